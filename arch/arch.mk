@@ -1,6 +1,7 @@
 # This file is part of MLDB. Copyright 2015 mldb.ai inc. All rights reserved.
 
 LIBARCH_SOURCES := \
+        simd_dispatch.cc \
         simd_vector.cc \
         demangle.cc \
 	tick_counter.cc \
@@ -9,11 +10,13 @@ LIBARCH_SOURCES := \
 	exception.cc \
 	exception_handler.cc \
 	backtrace.cc \
+	sampling_profiler.cc \
 	format.cc \
 	fslock.cc \
 	gpgpu.cc \
 	environment_static.cc \
 	cpu_info.cc \
+	numa_info.cc \
 	vm.cc \
 	info.cc \
 	rtti_utils.cc \
@@ -29,6 +32,7 @@ LIBARCH_SOURCES := \
 
 ifeq ($(ARCH),x86_64)
 LIBARCH_SOURCES += simd_vector_avx.cc
+LIBARCH_SOURCES += simd_vector_avx512.cc
 endif
 
 LIBARCH_LINK := \
@@ -57,6 +61,7 @@ $(eval $(call library,gc,$(LIBGC_SOURCES),$(LIBGC_LINK)))
 # Note: we should be able to get away without this, but we get a segfault on
 # shared library loading if it's not here.
 $(eval $(call set_single_compile_option,simd_vector_avx.cc,-mavx))
+$(eval $(call set_single_compile_option,simd_vector_avx512.cc,-mavx512f))
 
 $(eval $(call library,exception_hook,exception_hook.cc,arch dl))
 
@@ -21,6 +21,8 @@
 #include <iterator>
 #include <iostream>
 #include <map>
+#include <deque>
+#include <thread>
 #include <cstring>
 #include <errno.h>
 
@@ -232,6 +234,10 @@ struct GcLockBase::Deferred {
     std::map<int32_t, DeferredList *> entries;
     std::vector<DeferredList *> spares;
 
+    /// Number of lists in entries; readable without taking the lock so
+    /// that the distributed-mode exit path can cheaply skip runDefers()
+    std::atomic<int64_t> pending = { 0 };
+
     bool empty() const
     {
         std::lock_guard<Spinlock> guard(lock);
@@ -239,6 +245,73 @@ struct GcLockBase::Deferred {
     }
 };
 
+
+/*****************************************************************************/
+/* READ SLOTS                                                                */
+/*****************************************************************************/
+
+/** Per-thread epoch slot for EM_DISTRIBUTED locks.  Each slot gets a
+    cacheline of its own so that read-side entry and exit never touch
+    memory that another thread writes.
+*/
+struct alignas(64) GcLockBase::ReadSlot {
+    static constexpr int64_t EMPTY = -1;
+
+    /// EMPTY when the owning thread is not in a critical section,
+    /// otherwise the (zero extended) epoch it entered in
+    std::atomic<int64_t> value = { EMPTY };
+};
+
+struct GcLockBase::Slots {
+    mutable Spinlock lock;
+
+    /// Deque so that growth never moves a slot another thread points to
+    std::deque<ReadSlot> slots;
+
+    /// Slots handed back by dead threads, ready for reuse
+    std::vector<ReadSlot *> spares;
+
+    ReadSlot * allocate()
+    {
+        std::lock_guard<Spinlock> guard(lock);
+        if (!spares.empty()) {
+            ReadSlot * result = spares.back();
+            spares.pop_back();
+            return result;
+        }
+        slots.emplace_back();
+        return &slots.back();
+    }
+
+    void release(ReadSlot * slot)
+    {
+        slot->value.store(ReadSlot::EMPTY, std::memory_order_release);
+        std::lock_guard<Spinlock> guard(lock);
+        spares.push_back(slot);
+    }
+
+    /** Find the oldest epoch any thread is currently reading in.  Returns
+        false if nobody is in a read-side critical section.  The caller is
+        responsible for the store-load barrier that makes recently
+        published slots visible.
+    */
+    bool oldestActiveReader(int32_t & oldest) const
+    {
+        std::lock_guard<Spinlock> guard(lock);
+        bool any = false;
+        for (const ReadSlot & slot: slots) {
+            int64_t value = slot.value.load(std::memory_order_acquire);
+            if (value == ReadSlot::EMPTY)
+                continue;
+            int32_t epoch = (int32_t)value;
+            if (!any || compareEpochs(epoch, oldest) < 0)
+                oldest = epoch;
+            any = true;
+        }
+        return any;
+    }
+};
+
 std::string
 GcLockBase::ThreadGcInfoEntry::
 print() const
@@ -256,7 +329,7 @@ GcLockBase::ThreadGcInfoEntry::
 ThreadGcInfoEntry()
     : inEpoch(-1), readLocked(0), writeLocked(0),
       specLocked(0), specUnlocked(0),
-      owner(0)
+      owner(0), slot(0)
 {
 }
 
@@ -277,8 +350,12 @@ GcLockBase::ThreadGcInfoEntry::
         unlockShared(RD_YES);
         specUnlocked = 0;
     }
-           
-} 
+
+    if (owner && slot) {
+        owner->releaseSlot(slot);
+        slot = 0;
+    }
+}
 
 
 /*****************************************************************************/
@@ -441,7 +518,9 @@ print() const
 }
 
 GcLockBase::
-GcLockBase()
+GcLockBase(EpochMode epochMode)
+    : epochMode(epochMode),
+      slots(epochMode == EM_DISTRIBUTED ? new Slots() : nullptr)
 {
     deferred = new Deferred();
 }
@@ -454,6 +533,51 @@ GcLockBase::
     }
 
     delete deferred;
+
+    // gcInfo is destroyed after this body runs and the entries it holds
+    // hand their slots back through releaseSlot, so leave a null behind
+    // for it to test rather than a dangling registry
+    delete slots;
+    slots = nullptr;
+}
+
+GcLockBase::ReadSlot *
+GcLockBase::
+allocateSlot()
+{
+    return slots->allocate();
+}
+
+void
+GcLockBase::
+releaseSlot(ReadSlot * slot)
+{
+    if (!slots) return;  // lock already destroyed; registry went with it
+    slots->release(slot);
+}
+
+bool
+GcLockBase::
+anyReaderActive() const
+{
+    int32_t oldest;
+    return slots->oldestActiveReader(oldest);
+}
+
+int32_t
+GcLockBase::
+visibleEpochForDefers() const
+{
+    if (epochMode == EM_SHARED)
+        return data->atomic.visibleEpoch();
+
+    // Make sure we see every slot published before this point
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    int32_t oldest;
+    if (!slots->oldestActiveReader(oldest))
+        return (int32_t)data->atomic.s.epoch.load() - 1;
+    return oldest - 1;
 }
 
 bool
@@ -526,10 +650,10 @@ checkDefers()
 {
     std::vector<DeferredList *> result;
 
+    int32_t visible = visibleEpochForDefers();
+
     while (!deferred->entries.empty() &&
-            compareEpochs(
-                    deferred->entries.begin()->first,
-                    data->atomic.visibleEpoch()) <= 0)
+            compareEpochs(deferred->entries.begin()->first, visible) <= 0)
     {
         result.reserve(deferred->entries.size());
 
@@ -537,7 +661,7 @@ checkDefers()
                  end = deferred->entries.end();
              it != end;  /* no inc */) {
 
-            if (compareEpochs(it->first, data->atomic.visibleEpoch()) > 0)
+            if (compareEpochs(it->first, visible) > 0)
                 break;  // still visible
 
             ExcAssert(it->second);
@@ -546,7 +670,10 @@ checkDefers()
             auto toDelete = it;
             it = std::next(it);
             deferred->entries.erase(toDelete);
+            --deferred->pending;
         }
+
+        visible = visibleEpochForDefers();
     }
 
     return result;
@@ -557,9 +684,14 @@ GcLockBase::
 enterCS(ThreadGcInfoEntry * entry, RunDefer runDefer)
 {
     if (!entry) entry = &getEntry();
-        
+
     ExcAssertEqual(entry->inEpoch, -1);
 
+    if (epochMode == EM_DISTRIBUTED) {
+        enterCSDistributed(entry);
+        return;
+    }
+
     Atomic current = data->atomic;
 
     for (;;) {
@@ -589,6 +721,38 @@ enterCS(ThreadGcInfoEntry * entry, RunDefer runDefer)
     }
 }
 
+void
+GcLockBase::
+enterCSDistributed(ThreadGcInfoEntry * entry)
+{
+    if (MLDB_UNLIKELY(!entry->slot))
+        entry->slot = allocateSlot();
+
+    ReadSlot & slot = *entry->slot;
+
+    for (;;) {
+        // Acquire so that a reader seeing an epoch bumped by defer() also
+        // sees the unlinking that preceded the bump
+        int32_t epoch = data->atomic.s.epoch.load(std::memory_order_acquire);
+
+        slot.value.store((int64_t)(uint32_t)epoch, std::memory_order_relaxed);
+
+        // Store-load barrier: the slot must be visible before we read any
+        // shared state, including the exclusive bit below.  Either a
+        // concurrent writer sees our slot, or we see its work.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (MLDB_LIKELY(!data->atomic.exclusive())) {
+            entry->inEpoch = epoch & 1;
+            return;
+        }
+
+        // An exclusive lock is in progress; stand down and wait for it
+        slot.value.store(ReadSlot::EMPTY, std::memory_order_relaxed);
+        wait_on_address(data->exclusiveFutex, 1);
+    }
+}
+
 void
 GcLockBase::
 exitCS(ThreadGcInfoEntry * entry, RunDefer runDefer /* = true */)
@@ -599,6 +763,20 @@ exitCS(ThreadGcInfoEntry * entry, RunDefer runDefer /* = true */)
     ExcCheck(entry->inEpoch == 0 || entry->inEpoch == 1,
             "Invalid inEpoch");
 
+    if (epochMode == EM_DISTRIBUTED) {
+        // Publishing the empty value is all that's needed; the release
+        // ordering keeps the reads we did inside the section from leaking
+        // past it
+        entry->slot->value.store(ReadSlot::EMPTY, std::memory_order_release);
+        entry->inEpoch = -1;
+
+        // Readers never wake the visible futex, so retired work is
+        // collected on the way out instead
+        if (runDefer && deferred->pending.load(std::memory_order_relaxed))
+            runDefers();
+        return;
+    }
+
 #if 0
     // Fast path
     if (data->atomic.decrementInAtomic(entry->inEpoch) > 1) {
@@ -626,6 +804,11 @@ enterCSExclusive(ThreadGcInfoEntry * entry)
 {
     ExcAssertEqual(entry->inEpoch, -1);
 
+    if (epochMode == EM_DISTRIBUTED) {
+        enterCSExclusiveDistributed(entry);
+        return;
+    }
+
     Atomic current = data->atomic, newValue;
 
     for (;;) {
@@ -683,6 +866,34 @@ enterCSExclusive(ThreadGcInfoEntry * entry)
     entry->inEpoch = startEpoch & 1;
 }
 
+void
+GcLockBase::
+enterCSExclusiveDistributed(ThreadGcInfoEntry * entry)
+{
+    // Contend for the exclusive bit with a subword RMW; a whole-word
+    // compare and swap would race with the epoch bumps that defer() does
+    for (;;) {
+        uint16_t old = data->atomic.s.in[0]
+            .fetch_or(Atomic::EXCLUSIVE_MASK, std::memory_order_seq_cst);
+        if (!(old & Atomic::EXCLUSIVE_MASK))
+            break;
+        wait_on_address(data->exclusiveFutex, 1);
+    }
+
+    data->exclusiveFutex.store(1, std::memory_order_release);
+
+    // Readers check the exclusive bit after publishing their slot: either
+    // the scan below sees their slot, or they see the bit and stand down
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    for (unsigned i = 0;  anyReaderActive();  ++i) {
+        if (i % 128 == 127)
+            std::this_thread::yield();
+    }
+
+    entry->inEpoch = data->atomic.s.epoch & 1;
+}
+
 void
 GcLockBase::
 exitCSExclusive(ThreadGcInfoEntry * entry)
@@ -725,6 +936,26 @@ visibleBarrier()
         throw MLDB::Exception("visibleBarrier called in critical section will "
                             "deadlock");
 
+    if (epochMode == EM_DISTRIBUTED) {
+        // Move the epoch along so that readers arriving from now on
+        // publish a newer one and can't keep us spinning, then wait for
+        // everybody who was in when we started to leave.  Readers exit
+        // with a plain store and never wake a futex, so we spin politely
+        // rather than sleeping.
+        int32_t startEpoch = (int32_t)data->atomic.s.epoch.fetch_add(1);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        for (unsigned i = 0;  ;  ++i) {
+            int32_t oldest;
+            if (!slots->oldestActiveReader(oldest)
+                || compareEpochs(oldest, startEpoch) > 0)
+                return;
+            if (i % 128 == 127)
+                std::this_thread::yield();
+        }
+    }
+
     Atomic current = data->atomic;
     int startEpoch = current.s.epoch;
     
@@ -847,6 +1078,43 @@ doDefer(void (fn) (Args...), Args... args) ATTRIBUTE_NO_SANITIZE_UNDEFINED
     // If there are threads in the current epoch (irrespective of the old
     // epoch) then we need to wait until the current epoch is done.
 
+    if (epochMode == EM_DISTRIBUTED) {
+        // The unlink that made this work safe to defer happened before the
+        // call; the barrier orders it before the reader scan below
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!anyReaderActive()) {
+            // Nobody can still see it: a reader whose slot the scan missed
+            // published after the barrier, so it already sees the new
+            // structure.  Run it inline.
+            fn(std::forward<Args>(args)...);
+            return;
+        }
+
+        {
+            std::lock_guard<Spinlock> guard(deferred->lock);
+
+            // Retire under the current epoch, then move the epoch along so
+            // that readers arriving from now on publish a newer one and
+            // don't hold this work up
+            int32_t retireEpoch = (int32_t)data->atomic.s.epoch.fetch_add(1);
+
+            auto epochIt = deferred->entries.insert
+                (make_pair(retireEpoch, (DeferredList *)0)).first;
+            if (epochIt->second == 0) {
+                epochIt->second = new DeferredList();
+                ++deferred->pending;
+            }
+            epochIt->second->addDeferred(retireEpoch, fn,
+                                         std::forward<Args>(args)...);
+        }
+
+        ++data->visibleFutex;
+        wake_by_address(data->visibleFutex);
+        runDefers();
+        return;
+    }
+
     Atomic current = data->atomic;
 
     int32_t newestVisibleEpoch = current.s.epoch;
@@ -894,6 +1162,7 @@ doDefer(void (fn) (Args...), Args... args) ATTRIBUTE_NO_SANITIZE_UNDEFINED
         if (epochIt->second == 0) {
             // Create a new list
             epochIt->second = new DeferredList();
+            ++deferred->pending;
         }
         
         DeferredList & list = *epochIt->second;
@@ -965,6 +1234,11 @@ bool
 GcLockBase::
 isLockedByAnyThread() const
 {
+    if (epochMode == EM_DISTRIBUTED) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return data->atomic.exclusive() || anyReaderActive();
+    }
+
     return data->atomic.s.in[0] || data->atomic.s.in[1] ;
 }
 
@@ -987,8 +1261,9 @@ uninitializedConstructData(void * memory)
 /*****************************************************************************/
 
 GcLock::
-GcLock()
-    : localData(new Data())
+GcLock(EpochMode epochMode)
+    : GcLockBase(epochMode),
+      localData(new Data())
 {
     data = localData.get();
 }
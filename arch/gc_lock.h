@@ -65,6 +65,29 @@ public:
         RD_YES = 1      ///< Potentially run deferred work on this call
     };
 
+    /** How read-side critical sections are tracked.
+
+        EM_SHARED keeps the per-epoch reader counts in a single atomic word
+        that every entry and exit updates with a compare-and-swap.  It's the
+        default, and the only mode available to shared-memory locks since
+        all of the state lives in one relocatable block.
+
+        EM_DISTRIBUTED gives each reading thread its own cacheline-sized
+        epoch slot; entering a critical section is a plain store to the
+        thread's own slot plus a fence, never a read-modify-write on shared
+        state.  Deferral processing, barriers and the exclusive lock scan
+        the slots instead of looking at counters.  Worth it for locks with
+        many threads doing short or speculative reads, where the shared
+        counter word otherwise becomes a contended cacheline.
+    */
+    enum EpochMode {
+        EM_SHARED = 0,      ///< Single shared epoch word (default)
+        EM_DISTRIBUTED = 1  ///< Per-thread epoch slots on separate cachelines
+    };
+
+    /// Per-thread epoch slot for EM_DISTRIBUTED mode (hidden structure)
+    struct ReadSlot;
+
     /// A thread's bookkeeping info about each GC area
     struct ThreadGcInfoEntry {
         ThreadGcInfoEntry();
@@ -79,6 +102,8 @@ public:
 
         GcLockBase *owner;
 
+        ReadSlot *slot;  ///< This thread's epoch slot (EM_DISTRIBUTED only)
+
         void init(const GcLockBase * const self);
         void lockShared(RunDefer runDefer);
         void unlockShared(RunDefer runDefer);
@@ -115,7 +140,7 @@ public:
         //return *gcInfo.get(info);
     }
 
-    GcLockBase();
+    GcLockBase(EpochMode epochMode = EM_SHARED);
 
     virtual ~GcLockBase();
 
@@ -329,11 +354,41 @@ protected:
 private:
     struct Deferred;
     struct DeferredList;
+    struct Slots;
 
     GcInfo gcInfo;
 
     Deferred * deferred;   ///< Deferred workloads (hidden structure)
 
+    EpochMode epochMode;   ///< How read-side critical sections are tracked
+
+    Slots * slots;         ///< Registry of per-thread epoch slots
+                           ///< (EM_DISTRIBUTED only, hidden structure)
+
+    /** Read-side entry for EM_DISTRIBUTED: publish the current epoch into
+        this thread's slot with a plain store and a fence, standing down if
+        an exclusive lock is in progress.
+    */
+    void enterCSDistributed(ThreadGcInfoEntry * entry);
+
+    /** Take the exclusive bit with a subword RMW, then wait for every
+        published read slot to drain.
+    */
+    void enterCSExclusiveDistributed(ThreadGcInfoEntry * entry);
+
+    ReadSlot * allocateSlot();
+    void releaseSlot(ReadSlot * slot);
+
+    /** Is any thread currently in a read-side critical section?  The
+        caller must issue a store-load barrier first.
+    */
+    bool anyReaderActive() const;
+
+    /** The newest epoch whose deferred work can safely be run, in either
+        mode.
+    */
+    int32_t visibleEpochForDefers() const;
+
     /** Update with the new value after first checking that the current
         value is the same as the old value.  Returns true if it
         succeeded; otherwise oldValue is updated with the new old
@@ -364,7 +419,7 @@ private:
 
 struct GcLock : public GcLockBase
 {
-    GcLock();
+    GcLock(EpochMode epochMode = EM_SHARED);
     virtual ~GcLock();
 
     virtual void unlink();
@@ -0,0 +1,97 @@
+// This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+/* numa_info.cc
+   Information about the NUMA topology of the machine, read from sysfs.
+*/
+
+#include "numa_info.h"
+#include "cpu_info.h"
+
+#include <fstream>
+#include <sstream>
+#include <mutex>
+
+
+using namespace std;
+
+
+namespace MLDB {
+
+namespace {
+
+/* Parse a kernel cpulist string like "0-15,32-47" into CPU numbers. */
+static vector<int> parseCpuList(const string & cpuList)
+{
+    vector<int> result;
+
+    istringstream stream(cpuList);
+    string range;
+    while (getline(stream, range, ',')) {
+        if (range.empty())
+            continue;
+        int first = -1, last = -1;
+        string::size_type dash = range.find('-');
+        if (dash == string::npos) {
+            first = last = atoi(range.c_str());
+        }
+        else {
+            first = atoi(range.substr(0, dash).c_str());
+            last = atoi(range.substr(dash + 1).c_str());
+        }
+        for (int cpu = first;  cpu >= 0 && cpu <= last;  ++cpu)
+            result.push_back(cpu);
+    }
+
+    return result;
+}
+
+static vector<NumaNode> readNumaTopology()
+{
+    vector<NumaNode> result;
+
+    // Nodes are numbered contiguously on most machines, but the kernel
+    // allows holes; stop only after a run of missing nodes.
+    for (int node = 0, missing = 0;  missing < 16;  ++node) {
+        ifstream stream("/sys/devices/system/node/node"
+                        + std::to_string(node) + "/cpulist");
+        if (!stream) {
+            ++missing;
+            continue;
+        }
+        missing = 0;
+
+        string cpuList;
+        getline(stream, cpuList);
+
+        NumaNode entry;
+        entry.node = node;
+        entry.cpus = parseCpuList(cpuList);
+        if (!entry.cpus.empty())
+            result.emplace_back(std::move(entry));
+    }
+
+    if (result.empty()) {
+        // No NUMA information available; report one node with every CPU
+        NumaNode entry;
+        for (int cpu = 0;  cpu < num_cpus();  ++cpu)
+            entry.cpus.push_back(cpu);
+        result.emplace_back(std::move(entry));
+    }
+
+    return result;
+}
+
+} // file scope
+
+const std::vector<NumaNode> & numaTopology()
+{
+    static const vector<NumaNode> topology = readNumaTopology();
+    return topology;
+}
+
+int numNumaNodes()
+{
+    return numaTopology().size();
+}
+
+} // namespace MLDB
@@ -0,0 +1,34 @@
+/* numa_info.h                                                     -*- C++ -*-
+   This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+   Information about the NUMA topology of the machine.
+*/
+
+#pragma once
+
+#include <vector>
+
+namespace MLDB {
+
+/** Description of a single NUMA node: its kernel node number and the set
+    of CPUs that belong to it.
+*/
+struct NumaNode {
+    int node = 0;           ///< Node number as reported by the kernel
+    std::vector<int> cpus;  ///< CPUs that belong to this node
+};
+
+/** Return the NUMA topology of the machine, one entry per node, each with
+    the CPUs it contains.  On machines without NUMA information (including
+    non-Linux systems) a single node containing every CPU is returned, so
+    the result always has at least one node with at least one CPU.
+
+    The topology is read once and cached; the reference stays valid for
+    the lifetime of the process.
+*/
+const std::vector<NumaNode> & numaTopology();
+
+/** Return the number of NUMA nodes in the machine (always at least 1). */
+int numNumaNodes();
+
+} // namespace MLDB
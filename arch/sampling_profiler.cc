@@ -0,0 +1,194 @@
+/* sampling_profiler.cc
+   Jeremy Barnes, 30 August 2026
+   Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+   This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+   In-process sampling profiler.
+*/
+
+#include "sampling_profiler.h"
+#include "backtrace.h"
+#include "exception.h"
+#include "mldb/base/scope.h"
+
+#include <atomic>
+#include <map>
+#include <vector>
+
+#include <dirent.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace std;
+
+
+namespace MLDB {
+
+namespace {
+
+constexpr int MAX_FRAMES = 64;
+
+struct RawSample {
+    int numFrames = 0;
+    void * frames[MAX_FRAMES];
+};
+
+/// Slot the signal handler writes into.  Only one signal is in flight
+/// at a time: the coordinator points this at a sample, signals one
+/// thread, and waits on the semaphore before reusing it.
+RawSample * volatile currentSample = nullptr;
+sem_t sampleDone;
+
+void onProfileSignal(int)
+{
+    RawSample * sample = currentSample;
+    if (sample)
+        sample->numFrames = ::backtrace(sample->frames, MAX_FRAMES);
+    sem_post(&sampleDone);
+}
+
+/// Thread IDs of every thread currently in the process
+std::vector<pid_t> listThreads()
+{
+    std::vector<pid_t> result;
+
+    DIR * dir = opendir("/proc/self/task");
+    if (!dir)
+        throw MLDB::Exception(errno, "opendir(\"/proc/self/task\")");
+    Scope_Exit(::closedir(dir));
+
+    while (struct dirent * entry = readdir(dir)) {
+        if (entry->d_name[0] == '.')
+            continue;
+        result.push_back(atoi(entry->d_name));
+    }
+
+    return result;
+}
+
+} // file scope
+
+std::string
+SamplingProfiler::
+sampleAllThreads(double durationSeconds, int frequencyHz)
+{
+    if (!(durationSeconds > 0) || durationSeconds > 600)
+        throw MLDB::Exception("profiling duration must be between 0 and "
+                              "600 seconds");
+    if (frequencyHz < 1 || frequencyHz > 1000)
+        throw MLDB::Exception("profiling frequency must be between 1 and "
+                              "1000 Hz");
+
+    static std::atomic<bool> running(false);
+    bool expected = false;
+    if (!running.compare_exchange_strong(expected, true))
+        throw MLDB::Exception("a profiling run is already in progress");
+    Scope_Exit(running = false);
+
+    // The first backtrace() call may allocate while libgcc loads its
+    // unwinder, which is not safe in a signal handler; prime it here
+    void * primeFrames[2];
+    ::backtrace(primeFrames, 2);
+
+    if (sem_init(&sampleDone, 0, 0) == -1)
+        throw MLDB::Exception(errno, "sem_init");
+    Scope_Exit(::sem_destroy(&sampleDone));
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onProfileSignal;
+    action.sa_flags = SA_RESTART;
+
+    struct sigaction oldAction;
+    if (sigaction(SIGPROF, &action, &oldAction) == -1)
+        throw MLDB::Exception(errno, "sigaction(SIGPROF)");
+    Scope_Exit(::sigaction(SIGPROF, &oldAction, nullptr));
+
+    pid_t self = getpid();
+    pid_t selfTid = (pid_t)syscall(SYS_gettid);
+
+    // Identical stacks are merged as we go, so memory stays bounded by
+    // the number of unique stacks rather than the number of samples
+    std::map<std::vector<void *>, uint64_t> stacks;
+
+    size_t ticks = std::max<size_t>(1, durationSeconds * frequencyHz);
+    uint64_t intervalNs = 1000000000ULL / frequencyHz;
+
+    RawSample sample;
+
+    for (size_t tick = 0;  tick < ticks;  ++tick) {
+        for (pid_t tid: listThreads()) {
+            // The coordinating thread's stack is just this loop
+            if (tid == selfTid)
+                continue;
+
+            sample.numFrames = 0;
+            currentSample = &sample;
+
+            if (syscall(SYS_tgkill, self, tid, SIGPROF) == -1)
+                continue;  // thread exited since we listed it
+
+            // The timeout covers a thread that exits between the
+            // tgkill and the signal being delivered
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += 100000000;  // 100ms
+            if (deadline.tv_nsec >= 1000000000) {
+                deadline.tv_sec += 1;
+                deadline.tv_nsec -= 1000000000;
+            }
+            if (sem_timedwait(&sampleDone, &deadline) == -1)
+                continue;
+
+            currentSample = nullptr;
+
+            // Frames 0 and 1 are the signal handler and the kernel
+            // trampoline; drop them
+            if (sample.numFrames <= 2)
+                continue;
+            std::vector<void *> stack(sample.frames + 2,
+                                      sample.frames + sample.numFrames);
+            ++stacks[std::move(stack)];
+        }
+
+        struct timespec pause;
+        pause.tv_sec = intervalNs / 1000000000;
+        pause.tv_nsec = intervalNs % 1000000000;
+        nanosleep(&pause, nullptr);
+    }
+
+    // Symbolize each unique address exactly once
+    std::map<const void *, std::string> names;
+    auto nameFor = [&] (const void * addr) -> const std::string &
+        {
+            auto it = names.find(addr);
+            if (it == names.end()) {
+                BacktraceFrame frame(-1, addr);
+                it = names.emplace(addr, frame.print_for_trace()).first;
+            }
+            return it->second;
+        };
+
+    // Collapsed stack format: root;...;leaf count
+    std::string result;
+    for (auto & s: stacks) {
+        std::string line;
+        for (auto it = s.first.rbegin();  it != s.first.rend();  ++it) {
+            if (!line.empty())
+                line += ';';
+            line += nameFor(*it);
+        }
+        result += line + ' ' + std::to_string(s.second) + '\n';
+    }
+
+    return result;
+}
+
+} // namespace MLDB
@@ -0,0 +1,45 @@
+/* sampling_profiler.h                                             -*- C++ -*-
+   Jeremy Barnes, 30 August 2026
+   Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+   This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+   In-process sampling profiler.
+*/
+
+#pragma once
+
+#include <string>
+
+namespace MLDB {
+
+/*****************************************************************************/
+/* SAMPLING PROFILER                                                         */
+/*****************************************************************************/
+
+/** Signal-based sampling profiler.
+
+    Periodically interrupts every thread in the process with SIGPROF,
+    captures its stack with the backtrace machinery, and aggregates
+    identical stacks.  The output is in collapsed-stack format (one
+    line per unique stack, root to leaf, semicolon separated, followed
+    by a sample count), ready to be fed to a flamegraph renderer.
+
+    Sampling runs synchronously in the calling thread for the requested
+    duration; symbolization happens once per unique address after
+    collection, so the per-sample cost on interrupted threads is just
+    the stack walk.
+*/
+
+struct SamplingProfiler {
+
+    /** Sample all thread stacks for the given duration at the given
+        frequency, and return the collapsed-stack file contents.
+
+        Only one sampling run may be active in the process at a time;
+        a concurrent call will throw.
+    */
+    static std::string sampleAllThreads(double durationSeconds,
+                                        int frequencyHz = 200);
+};
+
+} // namespace MLDB
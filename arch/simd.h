@@ -53,6 +53,12 @@ MLDB_ALWAYS_INLINE bool has_avx2()
     return cpuid(7, 0).ebx & (1 << 5);
 }
 
+MLDB_ALWAYS_INLINE bool has_avx512f()
+{
+    const CPU_Info & info = cpu_info();
+    return (cpuid(7, 0).ebx & (1 << 16)) && info.xsave && info.osxsave;
+}
+
 #endif // __i686__
 
 } // namespace MLDB
@@ -0,0 +1,134 @@
+/* simd_dispatch.cc
+   Jeremy Barnes, 30 August 2026
+   Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+   This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+   Central registry for runtime-dispatched SIMD kernel variants.
+*/
+
+#include "simd_dispatch.h"
+#include "simd.h"
+#include "exception.h"
+#include <map>
+#include <mutex>
+
+using namespace std;
+
+namespace MLDB {
+
+const char *
+simdLevelName(SimdLevel level)
+{
+    switch (level) {
+    case SimdLevel::SCALAR:   return "scalar";
+    case SimdLevel::SSE2:     return "sse2";
+    case SimdLevel::AVX:      return "avx";
+    case SimdLevel::AVX2:     return "avx2";
+    case SimdLevel::AVX512F:  return "avx512f";
+    }
+    throw Exception("unknown SimdLevel");
+}
+
+SimdLevel
+highestSupportedSimdLevel()
+{
+    // cpuid doesn't change under us, so interrogate it once
+    static const SimdLevel level = [] () -> SimdLevel
+        {
+#ifdef MLDB_INTEL_ISA
+            if (has_avx512f())
+                return SimdLevel::AVX512F;
+            if (has_avx2())
+                return SimdLevel::AVX2;
+            if (has_avx())
+                return SimdLevel::AVX;
+            if (has_sse2())
+                return SimdLevel::SSE2;
+#endif
+            return SimdLevel::SCALAR;
+        } ();
+    return level;
+}
+
+namespace {
+
+struct SimdRegistry {
+    std::mutex mutex;
+    std::map<std::string, std::map<SimdLevel, void *> > kernels;
+
+    static SimdRegistry & instance()
+    {
+        // Leaked so that registrations from static initializers in other
+        // translation units never race with its destruction
+        static SimdRegistry * registry = new SimdRegistry();
+        return *registry;
+    }
+
+    void registerVariant(const std::string & key, SimdLevel level, void * fn)
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        kernels[key][level] = fn;
+    }
+
+    /** Pick the highest registered level the CPU supports. */
+    void * resolve(const std::string & key)
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        auto it = kernels.find(key);
+        if (it == kernels.end())
+            throw Exception("no variants registered for SIMD kernel '"
+                            + key + "'");
+        SimdLevel supported = highestSupportedSimdLevel();
+        for (auto vit = it->second.rbegin(); vit != it->second.rend(); ++vit) {
+            if (vit->first <= supported)
+                return vit->second;
+        }
+        throw Exception("no usable variant for SIMD kernel '" + key
+                        + "' (missing scalar fallback?)");
+    }
+
+    std::vector<SimdKernelInfo> list()
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        SimdLevel supported = highestSupportedSimdLevel();
+        std::vector<SimdKernelInfo> result;
+        result.reserve(kernels.size());
+        for (auto & k: kernels) {
+            SimdKernelInfo info;
+            info.key = k.first;
+            for (auto & v: k.second) {
+                info.available.push_back(simdLevelName(v.first));
+                if (v.first <= supported)
+                    info.chosen = simdLevelName(v.first);
+            }
+            result.emplace_back(std::move(info));
+        }
+        return result;
+    }
+};
+
+} // file scope
+
+namespace Dispatch_Details {
+
+void
+registerSimdVariant(const std::string & key, SimdLevel level, void * fn)
+{
+    SimdRegistry::instance().registerVariant(key, level, fn);
+}
+
+void *
+resolveSimdVariant(const std::string & key)
+{
+    return SimdRegistry::instance().resolve(key);
+}
+
+} // namespace Dispatch_Details
+
+std::vector<SimdKernelInfo>
+listSimdKernels()
+{
+    return SimdRegistry::instance().list();
+}
+
+} // namespace MLDB
@@ -0,0 +1,121 @@
+/* simd_dispatch.h                                                 -*- C++ -*-
+   Jeremy Barnes, 30 August 2026
+   Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+   This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+   Central registry for runtime-dispatched SIMD kernel variants.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace MLDB {
+
+/** Instruction-set levels a kernel variant can be compiled for, in
+    increasing order of capability.  Resolution picks the highest
+    registered level the running CPU supports.
+*/
+enum class SimdLevel : int {
+    SCALAR = 0,     ///< plain C++, always available
+    SSE2,
+    AVX,
+    AVX2,
+    AVX512F
+};
+
+/** Return the printable name of a level ("scalar", "sse2", ...). */
+const char * simdLevelName(SimdLevel level);
+
+/** Return the highest level the running CPU supports, interrogated from
+    cpuid once on first use.
+*/
+SimdLevel highestSupportedSimdLevel();
+
+/** Diagnostics view of one registered kernel: which variants exist and
+    which one resolution chose for this machine.
+*/
+struct SimdKernelInfo {
+    std::string key;
+    std::string chosen;
+    std::vector<std::string> available;
+};
+
+/** Return the registered kernels with their chosen variants, sorted by
+    key.  Exposed on GET /v1/simdKernels for diagnostics.
+*/
+std::vector<SimdKernelInfo> listSimdKernels();
+
+namespace Dispatch_Details {
+
+void registerSimdVariant(const std::string & key, SimdLevel level, void * fn);
+void * resolveSimdVariant(const std::string & key);
+
+} // namespace Dispatch_Details
+
+
+/*****************************************************************************/
+/* SIMD KERNEL                                                               */
+/*****************************************************************************/
+
+/** One multi-versioned kernel.  Declare a file-scope instance with a
+    unique key, register the variants against it at static initialization
+    time with RegisterSimdVariant, and call through it like a function:
+
+        static SimdKernel<double (const double *, const double *, size_t)>
+        dotprodKernel("vec_dotprod_double");
+
+        static RegisterSimdVariant
+        regScalar(dotprodKernel, SimdLevel::SCALAR, &dotprod_scalar),
+        regAvx(dotprodKernel, SimdLevel::AVX, &Avx::vec_dotprod);
+
+        double vec_dotprod(const double * x, const double * y, size_t n)
+        {
+            return dotprodKernel(x, y, n);
+        }
+
+    The variant is resolved once on first call (and re-resolved if a
+    variant is registered later) and cached in an atomic, so steady-state
+    dispatch is a single load and an indirect call.  At least a SCALAR
+    variant must be registered or the first call will throw.
+*/
+template<typename Fn> struct SimdKernel;
+
+template<typename R, typename... Args>
+struct SimdKernel<R (Args...)> {
+    explicit SimdKernel(const char * key)
+        : key(key), resolved(nullptr)
+    {
+    }
+
+    R operator () (Args... args) const
+    {
+        auto fn = resolved.load(std::memory_order_acquire);
+        if (!fn) {
+            fn = reinterpret_cast<R (*) (Args...)>
+                (Dispatch_Details::resolveSimdVariant(key));
+            resolved.store(fn, std::memory_order_release);
+        }
+        return fn(args...);
+    }
+
+    const char * key;
+    mutable std::atomic<R (*) (Args...)> resolved;
+};
+
+struct RegisterSimdVariant {
+    template<typename R, typename... Args>
+    RegisterSimdVariant(SimdKernel<R (Args...)> & kernel,
+                        SimdLevel level,
+                        R (*fn) (Args...))
+    {
+        Dispatch_Details::registerSimdVariant(kernel.key, level,
+                                              reinterpret_cast<void *>(fn));
+        // Force re-resolution so registration order doesn't matter
+        kernel.resolved.store(nullptr, std::memory_order_release);
+    }
+};
+
+} // namespace MLDB
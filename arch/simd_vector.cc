@@ -9,12 +9,14 @@
 
 #include "mldb/arch/arch.h"
 #include "mldb/compiler/compiler.h"
+#include "simd_dispatch.h"
 #include "exception.h"
 #include <iostream>
 #include <cmath>
 #if MLDB_INTEL_ISA
 # include "simd_vector.h"
 # include "simd_vector_avx.h"
+# include "simd_vector_avx512.h"
 # include "sse2.h"
 # include <immintrin.h>
 #endif
@@ -205,13 +207,24 @@ void vec_prod(const double * x, const double * y, float * r, size_t n)
     for (; i < n;  ++i) r[i] = x[i] * y[i];
 }
 
-void vec_add(const float * x, float k, const float * y, float * r, size_t n)
+namespace {
+
+void vec_add_k_scalar(const float * x, float k, const float * y, float * r,
+                      size_t n)
+{
+    for (size_t i = 0;  i < n;  ++i) r[i] = x[i] + k * y[i];
+}
+
+} // file scope
+
+#if MLDB_INTEL_ISA
+static void vec_add_k_sse2(const float * x, float k, const float * y,
+                           float * r, size_t n)
 {
     size_t i = 0;
 
     //bool alignment_unimportant = true;  // nehalem?
 
-#if MLDB_INTEL_ISA
     if (false && n >= 16 && (ptr_align(x) == ptr_align(y) && ptr_align(y) == ptr_align(r))) {
         v4sf kkkk = vec_splat(k);
 
@@ -294,10 +307,27 @@ void vec_add(const float * x, float k, const float * y, float * r, size_t n)
             _mm_storeu_ps(r + i + 0, yyyy0);
         }
     }
-#endif
 
     for (; i < n;  ++i) r[i] = x[i] + k * y[i];
 }
+#endif // MLDB_INTEL_ISA
+
+static SimdKernel<void (const float *, float, const float *, float *, size_t)>
+vecAddKFloatKernel("vec_add_k_float");
+
+static RegisterSimdVariant
+regVecAddKScalar(vecAddKFloatKernel, SimdLevel::SCALAR, &vec_add_k_scalar);
+
+#if MLDB_INTEL_ISA
+static RegisterSimdVariant
+regVecAddKSse2(vecAddKFloatKernel, SimdLevel::SSE2, &vec_add_k_sse2),
+regVecAddKAvx512(vecAddKFloatKernel, SimdLevel::AVX512F, &Avx512::vec_add);
+#endif
+
+void vec_add(const float * x, float k, const float * y, float * r, size_t n)
+{
+    vecAddKFloatKernel(x, k, y, r, n);
+}
 
 void vec_add(const float * x, const float * k, const float * y, float * r,
              size_t n)
@@ -629,67 +659,87 @@ double vec_dotprod(const double * x, const double * y, size_t n)
     return vec_dotprod_(x, y, n);
 }
 #else
-double vec_dotprod(const double * x, const double * y, size_t n)
+
+// Dispatch goes through the central registry in simd_dispatch.h: each
+// variant is registered against its instruction-set level and the best
+// one the CPU supports is resolved once, on first call.
+
+namespace {
+
+double vec_dotprod_scalar(const double * x, const double * y, size_t n)
 {
-    // Interrogate the cpuid flags directly to decide which one to use
-        if (false)
-        ;
+    double result = 0.0;
+    for (size_t i = 0; i < n;  ++i) result += x[i] * y[i];
+    return result;
+}
+
+void vec_minus_scalar(const float * x, const float * y, float * r, size_t n)
+{
+    for (size_t i = 0;  i < n;  ++i) r[i] = x[i] - y[i];
+}
+
+double vec_euclid_scalar(const float * x, const float * y, size_t n)
+{
+    double result = 0.0;
+    for (size_t i = 0;  i < n;  ++i)
+        result += (x[i] - y[i]) * (x[i] - y[i]);
+    return result;
+}
+
+} // file scope
 
 #if MLDB_INTEL_ISA
-    else if (has_avx()) {
-        return Avx::vec_dotprod(x, y, n);
-    }
-    else if (true) {
-        return vec_dotprod_sse2(x, y, n);
-    }
+static double vec_euclid_sse2(const float * x, const float * y, size_t n)
+{
+    float tmp[n];
+    vec_minus_sse2(x, y, tmp, n);
+    return vec_dotprod_sse2(tmp, tmp, n);
+}
 #endif
-    else {
-        double result = 0.0;
-        for (size_t i = 0; i < n;  ++i) result += x[i] * y[i];
-        return result;
-    }
+
+static SimdKernel<double (const double *, const double *, size_t)>
+vecDotprodDoubleKernel("vec_dotprod_double");
+
+static SimdKernel<void (const float *, const float *, float *, size_t)>
+vecMinusFloatKernel("vec_minus_float");
+
+static SimdKernel<double (const float *, const float *, size_t)>
+vecEuclidFloatKernel("vec_euclid_float");
+
+static RegisterSimdVariant
+regVecDotprodScalar(vecDotprodDoubleKernel, SimdLevel::SCALAR,
+                    &vec_dotprod_scalar),
+regVecMinusScalar(vecMinusFloatKernel, SimdLevel::SCALAR, &vec_minus_scalar),
+regVecEuclidScalar(vecEuclidFloatKernel, SimdLevel::SCALAR,
+                   &vec_euclid_scalar);
+
+#if MLDB_INTEL_ISA
+static RegisterSimdVariant
+regVecDotprodSse2(vecDotprodDoubleKernel, SimdLevel::SSE2, &vec_dotprod_sse2),
+regVecDotprodAvx(vecDotprodDoubleKernel, SimdLevel::AVX, &Avx::vec_dotprod),
+regVecDotprodAvx512(vecDotprodDoubleKernel, SimdLevel::AVX512F,
+                    &Avx512::vec_dotprod),
+regVecMinusSse2(vecMinusFloatKernel, SimdLevel::SSE2, &vec_minus_sse2),
+regVecMinusAvx(vecMinusFloatKernel, SimdLevel::AVX, &Avx::vec_minus),
+regVecEuclidSse2(vecEuclidFloatKernel, SimdLevel::SSE2, &vec_euclid_sse2),
+regVecEuclidAvx(vecEuclidFloatKernel, SimdLevel::AVX, &Avx::vec_euclid),
+regVecEuclidAvx512(vecEuclidFloatKernel, SimdLevel::AVX512F,
+                   &Avx512::vec_euclid);
+#endif
+
+double vec_dotprod(const double * x, const double * y, size_t n)
+{
+    return vecDotprodDoubleKernel(x, y, n);
 }
 
 void vec_minus(const float * x, const float * y, float * r, size_t n)
 {
-    // Interrogate the cpuid flags directly to decide which one to use
-    if (false)
-        ;
-#if MLDB_INTEL_ISA
-    if (has_avx()) {
-        Avx::vec_minus(x, y, r, n);
-    }
-    else if (true) /* sse2 */ {
-        vec_minus_sse2(x, y, r, n);
-    }
-#endif
-    else {
-        for (size_t i = 0;  i < n;  ++i) r[i] = x[i] - y[i];
-    }
+    vecMinusFloatKernel(x, y, r, n);
 }
 
 double vec_euclid(const float * x, const float * y, size_t n)
 {
-    // Interrogate the cpuid flags directly to decide which one to use
-        if (false)
-        ;
-
-#if MLDB_INTEL_ISA
-    if (has_avx()) {
-        return Avx::vec_euclid(x, y, n);
-    }
-    else if (true) /* sse2 */ {
-        float tmp[n];
-        vec_minus(x, y, tmp, n);
-        return vec_dotprod(tmp, tmp, n);
-    }
-#endif
-    else {
-        double result = 0.0;
-        for (size_t i = 0;  i < n;  ++i)
-            result += (x[i] - y[i]) * (x[i] - y[i]);
-        return result;
-    }
+    return vecEuclidFloatKernel(x, y, n);
 }
 
 #endif // GCC 4.8 multiversion problems
@@ -1066,25 +1116,37 @@ double vec_dotprod_dp(const double * x, const float * y, size_t n)
     return res;
 }
 
-double vec_dotprod_dp(const float * x, const float * y, size_t n)
+namespace {
+
+double vec_dotprod_dp_scalar(const float * x, const float * y, size_t n)
 {
-    // Interrogate the cpuid flags directly to decide which one to use
-        if (false)
-        ;
+    double res = 0.0;
+    for (size_t i = 0;  i < n;  ++i) res += x[i] * y[i];
+    return res;
+}
+
+} // file scope
+
+static SimdKernel<double (const float *, const float *, size_t)>
+vecDotprodDpFloatKernel("vec_dotprod_dp_float");
+
+static RegisterSimdVariant
+regVecDotprodDpScalar(vecDotprodDpFloatKernel, SimdLevel::SCALAR,
+                      &vec_dotprod_dp_scalar);
 
 #if MLDB_INTEL_ISA
-    else if (has_avx()) {
-        return Avx::vec_dotprod_dp(x, y, n);
-    }
-    else if (true) {
-        return vec_dotprod_dp_sse2(x, y, n);
-    }
+static RegisterSimdVariant
+regVecDotprodDpSse2(vecDotprodDpFloatKernel, SimdLevel::SSE2,
+                    &vec_dotprod_dp_sse2),
+regVecDotprodDpAvx(vecDotprodDpFloatKernel, SimdLevel::AVX,
+                   &Avx::vec_dotprod_dp),
+regVecDotprodDpAvx512(vecDotprodDpFloatKernel, SimdLevel::AVX512F,
+                      &Avx512::vec_dotprod_dp);
 #endif
-    else {
-        double res = 0.0;
-        for (size_t i = 0;  i < n;  ++i) res += x[i] * y[i];
-        return res;
-    }
+
+double vec_dotprod_dp(const float * x, const float * y, size_t n)
+{
+    return vecDotprodDpFloatKernel(x, y, n);
 }
 
 double vec_sum_dp(const float * x, size_t n)
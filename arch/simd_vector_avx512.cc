@@ -0,0 +1,147 @@
+/** simd_vector_avx512.cc
+    This file is part of MLDB. Copyright 2016 mldb.ai inc. All rights reserved.
+
+    SIMD vector operations; AVX-512 specializations.
+
+    These kernels use fused multiply-add and masked loads/stores, so the
+    tail of a vector is handled by the same instructions as the body
+    rather than a scalar loop.  They are compiled with -mavx512f and must
+    only be called once has_avx512f() has returned true.
+
+    Note that the FMA accumulation means the results are not bit-for-bit
+    identical to the sse2/avx kernels (they are more accurate: products
+    are not rounded before being added).
+*/
+
+#include "simd_vector_avx512.h"
+#include <immintrin.h>
+
+namespace MLDB {
+namespace SIMD {
+namespace Avx512 {
+
+double vec_dotprod(const double * x, const double * y, size_t n)
+{
+    __m512d rr0 = _mm512_setzero_pd(), rr1 = rr0;
+
+    size_t i = 0;
+
+    for (; i + 16 <= n;  i += 16) {
+        rr0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i),
+                              _mm512_loadu_pd(y + i), rr0);
+        rr1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8),
+                              _mm512_loadu_pd(y + i + 8), rr1);
+    }
+
+    for (; i + 8 <= n;  i += 8) {
+        rr0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i),
+                              _mm512_loadu_pd(y + i), rr0);
+    }
+
+    if (i < n) {
+        __mmask8 mask = (1u << (n - i)) - 1;
+        rr1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, x + i),
+                              _mm512_maskz_loadu_pd(mask, y + i), rr1);
+    }
+
+    return _mm512_reduce_add_pd(_mm512_add_pd(rr0, rr1));
+}
+
+namespace {
+
+/// Upper 256 bits of a 512 bit single precision register
+inline __m256 upper_half(__m512 x)
+{
+    return _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(x), 1));
+}
+
+} // file scope
+
+double vec_dotprod_dp(const float * x, const float * y, size_t n)
+{
+    __m512d rr0 = _mm512_setzero_pd(), rr1 = rr0;
+
+    auto accum = [&] (__m512 xx, __m512 yy)
+        {
+            rr0 = _mm512_fmadd_pd
+                (_mm512_cvtps_pd(_mm512_castps512_ps256(xx)),
+                 _mm512_cvtps_pd(_mm512_castps512_ps256(yy)), rr0);
+            rr1 = _mm512_fmadd_pd
+                (_mm512_cvtps_pd(upper_half(xx)),
+                 _mm512_cvtps_pd(upper_half(yy)), rr1);
+        };
+
+    size_t i = 0;
+
+    for (; i + 16 <= n;  i += 16)
+        accum(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i));
+
+    if (i < n) {
+        __mmask16 mask = (1u << (n - i)) - 1;
+        accum(_mm512_maskz_loadu_ps(mask, x + i),
+              _mm512_maskz_loadu_ps(mask, y + i));
+    }
+
+    return _mm512_reduce_add_pd(_mm512_add_pd(rr0, rr1));
+}
+
+double vec_euclid(const float * x, const float * y, size_t n)
+{
+    __m512d rr0 = _mm512_setzero_pd(), rr1 = rr0;
+
+    auto accum = [&] (__m512 xx, __m512 yy)
+        {
+            __m512 dd = _mm512_sub_ps(xx, yy);
+            __m512d lo = _mm512_cvtps_pd(_mm512_castps512_ps256(dd));
+            __m512d hi = _mm512_cvtps_pd(upper_half(dd));
+            rr0 = _mm512_fmadd_pd(lo, lo, rr0);
+            rr1 = _mm512_fmadd_pd(hi, hi, rr1);
+        };
+
+    size_t i = 0;
+
+    for (; i + 16 <= n;  i += 16)
+        accum(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i));
+
+    if (i < n) {
+        __mmask16 mask = (1u << (n - i)) - 1;
+        accum(_mm512_maskz_loadu_ps(mask, x + i),
+              _mm512_maskz_loadu_ps(mask, y + i));
+    }
+
+    return _mm512_reduce_add_pd(_mm512_add_pd(rr0, rr1));
+}
+
+void vec_add(const float * x, float k, const float * y, float * r, size_t n)
+{
+    __m512 kk = _mm512_set1_ps(k);
+
+    size_t i = 0;
+
+    for (; i + 32 <= n;  i += 32) {
+        _mm512_storeu_ps
+            (r + i, _mm512_fmadd_ps(kk, _mm512_loadu_ps(y + i),
+                                    _mm512_loadu_ps(x + i)));
+        _mm512_storeu_ps
+            (r + i + 16, _mm512_fmadd_ps(kk, _mm512_loadu_ps(y + i + 16),
+                                         _mm512_loadu_ps(x + i + 16)));
+    }
+
+    for (; i + 16 <= n;  i += 16) {
+        _mm512_storeu_ps
+            (r + i, _mm512_fmadd_ps(kk, _mm512_loadu_ps(y + i),
+                                    _mm512_loadu_ps(x + i)));
+    }
+
+    if (i < n) {
+        __mmask16 mask = (1u << (n - i)) - 1;
+        _mm512_mask_storeu_ps
+            (r + i, mask,
+             _mm512_fmadd_ps(kk, _mm512_maskz_loadu_ps(mask, y + i),
+                             _mm512_maskz_loadu_ps(mask, x + i)));
+    }
+}
+
+} // namespace Avx512
+} // namespace SIMD
+} // namespace MLDB
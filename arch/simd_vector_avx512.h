@@ -0,0 +1,31 @@
+/** simd_vector_avx512.h                                           -*- C++ -*-
+    This file is part of MLDB. Copyright 2016 mldb.ai inc. All rights reserved.
+
+    SIMD vector operations; AVX-512 specializations.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+namespace MLDB {
+namespace SIMD {
+namespace Avx512 {
+
+/// Double precision vector dot product, avx-512 version
+double vec_dotprod(const double * x, const double * y, size_t n);
+
+/// Single precision vector dot product with internal summation in dp,
+/// avx-512 version
+double vec_dotprod_dp(const float * x, const float * y, size_t n);
+
+/// Single precision vector euclidean distance squared, accumulated in
+/// double precision, avx-512 version
+double vec_euclid(const float * x, const float * y, size_t n);
+
+/// Single precision saxpy (r = x + k y), avx-512 version
+void vec_add(const float * x, float k, const float * y, float * r, size_t n);
+
+} // namespace Avx512
+} // namespace SIMD
+} // namespace MLDB
@@ -316,6 +316,130 @@ BOOST_AUTO_TEST_CASE ( test_gc_deferred )
                        std::placeholders::_1));
 }
 
+/// GcLock in distributed-epoch mode, for reuse of the TestBase harness
+struct DistributedGcLock : public GcLock {
+    DistributedGcLock()
+        : GcLock(GcLockBase::EM_DISTRIBUTED)
+    {
+    }
+};
+
+BOOST_AUTO_TEST_CASE ( test_gc_distributed )
+{
+    GcLock gc(GcLockBase::EM_DISTRIBUTED);
+
+    gc.lockShared();
+    BOOST_CHECK(gc.isLockedShared());
+    BOOST_CHECK(gc.isLockedByAnyThread());
+
+    std::atomic<int> deferred(false);
+    gc.defer([&] () { deferred = true; });
+
+    // We hold the lock, so the work must wait for us
+    BOOST_CHECK(!deferred);
+
+    gc.unlockShared();
+    BOOST_CHECK(!gc.isLockedShared());
+
+    gc.deferBarrier();
+    BOOST_CHECK(deferred);
+
+    // With nobody in a critical section the work runs inline
+    std::atomic<int> deferred2(false);
+    gc.defer([&] () { deferred2 = true; });
+    BOOST_CHECK(deferred2);
+}
+
+BOOST_AUTO_TEST_CASE ( test_gc_distributed_mutual_exclusion )
+{
+    cerr << "testing distributed-epoch mutual exclusion" << endl;
+
+    GcLock lock(GcLockBase::EM_DISTRIBUTED);
+    std::atomic<bool> finished(false);
+    std::atomic<int> numExclusive(0);
+    std::atomic<int> numShared(0);
+    std::atomic<int> errors(0);
+    std::atomic<int> sharedIterations(0);
+    std::atomic<uint64_t> exclusiveIterations(0);
+
+    auto sharedThread = [&] ()
+        {
+            while (!finished) {
+                GcLock::SharedGuard guard(lock);
+                numShared += 1;
+
+                if (numExclusive > 0) {
+                    cerr << "exclusive and shared" << endl;
+                    errors += 1;
+                }
+
+                numShared -= 1;
+                sharedIterations += 1;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        };
+
+    auto exclusiveThread = [&] ()
+        {
+            while (!finished) {
+                GcLock::ExclusiveGuard guard(lock);
+                numExclusive += 1;
+
+                if (numExclusive > 1) {
+                    cerr << "more than one exclusive" << endl;
+                    errors += 1;
+                }
+                if (numShared > 0) {
+                    cerr << "exclusive and shared" << endl;
+                    errors += 1;
+                }
+
+                numExclusive -= 1;
+                exclusiveIterations += 1;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        };
+
+    int nthreads = 4;
+
+    ThreadGroup tg;
+    for (unsigned i = 0;  i < nthreads;  ++i)
+        tg.emplace_back(sharedThread);
+    for (unsigned i = 0;  i < nthreads;  ++i)
+        tg.emplace_back(exclusiveThread);
+    sleep(1);
+    finished = true;
+    tg.join_all();
+
+    BOOST_CHECK_EQUAL(errors, 0);
+    cerr << "iterations: shared " << sharedIterations
+         << " exclusive " << exclusiveIterations << endl;
+}
+
+BOOST_AUTO_TEST_CASE ( test_gc_distributed_sync )
+{
+    cerr << "testing synchronized distributed-epoch GcLock" << endl;
+
+    int nthreads = 8;
+    int nblocks = 2;
+
+    TestBase<DistributedGcLock> test(nthreads, nblocks);
+    test.run(std::bind(&TestBase<DistributedGcLock>::allocThreadSync, &test,
+                       std::placeholders::_1));
+}
+
+BOOST_AUTO_TEST_CASE ( test_gc_distributed_deferred )
+{
+    cerr << "testing deferred distributed-epoch GcLock" << endl;
+
+    int nthreads = 8;
+    int nblocks = 2;
+
+    TestBase<DistributedGcLock> test(nthreads, nblocks);
+    test.run(std::bind(&TestBase<DistributedGcLock>::allocThreadDefer, &test,
+                       std::placeholders::_1));
+}
+
 BOOST_AUTO_TEST_CASE ( test_defer_race )
 {
     cerr << "testing defer race" << endl;
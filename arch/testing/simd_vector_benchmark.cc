@@ -11,7 +11,9 @@
 #define BOOST_TEST_DYN_LINK
 
 #include "mldb/arch/arch.h"
+#include "mldb/arch/simd.h"
 #include "mldb/arch/simd_vector.h"
+#include "mldb/arch/simd_vector_avx512.h"
 #include "mldb/arch/demangle.h"
 #include "mldb/arch/tick_counter.h"
 
@@ -64,6 +66,14 @@ BOOST_AUTO_TEST_CASE( benchmark )
             y[i] = rand() / 16384.0;
         }
     
+        double min4 = INFINITY;
+
+#if MLDB_INTEL_ISA
+        bool avx512 = has_avx512f();
+#else
+        bool avx512 = false;
+#endif
+
         for (unsigned i = 0;  i < 100;  ++i) {
 
 #if MLDB_INTEL_ISA
@@ -77,19 +87,31 @@ BOOST_AUTO_TEST_CASE( benchmark )
             uint64_t t2 = ticks();
             vec_dotprod_generic(&x[0], &y[0], nvals);
             uint64_t t3 = ticks();
+#if MLDB_INTEL_ISA
+            if (avx512)
+                SIMD::Avx512::vec_dotprod(&x[0], &y[0], nvals);
+#endif // MLDB_INTEL_ISA
+            uint64_t t4 = ticks();
 
             double res_sse2 = t1 - t0;
             double res_avx  = t2 - t1;
             double res_generic = t3 - t2;
+            double res_avx512 = t4 - t3;
 
             min1 = std::min(min1, res_sse2);
             min2 = std::min(min2, res_avx);
             min3 = std::min(min3, res_generic);
+            min4 = std::min(min4, res_avx512);
         }
 
-        cerr << "Minimum: sse2 " << min1 << " avx " << min2 << " gen " << min3 << endl;
+        cerr << "Minimum: sse2 " << min1 << " avx " << min2 << " gen " << min3;
+        if (avx512)
+            cerr << " avx512 " << min4;
+        cerr << endl;
         cerr << "cycles/op: sse2 " << min1 / nvals << " avx " << min2 / nvals
-             << " generic " << min3 / nvals
-             << endl;
+             << " generic " << min3 / nvals;
+        if (avx512)
+            cerr << " avx512 " << min4 / nvals;
+        cerr << endl;
     }
 }
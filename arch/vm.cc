@@ -213,6 +213,28 @@ std::vector<unsigned char> page_flags(const void * addr, int npages)
     
 }
 
+Huge_Page_Stats huge_page_stats()
+{
+    Huge_Page_Stats result;
+
+    std::ifstream stream("/proc/self/smaps_rollup");
+
+    string line;
+    while (getline(stream, line)) {
+        char name[64];
+        unsigned long long kb;
+        if (sscanf(line.c_str(), "%63s %llu kB", name, &kb) != 2)
+            continue;
+        if (strcmp(name, "AnonHugePages:") == 0)
+            result.anon_huge_bytes += kb * 1024;
+        else if (strcmp(name, "Shared_Hugetlb:") == 0
+                 || strcmp(name, "Private_Hugetlb:") == 0)
+            result.hugetlb_bytes += kb * 1024;
+    }
+
+    return result;
+}
+
 void dump_maps(std::ostream & out)
 {
     std::ifstream stream("/proc/self/maps");
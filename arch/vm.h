@@ -31,6 +31,10 @@ constexpr int page_shift       = 14;  // M1 has 16k pages
 constexpr int page_size        = 1 << page_shift;
 constexpr int page_offset_mask = page_size - 1;
 
+// 2MB huge pages, used to reduce TLB pressure on very large regions
+constexpr int huge_page_shift  = 21;
+constexpr size_t huge_page_size = (size_t)1 << huge_page_shift;
+
 static const size_t page_num_mask = ~(size_t)page_offset_mask;
 
 struct Pagemap_Entry {
@@ -176,6 +180,17 @@ inline ssize_t to_page_num(ssize_t val)
 
 void dump_maps(std::ostream & stream = std::cerr);
 
+/** Huge page usage of the current process, in bytes, read from
+    /proc/self/smaps_rollup.  All zero when the kernel doesn't provide
+    the file.
+*/
+struct Huge_Page_Stats {
+    size_t anon_huge_bytes = 0;  ///< Transparent (THP) huge pages
+    size_t hugetlb_bytes = 0;    ///< Explicit MAP_HUGETLB pages
+};
+
+Huge_Page_Stats huge_page_stats();
+
 
 /*****************************************************************************/
 /* PAGEMAP_READER                                                            */
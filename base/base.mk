@@ -5,6 +5,7 @@ LIBBASE_SOURCES := \
         parse_context.cc \
 	thread_pool.cc \
 	parallel.cc \
+	work_class.cc \
 	optimized_path.cc \
 	hex_dump.cc \
 
@@ -7,6 +7,7 @@
 #include "optimized_path.h"
 #include "mldb/arch/exception.h"
 #include "mldb/base/exc_assert.h"
+#include <algorithm>
 #include <mutex>
 #include <map>
 #include <regex>
@@ -22,18 +23,16 @@ namespace MLDB {
 /*****************************************************************************/
 
 struct OptimizedPath::Itl {
-    Itl(std::string name)
-        : name(std::move(name)),
-          randSeed(1), ineligible(0),
-          eligibleAndTaken(0),
-          eligibleAndNotTaken(0)
+    Itl(std::string name, size_t index)
+        : name(std::move(name)), index(index),
+          randSeed(1)
     {
     }
 
     std::string name;
+    size_t index;   ///< slot in the per-thread counter blocks
     int level;
     unsigned randSeed;
-    std::atomic<uint64_t> ineligible, eligibleAndTaken, eligibleAndNotTaken;
 };
 
 /// Allow the default level to be controlled by the environment
@@ -64,6 +63,82 @@ int getDefaultLevel()
 std::mutex pathRegistryMutex;
 std::map<std::string, OptimizedPath *> pathRegistry;
 int defaultLevel = -1;
+
+/* Per-thread counter blocks.  Each thread counts into plain (non-atomic)
+   integers indexed by path slot, so the hot path is an increment with no
+   cache line sharing.  Blocks register themselves so that stats() can sum
+   across threads, and fold their totals into the retired tally when the
+   thread exits.  stats() reads the live counters without synchronizing
+   with the counting threads; the blocks never move once allocated, so
+   the worst case is a slightly stale number.
+
+   Slots are handed out at path registration and never reused: destroyed
+   paths leave their counters stale, which is harmless since paths are
+   almost always static objects that live until program exit.  Paths past
+   maxPathSlots are not counted. */
+
+constexpr size_t maxPathSlots = 1024;
+
+struct PathCounts {
+    uint64_t ineligible = 0;
+    uint64_t taken = 0;
+    uint64_t notTaken = 0;
+};
+
+std::mutex pathCountsMutex;
+size_t numPathSlots = 0;
+
+struct ThreadPathCounts;
+std::vector<ThreadPathCounts *> liveThreadCounts;
+PathCounts retiredCounts[maxPathSlots];
+
+struct ThreadPathCounts {
+    ThreadPathCounts()
+        : counts(nullptr)
+    {
+        std::unique_lock<std::mutex> guard(pathCountsMutex);
+        liveThreadCounts.push_back(this);
+    }
+
+    ~ThreadPathCounts()
+    {
+        std::unique_lock<std::mutex> guard(pathCountsMutex);
+        PathCounts * c = counts.load(std::memory_order_relaxed);
+        if (c) {
+            for (size_t i = 0;  i < maxPathSlots;  ++i) {
+                retiredCounts[i].ineligible += c[i].ineligible;
+                retiredCounts[i].taken += c[i].taken;
+                retiredCounts[i].notTaken += c[i].notTaken;
+            }
+            delete[] c;
+        }
+        auto it = std::find(liveThreadCounts.begin(), liveThreadCounts.end(),
+                            this);
+        if (it != liveThreadCounts.end())
+            liveThreadCounts.erase(it);
+    }
+
+    PathCounts * get()
+    {
+        PathCounts * c = counts.load(std::memory_order_relaxed);
+        if (MLDB_UNLIKELY(!c)) {
+            c = new PathCounts[maxPathSlots]();
+            counts.store(c, std::memory_order_release);
+        }
+        return c;
+    }
+
+    std::atomic<PathCounts *> counts;
+};
+
+thread_local ThreadPathCounts threadPathCounts;
+
+size_t allocatePathSlot()
+{
+    std::unique_lock<std::mutex> guard(pathCountsMutex);
+    return numPathSlots++;
+}
+
 } // file scope
 
 void
@@ -133,7 +208,7 @@ setOptimizationRegex(const std::string & pathNameRegex,
 OptimizedPath::
 OptimizedPath(const std::string & name)
     : alwaysTake(true),
-      itl(new (storage) Itl(name), [] (Itl *) {})
+      itl(new (storage) Itl(name, allocatePathSlot()), [] (Itl *) {})
 {
     std::unique_lock<std::mutex> guard(pathRegistryMutex);
     // Initialize here to avoid problems if this library is initialized after
@@ -171,8 +246,7 @@ maybeTake() const
     else {
         result = rand_r(&itl->randSeed) < level;
     }
-    (result ? itl->eligibleAndTaken: itl->eligibleAndNotTaken)
-        .fetch_add(1, std::memory_order_relaxed);
+    count(true, result);
     return result;
 }
 
@@ -181,10 +255,82 @@ OptimizedPath::
 maybeTake(bool canTake) const
 {
     if (!canTake) {
-        itl->ineligible.fetch_add(1, std::memory_order_relaxed);
+        count(false, false);
         return false;
     }
     return maybeTake();
 }
 
+void
+OptimizedPath::
+count(bool eligible, bool taken) const
+{
+    size_t slot = itl->index;
+    if (MLDB_UNLIKELY(slot >= maxPathSlots))
+        return;
+    PathCounts & c = threadPathCounts.get()[slot];
+    if (!eligible)
+        c.ineligible += 1;
+    else if (taken)
+        c.taken += 1;
+    else
+        c.notTaken += 1;
+}
+
+std::vector<std::string>
+OptimizedPath::
+known()
+{
+    std::unique_lock<std::mutex> guard(pathRegistryMutex);
+    std::vector<std::string> result;
+    result.reserve(pathRegistry.size());
+    for (auto & p: pathRegistry)
+        result.push_back(p.first);
+    return result;
+}
+
+std::vector<OptimizedPath::Stats>
+OptimizedPath::
+stats()
+{
+    std::vector<Stats> result;
+    std::vector<size_t> slots;
+
+    {
+        std::unique_lock<std::mutex> guard(pathRegistryMutex);
+        result.reserve(pathRegistry.size());
+        for (auto & p: pathRegistry) {
+            Stats entry;
+            entry.name = p.first;
+            entry.level = p.second->itl->level;
+            entry.ineligible = entry.taken = entry.notTaken = 0;
+            slots.push_back(p.second->itl->index);
+            result.emplace_back(std::move(entry));
+        }
+    }
+
+    std::unique_lock<std::mutex> guard(pathCountsMutex);
+
+    auto accumulate = [&] (const PathCounts * counts) {
+        for (size_t i = 0;  i < result.size();  ++i) {
+            size_t slot = slots[i];
+            if (slot >= maxPathSlots)
+                continue;
+            result[i].ineligible += counts[slot].ineligible;
+            result[i].taken += counts[slot].taken;
+            result[i].notTaken += counts[slot].notTaken;
+        }
+    };
+
+    accumulate(retiredCounts);
+    for (auto * threadCounts: liveThreadCounts) {
+        const PathCounts * counts
+            = threadCounts->counts.load(std::memory_order_acquire);
+        if (counts)
+            accumulate(counts);
+    }
+
+    return result;
+}
+
 } // namespace MLDB
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "mldb/compiler/compiler.h"
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -38,8 +39,10 @@ struct OptimizedPath {
     {
         // Fast path, which will always be used in production.  Definitely
         // take the optimized path if it's optimized.
-        if (MLDB_LIKELY(alwaysTake.load(std::memory_order_relaxed)))
+        if (MLDB_LIKELY(alwaysTake.load(std::memory_order_relaxed))) {
+            count(canTake, canTake);
             return canTake;
+        }
 
         // Otherwise, lookup internally whether we should take it.  Slow
         // path
@@ -51,8 +54,10 @@ struct OptimizedPath {
     {
         // Fast path, which will always be used in production.  Definitely
         // take the optimized path.
-        if (MLDB_LIKELY(alwaysTake.load(std::memory_order_relaxed)))
+        if (MLDB_LIKELY(alwaysTake.load(std::memory_order_relaxed))) {
+            count(true, true);
             return true;
+        }
 
         // Otherwise, lookup internally whether we should take it.  Slow
         // path
@@ -103,6 +108,24 @@ struct OptimizedPath {
     /** List the known optimization levels. */
     static std::vector<std::string> known();
 
+    /** Per-path usage statistics, accumulated in cheap per-thread
+        counters on every call to take().  These reveal which optimized
+        paths actually engage on a given workload: a path whose taken
+        count stays at zero in production is dead weight or has an
+        eligibility test that never passes. */
+    struct Stats {
+        std::string name;     ///< registered path name
+        int level;            ///< current frequency (ALWAYS, NEVER, ...)
+        uint64_t ineligible;  ///< calls where canTake was false
+        uint64_t taken;       ///< eligible calls that took the fast path
+        uint64_t notTaken;    ///< eligible calls that took the slow path
+    };
+
+    /** Snapshot the statistics of all registered paths.  The counters
+        are read without synchronizing with the counting threads, so the
+        numbers are approximate; they are meant for diagnostics. */
+    static std::vector<Stats> stats();
+
 private:
     bool maybeTake() const;
 
@@ -111,6 +134,10 @@ private:
     */
     bool maybeTake(bool canTake) const;
 
+    /** Bump this path's per-thread counters: ineligible when "eligible"
+        is false, otherwise taken or not taken. */
+    void count(bool eligible, bool taken) const;
+
     /** Perform the actual work to set the optimization level. */
     static void setOptimization(OptimizedPath * path, int frequency);
 
@@ -9,7 +9,9 @@
 #include "mldb/compiler/compiler.h"
 #include "mldb/base/exc_assert.h"
 #include "thread_pool.h"
+#include "work_class.h"
 #include <atomic>
+#include <chrono>
 #include <mutex>
 
 namespace MLDB {
@@ -34,6 +36,11 @@ void parallelMap(size_t first, size_t last,
     if (occupancyLimit > (last - first))
         occupancyLimit = (last - first);
 
+    // Admission control: while other work classes are busy, this call is
+    // squeezed to its class's weighted share of the CPUs
+    WorkClassLease lease(occupancyLimit);
+    occupancyLimit = lease.allowed();
+
     auto worker = [&] ()
         {
             while (!hasException.load(std::memory_order_relaxed)) {
@@ -85,6 +92,10 @@ bool parallelMapHaltable(size_t first, size_t last,
     if (occupancyLimit > (last - first))
         occupancyLimit = (last - first);
 
+    // Admission control, as in parallelMap()
+    WorkClassLease lease(occupancyLimit);
+    occupancyLimit = lease.allowed();
+
     auto worker = [&] ()
         {
             while (!stop.load(std::memory_order_relaxed)
@@ -128,31 +139,85 @@ void parallelMapChunked(size_t first, size_t last, size_t chunkSize,
                         const std::function<void (size_t, size_t)> & doWork,
                         int occupancyLimit)
 {
-    ExcAssertGreater(chunkSize, 0);
     ExcAssertGreater(last, first);
+
+    // A chunkSize of zero asks us to tune the chunk size ourselves, by
+    // sampling how long chunks take and aiming for a fixed quantum of
+    // work per chunk.
+    bool adaptive = (chunkSize == 0);
+
+    // Start small so the first samples come back quickly; bad guesses
+    // here cost us a handful of cheap chunks at most.
+    static constexpr size_t ADAPTIVE_INITIAL_CHUNK = 16;
+    static constexpr size_t ADAPTIVE_MAX_CHUNK = 1ULL << 20;
+    static constexpr double ADAPTIVE_QUANTUM_SECONDS = 0.001;
+
+    if (adaptive)
+        chunkSize = std::min(ADAPTIVE_INITIAL_CHUNK, last - first);
+
     ExcAssertLess((last - first) / chunkSize, 1ULL << 31);
 
     std::atomic<int> hasException(0);
     std::atomic<size_t> index(first);
+    std::atomic<size_t> currentChunkSize(chunkSize);
     std::exception_ptr exc;
 
     // This creates a thread pool that runs jobs on the default thread pool
     ThreadPool tp;
-    
+
     if (occupancyLimit == -1)
         occupancyLimit = numCpus();
     if (occupancyLimit > (last - first + chunkSize - 1) / chunkSize)
         occupancyLimit = (last - first + chunkSize - 1) / chunkSize;
 
+    // Admission control, as in parallelMap()
+    WorkClassLease lease(occupancyLimit);
+    occupancyLimit = lease.allowed();
+
     auto worker = [&] ()
         {
             while (!hasException.load(std::memory_order_relaxed)) {
-                size_t myindex = index.fetch_add(chunkSize);
+                size_t mychunk = currentChunkSize.load(std::memory_order_relaxed);
+                size_t myindex = index.fetch_add(mychunk);
                 if (myindex >= last)
                     return;
-                size_t indexEnd = std::min(last, myindex + chunkSize);
+                size_t indexEnd = std::min(last, myindex + mychunk);
                 try {
-                    doWork(myindex, indexEnd);
+                    if (adaptive) {
+                        auto before = std::chrono::steady_clock::now();
+                        doWork(myindex, indexEnd);
+                        std::chrono::duration<double> elapsed
+                            = std::chrono::steady_clock::now() - before;
+
+                        // Re-size towards the quantum based on the
+                        // per-item cost we just observed.  Growth is
+                        // limited to 2x per observation so that one
+                        // anomalously cheap chunk can't blow the size
+                        // up, which keeps the feedback loop stable on
+                        // skewed workloads.
+                        double perItem = elapsed.count() / (indexEnd - myindex);
+                        size_t desired = mychunk * 2;
+                        if (perItem > 0)
+                            desired = std::min<size_t>
+                                (desired, ADAPTIVE_QUANTUM_SECONDS / perItem);
+                        desired = std::max<size_t>(desired, 1);
+                        desired = std::min(desired, ADAPTIVE_MAX_CHUNK);
+
+                        // Near the end of the range, shrink so that the
+                        // remaining work can still be spread over all
+                        // of the workers.
+                        size_t remaining
+                            = last - std::min(last, index.load(std::memory_order_relaxed));
+                        size_t tailCap
+                            = std::max<size_t>(1, remaining / (2 * occupancyLimit + 1));
+                        desired = std::min(desired, tailCap);
+
+                        currentChunkSize.store(desired,
+                                               std::memory_order_relaxed);
+                    }
+                    else {
+                        doWork(myindex, indexEnd);
+                    }
                 } MLDB_CATCH_ALL {
                     if (hasException.fetch_add(1) == 0) {
                         ExcAssert(!exc);
@@ -50,6 +50,16 @@ bool parallelMapHaltable(size_t first, size_t last,
 /** Same as parallelMap, except that each doWork() call will be passed
     a chunk of work of chunkSize.  This is useful to reduce the amount
     of calling overhead on a very fine-grained job.
+
+    Passing a chunkSize of zero enables adaptive chunking: the chunk
+    size starts small, the wall time of completed chunks is sampled,
+    and subsequent chunks are re-sized so that each one takes roughly
+    a fixed quantum (about one millisecond) to run.  This avoids both
+    drowning in scheduling overhead on cheap items and stragglers on
+    expensive ones, without requiring the caller to guess a size.
+    Near the end of the range the chunk size is additionally capped by
+    the work remaining, so that the tail stays well balanced even on
+    skewed workloads.
 */
 void parallelMapChunked(size_t first, size_t last, size_t chunkSize,
                         const std::function<void (size_t, size_t)> & doWork,
@@ -218,6 +218,115 @@ expect_text(const char * delimiters, bool allow_empty, const char * error)
     return result;
 }
 
+void
+ParseContext::
+advance_bulk(const char * newPos)
+{
+    // Replicate the line/column bookkeeping of operator ++ for the whole
+    // range at once: each newline starts a new line with the newline
+    // itself as its first column
+    const char * p = cur_;
+    for (;;) {
+        const char * nl = (const char *)memchr(p, '\n', newPos - p);
+        if (!nl)
+            break;
+        ++line_;
+        col_ = 1;
+        p = nl + 1;
+    }
+    col_ += newPos - p;
+    ofs_ += newPos - cur_;
+    cur_ = newPos;
+
+    if (cur_ == ebuf_)
+        next_buffer();
+}
+
+bool
+ParseContext::
+skip_to_char(char c, std::string * skipped)
+{
+    for (;;) {
+        if (eof())
+            return false;
+        const char * found
+            = (const char *)memchr(cur_, c, ebuf_ - cur_);
+        const char * stop = found ? found : ebuf_;
+        if (skipped)
+            skipped->append(cur_, stop);
+        advance_bulk(stop);
+        if (found)
+            return true;
+    }
+}
+
+char
+ParseContext::
+skip_to_either(char c1, char c2)
+{
+    for (;;) {
+        if (eof())
+            return 0;
+        const char * found1
+            = (const char *)memchr(cur_, c1, ebuf_ - cur_);
+        const char * limit = found1 ? found1 : ebuf_;
+        const char * found2
+            = (const char *)memchr(cur_, c2, limit - cur_);
+        const char * stop = found2 ? found2 : limit;
+        advance_bulk(stop);
+        if (found2)
+            return c2;
+        if (found1)
+            return c1;
+    }
+}
+
+size_t
+ParseContext::
+match_run_of_class(const bool * table, char * out, size_t outSize)
+{
+    size_t done = 0;
+    while (done < outSize && !eof()) {
+        const char * p = cur_;
+        const char * e = ebuf_;
+        if ((size_t)(e - p) > outSize - done)
+            e = p + (outSize - done);
+        while (p < e && table[(unsigned char)*p])
+            ++p;
+        if (p == cur_)
+            break;  // cursor is on a byte outside the class
+        memcpy(out + done, cur_, p - cur_);
+        done += p - cur_;
+        bool wholeBuffer = (p == ebuf_);
+        advance_bulk(p);
+        if (!wholeBuffer && p < e)
+            break;  // stopped on a byte outside the class
+    }
+    return done;
+}
+
+size_t
+ParseContext::
+match_run_of_class(const bool * table, std::string & out)
+{
+    size_t done = 0;
+    while (!eof()) {
+        const char * p = cur_;
+        const char * e = ebuf_;
+        while (p < e && table[(unsigned char)*p])
+            ++p;
+        if (p == cur_)
+            break;
+        out.append(cur_, p);
+        done += p - cur_;
+        bool wholeBuffer = (p == ebuf_);
+        advance_bulk(p);
+        if (!wholeBuffer)
+            break;
+    }
+    return done;
+}
+
 bool
 ParseContext::
 match_int(int & val_, int min, int max)
@@ -285,7 +285,33 @@ struct ParseContext {
     std::string expect_text(const char * delimiters,
                             bool allow_empty = true,
                             const char * error = "expected text");
-    
+
+    /** Advance to the next occurrence of the given character, scanning a
+        whole buffer at a time (via memchr) rather than byte by byte.  If
+        skipped is non-null the characters passed over are appended to it.
+        Returns true with the cursor on the character if it was found, or
+        false with the cursor at EOF if it wasn't.  Never throws.
+    */
+    bool skip_to_char(char c, std::string * skipped = nullptr);
+
+    /** Advance to the first occurrence of either of the given characters,
+        scanning a whole buffer at a time like skip_to_char.  Returns the
+        character found with the cursor on it, or 0 with the cursor at EOF
+        if neither occurs.  Never throws.
+    */
+    char skip_to_either(char c1, char c2);
+
+    /** Advance over the run of characters whose byte values are marked
+        true in the given 256 entry table, copying them into out.  Stops
+        at the first byte outside the class, at EOF, or once outSize
+        bytes have been produced; returns the number of bytes copied.
+        Scans a whole buffer at a time.  Never throws.
+    */
+    size_t match_run_of_class(const bool * table, char * out, size_t outSize);
+
+    /** Same, but appending the run to a string, with no length limit. */
+    size_t match_run_of_class(const bool * table, std::string & out);
+
     bool match_int(int & val, int min = -INT_MAX, int max = INT_MAX);
     
     int expect_int(int min = -INT_MAX, int max = INT_MAX,
@@ -726,6 +752,12 @@ private:
         necessary. */
     void next_buffer();
 
+    /** Move the cursor forwards to the given position, which must be
+        within the current buffer, updating the offset and line/column
+        bookkeeping in bulk, and pulling in the next buffer if we land
+        on the end of this one. */
+    void advance_bulk(const char * newPos);
+
     /** Go to a given offset.  It must be within the current set of buffers. */
     void goto_ofs(uint64_t ofs, size_t line, size_t col,
                   bool in_destructor = false);
@@ -10,7 +10,9 @@
 #pragma once
 
 #include "mldb/arch/thread_specific.h"
+#include "mldb/base/exc_assert.h"
 #include <functional>
+#include <memory>
 #include <vector>
 #include <thread>
 
@@ -11,6 +11,7 @@
 #include "thread_pool_impl.h"
 #include "mldb/arch/thread_specific.h"
 #include "mldb/arch/demangle.h"
+#include "mldb/arch/numa_info.h"
 #include "mldb/utils/environment.h"
 #include <atomic>
 #include <condition_variable>
@@ -18,6 +19,11 @@
 #include <thread>
 #include <iostream>
 
+#ifdef __linux__
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
 
 using namespace std;
 
@@ -27,6 +33,13 @@ namespace MLDB {
 static EnvOption<int, true /* trace */>
 NUM_CPUS("NUM_CPUS", std::thread::hardware_concurrency());
 
+/// If set, worker threads are pinned to the CPUs of a single NUMA node,
+/// spread round-robin across nodes.  Workers then never migrate across
+/// sockets mid-scan, and (since allocations are placed on first touch)
+/// the memory a worker fills stays on its own node.
+static EnvOption<int, true /* trace */>
+THREAD_POOL_NUMA_BIND("THREAD_POOL_NUMA_BIND", 0);
+
 int numCpus()
 {
     return NUM_CPUS;
@@ -113,6 +126,24 @@ struct ThreadPool::Itl: public std::enable_shared_from_this<ThreadPool::Itl> {
 
         /// The last queue number we found work in
         int lastFound;
+
+        /// Per-thread pseudo-random state, used to choose steal victims.
+        /// Seeded per-entry so that threads don't probe in lock-step.
+        uint32_t rngState = 0;
+
+        /// Cheap xorshift32 generator; quality is unimportant here, we
+        /// just need different threads to visit victims in different
+        /// orders.
+        uint32_t rng()
+        {
+            uint32_t x = rngState;
+            if (x == 0)
+                x = uint32_t(reinterpret_cast<uintptr_t>(this) >> 4) | 1;
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            return rngState = x;
+        }
     };
 
     /// This allows us to have one threadEntry per thread
@@ -427,22 +458,31 @@ struct ThreadPool::Itl: public std::enable_shared_from_this<ThreadPool::Itl> {
             };
 
         size_t nq = entry.queues->size();
+        if (nq == 0)
+            return false;
 
-        if (entry.lastFound > 0 && entry.lastFound < nq) {
+        // First, go back to the last queue we found work in; a thread
+        // that produces lots of work will usually still have more.
+        if (entry.lastFound >= 0 && entry.lastFound < nq) {
             stealFrom(entry.lastFound);
+            if (foundWork)
+                return true;
+        }
+
+        // Randomized victim selection.  Probing queues in a per-thread
+        // random order avoids the convoy that forms when all idle
+        // threads scan the list from the same starting point and end up
+        // contending on the same victim's top_ counter.
+        for (unsigned i = 0;  i < 2 * nq && !shutdown && !foundWork;  ++i) {
+            stealFrom(entry.rng() % nq);
         }
 
-        for (unsigned i = 0;  i < nq && !shutdown;  ++i) {
-            // Try to avoid all threads starting looking for work at the
-            // same place.
-            int n = entry.lastFound + i;
-            while (n < 0)
-                n += nq;
-            while (n >= nq)
-                n -= nq;
+        // Fall back to a full sweep so that we can't systematically miss
+        // a queue that does have work in it.
+        for (unsigned n = 0;  n < nq && !shutdown && !foundWork;  ++n) {
             stealFrom(n);
         }
-        
+
         return foundWork;
     }
 
@@ -515,9 +555,37 @@ struct ThreadPool::Itl: public std::enable_shared_from_this<ThreadPool::Itl> {
         return result;
     }
 
+    /** Pin the calling worker thread to the CPUs of one NUMA node, with
+        workers spread round-robin across nodes.  A no-op on single-node
+        machines and on platforms without thread affinity support.
+    */
+    static void bindWorkerToNumaNode(int workerNum)
+    {
+#ifdef __linux__
+        const auto & topology = numaTopology();
+        if (topology.size() < 2)
+            return;
+
+        const NumaNode & node = topology[workerNum % topology.size()];
+
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu: node.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE)
+                CPU_SET(cpu, &cpus);
+        }
+
+        // Best effort; if it fails the worker simply stays unpinned
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#endif
+    }
+
     /** Run a worker thread. */
     void runWorker(int workerNum)
     {
+        if (THREAD_POOL_NUMA_BIND)
+            bindWorkerToNumaNode(workerNum);
+
         ThreadEntry & entry = getEntry(workerNum);
 
         int itersWithNoWork = 0;
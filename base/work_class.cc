@@ -0,0 +1,165 @@
+/** work_class.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Weighted work classes for admission control of parallel work.
+*/
+
+#include "work_class.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+using namespace std;
+
+
+namespace MLDB {
+
+namespace {
+
+struct WorkClass {
+    std::string name;
+    int weight = 1;
+    int maxConcurrency = -1;
+    int running = 0;
+    uint64_t admitted = 0;
+    uint64_t throttled = 0;
+};
+
+struct WorkClassRegistry {
+    WorkClassRegistry()
+    {
+        // Interactive work (REST queries) gets most of the machine when
+        // it has to share with batch work (procedure runs)
+        configure("interactive", 4, -1);
+        configure("batch", 1, -1);
+    }
+
+    std::mutex lock;
+    std::map<std::string, WorkClass> classes;
+
+    WorkClass & configure(const std::string & name,
+                          int weight, int maxConcurrency)
+    {
+        WorkClass & cls = classes[name];
+        cls.name = name;
+        cls.weight = std::max(1, weight);
+        cls.maxConcurrency = maxConcurrency;
+        return cls;
+    }
+
+    static WorkClassRegistry & instance()
+    {
+        static WorkClassRegistry result;
+        return result;
+    }
+};
+
+thread_local std::string threadWorkClass = "interactive";
+
+} // file scope
+
+void
+configureWorkClass(const std::string & name,
+                   int weight,
+                   int maxConcurrency)
+{
+    auto & registry = WorkClassRegistry::instance();
+    std::unique_lock<std::mutex> guard(registry.lock);
+    registry.configure(name, weight, maxConcurrency);
+}
+
+std::vector<WorkClassStats>
+getWorkClassStats()
+{
+    auto & registry = WorkClassRegistry::instance();
+    std::unique_lock<std::mutex> guard(registry.lock);
+
+    std::vector<WorkClassStats> result;
+    result.reserve(registry.classes.size());
+    for (auto & entry: registry.classes) {
+        const WorkClass & cls = entry.second;
+        result.push_back({cls.name, cls.weight, cls.maxConcurrency,
+                          cls.running, cls.admitted, cls.throttled});
+    }
+    return result;
+}
+
+const std::string &
+currentWorkClass()
+{
+    return threadWorkClass;
+}
+
+
+/*****************************************************************************/
+/* SCOPED WORK CLASS                                                         */
+/*****************************************************************************/
+
+ScopedWorkClass::
+ScopedWorkClass(std::string name)
+    : saved(std::move(threadWorkClass))
+{
+    threadWorkClass = std::move(name);
+}
+
+ScopedWorkClass::
+~ScopedWorkClass()
+{
+    threadWorkClass = std::move(saved);
+}
+
+
+/*****************************************************************************/
+/* WORK CLASS LEASE                                                          */
+/*****************************************************************************/
+
+WorkClassLease::
+WorkClassLease(int requested)
+{
+    auto & registry = WorkClassRegistry::instance();
+    std::unique_lock<std::mutex> guard(registry.lock);
+
+    auto it = registry.classes.find(threadWorkClass);
+    if (it == registry.classes.end())
+        it = registry.classes
+            .emplace(threadWorkClass,
+                     WorkClass{threadWorkClass, 1, -1})
+            .first;
+    WorkClass & mine = it->second;
+
+    // The weighted share only considers classes that are actually busy;
+    // a class alone on the machine gets all of it
+    int totalWeight = mine.weight;
+    for (auto & entry: registry.classes) {
+        if (&entry.second != &mine && entry.second.running > 0)
+            totalWeight += entry.second.weight;
+    }
+
+    int share = std::max(1, numCpus() * mine.weight / totalWeight);
+    if (mine.maxConcurrency >= 0)
+        share = std::min(share, std::max(1, mine.maxConcurrency));
+
+    // Never admit zero workers: the caller runs at least serially
+    allowed_ = std::max(1, std::min(requested, share - mine.running));
+
+    mine.running += allowed_;
+    ++mine.admitted;
+    if (allowed_ < requested)
+        ++mine.throttled;
+
+    cls = &mine;
+}
+
+WorkClassLease::
+~WorkClassLease()
+{
+    auto & registry = WorkClassRegistry::instance();
+    std::unique_lock<std::mutex> guard(registry.lock);
+    reinterpret_cast<WorkClass *>(cls)->running -= allowed_;
+}
+
+} // namespace MLDB
@@ -0,0 +1,90 @@
+/** work_class.h                                                   -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Weighted work classes for admission control of parallel work.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace MLDB {
+
+/** All parallel work funnels into the one global ThreadPool, so a single
+    large batch job (a 300M row GROUP BY, say) can starve latency-critical
+    point queries of workers.  Work classes put a first scheduling level in
+    front of the pool: each class has a weight and an optional hard
+    concurrency cap, and when several classes are busy at once each one is
+    admitted at most its weighted share of the CPUs.  A class alone on the
+    machine still gets everything; the squeeze only appears under
+    contention, and no class is ever pushed below one worker.
+
+    The calling thread's class is ambient: it defaults to "interactive"
+    and is changed for a scope with ScopedWorkClass.  parallelMap and
+    friends take a WorkClassLease where they decide their occupancy, which
+    is where the shares are enforced.
+*/
+
+/** Point-in-time view of one work class, for the admin surface. */
+struct WorkClassStats {
+    std::string name;
+    int weight = 1;
+    int maxConcurrency = -1;    ///< -1 means no explicit cap
+    int running = 0;            ///< workers currently admitted
+    uint64_t admitted = 0;      ///< total admission requests
+    uint64_t throttled = 0;     ///< requests given fewer workers than asked
+};
+
+/** Create the named class or update its weight and cap in place.  Takes
+    effect for the next admission; running work is not preempted.  The
+    weight is clamped to at least 1.
+*/
+void configureWorkClass(const std::string & name,
+                        int weight,
+                        int maxConcurrency = -1);
+
+/** Return a snapshot of every configured class. */
+std::vector<WorkClassStats> getWorkClassStats();
+
+/** Return the name of the calling thread's current work class. */
+const std::string & currentWorkClass();
+
+/** Set the calling thread's work class for the lifetime of the object.
+    An unknown name creates the class with weight 1 and no cap.
+*/
+struct ScopedWorkClass {
+    explicit ScopedWorkClass(std::string name);
+    ~ScopedWorkClass();
+
+    ScopedWorkClass(const ScopedWorkClass &) = delete;
+    void operator = (const ScopedWorkClass &) = delete;
+
+private:
+    std::string saved;
+};
+
+/** Admission of up to 'requested' workers against the calling thread's
+    work class, released on destruction.  allowed() is always at least
+    one, so a class under heavy contention degrades to serial execution
+    rather than blocking.
+*/
+struct WorkClassLease {
+    explicit WorkClassLease(int requested);
+    ~WorkClassLease();
+
+    WorkClassLease(const WorkClassLease &) = delete;
+    void operator = (const WorkClassLease &) = delete;
+
+    int allowed() const { return allowed_; }
+
+private:
+    int allowed_;
+    void * cls;   ///< opaque pointer to the class record
+};
+
+} // namespace MLDB
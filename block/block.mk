@@ -3,9 +3,12 @@
 LIBBLOCK_SOURCES:= \
 	memory_region.cc \
 	zip_serializer.cc \
+	block_compressed_region.cc \
 	file_serializer.cc \
 	content_descriptor.cc \
 	content.cc \
+	uring_block_reader.cc \
+	decoded_block_cache.cc \
 
 $(eval $(call library,block,$(LIBBLOCK_SOURCES),vfs $(LIBARCHIVE_LIB_NAME) types arch db base value_description any))
 
@@ -0,0 +1,399 @@
+/** block_compressed_region.cc
+    Jeremy Barnes, 30 August 2026
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Implementation of the seekable compressed container format.
+*/
+
+#include "block_compressed_region.h"
+#include "mldb/vfs/compressor.h"
+#include "mldb/types/annotated_exception.h"
+#include "mldb/base/exc_assert.h"
+#include <cstring>
+
+using namespace std;
+
+namespace MLDB {
+
+namespace {
+
+static constexpr char BCR_MAGIC[8]
+    = { 'M', 'L', 'D', 'B', 'S', 'B', 'C', '1' };
+
+/** Fixed-size trailer at the very end of the container.  The leading
+    magic allows the format to be identified from the first bytes of a
+    file; the trailing copy allows the footer to be located without
+    knowing anything but the container length.
+*/
+struct BCRTrailer {
+    uint64_t indexOffset;    ///< Container offset of the frame index
+    uint64_t numBlocks;      ///< Number of compressed frames
+    uint64_t blockSize;      ///< Decompressed bytes per block (except last)
+    uint64_t totalSize;      ///< Total decompressed bytes
+    char compression[24];    ///< NUL-padded compression scheme name
+    char magic[8];           ///< BCR_MAGIC
+};
+
+static_assert(sizeof(BCRTrailer) == 64, "trailer layout changed");
+
+} // file scope
+
+
+/*****************************************************************************/
+/* BLOCK COMPRESSED REGION WRITER                                            */
+/*****************************************************************************/
+
+BlockCompressedRegionWriter::
+BlockCompressedRegionWriter(std::ostream & out,
+                            const std::string & compression,
+                            int level,
+                            size_t blockSize)
+    : out(out), compression(compression), level(level), blockSize(blockSize)
+{
+    if (blockSize == 0) {
+        throw AnnotatedException
+            (400, "Block compressed region needs a non-zero block size");
+    }
+    if (compression.size() >= sizeof(BCRTrailer::compression)) {
+        throw AnnotatedException
+            (400, "Compression scheme name '" + compression
+             + "' too long for block compressed region trailer");
+    }
+
+    // Fail now, not on the first full block, if the scheme is unknown
+    std::unique_ptr<Compressor> probe(Compressor::create(compression, level));
+    if (!probe) {
+        throw AnnotatedException
+            (400, "Unknown compression scheme '" + compression
+             + "' for block compressed region");
+    }
+
+    out.write(BCR_MAGIC, sizeof(BCR_MAGIC));
+    written = sizeof(BCR_MAGIC);
+}
+
+BlockCompressedRegionWriter::
+~BlockCompressedRegionWriter()
+{
+}
+
+void
+BlockCompressedRegionWriter::
+write(const char * data, size_t len)
+{
+    ExcAssert(!finished);
+
+    while (len > 0) {
+        if (current.empty() && len >= blockSize) {
+            // Full block straight from the caller's buffer
+            compressBlock(data, blockSize);
+            data += blockSize;
+            len -= blockSize;
+            continue;
+        }
+
+        size_t toBuffer = std::min(len, blockSize - current.size());
+        current.append(data, toBuffer);
+        data += toBuffer;
+        len -= toBuffer;
+
+        if (current.size() == blockSize) {
+            compressBlock(current.data(), current.size());
+            current.clear();
+        }
+    }
+}
+
+void
+BlockCompressedRegionWriter::
+compressBlock(const char * data, size_t len)
+{
+    frameOffsets.push_back(written);
+
+    // Each block gets a fresh compressor so its frame is decodable on
+    // its own.
+    std::unique_ptr<Compressor> compressor
+        (Compressor::create(compression, level));
+    ExcAssert(compressor);
+
+    auto onData = [&] (const char * data, size_t len) -> size_t
+        {
+            out.write(data, len);
+            if (!out) {
+                throw AnnotatedException
+                    (500, "Error writing block compressed region");
+            }
+            written += len;
+            return len;
+        };
+
+    compressor->notifyInputSize(len);
+    compressor->compress(data, len, onData);
+    compressor->finish(onData);
+
+    totalSize += len;
+}
+
+void
+BlockCompressedRegionWriter::
+finish()
+{
+    ExcAssert(!finished);
+
+    if (!current.empty()) {
+        compressBlock(current.data(), current.size());
+        current.clear();
+    }
+
+    BCRTrailer trailer;
+    std::memset(&trailer, 0, sizeof(trailer));
+    trailer.indexOffset = written;
+    trailer.numBlocks = frameOffsets.size();
+    trailer.blockSize = blockSize;
+    trailer.totalSize = totalSize;
+    std::memcpy(trailer.compression, compression.data(), compression.size());
+    std::memcpy(trailer.magic, BCR_MAGIC, sizeof(BCR_MAGIC));
+
+    for (uint64_t offset: frameOffsets) {
+        out.write((const char *)&offset, sizeof(offset));
+    }
+    out.write((const char *)&trailer, sizeof(trailer));
+    if (!out) {
+        throw AnnotatedException
+            (500, "Error writing block compressed region footer");
+    }
+
+    finished = true;
+}
+
+
+/*****************************************************************************/
+/* BLOCK COMPRESSED REGION                                                   */
+/*****************************************************************************/
+
+struct BlockCompressedRegion::Itl {
+    Itl(FrozenMemoryRegion container_)
+        : container(std::move(container_))
+    {
+        if (container.length() < sizeof(BCR_MAGIC) + sizeof(BCRTrailer)
+            || std::memcmp(container.data(), BCR_MAGIC,
+                           sizeof(BCR_MAGIC)) != 0) {
+            throw AnnotatedException
+                (500, "Not a block compressed region container");
+        }
+
+        std::memcpy(&trailer,
+                    container.data() + container.length() - sizeof(trailer),
+                    sizeof(trailer));
+        if (std::memcmp(trailer.magic, BCR_MAGIC, sizeof(BCR_MAGIC)) != 0) {
+            throw AnnotatedException
+                (500, "Truncated or corrupt block compressed region "
+                 "(bad trailer magic)");
+        }
+        compression = std::string
+            (trailer.compression,
+             strnlen(trailer.compression, sizeof(trailer.compression)));
+
+        uint64_t indexBytes = trailer.numBlocks * sizeof(uint64_t);
+        if (trailer.indexOffset + indexBytes + sizeof(trailer)
+                != container.length()
+            || (trailer.numBlocks != 0 && trailer.blockSize == 0)) {
+            throw AnnotatedException
+                (500, "Truncated or corrupt block compressed region "
+                 "(inconsistent index)");
+        }
+
+        // Copy the index out rather than pointing into the container:
+        // it is small, and nothing guarantees its alignment after a
+        // run of variable length frames.
+        frameOffsets.resize(trailer.numBlocks + 1);
+        std::memcpy(frameOffsets.data(),
+                    container.data() + trailer.indexOffset, indexBytes);
+        frameOffsets.back() = trailer.indexOffset;
+
+        uint64_t last = sizeof(BCR_MAGIC);
+        for (uint64_t offset: frameOffsets) {
+            if (offset < last || offset > container.length()) {
+                throw AnnotatedException
+                    (500, "Truncated or corrupt block compressed region "
+                     "(bad frame offset)");
+            }
+            last = offset;
+        }
+
+        // Fail now, not on the first access, if the scheme is unknown
+        std::unique_ptr<Decompressor> probe(Decompressor::create(compression));
+        if (!probe) {
+            throw AnnotatedException
+                (400, "Unknown compression scheme '" + compression
+                 + "' in block compressed region");
+        }
+    }
+
+    FrozenMemoryRegion getBlock(size_t blockNum) const
+    {
+        ExcAssertLess(blockNum, trailer.numBlocks);
+
+        size_t expected
+            = blockNum == trailer.numBlocks - 1
+            ? trailer.totalSize - blockNum * trailer.blockSize
+            : trailer.blockSize;
+
+        std::shared_ptr<char> buf(new char[expected],
+                                  [] (char * p) { delete[] p; });
+        size_t done = 0;
+
+        auto onData = [&] (const char * data, size_t len) -> size_t
+            {
+                if (done + len > expected) {
+                    throw AnnotatedException
+                        (500, "Corrupt block compressed region "
+                         "(block decompressed too large)");
+                }
+                std::memcpy(buf.get() + done, data, len);
+                done += len;
+                return len;
+            };
+
+        std::unique_ptr<Decompressor> decompressor
+            (Decompressor::create(compression));
+        ExcAssert(decompressor);
+        decompressor->decompress
+            (container.data() + frameOffsets[blockNum],
+             frameOffsets[blockNum + 1] - frameOffsets[blockNum],
+             onData);
+        decompressor->finish(onData);
+
+        if (done != expected) {
+            throw AnnotatedException
+                (500, "Corrupt block compressed region "
+                 "(block decompressed too small)");
+        }
+
+        return FrozenMemoryRegion(buf, buf.get(), expected);
+    }
+
+    FrozenMemoryRegion container;
+    BCRTrailer trailer;
+    std::string compression;
+    std::vector<uint64_t> frameOffsets;  ///< numBlocks + 1 entries
+};
+
+BlockCompressedRegion::
+BlockCompressedRegion(FrozenMemoryRegion container)
+    : itl(new Itl(std::move(container)))
+{
+}
+
+BlockCompressedRegion::
+~BlockCompressedRegion()
+{
+}
+
+uint64_t
+BlockCompressedRegion::
+length() const
+{
+    return itl->trailer.totalSize;
+}
+
+size_t
+BlockCompressedRegion::
+blockSize() const
+{
+    return itl->trailer.blockSize;
+}
+
+size_t
+BlockCompressedRegion::
+numBlocks() const
+{
+    return itl->trailer.numBlocks;
+}
+
+const std::string &
+BlockCompressedRegion::
+compression() const
+{
+    return itl->compression;
+}
+
+FrozenMemoryRegion
+BlockCompressedRegion::
+getBlock(size_t blockNum) const
+{
+    return itl->getBlock(blockNum);
+}
+
+FrozenMemoryRegion
+BlockCompressedRegion::
+getRange(uint64_t offset, int64_t length) const
+{
+    uint64_t totalSize = itl->trailer.totalSize;
+    if (length == -1) {
+        if (offset > totalSize) {
+            throw AnnotatedException
+                (400, "Block compressed region range starts past the end");
+        }
+        length = totalSize - offset;
+    }
+    if (offset + length > totalSize) {
+        throw AnnotatedException
+            (400, "Block compressed region range extends past the end");
+    }
+    if (length == 0) {
+        return FrozenMemoryRegion();
+    }
+
+    size_t blockSize = itl->trailer.blockSize;
+    size_t firstBlock = offset / blockSize;
+    size_t lastBlock = (offset + length - 1) / blockSize;
+
+    if (firstBlock == lastBlock) {
+        // Single block; return a subrange of it with no copying
+        return itl->getBlock(firstBlock)
+            .range(offset - firstBlock * blockSize,
+                   offset - firstBlock * blockSize + length);
+    }
+
+    std::shared_ptr<char> buf(new char[length],
+                              [] (char * p) { delete[] p; });
+
+    for (size_t blockNum = firstBlock;  blockNum <= lastBlock;  ++blockNum) {
+        FrozenMemoryRegion block = itl->getBlock(blockNum);
+        uint64_t blockStart = blockNum * (uint64_t)blockSize;
+
+        uint64_t copyFrom = std::max<uint64_t>(offset, blockStart);
+        uint64_t copyTo
+            = std::min<uint64_t>(offset + length,
+                                 blockStart + block.length());
+
+        std::memcpy(buf.get() + (copyFrom - offset),
+                    block.data() + (copyFrom - blockStart),
+                    copyTo - copyFrom);
+    }
+
+    return FrozenMemoryRegion(buf, buf.get(), length);
+}
+
+std::pair<uint64_t, FrozenMemoryRegion>
+BlockCompressedRegion::
+getRangeContaining(uint64_t offset, uint64_t length) const
+{
+    uint64_t totalSize = itl->trailer.totalSize;
+    if (offset >= totalSize) {
+        return { totalSize, FrozenMemoryRegion() };
+    }
+
+    size_t blockSize = itl->trailer.blockSize;
+    uint64_t end = std::min(offset + std::max<uint64_t>(length, 1),
+                            totalSize);
+
+    uint64_t startOffset = (offset / blockSize) * blockSize;
+    uint64_t endOffset
+        = std::min((((end - 1) / blockSize) + 1) * blockSize, totalSize);
+
+    return { startOffset, getRange(startOffset, endOffset - startOffset) };
+}
+
+} // namespace MLDB
@@ -0,0 +1,138 @@
+/** block_compressed_region.h                                      -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Seekable compressed container: fixed-size independently compressed
+    blocks followed by a footer index, so that a byte range of the
+    decompressed data can be materialized without decompressing from
+    the start.
+*/
+
+#pragma once
+
+#include "mldb/block/memory_region.h"
+#include <iostream>
+#include <vector>
+
+
+namespace MLDB {
+
+
+/*****************************************************************************/
+/* BLOCK COMPRESSED REGION WRITER                                            */
+/*****************************************************************************/
+
+/** Writes the seekable container format to a stream.
+
+    The layout is a magic number, then one independently compressed
+    frame per fixed-size block of input, then an index of the container
+    offset of each frame, then a fixed-size trailer recording where the
+    index is, the block size, the total decompressed size and the
+    compression scheme.  Everything needed to seek is at the end, so the
+    container can be written to a non-seekable stream (eg, a
+    StructuredSerializer entry or an S3 upload).
+*/
+
+struct BlockCompressedRegionWriter {
+    /** Write to the given stream with the given compression scheme and
+        level (-1 means the scheme's default).  blockSize is the number
+        of decompressed bytes per block; it bounds how much must be
+        decompressed to serve a one byte read.
+    */
+    BlockCompressedRegionWriter(std::ostream & out,
+                                const std::string & compression = "zstd",
+                                int level = -1,
+                                size_t blockSize = 1024 * 1024);
+
+    ~BlockCompressedRegionWriter();
+
+    /** Append bytes to the logical (decompressed) contents. */
+    void write(const char * data, size_t len);
+
+    void write(const FrozenMemoryRegion & region)
+    {
+        write(region.data(), region.length());
+    }
+
+    /** Compress any buffered partial block and write the index and
+        trailer.  Must be called exactly once; no writes are allowed
+        afterwards.
+    */
+    void finish();
+
+private:
+    void compressBlock(const char * data, size_t len);
+
+    std::ostream & out;
+    std::string compression;
+    int level;
+    size_t blockSize;
+    std::string current;              ///< Partially filled block
+    std::vector<uint64_t> frameOffsets; ///< Container offset of each frame
+    uint64_t written = 0;             ///< Container bytes written so far
+    uint64_t totalSize = 0;           ///< Decompressed bytes accepted so far
+    bool finished = false;
+};
+
+
+/*****************************************************************************/
+/* BLOCK COMPRESSED REGION                                                   */
+/*****************************************************************************/
+
+/** Random access reader over a container produced by
+    BlockCompressedRegionWriter.
+
+    It is constructed over the raw container bytes, which need only be
+    addressable, not resident: a region returned by
+    StructuredReconstituter::getRegion() or by mapFile() over a remote
+    object works, and serving a range then touches only the frames that
+    cover it plus the footer.
+*/
+
+struct BlockCompressedRegion {
+    /** Construct from the raw container bytes.  Reads only the trailer
+        and the index; throws if the container is malformed or the
+        compression scheme is unknown.
+    */
+    BlockCompressedRegion(FrozenMemoryRegion container);
+
+    ~BlockCompressedRegion();
+
+    /** Total decompressed length in bytes. */
+    uint64_t length() const;
+
+    /** Decompressed bytes per block (the last block may be shorter). */
+    size_t blockSize() const;
+
+    size_t numBlocks() const;
+
+    /** Compression scheme the container was written with. */
+    const std::string & compression() const;
+
+    /** Decompress the given block; blockNum must be less than
+        numBlocks().
+    */
+    FrozenMemoryRegion getBlock(size_t blockNum) const;
+
+    /** Return the given byte range of the decompressed contents,
+        decompressing only the blocks that cover it.  A length of -1
+        means to the end.  Throws if the range extends past the end.
+    */
+    FrozenMemoryRegion getRange(uint64_t offset, int64_t length = -1) const;
+
+    /** Return the block-aligned range containing the given range, and
+        the offset of its first byte, following the
+        ContentHandler::getRangeContaining() contract (in particular, a
+        request entirely past the end returns { length(), {} }).
+        Callers that cache decoded blocks should prefer this to
+        getRange() as it always returns whole blocks.
+    */
+    std::pair<uint64_t, FrozenMemoryRegion>
+    getRangeContaining(uint64_t offset, uint64_t length) const;
+
+private:
+    struct Itl;
+    std::shared_ptr<Itl> itl;
+};
+
+} // namespace MLDB
@@ -15,6 +15,10 @@
 #include "mldb/vfs/compressor.h"
 #include "mldb/watch/watch_impl.h"
 #include "mldb/base/thread_pool.h"
+#include "mldb/block/uring_block_reader.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 
 using namespace std;
@@ -633,7 +637,80 @@ struct UrlContentHandler
     {
         return ADV_UNKNOWN;
     }
-    
+
+    virtual bool
+    forEachBlockParallel(uint64_t startOffset,
+                         uint64_t requestedBlockSize,
+                         int maxParallelism,
+                         std::function<bool (size_t, uint64_t,
+                                             FrozenMemoryRegion)> fn)
+        const override
+    {
+        // For local files, read the blocks through io_uring with a deep
+        // queue rather than one synchronous range at a time; a single
+        // reader leaves most of an NVMe device's bandwidth unused.
+        // Blocks complete out of order and are handed straight to the
+        // worker group.
+        Url url = descriptor.getUrl();
+        if (maxParallelism != 1
+            && url.scheme() == "file"
+            && UringBlockReader::isAvailable()) {
+
+            int fd = ::open(url.path().c_str(), O_RDONLY);
+            if (fd != -1) {
+                struct stat st;
+                if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+                    ::close(fd);
+                }
+                else {
+                    uint64_t size = st.st_size;
+                    if (startOffset >= size) {
+                        ::close(fd);
+                        return true;
+                    }
+
+                    std::atomic<bool> finished(false);
+                    ThreadWorkGroup tp(maxParallelism);
+                    UringBlockReader reader(fd);
+
+                    auto onBlock = [&] (size_t blockNum,
+                                        uint64_t blockOffset,
+                                        FrozenMemoryRegion block)
+                        {
+                            auto processBlock
+                                = [blockNum, blockOffset,
+                                   block = std::move(block),
+                                   &fn, &finished] ()
+                                {
+                                    if (!fn(blockNum, blockOffset, block))
+                                        finished = true;
+                                };
+                            tp.add(std::move(processBlock));
+                            return !finished && !tp.hasException();
+                        };
+
+                    bool res;
+                    try {
+                        res = reader.forEachBlock(startOffset,
+                                                  size - startOffset,
+                                                  requestedBlockSize,
+                                                  onBlock);
+                        tp.waitForAll();
+                    } catch (...) {
+                        ::close(fd);
+                        throw;
+                    }
+                    ::close(fd);
+                    return res && !finished;
+                }
+            }
+        }
+
+        return ContentHandler::forEachBlockParallel(startOffset,
+                                                    requestedBlockSize,
+                                                    maxParallelism, fn);
+    }
+
     virtual FrozenMemoryRegion
     getRange(uint64_t offset, int64_t length) const override
     {
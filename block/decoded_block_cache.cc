@@ -0,0 +1,275 @@
+/** decoded_block_cache.cc
+    Jeremy Barnes, 30 August 2026
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Implementation of the process-wide decoded block cache.
+*/
+
+#include "decoded_block_cache.h"
+#include "mldb/utils/environment.h"
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+
+
+using namespace std;
+
+
+namespace MLDB {
+
+namespace {
+
+EnvOption<int> BLOCK_CACHE_SIZE_MB("BLOCK_CACHE_SIZE_MB", 512);
+
+/// Mix an (owner, index) pair down to a 64 bit hash for the sketch
+uint64_t mixKey(const void * owner, uint64_t blockIndex)
+{
+    uint64_t h = (uint64_t)owner;
+    h ^= blockIndex + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/** Counting sketch used for the admission decision: four saturating
+    4-bit counters per key, halved periodically so the estimate tracks
+    recent popularity rather than all-time popularity.
+*/
+struct FrequencySketch {
+
+    static constexpr size_t NUM_COUNTERS = 1 << 16;  // 32kb of nibbles
+    static constexpr uint64_t RESET_INTERVAL = 10 * NUM_COUNTERS;
+
+    std::vector<uint8_t> counters =
+        std::vector<uint8_t>(NUM_COUNTERS / 2, 0);
+    uint64_t numIncrements = 0;
+
+    uint8_t read(size_t i) const
+    {
+        uint8_t byte = counters[i / 2];
+        return (i % 2) ? (byte >> 4) : (byte & 0x0f);
+    }
+
+    void bump(size_t i)
+    {
+        uint8_t byte = counters[i / 2];
+        uint8_t nibble = (i % 2) ? (byte >> 4) : (byte & 0x0f);
+        if (nibble == 15)
+            return;  // saturated
+        nibble += 1;
+        counters[i / 2] = (i % 2)
+            ? ((byte & 0x0f) | (nibble << 4))
+            : ((byte & 0xf0) | nibble);
+    }
+
+    void increment(uint64_t hash)
+    {
+        for (int i = 0;  i < 4;  ++i) {
+            bump((hash >> (i * 16)) % NUM_COUNTERS);
+        }
+
+        if (++numIncrements >= RESET_INTERVAL) {
+            // Halve everything so stale popularity ages out
+            for (auto & byte: counters)
+                byte = (byte >> 1) & 0x77;
+            numIncrements /= 2;
+        }
+    }
+
+    uint8_t estimate(uint64_t hash) const
+    {
+        uint8_t result = 15;
+        for (int i = 0;  i < 4;  ++i) {
+            result = std::min(result,
+                              read((hash >> (i * 16)) % NUM_COUNTERS));
+        }
+        return result;
+    }
+};
+
+} // file scope
+
+
+/*****************************************************************************/
+/* DECODED BLOCK CACHE                                                       */
+/*****************************************************************************/
+
+struct DecodedBlockCache::Itl {
+
+    typedef std::pair<const void *, uint64_t> Key;
+
+    struct Entry {
+        std::shared_ptr<const std::string> data;
+        std::list<Key>::iterator lruIt;
+    };
+
+    mutable std::mutex mutex;
+    std::map<Key, Entry> entries;
+    std::list<Key> lru;  // front = most recently used
+    FrequencySketch sketch;
+    Stats stats;
+
+    Itl()
+    {
+        stats.maxBytes = (uint64_t)BLOCK_CACHE_SIZE_MB.get() * 1024 * 1024;
+    }
+
+    std::shared_ptr<const std::string>
+    get(const void * owner, uint64_t blockIndex)
+    {
+        Key key(owner, blockIndex);
+
+        std::unique_lock<std::mutex> guard(mutex);
+
+        sketch.increment(mixKey(owner, blockIndex));
+
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            ++stats.misses;
+            return nullptr;
+        }
+
+        ++stats.hits;
+        lru.splice(lru.begin(), lru, it->second.lruIt);
+        return it->second.data;
+    }
+
+    void put(const void * owner, uint64_t blockIndex,
+             std::shared_ptr<const std::string> data)
+    {
+        Key key(owner, blockIndex);
+        size_t size = data->size();
+
+        std::unique_lock<std::mutex> guard(mutex);
+
+        // A block this big would evict most of the cache by itself
+        if (size > stats.maxBytes / 4) {
+            ++stats.rejected;
+            return;
+        }
+
+        if (entries.count(key))
+            return;  // another thread beat us to it
+
+        // Make room, but only if the newcomer is at least as popular as
+        // each victim it would displace
+        uint8_t newFreq = sketch.estimate(mixKey(owner, blockIndex));
+
+        while (stats.currentBytes + size > stats.maxBytes) {
+            const Key & victim = lru.back();
+            uint8_t victimFreq
+                = sketch.estimate(mixKey(victim.first, victim.second));
+            if (newFreq < victimFreq) {
+                ++stats.rejected;
+                return;
+            }
+            evictOne();
+        }
+
+        auto lruIt = lru.insert(lru.begin(), key);
+        entries.emplace(key, Entry{std::move(data), lruIt});
+        stats.currentBytes += size;
+        stats.currentBlocks += 1;
+        ++stats.admitted;
+    }
+
+    // mutex must be held
+    void evictOne()
+    {
+        const Key & victim = lru.back();
+        auto it = entries.find(victim);
+        stats.currentBytes -= it->second.data->size();
+        stats.currentBlocks -= 1;
+        ++stats.evicted;
+        entries.erase(it);
+        lru.pop_back();
+    }
+
+    void evictOwner(const void * owner)
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+
+        auto it = entries.lower_bound(Key(owner, 0));
+        while (it != entries.end() && it->first.first == owner) {
+            stats.currentBytes -= it->second.data->size();
+            stats.currentBlocks -= 1;
+            lru.erase(it->second.lruIt);
+            it = entries.erase(it);
+        }
+    }
+
+    Stats getStats() const
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        return stats;
+    }
+
+    void setMaxBytes(uint64_t maxBytes)
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        stats.maxBytes = maxBytes;
+        while (stats.currentBytes > stats.maxBytes && !lru.empty())
+            evictOne();
+    }
+};
+
+DecodedBlockCache::
+DecodedBlockCache()
+    : itl(new Itl())
+{
+}
+
+DecodedBlockCache::
+~DecodedBlockCache()
+{
+}
+
+DecodedBlockCache &
+DecodedBlockCache::
+instance()
+{
+    static DecodedBlockCache result;
+    return result;
+}
+
+std::shared_ptr<const std::string>
+DecodedBlockCache::
+get(const void * owner, uint64_t blockIndex)
+{
+    return itl->get(owner, blockIndex);
+}
+
+void
+DecodedBlockCache::
+put(const void * owner, uint64_t blockIndex,
+    std::shared_ptr<const std::string> data)
+{
+    itl->put(owner, blockIndex, std::move(data));
+}
+
+void
+DecodedBlockCache::
+evictOwner(const void * owner)
+{
+    itl->evictOwner(owner);
+}
+
+DecodedBlockCache::Stats
+DecodedBlockCache::
+getStats() const
+{
+    return itl->getStats();
+}
+
+void
+DecodedBlockCache::
+setMaxBytes(uint64_t maxBytes)
+{
+    itl->setMaxBytes(maxBytes);
+}
+
+} // namespace MLDB
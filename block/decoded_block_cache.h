@@ -0,0 +1,88 @@
+/** decoded_block_cache.h                                          -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Process-wide cache of decompressed data blocks.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+
+namespace MLDB {
+
+
+/*****************************************************************************/
+/* DECODED BLOCK CACHE                                                       */
+/*****************************************************************************/
+
+/** Process-wide, size-bounded cache of decompressed blocks, shared by
+    the frozen column implementations that store their values zstd (or
+    otherwise) compressed.  Without it, every query touching a
+    compressed column pays the full decompression cost again, even for
+    the handful of hot columns a dashboard re-reads thousands of times
+    an hour.
+
+    Blocks are keyed on (owner identity, block index); owners are
+    expected to call evictOwner() from their destructor so that a
+    recycled address can't alias a dead column's blocks.
+
+    Eviction is least-recently-used, but admission is frequency-based
+    (TinyLFU style): a block only displaces the eviction victim if it
+    has been requested at least as often, so a large sequential scan
+    can't flush the working set of the hot columns.  Hit and miss
+    counters are exposed over REST via /v1/blockCacheStats.
+
+    The cache size defaults to 512MB and can be set with the
+    BLOCK_CACHE_SIZE_MB environment variable.
+*/
+
+struct DecodedBlockCache {
+
+    static DecodedBlockCache & instance();
+
+    /** Look up a block, recording its access for the admission
+        frequency estimate.  Returns nullptr on a miss.
+    */
+    std::shared_ptr<const std::string>
+    get(const void * owner, uint64_t blockIndex);
+
+    /** Offer a freshly decoded block to the cache.  It may be rejected
+        by the admission policy, in which case the caller's reference is
+        simply the only one.
+    */
+    void put(const void * owner, uint64_t blockIndex,
+             std::shared_ptr<const std::string> data);
+
+    /** Drop all blocks belonging to the given owner.  Must be called
+        when the owner is destroyed.
+    */
+    void evictOwner(const void * owner);
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t admitted = 0;
+        uint64_t rejected = 0;
+        uint64_t evicted = 0;
+        uint64_t currentBytes = 0;
+        uint64_t currentBlocks = 0;
+        uint64_t maxBytes = 0;
+    };
+
+    Stats getStats() const;
+
+    void setMaxBytes(uint64_t maxBytes);
+
+private:
+    DecodedBlockCache();
+    ~DecodedBlockCache();
+
+    struct Itl;
+    std::unique_ptr<Itl> itl;
+};
+
+} // namespace MLDB
@@ -12,6 +12,7 @@
 #include "mldb/arch/vm.h"
 #include "mldb/types/annotated_exception.h"
 #include "mldb/vfs/filter_streams.h"
+#include "mldb/base/thread_pool.h"
 #include "mldb/types/path.h"
 #include "mldb/types/basic_value_descriptions.h"
 #include "mldb/arch/vm.h"
@@ -93,6 +94,36 @@ rangeAtEnd(size_t length) const
     return range(this->length() - length, this->length());
 }
 
+void
+FrozenMemoryRegion::
+prefetchRange(size_t offset, ssize_t length) const
+{
+    if (offset >= length_)
+        return;
+    if (length == -1 || offset + length > length_)
+        length = length_ - offset;
+    if (length == 0)
+        return;
+
+    // Round the start down to a page boundary; madvise requires a
+    // page-aligned address, and for prefetching we want the partial
+    // pages at either end included, not excluded.
+    const char * start = data_ + offset;
+    const char * alignedStart
+        = (const char *)((size_t)start & ~(page_size - 1));
+    size_t alignedLength = start + length - alignedStart;
+
+    // Keep the underlying mapping alive until the hint has been issued.
+    // The job must not throw; a failed madvise (eg anonymous memory on
+    // some kernels) just means no readahead.
+    auto job = [handle = handle_, alignedStart, alignedLength] ()
+        {
+            ::madvise((void *)alignedStart, alignedLength, MADV_WILLNEED);
+        };
+
+    ThreadPool::instance().add(std::move(job));
+}
+
 #if 0
 void
 FrozenMemoryRegion::
@@ -249,13 +280,8 @@ mapFile(const Url & filename, size_t startOffset, ssize_t length)
         length = buf.st_size;
     }
 
-    cerr << "file goes from 0 for " << length << " bytes" << endl;
-    
     size_t mapOffset = startOffset & ~(page_size - 1);
     size_t mapLength = (length - mapOffset + page_size -1) & ~(page_size - 1);
-    
-    cerr << "mapping from " << mapOffset << " for " << mapLength << " bytes"
-         << endl;
 
     std::shared_ptr<void> addr
         (mmap(nullptr, mapLength,
@@ -271,9 +297,6 @@ mapFile(const Url & filename, size_t startOffset, ssize_t length)
     const char * start = reinterpret_cast<const char *>(addr.get());
     start += (startOffset % page_size);
 
-    cerr << "taking off " << (startOffset % page_size) << " bytes" << endl;
-    cerr << "length = " << length << endl;
-    
     return FrozenMemoryRegion(std::move(addr), start, length);
 }
 
@@ -321,7 +344,38 @@ allocateWritable(uint64_t bytesRequired,
 
     size_t bytesToAllocate
         = (bytesRequired + alignment - 1) / alignment * alignment;
-    
+
+    if (hugePages && bytesToAllocate >= huge_page_size) {
+        size_t mapLength
+            = (bytesToAllocate + huge_page_size - 1)
+            / huge_page_size * huge_page_size;
+
+        // Explicit huge pages first; this fails with ENOMEM when no
+        // hugetlb pool is configured, in which case we take normal
+        // pages and ask for them to be merged transparently.
+        mem = ::mmap(nullptr, mapLength, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mem == MAP_FAILED) {
+            mem = ::mmap(nullptr, mapLength, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mem != MAP_FAILED) {
+                // Advisory; if it fails we still have a valid mapping
+                ::madvise(mem, mapLength, MADV_HUGEPAGE);
+            }
+        }
+
+        if (mem != MAP_FAILED) {
+            std::shared_ptr<void> handle
+                (mem, [mapLength] (void * mem)
+                    { ::munmap(mem, mapLength); });
+            return {std::move(handle), (char *)mem,
+                    (size_t)bytesRequired, this };
+        }
+
+        // Fall through to the normal allocator
+        mem = nullptr;
+    }
+
     int res = posix_memalign(&mem, alignment, bytesToAllocate);
     if (res != 0) {
         cerr << "bytesRequired = " << bytesRequired
@@ -152,7 +152,15 @@ struct FrozenMemoryRegion {
 
     /** Return the given number of bytes at the end. */
     FrozenMemoryRegion rangeAtEnd(size_t length) const;
-    
+
+    /** Hint that the given range will be read soon, so that a mapped
+        region can be paged in ahead of the access instead of one fault
+        at a time.  The hint is issued asynchronously on a background
+        thread and is purely advisory; errors are ignored.  A length of
+        -1 means until the end of the region.
+    */
+    void prefetchRange(size_t offset, ssize_t length = -1) const;
+
     /** This tests whether the region is initialized or not.  A
         non-initialized region has either been constructed from the
         default constructor or moved from.
@@ -419,6 +427,17 @@ struct MappedSerializer {
 /** Mapped serializer that puts things in memory. */
 
 struct MemorySerializer: public MappedSerializer {
+    /** When hugePages is true, allocations of at least one huge page
+        are backed by 2MB pages to reduce TLB pressure when scanning
+        large frozen datasets: first MAP_HUGETLB, falling back to
+        transparent huge pages, and finally to normal pages when
+        neither is available.
+    */
+    MemorySerializer(bool hugePages = false)
+        : hugePages(hugePages)
+    {
+    }
+
     virtual ~MemorySerializer()
     {
     }
@@ -430,6 +449,9 @@ struct MemorySerializer: public MappedSerializer {
     virtual MutableMemoryRegion
     allocateWritable(uint64_t bytesRequired,
                      size_t alignment);
+
+private:
+    bool hugePages = false;
 };
 
 
@@ -0,0 +1,121 @@
+/* block_compressed_region_test.cc
+   Jeremy Barnes, 30 August 2026
+   This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+   Tests of the seekable compressed container format.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include "mldb/block/block_compressed_region.h"
+
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+
+using namespace std;
+using namespace MLDB;
+
+namespace {
+
+std::string makeData(size_t size)
+{
+    std::string data;
+    data.reserve(size);
+    for (size_t i = 0;  i < size;  ++i) {
+        data.push_back('a' + (i * 2654435761ULL >> 16) % 26);
+    }
+    return data;
+}
+
+FrozenMemoryRegion regionOf(const std::shared_ptr<std::string> & str)
+{
+    return FrozenMemoryRegion(str, str->data(), str->size());
+}
+
+} // file scope
+
+BOOST_AUTO_TEST_CASE( test_round_trip_random_access )
+{
+    const size_t blockSize = 64 * 1024;
+    std::string data = makeData(10 * blockSize + 12345);
+
+    std::ostringstream out;
+    BlockCompressedRegionWriter writer(out, "zstd", -1, blockSize);
+
+    // Write in odd-sized pieces so partial block buffering is exercised
+    for (size_t ofs = 0;  ofs < data.size();  ofs += 100000) {
+        writer.write(data.data() + ofs,
+                     std::min<size_t>(100000, data.size() - ofs));
+    }
+    writer.finish();
+
+    auto container = std::make_shared<std::string>(out.str());
+    BOOST_CHECK_LT(container->size(), data.size());
+
+    BlockCompressedRegion region(regionOf(container));
+    BOOST_CHECK_EQUAL(region.length(), data.size());
+    BOOST_CHECK_EQUAL(region.blockSize(), blockSize);
+    BOOST_CHECK_EQUAL(region.numBlocks(), 11);
+    BOOST_CHECK_EQUAL(region.compression(), "zstd");
+
+    // Whole contents
+    {
+        FrozenMemoryRegion all = region.getRange(0);
+        BOOST_REQUIRE_EQUAL(all.length(), data.size());
+        BOOST_CHECK(std::string(all.data(), all.length()) == data);
+    }
+
+    // Ranges within a block, spanning blocks, and at the tail
+    for (auto [ofs, len]: { std::pair<size_t, size_t>{100, 200},
+                            {blockSize - 10, 20},
+                            {3 * blockSize + 7, 4 * blockSize},
+                            {data.size() - 100, 100} }) {
+        FrozenMemoryRegion range = region.getRange(ofs, len);
+        BOOST_REQUIRE_EQUAL(range.length(), len);
+        BOOST_CHECK_EQUAL(std::string(range.data(), range.length()),
+                          data.substr(ofs, len));
+    }
+
+    BOOST_CHECK_THROW(region.getRange(data.size() - 10, 20), std::exception);
+
+    // Block-aligned access
+    {
+        auto [startOffset, range]
+            = region.getRangeContaining(blockSize + 10, 100);
+        BOOST_CHECK_EQUAL(startOffset, blockSize);
+        BOOST_REQUIRE_EQUAL(range.length(), blockSize);
+        BOOST_CHECK_EQUAL(std::string(range.data(), range.length()),
+                          data.substr(blockSize, blockSize));
+    }
+
+    // Off the end
+    {
+        auto [startOffset, range]
+            = region.getRangeContaining(data.size(), 100);
+        BOOST_CHECK_EQUAL(startOffset, data.size());
+        BOOST_CHECK(!range);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_empty_container )
+{
+    std::ostringstream out;
+    BlockCompressedRegionWriter writer(out, "zstd");
+    writer.finish();
+
+    auto container = std::make_shared<std::string>(out.str());
+    BlockCompressedRegion region(regionOf(container));
+
+    BOOST_CHECK_EQUAL(region.length(), 0);
+    BOOST_CHECK_EQUAL(region.numBlocks(), 0);
+    BOOST_CHECK(!region.getRange(0, -1));
+}
+
+BOOST_AUTO_TEST_CASE( test_not_a_container )
+{
+    auto container
+        = std::make_shared<std::string>("definitely not a container");
+    BOOST_CHECK_THROW(BlockCompressedRegion{regionOf(container)},
+                      std::exception);
+}
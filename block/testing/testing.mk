@@ -1,3 +1,4 @@
 # This file is part of MLDB. Copyright 2015 mldb.ai inc. All rights reserved.
 
 $(eval $(call test,content_descriptor_test,vfs block types value_description vfs,boost))
+$(eval $(call test,block_compressed_region_test,vfs block types value_description,boost))
@@ -0,0 +1,341 @@
+/** uring_block_reader.cc
+    Jeremy Barnes, 30 August 2026
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Implementation of the io_uring backed block reader.
+*/
+
+#include "uring_block_reader.h"
+#include "mldb/base/exc_assert.h"
+#include "mldb/types/annotated_exception.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#  define MLDB_HAS_IO_URING 1
+#  include <linux/io_uring.h>
+#  include <sys/syscall.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+
+using namespace std;
+
+
+namespace MLDB {
+
+#ifdef MLDB_HAS_IO_URING
+
+namespace {
+
+// Thin wrappers; there are no glibc stubs for these syscalls
+int ioUringSetup(unsigned entries, struct io_uring_params * params)
+{
+    return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int ioUringEnter(int ringFd, unsigned toSubmit, unsigned minComplete,
+                 unsigned flags)
+{
+    return syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete,
+                   flags, nullptr, 0);
+}
+
+} // file scope
+
+
+/*****************************************************************************/
+/* URING BLOCK READER                                                        */
+/*****************************************************************************/
+
+struct UringBlockReader::Itl {
+
+    Itl(int fd, int queueDepth)
+        : fd(fd), queueDepth(queueDepth)
+    {
+        struct io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+
+        ringFd = ioUringSetup(queueDepth, &params);
+        if (ringFd == -1) {
+            throw AnnotatedException
+                (500, "io_uring_setup: " + string(strerror(errno)));
+        }
+
+        size_t sqSize
+            = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        size_t cqSize
+            = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        // Newer kernels map both rings through a single region
+        bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMmap)
+            sqSize = cqSize = std::max(sqSize, cqSize);
+
+        sqRing = mmap(nullptr, sqSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) {
+            int err = errno;
+            ::close(ringFd);
+            throw AnnotatedException
+                (500, "io_uring mmap sq: " + string(strerror(err)));
+        }
+        sqRingSize = sqSize;
+
+        if (singleMmap) {
+            cqRing = sqRing;
+            cqRingSize = 0;  // same mapping; don't unmap twice
+        }
+        else {
+            cqRing = mmap(nullptr, cqSize, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ringFd,
+                          IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) {
+                int err = errno;
+                munmap(sqRing, sqRingSize);
+                ::close(ringFd);
+                throw AnnotatedException
+                    (500, "io_uring mmap cq: " + string(strerror(err)));
+            }
+            cqRingSize = cqSize;
+        }
+
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = (io_uring_sqe *)mmap(nullptr, sqesSize,
+                                    PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE, ringFd,
+                                    IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            int err = errno;
+            if (cqRingSize)
+                munmap(cqRing, cqRingSize);
+            munmap(sqRing, sqRingSize);
+            ::close(ringFd);
+            throw AnnotatedException
+                (500, "io_uring mmap sqes: " + string(strerror(err)));
+        }
+
+        char * sq = (char *)sqRing;
+        sqTail = (std::atomic<unsigned> *)(sq + params.sq_off.tail);
+        sqMask = *(unsigned *)(sq + params.sq_off.ring_mask);
+        sqArray = (unsigned *)(sq + params.sq_off.array);
+
+        char * cq = (char *)cqRing;
+        cqHead = (std::atomic<unsigned> *)(cq + params.cq_off.head);
+        cqTail = (std::atomic<unsigned> *)(cq + params.cq_off.tail);
+        cqMask = *(unsigned *)(cq + params.cq_off.ring_mask);
+        cqes = (io_uring_cqe *)(cq + params.cq_off.cqes);
+    }
+
+    ~Itl()
+    {
+        munmap(sqes, sqesSize);
+        if (cqRingSize)
+            munmap(cqRing, cqRingSize);
+        munmap(sqRing, sqRingSize);
+        ::close(ringFd);
+    }
+
+    int fd;
+    int queueDepth;
+    int ringFd = -1;
+
+    void * sqRing = nullptr;
+    size_t sqRingSize = 0;
+    std::atomic<unsigned> * sqTail = nullptr;
+    unsigned sqMask = 0;
+    unsigned * sqArray = nullptr;
+    io_uring_sqe * sqes = nullptr;
+    size_t sqesSize = 0;
+
+    void * cqRing = nullptr;
+    size_t cqRingSize = 0;
+    std::atomic<unsigned> * cqHead = nullptr;
+    std::atomic<unsigned> * cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe * cqes = nullptr;
+
+    /// One block being read; reads that come back short are continued
+    /// into the same buffer until the block is complete.
+    struct PendingBlock {
+        std::shared_ptr<char> data;
+        uint64_t offset = 0;
+        uint32_t length = 0;
+        uint32_t done = 0;
+    };
+
+    bool forEachBlock(uint64_t startOffset,
+                      uint64_t totalLength,
+                      uint64_t blockSize,
+                      const OnBlock & onBlock)
+    {
+        ExcAssertGreater(blockSize, 0);
+
+        if (totalLength == 0)
+            return true;
+
+        size_t numBlocks = (totalLength + blockSize - 1) / blockSize;
+
+        std::vector<PendingBlock> blocks(numBlocks);
+
+        size_t nextToSubmit = 0;
+        size_t numCompleted = 0;
+        unsigned inFlight = 0;
+        unsigned toSubmit = 0;
+        bool finished = false;
+
+        // Push one read (or continuation of a short read) onto the
+        // submission queue.  We're the only submitter, so the tail is
+        // only contended with the kernel's acquire load.
+        auto submitOne = [&] (size_t blockNum)
+            {
+                const PendingBlock & b = blocks[blockNum];
+                unsigned tail
+                    = sqTail->load(std::memory_order_relaxed);
+                unsigned index = tail & sqMask;
+                io_uring_sqe & sqe = sqes[index];
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode = IORING_OP_READ;
+                sqe.fd = fd;
+                sqe.addr = (uint64_t)(b.data.get() + b.done);
+                sqe.len = b.length - b.done;
+                sqe.off = b.offset + b.done;
+                sqe.user_data = blockNum;
+                sqArray[index] = index;
+                sqTail->store(tail + 1, std::memory_order_release);
+                ++inFlight;
+                ++toSubmit;
+            };
+
+        while (numCompleted < numBlocks) {
+            // Keep the queue full
+            while (!finished
+                   && inFlight < (unsigned)queueDepth
+                   && nextToSubmit < numBlocks) {
+                size_t n = nextToSubmit++;
+                PendingBlock & b = blocks[n];
+                b.offset = startOffset + n * blockSize;
+                b.length = std::min<uint64_t>
+                    (blockSize, startOffset + totalLength - b.offset);
+                b.data = std::shared_ptr<char>
+                    (new char[b.length], std::default_delete<char[]>());
+                submitOne(n);
+            }
+
+            if (inFlight == 0)
+                break;  // stopped early and drained
+
+            int res = ioUringEnter(ringFd, toSubmit, 1 /* minComplete */,
+                                   IORING_ENTER_GETEVENTS);
+            if (res == -1) {
+                if (errno == EINTR)
+                    continue;
+                throw AnnotatedException
+                    (500, "io_uring_enter: " + string(strerror(errno)));
+            }
+            toSubmit = 0;
+
+            // Reap whatever has completed
+            unsigned head = cqHead->load(std::memory_order_relaxed);
+            while (head != cqTail->load(std::memory_order_acquire)) {
+                const io_uring_cqe & cqe = cqes[head & cqMask];
+                size_t blockNum = cqe.user_data;
+                int32_t cqeRes = cqe.res;
+                ++head;
+                cqHead->store(head, std::memory_order_release);
+                --inFlight;
+
+                PendingBlock & b = blocks[blockNum];
+
+                if (cqeRes < 0) {
+                    throw AnnotatedException
+                        (500, "io_uring read: "
+                         + string(strerror(-cqeRes)));
+                }
+                if (cqeRes == 0) {
+                    throw AnnotatedException
+                        (500, "io_uring read: unexpected end of file");
+                }
+
+                b.done += cqeRes;
+
+                if (b.done < b.length) {
+                    // Short read; continue it
+                    submitOne(blockNum);
+                    continue;
+                }
+
+                ++numCompleted;
+
+                if (!finished) {
+                    FrozenMemoryRegion block
+                        (b.data, b.data.get(), b.length);
+                    if (!onBlock(blockNum, b.offset, std::move(block)))
+                        finished = true;
+                }
+
+                b.data.reset();
+            }
+        }
+
+        return !finished;
+    }
+};
+
+#endif /* MLDB_HAS_IO_URING */
+
+bool
+UringBlockReader::
+isAvailable()
+{
+#ifdef MLDB_HAS_IO_URING
+    static const bool available = [] ()
+        {
+            struct io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            int fd = ioUringSetup(4, &params);
+            if (fd == -1)
+                return false;
+            ::close(fd);
+            return true;
+        }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+UringBlockReader::
+UringBlockReader(int fd, int queueDepth)
+{
+#ifdef MLDB_HAS_IO_URING
+    itl.reset(new Itl(fd, queueDepth));
+#else
+    throw AnnotatedException(500, "io_uring is not supported on this platform");
+#endif
+}
+
+UringBlockReader::
+~UringBlockReader()
+{
+}
+
+bool
+UringBlockReader::
+forEachBlock(uint64_t startOffset,
+             uint64_t totalLength,
+             uint64_t blockSize,
+             const OnBlock & onBlock)
+{
+#ifdef MLDB_HAS_IO_URING
+    return itl->forEachBlock(startOffset, totalLength, blockSize, onBlock);
+#else
+    throw AnnotatedException(500, "io_uring is not supported on this platform");
+#endif
+}
+
+} // namespace MLDB
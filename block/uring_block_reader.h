@@ -0,0 +1,69 @@
+/** uring_block_reader.h                                           -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Asynchronous block reader over a file descriptor, backed by the
+    Linux io_uring interface.
+*/
+
+#pragma once
+
+#include "mldb/block/memory_region.h"
+#include <functional>
+#include <memory>
+
+
+namespace MLDB {
+
+
+/*****************************************************************************/
+/* URING BLOCK READER                                                        */
+/*****************************************************************************/
+
+/** Reads a range of a file in fixed-size blocks, keeping a queue of
+    reads in flight so that the device sees enough parallelism to reach
+    its full bandwidth (a single synchronous reader on NVMe does not).
+
+    Blocks are delivered in completion order, not file order; callers
+    that need ordering (like the line-oriented import pipeline) already
+    resequence on block number.  Callers should check isAvailable()
+    first and fall back to a synchronous path where io_uring is not
+    supported by the kernel.
+*/
+
+struct UringBlockReader {
+
+    /** Does this kernel support io_uring?  Cheap after the first call. */
+    static bool isAvailable();
+
+    /** Create a reader over the given file descriptor.  The descriptor
+        remains owned by the caller and must stay open for the lifetime
+        of the reader.
+    */
+    UringBlockReader(int fd, int queueDepth = 32);
+
+    ~UringBlockReader();
+
+    typedef std::function<bool (size_t blockNumber,
+                                uint64_t blockOffset,
+                                FrozenMemoryRegion block)> OnBlock;
+
+    /** Read [startOffset, startOffset + totalLength) in blocks of
+        blockSize bytes (the last block may be shorter), calling onBlock
+        for each completed block from the calling thread.
+
+        Block numbers start at zero for the block at startOffset.  If an
+        onBlock call returns false, no further blocks are submitted or
+        delivered, in-flight reads are drained, and false is returned.
+    */
+    bool forEachBlock(uint64_t startOffset,
+                      uint64_t totalLength,
+                      uint64_t blockSize,
+                      const OnBlock & onBlock);
+
+private:
+    struct Itl;
+    std::unique_ptr<Itl> itl;
+};
+
+} // namespace MLDB
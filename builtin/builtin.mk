@@ -8,6 +8,7 @@ LIBMLDB_BUILTIN_BASE_SOURCES:= \
 	filtered_dataset.cc \
 	sampled_dataset.cc \
 	union_dataset.cc \
+	partitioned_dataset.cc \
 	\
 	basic_procedures.cc \
 	sql_functions.cc \
@@ -29,8 +30,10 @@ LIBMLDB_BUILTIN_BASE_SOURCES:= \
 	ranking_procedure.cc \
 	pooling_function.cc \
 	permuter_procedure.cc \
+	dag_procedure.cc \
 	datasetsplit_procedure.cc \
 	summary_statistics_proc.cc \
+	materialized_view_procedure.cc \
 	\
 	metric_space.cc \
 	matrix.cc \
@@ -23,6 +23,8 @@
 #include "mldb/builtin/merged_dataset.h"
 #include "mldb/utils/log.h"
 #include "mldb/types/structure_description.h"
+#include <list>
+#include <map>
 
 
 using namespace std;
@@ -469,6 +471,79 @@ ContinuousWindowDatasetConfigDescription()
 }
 
 
+/*****************************************************************************/
+/* GENERATION CACHE                                                          */
+/*****************************************************************************/
+
+namespace {
+
+/** Process-wide cache of loaded generation datasets.
+
+    Each continuous.window dataset used to resolve its constituent
+    generations from their configurations, so a window re-created per
+    query would map the same immutable generation files over and over.
+    Saved generations never change once written, so the loaded datasets
+    can be shared: this keeps the most recently used ones alive and
+    hands out the same instance to every window that composes it.  The
+    entries are reference counted, so a generation still in use by a
+    live window survives eviction from the cache; it just won't be
+    handed out to new windows any more.
+*/
+struct GenerationCache {
+
+    /// Number of generations kept alive beyond those in use by windows
+    static constexpr size_t MAX_ENTRIES = 128;
+
+    std::shared_ptr<Dataset>
+    obtain(MldbEngine * engine, const PolyConfigT<const Dataset> & config)
+    {
+        Utf8String key = config.id;
+
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+            auto it = index.find(key);
+            if (it != index.end()) {
+                // Move to the front of the LRU list
+                lru.splice(lru.begin(), lru, it->second);
+                return it->second->second;
+            }
+        }
+
+        // Load outside the lock.  Concurrent loads of the same generation
+        // are wasteful but harmless; the loser of the insert race below
+        // just drops its copy.
+        auto dataset = obtainDataset(engine, config, nullptr);
+
+        std::unique_lock<std::mutex> guard(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            return it->second->second;
+        }
+
+        lru.emplace_front(key, dataset);
+        index[key] = lru.begin();
+
+        while (lru.size() > MAX_ENTRIES) {
+            index.erase(lru.back().first);
+            lru.pop_back();
+        }
+
+        return dataset;
+    }
+
+    std::mutex mutex;
+    std::list<std::pair<Utf8String, std::shared_ptr<Dataset> > > lru;
+    std::map<Utf8String,
+             std::list<std::pair<Utf8String,
+                                 std::shared_ptr<Dataset> > >::iterator> index;
+};
+
+static GenerationCache generationCache;
+
+} // file scope
+
+
 /*****************************************************************************/
 /* CONTINUOUS WINDOW DATASET                                                 */
 /*****************************************************************************/
@@ -566,9 +641,18 @@ ContinuousWindowDataset(MldbEngine * owner,
     }
 
     try {
-        // Obtain the merged dataset, recursively
+        // Obtain each generation through the cache, so that windows over
+        // the same time range share the already-mapped datasets rather
+        // than re-loading them, and compose them into a merged view.
+        auto params = toLoadConfig.params.convert<MergedDatasetConfig>();
+
+        std::vector<std::shared_ptr<Dataset> > generations;
+        generations.reserve(params.datasets.size());
+        for (auto & ds: params.datasets)
+            generations.emplace_back(generationCache.obtain(engine, ds));
+
         std::shared_ptr<Dataset> underlying
-            = obtainDataset(engine, toLoadConfig);
+            = std::make_shared<MergedDataset>(engine, std::move(generations));
         setUnderlying(underlying);
     } MLDB_CATCH_ALL {
         rethrowException(-1, "Error initializing continuous window dataset in "
@@ -0,0 +1,385 @@
+/** dag_procedure.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Procedure that runs a DAG of child procedures, with independent
+    nodes running concurrently.
+*/
+
+#include "dag_procedure.h"
+#include "mldb/types/basic_value_descriptions.h"
+#include "mldb/types/any_impl.h"
+#include "mldb/types/annotated_exception.h"
+#include "mldb/base/work_class.h"
+#include "mldb/utils/string_functions.h"
+#include "mldb/utils/log.h"
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace std;
+
+
+namespace MLDB {
+
+
+/*****************************************************************************/
+/* DAG PROCEDURE CONFIG                                                      */
+/*****************************************************************************/
+
+DEFINE_STRUCTURE_DESCRIPTION(DagStepConfig);
+
+DagStepConfigDescription::
+DagStepConfigDescription()
+{
+    addField("name", &DagStepConfig::name,
+             "Name of the node.  Must be unique within the DAG; it is also "
+             "used as the id of the child run.");
+    addField("procedure", &DagStepConfig::procedure,
+             "Configuration of the procedure to run for this node.");
+    addField("dependsOn", &DagStepConfig::dependsOn,
+             "Names of nodes that must finish before this one starts.  "
+             "Dependencies through datasets (this node reading a dataset "
+             "another node outputs) are inferred automatically and don't "
+             "need to be listed here.");
+}
+
+DEFINE_STRUCTURE_DESCRIPTION(DagProcedureConfig);
+
+DagProcedureConfigDescription::
+DagProcedureConfigDescription()
+{
+    addField("steps", &DagProcedureConfig::steps,
+             "Nodes of the DAG.  Nodes whose dependencies have all finished "
+             "run concurrently.");
+    addParent<ProcedureConfig>();
+}
+
+
+namespace {
+
+/** Collect the ids of datasets a step's configuration declares as outputs:
+    any object with both an "id" and a "type" member sitting under a key
+    whose name contains "output" (outputDataset, modelFileUrlOutput style
+    keys don't match; they are not dataset configs).
+*/
+void collectOutputIds(const Json::Value & js,
+                      const string & parentKey,
+                      set<string> & ids)
+{
+    if (!js.isObject())
+        return;
+    if (js.isMember("id") && js["id"].isString() && js.isMember("type")
+        && parentKey.find("output") != string::npos
+        && !js["id"].asString().empty()) {
+        ids.insert(js["id"].asString());
+    }
+    for (const auto & key: js.getMemberNames())
+        collectOutputIds(js[key], MLDB::lowercase(key), ids);
+}
+
+} // file scope
+
+
+/*****************************************************************************/
+/* DAG PROCEDURE                                                             */
+/*****************************************************************************/
+
+DagProcedure::
+DagProcedure(MldbEngine * owner,
+             PolyConfig config,
+             const std::function<bool (const Json::Value &)> & onProgress)
+    : Procedure(owner)
+{
+    procConf = config.params.convert<DagProcedureConfig>();
+}
+
+Any
+DagProcedure::
+getStatus() const
+{
+    return Any();
+}
+
+RunOutput
+DagProcedure::
+run(const ProcedureRunConfig & run,
+    const std::function<bool (const Json::Value &)> & onProgress) const
+{
+    auto runProcConf = applyRunConfOverProcConf(procConf, run);
+
+    const auto & steps = runProcConf.steps;
+    size_t n = steps.size();
+    if (n == 0)
+        throw AnnotatedException(400, "dag.run needs at least one step");
+
+    map<Utf8String, size_t> stepIndex;
+    for (size_t i = 0;  i < n;  ++i) {
+        if (steps[i].name.empty())
+            throw AnnotatedException(400, "dag.run steps need a name");
+        if (!stepIndex.insert({steps[i].name, i}).second)
+            throw AnnotatedException(400, "dag.run step names must be unique",
+                                     "name", steps[i].name);
+    }
+
+    // Dependency edges: explicit dependsOn lists first
+    vector<set<size_t>> deps(n);
+    for (size_t i = 0;  i < n;  ++i) {
+        for (const auto & dep: steps[i].dependsOn) {
+            auto it = stepIndex.find(dep);
+            if (it == stepIndex.end())
+                throw AnnotatedException(400, "dag.run dependsOn refers to an "
+                                         "unknown step",
+                                         "step", steps[i].name,
+                                         "dependsOn", dep);
+            if (it->second == i)
+                throw AnnotatedException(400, "dag.run step depends on itself",
+                                         "step", steps[i].name);
+            deps[i].insert(it->second);
+        }
+    }
+
+    // ... then implicit edges through datasets: a step whose configuration
+    // mentions the id of a dataset another step outputs runs after it.  The
+    // consumer side matches on the serialized configuration since input
+    // datasets can appear as bare ids, dataset configs or inside FROM
+    // clauses of inline SQL.
+    vector<Json::Value> paramsJson(n);
+    vector<set<string>> outputIds(n);
+    for (size_t i = 0;  i < n;  ++i) {
+        paramsJson[i] = jsonEncode(steps[i].procedure.params);
+        collectOutputIds(paramsJson[i], "", outputIds[i]);
+    }
+    for (size_t i = 0;  i < n;  ++i) {
+        string serialized = paramsJson[i].toString();
+        for (size_t j = 0;  j < n;  ++j) {
+            if (j == i)
+                continue;
+            for (const auto & id: outputIds[j]) {
+                if (serialized.find("\"" + id + "\"") != string::npos) {
+                    deps[i].insert(j);
+                    break;
+                }
+            }
+        }
+    }
+
+    // Kahn's algorithm both orders the nodes and detects cycles
+    vector<set<size_t>> dependents(n);
+    vector<size_t> remaining(n, 0);
+    for (size_t i = 0;  i < n;  ++i) {
+        remaining[i] = deps[i].size();
+        for (size_t d: deps[i])
+            dependents[d].insert(i);
+    }
+
+    {
+        vector<size_t> order, counts(remaining);
+        for (size_t i = 0;  i < n;  ++i)
+            if (counts[i] == 0)
+                order.push_back(i);
+        for (size_t pos = 0;  pos < order.size();  ++pos)
+            for (size_t d: dependents[order[pos]])
+                if (--counts[d] == 0)
+                    order.push_back(d);
+        if (order.size() != n) {
+            Utf8String cycle;
+            for (size_t i = 0;  i < n;  ++i)
+                if (counts[i] > 0)
+                    cycle += (cycle.empty() ? "" : ", ") + steps[i].name;
+            throw AnnotatedException(400, "dag.run steps form a cycle",
+                                     "steps", cycle);
+        }
+    }
+
+    // Run it.  Ready nodes each get a thread; the procedures themselves
+    // are batch work, so their parallel sections share the machine under
+    // the admission scheduler rather than oversubscribing it.
+    std::mutex mutex;
+    std::condition_variable cv;
+    vector<std::thread> threads;
+    vector<bool> started(n, false), finished(n, false);
+    vector<double> durations(n, 0.0);
+    vector<RunOutput> outputs(n);
+    std::exception_ptr firstError;
+    Utf8String failedStep;
+    size_t numFinished = 0;
+
+    auto onStepProgress = [&] (const Utf8String & name,
+                               const Json::Value & progress) -> bool
+        {
+            if (!onProgress)
+                return true;
+            Json::Value wrapped;
+            wrapped["step"] = name.rawString();
+            wrapped["progress"] = progress;
+            std::unique_lock<std::mutex> guard(mutex);
+            return onProgress(wrapped);
+        };
+
+    auto runStep = [&] (size_t i)
+        {
+            ScopedWorkClass batchWork("batch");
+
+            Date stepStart = Date::now();
+            RunOutput output;
+            std::exception_ptr error;
+            try {
+                PolyConfig procPC = steps[i].procedure;
+                auto stepProgress = [&] (const Json::Value & progress)
+                    {
+                        return onStepProgress(steps[i].name, progress);
+                    };
+                auto procedure = obtainProcedure(engine, procPC, stepProgress);
+
+                ProcedureRunConfig procRunConf;
+                procRunConf.id = steps[i].name.rawString();
+                output = procedure->run(procRunConf, stepProgress);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            double duration = Date::now().secondsSince(stepStart);
+
+            std::unique_lock<std::mutex> guard(mutex);
+            durations[i] = duration;
+            outputs[i] = std::move(output);
+            finished[i] = true;
+            ++numFinished;
+            if (error && !firstError) {
+                firstError = error;
+                failedStep = steps[i].name;
+            }
+            cv.notify_all();
+        };
+
+    Date dagStart = Date::now();
+
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        for (;;) {
+            if (!firstError) {
+                for (size_t i = 0;  i < n;  ++i) {
+                    if (started[i] || remaining[i] > 0)
+                        continue;
+                    started[i] = true;
+                    threads.emplace_back(runStep, i);
+                }
+            }
+
+            size_t numStarted = 0;
+            for (size_t i = 0;  i < n;  ++i)
+                numStarted += started[i];
+            if (numFinished == numStarted)
+                break;
+
+            cv.wait(guard);
+
+            for (size_t i = 0;  i < n;  ++i) {
+                if (!finished[i])
+                    continue;
+                for (size_t d: dependents[i]) {
+                    if (deps[d].erase(i))
+                        --remaining[d];
+                }
+            }
+        }
+    }
+
+    for (auto & t: threads)
+        t.join();
+
+    if (firstError) {
+        try {
+            std::rethrow_exception(firstError);
+        } catch (const std::exception & exc) {
+            rethrowException(400, "dag.run step '" + failedStep + "' failed: "
+                             + getExceptionString(),
+                             "step", failedStep);
+        }
+    }
+
+    double totalSeconds = Date::now().secondsSince(dagStart);
+
+    // Critical path: longest chain of dependent steps by wall clock.  With
+    // unbounded concurrency this bounds the total; the gap between the two
+    // is the time lost to machine contention.
+    vector<set<size_t>> finalDeps(n);
+    for (size_t i = 0;  i < n;  ++i)
+        for (size_t d = 0;  d < n;  ++d)
+            if (dependents[d].count(i))
+                finalDeps[i].insert(d);
+
+    vector<double> pathLength(n, 0.0);
+    vector<ssize_t> pathPrev(n, -1);
+    {
+        vector<size_t> order, counts(n);
+        for (size_t i = 0;  i < n;  ++i) {
+            counts[i] = finalDeps[i].size();
+            if (counts[i] == 0)
+                order.push_back(i);
+        }
+        for (size_t pos = 0;  pos < order.size();  ++pos) {
+            size_t i = order[pos];
+            pathLength[i] = durations[i];
+            for (size_t d: finalDeps[i]) {
+                if (pathLength[d] + durations[i] >= pathLength[i]) {
+                    pathLength[i] = pathLength[d] + durations[i];
+                    pathPrev[i] = d;
+                }
+            }
+            for (size_t d: dependents[i])
+                if (--counts[d] == 0)
+                    order.push_back(d);
+        }
+    }
+
+    ssize_t critEnd = 0;
+    for (size_t i = 1;  i < n;  ++i)
+        if (pathLength[i] > pathLength[critEnd])
+            critEnd = i;
+
+    Json::Value criticalPath(Json::ValueType::arrayValue);
+    {
+        vector<ssize_t> chain;
+        for (ssize_t i = critEnd;  i != -1;  i = pathPrev[i])
+            chain.push_back(i);
+        for (auto it = chain.rbegin();  it != chain.rend();  ++it)
+            criticalPath.append(steps[*it].name.rawString());
+    }
+
+    Json::Value result;
+    Json::Value stepResults(Json::ValueType::arrayValue);
+    for (size_t i = 0;  i < n;  ++i) {
+        Json::Value step;
+        step["name"] = steps[i].name.rawString();
+        Json::Value dependsOn(Json::ValueType::arrayValue);
+        for (size_t d: finalDeps[i])
+            dependsOn.append(steps[d].name.rawString());
+        step["dependsOn"] = dependsOn;
+        step["durationSeconds"] = durations[i];
+        step["results"] = jsonEncode(outputs[i].results);
+        stepResults.append(step);
+    }
+    result["steps"] = stepResults;
+    result["totalSeconds"] = totalSeconds;
+    result["criticalPathSeconds"] = pathLength[critEnd];
+    result["criticalPath"] = criticalPath;
+
+    return RunOutput(result);
+}
+
+
+namespace {
+
+RegisterProcedureType<DagProcedure, DagProcedureConfig>
+regDag(builtinPackage(),
+       "Run a DAG of child procedures, with independent nodes in parallel",
+       "procedures/DagProcedure.md.html");
+
+} // file scope
+
+} // namespace MLDB
@@ -0,0 +1,66 @@
+/** dag_procedure.h                                                -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Procedure that runs a DAG of child procedures.
+*/
+
+#pragma once
+
+#include "mldb/types/value_description_fwd.h"
+#include "mldb/core/mldb_engine.h"
+#include "mldb/core/procedure.h"
+
+
+namespace MLDB {
+
+
+/*****************************************************************************/
+/* DAG PROCEDURE CONFIG                                                      */
+/*****************************************************************************/
+
+struct DagStepConfig {
+    Utf8String name;                     ///< Unique name of the node
+    PolyConfig procedure;                ///< Procedure to run for the node
+    std::vector<Utf8String> dependsOn;   ///< Explicit upstream nodes
+};
+
+DECLARE_STRUCTURE_DESCRIPTION(DagStepConfig);
+
+struct DagProcedureConfig : public ProcedureConfig {
+    static constexpr const char * name = "dag.run";
+
+    std::vector<DagStepConfig> steps;
+};
+
+DECLARE_STRUCTURE_DESCRIPTION(DagProcedureConfig);
+
+
+/*****************************************************************************/
+/* DAG PROCEDURE                                                             */
+/*****************************************************************************/
+
+/** Runs a set of child procedures as a dependency graph: nodes with no
+    unfinished dependencies run concurrently, each under the batch work
+    class of the admission scheduler.  Dependencies come from the
+    explicit dependsOn lists plus the dataset ids flowing between steps
+    (a step consuming a dataset another step outputs runs after it).
+    Intermediate datasets stay registered in the engine, so they pass
+    between steps by reference without any serialization.
+*/
+struct DagProcedure: public Procedure {
+
+    DagProcedure(MldbEngine * owner,
+                 PolyConfig config,
+                 const std::function<bool (const Json::Value &)> & onProgress);
+
+    virtual RunOutput run(const ProcedureRunConfig & run,
+                          const std::function<bool (const Json::Value &)> & onProgress) const;
+
+    virtual Any getStatus() const;
+
+    DagProcedureConfig procConf;
+};
+
+} // namespace MLDB
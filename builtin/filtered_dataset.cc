@@ -258,5 +258,26 @@ getColumnIndex() const
     return itl;
 }
 
+GenerateRowsWhereFunction
+FilteredDataset::
+generateRowsWhere(const SqlBindingScope & context,
+                  const Utf8String & alias,
+                  const SqlExpression & where,
+                  ssize_t offset,
+                  ssize_t limit) const
+{
+    // The filter removes individual (value, timestamp) tuples, never
+    // whole rows, so a where expression that doesn't read any column
+    // value selects the same rows here as on the dataset underneath.
+    // Push those down so the underlying dataset can use its own
+    // optimized row generation.
+    UnboundEntities unbound = where.getUnbound();
+    if (unbound.vars.empty() && unbound.wildcards.empty())
+        return dataset.generateRowsWhere(context, alias, where,
+                                         offset, limit);
+
+    return Dataset::generateRowsWhere(context, alias, where, offset, limit);
+}
+
 } // namespace MLDB
 
@@ -50,6 +50,16 @@ struct FilteredDataset : public Dataset {
     virtual std::shared_ptr<MatrixView> getMatrixView() const;
     virtual std::shared_ptr<ColumnIndex> getColumnIndex() const;
 
+    /** Push row generation down to the underlying dataset when the where
+        expression doesn't read any column value, so that its indexes
+        stay usable through the view. */
+    virtual GenerateRowsWhereFunction
+    generateRowsWhere(const SqlBindingScope & context,
+                      const Utf8String & alias,
+                      const SqlExpression & where,
+                      ssize_t offset,
+                      ssize_t limit) const;
+
     // TODO: if often used, this could be reasonably overridden here
     //virtual std::pair<Date, Date> getTimestampRange() const;
 
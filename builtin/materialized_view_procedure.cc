@@ -0,0 +1,228 @@
+/** materialized_view_procedure.cc
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Procedure that maintains the result of a SELECT over an append-only
+    dataset, refreshing it incrementally as the input grows.
+*/
+
+#include "mldb/builtin/materialized_view_procedure.h"
+#include "mldb/builtin/sub_dataset.h"
+#include "mldb/core/mldb_engine.h"
+#include "mldb/core/dataset_scope.h"
+#include "mldb/sql/sql_expression.h"
+#include "mldb/types/basic_value_descriptions.h"
+#include "mldb/types/any_impl.h"
+#include "mldb/types/annotated_exception.h"
+#include "mldb/utils/log.h"
+#include <mutex>
+
+using namespace std;
+
+
+namespace MLDB {
+
+
+/*****************************************************************************/
+/* MATERIALIZED VIEW PROCEDURE                                               */
+/*****************************************************************************/
+
+MaterializedViewProcedureConfig::
+MaterializedViewProcedureConfig()
+    : refreshOnCommit(true)
+{
+    outputDataset.withType("sparse.mutable");
+}
+
+DEFINE_STRUCTURE_DESCRIPTION(MaterializedViewProcedureConfig);
+
+MaterializedViewProcedureConfigDescription::
+MaterializedViewProcedureConfigDescription()
+{
+    addField("inputData", &MaterializedViewProcedureConfig::inputData,
+             "The view query.  Each refresh runs this query over only the "
+             "rows appended to the input dataset since the last refresh and "
+             "appends the result to the output dataset, so new input rows "
+             "must only ever produce new output rows.  OFFSET and LIMIT are "
+             "not supported.");
+    addField("outputDataset", &MaterializedViewProcedureConfig::outputDataset,
+             "Dataset holding the materialized result.  Refreshes append to "
+             "it; it should not be written to by anything else.",
+             PolyConfigT<Dataset>().withType("sparse.mutable"));
+    addField("refreshOnCommit", &MaterializedViewProcedureConfig::refreshOnCommit,
+             "If true, the view is refreshed automatically each time the "
+             "input dataset commits, in addition to each run of the "
+             "procedure.", true);
+    addParent<ProcedureConfig>();
+}
+
+struct MaterializedViewProcedure::RefreshState {
+    std::mutex mutex;
+
+    /// Number of input rows already reflected in the output
+    uint64_t rowsProcessed = 0;
+
+    /// Whether the commit callback is already registered on the input
+    bool callbackRegistered = false;
+
+    /// The output dataset; kept here so that the commit callback keeps it
+    /// alive for as long as the input dataset may fire it
+    std::shared_ptr<Dataset> output;
+};
+
+/** Run one incremental refresh: query the input rows past rowsProcessed,
+    apply the view query to them, and append the result to the output.
+    Returns the number of input rows consumed.
+*/
+static uint64_t
+refreshMaterializedView(MldbEngine * engine,
+                        const MaterializedViewProcedureConfig & config,
+                        Dataset & input,
+                        MaterializedViewProcedure::RefreshState & state)
+{
+    std::unique_lock<std::mutex> guard(state.mutex);
+
+    ExcAssert(state.output);
+    if (state.output.get() == &input) {
+        // Refreshing a view into its own input would feed back on itself
+        return 0;
+    }
+
+    uint64_t totalRows = input.getRowCount();
+    if (totalRows <= state.rowsProcessed)
+        return 0;
+
+    // Materialize the newly appended input rows.  With no ORDER BY the
+    // rows come back in stable dataset order, so for an append-only
+    // dataset the offset skips exactly the rows already processed.
+    auto deltaRows
+        = std::get<0>(input.queryStructuredExpr(SelectExpression::STAR,
+                                                WhenExpression::TRUE,
+                                                *SqlExpression::TRUE,
+                                                OrderByExpression(),
+                                                TupleExpression(),
+                                                SqlExpression::TRUE,
+                                                SqlExpression::parse("rowPath()"),
+                                                state.rowsProcessed,
+                                                -1 /* limit */));
+
+    SubDataset delta(engine, std::move(deltaRows));
+
+    // Run the view query over just the delta
+    const SelectStatement & stm = *config.inputData.stm;
+    auto viewRows
+        = std::get<0>(delta.queryStructuredExpr(stm.select, stm.when,
+                                                *stm.where, stm.orderBy,
+                                                stm.groupBy, stm.having,
+                                                stm.rowName,
+                                                0 /* offset */,
+                                                -1 /* limit */));
+
+    for (auto & row: viewRows) {
+        MatrixNamedRow flat = row.flattenDestructive();
+        state.output->recordRow(flat.rowName, flat.columns);
+    }
+
+    state.output->commit();
+
+    uint64_t processed = totalRows - state.rowsProcessed;
+    state.rowsProcessed = totalRows;
+    return processed;
+}
+
+MaterializedViewProcedure::
+MaterializedViewProcedure(
+    MldbEngine * owner,
+    PolyConfig config,
+    const std::function<bool (const Json::Value &)> & onProgress)
+    : Procedure(owner),
+      state(std::make_shared<RefreshState>())
+{
+    procedureConfig = config.params.convert<MaterializedViewProcedureConfig>();
+}
+
+RunOutput
+MaterializedViewProcedure::
+run(const ProcedureRunConfig & run,
+    const std::function<bool (const Json::Value &)> & onProgress) const
+{
+    auto runProcConf = applyRunConfOverProcConf(procedureConfig, run);
+
+    if (runProcConf.inputData.stm == nullptr) {
+        throw AnnotatedException(400, "You need to define inputData");
+    }
+    if (runProcConf.inputData.stm->offset != 0
+        || runProcConf.inputData.stm->limit != -1) {
+        throw AnnotatedException
+            (400, "OFFSET and LIMIT are not supported in the query of a "
+             + string(MaterializedViewProcedureConfig::name) + " procedure");
+    }
+
+    SqlExpressionMldbScope context(engine);
+
+    auto boundDataset = runProcConf.inputData.stm->from
+        ? runProcConf.inputData.stm->from->bind(context, nullptr /*onProgress*/)
+        : BoundTableExpression();
+    if (!boundDataset.dataset) {
+        throw AnnotatedException
+            (400, "The query of a "
+             + string(MaterializedViewProcedureConfig::name)
+             + " procedure must select FROM a dataset");
+    }
+
+    std::shared_ptr<Dataset> input = boundDataset.dataset;
+
+    bool registerCallback = false;
+    {
+        std::unique_lock<std::mutex> guard(state->mutex);
+        if (!state->output) {
+            state->output = createDataset(engine, runProcConf.outputDataset,
+                                          nullptr, true /*overwrite*/);
+        }
+        if (runProcConf.refreshOnCommit && !state->callbackRegistered) {
+            state->callbackRegistered = true;
+            registerCallback = true;
+        }
+    }
+
+    uint64_t processed
+        = refreshMaterializedView(engine, runProcConf, *input, *state);
+
+    if (registerCallback) {
+        // The callback captures the config and state by value, not the
+        // procedure itself, so it stays valid for the whole lifetime of
+        // the input dataset.  The dataset that committed is passed in.
+        auto sharedState = state;
+        auto configCopy = runProcConf;
+        MldbEngine * enginePtr = engine;
+        input->addOnCommitCallback
+            ([=] (Dataset & dataset)
+             {
+                 refreshMaterializedView(enginePtr, configCopy, dataset,
+                                         *sharedState);
+             });
+    }
+
+    Json::Value result;
+    result["rowsProcessed"] = (int64_t)processed;
+    {
+        std::unique_lock<std::mutex> guard(state->mutex);
+        result["totalRowsProcessed"] = (int64_t)state->rowsProcessed;
+    }
+    return RunOutput(result);
+}
+
+Any
+MaterializedViewProcedure::
+getStatus() const
+{
+    return Any();
+}
+
+static RegisterProcedureType<MaterializedViewProcedure,
+                             MaterializedViewProcedureConfig>
+regMaterializedView(builtinPackage(),
+                    "Maintain the result of a SELECT incrementally as its "
+                    "input dataset grows",
+                    "procedures/MaterializedViewProcedure.md.html");
+
+} // namespace MLDB
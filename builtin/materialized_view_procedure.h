@@ -0,0 +1,76 @@
+/** materialized_view_procedure.h                                 -*- C++ -*-
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Procedure that maintains the result of a SELECT over an append-only
+    dataset, refreshing it incrementally as the input grows.
+*/
+
+#pragma once
+
+#include "mldb/core/procedure.h"
+#include "mldb/core/dataset.h"
+#include "mldb/sql/sql_expression.h"
+
+
+namespace MLDB {
+
+
+/*****************************************************************************/
+/* MATERIALIZED VIEW PROCEDURE                                               */
+/*****************************************************************************/
+
+/** Procedure that materializes the result of a SELECT into an output
+    dataset, and keeps it up to date as the input dataset is appended to.
+
+    Each refresh runs the view query over only the rows appended to the
+    input since the last refresh, and appends the result to the output, so
+    a refresh costs O(new data) rather than O(all data).  A refresh happens
+    on each run of the procedure and, if refreshOnCommit is set, each time
+    the input dataset commits (see Dataset::addOnCommitCallback).
+
+    This requires that the input dataset be append-only, and that new input
+    rows only ever produce new output rows: row-wise transforms always
+    qualify, and aggregations qualify when their grouping keys do not recur
+    across refreshes (for example rollups grouped by a time bucket aligned
+    with the commit cadence).
+*/
+
+struct MaterializedViewProcedureConfig : ProcedureConfig {
+    static constexpr const char * name = "materialized.view";
+
+    MaterializedViewProcedureConfig();
+
+    /// The view query, run incrementally over the input dataset
+    InputQuery inputData;
+
+    /// The dataset holding the materialized result
+    PolyConfigT<Dataset> outputDataset;
+
+    /// Refresh the view automatically when the input dataset commits
+    bool refreshOnCommit;
+};
+
+DECLARE_STRUCTURE_DESCRIPTION(MaterializedViewProcedureConfig);
+
+struct MaterializedViewProcedure: public Procedure {
+
+    MaterializedViewProcedure(
+        MldbEngine * owner,
+        PolyConfig config,
+        const std::function<bool (const Json::Value &)> & onProgress);
+
+    virtual RunOutput run(
+        const ProcedureRunConfig & run,
+        const std::function<bool (const Json::Value &)> & onProgress) const;
+
+    virtual Any getStatus() const;
+
+    MaterializedViewProcedureConfig procedureConfig;
+
+    /// Refresh bookkeeping shared between run() and the commit callback
+    /// registered on the input dataset
+    struct RefreshState;
+    std::shared_ptr<RefreshState> state;
+};
+
+} // namespace MLDB
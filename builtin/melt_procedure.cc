@@ -19,6 +19,9 @@
 #include "mldb/builtin/sql_config_validator.h"
 #include "mldb/builtin/sql_expression_extractors.h"
 #include "mldb/core/bound_queries.h"
+#include "mldb/core/recorder.h"
+#include "mldb/base/parallel.h"
+#include "mldb/base/per_thread_accumulator.h"
 #include "mldb/types/annotated_exception.h"
 
 using namespace std;
@@ -138,10 +141,30 @@ run(const ProcedureRunConfig & run,
     ColumnPath keyColumnName(runProcConf.keyColumnName);
     ColumnPath valueColumnName(runProcConf.valueColumnName);
 
-    std::mutex recordMutex;
+    // Each thread records into its own chunk of the output dataset, so
+    // that no locking is needed on the recording path and datasets that
+    // support chunked recording (eg tabular) ingest in parallel.
+    Dataset::MultiChunkRecorder recorder
+        = outputDataset->getChunkRecorder();
+
+    struct ThreadAccum {
+        /// Recorder object for this thread that the dataset gives us
+        /// to record into the dataset.
+        std::unique_ptr<Recorder> threadRecorder;
+    };
+
+    PerThreadAccumulator<ThreadAccum> accum;
+
+    std::atomic<size_t> chunkNumber(0);
     auto processor = [&] (NamedRowValue & row_,
                            const std::vector<ExpressionValue> & extraVals)
         {
+            auto & threadAccum = accum.get();
+            if (!threadAccum.threadRecorder) {
+                threadAccum.threadRecorder
+                    = recorder.newChunk(chunkNumber.fetch_add(1));
+            }
+
             MatrixNamedRow row = row_.flattenDestructive();
             Date rowTs = Date::negativeInfinity();
             for(auto & col : row.columns) {
@@ -166,19 +189,27 @@ run(const ProcedureRunConfig & run,
                 expr.forEachAtom(onAtom, ColumnPath());
             }
 
-            // Melted
+            // Melted.  One output row per input column, all recorded in a
+            // single transaction.
+            std::vector<std::pair<RowPath, RowValue> > outputRows;
+            outputRows.reserve(row.columns.size());
+
             for(auto & col : row.columns) {
-                // TODO. should I call recordRow twice instead of doing a vector copy here?
-                RowValue currOutputRow(fixedOutputRows);
+                RowValue currOutputRow;
+                currOutputRow.reserve(fixedOutputRows.size() + 2);
+                currOutputRow.insert(currOutputRow.end(),
+                                     fixedOutputRows.begin(),
+                                     fixedOutputRows.end());
 
                 currOutputRow.emplace_back(keyColumnName, get<0>(col).toUtf8String(), rowTs);
-                currOutputRow.emplace_back(valueColumnName, get<1>(col), rowTs);
-
-                RowPath rowName = row.rowName + std::get<0>(col);
+                currOutputRow.emplace_back(valueColumnName, std::move(get<1>(col)), rowTs);
 
-                std::unique_lock<std::mutex> guard(recordMutex);
-                outputDataset->recordRow(rowName, currOutputRow);
+                outputRows.emplace_back(row.rowName + std::get<0>(col),
+                                        std::move(currOutputRow));
             }
+
+            threadAccum.threadRecorder
+                ->recordRowsDestructive(std::move(outputRows));
             return true;
         };
 
@@ -194,6 +225,15 @@ run(const ProcedureRunConfig & run,
                  runProcConf.inputData.stm->limit,
                  nullptr /* progress */);
 
+    // Finish off the last bits of each thread
+    parallelMap(0, accum.threads.size(),
+                [&] (size_t n)
+                {
+                    auto & threadAccum = *accum.threads[n];
+                    ExcAssert(threadAccum.threadRecorder.get());
+                    threadAccum.threadRecorder->finishedChunk();
+                });
+
     outputDataset->commit();
 
     return RunOutput();
@@ -14,7 +14,8 @@
 #include "mldb/types/annotated_exception.h"
 #include "mldb/engine/dataset_utils.h"
 #include "mldb/utils/log.h"
-#include <thread>
+#include <atomic>
+#include <mutex>
 #include <sstream>
 
 
@@ -41,6 +42,131 @@ MergedDatasetConfigDescription()
 }
 
 
+/*****************************************************************************/
+/* LAZY ID HASHES UNION                                                      */
+/*****************************************************************************/
+
+/** Lazily materialized union of per-dataset hash indexes.
+
+    Construction captures only how to extract the entries of each source;
+    nothing is scanned until the index is first used.  The union is
+    materialized one IdHashes hash-prefix bucket at a time, so a point
+    query pays for extraction plus the merge of a single bucket, and a
+    full scan merges the remaining buckets in parallel.  Once every
+    bucket is done the per-source entries are released.
+*/
+struct LazyIdHashesUnion {
+
+    LazyIdHashesUnion(size_t numSources,
+                      std::function<MergeHashEntries (int)> getEntries)
+        : numSources(numSources),
+          getEntries(std::move(getEntries)),
+          bucketsRemaining(IdHashes::NBUCKETS)
+    {
+    }
+
+    /** Look up the bitmap for the given hash, materializing only the
+        bucket that covers it. */
+    uint32_t getDefault(uint64_t key, uint32_t def) const
+    {
+        if (!allDone.load(std::memory_order_acquire))
+            materializeBucket(index.bucketNum(key));
+        return index.getDefault(key, def);
+    }
+
+    size_t size() const
+    {
+        return materialize().size();
+    }
+
+    template<typename Fn>
+    bool forEach(const Fn & fn) const
+    {
+        return materialize().forEach(fn);
+    }
+
+    /** Materialize every bucket (needed to iterate or count), in
+        parallel for those not already done. */
+    const IdHashes & materialize() const
+    {
+        if (!allDone.load(std::memory_order_acquire)) {
+            auto onBucket = [&] (int bucket)
+                {
+                    materializeBucket(bucket);
+                };
+            parallelMap(0, IdHashes::NBUCKETS, onBucket);
+        }
+        return index;
+    }
+
+private:
+    void extract() const
+    {
+        std::call_once(extractOnce, [&] ()
+            {
+                std::vector<MergeHashEntries> entries(numSources);
+                auto onSource = [&] (int i)
+                    {
+                        entries[i] = getEntries(i);
+                    };
+                parallelMap(0, numSources, onSource);
+                allEntries = std::move(entries);
+            });
+    }
+
+    void mergeBucketRecursive(int bucket, int first, int last,
+                              MergeHashEntryBucket & result) const
+    {
+        if (last == first + 1) {
+            result = std::move(allEntries[first].buckets[bucket]);
+        }
+        else {
+            int mid = (first + last) / 2;
+            MergeHashEntryBucket left, right;
+            mergeBucketRecursive(bucket, first, mid, left);
+            mergeBucketRecursive(bucket, mid, last, right);
+            result.merge(left, right);
+        }
+    }
+
+    void materializeBucket(int bucket) const
+    {
+        std::call_once(bucketOnce[bucket], [&] ()
+            {
+                extract();
+
+                MergeHashEntryBucket merged;
+                mergeBucketRecursive(bucket, 0, numSources, merged);
+
+                auto & b = index.buckets[bucket];
+                b.reserve(merged.size());
+                for (auto & e: merged) {
+                    uint64_t h = e.hash;
+                    uint32_t bm = e.bitmap;
+                    b.insert(make_pair(h, bm));
+                }
+
+                if (bucketsRemaining.fetch_sub(1) == 1) {
+                    // Last bucket; the per-source entries are no longer
+                    // needed
+                    std::vector<MergeHashEntries>().swap(allEntries);
+                    allDone.store(true, std::memory_order_release);
+                }
+            });
+    }
+
+    size_t numSources;
+    std::function<MergeHashEntries (int)> getEntries;
+
+    mutable std::once_flag extractOnce;
+    mutable std::vector<MergeHashEntries> allEntries;
+    mutable std::once_flag bucketOnce[IdHashes::NBUCKETS];
+    mutable std::atomic<int> bucketsRemaining;
+    mutable std::atomic<bool> allDone = false;
+    mutable IdHashes index;
+};
+
+
 /*****************************************************************************/
 /* MERGED INTERNAL REPRESENTATION                                            */
 /*****************************************************************************/
@@ -49,8 +175,8 @@ MergedDatasetConfigDescription()
 struct MergedDataset::Itl
     : public MatrixView, public ColumnIndex {
 
-    IdHashes rowIndex;
-    IdHashes columnIndex;
+    std::unique_ptr<LazyIdHashesUnion> rowIndex;
+    std::unique_ptr<LazyIdHashesUnion> columnIndex;
 
     /// Datasets that it was constructed with
     std::vector<std::shared_ptr<Dataset> > datasetsIn;
@@ -124,10 +250,16 @@ struct MergedDataset::Itl
         }
 
         ExcAssertLessEqual(toMerge.size(), 32);
-    
-        auto getRowHashes = [&] (int datasetIndex)
+
+        this->datasetsIn = std::move(datasets);
+        this->datasets = std::move(toMerge);
+        for (auto & d: this->datasets) {
+            matrices.emplace_back(d->getMatrixView());
+        }
+
+        auto getRowHashes = [this] (int datasetIndex)
             {
-                auto dataset = toMerge[datasetIndex];
+                auto dataset = this->datasets[datasetIndex];
                 MergeHashEntries result;
                 vector<RowHash> rows = dataset->getMatrixView()->getRowHashes();
                 std::sort(rows.begin(), rows.end());
@@ -139,9 +271,9 @@ struct MergedDataset::Itl
                 return result;
             };
 
-        auto getColumnHashes = [&] (int datasetIndex)
+        auto getColumnHashes = [this] (int datasetIndex)
             {
-                auto dataset = toMerge[datasetIndex];
+                auto dataset = this->datasets[datasetIndex];
                 MergeHashEntries result;
                 vector<ColumnPath> cols = dataset->getMatrixView()->getColumnPaths();
                 std::sort(cols.begin(), cols.end());
@@ -152,48 +284,16 @@ struct MergedDataset::Itl
                 return result;
             };
 
-        auto initRowBucket = [&] (int i, MergeHashEntryBucket & b)
-            {
-                auto & b2 = rowIndex.buckets[i];
-
-                b2.reserve(b.size());
-
-                for (auto & e: b) {
-                    uint64_t h = e.hash;
-                    uint32_t bm = e.bitmap;
-                    b2.insert(make_pair(h, bm));
-                }
-            };
-
-        auto initColumnBucket = [&] (int i, MergeHashEntryBucket & b)
-            {
-                auto & b2 = columnIndex.buckets[i];
-
-                b2.reserve(b.size());
-
-                for (auto & e: b) {
-                    uint64_t h = e.hash;
-                    uint32_t bm = e.bitmap;
-                    b2.insert(make_pair(h, bm));
-                }
-            };
-
-        std::thread mergeColumns([&] () { extractAndMerge(toMerge.size(), getColumnHashes, initColumnBucket); });
-        std::thread mergeRows([&] () { extractAndMerge(toMerge.size(), getRowHashes, initRowBucket); });
-
-        DEBUG_MSG(logger) << "merging columns and rows";
-        mergeColumns.join();
-        mergeRows.join();
-
-        this->datasetsIn = std::move(datasets);
-        this->datasets = std::move(toMerge);
-        for (auto & d: this->datasets) {
-            matrices.emplace_back(d->getMatrixView());
-        }
+        // The index unions are built lazily, one hash-prefix bucket at a
+        // time, so that creating a merged view is cheap and point
+        // queries only pay for the buckets they touch
+        rowIndex.reset(new LazyIdHashesUnion(this->datasets.size(),
+                                             getRowHashes));
+        columnIndex.reset(new LazyIdHashesUnion(this->datasets.size(),
+                                                getColumnHashes));
 
-        DEBUG_MSG(logger) << "merged dataset has " 
-                          << this->getRowHashes().size() << " rows and " 
-                          << this->getColumnPaths(0, -1).size() << " columns";
+        DEBUG_MSG(logger) << "created lazy merged dataset over "
+                          << this->datasets.size() << " datasets";
     }
 
     struct MergedRowStream : public RowStream {
@@ -210,7 +310,7 @@ struct MergedDataset::Itl
         /* set where the stream should start*/
         virtual void initAt(size_t start) override
         {
-            it = source->rowIndex.begin();
+            it = source->rowIndex->materialize().begin();
             for (size_t i = 0; i < start; ++i)
                 ++it;
         }
@@ -375,7 +475,7 @@ struct MergedDataset::Itl
                 return true;
             };
 
-        rowIndex.forEach(onRow);
+        rowIndex->forEach(onRow);
 
         return result;
     }
@@ -460,7 +560,7 @@ struct MergedDataset::Itl
                 return true;
             };
         
-        columnIndex.forEach(onColumn);
+        columnIndex->forEach(onColumn);
         
         return applyOffsetLimit(offset, limit, result);
     }
@@ -596,22 +696,22 @@ struct MergedDataset::Itl
 
     virtual uint64_t getRowCount() const
     {
-        return rowIndex.size();
+        return rowIndex->size();
     }
 
     virtual size_t getColumnCount() const
     {
-        return columnIndex.size();
+        return columnIndex->size();
     }
 
     uint32_t getRowBitmap(RowHash rowHash) const
     {
-        return rowIndex.getDefault(rowHash, 0);
+        return rowIndex->getDefault(rowHash, 0);
     }
 
     uint32_t getColumnBitmap(ColumnHash columnHash) const
     {
-        return columnIndex.getDefault(columnHash, 0);
+        return columnIndex->getDefault(columnHash, 0);
     }
 
     std::pair<Date, Date> getTimestampRange() const
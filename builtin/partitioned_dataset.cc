@@ -0,0 +1,599 @@
+/**                                                                 -*- C++ -*-
+ * partitioned_dataset.cc
+ * Jeremy Barnes, 30 August 2026
+ * This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+ **/
+#include "partitioned_dataset.h"
+
+#include "mldb/sql/sql_expression.h"
+#include "mldb/sql/sql_expression_operations.h"
+#include "mldb/sql/dataset_types.h"
+#include "mldb/types/any_impl.h"
+#include "mldb/types/structure_description.h"
+#include "mldb/types/vector_description.h"
+#include "mldb/types/json_printing.h"
+#include "mldb/types/annotated_exception.h"
+#include "mldb/engine/dataset_utils.h"
+#include "mldb/http/http_replica_pool.h"
+#include "mldb/base/parallel.h"
+
+#include <map>
+
+using namespace std;
+
+
+namespace MLDB {
+
+
+/*****************************************************************************/
+/* PARTITIONED DATASET CONFIG                                                */
+/*****************************************************************************/
+
+DEFINE_STRUCTURE_DESCRIPTION(PartitionShardConfig);
+
+PartitionShardConfigDescription::
+PartitionShardConfigDescription()
+{
+    addField("dataset", &PartitionShardConfig::dataset,
+             "Member dataset holding the shard, when it lives in this "
+             "node.  Ignored when peer is set.");
+    addField("peer", &PartitionShardConfig::peer,
+             "Base URL of the MLDB node owning the shard, for example "
+             "'http://mldb-3:1994'.  Leave empty for a local shard.");
+    addField("replicas", &PartitionShardConfig::replicas,
+             "Base URLs of further replicas of the shard.  Requests "
+             "balance over the peer and its replicas by observed "
+             "latency, fail over when one is down and hedge when one "
+             "is slow.");
+    addField("remoteName", &PartitionShardConfig::remoteName,
+             "Id of the dataset on the owning node.  Required when peer "
+             "is set.");
+}
+
+DEFINE_STRUCTURE_DESCRIPTION(PartitionedDatasetConfig);
+
+PartitionedDatasetConfigDescription::
+PartitionedDatasetConfigDescription()
+{
+    addField("shards", &PartitionedDatasetConfig::shards,
+             "Shards making up the dataset.  Rows are assumed disjoint "
+             "between shards.");
+}
+
+
+namespace {
+
+/* The grouped executor names each output row after the JSON printout of
+   its group key tuple; merged partial aggregates must come back under
+   the same names the same query would produce against a single dataset. */
+RowPath groupKeyRowPath(const std::vector<ExpressionValue> & groupKey)
+{
+    static VectorDescription<ExpressionValue>
+        desc(getExpressionValueDescriptionNoTimestamp());
+
+    std::string printed;
+    printed.reserve(116);
+    StringJsonPrintingContext context(printed);
+    context.writeUtf8 = true;
+    desc.printJsonTyped(&groupKey, context);
+
+    return PathElement(printed);
+}
+
+/* Quote a dataset id for use in the FROM clause of a query shipped to a
+   peer. */
+Utf8String quoteIdentifier(const Utf8String & id)
+{
+    std::string out = "\"";
+    for (char c: id.rawString()) {
+        if (c == '"')
+            out += '"';
+        out += c;
+    }
+    out += '"';
+    return Utf8String(out);
+}
+
+/* One aggregate output column of the original select, in a shape we know
+   how to decompose into per-shard partials. */
+struct AggClause {
+    enum Op { COUNT, SUM, MIN, MAX, AVG } op;
+    ColumnPath outputName;
+    Utf8String argSurface;
+};
+
+/* Parse the select into decomposable aggregate clauses, throwing a 400
+   explaining the supported shapes if anything else appears. */
+std::vector<AggClause>
+parseAggClauses(const SelectExpression & select)
+{
+    static const std::map<Utf8String, AggClause::Op> ops = {
+        { "count", AggClause::COUNT },
+        { "sum",   AggClause::SUM },
+        { "min",   AggClause::MIN },
+        { "max",   AggClause::MAX },
+        { "avg",   AggClause::AVG }
+    };
+
+    std::vector<AggClause> result;
+    for (auto & clause: select.clauses) {
+        auto named = std::dynamic_pointer_cast<NamedColumnExpression>(clause);
+        if (!named || named->alias.empty())
+            throw AnnotatedException
+                (400, "Aggregate queries on partitioned datasets must "
+                 "select named aggregates, eg sum(x) AS total",
+                 "select", select.surface);
+        auto call = std::dynamic_pointer_cast<FunctionCallExpression>
+            (named->expression);
+        auto op = call && call->tableName.empty() && call->args.size() == 1
+            ? ops.find(call->functionName) : ops.end();
+        if (!call || op == ops.end())
+            throw AnnotatedException
+                (400, "Partitioned datasets can only merge count, sum, "
+                 "min, max and avg aggregates of a single argument "
+                 "across shards",
+                 "select", select.surface,
+                 "clause", clause->surface);
+        if (call->args[0]->surface.empty())
+            throw AnnotatedException
+                (400, "Cannot ship aggregate argument to shards: the "
+                 "expression has no surface form",
+                 "clause", clause->surface);
+        result.push_back({ op->second, named->alias,
+                           call->args[0]->surface });
+    }
+    return result;
+}
+
+/* Running merge state for one aggregate clause of one group. */
+struct PartialAccum {
+    uint64_t count = 0;
+    double dsum = 0.0;
+    int64_t isum = 0;
+    bool intOnly = true;
+    bool any = false;
+    CellValue extreme;
+    Date ts = Date::negativeInfinity();
+};
+
+} // file scope
+
+
+/*****************************************************************************/
+/* PARTITIONED DATASET INTERNAL                                              */
+/*****************************************************************************/
+
+struct PartitionedDataset::Itl {
+
+    struct Shard {
+        std::shared_ptr<Dataset> local;   ///< null for remote shards
+        Utf8String peer;                  ///< primary replica, for messages
+        std::shared_ptr<HttpReplicaPool> pool;
+        Utf8String remoteName;
+    };
+
+    std::vector<Shard> shards;
+
+    /** Run "SELECT <selectPart'> FROM <shard> <tailPart>" on every shard
+        in parallel and return the per-shard results.  Local shards run
+        the parsed statement directly on the member dataset; remote
+        shards ship the query text to the peer's /v1/query endpoint.
+    */
+    std::vector<std::vector<MatrixNamedRow> >
+    scatter(const Utf8String & selectPart, const Utf8String & tailPart) const
+    {
+        // Parse once for all local shards; queryString() established that
+        // FROM-less statements parse.
+        std::shared_ptr<SelectStatement> localStm;
+        for (auto & shard: shards) {
+            if (shard.local) {
+                localStm.reset(new SelectStatement
+                               (SelectStatement::parse(selectPart + tailPart)));
+                break;
+            }
+        }
+
+        std::vector<std::vector<MatrixNamedRow> > results(shards.size());
+
+        auto runShard = [&] (size_t i)
+            {
+                const Shard & shard = shards[i];
+                if (shard.local) {
+                    results[i] = shard.local->queryStructured
+                        (localStm->select, localStm->when, *localStm->where,
+                         localStm->orderBy, localStm->groupBy,
+                         localStm->having, localStm->rowName,
+                         localStm->offset, localStm->limit);
+                    return;
+                }
+
+                Utf8String sql = selectPart + " FROM "
+                    + quoteIdentifier(shard.remoteName) + tailPart;
+
+                auto response = shard.pool->get
+                    ("/v1/query", { { "q", sql }, { "format", "full" } });
+                if (response.code() != 200)
+                    throw AnnotatedException
+                        (500, "Shard query failed on peer",
+                         "peer", shard.peer,
+                         "query", sql,
+                         "httpCode", response.code(),
+                         "response", response.body());
+                results[i] = jsonDecode<std::vector<MatrixNamedRow> >
+                    (response.jsonBody());
+            };
+
+        parallelMap(0, shards.size(), runShard);
+
+        return results;
+    }
+};
+
+
+/*****************************************************************************/
+/* PARTITIONED DATASET                                                       */
+/*****************************************************************************/
+
+PartitionedDataset::
+PartitionedDataset(MldbEngine * owner,
+                   PolyConfig config,
+                   const ProgressFunc & onProgress)
+    : Dataset(owner)
+{
+    auto datasetConfig = config.params.convert<PartitionedDatasetConfig>();
+
+    if (datasetConfig.shards.empty())
+        throw AnnotatedException
+            (400, "Attempt to create partitioned dataset with no shards");
+
+    itl.reset(new Itl());
+    for (auto & s: datasetConfig.shards) {
+        Itl::Shard shard;
+        if (s.peer.empty()) {
+            shard.local = obtainDataset(owner, s.dataset, nullptr /*onProgress*/);
+        }
+        else {
+            if (s.remoteName.empty())
+                throw AnnotatedException
+                    (400, "Partitioned dataset shards on a peer need a "
+                     "remoteName", "peer", s.peer);
+            shard.peer = s.peer;
+            shard.remoteName = s.remoteName;
+
+            std::vector<std::string> uris;
+            uris.emplace_back(s.peer.rawString());
+            for (auto & replica: s.replicas)
+                uris.emplace_back(replica.rawString());
+            shard.pool = std::make_shared<HttpReplicaPool>(std::move(uris));
+        }
+        itl->shards.emplace_back(std::move(shard));
+    }
+}
+
+PartitionedDataset::
+~PartitionedDataset()
+{
+}
+
+Any
+PartitionedDataset::
+getStatus() const
+{
+    return Any();
+}
+
+std::vector<MatrixNamedRow>
+PartitionedDataset::
+queryStructured(const SelectExpression & select,
+                const WhenExpression & when,
+                const SqlExpression & where,
+                const OrderByExpression & orderBy,
+                const TupleExpression & groupBy,
+                const std::shared_ptr<SqlExpression> having,
+                const std::shared_ptr<SqlExpression> rowName,
+                ssize_t offset,
+                ssize_t limit,
+                Utf8String alias) const
+{
+    ExcAssert(having);
+    ExcAssert(rowName);
+
+    if (when.when && !when.when->isConstantTrue())
+        throw AnnotatedException
+            (400, "WHEN clauses are not supported on partitioned datasets");
+    if (!orderBy.clauses.empty())
+        throw AnnotatedException
+            (400, "ORDER BY is not supported on partitioned datasets: "
+             "shard results cannot be merged in order");
+    if (!where.isConstantTrue() && where.surface.empty())
+        throw AnnotatedException
+            (400, "Cannot ship where clause to shards: the expression "
+             "has no surface form");
+
+    Utf8String whereTail;
+    if (!where.isConstantTrue())
+        whereTail = " WHERE " + where.surface;
+
+    std::vector<std::shared_ptr<SqlExpression> > aggregators
+        = select.findAggregators(!groupBy.clauses.empty());
+
+    // Plain row queries scatter as-is and concatenate
+    if (groupBy.clauses.empty() && aggregators.empty()) {
+        if (select.surface.empty())
+            throw AnnotatedException
+                (400, "Cannot ship select to shards: the expression has "
+                 "no surface form");
+
+        Utf8String selectPart = "SELECT " + select.surface;
+        if (rowName->surface != "rowPath()" && rowName->surface != "rowName()") {
+            if (rowName->surface.empty())
+                throw AnnotatedException
+                    (400, "Cannot ship row name expression to shards: the "
+                     "expression has no surface form");
+            selectPart += " NAMED " + rowName->surface;
+        }
+
+        Utf8String tailPart = whereTail;
+        if (limit != -1)
+            tailPart += " LIMIT " + to_string(offset + limit);
+
+        std::vector<MatrixNamedRow> result;
+        for (auto & shardRows: itl->scatter(selectPart, tailPart)) {
+            result.insert(result.end(),
+                          make_move_iterator(shardRows.begin()),
+                          make_move_iterator(shardRows.end()));
+        }
+        return applyOffsetLimit(offset, limit, result);
+    }
+
+    // Aggregate queries ship a partial-aggregate query per shard and
+    // merge the per-group partials locally
+    if (!having->isConstantTrue())
+        throw AnnotatedException
+            (400, "HAVING is not supported on partitioned datasets: it "
+             "cannot be evaluated on partial aggregates");
+    if (rowName->surface != "rowPath()" && rowName->surface != "rowName()"
+        && !rowName->isConstant())
+        throw AnnotatedException
+            (400, "NAMED is not supported on aggregate queries over "
+             "partitioned datasets");
+
+    std::vector<AggClause> aggClauses = parseAggClauses(select);
+
+    std::vector<Utf8String> partials;
+    for (size_t i = 0;  i < aggClauses.size();  ++i) {
+        const AggClause & c = aggClauses[i];
+        Utf8String p = "__p" + to_string(i);
+        switch (c.op) {
+        case AggClause::COUNT:
+            partials.push_back("count(" + c.argSurface + ") AS \"" + p + "\"");
+            break;
+        case AggClause::SUM:
+            partials.push_back("sum(" + c.argSurface + ") AS \"" + p + "\"");
+            break;
+        case AggClause::MIN:
+            partials.push_back("min(" + c.argSurface + ") AS \"" + p + "\"");
+            break;
+        case AggClause::MAX:
+            partials.push_back("max(" + c.argSurface + ") AS \"" + p + "\"");
+            break;
+        case AggClause::AVG:
+            // An average doesn't merge; its sum and count parts do
+            partials.push_back("sum(" + c.argSurface + ") AS \"" + p + "s\"");
+            partials.push_back("count(" + c.argSurface + ") AS \"" + p + "c\"");
+            break;
+        }
+    }
+
+    Utf8String selectPart = "SELECT ";
+    for (size_t i = 0;  i < partials.size();  ++i)
+        selectPart += (i ? ", " : "") + partials[i];
+
+    Utf8String tailPart = whereTail;
+    for (size_t j = 0;  j < groupBy.clauses.size();  ++j) {
+        if (groupBy.clauses[j]->surface.empty())
+            throw AnnotatedException
+                (400, "Cannot ship group by clause to shards: the "
+                 "expression has no surface form");
+        selectPart += ", " + groupBy.clauses[j]->surface
+            + " AS \"__k" + to_string(j) + "\"";
+        tailPart += (j ? ", " : " GROUP BY ") + groupBy.clauses[j]->surface;
+    }
+
+    // groupKey -> one merge state per aggregate clause
+    std::map<std::vector<CellValue>, std::vector<PartialAccum> > groups;
+
+    for (auto & shardRows: itl->scatter(selectPart, tailPart)) {
+        for (auto & row: shardRows) {
+            std::map<ColumnPath, std::pair<CellValue, Date> > byName;
+            for (auto & col: row.columns)
+                byName[std::get<0>(col)]
+                    = { std::get<1>(col), std::get<2>(col) };
+
+            auto cell = [&] (const Utf8String & name) -> const CellValue &
+                {
+                    static const CellValue none;
+                    auto it = byName.find(PathElement(name));
+                    return it == byName.end() ? none : it->second.first;
+                };
+            auto cellTs = [&] (const Utf8String & name)
+                {
+                    auto it = byName.find(PathElement(name));
+                    return it == byName.end()
+                        ? Date::negativeInfinity() : it->second.second;
+                };
+
+            std::vector<CellValue> key;
+            for (size_t j = 0;  j < groupBy.clauses.size();  ++j)
+                key.push_back(cell("__k" + to_string(j)));
+
+            auto & accums = groups[key];
+            accums.resize(aggClauses.size());
+
+            for (size_t i = 0;  i < aggClauses.size();  ++i) {
+                PartialAccum & accum = accums[i];
+                Utf8String p = "__p" + to_string(i);
+                switch (aggClauses[i].op) {
+                case AggClause::COUNT: {
+                    const CellValue & v = cell(p);
+                    if (!v.empty()) {
+                        accum.count += v.toUInt();
+                        accum.any = true;
+                        accum.ts.setMax(cellTs(p));
+                    }
+                    break;
+                }
+                case AggClause::SUM: {
+                    const CellValue & v = cell(p);
+                    if (!v.empty()) {
+                        if (v.isInteger() && accum.intOnly)
+                            accum.isum += v.toInt();
+                        else
+                            accum.intOnly = false;
+                        accum.dsum += v.toDouble();
+                        accum.any = true;
+                        accum.ts.setMax(cellTs(p));
+                    }
+                    break;
+                }
+                case AggClause::MIN: {
+                    const CellValue & v = cell(p);
+                    if (!v.empty()) {
+                        if (!accum.any || v < accum.extreme)
+                            accum.extreme = v;
+                        accum.any = true;
+                        accum.ts.setMax(cellTs(p));
+                    }
+                    break;
+                }
+                case AggClause::MAX: {
+                    const CellValue & v = cell(p);
+                    if (!v.empty()) {
+                        if (!accum.any || accum.extreme < v)
+                            accum.extreme = v;
+                        accum.any = true;
+                        accum.ts.setMax(cellTs(p));
+                    }
+                    break;
+                }
+                case AggClause::AVG: {
+                    const CellValue & s = cell(p + "s");
+                    const CellValue & c = cell(p + "c");
+                    if (!c.empty() && c.toUInt() > 0) {
+                        accum.dsum += s.toDouble();
+                        accum.count += c.toUInt();
+                        accum.any = true;
+                        accum.ts.setMax(cellTs(p + "c"));
+                    }
+                    break;
+                }
+                }
+            }
+        }
+    }
+
+    // An ungrouped aggregate query returns its single row even over an
+    // empty dataset
+    if (groupBy.clauses.empty() && groups.empty())
+        groups[{}].resize(aggClauses.size());
+
+    std::vector<MatrixNamedRow> result;
+    for (auto & group: groups) {
+        std::vector<ExpressionValue> groupKey;
+        for (auto & k: group.first)
+            groupKey.emplace_back(k, Date::negativeInfinity());
+
+        MatrixNamedRow row;
+        row.rowName = groupKeyRowPath(groupKey);
+        row.rowHash = row.rowName;
+
+        for (size_t i = 0;  i < aggClauses.size();  ++i) {
+            const PartialAccum & accum = group.second[i];
+            CellValue merged;
+            switch (aggClauses[i].op) {
+            case AggClause::COUNT:
+                merged = accum.count;
+                break;
+            case AggClause::SUM:
+                if (accum.any)
+                    merged = accum.intOnly
+                        ? CellValue(accum.isum) : CellValue(accum.dsum);
+                break;
+            case AggClause::MIN:
+            case AggClause::MAX:
+                if (accum.any)
+                    merged = accum.extreme;
+                break;
+            case AggClause::AVG:
+                if (accum.count > 0)
+                    merged = accum.dsum / accum.count;
+                break;
+            }
+            row.columns.emplace_back(aggClauses[i].outputName,
+                                     std::move(merged), accum.ts);
+        }
+        result.emplace_back(std::move(row));
+    }
+
+    return applyOffsetLimit(offset, limit, result);
+}
+
+bool
+PartitionedDataset::
+queryStructuredIncremental(std::function<bool (Path &, ExpressionValue &)> & onRow,
+                           const SelectExpression & select,
+                           const WhenExpression & when,
+                           const SqlExpression & where,
+                           const OrderByExpression & orderBy,
+                           const TupleExpression & groupBy,
+                           const std::shared_ptr<SqlExpression> having,
+                           const std::shared_ptr<SqlExpression> rowName,
+                           ssize_t offset,
+                           ssize_t limit,
+                           Utf8String alias,
+                           const ProgressFunc & onProgress) const
+{
+    auto rows = queryStructured(select, when, where, orderBy, groupBy,
+                                having, rowName, offset, limit, alias);
+    for (auto & row: rows) {
+        ExpressionValue value(std::move(row.columns));
+        if (!onRow(row.rowName, value))
+            return false;
+    }
+    return true;
+}
+
+std::shared_ptr<MatrixView>
+PartitionedDataset::
+getMatrixView() const
+{
+    throw AnnotatedException
+        (400, "Partitioned datasets only support structured queries; "
+         "they have no row-level random access");
+}
+
+std::shared_ptr<ColumnIndex>
+PartitionedDataset::
+getColumnIndex() const
+{
+    throw AnnotatedException
+        (400, "Partitioned datasets only support structured queries; "
+         "they have no column index");
+}
+
+std::pair<Date, Date>
+PartitionedDataset::
+getTimestampRange() const
+{
+    // The base implementation expresses this as an ungrouped min/max
+    // aggregate query, which scatters and merges like any other
+    return Dataset::getTimestampRange();
+}
+
+static RegisterDatasetType<PartitionedDataset, PartitionedDatasetConfig>
+regPartitioned(builtinPackage(),
+               "partitioned",
+               "Query a dataset sharded over several local or remote datasets",
+               "datasets/PartitionedDataset.md.html");
+
+} // namespace MLDB
@@ -0,0 +1,113 @@
+/**                                                                 -*- C++ -*-
+ * partitioned_dataset.h
+ * Jeremy Barnes, 30 August 2026
+ * This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+ **/
+
+#pragma once
+
+#include "mldb/core/dataset.h"
+#include "mldb/types/value_description_fwd.h"
+
+namespace MLDB {
+
+
+/*****************************************************************************/
+/* PARTITIONED DATASET CONFIG                                                */
+/*****************************************************************************/
+
+struct PartitionShardConfig {
+    /// Local member dataset (config or id of an existing one).  Ignored
+    /// when peer is set.
+    PolyConfigT<const Dataset> dataset;
+
+    /// Base URL of the MLDB node owning the shard (eg
+    /// "http://mldb-3:1994").  Empty means the shard is local.
+    Utf8String peer;
+
+    /// Base URLs of further replicas of the shard.  Requests balance
+    /// over the peer and its replicas and hedge when one is slow.
+    std::vector<Utf8String> replicas;
+
+    /// Id of the dataset on the owning node.
+    Utf8String remoteName;
+};
+
+DECLARE_STRUCTURE_DESCRIPTION(PartitionShardConfig);
+
+struct PartitionedDatasetConfig {
+    std::vector<PartitionShardConfig> shards;
+};
+
+DECLARE_STRUCTURE_DESCRIPTION(PartitionedDatasetConfig);
+
+
+/*****************************************************************************/
+/* PARTITIONED DATASET                                                       */
+/*****************************************************************************/
+
+/** Dataset sharded over several member datasets, local or on other MLDB
+    nodes.  Queries scatter to every shard in parallel and the partial
+    results merge locally: decomposable aggregates (count, sum, min, max,
+    avg) over a GROUP BY ship one partial row per group per shard rather
+    than the underlying rows, and plain row queries ship only the rows
+    matching the pushed-down where clause.  Remote shards execute over
+    the peer's /v1/query endpoint; rows are assumed disjoint between
+    shards.
+
+    Only structured queries are supported; there is no row-level random
+    access, so the dataset cannot be joined against or transposed.
+*/
+struct PartitionedDataset: public Dataset {
+
+    PartitionedDataset(MldbEngine * owner,
+                       PolyConfig config,
+                       const ProgressFunc & onProgress);
+
+    virtual ~PartitionedDataset() override;
+
+    virtual Any getStatus() const override;
+
+    virtual void recordRowItl(const RowPath & rowPath,
+        const std::vector<std::tuple<ColumnPath, CellValue, Date> > & vals) override
+    {
+        throw MLDB::Exception("Dataset type doesn't allow recording");
+    }
+
+    virtual std::vector<MatrixNamedRow>
+    queryStructured(const SelectExpression & select,
+                    const WhenExpression & when,
+                    const SqlExpression & where,
+                    const OrderByExpression & orderBy,
+                    const TupleExpression & groupBy,
+                    const std::shared_ptr<SqlExpression> having,
+                    const std::shared_ptr<SqlExpression> rowName,
+                    ssize_t offset,
+                    ssize_t limit,
+                    Utf8String alias = "") const override;
+
+    virtual bool
+    queryStructuredIncremental(std::function<bool (Path &, ExpressionValue &)> & onRow,
+                               const SelectExpression & select,
+                               const WhenExpression & when,
+                               const SqlExpression & where,
+                               const OrderByExpression & orderBy,
+                               const TupleExpression & groupBy,
+                               const std::shared_ptr<SqlExpression> having,
+                               const std::shared_ptr<SqlExpression> rowName,
+                               ssize_t offset,
+                               ssize_t limit,
+                               Utf8String alias = "",
+                               const ProgressFunc & onProgress = nullptr) const override;
+
+    virtual std::shared_ptr<MatrixView> getMatrixView() const override;
+    virtual std::shared_ptr<ColumnIndex> getColumnIndex() const override;
+
+    virtual std::pair<Date, Date> getTimestampRange() const override;
+
+private:
+    struct Itl;
+    std::shared_ptr<Itl> itl;
+};
+
+} // namespace MLDB
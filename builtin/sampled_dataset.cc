@@ -7,10 +7,12 @@
 #include "mldb/sql/sql_expression.h"
 #include "sampled_dataset.h"
 #include "mldb/utils/lightweight_hash.h"
+#include "mldb/utils/row_bitmap.h"
 #include "mldb/types/any_impl.h"
 #include "mldb/types/structure_description.h"
 #include "mldb/core/dataset_scope.h"
 #include "mldb/types/annotated_exception.h"
+#include <mutex>
 #include <random>
 #include <unordered_set>
 
@@ -53,6 +55,16 @@ void validateConfig(SampledDatasetConfig * config)
         throw MLDB::Exception(SampledDataset::getErrorMsg(MLDB::format("The 'fraction' parameter needs to "
                     "be between 0 and 1. Value provided is '%0.4f'", config->fraction)));
     }
+    if (!config->stratifyBy.empty()) {
+        if (config->rows != 0) {
+            throw MLDB::Exception(SampledDataset::getErrorMsg("The 'stratifyBy' parameter "
+                        "requires 'fraction'; it cannot be used with 'rows'."));
+        }
+        if (config->withReplacement) {
+            throw MLDB::Exception(SampledDataset::getErrorMsg("The 'stratifyBy' parameter "
+                        "cannot be used with 'withReplacement'."));
+        }
+    }
 }
 
 DEFINE_STRUCTURE_DESCRIPTION(SampledDatasetConfig);
@@ -80,6 +92,12 @@ SampledDatasetConfigDescription()
               "this parameter is to permit reproducible random samples. "
               "This parameter is optional, with the default value being "
               "selected randomly for each sample.");
+    addField("stratifyBy", &SampledDatasetConfig::stratifyBy,
+              "Optional column whose values define strata. When set, the "
+              "`fraction` sample is drawn independently within each distinct "
+              "value of this column, so every stratum keeps the sampling "
+              "fraction. Only the stratification column is scanned to draw "
+              "the sample. Cannot be used with `rows` or `withReplacement`.");
 
     onPostValidate = [] (SampledDatasetConfig * config,
                          JsonParsingContext & context)
@@ -104,24 +122,51 @@ struct SampledDataset::Itl
     std::shared_ptr<ColumnIndex> index;
     size_t columnCount;
 
-    std::unordered_set<RowPath> sampledRowsIndex;
-    std::vector<RowPath> sampledRows;
-    std::vector<RowHash> sampledRowsHash;
+    SampledDatasetConfig config;
+
+    /// The sample is drawn lazily, on first access, so that creating
+    /// the view costs nothing and queries only ever touch sampled rows
+    mutable std::once_flag sampleOnce;
+    mutable std::unordered_set<RowPath> sampledRowsIndex;
+    mutable std::vector<RowPath> sampledRows;
+    mutable std::vector<RowHash> sampledRowsHash;
 
     Itl(MldbEngine * engine, std::shared_ptr<Dataset> dataset,
             const SampledDatasetConfig config)
         : dataset(dataset),
           matrix(dataset->getMatrixView()),
           index(dataset->getColumnIndex()),
-          columnCount(matrix->getColumnPaths().size())
+          columnCount(matrix->getColumnPaths().size()),
+          config(config)
+    {
+    }
+
+    void ensureSampled() const
+    {
+        std::call_once(sampleOnce, [&] ()
+            {
+                if (config.stratifyBy.empty())
+                    sampleUniform();
+                else
+                    sampleStratified();
+            });
+    }
+
+    void recordSampledRow(RowPath rowName) const
     {
-        // get all existing rows
-        auto rows = matrix->getRowHashes();
+        sampledRowsHash.emplace_back(rowName);
+        sampledRowsIndex.insert(rowName);
+        sampledRows.emplace_back(std::move(rowName));
+    }
 
-        unsigned numRows = config.rows != 0 ? config.rows
-                                            : rows.size() * config.fraction;
+    void sampleUniform() const
+    {
+        uint64_t totalRows = dataset->getRowCount();
 
-        if(!config.withReplacement && numRows > rows.size()) {
+        uint64_t numRows = config.rows != 0 ? config.rows
+                                            : totalRows * config.fraction;
+
+        if(!config.withReplacement && numRows > totalRows) {
             throw MLDB::Exception("Requested more rows without replacement than "
                     "available number of rows in original dataset.");
         }
@@ -130,31 +175,101 @@ struct SampledDataset::Itl
 
         // do the sampling
         std::mt19937 gen(config.seed);
-        std::uniform_int_distribution<> dis(0, rows.size() - 1);
+        std::uniform_int_distribution<uint64_t> dis(0, totalRows - 1);
 
-        unordered_set<unsigned> sampledIndexes;
-        while(sampledRows.size() < numRows) {
-            unsigned sample_index = dis(gen);
+        // Compressed bitmap over the candidate indexes; far more compact
+        // than a hash set when sampling a large fraction of a big dataset
+        RowBitmap sampledIndexes;
+        std::vector<uint64_t> indexes;
+        indexes.reserve(numRows);
+        while(indexes.size() < numRows) {
+            uint64_t sample_index = dis(gen);
 
             // if we're not sampling with replacement, check if
             // we already sampled this index
-            if(!config.withReplacement) {
-                if(sampledIndexes.count(sample_index))
-                    continue;
+            if(!config.withReplacement && !sampledIndexes.insert(sample_index))
+                continue;
 
-                sampledIndexes.insert(sample_index);
+            indexes.push_back(sample_index);
+        }
+        std::sort(indexes.begin(), indexes.end());
+
+        auto stream = dataset->getRowStream();
+        if (stream) {
+            // Jump the row stream straight to each sampled position, so
+            // that only sampled rows are ever touched
+            uint64_t lastIndex = (uint64_t)-1;
+            for (uint64_t i: indexes) {
+                if (i == lastIndex) {
+                    // sampled with replacement; repeat the previous row
+                    recordSampledRow(sampledRows.back());
+                    continue;
+                }
+                stream->initAt(i);
+                recordSampledRow(stream->next());
+                lastIndex = i;
             }
+        }
+        else {
+            // No row stream; fall back to enumerating the candidates
+            auto rows = matrix->getRowHashes();
+            for (uint64_t i: indexes)
+                recordSampledRow(matrix->getRowPath(rows[i]));
+        }
+    }
 
-            sampledRowsHash.emplace_back(rows[sample_index]);
-
-            auto rowName = matrix->getRowPath(rows[sample_index]);
-            sampledRows.emplace_back(rowName);
-            sampledRowsIndex.insert(rowName);
+    /** Draw the sampling fraction independently within each stratum,
+        where the strata are the distinct values of the stratification
+        column.  Only the stratification column is scanned; the rows
+        themselves are never touched.  Selection within a stratum takes
+        the rows with the smallest seed-keyed hash, so the sample is
+        reproducible for a given seed. */
+    void sampleStratified() const
+    {
+        if (!matrix->knownColumn(config.stratifyBy))
+            throw AnnotatedException
+                (400, "Stratification column '"
+                 + config.stratifyBy.toUtf8String()
+                 + "' doesn't exist in the sampled dataset");
+
+        auto vals = index->getColumnValues(config.stratifyBy);
+
+        std::map<CellValue, std::vector<RowPath> > strata;
+        for (auto & v: vals)
+            strata[std::get<1>(v)].emplace_back(std::move(std::get<0>(v)));
+
+        uint64_t seedMix = (uint64_t)config.seed * 0x9E3779B97F4A7C15ULL;
+        auto keyedHash = [&] (const RowPath & row)
+            {
+                return RowHash(row).hash() ^ seedMix;
+            };
+
+        for (auto & s: strata) {
+            auto & rows = s.second;
+            size_t numToTake = std::llround(rows.size() * (double)config.fraction);
+            if (numToTake == 0)
+                continue;
+
+            std::partial_sort(rows.begin(), rows.begin() + numToTake,
+                              rows.end(),
+                              [&] (const RowPath & r1, const RowPath & r2)
+                              {
+                                  return keyedHash(r1) < keyedHash(r2);
+                              });
+
+            for (size_t i = 0;  i < numToTake;  ++i) {
+                // A row can appear once per value of the column; keep it
+                // only once
+                if (sampledRowsIndex.count(rows[i]))
+                    continue;
+                recordSampledRow(std::move(rows[i]));
+            }
         }
     }
 
     virtual RowPath getRowPath(const RowHash & row) const
     {
+        ensureSampled();
         auto rowName = matrix->getRowPath(row);
         if(!knownRow(rowName))
             throw MLDB::Exception("Can't get name of unknown row");
@@ -165,6 +280,7 @@ struct SampledDataset::Itl
     virtual std::vector<RowPath>
     getRowPaths(ssize_t start = 0, ssize_t limit = -1) const
     {
+        ensureSampled();
         std::vector<RowPath> rtn;
         rtn.reserve(sampledRows.size() - start);
 
@@ -181,6 +297,7 @@ struct SampledDataset::Itl
     virtual std::vector<RowHash>
     getRowHashes(ssize_t start = 0, ssize_t limit = -1) const
     {
+        ensureSampled();
         std::vector<RowHash> rtn;
         rtn.reserve(sampledRows.size() - start);
 
@@ -196,6 +313,7 @@ struct SampledDataset::Itl
 
     virtual bool knownRow(const RowPath & row) const
     {
+        ensureSampled();
         return sampledRowsIndex.count(row);
     }
 
@@ -233,6 +351,7 @@ struct SampledDataset::Itl
 
     virtual uint64_t getRowCount() const
     {
+        ensureSampled();
         return sampledRows.size();
     }
 
@@ -251,6 +370,7 @@ struct SampledDataset::Itl
 
     virtual MatrixColumn getColumn(const ColumnPath & column) const
     {
+        ensureSampled();
         auto col = index->getColumn(column);
 
         std::vector<std::tuple<RowPath, CellValue, Date> > allRows = std::move(col.rows);
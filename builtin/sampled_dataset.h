@@ -27,6 +27,7 @@ struct SampledDatasetConfig {
     unsigned rows;
     float fraction;
     bool withReplacement;
+    ColumnPath stratifyBy;
 };
 
 DECLARE_STRUCTURE_DESCRIPTION(SampledDatasetConfig);
@@ -99,6 +99,12 @@ struct SqlExpressionFunction: public Function {
 
     virtual FunctionInfo getFunctionInfo() const;
 
+    /** A prepared expression is bound once at creation against its
+        declared input, so its applier holds no per-call state and
+        call() can reuse a single one across calls and threads.
+    */
+    virtual bool canReuseApplier() const;
+
     SqlExpressionFunctionConfig functionConfig;
 
     std::unique_ptr<SqlExpressionMldbScope> outerScope;
@@ -135,6 +141,9 @@ struct TransformDatasetConfig : ProcedureConfig {
 
     /// Skip rows with no columns
     bool skipEmptyRows;
+
+    /// Use the fused chunk-parallel executor when the query shape allows
+    bool fused;
 };
 
 
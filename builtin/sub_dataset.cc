@@ -269,10 +269,8 @@ struct SubDataset::Itl
         {
             const PathElement & cName = std::get<0>(c);
 
-            if (std::find(columnNameSet.begin(), columnNameSet.end(), cName) == columnNameSet.end()
-                && std::find(chunk.columnNames.begin(), chunk.columnNames.end(), cName) == chunk.columnNames.end()) {
+            if (!chunk.columnNames.count(cName))
                 columnNameSet.insert(cName);
-            }
 
             Date ts = std::get<1>(c).getEffectiveTimestamp();
             
@@ -309,7 +307,12 @@ struct SubDataset::Itl
         std::lock_guard<std::mutex> lock(recordLock);
         //STACK_PROFILE(commitWrites);
         size_t start = mainChunk.subOutput.size();
-        mainChunk.subOutput.insert( mainChunk.subOutput.begin(), 
+        // Append the chunk's rows.  Inserting at the front (as this
+        // used to do) shifts every previously committed row, which
+        // both invalidates their row index entries and makes each
+        // chunk commit cost the size of everything committed so far.
+        mainChunk.subOutput.reserve(start + newChunk.subOutput.size());
+        mainChunk.subOutput.insert( mainChunk.subOutput.end(),
                                     make_move_iterator(newChunk.subOutput.begin()),  
                                     make_move_iterator(newChunk.subOutput.end()));
         mainChunk.columnNames.insert( newChunk.columnNames.begin(),  newChunk.columnNames.end());
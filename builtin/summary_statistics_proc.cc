@@ -22,6 +22,7 @@
 #include "mldb/builtin/sql_config_validator.h"
 #include "mldb/utils/log.h"
 #include "mldb/utils/progress.h"
+#include "mldb/utils/quantile_sketch.h"
 #include <memory>
 
 
@@ -255,14 +256,12 @@ struct NumericRowHandler {
         select = SelectExpression::parse("count(" + name + ") AS _0, "
                                          + name + " AS _1");
         auto groupBy = TupleExpression::parse(name);
-        auto orderBy = OrderByExpression::parse(name);
         auto where = SqlExpression::parse(name + " IS NOT NULL");
-        const int NUM_QUARTILES = 3;
-        double quartiles[NUM_QUARTILES];
-        double quartilesThreshold[NUM_QUARTILES] = {numNotNull * 0.25,
-                                                    numNotNull * 0.5,
-                                                    numNotNull * 0.75};
-        int idx = 0;
+
+        // The quantiles come from a mergeable sketch fed with the
+        // (value, count) pairs, so the group by doesn't need an ORDER BY
+        // and the values never get sorted.
+        QuantileSketch sketch;
         int64_t count = 0;
         MostFrequents<double, 10> mostFrequents; // Keep top 10
         auto onRow2 = [&] (NamedRowValue & row) {
@@ -273,13 +272,10 @@ struct NumericRowHandler {
                 first = false;
             }
             int64_t currentCount = std::get<1>(cols[0]).toInt();
-            mostFrequents.addItem(make_pair(currentCount,
-                                            std::get<1>(cols[1]).toDouble()));
+            double currentValue = std::get<1>(cols[1]).toDouble();
+            mostFrequents.addItem(make_pair(currentCount, currentValue));
             count += currentCount;
-            while (idx < NUM_QUARTILES && quartilesThreshold[idx] < count) {
-                quartiles[idx] = std::get<1>(cols[1]).toDouble();
-                ++idx;
-            }
+            sketch.add(currentValue, currentCount);
             return true;
         };
         ConvertProgressToJson convertProgressToJson(onProgress);
@@ -292,17 +288,16 @@ struct NumericRowHandler {
                         aggregators,
                         *config.inputData.stm->having,
                         *config.inputData.stm->rowName,
-                        orderBy)
+                        OrderByExpression())
             .execute({onRow2, false /*processInParallel*/},
                      0, // offset
                      -1, // limit
                      convertProgressToJson);
         ExcAssert(count == numNotNull);
-        ExcAssert(idx == NUM_QUARTILES);
         vector<Cell> toRecord;
-        toRecord.emplace_back(value + "1st_quartile", quartiles[0], now);
-        toRecord.emplace_back(value + "median", quartiles[1], now);
-        toRecord.emplace_back(value + "3rd_quartile", quartiles[2], now);
+        toRecord.emplace_back(value + "1st_quartile", sketch.quantile(0.25), now);
+        toRecord.emplace_back(value + "median", sketch.quantile(0.5), now);
+        toRecord.emplace_back(value + "3rd_quartile", sketch.quantile(0.75), now);
         for (int i = 0; i < mostFrequents.currSize; ++ i) {
             toRecord.emplace_back(
                 // CellValue::to_string returns "1" instead of "1.00000"
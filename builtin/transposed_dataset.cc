@@ -12,6 +12,9 @@
 #include "mldb/types/any_impl.h"
 #include "mldb/types/structure_description.h"
 #include "mldb/engine/dataset_utils.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 using namespace std;
 
@@ -51,6 +54,86 @@ struct TransposedDataset::Itl
     std::shared_ptr<ColumnIndex> index;
     size_t columnCount;
 
+    /** Byte-budgeted LRU cache of materialized transposed columns.
+
+        A transposed column is a row of the source dataset, and fetching
+        one walks the source's row representation.  Workloads that touch
+        each column many times (correlation matrices, column-wise stats)
+        would otherwise re-walk the same source row on every access.
+        The first access materializes the column; it then stays cached
+        until the byte budget pushes it out, least recently used first,
+        or until a commit on the source dataset makes new data visible,
+        which drops the whole cache (see clearCacheOnCommit()).
+    */
+    struct ColumnCache {
+        static constexpr size_t BUDGET_BYTES = 256ULL * 1024 * 1024;
+
+        std::shared_ptr<const MatrixColumn> get(uint64_t key) const
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+            auto it = entries.find(key);
+            if (it == entries.end())
+                return nullptr;
+            lru.splice(lru.begin(), lru, it->second.lruIt);
+            return it->second.column;
+        }
+
+        void clear() const
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+            entries.clear();
+            lru.clear();
+            currentBytes = 0;
+        }
+
+        void put(uint64_t key,
+                 std::shared_ptr<const MatrixColumn> column) const
+        {
+            size_t bytes = columnBytes(*column);
+            if (bytes > BUDGET_BYTES)
+                return;  // would evict everything else for one entry
+
+            std::unique_lock<std::mutex> guard(mutex);
+            if (entries.count(key))
+                return;  // raced with another thread; keep theirs
+
+            currentBytes += bytes;
+            while (currentBytes > BUDGET_BYTES && !lru.empty()) {
+                auto evictIt = entries.find(lru.back());
+                currentBytes -= evictIt->second.bytes;
+                entries.erase(evictIt);
+                lru.pop_back();
+            }
+
+            lru.push_front(key);
+            entries[key] = { std::move(column), bytes, lru.begin() };
+        }
+
+    private:
+        static size_t columnBytes(const MatrixColumn & col)
+        {
+            size_t result = sizeof(MatrixColumn) + col.columnName.memusage();
+            for (auto & r: col.rows)
+                result += std::get<0>(r).memusage()
+                    + std::get<1>(r).memusage()
+                    + sizeof(Date);
+            return result;
+        }
+
+        struct Entry {
+            std::shared_ptr<const MatrixColumn> column;
+            size_t bytes;
+            std::list<uint64_t>::iterator lruIt;
+        };
+
+        mutable std::mutex mutex;
+        mutable size_t currentBytes = 0;
+        mutable std::unordered_map<uint64_t, Entry> entries;
+        mutable std::list<uint64_t> lru;  ///< front is most recently used
+    };
+
+    ColumnCache columnCache;
+
     Itl(MldbEngine * engine, std::shared_ptr<Dataset> dataset)
         : dataset(dataset),
           matrix(dataset->getMatrixView()),
@@ -59,6 +142,42 @@ struct TransposedDataset::Itl
     {
     }
 
+    /** Register the commit hook that drops the cached columns whenever
+        the source publishes new data, so a transposed view over a
+        mutable dataset never serves stale columns.  The source keeps
+        its callbacks for its own lifetime, which can exceed ours, so
+        the hook only holds the representation weakly. */
+    static void clearCacheOnCommit(const std::shared_ptr<Itl> & itl)
+    {
+        std::weak_ptr<Itl> weak = itl;
+        itl->dataset->addOnCommitCallback
+            ([weak] (Dataset &)
+             {
+                 if (auto itl = weak.lock())
+                     itl->columnCache.clear();
+             });
+    }
+
+    /** Return the given transposed column, materializing it from the
+        source row on first access and serving it from the cache
+        afterwards. */
+    std::shared_ptr<const MatrixColumn>
+    getMaterializedColumn(const ColumnPath & column) const
+    {
+        uint64_t key = ColumnHash(column).hash();
+        if (auto cached = columnCache.get(key))
+            return cached;
+
+        auto row = matrix->getRow(colToRow(column));
+        auto result = std::make_shared<MatrixColumn>();
+        result->columnName = rowToCol(std::move(row.rowName));
+        result->columnHash = rowToCol(row.rowHash);
+        result->rows = colToRow(std::move(row.columns));
+
+        columnCache.put(key, result);
+        return result;
+    }
+
     struct TransposedRowStream : public RowStream {
 
         TransposedRowStream(TransposedDataset::Itl* source) : source(source)
@@ -249,19 +368,19 @@ struct TransposedDataset::Itl
     virtual const ColumnStats &
     getColumnStats(const ColumnPath & columnName, ColumnStats & stats) const
     {
-        auto row = matrix->getRow(colToRow(columnName));
+        auto col = getMaterializedColumn(columnName);
 
         stats = ColumnStats();
 
-        LightweightHashSet<ColumnHash> columns;
+        LightweightHashSet<RowHash> rows;
         bool oneOnly = true;
         bool isNumeric = true;
 
-        for (auto & c: row.columns) {
-            ColumnHash ch = std::get<0>(c);
+        for (auto & c: col->rows) {
+            RowHash rh = std::get<0>(c);
             const CellValue & v = std::get<1>(c);
 
-            if (!columns.insert(ch).second)
+            if (!rows.insert(rh).second)
                 oneOnly = false;
             
             if (!v.isNumber())
@@ -271,8 +390,8 @@ struct TransposedDataset::Itl
             stats.values[v].rowCount_ += 1;
         }
 
-        stats.isNumeric_ = isNumeric && !row.columns.empty();
-        stats.rowCount_ = columns.size();
+        stats.isNumeric_ = isNumeric && !col->rows.empty();
+        stats.rowCount_ = rows.size();
         stats.atMostOne_ = oneOnly;
         return stats;
     }
@@ -290,12 +409,7 @@ struct TransposedDataset::Itl
     /** Return the value of the column for all rows and timestamps. */
     virtual MatrixColumn getColumn(const ColumnPath & column) const
     {
-        auto row = matrix->getRow(colToRow(column));
-        MatrixColumn result;
-        result.columnName = rowToCol(row.rowName);
-        result.columnHash = rowToCol(row.rowHash);
-        result.rows = colToRow(std::move(row.columns));
-        return result;
+        return *getMaterializedColumn(column);
     }
 
     virtual uint64_t getRowCount() const
@@ -333,6 +447,7 @@ TransposedDataset(MldbEngine * owner,
                                                      nullptr /*onProgress*/);
 
     itl.reset(new Itl(engine, dataset));
+    Itl::clearCacheOnCommit(itl);
 }
 
 TransposedDataset::
@@ -341,6 +456,7 @@ TransposedDataset(MldbEngine * owner,
     : Dataset(owner)
 {
     itl.reset(new Itl(engine, dataset));
+    Itl::clearCacheOnCommit(itl);
 }
 
 TransposedDataset::
@@ -5,6 +5,8 @@
  **/
 #include "union_dataset.h"
 
+#include "mldb/sql/sql_expression.h"
+
 #include <thread>
 #include <math.h>
 
@@ -435,6 +437,62 @@ getRowStream() const
     return make_shared<UnionDataset::Itl::UnionRowStream>(itl.get());
 }
 
+GenerateRowsWhereFunction
+UnionDataset::
+generateRowsWhere(const SqlBindingScope & context,
+                  const Utf8String & alias,
+                  const SqlExpression & where,
+                  ssize_t offset,
+                  ssize_t limit) const
+{
+    // A row of the union has exactly the contents of the matching row of
+    // its member dataset; only its name gains the dataset index prefix.
+    // A where expression with no function calls (rowName() and friends
+    // would see the unprefixed name) therefore selects the same rows on
+    // each member as on the union, and can be pushed down so that each
+    // member uses its own indexes.
+    UnboundEntities unbound = where.getUnbound();
+    if (!unbound.funcs.empty())
+        return Dataset::generateRowsWhere(context, alias, where,
+                                          offset, limit);
+
+    std::vector<GenerateRowsWhereFunction> generators;
+    generators.reserve(itl->datasets.size());
+    auto complexity = GenerateRowsWhereFunction::CONSTANT;
+    Utf8String explain;
+    for (auto & d: itl->datasets) {
+        generators.emplace_back(d->generateRowsWhere(context, alias, where,
+                                                     0, -1));
+        complexity = std::max(complexity, generators.back().complexity);
+        if (!explain.empty())
+            explain += "; ";
+        explain += generators.back().explain;
+    }
+
+    auto exec = [offset, limit, generators = std::move(generators)]
+        (ssize_t numToGenerate, Any token,
+         const BoundParameters & params,
+         const ProgressFunc & onProgress)
+        -> std::pair<std::vector<RowPath>, Any>
+        {
+            std::vector<RowPath> rows;
+            for (int i = 0;  i < generators.size();  ++i) {
+                auto subRows
+                    = generators[i](-1, Any(), params, onProgress).first;
+                rows.reserve(rows.size() + subRows.size());
+                for (auto & r: subRows)
+                    rows.emplace_back(PathElement(i) + std::move(r));
+            }
+
+            rows = applyOffsetLimit(offset, limit, rows);
+            return { std::move(rows), Any() };
+        };
+
+    return GenerateRowsWhereFunction(std::move(exec),
+                                     "union pushdown: [" + explain + "]",
+                                     complexity);
+}
+
 ExpressionValue
 UnionDataset::
 getRowExpr(const RowPath & rowPath) const
@@ -53,6 +53,16 @@ struct UnionDataset: public Dataset {
     virtual std::pair<Date, Date> getTimestampRange() const override;
     virtual ExpressionValue getRowExpr(const RowPath & rowPath) const override;
 
+    /** Push row generation down to each member dataset when the where
+        expression only depends on row contents, composing the results
+        with the union's row name prefix. */
+    virtual GenerateRowsWhereFunction
+    generateRowsWhere(const SqlBindingScope & context,
+                      const Utf8String & alias,
+                      const SqlExpression & where,
+                      ssize_t offset,
+                      ssize_t limit) const override;
+
 private:
     UnionDatasetConfig datasetConfig;
     struct Itl;
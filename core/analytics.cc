@@ -17,6 +17,7 @@
 #include "mldb/sql/execution_pipeline.h"
 #include <boost/algorithm/string.hpp>
 #include "mldb/core/bound_queries.h"
+#include "mldb/core/query_profile.h"
 #include "mldb/base/parallel_merge_sort.h"
 #include "mldb/utils/distribution.h"
 #include <mutex>
@@ -173,9 +174,11 @@ void iterateDense(const SelectExpression & select,
     // This function lets us efficiently extract the embedding from each row
     auto extractEmbedding = boundSelect.info->extractDoubleEmbedding(columns);
 
-    // Get a list of rows that we run over
+    // Get a list of rows that we run over, shared with any concurrent
+    // scans of the same dataset.
     // getRowPaths can return row names in an arbitrary order as long as it is deterministic.
-    auto rows = matrix->getRowPaths();
+    auto rowsShared = from.getSharedRowPaths();
+    const std::vector<RowPath> & rows = *rowsShared;
 
     auto doRow = [&] (int rowNum) -> bool
         {
@@ -425,8 +428,10 @@ queryFromStatementExpr(const SelectStatement & stm,
     };
 
     auto & bindProgress = onProgress ? bind(joinedProgress, 0, _1) : onProgress;
+    Timer bindTimer;
     BoundTableExpression table = stm.from->bind(scope, bindProgress);
-    
+    QueryProfile::record("bindFrom", bindTimer);
+
     auto & iterateProgress = onProgress ? bind(joinedProgress, 1, _1) : onProgress;
     if (table.dataset) {
         return table.dataset->queryStructuredExpr(stm.select, stm.when,
@@ -451,12 +456,18 @@ queryFromStatementExpr(const SelectStatement & stm,
                 throw AnnotatedException(500, "No query parameter " + param); 
             };
 
+        Timer pipelineBindTimer;
+
         std::shared_ptr<PipelineElement> pipeline = PipelineElement::root(scope)->statement(stm, getParamInfo);
 
         auto boundPipeline = pipeline->bind();
 
         auto executor = boundPipeline->start(params);
-        
+
+        QueryProfile::record("bindPipeline", pipelineBindTimer);
+
+        Timer pipelineRunTimer;
+
         std::vector<NamedRowValue> rows;
 
         ssize_t limit = stm.limit;
@@ -485,8 +496,10 @@ queryFromStatementExpr(const SelectStatement & stm,
             output->values.back().mergeToRowDestructive(row.columns);
             rows.emplace_back(std::move(row));
         }
-            
-        return std::make_tuple<std::vector<NamedRowValue>, 
+
+        QueryProfile::record("executePipeline", pipelineRunTimer, 0, rows.size());
+
+        return std::make_tuple<std::vector<NamedRowValue>,
                               std::shared_ptr<ExpressionValueInfo> >(std::move(rows), std::make_shared<UnknownRowValueInfo>());
     }
     else {
@@ -7,20 +7,28 @@
 */
 
 #include "mldb/core/bound_queries.h"
+#include "mldb/core/cancellation.h"
 #include "mldb/core/dataset.h"
 #include "mldb/core/dataset_scope.h"
+#include "mldb/core/query_profile.h"
+#include "mldb/rest/metrics_registry.h"
 #include "mldb/base/parallel.h"
 #include "mldb/base/per_thread_accumulator.h"
 #include "mldb/base/parallel_merge_sort.h"
 #include "mldb/arch/timers.h"
 #include "mldb/types/basic_value_descriptions.h"
 #include "mldb/sql/sql_expression_operations.h"
+#include "mldb/sql/sql_expression_cse.h"
 #include "mldb/sql/sql_utils.h"
 #include "mldb/types/annotated_exception.h"
 #include "mldb/utils/log.h"
+#include "mldb/utils/memory_arena.h"
+#include "mldb/utils/environment.h"
+#include "mldb/block/file_serializer.h"
 #include "mldb/arch/demangle.h"
 
 #include <boost/algorithm/string.hpp>
+#include <future>
 
 #include "mldb/utils/profile.h"
 
@@ -186,8 +194,16 @@ struct UnorderedExecutor: public BoundSelectQuery::Executor {
         size_t effectiveNumBucket = std::min((size_t)numBuckets, numRows);
         std::atomic_ulong rowCount(0);
         ProgressState progress(numRows);
+
+        // Captured here since the per-row checks run on pool threads
+        auto cancellation = currentCancellationToken();
+
+        // Per-thread scratch arenas, reset as each row starts
+        PerThreadAccumulator<MemoryArena> arenas;
+
         auto doRow = [&] (size_t rowNum) -> bool
             {
+                checkCancellation(cancellation);
                 ++rowCount;
 
                 if (rowCount % PROGRESS_RATE == 0) {
@@ -202,7 +218,7 @@ struct UnorderedExecutor: public BoundSelectQuery::Executor {
 
                 ExpressionValue row = dataset.getRowExpr(rows[rowNum]);
                 auto output = processRow(rows[rowNum], row, rowNum, numPerBucket,
-                                         selectStar);
+                                         selectStar, &arenas.get());
 
                 int bucketNumber
                     = numBuckets > 0
@@ -246,42 +262,80 @@ struct UnorderedExecutor: public BoundSelectQuery::Executor {
                     return parallelMapHaltable(offset, upper, doRow);
                 }
                 else {
-                    // TODO: to reduce memory usage, we should fill blocks of
-                    // output on worker threads
-                    // in order as much as possible
-                    // while calling the aggregator on the caller thread.
+                    // Fill blocks of output on worker threads while the
+                    // caller's processor consumes them in order.  The next
+                    // block is computed in the background as the current one
+                    // is consumed, so serial per-row processing (eg rendering
+                    // and writing an export) overlaps with the parallel row
+                    // evaluation, and memory stays bounded by the block size
+                    // rather than the result size.
                     ExcAssert(offset >= 0 && offset <= upper);
-                    std::vector<std::tuple<Path, ExpressionValue, std::vector<ExpressionValue> > >
-                        output(upper-offset);
-                
+
+                    constexpr size_t BLOCK_SIZE = 65536;
+
+                    typedef std::vector<std::tuple<Path, ExpressionValue, std::vector<ExpressionValue> > > Block;
+
                     ProgressState progress(upper-offset);
-                    auto copyRow = [&] (int rowNum) -> bool
+                    std::atomic<bool> stop(false);
+
+                    auto computeBlock = [&] (size_t first, size_t last) -> Block
                         {
-                            if (rowNum % PROGRESS_RATE == 0) {
-                                if (onProgress) {
-                                    progress = rowNum;
-                                    if (!onProgress(progress)) {
-                                        DEBUG_MSG(logger) << "dataset iteration was cancelled";
-                                        return false;
+                            Block output(last - first);
+                            auto copyRow = [&] (int rowNum) -> bool
+                                {
+                                    checkCancellation(cancellation);
+                                    if (rowNum % PROGRESS_RATE == 0) {
+                                        if (onProgress) {
+                                            progress = rowNum;
+                                            if (!onProgress(progress)) {
+                                                DEBUG_MSG(logger) << "dataset iteration was cancelled";
+                                                return false;
+                                            }
+                                        }
                                     }
-                                }
-                            }
-                            auto row = dataset.getRowExpr(rows[rowNum]);
-                            auto outputRow = processRow(rows[rowNum], row, rowNum,
-                                                        numPerBucket, selectStar);
-                            output[rowNum-offset] = std::move(outputRow);
-                            return true;
+                                    auto row = dataset.getRowExpr(rows[rowNum]);
+                                    auto outputRow = processRow(rows[rowNum], row, rowNum,
+                                                                numPerBucket, selectStar,
+                                                                &arenas.get());
+                                    output[rowNum - first] = std::move(outputRow);
+                                    return true;
+                                };
+                            if (!parallelMapHaltable(first, last, copyRow))
+                                stop = true;
+                            return output;
                         };
 
-                    DEBUG_MSG(logger) << "iterating rows sequentially";
-                    if (!parallelMapHaltable(offset, upper, copyRow))
-                        return false;
+                    DEBUG_MSG(logger) << "iterating rows sequentially in blocks";
+
+                    size_t first = offset;
+                    size_t last = std::min<size_t>(first + BLOCK_SIZE, upper);
+                    std::future<Block> pending
+                        = std::async(std::launch::async, computeBlock, first, last);
 
-                    for (size_t i = offset; i < upper; ++i) {
-                        auto& outputRow = output[i-offset];
-                        if (!processor(std::get<0>(outputRow), std::get<1>(outputRow),
-                                       std::get<2>(outputRow), -1))
+                    while (first < last) {
+                        Block block = pending.get();
+                        if (stop)
                             return false;
+
+                        // Kick off the next block before consuming this one
+                        size_t nextFirst = last;
+                        size_t nextLast = std::min<size_t>(nextFirst + BLOCK_SIZE, upper);
+                        bool hasNext = nextFirst < nextLast;
+                        if (hasNext)
+                            pending = std::async(std::launch::async, computeBlock,
+                                                 nextFirst, nextLast);
+
+                        for (auto & outputRow: block) {
+                            if (!processor(std::get<0>(outputRow), std::get<1>(outputRow),
+                                           std::get<2>(outputRow), -1)) {
+                                if (hasNext)
+                                    pending.wait();
+                                return false;
+                            }
+                        }
+
+                        first = nextFirst;
+                        last = nextLast;
                     }
                 }
             }
@@ -328,17 +382,23 @@ struct UnorderedExecutor: public BoundSelectQuery::Executor {
 
         std::atomic_ulong bucketCount(0);
         ProgressState progress(effectiveNumBucket);
+        auto cancellation = currentCancellationToken();
         auto doBucket = [&] (int bucketNumber) -> bool
             {
                 size_t it = bucketNumber * numPerBucket;
                 int stopIt = bucketNumber == numBuckets - 1 ? numRows : it + numPerBucket;
                 auto stream = whereGenerator.rowStream->clone();
                 stream->initAt(it);
+
+                MemoryArena arena;  // scratch for this bucket's rows
+
                 for (;  it < stopIt; ++it) {
+                    checkCancellation(cancellation);
                     RowPath rowName = stream->next();
                     auto row = dataset.getRowExpr(rowName);
 
-                    auto output = processRow(rowName, row, it, numPerBucket, selectStar);
+                    auto output = processRow(rowName, row, it, numPerBucket,
+                                             selectStar, &arena);
                     int bucketNumber
                         = numBuckets > 0 ? std::min((size_t)(it/numPerBucket),
                                                     (size_t)(numBuckets-1)) : -1;
@@ -364,9 +424,15 @@ struct UnorderedExecutor: public BoundSelectQuery::Executor {
                ExpressionValue & row,
                int rowNum,
                int numPerBucket,
-               bool selectStar)
+               bool selectStar,
+               MemoryArena * arena = nullptr)
     {
+        // Scratch from previous rows on this thread is dead by now
+        if (arena)
+            arena->reset();
+
         auto rowContext = context.getRowScope(rowName, row);
+        rowContext.arena = arena;
 
         whenBound.filterInPlace(row, rowContext);
 
@@ -375,6 +441,7 @@ struct UnorderedExecutor: public BoundSelectQuery::Executor {
         std::get<0>(output) = rowName;
 
         auto selectRowScope = context.getRowScope(rowName, row);
+        selectRowScope.arena = arena;
 
         vector<ExpressionValue>& calcd = std::get<2>(output);
         calcd.resize(boundCalc.size());
@@ -403,6 +470,244 @@ struct UnorderedExecutor: public BoundSelectQuery::Executor {
     }
 };
 
+namespace {
+
+/* When set to a non-zero number of megabytes, ordered queries account for
+   the bytes pinned by their accumulated rows and, once over budget, sort
+   what they have into a run that is spilled to a temporary file; the final
+   ordering is then produced by streaming a merge of the runs.  Slower than
+   sorting in memory, but the query's memory use stays near the budget no
+   matter how many rows it sorts.
+*/
+static EnvOption<int, true> QUERY_SORT_MEMORY_LIMIT_MB
+    ("MLDB_QUERY_SORT_MEMORY_LIMIT_MB", 0);
+
+/** Spills sorted runs of (sort key, output row, calcd) tuples through a
+    temporary file and streams them back for the merge phase of an ordered
+    query.  Rows are encoded as a flat sequence of CellValues in the
+    CellValue binary serialization, which round trips atoms, paths and
+    timestamps exactly; the spilled regions are memory mapped, so reading
+    them back for the merge doesn't pull a run into memory all at once.
+*/
+struct OrderedRowSpiller {
+
+    typedef std::tuple<std::vector<ExpressionValue>, NamedRowValue,
+                       std::vector<ExpressionValue> > SortedRow;
+
+    OrderedRowSpiller()
+        : serializer("tmp", "query-sort-spill")
+    {
+    }
+
+    static constexpr bool EXACT_BYTES = false;
+
+    TemporaryFileSerializer serializer;
+    std::mutex mutex;
+
+    /// Per-row field counts, fixed per query; recorded on the first spill
+    size_t numSortFields = 0;
+    size_t numCalcd = 0;
+
+    /// One spilled, internally sorted run: its frozen bytes and row count
+    std::vector<std::pair<FrozenMemoryRegion, size_t> > runs;
+
+    /** Approximate bytes a row pins in memory while waiting to be
+        sorted.  Used for the byte accounting, not for allocation, so it
+        only needs to be in the right ballpark.
+    */
+    static size_t memUsage(const SortedRow & row)
+    {
+        size_t result = sizeof(SortedRow);
+
+        auto onValue = [&] (const ExpressionValue & val)
+            {
+                result += sizeof(ExpressionValue);
+                if (val.empty())
+                    return;
+                if (val.isAtom()) {
+                    result += val.getAtom().memusage();
+                    return;
+                }
+                auto onAtom = [&] (const Path & columnName,
+                                   const Path & prefix,
+                                   const CellValue & cell,
+                                   Date ts)
+                    {
+                        result += columnName.memusage() + cell.memusage()
+                            + sizeof(Date);
+                        return true;
+                    };
+                val.forEachAtom(onAtom);
+            };
+
+        for (const ExpressionValue & field: std::get<0>(row))
+            onValue(field);
+
+        const NamedRowValue & out = std::get<1>(row);
+        result += out.rowName.memusage();
+        for (const auto & col: out.columns) {
+            result += sizeof(PathElement);
+            onValue(std::get<1>(col));
+        }
+
+        for (const ExpressionValue & field: std::get<2>(row))
+            onValue(field);
+
+        return result;
+    }
+
+    /** Sort the given rows into a run and write it to the temporary
+        file.  Thread safe; called by whichever worker thread finds the
+        query over budget.
+    */
+    void spill(std::vector<SortedRow> rows)
+    {
+        if (rows.empty())
+            return;
+
+        std::unique_lock<std::mutex> guard(mutex);
+
+        numSortFields = std::get<0>(rows[0]).size();
+        numCalcd = std::get<2>(rows[0]).size();
+
+        uint64_t totalBytes = 0;
+        auto measure = [&] (const CellValue & cell)
+            {
+                totalBytes += cell.serializedBytes(EXACT_BYTES);
+            };
+        for (const SortedRow & row: rows)
+            encodeRow(row, measure);
+
+        MutableMemoryRegion region
+            = serializer.allocateWritable(totalBytes, 1 /* alignment */);
+
+        char * p = region.data();
+        char * end = p + totalBytes;
+        auto write = [&] (const CellValue & cell)
+            {
+                p = cell.serialize(p, end - p, EXACT_BYTES);
+                ExcAssert(p);
+            };
+        for (const SortedRow & row: rows)
+            encodeRow(row, write);
+        ExcAssertEqual((const void *)p, (const void *)end);
+
+        runs.emplace_back(serializer.freeze(region), rows.size());
+    }
+
+    /** An ExpressionValue is encoded as a count followed by its atoms:
+        -2 for null, -1 for an atom (cell, timestamp), or n >= 0 for a
+        flattened row of n (column path, cell, timestamp) triples.
+    */
+    template<typename Fn>
+    static void encodeValue(const ExpressionValue & val, Fn && onCell)
+    {
+        if (val.empty()) {
+            onCell(CellValue((int64_t)-2));
+            return;
+        }
+        if (val.isAtom()) {
+            onCell(CellValue((int64_t)-1));
+            onCell(val.getAtom());
+            onCell(CellValue(val.getEffectiveTimestamp()));
+            return;
+        }
+
+        onCell(CellValue((int64_t)val.getAtomCount()));
+        auto onAtom = [&] (const Path & columnName,
+                           const Path & prefix,
+                           const CellValue & cell,
+                           Date ts)
+            {
+                onCell(CellValue(prefix + columnName));
+                onCell(cell);
+                onCell(CellValue(ts));
+                return true;
+            };
+        val.forEachAtom(onAtom);
+    }
+
+    template<typename Fn>
+    void encodeRow(const SortedRow & row, Fn && onCell) const
+    {
+        for (const ExpressionValue & field: std::get<0>(row))
+            encodeValue(field, onCell);
+
+        const NamedRowValue & out = std::get<1>(row);
+        onCell(CellValue(out.rowName));
+        onCell(CellValue((int64_t)out.columns.size()));
+        for (const auto & col: out.columns) {
+            onCell(CellValue(Path(std::get<0>(col))));
+            encodeValue(std::get<1>(col), onCell);
+        }
+
+        for (const ExpressionValue & field: std::get<2>(row))
+            encodeValue(field, onCell);
+    }
+
+    static CellValue nextCell(const char * & p, size_t & remaining)
+    {
+        auto res = CellValue::reconstitute
+            (p, remaining, CellValue::serializationFormat(EXACT_BYTES),
+             EXACT_BYTES);
+        p += res.second;
+        remaining -= res.second;
+        return std::move(res.first);
+    }
+
+    static ExpressionValue decodeValue(const char * & p, size_t & remaining)
+    {
+        int64_t n = nextCell(p, remaining).toInt();
+        if (n == -2)
+            return ExpressionValue();
+        if (n == -1) {
+            CellValue cell = nextCell(p, remaining);
+            Date ts = nextCell(p, remaining).toTimestamp();
+            return ExpressionValue(std::move(cell), ts);
+        }
+
+        RowValue rowValue;
+        rowValue.reserve(n);
+        for (int64_t i = 0;  i < n;  ++i) {
+            Path columnName = nextCell(p, remaining).coerceToPath();
+            CellValue cell = nextCell(p, remaining);
+            Date ts = nextCell(p, remaining).toTimestamp();
+            rowValue.emplace_back(std::move(columnName), std::move(cell), ts);
+        }
+        return ExpressionValue(std::move(rowValue));
+    }
+
+    SortedRow decodeRow(const char * & p, size_t & remaining) const
+    {
+        std::vector<ExpressionValue> sortFields;
+        sortFields.reserve(numSortFields);
+        for (size_t i = 0;  i < numSortFields;  ++i)
+            sortFields.emplace_back(decodeValue(p, remaining));
+
+        NamedRowValue out;
+        out.rowName = nextCell(p, remaining).coerceToPath();
+        out.rowHash = out.rowName;
+        int64_t numColumns = nextCell(p, remaining).toInt();
+        out.columns.reserve(numColumns);
+        for (int64_t i = 0;  i < numColumns;  ++i) {
+            PathElement columnName
+                = nextCell(p, remaining).coerceToPathElement();
+            ExpressionValue val = decodeValue(p, remaining);
+            out.columns.emplace_back(std::move(columnName), std::move(val));
+        }
+
+        std::vector<ExpressionValue> calcd;
+        calcd.reserve(numCalcd);
+        for (size_t i = 0;  i < numCalcd;  ++i)
+            calcd.emplace_back(decodeValue(p, remaining));
+
+        return SortedRow(std::move(sortFields), std::move(out),
+                         std::move(calcd));
+    }
+};
+
+} // file scope
+
 struct OrderedExecutor: public BoundSelectQuery::Executor {
 
     const Dataset & dataset;
@@ -463,16 +768,48 @@ struct OrderedExecutor: public BoundSelectQuery::Executor {
    
         // For each one, generate the order by key
 
-        typedef std::tuple<std::vector<ExpressionValue>, NamedRowValue, std::vector<ExpressionValue> > SortedRow;
+        typedef OrderedRowSpiller::SortedRow SortedRow;
         typedef std::vector<SortedRow> SortedRows;
-        
+
         PerThreadAccumulator<SortedRows> accum;
 
+        // Memory governor: when a sort budget is configured, account for
+        // the bytes pinned by the accumulated rows, and spill sorted runs
+        // to a temporary file whenever the budget is exceeded.
+        // Top-K pushdown: with ORDER BY ... LIMIT and a small offset, only
+        // the best offset+limit rows can ever be emitted, so each thread
+        // keeps at most that many in a bounded heap (worst retained row at
+        // the front) instead of accumulating everything for a full sort.
+        // DISTINCT ON drops rows after sorting, so it needs the full
+        // ordering and disables the pushdown.
+        static constexpr ssize_t TOP_K_MAX = 1000000;
+        ssize_t topK = -1;
+        if (limit != -1 && offset >= 0 && offset + limit <= TOP_K_MAX
+            && numDistinctOnClauses_ == 0)
+            topK = offset + limit;
+
+        ssize_t memoryLimit
+            = (ssize_t)QUERY_SORT_MEMORY_LIMIT_MB.get() * 1000000;
+        std::unique_ptr<OrderedRowSpiller> spiller;
+        if (memoryLimit > 0 && topK == -1)
+            spiller.reset(new OrderedRowSpiller());
+        PerThreadAccumulator<size_t> bytesAccum;
+        std::atomic<ssize_t> totalBytes(0);
+
+        // Compare two rows according to the sort criteria
+        auto compareRows = [&] (const SortedRow & row1,
+                                const SortedRow & row2) -> bool
+            {
+                return boundOrderBy.less(std::get<0>(row1), std::get<0>(row2));
+            };
+
         std::atomic<int64_t> rowsAdded(0);
         ProgressState progress(rows.size());
+        auto cancellation = currentCancellationToken();
 
         auto doWhere = [&] (int rowNum) -> bool
             {
+                checkCancellation(cancellation);
                 QueryThreadTracker childTracker = parentTracker.child();
 
                 auto row = dataset.getRowExpr(rows[rowNum]);
@@ -518,10 +855,59 @@ struct OrderedExecutor: public BoundSelectQuery::Executor {
                     = boundOrderBy.apply(orderByRowScope);
 
                 SortedRows * sortedRows = &accum.get();
+
+                if (topK != -1) {
+                    // Bounded heap: the heap is full once it holds topK
+                    // rows, and anything sorting at or after the worst
+                    // retained row can never be emitted.  Memory is
+                    // bounded to topK rows per thread, so the spill
+                    // accounting below doesn't apply.
+                    if (sortedRows->size() >= (size_t)topK
+                        && !boundOrderBy.less(sortFields,
+                                              std::get<0>(sortedRows->front()))) {
+                        ++rowsAdded;
+                        return true;
+                    }
+
+                    sortedRows->emplace_back(std::move(sortFields),
+                                             std::move(outputRow),
+                                             std::move(calcd));
+                    std::push_heap(sortedRows->begin(), sortedRows->end(),
+                                   compareRows);
+                    if (sortedRows->size() > (size_t)topK) {
+                        std::pop_heap(sortedRows->begin(), sortedRows->end(),
+                                      compareRows);
+                        sortedRows->pop_back();
+                    }
+
+                    ++rowsAdded;
+                    return true;
+                }
+
                 sortedRows->emplace_back(std::move(sortFields),
                                          std::move(outputRow),
                                          std::move(calcd));
 
+                if (spiller) {
+                    size_t rowBytes
+                        = OrderedRowSpiller::memUsage(sortedRows->back());
+                    size_t & threadBytes = bytesAccum.get();
+                    threadBytes += rowBytes;
+                    ssize_t newTotal
+                        = totalBytes.fetch_add(rowBytes) + (ssize_t)rowBytes;
+                    if (newTotal >= memoryLimit) {
+                        // Over budget: turn this thread's rows into a
+                        // sorted run on disk.  Other threads will do the
+                        // same as they next add a row.
+                        std::sort(sortedRows->begin(), sortedRows->end(),
+                                  compareRows);
+                        spiller->spill(std::move(*sortedRows));
+                        sortedRows->clear();
+                        totalBytes -= threadBytes;
+                        threadBytes = 0;
+                    }
+                }
+
                 ++rowsAdded;
                 return true;
             };
@@ -534,90 +920,136 @@ struct OrderedExecutor: public BoundSelectQuery::Executor {
 
         //cerr << "map took " << timer.elapsed() << endl;
         timer.restart();
-        
-        // Compare two rows according to the sort criteria
-        auto compareRows = [&] (const SortedRow & row1,
-                                const SortedRow & row2) -> bool
-            {
-                return boundOrderBy.less(std::get<0>(row1), std::get<0>(row2));
-            };
-            
-        auto rowsSorted = parallelMergeSort(accum.threads, compareRows);
-
-        //cerr << "shuffle took " << timer.elapsed() << endl;
-        timer.restart(); 
-
-        // Now select only the required subset of sorted rows
-        if (limit == -1)
-            limit = rowsSorted.size();
 
+        // Streamed consumption of the sorted rows: applies DISTINCT ON,
+        // offset and limit, and forwards to the processor.  Returns false
+        // once iteration should stop.
         ExcAssertGreaterEqual(offset, 0);
 
-        if (numDistinctOnClauses_ > 0) {
-
-            std::vector<ExpressionValue> reference;
-            reference.resize(numDistinctOnClauses_);
-            ssize_t count = 0;
-
-            for (unsigned i = 0;  i < rowsSorted.size();  ++i) {
+        std::vector<ExpressionValue> reference(numDistinctOnClauses_);
+        ssize_t count = 0;
+        ssize_t emitted = 0;
+        size_t rowIndex = 0;
+        bool processorStopped = false;
 
-                std::vector<ExpressionValue> & mark = std::get<0>(rowsSorted[i]);
+        auto consumeSorted = [&] (SortedRow & rowOut) -> bool
+            {
+                size_t i = rowIndex++;
 
-                if (i == 0) {
-                    std::copy_n(mark.begin(), numDistinctOnClauses_, reference.begin());
-                }
-                else {
+                if (numDistinctOnClauses_ > 0) {
+                    std::vector<ExpressionValue> & mark = std::get<0>(rowOut);
 
-                    bool same = true;
-                    for (int i = 0; i < numDistinctOnClauses_; ++i){
-                        if (reference[i] != mark[i]) {
-                            same = false;
-                            break;
-                        }
+                    if (i == 0) {
+                        std::copy_n(mark.begin(), numDistinctOnClauses_,
+                                    reference.begin());
                     }
+                    else {
+                        bool same = true;
+                        for (size_t j = 0;  j < numDistinctOnClauses_;  ++j) {
+                            if (reference[j] != mark[j]) {
+                                same = false;
+                                break;
+                            }
+                        }
 
-                    if (!same)
-                        std::copy_n(mark.begin(), numDistinctOnClauses_, reference.begin());
-                    else
-                        continue; //skip duplicates
+                        if (!same)
+                            std::copy_n(mark.begin(), numDistinctOnClauses_,
+                                        reference.begin());
+                        else
+                            return true; //skip duplicates
+                    }
                 }
 
                 ++count;
 
                 if (count <= offset)
-                    continue;
+                    return true;
 
-                auto & row = std::get<1>(rowsSorted[i]);
-                auto & calcd = std::get<2>(rowsSorted[i]);
+                auto & row = std::get<1>(rowOut);
+                auto & calcd = std::get<2>(rowOut);
 
                 /* Finally, pass to the terminator to continue. */
-                if (!processor(row, calcd, i))
+                if (!processor(row, calcd, i)) {
+                    processorStopped = true;
                     return false;
+                }
 
-                if (count - offset == limit)
-                    break;
+                ++emitted;
+                return limit == -1 || emitted < limit;
+            };
+
+        if (spiller && !spiller->runs.empty()) {
+            // At least one run hit the disk; spill the remaining partial
+            // runs too so that everything merges the same way.
+            auto spillRest = [&] (SortedRows * threadRows)
+                {
+                    if (threadRows->empty())
+                        return;
+                    std::sort(threadRows->begin(), threadRows->end(),
+                              compareRows);
+                    spiller->spill(std::move(*threadRows));
+                    threadRows->clear();
+                };
+            accum.forEach(spillRest);
+
+            // Stream a merge of the runs; each run is already sorted, so
+            // the smallest remaining head across the runs is the next row.
+            struct RunCursor {
+                const char * p = nullptr;
+                size_t remaining = 0;
+                size_t rowsLeft = 0;
+                SortedRow current;
+            };
+
+            std::vector<RunCursor> cursors(spiller->runs.size());
+            for (size_t i = 0;  i < cursors.size();  ++i) {
+                cursors[i].p = spiller->runs[i].first.data();
+                cursors[i].remaining = spiller->runs[i].first.length();
+                cursors[i].rowsLeft = spiller->runs[i].second;
+                if (cursors[i].rowsLeft)
+                    cursors[i].current
+                        = spiller->decodeRow(cursors[i].p,
+                                             cursors[i].remaining);
             }
 
-        }
-        else {
-            ssize_t begin = std::min<ssize_t>(offset, rowsSorted.size());
-            ssize_t end = std::min<ssize_t>(offset + limit, rowsSorted.size());
-            for (unsigned i = begin;  i < end;  ++i) {
+            for (;;) {
+                RunCursor * best = nullptr;
+                for (RunCursor & c: cursors) {
+                    if (!c.rowsLeft)
+                        continue;
+                    if (!best
+                        || boundOrderBy.less(std::get<0>(c.current),
+                                             std::get<0>(best->current)))
+                        best = &c;
+                }
 
-                auto & row = std::get<1>(rowsSorted[i]);
-                auto & calcd = std::get<2>(rowsSorted[i]);
+                if (!best)
+                    break;
 
-                /* Finally, pass to the terminator to continue. */
-                if (!processor(row, calcd, i))
-                    return false;
+                if (!consumeSorted(best->current))
+                    break;
+
+                if (--best->rowsLeft)
+                    best->current = spiller->decodeRow(best->p,
+                                                       best->remaining);
             }
+
+            return !processorStopped;
         }
 
-     
+        auto rowsSorted = parallelMergeSort(accum.threads, compareRows);
+
+        //cerr << "shuffle took " << timer.elapsed() << endl;
+        timer.restart();
+
+        for (SortedRow & sortedRow: rowsSorted) {
+            if (!consumeSorted(sortedRow))
+                break;
+        }
 
         cerr << "reduce took " << timer.elapsed() << endl;
 
-        return true;
+        return !processorStopped;
     }
 
     virtual std::shared_ptr<ExpressionValueInfo> getOutputInfo() const
@@ -711,7 +1143,9 @@ struct RowHashOrderedExecutor: public BoundSelectQuery::Executor {
              << " on " << (rowsTimer.elapsed_cpu() / rowsTimer.elapsed_wall()) << " cpus "
              << " at " << rows.size() / rowsTimer.elapsed_wall() << "/second and "
              << rows.size() / rowsTimer.elapsed_cpu() << " /cpu-second" << endl;
-        
+
+        QueryProfile::record("generateRows", rowsTimer, 0, rows.size());
+
         Timer scanTimer;
 
         // Special but exceedingly common case: we sort by row hash.
@@ -730,6 +1164,8 @@ struct RowHashOrderedExecutor: public BoundSelectQuery::Executor {
         // Do we select *?  In that case we can avoid a lot of copying
         bool selectStar = boundSelect.expr->isIdentitySelect(context);
 
+        auto cancellation = currentCancellationToken();
+
         auto doRow = [&] (ssize_t rowNum) -> bool
             {
                 //if (rowNum % 1000 == 0)
@@ -737,6 +1173,7 @@ struct RowHashOrderedExecutor: public BoundSelectQuery::Executor {
                 //         << minRowNum << " maxRowNumNeeded " << maxRowNumNeeded
                 //         << " maxRowNum " << maxRowNum << endl;
 
+                checkCancellation(cancellation);
                 QueryThreadTracker childTracker = parentTracker.child();
 
                 ExpressionValue row;
@@ -870,6 +1307,8 @@ struct RowHashOrderedExecutor: public BoundSelectQuery::Executor {
              << " at " << sorted.size() / scanTimer.elapsed_wall() << "/second and "
              << sorted.size() / scanTimer.elapsed_cpu() << " /cpu-second" << endl;
 
+        QueryProfile::record("scan", scanTimer, rows.size(), sorted.size());
+
         scanTimer.restart();
 
         // Now select only the required subset of sorted rows
@@ -896,6 +1335,8 @@ struct RowHashOrderedExecutor: public BoundSelectQuery::Executor {
              << " at " << sorted.size() / scanTimer.elapsed_wall() << "/second and "
              << sorted.size() / scanTimer.elapsed_cpu() << " /cpu-second" << endl;
 
+        QueryProfile::record("sort", scanTimer, sorted.size(), sorted.size());
+
         scanTimer.restart();
 
         ssize_t begin = std::min<ssize_t>(offset, sorted.size());
@@ -934,6 +1375,8 @@ struct RowHashOrderedExecutor: public BoundSelectQuery::Executor {
              << " at " << sorted.size() / scanTimer.elapsed_wall() << "/second and "
              << sorted.size() / scanTimer.elapsed_cpu() << " /cpu-second" << endl;
 
+        QueryProfile::record("output", scanTimer, sorted.size(), end - begin);
+
         return true;
     }
 
@@ -968,6 +1411,8 @@ struct RowHashOrderedExecutor: public BoundSelectQuery::Executor {
         numChunk = std::max(numChunk, (int)1U);
         int chunkSize = (int)std::floor((float)upperBound / numChunk);
 
+        auto cancellation = currentCancellationToken();
+
         auto doChunk = [&] (int bucketIndex)
         {
           int index = bucketIndex*chunkSize;
@@ -979,6 +1424,7 @@ struct RowHashOrderedExecutor: public BoundSelectQuery::Executor {
 
           while (index < stopIndex)
           {
+              checkCancellation(cancellation);
               RowPath rowName = stream->next();
 
               if (rowName == RowPath())
@@ -1093,6 +1539,7 @@ BoundSelectQuery(const SelectExpression & select,
       orderBy(orderBy), context(new SqlExpressionDatasetScope(from, std::move(alias))),
       logger(getMldbLog<BoundSelectQuery>())
 {
+    Timer bindTimer;
     try {
         SqlExpressionWhenScope whenScope(*context);
         auto whenBound = when.bind(whenScope);
@@ -1100,7 +1547,25 @@ BoundSelectQuery(const SelectExpression & select,
         // Get a generator for the rows that match 
         auto whereGenerator = context->doCreateRowsWhereGenerator(where, 0, -1);
 
-        auto boundSelect = select.bind(*context);
+        // Bind the select with common subexpression elimination: repeated
+        // pure subtrees are evaluated once per row and served from
+        // memoization slots for the other occurrences
+        size_t numSharedNodes = 0, numSharedOccurrences = 0;
+        Timer cseTimer;
+        auto boundSelect = bindWithCommonSubexpressions
+            (select, *context, &numSharedNodes, &numSharedOccurrences);
+
+        if (numSharedNodes > 0) {
+            // Surface the sharing in the query profile (rowsIn counts the
+            // occurrences covered, rowsOut the distinct shared subtrees)
+            // and the debug log
+            QueryProfile::record("cse", cseTimer,
+                                 numSharedOccurrences, numSharedNodes);
+            DEBUG_MSG(logger) << "CSE shared " << numSharedNodes
+                              << " subexpressions covering "
+                              << numSharedOccurrences << " occurrences in "
+                              << select.print();
+        }
 
         selectInfo = boundSelect.info;
 
@@ -1178,6 +1643,8 @@ BoundSelectQuery(const SelectExpression & select,
                                                  logger));
         }
 
+        QueryProfile::record("bind", bindTimer);
+
     } MLDB_CATCH_ALL {
         rethrowException(KEEP_HTTP_CODE, "Binding error: "
                              + getExceptionString(),
@@ -1222,8 +1689,31 @@ execute(std::function<bool (NamedRowValue & output,
 
     ExcAssert(processor);
 
+    static LatencyHistogram & executeLatency
+        = MetricsRegistry::instance().histogram("query.execute.latencySeconds");
+
     try {
-        return executor->execute(processor, processInParallel, offset, limit, onProgress);
+        Timer timer;
+        bool result;
+        if (auto * profile = QueryProfile::current()) {
+            std::atomic<uint64_t> rowsOut(0);
+            auto countingProcessor = [&] (NamedRowValue & output,
+                                          std::vector<ExpressionValue> & calcd,
+                                          int groupNum)
+                {
+                    rowsOut.fetch_add(1, std::memory_order_relaxed);
+                    return processor(output, calcd, groupNum);
+                };
+            result = executor->execute(countingProcessor, processInParallel,
+                                       offset, limit, onProgress);
+            profile->recordStage("execute", timer, 0 /* rowsIn */, rowsOut);
+        }
+        else {
+            result = executor->execute(processor, processInParallel,
+                                       offset, limit, onProgress);
+        }
+        executeLatency.recordSeconds(timer.elapsed_wall());
+        return result;
     } MLDB_CATCH_ALL {
         rethrowException(KEEP_HTTP_CODE, "Execution error: "
                              + getExceptionString(),
@@ -1271,9 +1761,32 @@ executeExpr(std::function<bool (Path & rowName,
 
     ExcAssert(processor);
 
+    static LatencyHistogram & executeLatency
+        = MetricsRegistry::instance().histogram("query.execute.latencySeconds");
+
     try {
-        return executor->executeExpr(processor, processInParallel,
-                                     offset, limit, onProgress);
+        Timer timer;
+        bool result;
+        if (auto * profile = QueryProfile::current()) {
+            std::atomic<uint64_t> rowsOut(0);
+            auto countingProcessor = [&] (Path & rowName,
+                                          ExpressionValue & output,
+                                          std::vector<ExpressionValue> & calcd,
+                                          int groupNum)
+                {
+                    rowsOut.fetch_add(1, std::memory_order_relaxed);
+                    return processor(rowName, output, calcd, groupNum);
+                };
+            result = executor->executeExpr(countingProcessor, processInParallel,
+                                           offset, limit, onProgress);
+            profile->recordStage("execute", timer, 0 /* rowsIn */, rowsOut);
+        }
+        else {
+            result = executor->executeExpr(processor, processInParallel,
+                                           offset, limit, onProgress);
+        }
+        executeLatency.recordSeconds(timer.elapsed_wall());
+        return result;
     } MLDB_CATCH_ALL {
         rethrowException(KEEP_HTTP_CODE, "Execution error: "
                              + getExceptionString(),
@@ -1668,6 +2181,31 @@ BoundGroupByQuery(const SelectExpression & select,
     numBuckets = maxNumRow <= maxNumTask*MIN_ROW_PER_TASK? maxNumRow / maxNumTask : maxNumTask;
     numBuckets = std::max(numBuckets, (size_t)1U);
 
+    // Estimate the number of groups from the column statistics, so that
+    // execute() can pre-size its hash tables.  Only group keys that are
+    // plain column reads have statistics; 0 means no estimate.
+    groupDistinctEstimate = 1;
+    for (auto & g: groupBy.clauses) {
+        auto col = dynamic_cast<const ReadColumnExpression *>(g.get());
+        uint64_t distinct = 0;
+        if (col)
+            distinct = from.getColumnIndex()
+                ->getColumnDistinctEstimate(removeTableName(alias,
+                                                            col->columnName));
+        if (distinct == 0) {
+            groupDistinctEstimate = 0;
+            break;
+        }
+
+        // The product over the keys is an upper bound on the number of
+        // groups, and so is the number of rows
+        if (groupDistinctEstimate > maxNumRow / distinct)
+            groupDistinctEstimate = maxNumRow;
+        else groupDistinctEstimate
+                 = std::min<uint64_t>(groupDistinctEstimate * distinct,
+                                      maxNumRow);
+    }
+
     // bind the subselect
     //false means no implicit sort by rowhash, we want unsorted
     subSelect.reset(new BoundSelectQuery(subSelectExpr, from, alias, when, where, subOrderBy, calc, numBuckets));
@@ -1720,8 +2258,44 @@ execute(RowProcessor processor,
     std::atomic<ssize_t> groupsDone(0);
 
     typedef std::vector<ExpressionValue> RowKey;
-    typedef std::map<RowKey, GroupMapValue> GroupByMapType;
-    std::vector<GroupByMapType> accum(numBuckets);
+
+    struct RowKeyHash {
+        size_t operator () (const RowKey & key) const
+        {
+            size_t result = 0;
+            for (const auto & v: key)
+                result = result * 1099511628211ULL + v.hash();
+            return result;
+        }
+    };
+
+    typedef std::unordered_map<RowKey, GroupMapValue, RowKeyHash>
+        GroupByMapType;
+
+    // Per task, per shard pre-aggregation maps.  Sharding on the key
+    // hash means the merge can later run one shard per thread with no
+    // two threads ever touching the same group.
+    size_t numShards = std::max(numCpus(), 1);
+    std::vector<std::vector<GroupByMapType> >
+        accum(numBuckets, std::vector<GroupByMapType>(numShards));
+
+    // Pre-size the per-task maps when the number of groups could be
+    // estimated, so that big aggregations don't pay a storm of rehashes
+    // growing each map from its initial handful of buckets.  A task map
+    // holds at most its share of the groups of its shard, and no more
+    // than the rows a task sees.
+    if (groupDistinctEstimate > 0) {
+        size_t rowsPerTask
+            = from.getMatrixView()->getRowCount() / numBuckets + 1;
+        size_t perMap
+            = std::min<uint64_t>(groupDistinctEstimate, rowsPerTask)
+            / numShards + 1;
+        perMap = std::min<size_t>(perMap, 1 << 20);
+        for (auto & taskMaps: accum) {
+            for (auto & map: taskMaps)
+                map.reserve(perMap);
+        }
+    }
 
     for (const auto & c: select.clauses) {
         if (c->isWildcard()) {
@@ -1751,8 +2325,9 @@ execute(RowProcessor processor,
                       const std::vector<ExpressionValue> & calc,
                       int groupNum)
     {
-       GroupByMapType & map = accum[groupNum];
        RowKey rowKey(calc.begin(), calc.begin() + groupBy.clauses.size());
+       GroupByMapType & map
+           = accum[groupNum][RowKeyHash()(rowKey) % numShards];
 
        auto pair = map.insert({rowKey, GroupMapValue()});
        auto & iter = pair.first;
@@ -1769,14 +2344,26 @@ execute(RowProcessor processor,
             
     subSelect->execute(onRow, true /*processInParallel*/, 0, -1, onProgress);
   
-    //merge the maps in fixed order
-    GroupByMapType destMap;
-    std::vector<GroupByMapType>& threads = accum;
-    if (threads.size() > 0)
+    //merge the per-task maps, one shard per thread; no shard is ever
+    //touched by two threads so no locking is needed
+    std::vector<GroupByMapType> mergedShards(numShards);
+
+    if (groupDistinctEstimate > 0) {
+        size_t perShard
+            = std::min<uint64_t>(groupDistinctEstimate / numShards + 1,
+                                 1 << 22);
+        for (auto & shard: mergedShards)
+            shard.reserve(perShard);
+    }
+
+    auto mergeShard = [&] (size_t shard)
     {
 //        STACK_PROFILE(MergingBuckets);
-        for (auto & srcMap : threads)
+        GroupByMapType & destMap = mergedShards[shard];
+
+        for (auto & taskMaps : accum)
         {
+            GroupByMapType & srcMap = taskMaps[shard];
             for (auto it = srcMap.begin(); it != srcMap.end(); ++it)
             {
                 auto pair = destMap.insert({it->first, GroupMapValue()});
@@ -1789,22 +2376,45 @@ execute(RowProcessor processor,
 
                 groupContext->mergeThreadMap(destiter->second, it->second);
             }
+            srcMap.clear();
         }
+    };
+
+    parallelMap(0, numShards, mergeShard);
+
+    // Gather the groups from all the shards.  Without an ORDER BY the
+    // output used to follow the merged (ordered) map, so sort by group
+    // key to keep emitting rows in the same order; with one, the rows
+    // get sorted below anyway.
+    std::vector<GroupByMapType::value_type *> groups;
+    for (auto & shard: mergedShards) {
+        for (auto & entry: shard)
+            groups.push_back(&entry);
+    }
+
+    if (boundOrderBy.empty()) {
+        std::sort(groups.begin(), groups.end(),
+                  [] (const GroupByMapType::value_type * p1,
+                      const GroupByMapType::value_type * p2)
+                  {
+                      return p1->first < p2->first;
+                  });
     }
 
-    if (destMap.empty() && groupContext->evaluateEmptyGroups
+    if (groups.empty() && groupContext->evaluateEmptyGroups
         && groupBy.clauses.empty())
     {
-        auto pair = destMap.emplace(RowKey(), GroupMapValue());
+        auto pair = mergedShards[0].emplace(RowKey(), GroupMapValue());
         groupContext->initializePerThreadAggregators(pair.first->second);
+        groups.push_back(&*pair.first);
     }
 
     //output rows
-    //each entry in the final map should be an output row for us   
-    for (auto it = destMap.begin(); it != destMap.end(); ++it)
+    //each entry in the final map should be an output row for us
+    for (auto * entry: groups)
     {
-        RowKey rowKey = it->first;
-        groupContext->aggData = it->second;
+        const RowKey & rowKey = entry->first;
+        groupContext->aggData = entry->second;
 
          // Create the context to evaluate the row name and order by
         NamedRowValue outputRow;
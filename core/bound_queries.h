@@ -191,6 +191,11 @@ struct BoundGroupByQuery {
 
     size_t numBuckets;
 
+    /// Estimated number of distinct groups, from the column statistics
+    /// of the dataset; 0 when no estimate is available.  Used to
+    /// pre-size the aggregation hash tables.
+    uint64_t groupDistinctEstimate;
+
     std::shared_ptr<spdlog::logger> logger;
 
 };
@@ -13,6 +13,7 @@
 #include "mldb/types/annotated_exception.h"
 #include "mldb/utils/buckets.h"
 #include "mldb/base/exc_assert.h"
+#include "mldb/base/parallel.h"
 #include "mldb/types/string.h"
 
 #include <algorithm>
@@ -168,6 +169,57 @@ getBucket(double val) const
         - splits.begin() + offset;
 }
 
+namespace {
+
+/** Branch-free lower_bound over the split array.  The conditional
+    updates compile to conditional moves, so a batch of searches can be
+    kept in flight together rather than each one serializing on a
+    mispredicted branch per level.
+*/
+MLDB_ALWAYS_INLINE uint32_t
+lowerBoundSplit(const double * splits, size_t numSplits, double val)
+{
+    const double * base = splits;
+    size_t len = numSplits;
+    while (len > 0) {
+        size_t half = len >> 1;
+        const double * mid = base + half;
+        bool above = *mid < val;
+        base = above ? mid + 1 : base;
+        len = above ? len - half - 1 : half;
+    }
+    return base - splits;
+}
+
+} // file scope
+
+void
+NumericValues::
+bucketizeAll(const double * vals, uint32_t * out, size_t n) const
+{
+    if (!active)
+        throw AnnotatedException(500, "Attempt to get bucket from non-numeric value");
+
+    const double * s = splits.data();
+    size_t numSplits = splits.size();
+
+    // Four independent searches per iteration; with no branches inside
+    // the search the processor overlaps their cache misses
+    size_t i = 0;
+    for (;  i + 4 <= n;  i += 4) {
+        uint32_t b0 = lowerBoundSplit(s, numSplits, vals[i + 0]);
+        uint32_t b1 = lowerBoundSplit(s, numSplits, vals[i + 1]);
+        uint32_t b2 = lowerBoundSplit(s, numSplits, vals[i + 2]);
+        uint32_t b3 = lowerBoundSplit(s, numSplits, vals[i + 3]);
+        out[i + 0] = b0 + offset;
+        out[i + 1] = b1 + offset;
+        out[i + 2] = b2 + offset;
+        out[i + 3] = b3 + offset;
+    }
+    for (;  i < n;  ++i)
+        out[i] = lowerBoundSplit(s, numSplits, vals[i]) + offset;
+}
+
 uint32_t
 OrdinalValues::
 getBucket(const CellValue & val) const
@@ -309,6 +361,70 @@ initialize(bool hasNulls,
     ExcAssertEqual(n, this->numBuckets());
 }
 
+BucketDescriptions
+BucketDescriptions::
+initializeFromSample(const std::vector<CellValue> & values,
+                     int numBuckets,
+                     size_t maxSamples)
+{
+    size_t n = values.size();
+    size_t stride = std::max<size_t>(1, n / std::max<size_t>(1, maxSamples));
+
+    constexpr size_t blockSize = 65536;
+    size_t numBlocks = (n + blockSize - 1) / blockSize;
+
+    // Per-block state; scanned in parallel, merged serially afterwards.
+    // Numerics are sampled at the given stride; strings and nulls are
+    // collected exactly, since looking up an unknown string throws.
+    struct BlockState {
+        std::vector<double> sampledNumerics;
+        std::vector<Utf8String> strings;
+        bool hasNulls = false;
+    };
+
+    std::vector<BlockState> blocks(numBlocks);
+
+    auto onBlock = [&] (size_t blockNum)
+        {
+            BlockState & block = blocks[blockNum];
+            size_t begin = blockNum * blockSize;
+            size_t end = std::min(n, begin + blockSize);
+            for (size_t i = begin;  i < end;  ++i) {
+                const CellValue & v = values[i];
+                if (v.empty())
+                    block.hasNulls = true;
+                else if (v.isNumber()) {
+                    if (i % stride == 0)
+                        block.sampledNumerics.push_back(v.toDouble());
+                }
+                else if (v.isString())
+                    block.strings.emplace_back(v.toUtf8String());
+                // Other types (blobs, timestamps, ...) are not
+                // bucketized, exactly as in initialize() above
+            }
+        };
+
+    parallelMap(0, numBlocks, onBlock);
+
+    bool hasNulls = false;
+    std::vector<double> sampledNumerics;
+    std::vector<Utf8String> stringValues;
+
+    for (auto & block: blocks) {
+        hasNulls = hasNulls || block.hasNulls;
+        sampledNumerics.insert(sampledNumerics.end(),
+                               block.sampledNumerics.begin(),
+                               block.sampledNumerics.end());
+        stringValues.insert(stringValues.end(),
+                            block.strings.begin(), block.strings.end());
+    }
+
+    BucketDescriptions result;
+    result.initialize(hasNulls, std::move(sampledNumerics),
+                      std::move(stringValues), numBuckets);
+    return result;
+}
+
 CellValue
 BucketDescriptions::
 getSplit(uint32_t bucket) const
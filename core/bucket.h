@@ -158,6 +158,16 @@ struct NumericValues {
 
     uint32_t getBucket(double val) const;
 
+    /** Assign each of the n values to its bucket, writing the bucket
+        numbers to out.  Equivalent to calling getBucket on each value,
+        but the binary search over the split array is branch free and
+        four searches run interleaved, so the processor overlaps their
+        memory accesses instead of stalling on one mispredicted
+        comparison per level.  This is the hot path of classifier
+        training preprocessing.
+    */
+    void bucketizeAll(const double * vals, uint32_t * out, size_t n) const;
+
     void merge(const NumericValues & other);
 };
 
@@ -234,7 +244,21 @@ struct BucketDescriptions {
                     std::vector<double> numericValues,
                     std::vector<Utf8String> stringValues,
                     int numBuckets = -1);
-    
+
+    /** Build bucket descriptions from a sample of the values, scanning
+        them in parallel.  Nulls and strings are still collected exactly
+        (looking up an unknown string throws), but the numeric split
+        points are computed from an evenly strided sample of at most
+        maxSamples values instead of sorting the whole column, so the
+        buckets are approximate quantiles.  Any numeric value still maps
+        to a bucket.
+    */
+    static BucketDescriptions
+    initializeFromSample(const std::vector<CellValue> & values,
+                         int numBuckets = -1,
+                         size_t maxSamples = 16384);
+
+
     /// Initialize from a set of pre-discretized
     std::pair<BucketDescriptions, BucketList>
     discretize(BucketList input, int numBuckets = -1);
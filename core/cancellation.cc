@@ -0,0 +1,104 @@
+/** cancellation.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Registry of in-flight cancellable operations.
+*/
+
+#include "cancellation.h"
+
+#include <map>
+#include <mutex>
+
+#include "mldb/rest/cancellation_exception.h"
+
+
+namespace MLDB {
+
+namespace {
+
+struct OperationEntry {
+    std::string description;
+    Date started;
+    std::shared_ptr<std::atomic<bool> > token;
+};
+
+std::mutex operationsMutex;
+std::map<int64_t, OperationEntry> operations;
+int64_t nextOperationId = 1;
+
+thread_local CancellationToken currentToken;
+
+} // file scope
+
+CancellationToken
+currentCancellationToken()
+{
+    return currentToken;
+}
+
+void
+throwOperationCancelled()
+{
+    throw CancellationException("operation was cancelled");
+}
+
+ScopedOperation::
+ScopedOperation(std::string description)
+    : token_(std::make_shared<std::atomic<bool> >(false)),
+      saved_(currentToken)
+{
+    OperationEntry entry;
+    entry.description = std::move(description);
+    entry.started = Date::now();
+    entry.token = token_;
+
+    {
+        std::unique_lock<std::mutex> guard(operationsMutex);
+        id_ = nextOperationId++;
+        operations.emplace(id_, std::move(entry));
+    }
+
+    currentToken = token_;
+}
+
+ScopedOperation::
+~ScopedOperation()
+{
+    currentToken = saved_;
+    std::unique_lock<std::mutex> guard(operationsMutex);
+    operations.erase(id_);
+}
+
+std::vector<OperationInfo>
+listOperations()
+{
+    std::unique_lock<std::mutex> guard(operationsMutex);
+    std::vector<OperationInfo> result;
+    result.reserve(operations.size());
+    for (auto & op: operations) {
+        OperationInfo info;
+        info.id = op.first;
+        info.description = op.second.description;
+        info.started = op.second.started;
+        info.cancelled = op.second.token->load(std::memory_order_relaxed);
+        result.push_back(std::move(info));
+    }
+    return result;
+}
+
+bool
+cancelOperation(int64_t id)
+{
+    std::unique_lock<std::mutex> guard(operationsMutex);
+    auto it = operations.find(id);
+    if (it == operations.end()) {
+        return false;
+    }
+    it->second.token->store(true, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace MLDB
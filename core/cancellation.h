@@ -0,0 +1,99 @@
+/** cancellation.h                                                 -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Registry of in-flight cancellable operations, with a cheap per-morsel
+    cancellation check for scan loops.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mldb/compiler/compiler.h"
+#include "mldb/types/date.h"
+
+
+namespace MLDB {
+
+/** Shared cancellation flag for one in-flight operation.  Scan loops
+    capture the token once on entry and poll it with a relaxed atomic
+    load per morsel, so a cancellation request takes effect within
+    milliseconds rather than at the next coarse progress checkpoint.
+*/
+typedef std::shared_ptr<const std::atomic<bool> > CancellationToken;
+
+/** Cheap per-morsel check: true once the operation was cancelled. */
+inline bool isCancelled(const CancellationToken & token)
+{
+    return token && token->load(std::memory_order_relaxed);
+}
+
+/** Return the token of the operation the calling thread is running, or
+    null when no cancellable operation is in scope.  Worker lambdas that
+    run on pool threads must capture the token on the thread that sets
+    up the work, since the scope is thread local.
+*/
+CancellationToken currentCancellationToken();
+
+/** Throw a CancellationException for the current operation. */
+[[noreturn]] void throwOperationCancelled();
+
+/** Throw a CancellationException if the operation owning the given
+    captured token was cancelled.  Cheap enough to call per row.
+*/
+inline void checkCancellation(const CancellationToken & token)
+{
+    if (MLDB_UNLIKELY(isCancelled(token)))
+        throwOperationCancelled();
+}
+
+/** Description of an in-flight operation, for diagnostics. */
+struct OperationInfo {
+    int64_t id;
+    std::string description;
+    Date started;
+    bool cancelled;
+};
+
+/** RAII registration of a cancellable operation.  While in scope, the
+    operation is listed on /v1/operations and its token is installed as
+    the calling thread's current cancellation token.
+*/
+struct ScopedOperation {
+    ScopedOperation(std::string description);
+    ~ScopedOperation();
+
+    int64_t id() const
+    {
+        return id_;
+    }
+
+    CancellationToken token() const
+    {
+        return token_;
+    }
+
+private:
+    int64_t id_;
+    std::shared_ptr<std::atomic<bool> > token_;
+    CancellationToken saved_;
+
+    ScopedOperation(const ScopedOperation &) = delete;
+    ScopedOperation & operator = (const ScopedOperation &) = delete;
+};
+
+/** List the currently registered operations, oldest first. */
+std::vector<OperationInfo> listOperations();
+
+/** Request cancellation of the operation with the given id.  Returns
+    false if no such operation is registered.
+*/
+bool cancelOperation(int64_t id);
+
+} // namespace MLDB
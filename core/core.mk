@@ -10,6 +10,9 @@ LIBMLDB_CORE_SOURCES:= \
 	mldb_engine.cc \
 	dataset_scope.cc \
 	bound_queries.cc \
+	query_profile.cc \
+	slow_query_log.cc \
+	cancellation.cc \
 	bucket.cc \
 	analytics.cc \
 
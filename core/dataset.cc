@@ -18,6 +18,7 @@
 #include "mldb/sql/sql_expression.h"
 #include "mldb/sql/sql_utils.h"
 #include "mldb/utils/lightweight_hash.h"
+#include "mldb/utils/quantile_sketch.h"
 #include "mldb/utils/profile.h"
 #include "mldb/core/dataset_scope.h"
 #include "mldb/base/per_thread_accumulator.h"
@@ -28,9 +29,12 @@
 #include "mldb/types/any_impl.h"
 #include "mldb/types/annotated_exception.h"
 #include "mldb/rest/rest_request_router.h"
+#include "mldb/rest/rest_response_cache.h"
+#include "mldb/rest/metrics_registry.h"
 #include "mldb/types/hash_wrapper_description.h"
 #include "mldb/rest/cancellation_exception.h"
 #include <mutex>
+#include <future>
 
 
 using namespace std;
@@ -359,9 +363,42 @@ getColumnStats(const ColumnPath & column, ColumnStats & stats) const
     stats.isNumeric_ = isNumeric && !col.empty();
     stats.rowCount_ = rows.size();
     stats.atMostOne_ = oneOnly;
+    stats.distinctValues_ = stats.values.size();
     return stats;
 }
 
+uint64_t
+ColumnIndex::
+getColumnDistinctEstimate(const ColumnPath & column) const
+{
+    // No statistics by default.  We deliberately don't fall back to
+    // getColumnStats here: this call is made speculatively by the query
+    // planner, and scanning the column would cost more than the plan
+    // improvement is worth.
+    return 0;
+}
+
+std::vector<double>
+ColumnIndex::
+getColumnQuantiles(const ColumnPath & column,
+                   const std::vector<double> & quantiles) const
+{
+    QuantileSketch sketch;
+
+    auto col = getColumn(column);
+    for (auto & r: col.rows) {
+        const CellValue & v = std::get<1>(r);
+        if (v.isNumber())
+            sketch.add(v.toDouble());
+    }
+
+    std::vector<double> result;
+    result.reserve(quantiles.size());
+    for (double q: quantiles)
+        result.push_back(sketch.quantile(q));
+    return result;
+}
+
 std::vector<std::tuple<RowPath, CellValue> >
 ColumnIndex::
 getColumnValues(const ColumnPath & column,
@@ -599,9 +636,24 @@ regLogger(builtinPackage(),
 /* DATASET                                                                   */
 /*****************************************************************************/
 
+struct Dataset::OnCommitCallbacks {
+    std::mutex mutex;
+    std::vector<std::function<void (Dataset &)> > callbacks;
+};
+
+struct Dataset::RowPathCache {
+    std::mutex mutex;
+
+    /// Shared result of the in-progress or completed row path scan.
+    /// Invalid when no scan has happened since the last invalidation.
+    std::shared_future<std::shared_ptr<const std::vector<RowPath> > > rows;
+};
+
 Dataset::
 Dataset(MldbEngine * engine)
-    : engine(engine)
+    : engine(engine),
+      onCommitCallbacks(std::make_shared<OnCommitCallbacks>()),
+      rowPathCache(std::make_shared<RowPathCache>())
 {
 }
 
@@ -636,8 +688,12 @@ Dataset::
 recordRow(const RowPath & rowName,
           const std::vector<std::tuple<ColumnPath, CellValue, Date> > & vals)
 {
+    static MetricsCounter & recordedRows
+        = MetricsRegistry::instance().counter("dataset.recordedRows");
+
     validateNames(rowName, vals);
     recordRowItl(rowName, vals);
+    recordedRows.add();
 }
 
 void
@@ -648,6 +704,14 @@ recordRowItl(const RowPath & rowName,
     throw MLDB::Exception(("Dataset type '" + getType() + "' doesn't allow recording").rawString());
 }
 
+std::vector<double>
+Dataset::
+getColumnQuantiles(const ColumnPath & column,
+                   const std::vector<double> & quantiles) const
+{
+    return getColumnIndex()->getColumnQuantiles(column, quantiles);
+}
+
 std::pair<Date, Date>
 Dataset::
 getTimestampRange() const
@@ -721,6 +785,44 @@ recordRows(const std::vector<std::pair<RowPath, std::vector<std::tuple<ColumnPat
         recordRow(r.first, r.second);
 }
 
+void
+Dataset::
+recordColumnar(const std::vector<RowPath> & rowNames,
+               const std::vector<ColumnPath> & columnNames,
+               std::vector<std::vector<CellValue> > columns,
+               Date timestamp)
+{
+    if (columns.size() != columnNames.size())
+        throw AnnotatedException(400, "recordColumnar: one column buffer "
+                                 "required per column name",
+                                 "numColumnNames", columnNames.size(),
+                                 "numColumns", columns.size());
+    for (auto & c: columns) {
+        if (c.size() != rowNames.size())
+            throw AnnotatedException(400, "recordColumnar: each column buffer "
+                                     "must have one value per row",
+                                     "numRows", rowNames.size(),
+                                     "columnLength", c.size());
+    }
+
+    std::vector<std::pair<RowPath, std::vector<std::tuple<ColumnPath, CellValue, Date> > > > rows;
+    rows.reserve(rowNames.size());
+
+    for (size_t r = 0;  r < rowNames.size();  ++r) {
+        std::vector<std::tuple<ColumnPath, CellValue, Date> > vals;
+        vals.reserve(columns.size());
+        for (size_t c = 0;  c < columns.size();  ++c) {
+            if (columns[c][r].empty())
+                continue;
+            vals.emplace_back(columnNames[c], std::move(columns[c][r]),
+                              timestamp);
+        }
+        rows.emplace_back(rowNames[r], std::move(vals));
+    }
+
+    recordRows(rows);
+}
+
 void
 Dataset::
 recordColumn(const ColumnPath & columnName,
@@ -859,6 +961,17 @@ getRowExpr(const RowPath & row) const
     return std::move(flattened.columns);
 }
 
+std::vector<ExpressionValue>
+Dataset::
+getRowsExpr(const std::vector<RowPath> & rows) const
+{
+    std::vector<ExpressionValue> result;
+    result.reserve(rows.size());
+    for (auto & r: rows)
+        result.emplace_back(getRowExpr(r));
+    return result;
+}
+
 std::vector<MatrixNamedRow>
 Dataset::
 queryStructured(const SelectExpression & select,
@@ -1115,6 +1228,106 @@ generateVariableEqualsConstant(const Dataset & dataset,
          + constantValue.toUtf8String() + "'");
 }
 
+/** Return a CellValue-level filter implementing 'column <op> constant', or
+    a null function if the operator or constant doesn't admit one.  The
+    filter must reproduce SQL comparison semantics: a comparison against
+    NULL is never true, and an empty cell never matches even though it
+    sorts first in CellValue's total order.
+*/
+static std::function<bool (const CellValue &)>
+makeColumnComparisonFilter(const std::string & op,
+                           const CellValue & constantValue)
+{
+    if (constantValue.empty())
+        return nullptr;
+
+    if (op == "=" || op == "==") {
+        return [=] (const CellValue & val)
+            {
+                return val == constantValue;
+            };
+    }
+    else if (op == "!=") {
+        return [=] (const CellValue & val)
+            {
+                return !val.empty() && val != constantValue;
+            };
+    }
+    else if (op == "<") {
+        return [=] (const CellValue & val)
+            {
+                return !val.empty() && val < constantValue;
+            };
+    }
+    else if (op == "<=") {
+        return [=] (const CellValue & val)
+            {
+                return !val.empty() && val <= constantValue;
+            };
+    }
+    else if (op == ">") {
+        return [=] (const CellValue & val)
+            {
+                return !val.empty() && val > constantValue;
+            };
+    }
+    else if (op == ">=") {
+        return [=] (const CellValue & val)
+            {
+                return !val.empty() && val >= constantValue;
+            };
+    }
+
+    return nullptr;
+}
+
+/** If the comparison has the shape 'variable <op> constant' (or the
+    flipped 'constant <op> variable'), return the column it reads and a
+    filter over that column's values; otherwise return a null filter.
+*/
+static std::pair<ColumnPath, std::function<bool (const CellValue &)> >
+getVariableComparisonFilter(const Utf8String & alias,
+                            const ComparisonExpression & comparison)
+{
+    auto vlhs = dynamic_cast<const ReadColumnExpression *>(comparison.lhs.get());
+    auto vrhs = dynamic_cast<const ReadColumnExpression *>(comparison.rhs.get());
+    auto clhs = dynamic_cast<const ConstantExpression *>(comparison.lhs.get());
+    auto crhs = dynamic_cast<const ConstantExpression *>(comparison.rhs.get());
+
+    const ReadColumnExpression * variable = nullptr;
+    const ConstantExpression * constant = nullptr;
+    std::string op = comparison.op;
+
+    if (vlhs && crhs) {
+        variable = vlhs;
+        constant = crhs;
+    }
+    else if (vrhs && clhs) {
+        variable = vrhs;
+        constant = clhs;
+
+        // constant <op> variable is variable <flipped op> constant
+        if (op == "<")
+            op = ">";
+        else if (op == ">")
+            op = "<";
+        else if (op == "<=")
+            op = ">=";
+        else if (op == ">=")
+            op = "<=";
+    }
+
+    if (!variable || !constant || !constant->constant.isAtom())
+        return { ColumnPath(), nullptr };
+
+    auto filter = makeColumnComparisonFilter(op, constant->constant.getAtom());
+    if (!filter)
+        return { ColumnPath(), nullptr };
+
+    return { ColumnPath(removeTableName(alias, variable->columnName)),
+             std::move(filter) };
+}
+
 static GenerateRowsWhereFunction
 generateVariableIsTrue(const Dataset & dataset,
                        const Utf8String& alias,
@@ -1491,12 +1704,44 @@ generateRowsWhere(const SqlBindingScope & scope,
                 }
             }
 
+            // AND of two comparisons on the same column (e.g. a range
+            // predicate like x > 2 AND x < 10): apply both predicates in a
+            // single pass over the column's values rather than intersecting
+            // the results of two separate scans
+            {
+                auto lhsComparison = dynamic_cast<const ComparisonExpression *>
+                    (boolean->lhs.get());
+                auto rhsComparison = dynamic_cast<const ComparisonExpression *>
+                    (boolean->rhs.get());
+
+                if (lhsComparison && rhsComparison) {
+                    ColumnPath lhsColumn, rhsColumn;
+                    std::function<bool (const CellValue &)> lhsFilter, rhsFilter;
+                    std::tie(lhsColumn, lhsFilter)
+                        = getVariableComparisonFilter(alias, *lhsComparison);
+                    std::tie(rhsColumn, rhsFilter)
+                        = getVariableComparisonFilter(alias, *rhsComparison);
+
+                    if (lhsFilter && rhsFilter && lhsColumn == rhsColumn) {
+                        auto filter = [=] (const CellValue & val)
+                            {
+                                return lhsFilter(val) && rhsFilter(val);
+                            };
+
+                        return generateFilteredColumnExpression
+                            (*this, lhsColumn, filter,
+                             "generate rows where conjunction '"
+                             + boolean->print() + "' is true");
+                    }
+                }
+            }
+
             GenerateRowsWhereFunction lhsGen
                 = generateRowsWhere(scope, alias, *boolean->lhs, 0, -1);
             GenerateRowsWhereFunction rhsGen
                 = generateRowsWhere(scope, alias, *boolean->rhs, 0, -1);
 
-            if (lhsGen.complexity < GenerateRowsWhereFunction::UNFILTERED_TABLESCAN 
+            if (lhsGen.complexity < GenerateRowsWhereFunction::UNFILTERED_TABLESCAN
                 && rhsGen.complexity < GenerateRowsWhereFunction::UNFILTERED_TABLESCAN) {
 
                 return {[=] (ssize_t numToGenerate, Any token,
@@ -1873,6 +2118,23 @@ generateRowsWhere(const SqlBindingScope & scope,
         if (vrhs && clhs && comparison->op == "=") {
             return generateVariableEqualsConstant(*this, alias, *vrhs, *clhs);
         }
+
+        // Optimization for variable <op> constant with the other comparison
+        // operators: filter the column's values directly instead of
+        // evaluating the bound expression over every row
+        {
+            ColumnPath columnName;
+            std::function<bool (const CellValue &)> filter;
+            std::tie(columnName, filter)
+                = getVariableComparisonFilter(alias, *comparison);
+
+            if (filter) {
+                return generateFilteredColumnExpression
+                    (*this, columnName, filter,
+                     "generate rows where comparison '"
+                     + comparison->print() + "' is true");
+            }
+        }
     }
 
     auto isType = getIsType(where);
@@ -1978,17 +2240,105 @@ generateRowsWhere(const SqlBindingScope & scope,
 
                 auto matrix = this->getMatrixView();
 
-                //Row names can be returned in an arbitrary order as long as it is deterministic.
-                //TODO - review if and how we should report progress here
-                auto rows = matrix->getRowPaths(start, limit);
-
                 std::vector<RowPath> rowsToKeep;
 
                 PerThreadAccumulator<std::vector<RowPath> > accum;
-                
-                size_t numRows = rows.size();
+
                 std::atomic_ulong rowCount(0);
 
+                // When the dataset can stream its rows, scan through the
+                // stream with one reused RowPath per thread, so that a row
+                // name is only materialized into fresh storage for the rows
+                // the where expression keeps.  Materializing the full list
+                // of row names up front (below) constructs and destroys a
+                // path per scanned row whether it matches or not.
+                auto stream = (start == 0 && limit == -1)
+                    ? this->getRowStream() : std::shared_ptr<RowStream>();
+
+                if (stream && stream->supportsExtendedInterface()) {
+                    int64_t totalRows = matrix->getRowCount();
+
+                    std::vector<size_t> streamOffsets;
+                    auto streams = stream->parallelize(totalRows,
+                                                       RowStream::AUTO,
+                                                       &streamOffsets);
+
+                    ProgressState whereProgress(totalRows);
+
+                    auto onStream = [&] (size_t i)
+                        {
+                            RowStream & s = *streams[i];
+                            auto & kept = accum.get();
+                            RowPath storage;
+                            MatrixNamedRow row;
+
+                            for (size_t n = streamOffsets[i];
+                                 n < streamOffsets[i + 1];  ++n) {
+                                if (n != streamOffsets[i])
+                                    s.advance();
+
+                                ++rowCount;
+                                if (rowCount % PROGRESS_RATE == 0
+                                    && onProgress) {
+                                    whereProgress = rowCount;
+                                    if (!onProgress(whereProgress))
+                                        return false;
+                                }
+
+                                const RowPath & r = s.rowName(storage);
+
+                                if (needsColumns)
+                                    row = matrix->getRow(r);
+                                else {
+                                    row.rowHash = row.rowName = r;
+                                }
+
+                                auto rowScope = dsScope.getRowScope(row,
+                                                                    &params);
+
+                                if (whereBound(rowScope, GET_LATEST).isTrue())
+                                    kept.push_back(r);
+                            }
+
+                            return true;
+                        };
+
+                    if (!parallelMapHaltable(0, streams.size(), onStream))
+                        throw CancellationException("row where generation was cancelled");
+
+                    auto onThreadOutput = [&] (std::vector<RowPath> * vec)
+                        {
+                            rowsToKeep.insert(rowsToKeep.end(),
+                                              std::make_move_iterator(vec->begin()),
+                                              std::make_move_iterator(vec->end()));
+                        };
+
+                    accum.forEach(onThreadOutput);
+
+                    //Need sorting because the parallelisation breaks determinism
+                    if (streams.size() > 1)
+                        parallelQuickSortRecursive<RowPath, SortByRowHash>(rowsToKeep.begin(), rowsToKeep.end());
+
+                    return make_pair(std::move(rowsToKeep), Any());
+                }
+
+                //Row names can be returned in an arbitrary order as long as it is deterministic.
+                //TODO - review if and how we should report progress here
+                std::shared_ptr<const std::vector<RowPath> > sharedRows;
+                std::vector<RowPath> ownedRows;
+                if (start == 0 && limit == -1) {
+                    // Full scan: share the row list with any concurrent
+                    // scans of this dataset
+                    sharedRows = this->getSharedRowPaths();
+                }
+                else {
+                    ownedRows = matrix->getRowPaths(start, limit);
+                }
+                const std::vector<RowPath> & rows
+                    = sharedRows ? *sharedRows : ownedRows;
+
+                size_t numRows = rows.size();
+
                 ProgressState whereProgress(numRows);
                 auto onRow = [&] (size_t n)
                     {
@@ -2373,6 +2723,96 @@ void
 Dataset::
 commit()
 {
+    // New rows are visible; drop the shared row path list so the next
+    // scan sees them
+    {
+        std::unique_lock<std::mutex> guard(rowPathCache->mutex);
+        rowPathCache->rows = {};
+    }
+
+    // Cached route responses may depend on this dataset's contents
+    RestResponseCache::instance().invalidate();
+
+    notifyOnCommit();
+}
+
+std::shared_ptr<const std::vector<RowPath> >
+Dataset::
+getSharedRowPaths() const
+{
+    auto matrix = getMatrixView();
+
+    for (int attempt = 0;  ;  ++attempt) {
+        std::shared_future<std::shared_ptr<const std::vector<RowPath> > >
+            rows;
+        std::promise<std::shared_ptr<const std::vector<RowPath> > > promise;
+        bool weScan = false;
+
+        {
+            std::unique_lock<std::mutex> guard(rowPathCache->mutex);
+            if (rowPathCache->rows.valid()) {
+                // Attach to the in-progress or completed scan
+                rows = rowPathCache->rows;
+            }
+            else {
+                // We were elected to perform the scan; anyone arriving
+                // while it runs will share our result
+                rowPathCache->rows = promise.get_future().share();
+                rows = rowPathCache->rows;
+                weScan = true;
+            }
+        }
+
+        if (weScan) {
+            try {
+                promise.set_value(std::make_shared
+                                  <const std::vector<RowPath> >
+                                  (matrix->getRowPaths()));
+            } catch (...) {
+                // Don't leave a poisoned entry behind; a later caller
+                // will retry the scan
+                std::unique_lock<std::mutex> guard(rowPathCache->mutex);
+                rowPathCache->rows = {};
+                promise.set_exception(std::current_exception());
+            }
+        }
+
+        auto result = rows.get();
+
+        // If rows were recorded since the list was cached (dataset being
+        // queried mid-ingestion), drop the cache and scan again.  On a
+        // repeated mismatch just return what we have: the dataset is
+        // changing under us, and a direct getRowPaths() call would be no
+        // more of a snapshot.
+        if (result->size() == matrix->getRowCount() || attempt > 0)
+            return result;
+
+        std::unique_lock<std::mutex> guard(rowPathCache->mutex);
+        rowPathCache->rows = {};
+    }
+}
+
+void
+Dataset::
+addOnCommitCallback(std::function<void (Dataset &)> fn)
+{
+    std::unique_lock<std::mutex> guard(onCommitCallbacks->mutex);
+    onCommitCallbacks->callbacks.emplace_back(std::move(fn));
+}
+
+void
+Dataset::
+notifyOnCommit()
+{
+    // Copy the callbacks so that registrations from other threads don't
+    // block while (potentially expensive) callbacks run
+    std::vector<std::function<void (Dataset &)> > callbacks;
+    {
+        std::unique_lock<std::mutex> guard(onCommitCallbacks->mutex);
+        callbacks = onCommitCallbacks->callbacks;
+    }
+    for (auto & fn: callbacks)
+        fn(*this);
 }
 
 BoundFunction
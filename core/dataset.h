@@ -140,11 +140,21 @@ struct ColumnStats {
         return rowCount_;
     }
 
+    /** Number of distinct values of the column.  May be an estimate for
+        datasets that keep sketch-based statistics rather than value
+        lists.
+    */
+    uint64_t distinctValues() const
+    {
+        return distinctValues_;
+    }
+
     std::map<CellValue, CellValueStats> values;
 
     bool isNumeric_;
     bool atMostOne_;
     uint64_t rowCount_;
+    uint64_t distinctValues_ = 0;
 };
 
 /*****************************************************************************/
@@ -212,6 +222,27 @@ struct ColumnIndex {
     */
     virtual uint64_t getColumnRowCount(const ColumnPath & column) const;
 
+    /** Return an estimate of the number of distinct values of this
+        column, or 0 when no estimate is available.  This is meant to be
+        cheap enough for query planning (join side selection, hash table
+        pre-sizing), so unlike getColumnStats the default does NOT scan
+        the column: it simply reports that it doesn't know.  Datasets
+        that keep per-column statistics should override it.
+    */
+    virtual uint64_t getColumnDistinctEstimate(const ColumnPath & column) const;
+
+    /** Return approximate quantiles of the numeric values of the column,
+        one output per entry of quantiles (each in [0,1]).  Null and
+        non-numeric values are ignored, and NaN is returned when the
+        column holds no numeric values at all.  The default
+        implementation scans the column once into a mergeable sketch;
+        datasets that keep per-chunk statistics can answer from those
+        without a scan.
+    */
+    virtual std::vector<double>
+    getColumnQuantiles(const ColumnPath & column,
+                       const std::vector<double> & quantiles) const;
+
     virtual std::vector<RowPath>
     getRowPaths(ssize_t start = 0, ssize_t limit = -1) const = 0;
 };
@@ -439,6 +470,28 @@ struct Dataset: public MldbEntity {
     */
     virtual void recordRows(const std::vector<std::pair<RowPath, std::vector<std::tuple<ColumnPath, CellValue, Date> > > > & rows);
 
+    /** Record a batch of rows given in columnar form: one vector of cell
+        values per column, each of length rowNames.size(), with nulls
+        represented as empty CellValues.  All cells share the given
+        timestamp.  This avoids building one (column, value, timestamp)
+        tuple per cell when the caller already holds its data in columns,
+        as bulk importers do.
+
+        The columns are passed by value so that implementations can move
+        the cells out; don't re-use them afterwards.
+
+        The default implementation transposes and forwards to
+        recordRows().  Columnar dataset types override it to stream the
+        buffers straight into their column storage.
+
+        This function must be thread safe with respect to concurrent calls to
+        all other functions.
+    */
+    virtual void recordColumnar(const std::vector<RowPath> & rowNames,
+                                const std::vector<ColumnPath> & columnNames,
+                                std::vector<std::vector<CellValue> > columns,
+                                Date timestamp);
+
     /** Record a column.  Default will forward to recordRows after transposing
         the input data.
 
@@ -528,6 +581,15 @@ struct Dataset: public MldbEntity {
     */
     virtual ExpressionValue getRowExpr(const RowPath & row) const;
 
+    /** Return a batch of rows as expression values, one per input name
+        in the same order.  Serving-style point lookups come in batches
+        of hundreds; datasets that can reorder the probes for memory
+        locality should override this.  Default calls getRowExpr() once
+        per row.
+    */
+    virtual std::vector<ExpressionValue>
+    getRowsExpr(const std::vector<RowPath> & rows) const;
+
 
     /** Commit changes to the database.  Default is a no-op.
 
@@ -538,6 +600,35 @@ struct Dataset: public MldbEntity {
     */
     virtual void commit();
 
+    /** Register a callback to be invoked every time commit() completes on
+        this dataset.  This is the hook on which incrementally maintained
+        entities (such as materialized views) are built: each time new data
+        becomes visible, the callback can process just what was appended.
+
+        Callbacks are invoked synchronously, in registration order, from
+        the thread that called commit(), and must not call commit() on the
+        same dataset.  They stay registered for the lifetime of the
+        dataset.
+
+        Dataset implementations that override commit() must call the base
+        class commit() (or notifyOnCommit()) once their new data is
+        visible to readers, otherwise callbacks will not fire.
+    */
+    void addOnCommitCallback(std::function<void (Dataset &)> fn);
+
+    /** Return the complete list of row paths for this dataset, shared
+        between concurrent callers.  The first caller performs the scan;
+        callers that arrive while it is in progress wait for and share
+        its result, and later callers reuse it until the next commit(),
+        so N concurrent table scans cost roughly one pass over the row
+        index instead of N.
+
+        The cached list is dropped on commit().  Datasets queried while
+        rows are still being appended fall back to a fresh scan whenever
+        the cached list no longer matches the row count.
+    */
+    std::shared_ptr<const std::vector<RowPath> > getSharedRowPaths() const;
+
     /** Select from the database. */
     virtual std::vector<MatrixNamedRow>
     queryStructured(const SelectExpression & select,
@@ -693,6 +784,14 @@ struct Dataset: public MldbEntity {
 
     virtual std::shared_ptr<MatrixView> getMatrixView() const = 0;
     virtual std::shared_ptr<ColumnIndex> getColumnIndex() const = 0;
+
+    /** Return approximate quantiles of the numeric values of a column;
+        see ColumnIndex::getColumnQuantiles, to which this forwards.
+    */
+    virtual std::vector<double>
+    getColumnQuantiles(const ColumnPath & column,
+                       const std::vector<double> & quantiles) const;
+
     virtual std::shared_ptr<RowStream> getRowStream() const { return std::shared_ptr<RowStream>(); } //optional but recommanded for performance
 
     /** Return the range of timestamps in the file.  The default implementation
@@ -729,6 +828,25 @@ struct Dataset: public MldbEntity {
                                        const RowPath & name) const;
 
     virtual uint64_t getRowCount() const;
+
+protected:
+    /** Invoke the callbacks registered with addOnCommitCallback().  Called
+        by the default commit(); implementations that override commit()
+        without calling the base class should call this directly once their
+        new data is visible.
+    */
+    void notifyOnCommit();
+
+private:
+    /// Callbacks registered with addOnCommitCallback(), behind an opaque
+    /// structure so that this API header doesn't pull in <mutex>
+    struct OnCommitCallbacks;
+    std::shared_ptr<OnCommitCallbacks> onCommitCallbacks;
+
+    /// Cached row path list shared by concurrent scans; see
+    /// getSharedRowPaths().  Opaque for the same reason as above.
+    struct RowPathCache;
+    std::shared_ptr<RowPathCache> rowPathCache;
 };
 
 
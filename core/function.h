@@ -14,6 +14,7 @@
 #include "mldb/sql/sql_expression.h"
 #include "mldb/types/annotated_exception.h"
 #include "mldb/types/path.h"
+#include <mutex>
 
 
 // NOTE TO MLDB DEVELOPERS: This is an API header file.  No includes
@@ -175,10 +176,25 @@ struct Function: public MldbEntity {
     */
     virtual FunctionInfo getFunctionInfo() const = 0;
 
+    /** Does binding against the function's own declared input (as
+        returned by getFunctionInfo()) produce an applier that holds no
+        per-call or per-input state?  Functions that bind once at
+        creation time (for example a prepared sql.expression) should
+        return true; call() will then bind a single applier lazily and
+        reuse it for every call instead of re-binding each time, which
+        matters for high-rate model serving.  The applier's apply()
+        must be safe to invoke concurrently from multiple threads.
+    */
+    virtual bool canReuseApplier() const
+    {
+        return false;
+    }
+
     /** Call an unbound function directly with the given input.  Note
-        that this will re-bind the function on every call and is therefore
-        horrendously inefficient; it should be used only for when the
-        input is truly dynamic and there is no possible way to bind it.
+        that unless canReuseApplier() is true, this will re-bind the
+        function on every call and is therefore horrendously
+        inefficient; it should be used only for when the input is truly
+        dynamic and there is no possible way to bind it.
 
         It's not a virtual method as it's complex in how it interprets
         its input.
@@ -207,6 +223,16 @@ struct Function: public MldbEntity {
                                   const ExpressionValue & context) const = 0;
 
     friend class FunctionApplier;
+
+private:
+    /// Scope the cached applier was bound in; declared before the
+    /// applier so that it is destroyed after it
+    mutable std::shared_ptr<SqlBindingScope> cachedApplierScope;
+
+    /// Applier reused across call()s when canReuseApplier() is true
+    mutable std::shared_ptr<const FunctionApplier> cachedApplier;
+
+    mutable std::mutex cachedApplierLock;
 };
 
 
@@ -8,10 +8,17 @@
 
 #include "mldb/core/procedure.h"
 #include "mldb/core/mldb_engine.h"
+#include "mldb/base/work_class.h"
 #include "mldb/types/basic_value_descriptions.h"
 #include <mutex>
+#include <thread>
+#include <condition_variable>
 #include "mldb/types/any_impl.h"
 #include "mldb/rest/cancellation_exception.h"
+#include "mldb/block/zip_serializer.h"
+#include "mldb/vfs/fs_utils.h"
+#include "mldb/vfs/filter_streams.h"
+#include "mldb/arch/format.h"
 
 
 using namespace std;
@@ -82,6 +89,9 @@ ProcedureRun(Procedure * owner,
     ExcAssert(owner);
     this->config.reset(new ProcedureRunConfig(std::move(config)));
     try {
+        // Procedure runs are batch work: their parallel sections yield
+        // CPUs to interactive queries under contention
+        ScopedWorkClass batchWork("batch");
         RunOutput output = owner->run(*this->config, onProgress);
         this->results = std::move(output.results);
         this->details = std::move(output.details);
@@ -122,6 +132,211 @@ RunOutputDescription()
 }
 
 
+/*****************************************************************************/
+/* PROCEDURE CHECKPOINTING                                                   */
+/*****************************************************************************/
+
+DEFINE_STRUCTURE_DESCRIPTION(ProcedureCheckpointConfig);
+
+ProcedureCheckpointConfigDescription::
+ProcedureCheckpointConfigDescription()
+{
+    nullAccepted = true;
+
+    addField("location", &ProcedureCheckpointConfig::location,
+             "URI prefix under which checkpoints are written.  Leaving it "
+             "empty disables checkpointing.");
+    addField("intervalSeconds", &ProcedureCheckpointConfig::intervalSeconds,
+             "Number of seconds between two checkpoints.", 300.0);
+    addField("resume", &ProcedureCheckpointConfig::resume,
+             "If true and a checkpoint is already present at the location, "
+             "the run will resume from it instead of starting from scratch.",
+             true);
+}
+
+struct ProcedureCheckpointer::Itl {
+    Itl(ProcedureCheckpointConfig config)
+        : config(std::move(config))
+    {
+    }
+
+    ProcedureCheckpointConfig config;
+    SaveSnapshot saveSnapshot;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool shutdown = false;
+
+    /// Serializes writers (the periodic thread and checkpointNow())
+    std::mutex writeMutex;
+    int64_t counter = 0;
+    std::string lastWritten;
+
+    bool enabled() const
+    {
+        return !config.location.empty();
+    }
+
+    std::string prefix() const
+    {
+        std::string result = config.location.toDecodedString();
+        if (!result.empty() && result[result.size() - 1] != '/')
+            result += '/';
+        return result;
+    }
+
+    /** Write one checkpoint.  The snapshot goes to a fresh name and
+        only becomes the checkpoint once the LATEST pointer names it,
+        so a node reclaimed mid-write leaves the previous checkpoint
+        untouched.
+    */
+    void writeCheckpoint()
+    {
+        std::unique_lock<std::mutex> guard(writeMutex);
+
+        std::string name
+            = MLDB::format("checkpoint-%09lld.zip", (long long)counter++);
+        std::string target = prefix() + name;
+
+        makeUriDirectory(target);
+
+        {
+            ZipStructuredSerializer serializer{Utf8String(target)};
+            saveSnapshot(serializer);
+            serializer.commit();
+        }
+
+        {
+            filter_ostream latest(prefix() + "LATEST");
+            latest << name << "\n";
+        }
+
+        // The pointer has moved on; the old checkpoint is dead weight
+        if (!lastWritten.empty())
+            tryEraseUriObject(lastWritten);
+        lastWritten = std::move(target);
+    }
+
+    std::shared_ptr<StructuredReconstituter> latestCheckpoint() const
+    {
+        if (!enabled() || !config.resume)
+            return nullptr;
+
+        std::string pointerUri = prefix() + "LATEST";
+        if (!tryGetUriObjectInfo(pointerUri))
+            return nullptr;
+
+        std::string name;
+        {
+            filter_istream stream(pointerUri);
+            getline(stream, name);
+        }
+        if (name.empty())
+            return nullptr;
+
+        std::string target = prefix() + name;
+        if (!tryGetUriObjectInfo(target))
+            return nullptr;
+
+        return std::make_shared<ZipStructuredReconstituter>(Url(target));
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        while (!shutdown) {
+            wakeup.wait_for(guard,
+                            std::chrono::duration<double>
+                                (config.intervalSeconds));
+            if (shutdown)
+                return;
+            guard.unlock();
+            try {
+                writeCheckpoint();
+            } catch (const std::exception & exc) {
+                // A transient write failure shouldn't kill an otherwise
+                // healthy run; the next interval will try again.
+                cerr << "warning: procedure checkpoint failed: "
+                     << exc.what() << endl;
+            }
+            guard.lock();
+        }
+    }
+
+    void start(SaveSnapshot fn)
+    {
+        ExcAssert(fn);
+        ExcAssert(!worker.joinable());
+        saveSnapshot = std::move(fn);
+        if (!enabled())
+            return;
+        worker = std::thread([this] () { this->run(); });
+    }
+
+    void stop()
+    {
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+            shutdown = true;
+            wakeup.notify_all();
+        }
+        if (worker.joinable())
+            worker.join();
+    }
+};
+
+ProcedureCheckpointer::
+ProcedureCheckpointer(ProcedureCheckpointConfig config)
+    : itl(new Itl(std::move(config)))
+{
+}
+
+ProcedureCheckpointer::
+~ProcedureCheckpointer()
+{
+    stop();
+}
+
+bool
+ProcedureCheckpointer::
+enabled() const
+{
+    return itl->enabled();
+}
+
+std::shared_ptr<StructuredReconstituter>
+ProcedureCheckpointer::
+latestCheckpoint() const
+{
+    return itl->latestCheckpoint();
+}
+
+void
+ProcedureCheckpointer::
+start(SaveSnapshot saveSnapshot)
+{
+    itl->start(std::move(saveSnapshot));
+}
+
+void
+ProcedureCheckpointer::
+checkpointNow()
+{
+    ExcAssert(itl->saveSnapshot);
+    if (!itl->enabled())
+        return;
+    itl->writeCheckpoint();
+}
+
+void
+ProcedureCheckpointer::
+stop()
+{
+    itl->stop();
+}
+
+
 /*****************************************************************************/
 /* PROCEDURE                                                                  */
 /*****************************************************************************/
@@ -196,6 +411,11 @@ ProcedureConfigDescription()
              "If true, the procedure will be run immediately. The response will contain an "
              "extra field called `firstRun` pointing to the URL of the run.",
              true);
+    addField("checkpoint", &ProcedureConfig::checkpoint,
+             "Configuration of periodic checkpointing of the run's state, "
+             "allowing a long run interrupted by a node failure to be "
+             "resumed.  Ignored by procedures that don't support "
+             "checkpointing.");
 
     // ignore unknown fields
     onUnknownField = [] (const ProcedureConfig * conf, JsonParsingContext & ctx) { };
@@ -8,6 +8,7 @@
 */
 
 #include "mldb/types/value_description_fwd.h"
+#include "mldb/types/url.h"
 #include "mldb/core/mldb_entity.h"
 #include "mldb/rest/rest_entity.h"
 #include <set>
@@ -28,6 +29,8 @@ namespace MLDB {
 
 struct MldbEngine;
 struct Procedure;
+struct StructuredSerializer;
+struct StructuredReconstituter;
 
 typedef EntityType<Procedure> ProcedureType;
 
@@ -170,6 +173,79 @@ struct Procedure: public MldbEntity, public RestEntity {
 
 
 
+/*****************************************************************************/
+/* PROCEDURE CHECKPOINTING                                                   */
+/*****************************************************************************/
+
+/** Configuration of periodic checkpointing of a long-running procedure
+    run, so that a run interrupted by a node failure can be resumed
+    instead of restarted from scratch.
+*/
+struct ProcedureCheckpointConfig {
+    Url location;                  ///< URI prefix under which checkpoints go;
+                                   ///< empty disables checkpointing
+    double intervalSeconds = 300;  ///< Seconds between two checkpoints
+    bool resume = true;            ///< Resume from the latest checkpoint if
+                                   ///< one is present at the location
+};
+
+DECLARE_STRUCTURE_DESCRIPTION(ProcedureCheckpointConfig);
+
+/** Drives periodic, asynchronous checkpointing of a procedure run.
+
+    A procedure that supports checkpointing creates one of these from
+    its config's checkpoint field and calls start() with a function
+    that writes a snapshot of its state to the given serializer.  The
+    function is called from a background thread so that compute is not
+    paused; it is up to the procedure to make the snapshot cheap to
+    take, typically by handing out a copy-on-write reference to the
+    model state rather than copying it.
+
+    Each checkpoint is written to a fresh object under the configured
+    location and only becomes the current checkpoint once it is
+    complete, so a failure part-way through a write never damages the
+    previous checkpoint.  At the start of a run, latestCheckpoint()
+    returns the last complete checkpoint, if any, so the run can pick
+    up from where it left off.
+*/
+struct ProcedureCheckpointer {
+    ProcedureCheckpointer(ProcedureCheckpointConfig config);
+    ~ProcedureCheckpointer();
+
+    /// Is checkpointing configured (ie, is there a location)?
+    bool enabled() const;
+
+    /** Return a reconstituter over the latest complete checkpoint, or
+        null if there is none or the config says not to resume.
+    */
+    std::shared_ptr<StructuredReconstituter> latestCheckpoint() const;
+
+    typedef std::function<void (StructuredSerializer &)> SaveSnapshot;
+
+    /** Begin checkpointing every intervalSeconds on a background
+        thread.  Does nothing when checkpointing is not enabled.
+    */
+    void start(SaveSnapshot saveSnapshot);
+
+    /** Write a checkpoint immediately, eg at the end of an epoch.
+        Throws on failure (the periodic path logs and carries on
+        instead, since a transient write error shouldn't kill an
+        otherwise healthy run).
+    */
+    void checkpointNow();
+
+    /** Stop the background thread.  The latest checkpoint is left in
+        place for a later run to resume from.  Called by the
+        destructor.
+    */
+    void stop();
+
+private:
+    struct Itl;
+    std::unique_ptr<Itl> itl;
+};
+
+
 /*****************************************************************************/
 /* PROCEDURE CONFIG                                                          */
 /*****************************************************************************/
@@ -179,6 +255,7 @@ struct Procedure: public MldbEntity, public RestEntity {
  */
 struct ProcedureConfig {
     bool runOnCreation = true; // force a run of the procedure upon creation
+    ProcedureCheckpointConfig checkpoint; // periodic run state checkpointing
 };
 
 DECLARE_STRUCTURE_DESCRIPTION(ProcedureConfig);
@@ -0,0 +1,61 @@
+/** query_profile.cc
+    Jeremy Barnes, 30 August 2026
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Per-stage profiling of SQL query execution.
+*/
+
+#include "mldb/core/query_profile.h"
+#include "mldb/types/structure_description.h"
+#include "mldb/types/basic_value_descriptions.h"
+
+
+namespace MLDB {
+
+__thread QueryProfile * QueryProfile::current_ = nullptr;
+
+void
+QueryProfile::
+recordStage(std::string stage, const Timer & timer,
+            uint64_t rowsIn, uint64_t rowsOut, uint64_t bytesTouched)
+{
+    QueryStageProfile result;
+    result.stage = std::move(stage);
+    result.wallSeconds = timer.elapsed_wall();
+    result.cpuSeconds = timer.elapsed_cpu();
+    result.rowsIn = rowsIn;
+    result.rowsOut = rowsOut;
+    result.bytesTouched = bytesTouched;
+    stages.emplace_back(std::move(result));
+}
+
+DEFINE_STRUCTURE_DESCRIPTION(QueryStageProfile);
+
+QueryStageProfileDescription::
+QueryStageProfileDescription()
+{
+    addField("stage", &QueryStageProfile::stage,
+             "Name of the stage");
+    addField("wallSeconds", &QueryStageProfile::wallSeconds,
+             "Elapsed wall clock time of the stage, in seconds");
+    addField("cpuSeconds", &QueryStageProfile::cpuSeconds,
+             "CPU time of the stage summed over all threads, in seconds");
+    addField("rowsIn", &QueryStageProfile::rowsIn,
+             "Number of rows read by the stage");
+    addField("rowsOut", &QueryStageProfile::rowsOut,
+             "Number of rows produced by the stage");
+    addField("bytesTouched", &QueryStageProfile::bytesTouched,
+             "Number of bytes read, where the stage can account for it");
+}
+
+DEFINE_STRUCTURE_DESCRIPTION(QueryProfile);
+
+QueryProfileDescription::
+QueryProfileDescription()
+{
+    addField("stages", &QueryProfile::stages,
+             "Stages of the query, in the order they completed");
+}
+
+} // namespace MLDB
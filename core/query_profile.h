@@ -0,0 +1,106 @@
+/** query_profile.h                                                -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    Per-stage profiling of SQL query execution.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+*/
+
+#pragma once
+
+#include "mldb/arch/timers.h"
+#include "mldb/types/value_description_fwd.h"
+#include <string>
+#include <vector>
+
+
+namespace MLDB {
+
+/*****************************************************************************/
+/* QUERY STAGE PROFILE                                                       */
+/*****************************************************************************/
+
+/** Timing and volume information for one stage of a query (parsing,
+    binding, scanning, sorting, output, ...).
+*/
+
+struct QueryStageProfile {
+    std::string stage;           ///< Name of the stage, eg "scan"
+    double wallSeconds = 0.0;    ///< Elapsed wall clock time
+    double cpuSeconds = 0.0;     ///< CPU time summed over all threads
+    uint64_t rowsIn = 0;         ///< Rows read by the stage
+    uint64_t rowsOut = 0;        ///< Rows produced by the stage
+    uint64_t bytesTouched = 0;   ///< Bytes read, where the stage knows it
+};
+
+DECLARE_STRUCTURE_DESCRIPTION(QueryStageProfile);
+
+
+/*****************************************************************************/
+/* QUERY PROFILE                                                             */
+/*****************************************************************************/
+
+/** Accumulates per-stage profiling information over the execution of a
+    single query.
+
+    A profile is installed on the current thread with a Scope object;
+    query execution code then reports completed stages via the static
+    record() method, which is a no-op when no profile is installed so
+    that unprofiled queries pay nothing beyond a thread-local pointer
+    test.  Stages are recorded from the thread that coordinates the
+    query, not from worker threads, so no locking is needed.
+*/
+
+struct QueryProfile {
+    std::vector<QueryStageProfile> stages;
+
+    /** Record a completed stage timed by the given timer. */
+    void recordStage(std::string stage, const Timer & timer,
+                     uint64_t rowsIn = 0, uint64_t rowsOut = 0,
+                     uint64_t bytesTouched = 0);
+
+    /** Profile installed on the calling thread, or null when profiling
+        is off.
+    */
+    static QueryProfile * current() { return current_; }
+
+    /** Record a stage into the profile installed on the calling thread,
+        if there is one.
+    */
+    static void record(std::string stage, const Timer & timer,
+                       uint64_t rowsIn = 0, uint64_t rowsOut = 0,
+                       uint64_t bytesTouched = 0)
+    {
+        if (current_)
+            current_->recordStage(std::move(stage), timer,
+                                  rowsIn, rowsOut, bytesTouched);
+    }
+
+    /** Install a profile on the calling thread for the duration of a
+        scope, restoring whatever was there before on exit.
+    */
+    struct Scope {
+        Scope(QueryProfile & profile)
+            : saved(current_)
+        {
+            current_ = &profile;
+        }
+
+        ~Scope()
+        {
+            current_ = saved;
+        }
+
+        Scope(const Scope &) = delete;
+        void operator = (const Scope &) = delete;
+
+    private:
+        QueryProfile * saved;
+    };
+
+private:
+    static __thread QueryProfile * current_;
+};
+
+DECLARE_STRUCTURE_DESCRIPTION(QueryProfile);
+
+} // namespace MLDB
@@ -4,10 +4,14 @@
 */
 
 #include "recorder.h"
+#include "mldb/core/dataset.h"
 #include "mldb/rest/poly_collection.h"
 #include "mldb/rest/poly_collection_impl.h"
 #include "mldb/types/structure_description.h"
 #include "mldb/core/mldb_engine.h"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 namespace MLDB {
 
@@ -106,6 +110,203 @@ recordTabularImpl(RowPath rowName,
 }
 
 
+/*****************************************************************************/
+/* BUFFERED RECORDER                                                         */
+/*****************************************************************************/
+
+struct BufferedRecorder::ThreadBuffer {
+    /// Chunk recorder owned by this thread; rows flush into it in bulk
+    std::unique_ptr<Recorder> chunk;
+
+    std::vector<std::pair<RowPath, ExpressionValue> > exprRows;
+    std::vector<std::pair<RowPath,
+                          std::vector<std::tuple<ColumnPath, CellValue,
+                                                 Date> > > > flatRows;
+
+    size_t buffered() const
+    {
+        return exprRows.size() + flatRows.size();
+    }
+};
+
+struct BufferedRecorder::Itl {
+    std::shared_ptr<Dataset> dataset;
+    size_t bufferRows;
+    Dataset::MultiChunkRecorder chunks;
+
+    /// Chunk number handed to the next thread that starts recording
+    std::atomic<size_t> nextChunk = 0;
+
+    /// Unique id of this recorder instance.  The thread-local buffer
+    /// maps are keyed on it rather than on the address, so a recorder
+    /// allocated where a destroyed one used to live doesn't pick up
+    /// its predecessor's buffers.
+    uint64_t instance;
+
+    /// Every buffer created so far, so commit() can flush them all.
+    /// Only touched when a thread records for the first time and at
+    /// commit, so the lock is off the per-row path.
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer> > buffers;
+
+    static std::atomic<uint64_t> nextInstance;
+};
+
+std::atomic<uint64_t> BufferedRecorder::Itl::nextInstance(0);
+
+BufferedRecorder::
+BufferedRecorder(MldbEngine * engine,
+                 std::shared_ptr<Dataset> dataset,
+                 size_t bufferRows)
+    : Recorder(engine), itl(new Itl())
+{
+    ExcAssert(dataset);
+    itl->dataset = std::move(dataset);
+    itl->bufferRows = std::max<size_t>(bufferRows, 1);
+    itl->chunks = itl->dataset->getChunkRecorder();
+    itl->instance = ++Itl::nextInstance;
+}
+
+BufferedRecorder::
+~BufferedRecorder()
+{
+    // Rows not committed are abandoned, as with the underlying chunk
+    // recorders
+}
+
+BufferedRecorder::ThreadBuffer &
+BufferedRecorder::
+getThreadBuffer()
+{
+    static thread_local std::unordered_map
+        <uint64_t, std::shared_ptr<ThreadBuffer> > buffers;
+
+    std::shared_ptr<ThreadBuffer> & entry = buffers[itl->instance];
+    if (!entry) {
+        entry = std::make_shared<ThreadBuffer>();
+        entry->chunk = itl->chunks.newChunk(itl->nextChunk.fetch_add(1));
+        std::unique_lock<std::mutex> guard(itl->mutex);
+        itl->buffers.emplace_back(entry);
+    }
+    return *entry;
+}
+
+void
+BufferedRecorder::
+flush(ThreadBuffer & buffer)
+{
+    if (!buffer.exprRows.empty()) {
+        auto rows = std::move(buffer.exprRows);
+        buffer.exprRows.clear();
+        buffer.chunk->recordRowsExprDestructive(std::move(rows));
+    }
+    if (!buffer.flatRows.empty()) {
+        auto rows = std::move(buffer.flatRows);
+        buffer.flatRows.clear();
+        buffer.chunk->recordRowsDestructive(std::move(rows));
+    }
+}
+
+void
+BufferedRecorder::
+recordRowExpr(const RowPath & rowName,
+              const ExpressionValue & expr)
+{
+    recordRowExprDestructive(rowName, expr);
+}
+
+void
+BufferedRecorder::
+recordRowExprDestructive(RowPath rowName,
+                         ExpressionValue expr)
+{
+    auto & buffer = getThreadBuffer();
+    buffer.exprRows.emplace_back(std::move(rowName), std::move(expr));
+    if (buffer.buffered() >= itl->bufferRows)
+        flush(buffer);
+}
+
+void
+BufferedRecorder::
+recordRow(const RowPath & rowName,
+          const std::vector<std::tuple<ColumnPath, CellValue, Date> > & vals)
+{
+    recordRowDestructive(rowName, vals);
+}
+
+void
+BufferedRecorder::
+recordRowDestructive(RowPath rowName,
+                     std::vector<std::tuple<ColumnPath, CellValue, Date> > vals)
+{
+    auto & buffer = getThreadBuffer();
+    buffer.flatRows.emplace_back(std::move(rowName), std::move(vals));
+    if (buffer.buffered() >= itl->bufferRows)
+        flush(buffer);
+}
+
+void
+BufferedRecorder::
+recordRows(const std::vector<std::pair<RowPath, std::vector<std::tuple<ColumnPath, CellValue, Date> > > > & rows)
+{
+    auto & buffer = getThreadBuffer();
+    for (auto & r: rows)
+        buffer.flatRows.emplace_back(r);
+    if (buffer.buffered() >= itl->bufferRows)
+        flush(buffer);
+}
+
+void
+BufferedRecorder::
+recordRowsDestructive(std::vector<std::pair<RowPath, std::vector<std::tuple<ColumnPath, CellValue, Date> > > > rows)
+{
+    auto & buffer = getThreadBuffer();
+    for (auto & r: rows)
+        buffer.flatRows.emplace_back(std::move(r));
+    if (buffer.buffered() >= itl->bufferRows)
+        flush(buffer);
+}
+
+void
+BufferedRecorder::
+recordRowsExpr(const std::vector<std::pair<RowPath, ExpressionValue > > & rows)
+{
+    auto & buffer = getThreadBuffer();
+    for (auto & r: rows)
+        buffer.exprRows.emplace_back(r);
+    if (buffer.buffered() >= itl->bufferRows)
+        flush(buffer);
+}
+
+void
+BufferedRecorder::
+recordRowsExprDestructive(std::vector<std::pair<RowPath, ExpressionValue > > rows)
+{
+    auto & buffer = getThreadBuffer();
+    for (auto & r: rows)
+        buffer.exprRows.emplace_back(std::move(r));
+    if (buffer.buffered() >= itl->bufferRows)
+        flush(buffer);
+}
+
+void
+BufferedRecorder::
+commit()
+{
+    {
+        std::unique_lock<std::mutex> guard(itl->mutex);
+        for (auto & b: itl->buffers) {
+            flush(*b);
+            b->chunk->finishedChunk();
+            b->chunk.reset();
+        }
+        itl->buffers.clear();
+    }
+
+    itl->chunks.commit();
+}
+
+
 /*****************************************************************************/
 /* REGISTRATION FUNCTIONS                                                    */
 /*****************************************************************************/
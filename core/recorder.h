@@ -140,6 +140,74 @@ struct Recorder: public MldbEntity {
 };
 
 
+/*****************************************************************************/
+/* BUFFERED RECORDER                                                         */
+/*****************************************************************************/
+
+/** Recorder that accumulates rows in per-thread buffers and flushes
+    each buffer in bulk to its own chunk of the underlying dataset's
+    chunk recorder when it fills up.  This is the pattern the text
+    importer hand-rolls; wrapping it here gives any procedure parallel
+    recording with no per-row synchronization: the record methods can
+    be called concurrently from any number of threads, and each thread
+    touches only its own buffer on the hot path.
+
+    commit() must be called once every recording thread has finished.
+    It flushes every thread's remaining rows, finishes each chunk and
+    then commits the dataset in a single place, so the committed
+    dataset always contains exactly the rows recorded before the call.
+*/
+
+struct BufferedRecorder: public Recorder {
+    BufferedRecorder(MldbEngine * engine,
+                     std::shared_ptr<Dataset> dataset,
+                     size_t bufferRows = 16384);
+
+    virtual ~BufferedRecorder();
+
+    virtual void
+    recordRowExpr(const RowPath & rowName,
+                  const ExpressionValue & expr) override;
+
+    virtual void
+    recordRowExprDestructive(RowPath rowName,
+                             ExpressionValue expr) override;
+
+    virtual void
+    recordRow(const RowPath & rowName,
+              const std::vector<std::tuple<ColumnPath, CellValue, Date> > & vals) override;
+
+    virtual void
+    recordRowDestructive(RowPath rowName,
+                         std::vector<std::tuple<ColumnPath, CellValue, Date> > vals) override;
+
+    virtual void
+    recordRows(const std::vector<std::pair<RowPath, std::vector<std::tuple<ColumnPath, CellValue, Date> > > > & rows) override;
+
+    virtual void
+    recordRowsDestructive(std::vector<std::pair<RowPath, std::vector<std::tuple<ColumnPath, CellValue, Date> > > > rows) override;
+
+    virtual void
+    recordRowsExpr(const std::vector<std::pair<RowPath, ExpressionValue > > & rows) override;
+
+    virtual void
+    recordRowsExprDestructive(std::vector<std::pair<RowPath, ExpressionValue > > rows) override;
+
+    /** Flush every thread's buffer and commit the underlying dataset.
+        Must not be called concurrently with the record methods.
+    */
+    void commit();
+
+private:
+    struct ThreadBuffer;
+    struct Itl;
+    std::unique_ptr<Itl> itl;
+
+    ThreadBuffer & getThreadBuffer();
+    void flush(ThreadBuffer & buffer);
+};
+
+
 /*****************************************************************************/
 /* FUNCTIONS                                                                 */
 /*****************************************************************************/
@@ -0,0 +1,197 @@
+/** slow_query_log.cc
+    Jeremy Barnes, 30 August 2026
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Automatic capture of queries exceeding a latency budget.
+*/
+
+#include "mldb/core/slow_query_log.h"
+#include "mldb/utils/environment.h"
+#include "mldb/arch/format.h"
+#include "mldb/types/structure_description.h"
+#include "mldb/types/basic_value_descriptions.h"
+
+
+namespace MLDB {
+
+namespace {
+
+/// Latency budget at startup, in milliseconds
+EnvOption<int> SLOW_QUERY_MS("MLDB_SLOW_QUERY_MS", 1000);
+
+/// How many captured queries the ring holds before dropping old ones
+constexpr size_t RING_CAPACITY = 128;
+
+} // file scope
+
+
+/*****************************************************************************/
+/* SLOW QUERY LOG ENTRY                                                      */
+/*****************************************************************************/
+
+DEFINE_STRUCTURE_DESCRIPTION(SlowQueryLogEntry);
+
+SlowQueryLogEntryDescription::
+SlowQueryLogEntryDescription()
+{
+    addField("startTime", &SlowQueryLogEntry::startTime,
+             "When the query started running");
+    addField("query", &SlowQueryLogEntry::query,
+             "SQL text of the query");
+    addField("fingerprint", &SlowQueryLogEntry::fingerprint,
+             "Hash of the query with literals stripped; different "
+             "parameter values of the same query shape share it");
+    addField("wallSeconds", &SlowQueryLogEntry::wallSeconds,
+             "Total runtime in seconds, or runtime so far for a query "
+             "that was still running when captured");
+    addField("stillRunning", &SlowQueryLogEntry::stillRunning,
+             "Captured by the watchdog before the query finished",
+             false);
+    addField("profile", &SlowQueryLogEntry::profile,
+             "Per-stage timings (empty for still running queries)");
+}
+
+
+/*****************************************************************************/
+/* SLOW QUERY LOG                                                            */
+/*****************************************************************************/
+
+SlowQueryLog::
+SlowQueryLog()
+    : thresholdSeconds(SLOW_QUERY_MS.get() / 1000.0)
+{
+}
+
+SlowQueryLog &
+SlowQueryLog::
+instance()
+{
+    static SlowQueryLog result;
+    return result;
+}
+
+SlowQueryLog::Scope::
+Scope(Utf8String query)
+    : startTime(Date::now()),
+      query(std::move(query))
+{
+    SlowQueryLog & log = instance();
+    std::unique_lock<std::mutex> guard(log.mutex);
+    position = log.active.insert(log.active.end(), this);
+}
+
+SlowQueryLog::Scope::
+~Scope()
+{
+    SlowQueryLog & log = instance();
+
+    bool reported;
+    {
+        std::unique_lock<std::mutex> guard(log.mutex);
+        log.active.erase(position);
+        reported = reportedStalled;
+    }
+
+    double elapsed = Date::now().secondsSince(startTime);
+    if (elapsed < log.thresholdSeconds.load() && !reported)
+        return;
+
+    SlowQueryLogEntry entry;
+    entry.startTime = startTime;
+    entry.query = std::move(query);
+    entry.fingerprint = fingerprint(entry.query);
+    entry.wallSeconds = elapsed;
+    entry.profile = std::move(profile);
+    log.record(std::move(entry));
+}
+
+void
+SlowQueryLog::
+checkStalled()
+{
+    double threshold = thresholdSeconds.load();
+    Date now = Date::now();
+
+    std::vector<SlowQueryLogEntry> stalled;
+
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        for (Scope * scope: active) {
+            if (scope->reportedStalled)
+                continue;
+            double elapsed = now.secondsSince(scope->startTime);
+            if (elapsed < threshold)
+                continue;
+            scope->reportedStalled = true;
+
+            SlowQueryLogEntry entry;
+            entry.startTime = scope->startTime;
+            entry.query = scope->query;
+            entry.fingerprint = fingerprint(entry.query);
+            entry.wallSeconds = elapsed;
+            entry.stillRunning = true;
+            // The profile is left empty: the query thread is still
+            // writing to it
+            stalled.emplace_back(std::move(entry));
+        }
+    }
+
+    for (auto & entry: stalled)
+        record(std::move(entry));
+}
+
+std::vector<SlowQueryLogEntry>
+SlowQueryLog::
+entries() const
+{
+    std::unique_lock<std::mutex> guard(mutex);
+    return std::vector<SlowQueryLogEntry>(ring.rbegin(), ring.rend());
+}
+
+std::string
+SlowQueryLog::
+fingerprint(const Utf8String & query)
+{
+    // Blank out quoted strings and runs of digits, so that the hash
+    // depends only on the shape of the query
+    std::string normalized;
+    normalized.reserve(query.rawLength());
+
+    char inQuote = 0;
+    bool inNumber = false;
+    for (char c: query.rawString()) {
+        if (inQuote) {
+            if (c == inQuote)
+                inQuote = 0;
+            continue;
+        }
+        if (c == '\'' || c == '"') {
+            inQuote = c;
+            normalized += '?';
+            continue;
+        }
+        if (isdigit(c)) {
+            if (!inNumber)
+                normalized += '?';
+            inNumber = true;
+            continue;
+        }
+        inNumber = false;
+        normalized += tolower(c);
+    }
+
+    return format("%016zx", std::hash<std::string>()(normalized));
+}
+
+void
+SlowQueryLog::
+record(SlowQueryLogEntry entry)
+{
+    std::unique_lock<std::mutex> guard(mutex);
+    ring.emplace_back(std::move(entry));
+    while (ring.size() > RING_CAPACITY)
+        ring.pop_front();
+}
+
+} // namespace MLDB
@@ -0,0 +1,110 @@
+/** slow_query_log.h                                               -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    Automatic capture of queries exceeding a latency budget.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+*/
+
+#pragma once
+
+#include "mldb/core/query_profile.h"
+#include "mldb/types/date.h"
+#include "mldb/types/string.h"
+#include <atomic>
+#include <deque>
+#include <list>
+#include <mutex>
+
+
+namespace MLDB {
+
+/*****************************************************************************/
+/* SLOW QUERY LOG ENTRY                                                      */
+/*****************************************************************************/
+
+/** One captured slow query. */
+
+struct SlowQueryLogEntry {
+    Date startTime;            ///< When the query started running
+    Utf8String query;          ///< SQL text of the query
+    std::string fingerprint;   ///< Hash of the query with literals stripped
+    double wallSeconds = 0.0;  ///< Total runtime, or runtime so far
+    bool stillRunning = false; ///< Captured by the watchdog before it finished
+    QueryProfile profile;      ///< Per-stage timings, for completed queries
+};
+
+DECLARE_STRUCTURE_DESCRIPTION(SlowQueryLogEntry);
+
+
+/*****************************************************************************/
+/* SLOW QUERY LOG                                                            */
+/*****************************************************************************/
+
+/** Ring buffer of queries that exceeded the latency budget.
+
+    Queries register themselves with a Scope for the time they are
+    running.  When the scope is destroyed, queries that ran longer than
+    thresholdSeconds are pushed into the ring; in addition checkStalled()
+    (driven by the server's watchdog timer) captures queries that are
+    over the budget but have not finished yet, so a query that has
+    wedged a node shows up without waiting for it to complete.
+
+    The budget is read from MLDB_SLOW_QUERY_MS at startup and can be
+    changed at runtime.
+*/
+
+struct SlowQueryLog {
+
+    static SlowQueryLog & instance();
+
+    /// Latency budget over which queries are captured, in seconds
+    std::atomic<double> thresholdSeconds;
+
+    /** Registers an in-flight query for the lifetime of the object.
+        The caller installs the embedded profile on its thread (with a
+        QueryProfile::Scope) so captured queries carry per-stage
+        timings.
+    */
+    struct Scope {
+        Scope(Utf8String query);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        void operator = (const Scope &) = delete;
+
+        QueryProfile profile;
+
+    private:
+        friend struct SlowQueryLog;
+        Date startTime;
+        Utf8String query;
+        bool reportedStalled = false;
+        std::list<Scope *>::iterator position;
+    };
+
+    /** Capture in-flight queries that are over the budget.  Called
+        periodically from the server's watchdog timer; each stalled
+        query is captured at most once.
+    */
+    void checkStalled();
+
+    /** The captured queries, most recent first. */
+    std::vector<SlowQueryLogEntry> entries() const;
+
+    /** Fingerprint of a query: a hash of the text with string and
+        numeric literals blanked out, so different parameter values of
+        the same query shape share a fingerprint.
+    */
+    static std::string fingerprint(const Utf8String & query);
+
+private:
+    SlowQueryLog();
+
+    void record(SlowQueryLogEntry entry);
+
+    mutable std::mutex mutex;
+    std::list<Scope *> active;        ///< Queries currently running
+    std::deque<SlowQueryLogEntry> ring;
+};
+
+} // namespace MLDB
@@ -10,7 +10,10 @@
 #include "mldb/credentials/credential_provider.h"
 #include "mldb/types/optional.h"
 #include "mldb/base/exc_assert.h"
+#include <atomic>
+#include <map>
 #include <mutex>
+#include <thread>
 #include <iostream>
 
 using namespace std;
@@ -31,14 +34,117 @@ namespace {
 std::mutex providersLock;
 std::vector<std::shared_ptr<CredentialProvider> > providers;
 
+/* Cache of stored credentials per resource type.  Opening a resource
+   consults the providers (and thus the credentials store) once per TTL
+   instead of once per resource; an entry past half of its TTL is
+   refreshed in the background so that lookups never wait on a store
+   round trip.  The prefix matching itself is done in memory on the
+   cached candidates. */
+
+struct CachedCredentials {
+    CachedCredentials()
+        : refreshing(false)
+    {
+    }
+
+    std::vector<StoredCredentials> candidates;
+    Date fetched;
+    std::atomic<bool> refreshing;
+};
+
+std::mutex cacheLock;
+std::map<std::string, std::shared_ptr<CachedCredentials> > credentialCache;
+double credentialCacheTtl = 60.0;
+
+/** Query all registered providers for credentials of the given type. */
+std::vector<StoredCredentials>
+fetchCredentialsOfType(const std::string & resourceType)
+{
+    std::vector<std::shared_ptr<CredentialProvider> > current;
+    {
+        std::unique_lock<std::mutex> guard(providersLock);
+        current = providers;
+    }
+
+    std::vector<StoredCredentials> candidates;
+    for (auto & p: current) {
+        auto creds = p->getCredentialsOfType(resourceType);
+        if (!creds.empty())
+            candidates.insert(candidates.end(), creds.begin(), creds.end());
+    }
+
+    return candidates;
+}
+
+/** Cache the given candidates for the given resource type. */
+void cacheCredentials(const std::string & resourceType,
+                      std::vector<StoredCredentials> candidates)
+{
+    auto entry = std::make_shared<CachedCredentials>();
+    entry->candidates = std::move(candidates);
+    entry->fetched = Date::now();
+
+    std::unique_lock<std::mutex> guard(cacheLock);
+    credentialCache[resourceType] = std::move(entry);
+}
+
+/** Refresh the cached entry for the given resource type without the
+    caller waiting on it.
+*/
+void refreshCredentialsInBackground(const std::string & resourceType)
+{
+    std::thread([resourceType] ()
+        {
+            try {
+                auto candidates = fetchCredentialsOfType(resourceType);
+                if (candidates.empty()) {
+                    // Don't serve stale credentials once the store says
+                    // there are none any more
+                    std::unique_lock<std::mutex> guard(cacheLock);
+                    credentialCache.erase(resourceType);
+                }
+                else cacheCredentials(resourceType, std::move(candidates));
+            } catch (const std::exception & exc) {
+                // Keep serving the current entry; it will be refetched
+                // synchronously once it expires
+                std::unique_lock<std::mutex> guard(cacheLock);
+                auto it = credentialCache.find(resourceType);
+                if (it != credentialCache.end())
+                    it->second->refreshing = false;
+            }
+        }).detach();
+}
+
 } // file scope
 
 void
 CredentialProvider::
 registerProvider(std::shared_ptr<CredentialProvider> provider)
 {
-    std::unique_lock<std::mutex> guard(providersLock);
-    providers.push_back(provider);
+    {
+        std::unique_lock<std::mutex> guard(providersLock);
+        providers.push_back(provider);
+    }
+
+    // The new provider may supply credentials for types we've already
+    // resolved
+    invalidateCredentialCache();
+}
+
+void
+setCredentialCacheTtl(double seconds)
+{
+    std::unique_lock<std::mutex> guard(cacheLock);
+    credentialCacheTtl = seconds;
+    if (seconds <= 0.0)
+        credentialCache.clear();
+}
+
+void
+invalidateCredentialCache()
+{
+    std::unique_lock<std::mutex> guard(cacheLock);
+    credentialCache.clear();
 }
 
 Credential
@@ -46,19 +152,37 @@ getCredential(const std::string & resourceType,
               const std::string & resource)
 {
     std::vector<StoredCredentials> candidates;
-    {
-        std::unique_lock<std::mutex> guard(providersLock);
 
-        // find all credentials matching the resource type
-        for (auto it = providers.begin(), end = providers.end();
-             it != end;  ++it) {
-            auto creds = (*it)->getCredentialsOfType(resourceType);
-            if (!creds.empty()) {
-                candidates.insert(candidates.end(), creds.begin(), creds.end());
+    double ttl;
+    bool cached = false;
+    {
+        std::unique_lock<std::mutex> guard(cacheLock);
+        ttl = credentialCacheTtl;
+        auto it = credentialCache.find(resourceType);
+        if (it != credentialCache.end()) {
+            auto & entry = *it->second;
+            if (Date::now() < entry.fetched.plusSeconds(ttl)) {
+                candidates = entry.candidates;
+                cached = true;
+
+                // Refresh before expiry so no lookup ever waits on the
+                // store
+                if (Date::now() > entry.fetched.plusSeconds(ttl / 2)
+                    && !entry.refreshing.exchange(true))
+                    refreshCredentialsInBackground(resourceType);
             }
         }
     }
 
+    if (!cached) {
+        candidates = fetchCredentialsOfType(resourceType);
+
+        // Don't cache misses: a credential stored just after this lookup
+        // must become visible immediately
+        if (ttl > 0.0 && !candidates.empty())
+            cacheCredentials(resourceType, candidates);
+    }
+
     // find the best match
 
     // This might be too simplistic but we assume here that longer
@@ -69,6 +193,11 @@ getCredential(const std::string & resourceType,
     for (const auto & storedCredential : candidates) {
         ExcAssertEqual(resourceType, storedCredential.resourceType);
 
+        // Skip credentials that have expired since they were cached
+        if (storedCredential.expiration != Date()
+            && storedCredential.expiration < Date::now())
+            continue;
+
         if (resource.find(storedCredential.resource) != 0)
             continue;  // not a prefix
 
@@ -44,8 +44,24 @@ DECLARE_STRUCTURE_DESCRIPTION(StoredCredentials);
 
 /** Returns the best credential match for the given resource.
     If no credential is found an exception is thrown.
+
+    Resolved credentials are served from a local TTL cache, which is
+    refreshed in the background before it expires so that lookups don't
+    wait on a round trip to the credentials store.
 */
 Credential getCredential(const std::string & resourceType,
                          const std::string & resource);
 
+/** Set the time for which resolved credentials may be served from the
+    local cache before being refetched from the providers.  A TTL of
+    zero disables caching entirely.
+*/
+void setCredentialCacheTtl(double seconds);
+
+/** Drop all cached credentials, forcing the next lookup to consult the
+    providers again.  Called whenever the set of stored credentials
+    changes.
+*/
+void invalidateCredentialCache();
+
 } // namespace MLDB
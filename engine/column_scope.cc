@@ -5,6 +5,7 @@
 
 #include "mldb/engine/column_scope.h"
 #include "mldb/sql/sql_expression_operations.h"
+#include "mldb/sql/builtin_functions.h"
 #include "mldb/arch/timers.h"
 #include "mldb/base/parallel.h"
 #include "mldb/base/thread_pool.h"
@@ -185,6 +186,317 @@ runFloat(const std::vector<BoundSqlExpression> & exprs) const
     return runT<float>(exprs);
 }
 
+namespace { // file scope
+
+/** Above this total cost for the arms of a CASE, eager evaluation of
+    every arm for every row costs more than the branch mispredicts it
+    saves, and the expression is left to the lazy row-at-a-time path.
+    The unit is roughly one vectorizable operation per row.
+*/
+constexpr size_t CASE_EAGER_COST_LIMIT = 64;
+
+/** Recursively compile an expression tree into a batch kernel, or
+    return a null function if a node outside the supported subset is
+    encountered.  cost accumulates a rough per-row operation count for
+    the compiled subtree, used to decide whether evaluating both arms
+    of a conditional eagerly is worthwhile.
+*/
+ColumnScope::BatchKernel
+compileBatchNode(const SqlExpression * node,
+                 const std::map<ColumnPath, size_t> & columnIndexes,
+                 size_t & cost)
+{
+    constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+    if (auto col = dynamic_cast<const ReadColumnExpression *>(node)) {
+        auto it = columnIndexes.find(col->columnName);
+        if (it == columnIndexes.end())
+            return nullptr;
+        size_t idx = it->second;
+        cost += 1;
+        return [=] (const double * rows, size_t stride,
+                    size_t n, double * out)
+            {
+                for (size_t r = 0;  r < n;  ++r)
+                    out[r] = rows[r * stride + idx];
+            };
+    }
+
+    if (auto cst = dynamic_cast<const ConstantExpression *>(node)) {
+        if (!cst->constant.isAtom())
+            return nullptr;
+        CellValue atom = cst->constant.getAtom();
+        double val;
+        if (atom.empty())
+            val = NaN;
+        else if (atom.isNumber())
+            val = atom.toDouble();
+        else return nullptr;
+        return [=] (const double *, size_t, size_t n, double * out)
+            {
+                std::fill(out, out + n, val);
+            };
+    }
+
+    if (auto fn = dynamic_cast<const FunctionCallExpression *>(node)) {
+        /* Unary numeric builtins with a registered typed kernel run
+           directly over the unboxed batch; NaN encodes null on both
+           sides, which the kernels propagate.  Anything else falls back
+           to the rich ExpressionValue interface. */
+        if (!fn->tableName.empty() || fn->args.size() != 1)
+            return nullptr;
+        auto kernel = Builtins::lookupBuiltinKernel(fn->functionName);
+        if (!kernel)
+            return nullptr;
+        auto arg = compileBatchNode(fn->args[0].get(), columnIndexes, cost);
+        if (!arg)
+            return nullptr;
+        cost += 4;
+        return [=] (const double * rows, size_t stride,
+                    size_t n, double * out)
+            {
+                arg(rows, stride, n, out);
+                for (size_t r = 0;  r < n;  ++r)
+                    out[r] = kernel(out[r]);
+            };
+    }
+
+    if (auto arith = dynamic_cast<const ArithmeticExpression *>(node)) {
+        auto lhs = compileBatchNode(arith->lhs.get(), columnIndexes, cost);
+        auto rhs = compileBatchNode(arith->rhs.get(), columnIndexes, cost);
+        if (!lhs || !rhs)
+            return nullptr;
+        cost += 2;
+        char op = arith->op.length() == 1 ? arith->op[0] : 0;
+        if (op != '+' && op != '-' && op != '*' && op != '/')
+            return nullptr;
+
+        // Nulls are NaNs in this representation, and NaNs propagate
+        // through arithmetic exactly as nulls do through SQL, so the
+        // inner loops need no null tests at all.
+        return [=] (const double * rows, size_t stride,
+                    size_t n, double * out)
+            {
+                PossiblyDynamicBuffer<double> tmpHolder(n);
+                double * tmp = tmpHolder.data();
+                lhs(rows, stride, n, out);
+                rhs(rows, stride, n, tmp);
+                switch (op) {
+                case '+':
+                    for (size_t r = 0;  r < n;  ++r) out[r] += tmp[r];
+                    break;
+                case '-':
+                    for (size_t r = 0;  r < n;  ++r) out[r] -= tmp[r];
+                    break;
+                case '*':
+                    for (size_t r = 0;  r < n;  ++r) out[r] *= tmp[r];
+                    break;
+                case '/':
+                    for (size_t r = 0;  r < n;  ++r) out[r] /= tmp[r];
+                    break;
+                }
+            };
+    }
+
+    if (auto cmp = dynamic_cast<const ComparisonExpression *>(node)) {
+        auto lhs = compileBatchNode(cmp->lhs.get(), columnIndexes, cost);
+        auto rhs = compileBatchNode(cmp->rhs.get(), columnIndexes, cost);
+        if (!lhs || !rhs)
+            return nullptr;
+        cost += 2;
+
+        enum { EQ, NE, LT, LE, GT, GE } code;
+        if (cmp->op == "=") code = EQ;
+        else if (cmp->op == "!=") code = NE;
+        else if (cmp->op == "<") code = LT;
+        else if (cmp->op == "<=") code = LE;
+        else if (cmp->op == ">") code = GT;
+        else if (cmp->op == ">=") code = GE;
+        else return nullptr;
+
+        return [=] (const double * rows, size_t stride,
+                    size_t n, double * out)
+            {
+                PossiblyDynamicBuffer<double> tmpHolder(n);
+                double * tmp = tmpHolder.data();
+                lhs(rows, stride, n, out);
+                rhs(rows, stride, n, tmp);
+
+                auto apply = [&] (auto && op)
+                    {
+                        // Comparing against a null yields null in SQL
+                        for (size_t r = 0;  r < n;  ++r) {
+                            out[r] = (std::isnan(out[r]) || std::isnan(tmp[r]))
+                                ? NaN
+                                : (double)op(out[r], tmp[r]);
+                        }
+                    };
+
+                switch (code) {
+                case EQ: apply(std::equal_to<double>());       break;
+                case NE: apply(std::not_equal_to<double>());   break;
+                case LT: apply(std::less<double>());           break;
+                case LE: apply(std::less_equal<double>());     break;
+                case GT: apply(std::greater<double>());        break;
+                case GE: apply(std::greater_equal<double>());  break;
+                }
+            };
+    }
+
+    if (auto boolOp = dynamic_cast<const BooleanOperatorExpression *>(node)) {
+        if (boolOp->op == "NOT") {
+            auto arg = compileBatchNode(boolOp->rhs.get(), columnIndexes,
+                                        cost);
+            if (!arg)
+                return nullptr;
+            cost += 1;
+            return [=] (const double * rows, size_t stride,
+                        size_t n, double * out)
+                {
+                    arg(rows, stride, n, out);
+                    for (size_t r = 0;  r < n;  ++r)
+                        out[r] = std::isnan(out[r])
+                            ? NaN : (double)(out[r] == 0.0);
+                };
+        }
+
+        bool isAnd;
+        if (boolOp->op == "AND") isAnd = true;
+        else if (boolOp->op == "OR") isAnd = false;
+        else return nullptr;
+
+        auto lhs = compileBatchNode(boolOp->lhs.get(), columnIndexes, cost);
+        auto rhs = compileBatchNode(boolOp->rhs.get(), columnIndexes, cost);
+        if (!lhs || !rhs)
+            return nullptr;
+        cost += 3;
+
+        // Three-valued logic, computed for both sides with selects
+        // rather than short-circuit branches: FALSE dominates AND and
+        // TRUE dominates OR even when the other side is null.
+        return [=] (const double * rows, size_t stride,
+                    size_t n, double * out)
+            {
+                PossiblyDynamicBuffer<double> tmpHolder(n);
+                double * tmp = tmpHolder.data();
+                lhs(rows, stride, n, out);
+                rhs(rows, stride, n, tmp);
+                for (size_t r = 0;  r < n;  ++r) {
+                    bool lNull = std::isnan(out[r]);
+                    bool rNull = std::isnan(tmp[r]);
+                    bool lTrue = !lNull && out[r] != 0.0;
+                    bool rTrue = !rNull && tmp[r] != 0.0;
+                    if (isAnd)
+                        out[r] = ((!lNull && !lTrue) || (!rNull && !rTrue))
+                            ? 0.0 : (lNull || rNull) ? NaN : 1.0;
+                    else
+                        out[r] = (lTrue || rTrue)
+                            ? 1.0 : (lNull || rNull) ? NaN : 0.0;
+                }
+            };
+    }
+
+    if (auto caseExpr = dynamic_cast<const CaseExpression *>(node)) {
+        // A simple CASE compares a selector against each WHEN value;
+        // a searched CASE evaluates each WHEN as a condition.
+        ColumnScope::BatchKernel selector;
+        if (caseExpr->expr) {
+            selector = compileBatchNode(caseExpr->expr.get(),
+                                        columnIndexes, cost);
+            if (!selector)
+                return nullptr;
+        }
+
+        // Every condition and every arm is evaluated for every row
+        // and the result blended by mask, so the compiled subtrees
+        // must all be in the (pure, cheap) supported subset, and the
+        // total work must stay under the eager budget; anything
+        // heavier is better served by the lazy row-at-a-time path.
+        size_t armCost = 0;
+        std::vector<std::pair<ColumnScope::BatchKernel,
+                              ColumnScope::BatchKernel> > whens;
+        for (auto & w: caseExpr->when) {
+            auto cond = compileBatchNode(w.first.get(), columnIndexes,
+                                         armCost);
+            auto then = compileBatchNode(w.second.get(), columnIndexes,
+                                         armCost);
+            if (!cond || !then)
+                return nullptr;
+            whens.emplace_back(std::move(cond), std::move(then));
+        }
+
+        ColumnScope::BatchKernel elseKernel;
+        if (caseExpr->elseExpr) {
+            elseKernel = compileBatchNode(caseExpr->elseExpr.get(),
+                                          columnIndexes, armCost);
+            if (!elseKernel)
+                return nullptr;
+        }
+
+        if (armCost > CASE_EAGER_COST_LIMIT)
+            return nullptr;
+        cost += armCost + whens.size();
+
+        bool simple = !!selector;
+        return [=] (const double * rows, size_t stride,
+                    size_t n, double * out)
+            {
+                PossiblyDynamicBuffer<double> condHolder(n);
+                PossiblyDynamicBuffer<double> valHolder(n);
+                PossiblyDynamicBuffer<double> selHolder(simple ? n : 1);
+                double * cond = condHolder.data();
+                double * val = valHolder.data();
+                double * sel = selHolder.data();
+
+                if (simple)
+                    selector(rows, stride, n, sel);
+
+                if (elseKernel)
+                    elseKernel(rows, stride, n, out);
+                else std::fill(out, out + n, NaN);
+
+                // Blend the WHEN clauses in reverse so that an earlier
+                // clause overwrites a later one: first match wins, as
+                // in the lazy evaluation order.
+                for (auto it = whens.rbegin();  it != whens.rend();  ++it) {
+                    it->first(rows, stride, n, cond);
+                    it->second(rows, stride, n, val);
+                    if (simple) {
+                        // Null selectors and null WHEN values match
+                        // nothing, exactly as = would return
+                        for (size_t r = 0;  r < n;  ++r) {
+                            bool match = !std::isnan(sel[r])
+                                && !std::isnan(cond[r])
+                                && sel[r] == cond[r];
+                            out[r] = match ? val[r] : out[r];
+                        }
+                    }
+                    else {
+                        for (size_t r = 0;  r < n;  ++r) {
+                            bool match = !std::isnan(cond[r])
+                                && cond[r] != 0.0;
+                            out[r] = match ? val[r] : out[r];
+                        }
+                    }
+                }
+            };
+    }
+
+    return nullptr;
+}
+
+} // file scope
+
+ColumnScope::BatchKernel
+ColumnScope::
+tryCompileBatch(const BoundSqlExpression & expr) const
+{
+    if (!expr.expr)
+        return nullptr;
+    size_t cost = 0;
+    return compileBatchNode(expr.expr.get(), requiredColumnIndexes, cost);
+}
+
 /// Allow control over whether the given optimization path is run
 /// so that we can test both with and without optimization.
 static const OptimizedPath optimizeRunIncremental
@@ -244,9 +556,25 @@ runIncrementalT(const std::vector<BoundSqlExpression> & exprs,
         auto chunks = rowGen.rowStream->parallelize(numRows,
                                                     RowStream::AUTO,
                                                     &chunkOffsets);
-            
+
         static constexpr size_t ROWS_AT_ONCE = 1000;
 
+        // For double extraction, complex expressions may compile into
+        // batch kernels that evaluate a whole block at once rather than
+        // going through the per-row ExpressionValue machinery.  The
+        // kernels only capture immutable state, so they can be shared
+        // across the worker threads.
+        std::vector<BatchKernel> kernels(exprs.size());
+        bool anyKernels = false;
+        if constexpr (std::is_same_v<Val, double>) {
+            for (size_t j = 0;  j < exprs.size();  ++j) {
+                if (columnNumbers[j] == -1) {
+                    kernels[j] = tryCompileBatch(exprs[j]);
+                    anyKernels = anyKernels || !!kernels[j];
+                }
+            }
+        }
+
         auto onChunk = [&] (size_t chunkNum)
             {
                 PossiblyDynamicBuffer<Val> valuesHolder(
@@ -257,12 +585,16 @@ runIncrementalT(const std::vector<BoundSqlExpression> & exprs,
 
                 ssize_t startOffset = chunkOffsets[chunkNum];
                 ssize_t endOffset = chunkOffsets[chunkNum + 1];
-                    
+
                 size_t numRows = endOffset - startOffset;
 
                 PossiblyDynamicBuffer<Val> resultsHolder(exprs.size());
                 Val * results = resultsHolder.data();
 
+                PossiblyDynamicBuffer<double> batchHolder
+                    (anyKernels ? exprs.size() * ROWS_AT_ONCE : 1);
+                double * batchOut = batchHolder.data();
+
                 for (size_t i = 0;  i < numRows;  i += ROWS_AT_ONCE) {
                     size_t startRow = i + startOffset;
                     size_t endRow
@@ -272,6 +604,15 @@ runIncrementalT(const std::vector<BoundSqlExpression> & exprs,
 
                     extractVals(blockRows, requiredColumns, values, stream);
 
+                    if constexpr (std::is_same_v<Val, double>) {
+                        for (size_t j = 0;  j < exprs.size();  ++j) {
+                            if (kernels[j]) {
+                                kernels[j](values, nc, blockRows,
+                                           batchOut + j * ROWS_AT_ONCE);
+                            }
+                        }
+                    }
+
                     for (size_t r = 0;  r < blockRows;  ++r) {
 
                         RowScope scope(values + nc * r);
@@ -282,6 +623,10 @@ runIncrementalT(const std::vector<BoundSqlExpression> & exprs,
                                 results[j]
                                     = extractVal(std::move(val), (Val *)0);
                             }
+                            else if (anyKernels && kernels[j]) {
+                                if constexpr (std::is_same_v<Val, double>)
+                                    results[j] = batchOut[j * ROWS_AT_ONCE + r];
+                            }
                             else {
                                 ExpressionValue storage;
                                 const ExpressionValue & result
@@ -296,12 +641,12 @@ runIncrementalT(const std::vector<BoundSqlExpression> & exprs,
                                 }
                             }
                         }
-                        
+
                         if (!onVal(startRow + r, results))
                             return false;
                     }
                 }
-                    
+
                 return true;
             };
 
@@ -161,6 +161,29 @@ struct ColumnScope: public SqlExpressionMldbScope {
                         std::function<bool (size_t rowNum,
                                             float * vals)> onVal) const;
 
+    /** Compiled batch kernel for a numeric expression.  Takes a
+        row-major block of extracted column values (stride values per
+        row, in requiredColumns order) and writes one double per row
+        into out.
+    */
+    typedef std::function<void (const double * rows, size_t stride,
+                                size_t numRows, double * out)> BatchKernel;
+
+    /** Attempt to compile the given bound expression into a batch
+        kernel that evaluates a whole block of rows in a tight loop,
+        without per-row ExpressionValue construction or virtual
+        dispatch.  Handles column reads, numeric constants, the
+        arithmetic, comparison and boolean operators over them, and
+        CASE expressions, with nulls represented as NaN.  Conditionals
+        evaluate all of their arms and blend by mask rather than
+        branching per row, so cheap CASE-dense scoring expressions
+        avoid branch mispredicts; a CASE whose arms exceed a cost
+        budget is left uncompiled instead.  Returns a null function if
+        the expression falls outside that subset, in which case the
+        caller should use the row-at-a-time path.
+    */
+    BatchKernel tryCompileBatch(const BoundSqlExpression & expr) const;
+
 private:
     template<typename Val>
     bool
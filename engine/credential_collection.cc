@@ -218,6 +218,16 @@ createCredentialCollection(MLDB::MldbEngine * engine, RestRouteManager & routeMa
 
     CredentialProvider::
         registerProvider(std::make_shared<CollectionCredentialProvider>(result));
+
+    // Cached resolutions must not outlive changes to the rule set
+    result->changeWatch
+        = result->watchElements("*", false /* catchUp */, nullptr);
+    result->changeWatch.bind([] (const CredentialRuleCollection::ChildEvent &)
+                             {
+                                 invalidateCredentialCache();
+                             },
+                             IGNORE_ERRORS);
+
     return result;
 }
 
@@ -76,6 +76,11 @@ struct CredentialRuleCollection
 
     virtual std::shared_ptr<CredentialRuleConfig>
     getConfig(std::string key, const CredentialRule & value) const;
+
+    /** Watch on our own elements, used to invalidate the credential
+        cache whenever a rule is added or removed.
+    */
+    WatchT<ChildEvent> changeWatch;
 };
 
 extern template class RestCollection<std::string, MLDB::CredentialRule>;
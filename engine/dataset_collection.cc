@@ -13,6 +13,7 @@
 #include "mldb/rest/rest_request_binding.h"
 #include "mldb/utils/lightweight_hash.h"
 #include "mldb/sql/sql_expression.h"
+#include "mldb/types/json_printing.h"
 #include "mldb/types/map_description.h"
 #include "mldb/types/vector_description.h"
 #include "mldb/types/pair_description.h"
@@ -67,8 +68,39 @@ void runHttpQuery(std::function<std::vector<MatrixNamedRow> ()> runQuery,
     }
 
     if (format == "full" || format == "") {
-        connection.sendResponse(200, jsonEncodeUtf8(sparseOutput),
-                                "application/json");
+        // Stream the rows back with chunked transfer encoding rather than
+        // materializing the whole JSON document: for a large export the
+        // encoded response is bigger than the result set itself, and the
+        // first byte would otherwise wait on the full encode.
+        connection.sendHttpResponseHeader(200, "application/json",
+                                          RestConnection::CHUNKED_ENCODING);
+
+        static auto rowDesc = getDefaultDescriptionSharedT<MatrixNamedRow>();
+
+        // Rows are serialized into a buffer that is flushed to the
+        // connection whenever it fills up
+        constexpr size_t FLUSH_THRESHOLD = 1024 * 1024;
+        std::string buffer;
+        StringJsonPrintingContext context(buffer);
+
+        buffer += '[';
+        for (size_t i = 0;  i < sparseOutput.size();  ++i) {
+            if (i != 0)
+                buffer += ',';
+            rowDesc->printJsonTyped(&sparseOutput[i], context);
+
+            // Release each row once encoded, so that peak memory stays
+            // bounded by the result set rather than a multiple of it
+            sparseOutput[i] = MatrixNamedRow();
+
+            if (buffer.size() >= FLUSH_THRESHOLD) {
+                connection.sendPayload(Utf8String(std::move(buffer)));
+                buffer.clear();
+            }
+        }
+        buffer += ']';
+        connection.sendPayload(Utf8String(std::move(buffer)));
+        connection.finishResponse();
     }
     else if (format == "sparse") {
         std::vector<std::vector<std::pair<ColumnPath, CellValue> > > output;
@@ -235,6 +267,158 @@ void runHttpQuery(std::function<std::vector<MatrixNamedRow> ()> runQuery,
         connection.sendResponse(200, jsonEncodeUtf8(output),
                                 "application/json");
     }
+    else if (format == "binary") {
+        // Column-oriented binary frame with typed buffers, for clients
+        // that read query results straight into numeric arrays instead
+        // of parsing JSON.  Layout (all integers little-endian):
+        //
+        //   magic "MLDBCOL1", uint32 ncols, uint64 nrows
+        //   per column:
+        //     uint32 nameLen, name bytes (UTF-8)
+        //     uint8 type: 0 = float64, 1 = int64, 2 = utf8
+        //     presence bitmap, (nrows+7)/8 bytes, bit set = non-null
+        //     float64/int64: nrows * 8 byte values (nulls zero-filled)
+        //     utf8: (nrows+1) uint64 offsets, then string bytes
+        //
+        // Latest value per cell, as for the table format.
+
+        size_t nrows = sparseOutput.size();
+
+        // Find all columns, in order of first appearance
+        std::vector<ColumnPath> columns;
+        LightweightHash<ColumnHash, int> columnIndex;
+        for (auto & o: sparseOutput) {
+            for (auto & c: o.columns) {
+                auto & columnName = std::get<0>(c);
+                if (columnIndex.insert({columnName, columns.size()}).second) {
+                    columns.push_back(columnName);
+                }
+            }
+        }
+
+        if (sortColumns) {
+            std::sort(columns.begin(), columns.end());
+            for (size_t i = 0;  i < columns.size();  ++i) {
+                columnIndex[columns[i]] = i;
+            }
+        }
+
+        // Pivot the sparse rows into per-column cell vectors
+        std::vector<std::vector<CellValue> > cells(columns.size());
+        for (auto & col: cells)
+            col.resize(nrows);
+
+        for (size_t i = 0;  i < nrows;  ++i) {
+            for (auto & c: sparseOutput[i].columns) {
+                cells[columnIndex[std::get<0>(c)]][i] = std::get<1>(c);
+            }
+            sparseOutput[i].columns.clear();
+        }
+
+        std::string buffer;
+
+        auto append = [&] (const void * data, size_t len)
+            {
+                buffer.append(reinterpret_cast<const char *>(data), len);
+            };
+        auto appendU32 = [&] (uint32_t v) { append(&v, sizeof(v)); };
+        auto appendU64 = [&] (uint64_t v) { append(&v, sizeof(v)); };
+
+        auto encodeColumn = [&] (const Utf8String & name,
+                                 const std::vector<CellValue> & vals)
+            {
+                appendU32(name.rawLength());
+                append(name.rawData(), name.rawLength());
+
+                // Pick the narrowest type that holds every value
+                bool hasFloat = false, hasOther = false;
+                for (auto & v: vals) {
+                    if (v.empty() || v.isInteger())
+                        continue;
+                    else if (v.isNumber())
+                        hasFloat = true;
+                    else hasOther = true;
+                }
+
+                uint8_t type = hasOther ? 2 : hasFloat ? 0 : 1;
+                append(&type, 1);
+
+                std::vector<uint8_t> present((nrows + 7) / 8, 0);
+                for (size_t i = 0;  i < nrows;  ++i) {
+                    if (!vals[i].empty())
+                        present[i / 8] |= 1 << (i % 8);
+                }
+                append(present.data(), present.size());
+
+                if (type == 0) {
+                    for (auto & v: vals) {
+                        double d = v.empty() ? 0.0 : v.toDouble();
+                        append(&d, sizeof(d));
+                    }
+                }
+                else if (type == 1) {
+                    for (auto & v: vals) {
+                        int64_t n = v.empty() ? 0 : v.toInt();
+                        append(&n, sizeof(n));
+                    }
+                }
+                else {
+                    std::vector<Utf8String> strs;
+                    strs.reserve(nrows);
+                    uint64_t offset = 0;
+                    for (auto & v: vals) {
+                        if (v.empty())
+                            strs.emplace_back();
+                        else if (v.isString())
+                            strs.emplace_back(v.toUtf8String());
+                        else strs.emplace_back(v.coerceToString()
+                                               .toUtf8String());
+                        appendU64(offset);
+                        offset += strs.back().rawLength();
+                    }
+                    appendU64(offset);
+                    for (auto & s: strs)
+                        append(s.rawData(), s.rawLength());
+                }
+            };
+
+        connection.sendHttpResponseHeader(200, "application/octet-stream",
+                                          RestConnection::CHUNKED_ENCODING);
+
+        append("MLDBCOL1", 8);
+        appendU32(columns.size() + rowNames + rowHashes);
+        appendU64(nrows);
+
+        if (rowNames) {
+            std::vector<CellValue> names(nrows);
+            for (size_t i = 0;  i < nrows;  ++i)
+                names[i] = sparseOutput[i].rowName.toUtf8String();
+            encodeColumn(Utf8String("_rowName"), names);
+        }
+        if (rowHashes) {
+            std::vector<CellValue> hashes(nrows);
+            for (size_t i = 0;  i < nrows;  ++i)
+                hashes[i] = sparseOutput[i].rowHash.toString();
+            encodeColumn(Utf8String("_rowHash"), hashes);
+        }
+
+        for (size_t c = 0;  c < columns.size();  ++c) {
+            encodeColumn(columns[c].toUtf8String(), cells[c]);
+            cells[c] = {};
+
+            // Flush column by column so large exports stream
+            if (buffer.size() >= 1024 * 1024) {
+                connection.sendPayload(Utf8String(std::move(buffer),
+                                                  false /* check */));
+                buffer.clear();
+            }
+        }
+
+        if (!buffer.empty())
+            connection.sendPayload(Utf8String(std::move(buffer),
+                                              false /* check */));
+        connection.finishResponse();
+    }
     else if (format == "atom") {
         if (sparseOutput.size() > 1) {
             connection.sendJsonErrorResponse(400, "Query with atom format returning multiple rows. Consider using limit.");
@@ -15,6 +15,7 @@
 #include "mldb/core/dataset_scope.h"
 #include "mldb/types/map_description.h"
 #include "mldb/types/vector_description.h"
+#include "mldb/base/parallel.h"
 
 
 using namespace std;
@@ -58,8 +59,26 @@ ExpressionValue
 Function::
 call(const ExpressionValue & input) const
 {
+    if (canReuseApplier()) {
+        // Steady-state serving path: the binding doesn't depend upon
+        // the input, so bind once against our declared input on the
+        // first call and reuse the applier for every call afterwards.
+        std::shared_ptr<const FunctionApplier> applier;
+        {
+            std::unique_lock<std::mutex> guard(cachedApplierLock);
+            if (!cachedApplier) {
+                auto scope = std::make_shared<SqlExpressionMldbScope>
+                    (MldbEntity::getOwner(this->engine));
+                cachedApplier = this->bind(*scope, getFunctionInfo().input);
+                cachedApplierScope = std::move(scope);
+            }
+            applier = cachedApplier;
+        }
+        return applier->apply(input);
+    }
+
     SqlExpressionMldbScope outerContext(MldbEntity::getOwner(this->engine));
-    
+
     auto info = this->getFunctionInfo();
 
 #if 0
@@ -111,7 +130,7 @@ call(const ExpressionValue & input) const
     //cerr << "inputContext = " << jsonEncode(inputContext) << endl;
 
     auto applier = this->bind(outerContext, info.input);
-    
+
     return applier->apply(input);
 }
 
@@ -239,13 +258,32 @@ applyBatch(const Function * function,
         return;
     }
     else if (inputs.isArray()) {
-        printingContext.startArray(inputs.size());
-        for (auto it = inputs.begin(), end = inputs.end();
-             it != end;  ++it) {
-            printingContext.newArrayElement();
-            doInput(*it);
+        // Evaluate the batch in parallel over the one binding, with
+        // each element rendered to its own buffer so that the output
+        // order matches the input order.  Appliers are required to
+        // support concurrent apply; queries already use them that way.
+        std::vector<Utf8String> results(inputs.size());
+
+        auto doElement = [&] (size_t i)
+            {
+                Utf8StringJsonPrintingContext elementContext(results[i]);
+                StructuredJsonParsingContext context(inputs[(int)i]);
+                ExpressionValue inputExpr
+                    = ExpressionValue::parseJson(context, ts);
+                ExpressionValue output
+                    = function->apply(*applier, std::move(inputExpr));
+                output.extractJson(elementContext);
+            };
+
+        parallelMap(0, inputs.size(), doElement);
+
+        str += "[";
+        for (size_t i = 0;  i < results.size();  ++i) {
+            if (i != 0)
+                str += ",";
+            str += results[i];
         }
-        printingContext.endArray();
+        str += "]";
     }
     else if (inputs.isObject()) {
         printingContext.startObject();
@@ -317,7 +355,7 @@ initRoutes(RouteManager & manager)
         "like dates into the call. This is the default and currently the only "
         "value accepted.";
     
-    addRouteAsync(*manager.valueNode, "/batch", { "GET" },
+    addRouteAsync(*manager.valueNode, "/batch", { "GET", "POST" },
                   "Apply a function to each element of a given set of input values and return the output",
                   //"Output of all values or those selected in the keepValues parameter",
                   &FunctionCollection::applyBatch,
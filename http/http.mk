@@ -5,6 +5,7 @@ LIBHTTP_SOURCES := \
 	http_header.cc \
 	http_parsers.cc \
 	http_rest_proxy.cc \
+	http_replica_pool.cc \
 	curl_wrapper.cc \
 	http_client.cc \
 	http_client_callbacks.cc \
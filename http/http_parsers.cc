@@ -322,30 +322,43 @@ handleHeader(const char * data, size_t dataSize)
         skipChar(' ');
     };
 
-    if (matchString("Connection", 10)) {
-        skipToValue();
-        if (matchString("close", 5)) {
-            requireClose_ = true;
+    /* Dispatch on the first byte of the header name so that the headers
+       we don't care about cost a single comparison rather than a cascade
+       of strncasecmp calls */
+    switch (dataSize > 0 ? (data[0] | 0x20) : 0) {
+    case 'c':
+        if (matchString("Connection", 10)) {
+            skipToValue();
+            if (matchString("close", 5)) {
+                requireClose_ = true;
+            }
         }
-    }
-    else if (matchString("Content-Length", 14)) {
-        skipToValue();
-        remainingBody_ = antoi(data + ptr, data + dataSize - 2);
-    }
-    else if (matchString("Transfer-Encoding", 15)) {
-        skipToValue();
-        if (matchString("chunked", 7)) {
-            useChunkedEncoding_ = true;
+        else if (matchString("Content-Length", 14)) {
+            skipToValue();
+            remainingBody_ = antoi(data + ptr, data + dataSize - 2);
         }
-    }
-    else if (matchString("Expect", 6)) {
-        skipToValue();
-        if (matchString("100-continue", 12)) {
-            if (onExpect100Continue) {
-                expect100Continue_ = true;
-                skipHeader = true;
+        break;
+    case 't':
+        if (matchString("Transfer-Encoding", 17)) {
+            skipToValue();
+            if (matchString("chunked", 7)) {
+                useChunkedEncoding_ = true;
+            }
+        }
+        break;
+    case 'e':
+        if (matchString("Expect", 6)) {
+            skipToValue();
+            if (matchString("100-continue", 12)) {
+                if (onExpect100Continue) {
+                    expect100Continue_ = true;
+                    skipHeader = true;
+                }
             }
         }
+        break;
+    default:
+        break;
     }
 
     if (!skipHeader) {
@@ -452,17 +465,17 @@ bool
 HttpParser::BufferState::
 skip_to_char(char c, bool throwOnEol)
 {
-    while (!eof()) {
-        if (operator *() == c) {
-            return true;
-        }
-        else if (throwOnEol && match_eol(false)) {
-            throw MLDB::Exception("unexpected end of line");
-        }
-        operator ++();
+    /* Both paths scan a whole buffer at a time (memchr underneath)
+       rather than byte by byte */
+    if (!throwOnEol) {
+        return ParseContext::skip_to_char(c);
     }
 
-    return false;
+    char found = skip_to_either(c, '\n');
+    if (found == '\n') {
+        throw MLDB::Exception("unexpected end of line");
+    }
+    return found == c;
 }
 
 
@@ -0,0 +1,309 @@
+/** http_replica_pool.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Load-balanced HTTP access to a replicated service.
+*/
+
+#include "http_replica_pool.h"
+#include "mldb/arch/exception.h"
+#include "mldb/base/exc_assert.h"
+#include "mldb/types/date.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+
+using namespace std;
+
+
+namespace MLDB {
+
+/*****************************************************************************/
+/* HTTP REPLICA POOL                                                         */
+/*****************************************************************************/
+
+struct HttpReplicaPool::Itl {
+
+    struct Replica {
+        std::string baseUri;
+        std::shared_ptr<HttpRestProxy> proxy;
+        std::string resourcePrefix;
+
+        // All protected by the pool mutex
+        double ewmaMs = 0.0;
+        bool hasEwma = false;
+        Date downUntil = Date::negativeInfinity();
+        uint64_t requests = 0;
+        uint64_t failures = 0;
+        uint64_t hedges = 0;
+    };
+
+    std::vector<Replica> replicas;
+    double hedgeDelayMs;
+    double cooldownSeconds;
+
+    mutable std::mutex mutex;
+    mutable std::mt19937 rng{std::random_device{}()};
+
+    Itl(std::vector<std::string> baseUris,
+        double hedgeDelayMs,
+        double cooldownSeconds)
+        : hedgeDelayMs(hedgeDelayMs),
+          cooldownSeconds(cooldownSeconds)
+    {
+        if (baseUris.empty())
+            throw MLDB::Exception("HttpReplicaPool needs at least one replica");
+        for (auto & uri: baseUris) {
+            Replica replica;
+            replica.baseUri = uri;
+            std::tie(replica.proxy, replica.resourcePrefix)
+                = HttpRestProxy::sharedProxyForUri(uri);
+            replicas.emplace_back(std::move(replica));
+        }
+    }
+
+    /** Power of two choices over the healthy replicas: draw two at
+        random and take the one with the lower latency average.  A
+        replica with no average yet wins the draw, so a replica coming
+        out of cooldown gets probed.  With every replica down, the whole
+        pool is considered again rather than refusing to try.
+    */
+    ssize_t pick(const std::set<size_t> & exclude) const
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+
+        Date now = Date::now();
+        std::vector<size_t> candidates, unhealthy;
+        for (size_t i = 0;  i < replicas.size();  ++i) {
+            if (exclude.count(i))
+                continue;
+            if (now < replicas[i].downUntil)
+                unhealthy.push_back(i);
+            else
+                candidates.push_back(i);
+        }
+        if (candidates.empty())
+            candidates = std::move(unhealthy);
+        if (candidates.empty())
+            return -1;
+        if (candidates.size() == 1)
+            return candidates[0];
+
+        std::uniform_int_distribution<size_t> dist(0, candidates.size() - 1);
+        size_t a = dist(rng), b = dist(rng);
+        while (b == a)
+            b = dist(rng);
+
+        auto better = [&] (size_t x, size_t y)
+            {
+                if (!replicas[x].hasEwma)
+                    return true;
+                if (!replicas[y].hasEwma)
+                    return false;
+                return replicas[x].ewmaMs <= replicas[y].ewmaMs;
+            };
+        return better(candidates[a], candidates[b])
+            ? candidates[a] : candidates[b];
+    }
+
+    /** Run the request on one replica, recording latency and health.
+        Returns whether the response is an answer to give the caller:
+        transport errors and 5xx are replica failures to fail over.
+    */
+    bool performOne(size_t i,
+                    const std::string & resource,
+                    const RestParams & queryParams,
+                    const RestParams & headers,
+                    double timeoutSeconds,
+                    HttpRestProxy::Response & response)
+    {
+        Replica & replica = replicas[i];
+
+        Date start = Date::now();
+        response = replica.proxy->get(replica.resourcePrefix + resource,
+                                      queryParams, headers, timeoutSeconds,
+                                      false /* exceptions */);
+        double latencyMs = Date::now().secondsSince(start) * 1000.0;
+
+        bool answer = response.errorCode() == 0 && response.code() < 500;
+
+        std::unique_lock<std::mutex> guard(mutex);
+        ++replica.requests;
+        if (answer) {
+            constexpr double alpha = 0.2;
+            replica.ewmaMs = replica.hasEwma
+                ? alpha * latencyMs + (1.0 - alpha) * replica.ewmaMs
+                : latencyMs;
+            replica.hasEwma = true;
+        }
+        else {
+            ++replica.failures;
+            replica.downUntil = Date::now().plusSeconds(cooldownSeconds);
+        }
+        return answer;
+    }
+
+    /** First attempt with a hedge: send to the primary, and if it
+        hasn't answered within the hedge delay, send the same request to
+        a second replica and take whichever answers first.  The losing
+        request finishes on its own thread and still updates the stats.
+    */
+    static bool hedgedAttempt(std::shared_ptr<Itl> self,
+                              size_t primary,
+                              std::set<size_t> & tried,
+                              const std::string & resource,
+                              const RestParams & queryParams,
+                              const RestParams & headers,
+                              double timeoutSeconds,
+                              HttpRestProxy::Response & response)
+    {
+        struct Attempt {
+            std::mutex mutex;
+            std::condition_variable cv;
+            int launched = 0;
+            int done = 0;
+            bool haveAnswer = false;
+            HttpRestProxy::Response answer;
+        };
+        auto attempt = std::make_shared<Attempt>();
+
+        auto launch = [&] (size_t replica)
+            {
+                ++attempt->launched;
+                std::thread([self, attempt, replica, resource,
+                             queryParams, headers, timeoutSeconds] ()
+                    {
+                        HttpRestProxy::Response r;
+                        bool ok = self->performOne(replica, resource,
+                                                   queryParams, headers,
+                                                   timeoutSeconds, r);
+                        std::unique_lock<std::mutex> guard(attempt->mutex);
+                        ++attempt->done;
+                        if (ok && !attempt->haveAnswer) {
+                            attempt->haveAnswer = true;
+                            attempt->answer = std::move(r);
+                        }
+                        attempt->cv.notify_all();
+                    }).detach();
+            };
+
+        std::unique_lock<std::mutex> guard(attempt->mutex);
+        tried.insert(primary);
+        launch(primary);
+
+        attempt->cv.wait_for
+            (guard,
+             std::chrono::microseconds((int64_t)(self->hedgeDelayMs * 1000)),
+             [&] { return attempt->done == attempt->launched; });
+
+        if (!attempt->haveAnswer && attempt->done < attempt->launched) {
+            guard.unlock();
+            ssize_t secondary = self->pick(tried);
+            guard.lock();
+            if (secondary != -1) {
+                {
+                    std::unique_lock<std::mutex> statsGuard(self->mutex);
+                    ++self->replicas[secondary].hedges;
+                }
+                tried.insert(secondary);
+                launch(secondary);
+            }
+        }
+
+        attempt->cv.wait(guard, [&] {
+                return attempt->haveAnswer
+                    || attempt->done == attempt->launched;
+            });
+
+        if (!attempt->haveAnswer)
+            return false;
+        response = std::move(attempt->answer);
+        return true;
+    }
+
+    static HttpRestProxy::Response
+    get(std::shared_ptr<Itl> self,
+        const std::string & resource,
+        const RestParams & queryParams,
+        const RestParams & headers,
+        double timeoutSeconds)
+    {
+        std::set<size_t> tried;
+        HttpRestProxy::Response response;
+
+        ssize_t primary = self->pick(tried);
+        ExcAssert(primary != -1);
+
+        bool ok = self->hedgeDelayMs > 0 && self->replicas.size() > 1
+            ? hedgedAttempt(self, primary, tried, resource, queryParams,
+                            headers, timeoutSeconds, response)
+            : (tried.insert(primary),
+               self->performOne(primary, resource, queryParams, headers,
+                                timeoutSeconds, response));
+
+        // Fail over to the replicas not tried yet
+        while (!ok) {
+            ssize_t next = self->pick(tried);
+            if (next == -1)
+                throw MLDB::Exception
+                    ("All %zd replicas failed for GET %s; last error: %s",
+                     self->replicas.size(), resource.c_str(),
+                     response.errorCode() != 0
+                         ? response.errorMessage().c_str()
+                         : response.body().c_str());
+            tried.insert(next);
+            ok = self->performOne(next, resource, queryParams, headers,
+                                  timeoutSeconds, response);
+        }
+
+        return response;
+    }
+};
+
+HttpReplicaPool::
+HttpReplicaPool(std::vector<std::string> baseUris,
+                double hedgeDelayMs,
+                double cooldownSeconds)
+    : itl(new Itl(std::move(baseUris), hedgeDelayMs, cooldownSeconds))
+{
+}
+
+HttpReplicaPool::
+~HttpReplicaPool()
+{
+}
+
+HttpRestProxy::Response
+HttpReplicaPool::
+get(const std::string & resource,
+    const RestParams & queryParams,
+    const RestParams & headers,
+    double timeoutSeconds) const
+{
+    return Itl::get(itl, resource, queryParams, headers, timeoutSeconds);
+}
+
+std::vector<HttpReplicaPool::ReplicaStats>
+HttpReplicaPool::
+getStats() const
+{
+    std::vector<ReplicaStats> result;
+    std::unique_lock<std::mutex> guard(itl->mutex);
+    for (auto & replica: itl->replicas) {
+        ReplicaStats stats;
+        stats.baseUri = replica.baseUri;
+        stats.healthy = !(Date::now() < replica.downUntil);
+        stats.ewmaLatencyMs = replica.ewmaMs;
+        stats.requests = replica.requests;
+        stats.failures = replica.failures;
+        stats.hedges = replica.hedges;
+        result.emplace_back(std::move(stats));
+    }
+    return result;
+}
+
+} // namespace MLDB
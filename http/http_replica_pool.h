@@ -0,0 +1,89 @@
+/** http_replica_pool.h                                            -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Load-balanced HTTP access to a replicated service.
+*/
+
+#pragma once
+
+#include "mldb/http/http_rest_proxy.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace MLDB {
+
+
+/*****************************************************************************/
+/* HTTP REPLICA POOL                                                         */
+/*****************************************************************************/
+
+/** Spreads read requests over the replicas of a service so that one slow
+    or dead replica doesn't define the caller's latency.
+
+    - Replica choice is power-of-two-choices on an exponentially weighted
+      moving average of observed latency: two healthy replicas are drawn
+      at random and the one that has been answering faster gets the
+      request, so load drains away from a degrading replica without any
+      coordination.
+    - Health is tracked passively: a transport error or 5xx marks the
+      replica down for a cooldown period, after which the next request
+      probes it again.  There is no background pinger.
+    - get() optionally hedges: if the chosen replica hasn't answered
+      within the hedge delay, the same request is sent to a second
+      replica and the first response wins.  Only use hedging for
+      idempotent requests.
+
+    Connections are reused through the process-wide shared proxy pool
+    (HttpRestProxy::sharedProxyForUri), so replicas talked to by several
+    callers share their keep-alive connections.
+*/
+struct HttpReplicaPool {
+
+    /** Per-replica counters, for the admin surface. */
+    struct ReplicaStats {
+        std::string baseUri;
+        bool healthy = true;
+        double ewmaLatencyMs = 0.0;
+        uint64_t requests = 0;
+        uint64_t failures = 0;
+        uint64_t hedges = 0;        ///< requests sent as the hedge copy
+    };
+
+    /** baseUris give the scheme://host[:port] of each replica.  The
+        hedge delay is in milliseconds; zero or negative disables
+        hedging.  The cooldown is how long a failed replica sits out
+        before being probed again.
+    */
+    HttpReplicaPool(std::vector<std::string> baseUris,
+                    double hedgeDelayMs = 50.0,
+                    double cooldownSeconds = 5.0);
+
+    ~HttpReplicaPool();
+
+    /** Perform a GET against one replica, hedging to a second one if
+        the first is slow.  The resource is the path part of the URI,
+        shared by all replicas.  A 4xx from a replica is an answer and
+        is returned as-is; transport errors and 5xx count as replica
+        failures and fail over to the remaining replicas.  Throws when
+        every replica fails.
+    */
+    HttpRestProxy::Response
+    get(const std::string & resource,
+        const RestParams & queryParams = RestParams(),
+        const RestParams & headers = RestParams(),
+        double timeoutSeconds = -1) const;
+
+    /** Snapshot of every replica's health and latency. */
+    std::vector<ReplicaStats> getStats() const;
+
+private:
+    // Shared with in-flight hedge threads, which may outlive the pool
+    struct Itl;
+    std::shared_ptr<Itl> itl;
+};
+
+} // namespace MLDB
@@ -10,6 +10,7 @@
 #include <curl/curl.h>
 #include "mldb/arch/threads.h"
 #include <chrono>
+#include <map>
 #include <thread>
 #include "mldb/types/structure_description.h"
 #include "curl_wrapper.h"
@@ -158,6 +159,21 @@ urlEncode(const Utf8String & str)
 /* HTTP REST PROXY                                                           */
 /*****************************************************************************/
 
+/** Maximum number of idle keep-alive connections retained per proxy.
+    Kept deliberately small: each one pins a curl handle and possibly an
+    open TLS session on the server side.
+*/
+static size_t maxIdleConnections()
+{
+    static const size_t result = [] () -> size_t {
+        char * value = ::getenv("HTTP_MAX_IDLE_CONNECTIONS_PER_HOST");
+        if (value)
+            return std::max(1, atoi(value));
+        return 8;
+    } ();
+    return result;
+}
+
 struct HttpRestProxy::Itl {
     Itl(std::string serviceUri, HttpRestProxy * owner)
         : serviceUri(std::move(serviceUri)), noSSLChecks(false), debug(false),
@@ -210,6 +226,14 @@ struct HttpRestProxy::Itl {
     void doneConnection(ConnectionHandler * conn)
     {
         std::unique_lock<std::mutex> guard(lock);
+
+        // Bound the number of idle handles we keep alive
+        if (inactive.size() >= maxIdleConnections()) {
+            guard.unlock();
+            delete conn;
+            return;
+        }
+
         conn->reset();
 
         // Put a Connection with a null handler on the list so it's
@@ -482,6 +506,33 @@ doneConnection(ConnectionHandler * conn)
     itl->doneConnection(conn);
 }
 
+std::pair<std::shared_ptr<HttpRestProxy>, std::string>
+HttpRestProxy::
+sharedProxyForUri(const std::string & uri)
+{
+    // Split the URI into its host root (scheme://host[:port]) and its
+    // resource, which is what the perform() methods expect
+    string::size_type schemeEnd = uri.find("://");
+    if (schemeEnd == string::npos)
+        throw MLDB::Exception("can't get a shared proxy for relative URI '"
+                              + uri + "'");
+    string::size_type resourceStart = uri.find('/', schemeEnd + 3);
+
+    string hostRoot
+        = resourceStart == string::npos ? uri : uri.substr(0, resourceStart);
+    string resource
+        = resourceStart == string::npos ? "" : uri.substr(resourceStart);
+
+    static std::mutex registryLock;
+    static std::map<std::string, std::shared_ptr<HttpRestProxy> > registry;
+
+    std::unique_lock<std::mutex> guard(registryLock);
+    auto & proxy = registry[hostRoot];
+    if (!proxy)
+        proxy = std::make_shared<HttpRestProxy>(hostRoot);
+    return { proxy, std::move(resource) };
+}
+
 std::ostream &
 operator << (std::ostream & stream, const HttpRestProxy::Response & response)
 {
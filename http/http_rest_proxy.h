@@ -7,8 +7,10 @@
 
 #pragma once
 
+#include <memory>
 #include <mutex>
 #include <functional>
+#include <utility>
 #include "mldb/http/http_header.h"
 
 namespace Json {
@@ -221,7 +223,27 @@ struct HttpRestProxy {
                      OnHeader onHeader = nullptr,
                      bool followRedirect = false,
                      bool abortOnSlowConnection = false) const;
-    
+
+    /** Return a process-wide shared proxy for the host of the given URI,
+        along with the resource part of the URI to pass to the perform()
+        methods.  Proxies are keyed on their host root
+        (scheme://host[:port]) and live for the lifetime of the process,
+        so keep-alive connections are reused across callers hitting the
+        same host instead of paying the TCP and TLS setup cost on every
+        request.
+
+        The number of idle connections kept alive per host is bounded; it
+        defaults to 8 and can be changed via the
+        HTTP_MAX_IDLE_CONNECTIONS_PER_HOST environment variable.
+
+        Shared proxies are used concurrently by unrelated callers, so
+        per-proxy state like cookies must not be modified on them; callers
+        that need cookies should construct a private HttpRestProxy
+        instead.
+    */
+    static std::pair<std::shared_ptr<HttpRestProxy>, std::string>
+    sharedProxyForUri(const std::string & uri);
+
 public:
     /** Get a connection. */
     struct Connection;
@@ -11,6 +11,8 @@
 #include <poll.h>
 #include <unistd.h>
 #include <errno.h>
+#include <sys/uio.h>
+#include <cstring>
 #include <iostream>
 
 #include "mldb/base/exc_assert.h"
@@ -30,6 +32,12 @@ inline bool isFileFlagSet(int fd, int flag)
     return ((oldFlags & flag) == flag);
 }
 
+/* maximum number of message spans gathered into a single writev call */
+constexpr size_t maxWriteIovecs(64);
+
+/* maximum number of recycled slabs kept around per instance */
+constexpr size_t maxFreeSlabs(16);
+
 } // file scope
 
 
@@ -103,21 +111,77 @@ closeFd()
 bool
 AsyncWriterSource::
 write(string data, const OnWriteResult & onWriteResult)
+{
+    return write(data.c_str(), data.size(), onWriteResult);
+}
+
+bool
+AsyncWriterSource::
+write(const char * data, size_t size, const OnWriteResult & onWriteResult)
 {
     ExcAssert(!closing_);
     ExcAssert(queueEnabled_);
 
-    bool result(true);
-
-    if (queueEnabled()) {
-        ExcCheck(data.size() > 0, "attempting to write empty data");
-        result = queue_.push_back(AsyncWrite(move(data), onWriteResult));
-    }
-    else {
+    if (!queueEnabled()) {
         throw MLDB::Exception("cannot write while queue is disabled");
     }
+    ExcCheck(size > 0, "attempting to write empty data");
+
+    AsyncWrite span;
+    {
+        std::unique_lock<std::mutex> guard(slabsLock_);
+        std::shared_ptr<WriteSlab> slab;
+        if (size > WriteSlab::SlabSize) {
+            /* oversized messages get a dedicated, non-pooled slab */
+            slab = std::make_shared<WriteSlab>(size);
+        }
+        else {
+            if (!currentSlab_
+                || currentSlab_->capacity - currentSlab_->used < size) {
+                if (currentSlab_ && currentSlab_.use_count() == 1) {
+                    /* all spans of the open slab were written and released:
+                       reuse it in place */
+                    currentSlab_->used = 0;
+                }
+                else if (!freeSlabs_.empty()) {
+                    currentSlab_ = std::move(freeSlabs_.back());
+                    freeSlabs_.pop_back();
+                }
+                else {
+                    currentSlab_
+                        = std::make_shared<WriteSlab>(WriteSlab::SlabSize);
+                }
+            }
+            slab = currentSlab_;
+        }
+        size_t offset = slab->used;
+        ::memcpy(slab->bytes.get() + offset, data, size);
+        slab->used += size;
+        span = AsyncWrite(std::move(slab), offset, size, onWriteResult);
+    }
 
-    return result;
+    return queue_.push_back(std::move(span));
+}
+
+void
+AsyncWriterSource::
+releaseSlab(std::shared_ptr<WriteSlab> && slab)
+{
+    std::unique_lock<std::mutex> guard(slabsLock_);
+
+    if (slab == currentSlab_) {
+        /* still open for serialization: the write path will reuse or
+           recycle it upon rotation */
+        return;
+    }
+    if (slab->capacity == WriteSlab::SlabSize
+        && slab.use_count() == 1
+        && freeSlabs_.size() < maxFreeSlabs) {
+        /* ours was the last reference: all spans are written, so the slab
+           can return to the pool */
+        slab->used = 0;
+        freeSlabs_.emplace_back(std::move(slab));
+    }
 }
 
 void
@@ -181,7 +245,7 @@ handleWriteResult(int error, AsyncWrite && currentWrite)
     if (currentWrite.onWriteResult) {
         currentWrite.onWriteResult(
             AsyncWriteResult(error,
-                             move(currentWrite.message),
+                             currentWrite.message(),
                              currentWrite.sent)
         );
     }
@@ -213,7 +277,7 @@ requestClose()
     if (queueEnabled()) {
         disableQueue();
         closing_ = true;
-        queue_.push_back(AsyncWrite("", nullptr));
+        queue_.push_back(AsyncWrite());
     }
     else {
         throw MLDB::Exception("already closed/ing\n");
@@ -243,50 +307,60 @@ flush()
         return;
     }
 
-    auto popWrite = [&] () {
-        if (queue_.size() == 0) {
-            return false;
-        }
-        auto writes = queue_.pop_front(1);
-        ExcAssert(writes.size() > 0);
-        currentWrite_ = move(writes[0]);
-        return true;
-    };
-
-    if (currentWrite_.message.empty()) {
-        if (!popWrite()) {
-            return;
+    while (true) {
+        if (pendingWrites_.empty()) {
+            auto writes = queue_.pop_front(0);
+            for (auto & write: writes) {
+                pendingWrites_.emplace_back(move(write));
+            }
+            if (pendingWrites_.empty()) {
+                break;
+            }
         }
-        if (currentWrite_.message.empty()) {
+        if (!pendingWrites_.front().slab) {
             ExcAssert(closing_);
             handleClosing(false, true);
-            return;
+            break;
         }
-    }
 
-    ssize_t remaining(currentWrite_.message.size() - currentWrite_.sent);
-
-    errno = 0;
+        /* Gather the pending spans into a single writev call. Spans within
+           the same slab coalesce naturally since messages serialize
+           back-to-back. */
+        struct iovec iov[maxWriteIovecs];
+        size_t numIov(0);
+        for (const auto & write: pendingWrites_) {
+            if (!write.slab) {
+                break;
+            }
+            iov[numIov].iov_base
+                = write.slab->bytes.get() + write.offset + write.sent;
+            iov[numIov].iov_len = write.size - write.sent;
+            numIov++;
+            if (numIov == maxWriteIovecs) {
+                break;
+            }
+        }
 
-    while (true) {
-        const char * data = currentWrite_.message.c_str() + currentWrite_.sent;
-        ssize_t len = ::write(fd_, data, remaining);
+        errno = 0;
+        ssize_t len = ::writev(fd_, iov, numIov);
         if (len > 0) {
-            currentWrite_.sent += len;
-            remaining -= len;
             bytesSent_ += len;
-            if (remaining == 0) {
-                msgsSent_++;
-                handleWriteResult(0, move(currentWrite_));
-                if (!popWrite()) {
+            size_t written(len);
+            while (written > 0) {
+                AsyncWrite & front = pendingWrites_.front();
+                size_t remaining = front.size - front.sent;
+                if (written < remaining) {
+                    front.sent += written;
                     break;
                 }
-                if (currentWrite_.message.empty()) {
-                    ExcAssert(closing_);
-                    handleClosing(false, true);
-                    break;
-                }
-                remaining = currentWrite_.message.size();
+                written -= remaining;
+                front.sent = front.size;
+                msgsSent_++;
+                AsyncWrite finished = move(front);
+                pendingWrites_.pop_front();
+                auto slab = finished.slab;
+                handleWriteResult(0, move(finished));
+                releaseSlab(move(slab));
             }
         }
         else if (len < 0) {
@@ -294,8 +368,13 @@ flush()
             if (errno == EWOULDBLOCK || errno == EAGAIN) {
                 break;
             }
-            handleWriteResult(errno, move(currentWrite_));
-            if (errno == EPIPE || errno == EBADF) {
+            int error = errno;
+            AsyncWrite failed = move(pendingWrites_.front());
+            pendingWrites_.pop_front();
+            auto slab = failed.slab;
+            handleWriteResult(error, move(failed));
+            releaseSlab(move(slab));
+            if (error == EPIPE || error == EBADF) {
                 handleClosing(true, true);
                 break;
             }
@@ -303,7 +382,7 @@ flush()
                 /* This exception indicates a lack of code in the handling of
                    errno. In a perfect world, it should never ever be
                    thrown. */
-                throw MLDB::Exception(errno, "unhandled write error");
+                throw MLDB::Exception(error, "unhandled write error");
             }
         }
     }
@@ -361,9 +440,18 @@ emptyMessageQueue()
 {
     std::vector<std::string> messages;
 
+    for (const auto & write: pendingWrites_) {
+        if (write.slab && write.sent == 0) {
+            messages.emplace_back(write.message());
+        }
+    }
+    pendingWrites_.clear();
+
     auto writes = queue_.pop_front(0);
-    for (auto & write: writes) {
-        messages.emplace_back(move(write.message));
+    for (const auto & write: writes) {
+        if (write.slab) {
+            messages.emplace_back(write.message());
+        }
     }
 
     return messages;
@@ -10,6 +10,9 @@
 #pragma once
 
 #include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -75,14 +78,13 @@ struct AsyncWriterSource : public EpollLoop
     virtual ~AsyncWriterSource();
 
     /* enqueue "data" for writing, provided the file descriptor is open or
-     * being opened, or throws */
+     * being opened, or throws. The bytes are serialized into a pooled
+     * buffer slab upon queueing, so the raw pointer form involves no
+     * per-message allocation. */
     bool write(std::string data,
                const OnWriteResult & onWriteResult);
     bool write(const char * data, size_t size,
-               const OnWriteResult & onWriteResult)
-    {
-        return write(std::string(data, size), onWriteResult);
-    }
+               const OnWriteResult & onWriteResult);
 
     /* returns whether we are ready to accept messages for sending */
     bool queueEnabled()
@@ -145,34 +147,64 @@ protected:
     std::vector<std::string> emptyMessageQueue();
 
 private:
-    /* Structure holding a write operation */
+    /* A pooled buffer into which queued messages are serialized. Slabs are
+       reference counted: the open slab and every queued span hold a
+       reference, and a slab returns to the pool once fully written and
+       released. Messages larger than SlabSize get a dedicated slab of the
+       exact size, which is never pooled. */
+    struct WriteSlab {
+        static constexpr size_t SlabSize = 65536;
+
+        WriteSlab(size_t capacity)
+            : bytes(new char[capacity]), capacity(capacity), used(0)
+        {
+        }
+
+        std::unique_ptr<char[]> bytes;
+        size_t capacity;
+        size_t used;
+    };
+
+    /* Structure holding a write operation: a span of bytes within a slab,
+       plus the completion callback. A null slab is the closing sentinel. */
     struct AsyncWrite {
         AsyncWrite()
-            : sent(0)
+            : offset(0), size(0), sent(0)
         {
         }
 
-        AsyncWrite(std::string && newMessage,
+        AsyncWrite(std::shared_ptr<WriteSlab> newSlab,
+                   size_t newOffset, size_t newSize,
                    const OnWriteResult & newOnWriteResult)
-            : message(std::move(newMessage)), sent(0),
-              onWriteResult(newOnWriteResult)
+            : slab(std::move(newSlab)), offset(newOffset), size(newSize),
+              sent(0), onWriteResult(newOnWriteResult)
+        {
+        }
+
+        std::string message() const
         {
+            return std::string(slab->bytes.get() + offset, size);
         }
 
         void clear()
         {
-            message.clear();
+            slab.reset();
+            offset = 0;
+            size = 0;
             sent = 0;
             onWriteResult = nullptr;
         }
 
-        std::string message;
+        std::shared_ptr<WriteSlab> slab;
+        size_t offset;
+        size_t size;
         size_t sent;
         OnWriteResult onWriteResult;
     };
 
     /* fd operations */
     void flush();
+    void releaseSlab(std::shared_ptr<WriteSlab> && slab);
 
     void handleFdEvent(const EpollEvent & event);
     void handleReadReady();
@@ -190,7 +222,13 @@ private:
 
     bool queueEnabled_;
     TypedMessageQueue<AsyncWrite> queue_;
-    AsyncWrite currentWrite_;
+
+    /* spans popped from the queue but not yet fully written */
+    std::deque<AsyncWrite> pendingWrites_;
+
+    std::mutex slabsLock_;
+    std::shared_ptr<WriteSlab> currentSlab_;
+    std::vector<std::shared_ptr<WriteSlab> > freeSlabs_;
 
     uint64_t bytesSent_;
     uint64_t bytesReceived_;
@@ -13,6 +13,7 @@
 #include "mldb/arch/exception.h"
 #include "mldb/arch/backtrace.h"
 #include <string.h>
+#include <atomic>
 #include <iostream>
 #include <unistd.h>
 #include "mldb/types/date.h"
@@ -24,6 +25,13 @@ namespace MLDB {
 // Maximum number of events that we can handle
 static constexpr int MaxEvents = 1024;
 
+// Whether the kernel supports epoll_pwait2, which lets us wait with
+// nanosecond resolution and collect events in a single syscall.  Cleared
+// on the first ENOSYS, after which we fall back to ppoll + epoll_wait.
+// A one-way latch touched from every event-loop thread, hence atomic;
+// relaxed order suffices as it guards nothing but itself.
+static std::atomic<bool> epollPwait2Available = true;
+
 struct EpollEvent: public epoll_event {
 };
 
@@ -157,23 +165,41 @@ handleEvents(int usToWait, int nEvents,
         if (beforeSleep)
             beforeSleep();
 
-        // Do the sleep with nanosecond resolution
-        // Let's hope it doesn't busy-wait
-        if (usToWait != 0) {
-            pollfd fd[1] = { { epoll_fd, POLLIN, 0 } };
-            timespec timeout = { 0, usToWait * 1000 };
-            int res = ppoll(fd, 1, &timeout, 0);
-            if (res == -1 && errno == EBADF) {
-                cerr << "got bad FD on sleep" << endl;
-                return -1;
-            }
-            if (res == -1 && errno == EINTR)
+        int res;
+
+        if (usToWait != 0
+            && epollPwait2Available.load(std::memory_order_relaxed)) {
+            // Sleep and collect events in a single syscall, with
+            // nanosecond resolution
+            timespec timeout = { usToWait / 1000000,
+                                 (usToWait % 1000000) * 1000 };
+            res = epoll_pwait2(epoll_fd, events, nEvents, &timeout, nullptr);
+            if (res == -1 && errno == ENOSYS) {
+                // Pre-5.11 kernel; take the two-syscall path from now on
+                epollPwait2Available.store(false, std::memory_order_relaxed);
                 continue;
-            //if (debug) cerr << "handleEvents: res = " << res << endl;
-            if (res == 0) return 0;
+            }
         }
+        else {
+            // Do the sleep with nanosecond resolution
+            // Let's hope it doesn't busy-wait
+            if (usToWait != 0) {
+                pollfd fd[1] = { { epoll_fd, POLLIN, 0 } };
+                timespec timeout = { usToWait / 1000000,
+                                     (usToWait % 1000000) * 1000 };
+                int res = ppoll(fd, 1, &timeout, 0);
+                if (res == -1 && errno == EBADF) {
+                    cerr << "got bad FD on sleep" << endl;
+                    return -1;
+                }
+                if (res == -1 && errno == EINTR)
+                    continue;
+                //if (debug) cerr << "handleEvents: res = " << res << endl;
+                if (res == 0) return 0;
+            }
 
-        int res = epoll_wait(epoll_fd, events, nEvents, timeout_);
+            res = epoll_wait(epoll_fd, events, nEvents, timeout_);
+        }
 
         if (afterSleep)
             afterSleep();
@@ -247,6 +273,7 @@ performAddFd(int fd, void * data, int flags, bool restart)
 
     auto doFlag = [&] (int inFlag, int outFlag) { if (flags & inFlag) event.events |= outFlag; flags &= ~inFlag; };
     doFlag(EPOLL_ONESHOT, EPOLLONESHOT);
+    doFlag(EPOLL_EXCLUSIVE, EPOLLEXCLUSIVE);
 
     if (flags != 0) {
         throw MLDB::Exception("Unknown flags in Epoller add");
@@ -701,6 +728,7 @@ performAddFd(int fd, void * data, int flags, bool restart)
     int kevent_flags = EV_ADD;  //(restart ? EV_ENABLE : EV_ADD); // restart applies to both read and write, which are separate.  EV_ADD has the right semantics
     auto doFlag = [&] (int inFlag, int outFlag) { if (flags & inFlag) kevent_flags |= outFlag; flags &= ~inFlag; };
     doFlag(EPOLL_ONESHOT, EV_ONESHOT);
+    doFlag(EPOLL_EXCLUSIVE, 0);  // kqueue wakes a single waiter already
 
     if (flags != 0) {
         throw MLDB::Exception("Unknown flags in Epoller add");
@@ -30,7 +30,14 @@ void * getPtr(const EpollEvent & event);
 enum {
     EPOLL_INPUT = 1,
     EPOLL_OUTPUT = 2,
-    EPOLL_ONESHOT = 4
+    EPOLL_ONESHOT = 4,
+
+    /** Wake only one of the threads sharing the fd (EPOLLEXCLUSIVE), to
+        avoid thundering herds on accept fds registered with several
+        pollers.  Only valid when first adding an fd, not when modifying
+        or restarting it.  Ignored on kqueue, which already wakes a
+        single waiter per event. */
+    EPOLL_EXCLUSIVE = 8
 };
 
 /*****************************************************************************/
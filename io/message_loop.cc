@@ -289,20 +289,19 @@ runWorkerThread()
             // First time, we sleep for up to one second waiting for events to come
             // in to the event loop, and handle as many as we can until we hit the
             // limit or we're idle.
-            int res MLDB_UNUSED = handleEvents(999999 /* microseconds */, maxEventsToHandle,
-                                              nullptr, beforeSleep, afterSleep);
+            int res = handleEvents(999999 /* microseconds */, maxEventsToHandle,
+                                   nullptr, beforeSleep, afterSleep);
             //cerr << "handleEvents returned " << res << endl;
 
-#if 0
-            while (res != 0) {
-                if (shutdown_)
-                    return;
-                
-                // Now we busy loop handling events while there is still more work to do
+            // If we filled the batch, more events are likely already
+            // queued; drain them without going back to sleep so that busy
+            // periods pay one wakeup for many events.  The poll() check
+            // keeps us from blocking when a blocking epoll timeout is
+            // configured and the queue turns out to be empty.
+            while (res == maxEventsToHandle && !shutdown_ && poll()) {
                 res = handleEvents(0 /* microseconds */, maxEventsToHandle,
                                    nullptr, beforeSleep, afterSleep);
             }
-#endif
         }
 
         if (shutdown_)
@@ -7,6 +7,7 @@
 
 #include <iostream>
 #include <mutex>
+#include <thread>
 
 #include "mldb/arch/exception.h"
 #include "mldb/base/exc_assert.h"
@@ -20,6 +21,21 @@ using namespace std;
 using namespace MLDB;
 
 
+/****************************************************************************/
+/* TCP ACCEPTOR :: SHARD                                                    */
+/****************************************************************************/
+
+/* An additional acceptor sharing the listening port via SO_REUSEPORT, with
+ * its own event loop running on a dedicated thread. Connections accepted by
+ * a shard are bootstrapped and handled on that loop. */
+
+struct TcpAcceptor::Shard {
+    std::unique_ptr<EventLoop> loop;
+    std::unique_ptr<TcpAcceptorImpl> impl;
+    std::thread thread;
+};
+
+
 /****************************************************************************/
 /* TCP ACCEPTOR                                                             */
 /****************************************************************************/
@@ -45,6 +61,35 @@ listen(const PortRange & portRange, const string & hostname, int backlog)
     impl_->listen(portRange, hostname, backlog);
 }
 
+void
+TcpAcceptor::
+listenSharded(const PortRange & portRange, const string & hostname,
+              int numShards, int backlog)
+{
+    ExcAssert(numShards > 0);
+    ExcAssert(shards_.empty());
+
+    /* The first shard listens on the caller's event loop, exactly as with
+       listen(), and fixes the effective port for the others. */
+    impl_->listen(portRange, hostname, backlog, true);
+
+    int port = impl_->effectiveTCPv4Port();
+    if (port == -1) {
+        port = impl_->effectiveTCPv6Port();
+    }
+
+    for (int i = 1; i < numShards; i++) {
+        auto shard = std::make_unique<Shard>();
+        shard->loop.reset(new EventLoop());
+        shard->impl.reset(new TcpAcceptorImpl(*shard->loop, *this));
+        shard->impl->listen(PortRange(port, port + 1), hostname, backlog,
+                            true);
+        auto * loop = shard->loop.get();
+        shard->thread = std::thread([loop] () { loop->run(); });
+        shards_.emplace_back(std::move(shard));
+    }
+}
+
 int
 TcpAcceptor::
 effectiveTCPv4Port() const
@@ -63,6 +108,14 @@ void
 TcpAcceptor::
 shutdown()
 {
+    for (auto & shard: shards_) {
+        shard->impl->shutdown();
+        shard->loop->terminate();
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+    shards_.clear();
     impl_->shutdown();
 }
 
@@ -76,6 +129,13 @@ onNewConnection(TcpSocket && socket)
 void
 TcpAcceptor::
 associate(std::shared_ptr<TcpSocketHandler> handler)
+{
+    associate(std::move(handler), eventLoop_);
+}
+
+void
+TcpAcceptor::
+associate(std::shared_ptr<TcpSocketHandler> handler, EventLoop & loop)
 {
     auto doAssociate = [handler, this] () {
         std::unique_lock<std::mutex> guard(associatedHandlersLock_);
@@ -83,7 +143,7 @@ associate(std::shared_ptr<TcpSocketHandler> handler)
         handler->setAcceptor(this);
         handler->bootstrap();
     };
-    eventLoop_.post(doAssociate);
+    loop.post(doAssociate);
 }
 
 std::shared_ptr<TcpSocketHandler>
@@ -11,6 +11,8 @@
 #include <mutex>
 #include <set>
 #include <string>
+#include <thread>
+#include <vector>
 #include "mldb/io/tcp_socket.h"
 
 
@@ -46,6 +48,18 @@ struct TcpAcceptor {
                 const std::string & hostname = "localhost",
                 int backlog = 128);
 
+    /* Like listen(), but with numShards acceptors each owning its own
+     * listening socket bound to the same port with SO_REUSEPORT and, for
+     * every shard beyond the first, its own event loop on a dedicated
+     * thread. The kernel spreads incoming connections across the sockets,
+     * and each connection is parsed and served on the loop that accepted
+     * it, so no cross-thread wakeup sits between the accept and the first
+     * byte read. Handlers behave exactly as with listen(). */
+    void listenSharded(const PortRange & portRange,
+                       const std::string & hostname = "localhost",
+                       int numShards = 1,
+                       int backlog = 128);
+
     /* Shutdowns the worker threads (except the main listening thread) as well
      * as the listening socket. */
     void shutdown();
@@ -62,6 +76,11 @@ struct TcpAcceptor {
        purpose only. */
     void associate(std::shared_ptr<TcpSocketHandler> handler);
 
+    /* Same, but bootstrapping the handler on the given loop, which must
+       be the one its socket belongs to. For internal purpose only. */
+    void associate(std::shared_ptr<TcpSocketHandler> handler,
+                   EventLoop & loop);
+
     /* Dissociate and the given handler. For internal purpose only. */
     void dissociate(TcpSocketHandler * handler);
 
@@ -71,9 +90,14 @@ struct TcpAcceptor {
                                                      * handler) const;
 
 private:
+    /* An extra acceptor with its own listening socket and event loop
+       thread, used by listenSharded. */
+    struct Shard;
+
     EventLoop & eventLoop_;
     OnNewConnection onNewConnection_;
     std::unique_ptr<TcpAcceptorImpl> impl_;
+    std::vector<std::unique_ptr<Shard> > shards_;
 
     mutable std::mutex associatedHandlersLock_;
     std::set<std::shared_ptr<TcpSocketHandler> > associatedHandlers_;
@@ -37,9 +37,11 @@ struct TcpAcceptorImpl {
     virtual ~TcpAcceptorImpl();
 
     /* Starts listening on the first available of the given ports (in
-     * ascending order) and interface. */
+     * ascending order) and interface. When "reusePort" is set, the
+     * listening sockets are opened with SO_REUSEPORT so that several
+     * acceptors can share the same port. */
     void listen(const PortRange & portRange, const std::string & hostname,
-                int backlog);
+                int backlog, bool reusePort = false);
 
     /* Shutdowns the worker threads (except the main listening thread) as well
      * as the listening socket. */
@@ -64,7 +66,8 @@ private:
 
         void open(const boost::asio::ip::tcp::endpoint & resolverEntry,
                   const PortRange & portRange,
-                  int backlog);
+                  int backlog,
+                  bool reusePort);
         void close();
         void accept();
         bool isOpen()
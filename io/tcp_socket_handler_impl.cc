@@ -6,6 +6,7 @@
 */
 
 #include <memory>
+#include <boost/asio/bind_executor.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/system/error_code.hpp>
 #include "mldb/io/tcp_socket.h"
@@ -21,6 +22,10 @@ constexpr auto NOT_CLOSED = 0;
 constexpr auto CLOSING = 1;
 constexpr auto CLOSED = 2;
 
+/* Maximum number of payloads covered by one gather write.  Comfortably
+   under IOV_MAX, and enough for a full pipelined response burst. */
+constexpr size_t MAX_WRITE_BATCH = 64;
+
 /****************************************************************************/
 /* TCP HANDLER IMPL                                                         */
 /****************************************************************************/
@@ -28,6 +33,9 @@ constexpr auto CLOSED = 2;
 TcpSocketHandlerImpl::
 TcpSocketHandlerImpl(TcpSocketHandler & handler, TcpSocket && socket)
     : handler_(handler), socket_(std::move(socket.impl().socket)),
+      writeStrand_(socket_.get_executor()),
+      writeBatchSize_(0),
+      writeInFlight_(false),
       recvBufferSize_(262144),
       recvBuffer_(new char[recvBufferSize_]),
       closed_(NOT_CLOSED)
@@ -94,29 +102,69 @@ void
 TcpSocketHandlerImpl::
 requestWrite(string data, TcpSocketHandler::OnWritten onWritten)
 {
-    auto dataPtr = std::make_shared<std::string>(std::move(data));
-
-    // These lambdas capture DataPtr not because they need it, but so that
-    // its lifetime exceeds those of the ASIO operations which use it (the
-    // const_buffer does not own its data, so we need to ensure that the
-    // data is pinned by another mechanism.
-    auto writeCompleteCond = [dataPtr] (const system::error_code & ec,
-                                   std::size_t written)
-    {
-        return written == dataPtr->size();
+    // All queue manipulation happens on the write strand, so that
+    // payloads issued from any thread are serialized and can be coalesced
+    // into a single gather write each time the socket is ready.
+    auto sharedThis = this->shared_from_this();
+    auto doWriteFn = [sharedThis,
+                      data = std::move(data),
+                      onWritten = std::move(onWritten)] () mutable {
+        sharedThis->writeQueue_.emplace_back(
+            WriteEntry{std::move(data), std::move(onWritten)});
+        if (!sharedThis->writeInFlight_) {
+            sharedThis->startBatchWrite();
+        }
     };
 
-    auto onWriteComplete = [dataPtr, onWritten] (const system::error_code & ec,
-                            size_t written)
+    boost::asio::post(writeStrand_, std::move(doWriteFn));
+}
+
+void
+TcpSocketHandlerImpl::
+startBatchWrite()
+{
+    writeInFlight_ = true;
+    writeBatchSize_ = std::min(writeQueue_.size(), MAX_WRITE_BATCH);
+
+    // The buffers point into the queued strings, which stay pinned until
+    // the completion handler below pops them.
+    writeBuffers_.clear();
+    for (size_t i = 0; i < writeBatchSize_; i++) {
+        const string & data = writeQueue_[i].data;
+        writeBuffers_.emplace_back(data.data(), data.size());
+    }
+
+    auto sharedThis = this->shared_from_this();
+    auto onWriteComplete = [sharedThis] (const system::error_code & ec,
+                                         size_t written)
     {
-        if (onWritten) {
-            onWritten(ec, written);
+        for (size_t i = 0; i < sharedThis->writeBatchSize_; i++) {
+            WriteEntry & entry = sharedThis->writeQueue_.front();
+            if (entry.onWritten) {
+                entry.onWritten(ec, ec ? 0 : entry.data.size());
+            }
+            sharedThis->writeQueue_.pop_front();
+        }
+        sharedThis->writeInFlight_ = false;
+        if (!ec && !sharedThis->writeQueue_.empty()) {
+            sharedThis->startBatchWrite();
+        }
+        else if (ec) {
+            // Payloads queued behind a failed write will never make it
+            // onto the wire; deliver the error to their callbacks too
+            while (!sharedThis->writeQueue_.empty()) {
+                WriteEntry & entry = sharedThis->writeQueue_.front();
+                if (entry.onWritten) {
+                    entry.onWritten(ec, 0);
+                }
+                sharedThis->writeQueue_.pop_front();
+            }
         }
     };
 
-    asio::const_buffer writeBuffer(dataPtr->data(), dataPtr->size());
-
-    async_write(socket_, writeBuffer, writeCompleteCond, onWriteComplete);
+    async_write(socket_, writeBuffers_,
+                boost::asio::bind_executor(writeStrand_,
+                                           std::move(onWriteComplete)));
 }
 
 void
@@ -9,9 +9,13 @@
 #pragma once
 
 #include <atomic>
+#include <deque>
 #include <string>
 #include <memory>
+#include <vector>
+#include <boost/asio/buffer.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/strand.hpp>
 #include "mldb/io/tcp_socket_handler.h"
 
 
@@ -44,7 +48,10 @@ struct TcpSocketHandlerImpl: public std::enable_shared_from_this<TcpSocketHandle
     /* Request the closing of the connection via the handling thread. */
     void requestClose(TcpSocketHandler::OnClose onClose = nullptr);
 
-    /* Request the sending of a given payload. */
+    /* Request the sending of a given payload.  Payloads are queued on the
+       write strand and flushed with a single gather write (writev) per
+       batch, so multiple requests issued while a write is in flight cost
+       one syscall rather than one each. */
     void requestWrite(std::string data,
                       TcpSocketHandler::OnWritten onWritten = nullptr);
 
@@ -56,9 +63,33 @@ struct TcpSocketHandlerImpl: public std::enable_shared_from_this<TcpSocketHandle
         operator = (const TcpSocketHandlerImpl & other) = delete;
 
 private:
+    /* Payload waiting to be put on the wire, with its completion
+       callback. */
+    struct WriteEntry {
+        std::string data;
+        TcpSocketHandler::OnWritten onWritten;
+    };
+
+    /* Start a gather write covering the queued entries.  Must be called
+       from the write strand, with no write in flight. */
+    void startBatchWrite();
+
     TcpSocketHandler & handler_;
     boost::asio::ip::tcp::socket socket_;
 
+    /* Serializes access to the write queue, since the event loop may be
+       run by several threads at once. */
+    boost::asio::strand<boost::asio::ip::tcp::socket::executor_type>
+        writeStrand_;
+
+    /* Write queue; only touched from the write strand.  Entries stay
+       in place while their buffers are on the wire (a deque never
+       relocates existing elements on push_back). */
+    std::deque<WriteEntry> writeQueue_;
+    size_t writeBatchSize_;
+    bool writeInFlight_;
+    std::vector<boost::asio::const_buffer> writeBuffers_;
+
     size_t recvBufferSize_;
 
     std::unique_ptr<char[]> recvBuffer_;
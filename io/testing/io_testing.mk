@@ -5,5 +5,6 @@ $(eval $(call test,async_writer_bench,io_base arch types,boost manual))
 $(eval $(call test,epoll_test,io_base,boost))
 $(eval $(call test,epoller_test,io_base,boost))
 $(eval $(call test,timerfd_test,io_base,boost))
+$(eval $(call test,tcp_write_batching_test,io_base watch types utils,boost))
 $(eval $(call test,message_channel_test,io_base arch types,boost))
 $(eval $(call test,message_loop_test,io_base arch types,boost))
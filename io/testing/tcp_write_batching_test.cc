@@ -0,0 +1,250 @@
+/** tcp_write_batching_test.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Tests of the gather-write batching in TcpSocketHandler.
+*/
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include <boost/system/error_code.hpp>
+
+#include "mldb/io/event_loop.h"
+#include "mldb/io/asio_thread_pool.h"
+#include "mldb/io/tcp_acceptor.h"
+#include "mldb/io/tcp_socket_handler.h"
+#include "mldb/io/port_range_service.h"
+#include "mldb/utils/testing/watchdog.h"
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace MLDB;
+
+namespace {
+
+/* Upon receiving anything, sends back numWrites payloads of the form
+   "<index>;", issued back to back so that most of them are batched into
+   gather writes behind the first one. */
+struct BurstWriterHandler : public TcpSocketHandler {
+    BurstWriterHandler(TcpSocket && socket, int numWrites,
+                       std::atomic<int> & numWritten)
+        : TcpSocketHandler(std::move(socket)),
+          numWrites(numWrites),
+          numWritten(numWritten)
+    {
+    }
+
+    virtual void bootstrap()
+    {
+        requestReceive();
+    }
+
+    virtual void onReceivedData(const char * buffer, size_t bufferSize)
+    {
+        for (int i = 0; i < numWrites; i++) {
+            auto onWritten = [&] (const boost::system::error_code & ec,
+                                  size_t) {
+                if (!ec) {
+                    numWritten++;
+                }
+            };
+            requestWrite(to_string(i) + ";", onWritten);
+        }
+    }
+
+    virtual void onReceiveError(const boost::system::error_code & ec,
+                                size_t bufferSize)
+    {
+        requestClose();
+    }
+
+    int numWrites;
+    std::atomic<int> & numWritten;
+};
+
+int connectToPort(int port)
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    BOOST_REQUIRE(fd != -1);
+
+    sockaddr_in addr;
+    ::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    int res = ::connect(fd, (const sockaddr *) &addr, sizeof(addr));
+    BOOST_REQUIRE_EQUAL(res, 0);
+
+    return fd;
+}
+
+} // file scope
+
+/* A burst of small writes issued while the socket is busy must all make
+   it onto the wire, in order, with their completion callbacks invoked. */
+BOOST_AUTO_TEST_CASE( test_write_burst_batched_in_order )
+{
+    MLDB::Watchdog watchdog(30);
+
+    constexpr int numWrites = 1000;
+
+    std::atomic<int> numWritten(0);
+
+    EventLoop eventLoop;
+    AsioThreadPool threads(eventLoop, 4 /* threads */);
+
+    auto makeHandler = [&] (TcpSocket && socket) {
+        return make_shared<BurstWriterHandler>(std::move(socket), numWrites,
+                                               numWritten);
+    };
+    TcpAcceptor acceptor(eventLoop, makeHandler);
+    acceptor.listen(PortRange(15500, 15999), "127.0.0.1");
+
+    int fd = connectToPort(acceptor.effectiveTCPv4Port());
+
+    char c = 'x';
+    BOOST_REQUIRE_EQUAL(::write(fd, &c, 1), 1);
+
+    string expected;
+    for (int i = 0; i < numWrites; i++) {
+        expected += to_string(i) + ";";
+    }
+
+    string received;
+    char buffer[4096];
+    while (received.size() < expected.size()) {
+        ssize_t res = ::read(fd, buffer, sizeof(buffer));
+        BOOST_REQUIRE(res > 0);
+        received.append(buffer, res);
+    }
+
+    BOOST_CHECK_EQUAL(received, expected);
+
+    while (numWritten < numWrites) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    BOOST_CHECK_EQUAL(numWritten, numWrites);
+
+    ::close(fd);
+    acceptor.shutdown();
+}
+
+/* Payloads from several submitting threads end up intact: every payload
+   appears exactly once on the wire, never interleaved inside another. */
+BOOST_AUTO_TEST_CASE( test_concurrent_writers_never_interleave )
+{
+    MLDB::Watchdog watchdog(30);
+
+    constexpr int numThreads = 4;
+    constexpr int writesPerThread = 250;
+
+    std::atomic<int> numWritten(0);
+
+    struct MultiWriterHandler : public TcpSocketHandler {
+        MultiWriterHandler(TcpSocket && socket, std::atomic<int> & numWritten)
+            : TcpSocketHandler(std::move(socket)), numWritten(numWritten)
+        {
+        }
+
+        virtual void bootstrap()
+        {
+            requestReceive();
+        }
+
+        virtual void onReceivedData(const char * buffer, size_t bufferSize)
+        {
+            auto onWritten = [&] (const boost::system::error_code & ec,
+                                  size_t) {
+                if (!ec) {
+                    numWritten++;
+                }
+            };
+            vector<std::thread> writers;
+            for (int t = 0; t < numThreads; t++) {
+                writers.emplace_back([&, t] () {
+                    for (int i = 0; i < writesPerThread; i++) {
+                        requestWrite(to_string(t) + ":" + to_string(i) + ";",
+                                     onWritten);
+                    }
+                });
+            }
+            for (auto & w: writers) {
+                w.join();
+            }
+        }
+
+        virtual void onReceiveError(const boost::system::error_code & ec,
+                                    size_t bufferSize)
+        {
+            requestClose();
+        }
+
+        std::atomic<int> & numWritten;
+    };
+
+    EventLoop eventLoop;
+    AsioThreadPool threads(eventLoop, 4 /* threads */);
+
+    auto makeHandler = [&] (TcpSocket && socket) {
+        return make_shared<MultiWriterHandler>(std::move(socket), numWritten);
+    };
+    TcpAcceptor acceptor(eventLoop, makeHandler);
+    acceptor.listen(PortRange(15500, 15999), "127.0.0.1");
+
+    int fd = connectToPort(acceptor.effectiveTCPv4Port());
+
+    char c = 'x';
+    BOOST_REQUIRE_EQUAL(::write(fd, &c, 1), 1);
+
+    constexpr int numPayloads = numThreads * writesPerThread;
+
+    string received;
+    char buffer[4096];
+    while (std::count(received.begin(), received.end(), ';') < numPayloads) {
+        ssize_t res = ::read(fd, buffer, sizeof(buffer));
+        BOOST_REQUIRE(res > 0);
+        received.append(buffer, res);
+    }
+
+    /* Per-thread sequences must arrive in submission order, and every
+       payload exactly once */
+    vector<int> lastSeen(numThreads, -1);
+    size_t pos = 0;
+    while (pos < received.size()) {
+        size_t sep = received.find(';', pos);
+        BOOST_REQUIRE(sep != string::npos);
+        string payload = received.substr(pos, sep - pos);
+        size_t colon = payload.find(':');
+        BOOST_REQUIRE(colon != string::npos);
+        int t = std::stoi(payload.substr(0, colon));
+        int i = std::stoi(payload.substr(colon + 1));
+        BOOST_REQUIRE(t >= 0 && t < numThreads);
+        BOOST_CHECK_EQUAL(i, lastSeen[t] + 1);
+        lastSeen[t] = i;
+        pos = sep + 1;
+    }
+    for (int t = 0; t < numThreads; t++) {
+        BOOST_CHECK_EQUAL(lastSeen[t], writesPerThread - 1);
+    }
+
+    while (numWritten < numPayloads) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ::close(fd);
+    acceptor.shutdown();
+}
@@ -9,11 +9,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <thread>
+#include <vector>
 
 #include "mldb/io/ring_buffer.h"
 #include "mldb/arch/wakeup_fd.h"
+#include "mldb/arch/wait_on_address.h"
 #include "mldb/base/exc_assert.h"
 #include "mldb/io/async_event_source.h"
 
@@ -40,7 +43,7 @@ struct TypedMessageSink: public AsyncEventSource {
     void push(MessageT&& message)
     {
         buf.push(std::forward<MessageT>(message));
-        wakeup.signal();
+        notify(1);
     }
 
     template<typename MessageT>
@@ -48,11 +51,53 @@ struct TypedMessageSink: public AsyncEventSource {
     {
         bool pushed = buf.tryPush(std::forward<MessageT>(message));
         if (pushed)
-            wakeup.signal();
+            notify(1);
 
         return pushed;
     }
 
+    /* Push a range of messages (moved from), with a single notification
+       for the whole batch instead of one futex wake per message. */
+    template<typename Iterator>
+    void pushBatch(Iterator first, Iterator last)
+    {
+        uint32_t numPushed = 0;
+        for (auto it = first;  it != last;  ++it, ++numPushed)
+            buf.push(std::move(*it));
+        if (numPushed)
+            notify(numPushed);
+    }
+
+    void pushBatch(std::vector<Message> && messages)
+    {
+        pushBatch(messages.begin(), messages.end());
+        messages.clear();
+    }
+
+    /* Blocking pop for a dedicated consumer thread, bypassing the
+       event-loop fd.  Spins briefly for the common case where the next
+       message is already in flight, then waits on the push counter, so
+       an idle consumer parks in the kernel without polling while a busy
+       one never pays the futex round trip. */
+    bool waitPop(Message & message)
+    {
+        for (unsigned i = 0;  i < SPIN_ITERATIONS;  ++i) {
+            if (buf.tryPop(message))
+                return true;
+            if ((i & 63) == 63)
+                std::this_thread::yield();
+        }
+
+        for (;;) {
+            uint32_t seen = pushCount.load(std::memory_order_acquire);
+            if (buf.tryPop(message))
+                return true;
+            waiters.fetch_add(1, std::memory_order_seq_cst);
+            wait_on_address(pushCount, seen);
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
     //protected:
     virtual int selectFd() const override
     {
@@ -66,16 +111,21 @@ struct TypedMessageSink: public AsyncEventSource {
 
     virtual bool processOne() override
     {
-        // Try to do one
+        // Drain a batch per call, so one wakeup read is amortized over
+        // up to PROCESS_BATCH messages instead of paid per message
         Message msg;
-        if (!buf.tryPop(msg))
+        size_t numDone = 0;
+        while (numDone < PROCESS_BATCH && buf.tryPop(msg)) {
+            onEvent(std::move(msg));
+            ++numDone;
+        }
+        if (numDone == 0)
             return false;
-        onEvent(std::move(msg));
 
         // Are there more waiting for us?
         if (buf.couldPop())
             return true;
-        
+
         // Warning: race condition... that's why we need the couldPop from
         // the next instruction to be accurate
         wakeup.tryRead();
@@ -85,8 +135,27 @@ struct TypedMessageSink: public AsyncEventSource {
 
     uint64_t size() const { return buf.ring.size() ; }
 private:
+    /// Iterations waitPop spins before parking on the push counter
+    static constexpr unsigned SPIN_ITERATIONS = 1024;
+
+    /// Maximum messages dispatched per processOne call
+    static constexpr size_t PROCESS_BATCH = 64;
+
+    /* One notification for a batch of numPushed messages: a single
+       eventfd write for the event loop, plus a single futex wake when a
+       waitPop consumer is parked. */
+    void notify(uint32_t numPushed)
+    {
+        pushCount.fetch_add(numPushed, std::memory_order_release);
+        wakeup.signal();
+        if (waiters.load(std::memory_order_seq_cst) > 0)
+            wake_by_address(pushCount);
+    }
+
     MLDB::WakeupFD wakeup;
     MLDB::RingBufferSRMW<Message> buf;
+    std::atomic<uint32_t> pushCount = 0;
+    std::atomic<uint32_t> waiters = 0;
 };
 
 
@@ -173,6 +242,30 @@ struct TypedMessageQueue: public AsyncEventSource
         return true;
     }
 
+    /* push a batch of messages into the queue under a single lock
+     * acquisition and with at most one notification; all or nothing
+     * with respect to the queue limit */
+    bool push_back(std::vector<Message> && messages)
+    {
+        Guard guard(queueLock_);
+
+        if (maxMessages_ > 0
+            && queue_.size() + messages.size() > maxMessages_) {
+            return false;
+        }
+
+        for (auto & message: messages) {
+            queue_.emplace(std::move(message));
+        }
+        messages.clear();
+        if (!pending_ && queue_.size() > 0) {
+            pending_ = true;
+            wakeup_.signal();
+        }
+
+        return true;
+    }
+
     /* returns up to "number" messages from the queue or all of them if 0 */
     std::vector<Message> pop_front(size_t number)
     {
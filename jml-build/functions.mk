@@ -121,7 +121,7 @@ BUILD_$(CWD)/$(2).lo_OBJ  := $$(OBJ)/$(CWD)/$(2).$$(BUILD_$(CWD)/$(2).lo_HASH).l
 BUILD_$(CWD)/$(2).lo_COMMAND2 := $$(subst $(OBJ)/$(CWD)/$(2).lo,$$(BUILD_$(CWD)/$(2).lo_OBJ),$$(BUILD_$(CWD)/$(2).lo_COMMAND))
 
 $(OBJ)/$(CWD)/$(2).d:
-$$(BUILD_$(CWD)/$(2).lo_OBJ):	$$(tmpDIR)/$(CWD)/$(1) $(OBJ)/$(CWD)/.dir_exists $$(dir $$(OBJ)/$(CWD)/$(2))/.dir_exists
+$$(BUILD_$(CWD)/$(2).lo_OBJ):	$$(tmpDIR)/$(CWD)/$(1) $(OBJ)/$(CWD)/.dir_exists $$(dir $$(OBJ)/$(CWD)/$(2))/.dir_exists $$(PCH_GCH)
 	$$(if $(verbose_build),,@$$(BUILD_$(CWD)/$(2).lo_COUNT_LINES) -o $(STDOUT_FILENAME) | grep . | wc > $$@.wc)
 	$$(if $(verbose_build),@echo $$(BUILD_$(CWD)/$(2).lo_COMMAND2),@echo "           $(COLOR_CYAN)[C++	`awk -f mldb/jml-build/print-line-counts.awk $$@.wc`]$(COLOR_RESET)		$(CWD)/$(1)")
 	@$$(call write_timing_to,$$@.timing) $$(BUILD_$(CWD)/$(2).lo_COMMAND2)
@@ -42,6 +42,33 @@ $(if $(findstring x5.1,x$(CXX_VERSION)),$(eval CXXFLAGS += -Wno-unused-local-typ
 # Library name of filesystem
 STD_FILESYSTEM_LIBNAME:=stdc++fs
 
+# Optional precompiled header support.  Set PCH to a header file (with the
+# path used to reach it from the build root) to precompile it once and
+# force-include it into every C++ compilation, eg:
+#
+#     make PCH:=mldb/sql/expression_value.h
+#
+# The header is copied under $(OBJ)/pch so the source tree stays clean, and
+# every object file depends on the .gch, so a change to the header rebuilds
+# everything that used it.  -Winvalid-pch makes gcc complain loudly if the
+# precompiled header can't actually be used.
+ifneq ($(PCH),)
+PCH_HEADER:=$(OBJ)/pch/precompiled.h
+PCH_GCH:=$(PCH_HEADER).gch
+
+# Flags as they were before the PCH was added, used to build the PCH itself
+PCH_CXXFLAGS:=$(CXXFLAGS) $(CXXNODEBUGFLAGS)
+
+$(PCH_HEADER): $(PCH)
+	@mkdir -p $(dir $@)
+	@cp $< $@
+
+$(PCH_GCH): $(PCH_HEADER)
+	$(CXX) $(PCH_CXXFLAGS) -x c++-header -o $@ $<
+
+CXXFLAGS += -include $(PCH_HEADER) -Winvalid-pch
+endif
+
 include $(JML_BUILD)/gcc$(GXX_VERSION_MAJOR).mk
 
 
@@ -41,6 +41,7 @@ $(eval $(call library,behavior,$(LIBBEHAVIOR_SOURCES),$(LIBBEHAVIOR_LINK)))
 LIBBEHAVIOR_PLUGIN_SOURCES := \
 	behavior_dataset.cc \
 	binary_behavior_dataset.cc \
+	behavior_event_export_procedure.cc \
 
 LIBBEHAVIOR_PLUGIN_LINK := \
 	behavior arch value_description sql_types types log vfs rest sql_expression base mldb_core mldb_engine progress
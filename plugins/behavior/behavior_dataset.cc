@@ -8,6 +8,7 @@
 */
 
 #include "mldb/sql/sql_expression.h"
+#include "mldb/sql/sql_expression_operations.h"
 #include "mldb/plugins/behavior/behavior_utils.h"
 
 #include "mldb/arch/timers.h"
@@ -20,6 +21,8 @@
 
 #include "mldb/types/basic_value_descriptions.h"
 #include "mldb/types/compact_vector_description.h"
+#include "mldb/types/vector_description.h"
+#include "mldb/types/json_printing.h"
 #include "mldb/vfs/fs_utils.h"
 #include "behavior_manager.h"
 #include "mutable_behavior_domain.h"
@@ -495,6 +498,14 @@ struct BehaviorColumnIndex: public ColumnIndex {
 
         const BehaviorColumnInfo & info = it2->second;
 
+        // A column backed by a single behavior has its subject count
+        // maintained by the format; no need to decode the posting list
+        if (info.values.size() == 1
+            && info.values.begin()->second.itl.size() == 1) {
+            return behs->getBehaviorSubjectCount
+                (info.values.begin()->second.itl[0]);
+        }
+
         // Now for each value we need to fill it in
 
         LightweightHashSet<SH> rows;
@@ -512,6 +523,14 @@ struct BehaviorColumnIndex: public ColumnIndex {
         return rows.size();
     }
 
+    virtual uint64_t getColumnDistinctEstimate(const ColumnPath & column) const
+    {
+        auto it2 = index->columnInfo.find(column);
+        if (it2 == index->columnInfo.end())
+            return 0;
+        return it2->second.values.size();
+    }
+
     virtual bool knownColumn(const ColumnPath & column) const
     {
         return index->columnInfo.count(column);
@@ -674,6 +693,166 @@ struct BehaviorMatrixView: public MatrixView {
 };
 
 
+/*****************************************************************************/
+/* BEHAVIOR STATS INDEX                                                     */
+/*****************************************************************************/
+
+/** Table of the per-behavior statistics the format maintains: one row
+    per behavior, with the decoded column and value plus the subject
+    count and time range.  Everything is answered from getBehaviorStats,
+    so no posting list is ever decoded.
+*/
+struct BehaviorStatsIndex: public MatrixView, public ColumnIndex {
+    BehaviorStatsIndex(std::shared_ptr<BehaviorDomain> behs)
+        : behs(behs)
+    {
+        auto hashes = behs->allBehaviorHashes(true /* sorted */);
+        behsSorted.reserve(hashes.size());
+        rowNames.reserve(hashes.size());
+        for (BH beh: hashes) {
+            RowPath name(PathElement(behs->getBehaviorId(beh).toString()));
+            rowIndex[RowHash(name)] = behsSorted.size();
+            behsSorted.push_back(beh);
+            rowNames.emplace_back(std::move(name));
+        }
+
+        columnNames.emplace_back(PathElement("column"));
+        columnNames.emplace_back(PathElement("value"));
+        columnNames.emplace_back(PathElement("subjectCount"));
+        columnNames.emplace_back(PathElement("earliest"));
+        columnNames.emplace_back(PathElement("latest"));
+    }
+
+    std::shared_ptr<BehaviorDomain> behs;
+    std::vector<BH> behsSorted;
+    std::vector<RowPath> rowNames;
+    std::unordered_map<RowHash, size_t> rowIndex;
+    std::vector<ColumnPath> columnNames;
+
+    std::vector<std::tuple<ColumnPath, CellValue, Date> >
+    statsRow(BH beh) const
+    {
+        auto stats = behs->getBehaviorStats(beh, BehaviorDomain::BS_ALL);
+
+        ColumnPath columnName;
+        CellValue cellValue;
+        std::tie(columnName, cellValue)
+            = behaviors::decodeColumn(stats.id, true /* could be legacy */);
+
+        std::vector<std::tuple<ColumnPath, CellValue, Date> > result;
+        result.emplace_back(columnNames[0],
+                            columnName.toUtf8String(), stats.latest);
+        result.emplace_back(columnNames[1], cellValue, stats.latest);
+        result.emplace_back(columnNames[2],
+                            (uint64_t)stats.subjectCount, stats.latest);
+        result.emplace_back(columnNames[3], stats.earliest, stats.earliest);
+        result.emplace_back(columnNames[4], stats.latest, stats.latest);
+        return result;
+    }
+
+    virtual std::vector<RowPath>
+    getRowPaths(ssize_t start = 0, ssize_t limit = -1) const
+    {
+        auto result = rowNames;
+        return applyOffsetLimit(start, limit, result);
+    }
+
+    virtual std::vector<RowHash>
+    getRowHashes(ssize_t start = 0, ssize_t limit = -1) const
+    {
+        std::vector<RowHash> result;
+        result.reserve(rowNames.size());
+        for (auto & name: rowNames)
+            result.emplace_back(name);
+        return applyOffsetLimit(start, limit, result);
+    }
+
+    virtual uint64_t getRowCount() const
+    {
+        return rowNames.size();
+    }
+
+    virtual bool knownRow(const RowPath & rowName) const
+    {
+        return rowIndex.count(RowHash(rowName));
+    }
+
+    virtual MatrixNamedRow getRow(const RowPath & rowName) const
+    {
+        auto it = rowIndex.find(RowHash(rowName));
+        if (it == rowIndex.end())
+            throw MLDB::Exception("unknown behavior row '"
+                                  + rowName.toUtf8String().rawString() + "'");
+
+        MatrixNamedRow result;
+        result.rowName = rowNames[it->second];
+        result.rowHash = result.rowName;
+        result.columns = statsRow(behsSorted[it->second]);
+        return result;
+    }
+
+    virtual RowPath getRowPath(const RowHash & rowHash) const
+    {
+        auto it = rowIndex.find(rowHash);
+        if (it == rowIndex.end())
+            throw MLDB::Exception("unknown behavior row hash");
+        return rowNames[it->second];
+    }
+
+    virtual bool knownColumn(const ColumnPath & column) const
+    {
+        for (auto & c: columnNames)
+            if (c == column)
+                return true;
+        return false;
+    }
+
+    virtual ColumnPath getColumnPath(ColumnHash column) const
+    {
+        for (auto & c: columnNames)
+            if (ColumnHash(c) == column)
+                return c;
+        throw MLDB::Exception("couldn't find column %s in behavior stats "
+                              "table", column.toString().c_str());
+    }
+
+    virtual std::vector<ColumnPath>
+    getColumnPaths(ssize_t offset, ssize_t limit) const
+    {
+        auto result = columnNames;
+        return applyOffsetLimit(offset, limit, result);
+    }
+
+    virtual size_t getColumnCount() const
+    {
+        return columnNames.size();
+    }
+
+    virtual MatrixColumn getColumn(const ColumnPath & column) const
+    {
+        int index = -1;
+        for (size_t i = 0;  i < columnNames.size();  ++i)
+            if (columnNames[i] == column)
+                index = i;
+        if (index == -1)
+            throw MLDB::Exception("unknown column '"
+                                  + column.toUtf8String().rawString()
+                                  + "' in behavior stats table");
+
+        MatrixColumn result;
+        result.columnName = column;
+        result.columnHash = column;
+        for (size_t i = 0;  i < behsSorted.size();  ++i) {
+            auto row = statsRow(behsSorted[i]);
+            result.rows.emplace_back(rowNames[i],
+                                     std::move(std::get<1>(row[index])),
+                                     std::get<2>(row[index]));
+        }
+        return result;
+    }
+};
+
+
 /*****************************************************************************/
 /* BEHAVIOR DATASET                                                         */
 /*****************************************************************************/
@@ -755,6 +934,139 @@ getColumnIndex() const
     return columns;
 }
 
+namespace {
+
+/* The grouped executor names each output row after the JSON printout of
+   its group key tuple; reproduce that exactly so index-only answers are
+   indistinguishable from scanned ones. */
+RowPath groupKeyRowPath(const std::vector<ExpressionValue> & groupKey)
+{
+    static VectorDescription<ExpressionValue>
+        desc(getExpressionValueDescriptionNoTimestamp());
+
+    std::string printed;
+    printed.reserve(116);
+    StringJsonPrintingContext context(printed);
+    context.writeUtf8 = true;
+    desc.printJsonTyped(&groupKey, context);
+
+    return PathElement(printed);
+}
+
+/* Match a select of the shape count(*) (or count of any non-null
+   constant), returning the name of the output column, or an empty path
+   for any other shape. */
+ColumnPath matchCountAllSelect(const SelectExpression & select)
+{
+    if (select.clauses.size() != 1)
+        return ColumnPath();
+    auto named = std::dynamic_pointer_cast<NamedColumnExpression>
+        (select.clauses[0]);
+    if (!named || named->alias.empty())
+        return ColumnPath();
+    auto call = std::dynamic_pointer_cast<FunctionCallExpression>
+        (named->expression);
+    if (!call || !call->tableName.empty() || call->functionName != "count"
+        || call->args.size() != 1)
+        return ColumnPath();
+    if (!call->args[0]->isConstant()
+        || call->args[0]->constantValue().empty())
+        return ColumnPath();
+    return named->alias;
+}
+
+} // file scope
+
+std::vector<MatrixNamedRow>
+BehaviorDataset::
+queryStructured(const SelectExpression & select,
+                const WhenExpression & when,
+                const SqlExpression & where,
+                const OrderByExpression & orderBy,
+                const TupleExpression & groupBy,
+                const std::shared_ptr<SqlExpression> having,
+                const std::shared_ptr<SqlExpression> rowName,
+                ssize_t offset,
+                ssize_t limit,
+                Utf8String alias) const
+{
+    auto fallback = [&] ()
+        {
+            return Dataset::queryStructured(select, when, where, orderBy,
+                                            groupBy, having, rowName,
+                                            offset, limit, alias);
+        };
+
+    // Only plain COUNT shapes with default row naming can be answered
+    // from the statistics the format maintains
+    if (!where.isConstantTrue()
+        || !when.when || !when.when->isConstantTrue()
+        || !having || !having->isConstantTrue()
+        || !orderBy.clauses.empty()
+        || !rowName
+        || (rowName->surface != "rowPath()" && rowName->surface != "rowName()"))
+        return fallback();
+
+    ColumnPath countName = matchCountAllSelect(select);
+    if (countName.empty())
+        return fallback();
+
+    std::vector<MatrixNamedRow> result;
+
+    auto addGroup = [&] (std::vector<ExpressionValue> groupKey,
+                         uint64_t count)
+        {
+            MatrixNamedRow row;
+            row.rowName = groupKeyRowPath(groupKey);
+            row.rowHash = row.rowName;
+            row.columns.emplace_back(countName, CellValue(count),
+                                     Date::negativeInfinity());
+            result.emplace_back(std::move(row));
+        };
+
+    if (groupBy.clauses.empty()) {
+        // SELECT count(*): the subject count is maintained by the format
+        addGroup({}, behs->subjectCount());
+        return applyOffsetLimit(offset, limit, result);
+    }
+
+    if (groupBy.clauses.size() != 1)
+        return fallback();
+    auto readColumn = std::dynamic_pointer_cast<ReadColumnExpression>
+        (groupBy.clauses[0]);
+    if (!readColumn)
+        return fallback();
+
+    auto it = columns->index->columnInfo.find(readColumn->columnName);
+    if (it == columns->index->columnInfo.end())
+        return fallback();
+
+    // Only a column backed by a single behavior provably gives each
+    // subject at most one value for it, which is what makes the
+    // per-behavior subject count equal to the SQL group count.
+    // Multi-valued columns fall back to scanning.
+    const BehaviorColumnInfo & info = it->second;
+    if (info.values.size() != 1
+        || info.values.begin()->second.itl.size() != 1)
+        return fallback();
+
+    uint64_t withValue
+        = behs->getBehaviorSubjectCount(info.values.begin()->second.itl[0]);
+    uint64_t total = behs->subjectCount();
+
+    // The null group (subjects without the column) sorts first, like in
+    // the scanned execution
+    if (total > withValue)
+        addGroup({ ExpressionValue::null(Date::negativeInfinity()) },
+                 total - withValue);
+    if (withValue > 0)
+        addGroup({ ExpressionValue(info.values.begin()->first,
+                                   Date::negativeInfinity()) },
+                 withValue);
+
+    return applyOffsetLimit(offset, limit, result);
+}
+
 struct BehaviorDatasetRowStream : public MLDB::RowStream
 {
     BehaviorDatasetRowStream(std::shared_ptr<const BehaviorDomain> source)
@@ -1009,6 +1321,70 @@ commit()
     matrix = std::make_shared<BehaviorMatrixView>(behs, columns->index);
 }
 
+/*****************************************************************************/
+/* BEHAVIOR STATS DATASET                                                   */
+/*****************************************************************************/
+
+BehaviorStatsDataset::
+BehaviorStatsDataset(MldbEngine * owner,
+                     PolyConfig config,
+                     const ProgressFunc & onProgress)
+    : Dataset(owner)
+{
+    ExcAssert(!config.id.empty());
+
+    auto params = config.params.convert<BehaviorDatasetConfig>();
+
+    behs = behManager.get(params.dataFileUrl.toString(),
+                          BehaviorManager::CACHE_CONFIG,
+                          nullptr /*onProgress*/);
+
+    index = std::make_shared<BehaviorStatsIndex>(behs);
+}
+
+BehaviorStatsDataset::
+~BehaviorStatsDataset()
+{
+}
+
+Any
+BehaviorStatsDataset::
+getStatus() const
+{
+    Json::Value result;
+    result["rowCount"] = behs->behaviorCount();
+    result["subjectCount"] = behs->subjectCount();
+    return result;
+}
+
+std::shared_ptr<MatrixView>
+BehaviorStatsDataset::
+getMatrixView() const
+{
+    return index;
+}
+
+std::shared_ptr<ColumnIndex>
+BehaviorStatsDataset::
+getColumnIndex() const
+{
+    return index;
+}
+
+std::pair<Date, Date>
+BehaviorStatsDataset::
+getTimestampRange() const
+{
+    return { behs->earliestTime(), behs->latestTime() };
+}
+
+Date
+BehaviorStatsDataset::
+quantizeTimestamp(Date timestamp) const
+{
+    return behs->unQuantizeTime(behs->quantizeTime(timestamp));
+}
+
 namespace {
 
 RegisterDatasetType<BehaviorDataset, BehaviorDatasetConfig>
@@ -1023,6 +1399,14 @@ regMutableBeh(builtinPackage(),
               "Recordable dataset designed to store behavioral data",
               "datasets/MutableBehaviorDataset.md.html");
 
+RegisterDatasetType<BehaviorStatsDataset, BehaviorDatasetConfig>
+regBehStats(builtinPackage(),
+            "beh.stats",
+            "Read-only table of the per-behavior statistics maintained "
+            "by a behavior file: one row per behavior with its decoded "
+            "column and value, subject count and time range",
+            "datasets/BehaviorDataset.md.html");
+
 } // file scope
 
 } // namespace MLDB
@@ -16,6 +16,7 @@ struct MutableBehaviorDomain;
 struct BehaviorManager;
 class BehaviorColumnIndex;
 class BehaviorMatrixView;
+struct BehaviorStatsIndex;
 
 // Static instance of a behavior manager, shared between all beh datasets
 // in behavior_dataset.cc
@@ -66,12 +67,68 @@ struct BehaviorDataset: public Dataset {
     virtual std::pair<Date, Date> getTimestampRange() const;
     virtual Date quantizeTimestamp(Date timestamp) const;
 
+    /** Answers COUNT shapes (with and without GROUP BY) from the
+        per-behavior statistics kept by the format when that is provably
+        equivalent to scanning; everything else goes through the generic
+        implementation.
+    */
+    virtual std::vector<MatrixNamedRow>
+    queryStructured(const SelectExpression & select,
+                    const WhenExpression & when,
+                    const SqlExpression & where,
+                    const OrderByExpression & orderBy,
+                    const TupleExpression & groupBy,
+                    const std::shared_ptr<SqlExpression> having,
+                    const std::shared_ptr<SqlExpression> rowName,
+                    ssize_t offset,
+                    ssize_t limit,
+                    Utf8String alias = "") const;
+
 private:
     std::shared_ptr<BehaviorDomain> behs;
     std::shared_ptr<BehaviorColumnIndex> columns;
     std::shared_ptr<BehaviorMatrixView> matrix;
 };
 
+
+/*****************************************************************************/
+/* BEHAVIOR STATS DATASET                                                   */
+/*****************************************************************************/
+
+/** Read-only dataset exposing the per-behavior statistics that the
+    behavior format already maintains (subject counts and time ranges)
+    as a table the SQL layer can query directly.  One row per behavior,
+    so monitoring queries are O(behaviors) instead of decoding every
+    posting list.
+*/
+struct BehaviorStatsDataset: public Dataset {
+
+    BehaviorStatsDataset(MldbEngine * owner,
+                         PolyConfig config,
+                         const ProgressFunc & onProgress);
+
+    virtual ~BehaviorStatsDataset();
+
+    virtual Any getStatus() const;
+
+    virtual void recordRowItl(const RowPath & rowName,
+          const std::vector<std::tuple<ColumnPath, CellValue, Date> > & vals)
+    {
+        throw MLDB::Exception("Dataset type doesn't allow recording");
+    }
+
+    virtual std::shared_ptr<MatrixView> getMatrixView() const;
+
+    virtual std::shared_ptr<ColumnIndex> getColumnIndex() const;
+
+    virtual std::pair<Date, Date> getTimestampRange() const;
+    virtual Date quantizeTimestamp(Date timestamp) const;
+
+private:
+    std::shared_ptr<BehaviorDomain> behs;
+    std::shared_ptr<BehaviorStatsIndex> index;
+};
+
 /*****************************************************************************/
 /* MUTABLE BEHAVIOR DATASET CONFIG                                          */
 /*****************************************************************************/
@@ -20,6 +20,7 @@
 #include "mapped_behavior_domain.h"
 #include "mldb/types/db/persistent.h"
 #include "mldb/base/parallel.h"
+#include "mldb/base/thread_pool.h"
 #include <boost/shared_array.hpp>
 #include "mldb/base/map_reduce.h"
 #include "mldb/types/jml_serialization.h"
@@ -276,7 +277,13 @@ save(const std::string & filename,
        post-destruction. */
     bool good(false);
     auto onExit = ScopeExit([&] () noexcept { if (!good) { cerr << "bad" << endl;  tryEraseUriObject(filename); }});
-    filter_ostream stream(filename);
+
+    // Compress blocks in parallel; serialization of the subject data is
+    // already parallel, so a serial compressor would dominate the save
+    // time for compressed filenames.
+    filter_ostream stream(filename,
+                          { { "compressionThreads",
+                              std::to_string(numCpus()) } });
     saveToStream(stream, maxSubjectBehaviors);
     stream.close();
     cerr << "finished writing" << endl;
@@ -1116,6 +1123,42 @@ serialize(DB::Store_Writer & store, ssize_t maxSubjectBehaviors)
         t.restart();
     }
 
+    // Bloom filter over the subject hashes.  A merged domain probes every
+    // constituent file for each subject lookup; the filter lets files
+    // that don't contain the subject answer without touching the index.
+    while (store.offset() % 8 != 0)
+        store << '\0';
+
+    uint64_t subjectBloomOffset = store.offset();
+    uint64_t subjectBloomWords;
+    {
+        uint64_t numBits = 64;
+        while (numBits < (uint64_t)index.size()
+                         * MappedBehaviorDomain::SUBJECT_BLOOM_BITS_PER_ENTRY)
+            numBits *= 2;
+        subjectBloomWords = numBits / 64;
+
+        std::vector<uint64_t> bloom(subjectBloomWords, 0);
+        uint64_t mask = numBits - 1;
+        for (auto & entry: index) {
+            uint64_t h1 = SH(entry.key).hash();
+            uint64_t h2 = (h1 >> 32) | 1;
+            for (int p = 0;  p < MappedBehaviorDomain::SUBJECT_BLOOM_PROBES;
+                 ++p) {
+                uint64_t bit = (h1 + p * h2) & mask;
+                bloom[bit / 64] |= uint64_t(1) << (bit % 64);
+            }
+        }
+
+        store.save_binary(bloom.data(), subjectBloomWords * 8);
+    }
+
+    if (debug) {
+        cerr << "finished writing subject bloom filter at " << t.elapsed()
+             << endl;
+        t.restart();
+    }
+
     int numSubjectBits = MLDB::highest_bit(index.size() - 1, -1) + 1;
 
     struct BehaviorEntryToWrite {
@@ -1432,6 +1475,8 @@ serialize(DB::Store_Writer & store, ssize_t maxSubjectBehaviors)
     metadata.idSpaceDeprecated = 0;
     metadata.fileMetadataOffset = fileMetadataOffset;
     metadata.totalEventsRecorded = totalEventsRecorded;
+    metadata.subjectBloomOffset = subjectBloomOffset;
+    metadata.subjectBloomWords = subjectBloomWords;
 
     store.save_binary(metadata);
 
@@ -0,0 +1,194 @@
+/** behavior_event_export_procedure.cc
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Procedure that exports the raw events of a behavior file into a
+    tabular dataset, one row per event.
+*/
+
+#include "behavior_event_export_procedure.h"
+#include "behavior_dataset.h"  // for behManager
+#include "behavior_manager.h"
+#include "behavior_domain.h"
+#include "behavior_utils.h"
+#include "mldb/core/recorder.h"
+#include "mldb/base/parallel.h"
+#include "mldb/base/per_thread_accumulator.h"
+#include "mldb/utils/lightweight_hash.h"
+#include "mldb/types/basic_value_descriptions.h"
+#include "mldb/types/any_impl.h"
+
+using namespace std;
+
+
+namespace MLDB {
+
+using namespace behaviors;
+
+
+/*****************************************************************************/
+/* BEHAVIOR EVENT EXPORT PROCEDURE CONFIG                                    */
+/*****************************************************************************/
+
+DEFINE_STRUCTURE_DESCRIPTION(BehaviorEventExportProcedureConfig);
+
+BehaviorEventExportProcedureConfigDescription::
+BehaviorEventExportProcedureConfigDescription()
+{
+    addField("dataFileUrl",
+             &BehaviorEventExportProcedureConfig::dataFileUrl,
+             "URL of the behavior file (with extension '.beh') from which "
+             "the events are read.");
+    addField("outputDataset",
+             &BehaviorEventExportProcedureConfig::outputDataset,
+             "Dataset that the events are recorded into.  One row is "
+             "recorded per event, with `subject`, `behavior`, `timestamp` "
+             "and `count` columns.",
+             PolyConfigT<Dataset>().withType("tabular"));
+    addParent<ProcedureConfig>();
+}
+
+
+/*****************************************************************************/
+/* BEHAVIOR EVENT EXPORT PROCEDURE                                           */
+/*****************************************************************************/
+
+BehaviorEventExportProcedure::
+BehaviorEventExportProcedure(MldbEngine * owner,
+                             PolyConfig config,
+                             const std::function<bool (const Json::Value &)> & onProgress)
+    : Procedure(owner)
+{
+    this->procConfig = config.params.convert<BehaviorEventExportProcedureConfig>();
+}
+
+Any
+BehaviorEventExportProcedure::
+getStatus() const
+{
+    return Any();
+}
+
+RunOutput
+BehaviorEventExportProcedure::
+run(const ProcedureRunConfig & run,
+    const std::function<bool (const Json::Value &)> & onProgress) const
+{
+    auto runProcConf = applyRunConfOverProcConf(procConfig, run);
+
+    auto behs = behManager.get(runProcConf.dataFileUrl.toString(),
+                               BehaviorManager::CACHE_CONFIG,
+                               nullptr /*onProgress*/);
+
+    auto output = createDataset(engine, runProcConf.outputDataset,
+                                nullptr, true /* overwrite */);
+
+    if (!output) {
+        throw MLDB::Exception("Unable to obtain output dataset");
+    }
+
+    // Decode each behavior ID exactly once up front; every event of a
+    // behavior then reuses the same cell instead of re-reading the ID
+    // store and re-constructing a CellValue per event.
+    std::vector<BH> allBehs = behs->allBehaviorHashes();
+    LightweightHash<BH, int> behToIndex;
+    std::vector<CellValue> behCells;
+    behCells.reserve(allBehs.size());
+    for (unsigned i = 0;  i < allBehs.size();  ++i) {
+        behToIndex[allBehs[i]] = i;
+        behCells.emplace_back(behs->getBehaviorId(allBehs[i]).toUtf8String());
+    }
+
+    std::vector<SH> allSubjects = behs->allSubjectHashes();
+
+    const std::vector<ColumnPath> columnNames
+        = { ColumnPath("subject"), ColumnPath("behavior"),
+            ColumnPath("timestamp"), ColumnPath("count") };
+
+    // Each thread records into its own chunk of the output dataset through
+    // the specialized tabular recorder, so the pre-typed cells go straight
+    // into the chunk columns without per-event column name handling.
+    Dataset::MultiChunkRecorder recorder = output->getChunkRecorder();
+
+    struct ThreadAccum {
+        /// Recorder object for this thread that the dataset gives us
+        /// to record into the dataset.
+        std::unique_ptr<Recorder> threadRecorder;
+
+        /// Function specialized to record our fixed set of columns.
+        std::function<void (RowPath rowName,
+                            Date timestamp,
+                            CellValue * vals,
+                            size_t numVals,
+                            std::vector<std::pair<ColumnPath, CellValue> > extra)>
+        specializedRecorder;
+    };
+
+    PerThreadAccumulator<ThreadAccum> accum;
+
+    std::atomic<size_t> chunkNumber(0);
+
+    auto onSubject = [&] (size_t i)
+        {
+            auto & threadAccum = accum.get();
+            if (!threadAccum.threadRecorder) {
+                threadAccum.threadRecorder
+                    = recorder.newChunk(chunkNumber.fetch_add(1));
+                threadAccum.specializedRecorder
+                    = threadAccum.threadRecorder
+                    ->specializeRecordTabular(columnNames);
+            }
+
+            SH subj = allSubjects[i];
+            PathElement subjectName = toPathElement(behs->getSubjectId(subj));
+            CellValue subjectCell(subjectName.toUtf8String());
+
+            size_t n = 0;
+            auto onBeh = [&] (BH beh, Date ts, uint32_t count)
+                {
+                    auto it = behToIndex.find(beh);
+                    if (it == behToIndex.end())
+                        return true;
+
+                    CellValue vals[4];
+                    vals[0] = subjectCell;
+                    vals[1] = behCells[it->second];
+                    vals[2] = CellValue(ts);
+                    vals[3] = CellValue(count);
+
+                    threadAccum.specializedRecorder
+                        (subjectName + PathElement(n++), ts, vals, 4, {});
+                    return true;
+                };
+
+            behs->forEachSubjectBehaviorHash(subj, onBeh, EventFilter(),
+                                             ANYORDER);
+        };
+
+    parallelMap(0, allSubjects.size(), onSubject);
+
+    // Finish off the last bits of each thread
+    parallelMap(0, accum.threads.size(),
+                [&] (size_t n)
+                {
+                    auto & threadAccum = *accum.threads[n];
+                    ExcAssert(threadAccum.threadRecorder.get());
+                    threadAccum.threadRecorder->finishedChunk();
+                });
+
+    output->commit();
+
+    return RunOutput();
+}
+
+
+namespace {
+
+RegisterProcedureType<BehaviorEventExportProcedure,
+                      BehaviorEventExportProcedureConfig>
+regBehEventExport(builtinPackage(),
+                  "Export the events of a behavior file as one row per event",
+                  "procedures/BehaviorEventExportProcedure.md.html");
+
+} // file scope
+
+} // namespace MLDB
@@ -0,0 +1,60 @@
+/** behavior_event_export_procedure.h                              -*- C++ -*-
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Procedure that exports the raw events of a behavior file into a
+    tabular dataset, one row per event.
+*/
+
+#pragma once
+
+#include "types/value_description_fwd.h"
+#include "core/mldb_engine.h"
+#include "mldb/core/procedure.h"
+#include "mldb/core/dataset.h"
+#include "mldb/types/url.h"
+
+
+namespace MLDB {
+
+
+/*****************************************************************************/
+/* BEHAVIOR EVENT EXPORT PROCEDURE CONFIG                                    */
+/*****************************************************************************/
+
+struct BehaviorEventExportProcedureConfig : public ProcedureConfig {
+    static constexpr const char * name = "beh.exportEvents";
+
+    BehaviorEventExportProcedureConfig()
+    {
+        outputDataset.withType("tabular");
+    }
+
+    /// URL of the behavior file from which the events are read
+    Url dataFileUrl;
+
+    /// Dataset that the events are exported into
+    PolyConfigT<Dataset> outputDataset;
+};
+
+DECLARE_STRUCTURE_DESCRIPTION(BehaviorEventExportProcedureConfig);
+
+
+/*****************************************************************************/
+/* BEHAVIOR EVENT EXPORT PROCEDURE                                           */
+/*****************************************************************************/
+
+struct BehaviorEventExportProcedure: public Procedure {
+
+    BehaviorEventExportProcedure(MldbEngine * owner,
+                                 PolyConfig config,
+                                 const std::function<bool (const Json::Value &)> & onProgress);
+
+    virtual RunOutput run(const ProcedureRunConfig & run,
+                          const std::function<bool (const Json::Value &)> & onProgress) const;
+
+    virtual Any getStatus() const;
+
+    BehaviorEventExportProcedureConfig procConfig;
+};
+
+} // namespace MLDB
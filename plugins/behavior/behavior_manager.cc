@@ -37,6 +37,7 @@
 #include "mldb/vfs/filter_streams.h"
 #include "mldb/base/scope.h"
 #include "mldb/base/parallel.h"
+#include "mldb/base/thread_pool.h"
 #include "mldb/types/date.h"
 #include "mldb/vfs/fs_utils.h"
 #include "mldb/base/scope.h"
@@ -848,7 +849,12 @@ save(BehaviorDomain & behs,
 {
     if (filename == "") return;
 
-    filter_ostream stream(filename);
+    // Compress blocks in parallel on the worker threads; the subject
+    // serialization upstream is already parallel, so a serial compressor
+    // would otherwise be the bottleneck for large files.
+    filter_ostream stream(filename,
+                          { { "compressionThreads",
+                              std::to_string(numCpus()) } });
     behs.saveToStream(stream);
 }
 
@@ -13,6 +13,7 @@
 #include "mldb/types/db/persistent.h"
 #include "mldb/utils/distribution_simd.h"
 #include "mldb/utils/distribution_ops.h"
+#include "mldb/utils/compute_provider.h"
 #include "mldb/utils/vector_utils.h"
 #include "mldb/arch/backtrace.h"
 #include "mldb/arch/timers.h"
@@ -607,18 +608,25 @@ calcDenseSvd()
      * n = ncol (y stores product vector).		              *
      **************************************************************/
 
+    // Flatten the overlap matrix so it can be handed to a compute
+    // provider (an accelerator when one is registered, otherwise SIMD
+    // over the thread pool); the Lanczos iteration applies it over and
+    // over, so this is where nearly all of the dense SVD time goes.
+    size_t n = numDenseBehaviors;
+    std::vector<float> overlapsFlat(n * n);
+    for (size_t i = 0;  i < n;  ++i)
+        std::copy(denseOverlaps[i].begin(), denseOverlaps[i].end(),
+                  &overlapsFlat[i * n]);
+
+    ComputeProvider & provider = bestComputeProvider();
+    cerr << "dense SVD multiplications running on " << provider.name()
+         << endl;
+
     auto opb_fn = [&] (double *x, double *y)
     {
-        int ncols = numDenseBehaviors;
-        for (unsigned i = 0; i != ncols; i++) {
-            double yval = 0.0;
-            for (unsigned j = 0; j != ncols; j++)
-                yval += denseOverlaps[i][j] * x[j];
-
-            y[i] = yval;
-        }
+        provider.denseMatVec(overlapsFlat.data(), n, x, y);
     };
-    
+
     SVDParams params;
     params.opb = opb_fn;
     params.ierr = 0;
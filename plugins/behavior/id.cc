@@ -157,6 +157,24 @@ MLDB_ALWAYS_INLINE int base64ToDec(unsigned c)
     return base64ToDecLookups[c & 0x7f] * mask - 1 + mask;
 }
 
+// Alphabet used by the GOOG128 IDs: 0-9, A-Z, a-z, '-', '_' in that order
+static const signed char goog64ToDecLookups[128] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+    25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, -1, -1, -1, -1, 63,
+    -1, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50,
+    51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1
+};
+
+MLDB_ALWAYS_INLINE int goog64ToDec(unsigned c)
+{
+    int mask = (c <= 0x7f);
+    return goog64ToDecLookups[c & 0x7f] * mask - 1 + mask;
+}
+
 inline int hexToDec3(int c)
 {
     int d = c & 0x1f;
@@ -251,40 +269,22 @@ parse(const char * value, size_t len, Type type)
         unsigned long long f5;
 
         const char * p = value;
-        bool failed = false;
-        int capsType = -1; // -1 = unknown, 0 = no, 1 = yes
+
+        // Branchless scan: failures and the case classes seen accumulate
+        // in masks that are tested once at the end, so the loop body has
+        // no data-dependent branches and vectorizes.
+        int bad = 0;
+        int lowerSeen = 0, upperSeen = 0;
 
         auto scanRange = [&] (int start, int len) -> unsigned long long
             {
                 unsigned long long val = 0;
                 for (unsigned i = start;  i != start + len;  ++i) {
-                    int c = p[i];
-                    {
-                        // case handling
-                        if (c >= 'a' && c <= 'f') {
-                            if (capsType == -1) {
-                                capsType = 0;
-                            }
-                            else if (capsType != 0) {
-                                failed = true;
-                                return val;
-                            }
-                        }
-                        else if (c >= 'A' && c <= 'F') {
-                            if (capsType == -1) {
-                                capsType = 1;
-                            }
-                            else if (capsType != 1) {
-                                failed = true;
-                                return val;
-                            }
-                        }
-                    }
+                    unsigned c = p[i];
+                    lowerSeen |= (c >= 'a') & (c <= 'f');
+                    upperSeen |= (c >= 'A') & (c <= 'F');
                     int v = hexToDec(c);
-                    if (v == -1) {
-                        failed = true;
-                        return val;
-                    }
+                    bad |= v;  // sign bit sticks if any v == -1
                     val = (val << 4) + v;
                 }
                 return val;
@@ -293,12 +293,13 @@ parse(const char * value, size_t len, Type type)
         f1 = scanRange(0, 8);
         f2 = scanRange(9, 4);
         f3 = scanRange(14, 4);
-        if (failed) break;
         f4 = scanRange(19, 4);
         f5 = scanRange(24, 12);
-        if (failed) break;
 
-        r.type = capsType == 1 ? UUID_CAPS : UUID;
+        if (bad < 0) break;
+        if (lowerSeen && upperSeen) break;  // mixed case isn't a UUID
+
+        r.type = upperSeen ? UUID_CAPS : UUID;
         r.f1 = f1;  r.f2 = f2;  r.f3 = f3;  r.f4 = f4;  r.f5 = f5;
         finish();
         return;
@@ -312,29 +313,14 @@ parse(const char * value, size_t len, Type type)
 
         auto res = make128(0, 0);
 
-        auto b64Decode = [] (int c) -> int
-            {
-                if (c >= '0' && c <= '9')
-                    return c - '0';
-                else if (c >= 'A' && c <= 'Z')
-                    return 10 + c - 'A';
-                else if (c >= 'a' && c <= 'z')
-                    return 36 + c - 'a';
-                else if (c == '-')
-                    return 62;
-                else if (c == '_')
-                    return 63;
-                else return -1;
-            };
-
-        bool error = false;
-        for (unsigned i = 5;  i < 26 && !error;  ++i) {
-            int v = b64Decode(value[i]);
-            if (v == -1) error = true;
-            res = (res << 6) | v;
+        int bad = 0;
+        for (unsigned i = 5;  i < 26;  ++i) {
+            int v = goog64ToDec(value[i]);
+            bad |= v;
+            res = (res << 6) | (v & 63);
         }
 
-        if (!error) {
+        if (bad >= 0) {
             r.type = GOOG128;
             r.valLow = getLow(res);
             r.valHigh = getHigh(res);
@@ -391,12 +377,13 @@ parse(const char * value, size_t len, Type type)
         auto scanRange = [&] (const char * p, size_t l) -> uint64_t
             {
                 uint64_t res = 0;
+                int bad = 0;
                 for (unsigned i = 0;  i < l;  ++i) {
                     int c = base64ToDec(p[i]);
-                    if (c == -1) return NONE;
-                    res = res << 6 | c;
+                    bad |= c;
+                    res = res << 6 | (c & 63);
                 }
-                return res;
+                return bad < 0 ? NONE : res;
             };
         
         uint64_t high = scanRange(value, 8);
@@ -418,34 +405,22 @@ parse(const char * value, size_t len, Type type)
         uint64_t high, low;
 
         const char * p = value;
-        bool failed = false;
+        int bad = 0;
 
         auto scanRange = [&] (int start, int len) -> unsigned long long
             {
                 uint64_t val = 0;
                 for (unsigned i = start;  i != start + len;  ++i) {
-                    int c = p[i];
-                    int v = hexToDec(c);
-
-                    //cerr << "c = " << c << " " << p[i] << " v = " << v << endl;
-
-                    if (v == -1) {
-                        failed = true;
-                        return val;
-                    }
+                    int v = hexToDec((unsigned char)p[i]);
+                    bad |= v;
                     val = (val << 4) + v;
                 }
-
-                //cerr << "val = " << val << " failed = " << failed << endl;
-
                 return val;
             };
 
         high = scanRange(0, 16);
-        if (failed)
-            break;
         low = scanRange(16, 16);
-        if (failed)
+        if (bad < 0)
             break;
 
         r.type = HEX128LC;
@@ -481,6 +456,26 @@ parse(const char * value, size_t len, Type type)
     return;
 }
 
+void
+Id::
+parseBatch(const char * const * strs,
+           const size_t * lens,
+           size_t n,
+           Id * out,
+           Type type)
+{
+    for (size_t i = 0;  i < n;  ++i)
+        out[i].parse(strs[i], lens[i], type);
+}
+
+void
+Id::
+hashBatch(const Id * ids, size_t n, uint64_t * hashes)
+{
+    for (size_t i = 0;  i < n;  ++i)
+        hashes[i] = ids[i].hash();
+}
+
 const Id &
 Id::
 compoundId1() const
@@ -179,7 +179,23 @@ struct Id {
     {
         parse(value, std::strlen(value), type);
     }
-    
+
+    /** Parse a batch of identifier strings into out.  Equivalent to
+        calling parse() on each element, but amortizes the call overhead
+        over the batch for ingestion paths that decode IDs in bulk.
+    */
+    static void parseBatch(const char * const * strs,
+                           const size_t * lens,
+                           size_t n,
+                           Id * out,
+                           Type type = UNKNOWN);
+
+    /** Hash a batch of ids into hashes.  Equivalent to calling hash()
+        on each element.
+    */
+    static void hashBatch(const Id * ids, size_t n, uint64_t * hashes);
+
+
     std::string toString() const;
 
     Utf8String toUtf8String() const;
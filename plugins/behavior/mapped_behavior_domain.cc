@@ -8,7 +8,9 @@
 
 #include "mapped_behavior_domain.h"
 #include "mldb/arch/bitops.h"
+#include "mldb/arch/vm.h"
 #include "mldb/base/exc_assert.h"
+#include "mldb/base/thread_pool.h"
 #include "mldb/arch/bit_range_ops.h"
 #include "mldb/types/db/persistent.h"
 #include "mldb/utils/vector_utils.h"
@@ -16,6 +18,7 @@
 #include "mldb/types/jml_serialization.h"
 #include "id_serialization.h"
 #include <boost/iterator/iterator_facade.hpp>
+#include <sys/mman.h>
 
 
 using namespace std;
@@ -34,6 +37,13 @@ namespace {
 
 using BitExtractor = Bit_Extractor<uint32_t, Bit_Buffer<uint32_t, Simple_Mem_Buffer<uint32_le>>>;
 
+/// Bytes occupied by a bit-packed array of len entries of the given
+/// width, stored in 32 bit words
+size_t bitArrayBytes(size_t len, int bits)
+{
+    return (len * bits + 31) / 32 * 4;
+}
+
 } // file scope
 
 /*****************************************************************************/
@@ -238,14 +248,16 @@ struct MappedBehaviorDomain::EventTable {
     uint64_t timeOffset;
 
     template<typename Fn>
-    bool forEachRaw(const Fn & onEntry, unsigned startAt = 0) const
+    bool forEachRaw(const Fn & onEntry, unsigned startAt = 0,
+                    unsigned endAt = (unsigned)-1) const
     {
         BitExtractor extractor = this->extractor;
 
         if (startAt)
             extractor.advance(startAt * (timeBits + behBits + cntBits));
 
-        for (unsigned i = startAt;  i < size_;  ++i) {
+        unsigned end = std::min<size_t>(endAt, size_);
+        for (unsigned i = startAt;  i < end;  ++i) {
             uint32_t time, behIndex, count;
             extractor.extract(time, timeBits,
                               behIndex, behBits,
@@ -327,6 +339,52 @@ struct MappedBehaviorDomain::EventTable {
         return size_;
     }
 
+    /** Return the index of the first event whose timestamp is strictly
+        after the given one.  Like lowerBoundTimestamp, relies on the
+        events being stored in nondecreasing timestamp order. */
+    uint32_t upperBoundTimestamp(Date ts, const TimestampTable & tst) const
+    {
+        uint32_t lower = 0, upper = size_;
+
+        for (;;) {
+            uint32_t range = upper - lower;
+
+            // Linear search if there is a small range
+            if (range <= 32) {
+                BitExtractor extractor = this->extractor;
+                extractor.advance(lower * (behBits + cntBits + timeBits));
+
+                for (unsigned i = lower;  i < upper;  ++i) {
+                    uint32_t time;
+                    extractor.extract(time, timeBits);
+
+                    if (tst.decode(time) > ts)
+                        return i;
+
+                    extractor.advance(behBits + cntBits);
+                }
+
+                return upper;
+            }
+
+            // Otherwise, binary search
+            uint32_t middle = (upper + lower) / 2;
+
+            BitExtractor extractor = this->extractor;
+            extractor.advance(middle * (behBits + cntBits + timeBits));
+
+            uint32_t time;
+            extractor.extract(time, timeBits);
+
+            if (tst.decode(time) > ts) {
+                upper = middle;
+            }
+            else {
+                lower = middle;
+            }
+        }
+    }
+
     template<typename Fn>
     bool forEach(const Fn & onEntry, Date earliest, Date latest) const
     {
@@ -345,10 +403,17 @@ struct MappedBehaviorDomain::EventTable {
 
         bool stopped = false;
 
+        // Both window edges are resolved by binary search, so the decode
+        // loop below runs over exactly the in-window block with no
+        // per-event timestamp comparisons
         uint32_t startAt = 0;
+        uint32_t endAt = size_;
         if (earliest.isADate()) {
             startAt = lowerBoundTimestamp(earliest, tst);
         }
+        if (latest.isADate() && startAt < endAt) {
+            endAt = upperBoundTimestamp(latest, tst);
+        }
 
         //cerr << "startAt = " << startAt << " earliest = " << earliest
         //     << " size_ = " << size_ << endl;
@@ -360,10 +425,6 @@ struct MappedBehaviorDomain::EventTable {
                 Date ts = tst.decode(time);
                 //cerr << "ts = " << ts << " earliest " << earliest << " latest " << latest << endl;
 
-                if (ts < earliest)  // skip forward since not at right time
-                    return true;
-                if (ts > latest)    // stop since we're after the required time
-                    return false;
                 ExcAssertLess(behIndex, behs.size());
                 BH beh = behs.beh(behIndex);
             
@@ -377,7 +438,7 @@ struct MappedBehaviorDomain::EventTable {
                 return res;
             };
 
-        forEachRaw(onEntry2, startAt);
+        forEachRaw(onEntry2, startAt, endAt);
 
         return !stopped;
     }
@@ -664,6 +725,15 @@ init(const File_Read_Buffer & file, uint64_t md_offset)
     }
     else fileMetadata_ = Json::Value();
 
+    // Bloom filter over subject hashes, written by newer files in one of
+    // the metadata expansion slots.  Older files leave the offset at zero
+    // and simply don't get the fast negative path.
+    if (md->subjectBloomOffset != 0) {
+        subjectBloom
+            = (const uint64_le *)(file.start() + md->subjectBloomOffset);
+        subjectBloomMask = md->subjectBloomWords * 64 - 1;
+    }
+
     /* Slicing the subject index in ranges of equal sizes enables us to
        alleviate the loss of performance (in the form of cache misses)
        occurring during lookups in "getSubjectIndex" in the case where the
@@ -786,11 +856,43 @@ makeDeepCopy() const
     return new MappedBehaviorDomain(*this);
 }
 
+void
+MappedBehaviorDomain::
+prefetchRegion(const void * start, size_t length) const
+{
+    if (length == 0)
+        return;
+
+    // madvise needs a page-aligned address; round the start down so the
+    // partial pages at either end are included.
+    const char * alignedStart
+        = (const char *)((size_t)start & ~(page_size - 1));
+    size_t alignedLength = (const char *)start + length - alignedStart;
+
+    // Keep the mapping alive until the hint has been issued.  The job
+    // must not throw; a failed madvise just means no readahead.
+    auto job = [region = file.region, alignedStart, alignedLength] ()
+        {
+            ::madvise((void *)alignedStart, alignedLength, MADV_WILLNEED);
+        };
+
+    ThreadPool::instance().add(std::move(job));
+}
+
 bool
 MappedBehaviorDomain::
 forEachSubject(const OnSubject & onSubject,
                const SubjectFilter & filter) const
 {
+    // A full scan touches the whole subject index; start paging it in
+    // behind the loop on a cold mapping.
+    if (indexV1())
+        prefetchRegion(subjectIndex1.begin(),
+                       subjectIndex1.size() * sizeof(*subjectIndex1.begin()));
+    else
+        prefetchRegion(subjectIndex2.begin(),
+                       subjectIndex2.size() * sizeof(*subjectIndex2.begin()));
+
     for (unsigned i = 0;  i < subjectCount();  ++i) {
         SubjectIterInfo info;
         if (!onSubject(getSubjectHash(SI(i)), info))
@@ -1287,6 +1389,11 @@ int64_t
 MappedBehaviorDomain::
 getSubjectIndexImpl(SH subj) const
 {
+    // Cheap definitive negative for subjects this file doesn't contain;
+    // pays off when many files are probed for each subject (eg from a
+    // MergedBehaviorDomain).
+    if (!subjectBloomContains(subj))
+        return -1;
     if (indexV1())
         return getSubjectIndexImplTmpl(subj, subjectIndex1);
     else
@@ -1417,6 +1524,9 @@ getSubjectHashes(BI beh, SH maxSubject, bool sorted) const
     int len = getBehaviorSubjectCount(beh);
     int numSubjectBits = MLDB::highest_bit(md->numSubjects - 1, -1) + 1;
 
+    // Page the subject list in behind the decode loop
+    prefetchRegion(data, bitArrayBytes(len, numSubjectBits));
+
     BitExtractor extractor(data);
 
     vector<SH> result;
@@ -1496,6 +1606,15 @@ getSubjectHashesAndTimestamps(BI index, SH maxSubject, bool sorted) const
 
     int numSubjectBits = MLDB::highest_bit(md->numSubjects - 1, -1) + 1;
 
+    // Page the subject list (and timestamps, if present) in behind the
+    // decode loop
+    prefetchRegion(subjectData,
+                   bitArrayBytes(stats.subjectCount, numSubjectBits));
+    if (hasTimestamps)
+        prefetchRegion(subjectTimestampData,
+                       bitArrayBytes(stats.subjectCount, numTimestampBits)
+                       + 4 /* leading word with numTimestampBits */);
+
     BitExtractor extractor(subjectData);
 
     for (unsigned i = 0;  i < stats.subjectCount;  ++i) {
@@ -1574,6 +1693,15 @@ forEachBehaviorSubject(BH beh,
 
     int numSubjectBits = MLDB::highest_bit(md->numSubjects - 1, -1) + 1;
 
+    // Page the subject list (and timestamps, if present) in behind the
+    // decode loop
+    prefetchRegion(subjectData,
+                   bitArrayBytes(stats.subjectCount, numSubjectBits));
+    if (hasTimestamps)
+        prefetchRegion(subjectTimestampData,
+                       bitArrayBytes(stats.subjectCount, numTimestampBits)
+                       + 4 /* leading word with numTimestampBits */);
+
     BitExtractor extractor(subjectData);
 
     for (unsigned i = 0;  i < stats.subjectCount;  ++i) {
@@ -1813,17 +1941,20 @@ coIterateBehaviorsScan(BI behi1, BI behi2,
     
     int numSubjectBits = MLDB::highest_bit(md->numSubjects - 1, -1) + 1;
 
-    auto getExtractor = [&] (BI beh)
+    auto getExtractor = [&] (BI beh, size_t count)
         {
             const uint32_le * data
             = behaviorToSubjects
             + behaviorToSubjectsIndex[beh];
 
+            // Page the subject list in behind the co-iteration
+            prefetchRegion(data, bitArrayBytes(count, numSubjectBits));
+
             return BitExtractor(data);
         };
 
-    BitExtractor extractor1 = getExtractor(behi1);
-    BitExtractor extractor2 = getExtractor(behi2);
+    BitExtractor extractor1 = getExtractor(behi1, e1.subjectCount);
+    BitExtractor extractor2 = getExtractor(behi2, e2.subjectCount);
 
     int idx1 = 0, len1 = e1.subjectCount;
     uint32_t sub1, sub2;
@@ -263,6 +263,8 @@ struct MappedBehaviorDomain: public BehaviorDomain {
 
     virtual bool knownSubject(SH subjectHash) const
     {
+        if (!subjectBloomContains(subjectHash))
+            return false;
         if (indexV1())
             return subjectIndex1.indexOf(subjectHash) != -1;
         else return subjectIndex2.indexOf(subjectHash) != -1;
@@ -434,6 +436,30 @@ struct MappedBehaviorDomain: public BehaviorDomain {
 
     int64_t getSubjectIndexImpl(SH subjectHash) const;
 
+    /// Bloom filter parameters, shared between the writer (serialize())
+    /// and the probe below.
+    static constexpr int SUBJECT_BLOOM_BITS_PER_ENTRY = 10;
+    static constexpr int SUBJECT_BLOOM_PROBES = 4;
+
+    /** Probe the mapped Bloom filter over subject hashes.  A negative
+        answer is definitive; a positive one must be confirmed against
+        the subject index.  Files written before the filter existed map
+        with no filter and always answer positively.
+    */
+    bool subjectBloomContains(SH subjectHash) const
+    {
+        if (!subjectBloom)
+            return true;
+        uint64_t h1 = subjectHash.hash();
+        uint64_t h2 = (h1 >> 32) | 1;
+        for (int i = 0;  i < SUBJECT_BLOOM_PROBES;  ++i) {
+            uint64_t bit = (h1 + i * h2) & subjectBloomMask;
+            if (!(subjectBloom[bit / 64] & (uint64_t(1) << (bit % 64))))
+                return false;
+        }
+        return true;
+    }
+
     /** Implement behavior co-iteration via a lookup when behi1 contains
         a lot more entries than behi2.
     */
@@ -478,7 +504,9 @@ struct MappedBehaviorDomain: public BehaviorDomain {
         uint64_le idSpaceDeprecated = 0;
         uint64_le fileMetadataOffset = 0;
         uint64_le totalEventsRecorded = 0;
-        uint64_le forExpansion[504] = {0};
+        uint64_le subjectBloomOffset = 0; ///< Bloom filter over subject hashes
+        uint64_le subjectBloomWords = 0;  ///< Number of 64 bit words in it
+        uint64_le forExpansion[502] = {0};
     };
 
     /** This is the format into which behavior stats are mapped. */
@@ -510,6 +538,8 @@ struct MappedBehaviorDomain: public BehaviorDomain {
     std::vector<uint64_t> subjectMarks; // range starts for the subject index
     uint64_t lastSubjectHash;
     size_t numSHPerMark;
+    const uint64_le * subjectBloom = nullptr; /// bloom filter over subjects
+    uint64_t subjectBloomMask = 0;
     const uint32_le * behaviorToSubjects;
     MappedValueArray<uint32_le> behaviorToSubjectsIndex;
 
@@ -556,6 +586,13 @@ struct MappedBehaviorDomain: public BehaviorDomain {
     int64_t
     getSubjectIndexImplTmpl(SH subjectHash, const SubjectIndex & subjectIndex) const;
 
+    /** Hint that the given range of the mapped file is about to be
+        scanned.  Issues madvise(MADV_WILLNEED) asynchronously so the
+        kernel pages it in behind the decode loop instead of one fault
+        at a time; purely advisory, errors are ignored.
+    */
+    void prefetchRegion(const void * start, size_t length) const;
+
 };
 
 static_assert(sizeof(MappedBehaviorDomain::SubjectIndexEntry2) == 24,
@@ -148,22 +148,32 @@ init(std::vector<std::shared_ptr<BehaviorDomain> > toMerge_,
         toMerge.push_back(toMerge2[i]);
     }
 
-    // The rest get broken down into groups of 31, pre-merged, and then added
+    // The rest get broken down into groups of 31, pre-merged, and then added.
+    // The group merges are independent of each other, so they run in
+    // parallel; each one internally shards its index merge over the
+    // thread pool too, and the work stealing sorts out the nesting.
+    std::vector<std::vector<std::shared_ptr<BehaviorDomain> > > subGroups;
     for (int current = numDirect;  current < toMerge2.size();  ) {
-        //cerr << "current = " << current << " toMerge.size() = "
-        //     << toMerge.size() << endl;
         vector<std::shared_ptr<BehaviorDomain> > subToMerge;
         for (; current < toMerge2.size() && subToMerge.size() < 31;  ++current) {
-            //cerr << "adding " << current << endl;
             subToMerge.push_back(toMerge2[current]);
         }
+        subGroups.emplace_back(std::move(subToMerge));
+    }
 
-        //cerr << "merging " << subToMerge.size() << " files" << endl;
+    std::vector<std::shared_ptr<BehaviorDomain> > subMerged(subGroups.size());
+
+    auto doSubMerge = [&] (size_t i)
+        {
+            subMerged[i]
+                = std::make_shared<MergedBehaviorDomain>(subGroups[i], true);
+        };
+
+    parallelMap(0, subGroups.size(), doSubMerge);
+
+    for (auto & m: subMerged)
+        toMerge.push_back(std::move(m));
 
-        toMerge.push_back(std::make_shared<MergedBehaviorDomain>(subToMerge, true));
-        //cerr << "done merging " << subToMerge.size() << " files" << endl;
-    }
-    
     clear();
 
     for (unsigned i = 0;  i < toMerge.size();  ++i) {
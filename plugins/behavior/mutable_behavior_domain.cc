@@ -1365,6 +1365,30 @@ obtainSubjectEntryAndIndex(const Id & subject)
     int rootNumber = (subjectHash >> 59);
     ExcAssertLess(rootNumber, NUM_SUBJECT_ROOTS);
 
+    // Fastest path: this thread has seen the subject before.  Entries
+    // are never moved or destroyed once created (root expansion only
+    // grows the array of pointers), so a cached pointer and index stay
+    // valid for the lifetime of the domain and no locking at all is
+    // needed.  This is what lets many ingestion threads hammering the
+    // same subjects scale: only the first occurrence per thread touches
+    // the shared index.
+    ThreadInfo * thrInfo = threadInfo.get();
+    if (thrInfo) {
+        auto cacheIt = thrInfo->subjectCache.find(subjectHash);
+        if (cacheIt != thrInfo->subjectCache.end())
+            return make_pair(cacheIt->second.entry,
+                             SI2(rootNumber, cacheIt->second.index));
+    }
+
+    auto cacheEntry = [&] (SubjectEntry * entry, uint32_t index)
+        {
+            if (thrInfo) {
+                if (thrInfo->subjectCache.size() >= 10000)
+                    thrInfo->subjectCache.clear();
+                thrInfo->subjectCache[subjectHash] = { entry, index };
+            }
+        };
+
     // Fast path: we already know the subject
 
     auto & subjectRoot = *subjectRoots[rootNumber];
@@ -1377,9 +1401,12 @@ obtainSubjectEntryAndIndex(const Id & subject)
     auto subjectIndex = subjectRoot.subjectIndexPtr();
 
     auto it = subjectIndex->find(subjectHash);
-    if (it != subjectIndex->end())
-        return make_pair(subjectRoot.subjectEntryPtr()->at(it->second), SI2(rootNumber, it->second));
-    
+    if (it != subjectIndex->end()) {
+        SubjectEntry * entry = subjectRoot.subjectEntryPtr()->at(it->second);
+        cacheEntry(entry, it->second);
+        return make_pair(entry, SI2(rootNumber, it->second));
+    }
+
     // ... to here?
     // Answer... it leads to race conditions I haven't fully worked out
     // yet
@@ -1446,6 +1473,7 @@ obtainSubjectEntryAndIndex(const Id & subject)
                 // readers.
                 (*subjectIndex)[subjectHash] = idx;
             }
+            cacheEntry(result, idx);
             return make_pair(result, SI2(rootNumber, idx));
         }
         else {
@@ -1453,7 +1481,9 @@ obtainSubjectEntryAndIndex(const Id & subject)
         }
     }
 
-    return make_pair(subjectRoot.subjectEntryPtr()->at(idx), SI2(rootNumber, idx));
+    SubjectEntry * entry = subjectRoot.subjectEntryPtr()->at(idx);
+    cacheEntry(entry, idx);
+    return make_pair(entry, SI2(rootNumber, idx));
 }
 
 const MutableBehaviorDomain::BehaviorEntry *
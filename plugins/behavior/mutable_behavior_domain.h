@@ -803,8 +803,19 @@ private:
     RcuProtected<LightweightHash<BH, BehaviorEntry *> > behaviorPartialCache;
     std::vector<std::shared_ptr<SubjectRoot> > subjectRoots;
 
+    struct CachedSubjectEntry {
+        SubjectEntry * entry = nullptr;
+        uint32_t index = 0;
+
+        friend std::ostream &
+        operator << (std::ostream & stream, const CachedSubjectEntry & e)
+        {
+            return stream << e.entry << ":" << e.index;
+        }
+    };
+
     struct ThreadInfo {
-        LightweightHash<uint64_t, SubjectEntry *> subjectCache;
+        LightweightHash<uint64_t, CachedSubjectEntry> subjectCache;
         LightweightHash<uint64_t, BehaviorEntry *> behaviorCache;
     };
 
@@ -0,0 +1,118 @@
+// This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+/* id_parse_bench.cc
+   Benchmark for Id parsing and hashing over each of the supported
+   identifier formats.
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "mldb/plugins/behavior/id.h"
+#include "mldb/arch/format.h"
+#include "mldb/types/date.h"
+
+using namespace std;
+using namespace MLDB;
+
+namespace {
+
+// Simple deterministic generator so runs are comparable
+uint64_t nextRand(uint64_t & state)
+{
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return state >> 16;
+}
+
+vector<string> makeIds(const string & what, size_t n)
+{
+    static const char googAlphabet[]
+        = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+          "abcdefghijklmnopqrstuvwxyz-_";
+
+    uint64_t state = 42;
+    vector<string> result;
+    result.reserve(n);
+
+    for (size_t i = 0;  i < n;  ++i) {
+        uint64_t r1 = nextRand(state), r2 = nextRand(state);
+        if (what == "uuid") {
+            result.push_back(MLDB::format("%08llx-%04llx-%04llx-%04llx-%012llx",
+                                          (unsigned long long)(r1 >> 32),
+                                          (unsigned long long)(r1 & 0xffff),
+                                          (unsigned long long)(r2 & 0xffff),
+                                          (unsigned long long)(r2 >> 48),
+                                          (unsigned long long)(r2 & 0xffffffffffffULL)));
+        }
+        else if (what == "goog128") {
+            string s = "CAESE";
+            for (int j = 0;  j < 21;  ++j)
+                s += googAlphabet[nextRand(state) % 64];
+            result.push_back(std::move(s));
+        }
+        else if (what == "bigdec") {
+            result.push_back(MLDB::format("%llu",
+                                          (unsigned long long)(r1 | 1)));
+        }
+        else if (what == "hex128") {
+            result.push_back(MLDB::format("%016llx%016llx",
+                                          (unsigned long long)r1,
+                                          (unsigned long long)r2));
+        }
+        else if (what == "shortstr") {
+            result.push_back(MLDB::format("u:%llu",
+                                          (unsigned long long)(r1 % 1000000)));
+        }
+        else throw MLDB::Exception("unknown id kind " + what);
+    }
+
+    return result;
+}
+
+void benchParse(const string & what, const vector<string> & ids, int passes)
+{
+    size_t n = ids.size();
+
+    vector<const char *> strs(n);
+    vector<size_t> lens(n);
+    for (size_t i = 0;  i < n;  ++i) {
+        strs[i] = ids[i].c_str();
+        lens[i] = ids[i].size();
+    }
+
+    vector<Id> parsed(n);
+
+    Date before = Date::now();
+    for (int p = 0;  p < passes;  ++p)
+        Id::parseBatch(strs.data(), lens.data(), n, parsed.data());
+    double parseElapsed = Date::now().secondsSince(before);
+
+    vector<uint64_t> hashes(n);
+
+    before = Date::now();
+    for (int p = 0;  p < passes;  ++p)
+        Id::hashBatch(parsed.data(), n, hashes.data());
+    double hashElapsed = Date::now().secondsSince(before);
+
+    size_t total = n * passes;
+    cerr << MLDB::format("%-10s parse %8.2fM/s   hash %8.2fM/s",
+                         what.c_str(),
+                         total / parseElapsed / 1000000.0,
+                         total / hashElapsed / 1000000.0)
+         << endl;
+}
+
+} // file scope
+
+int main(int argc, char ** argv)
+{
+    size_t n = 1000000;
+    int passes = 10;
+
+    for (const char * what: { "uuid", "goog128", "bigdec", "hex128",
+                              "shortstr" }) {
+        benchParse(what, makeIds(what, n), passes);
+    }
+
+    return 0;
+}
@@ -7,6 +7,7 @@
 */
 
 #include "tranches.h"
+#include "mldb/utils/row_bitmap.h"
 #include "mldb/utils/vector_utils.h"
 #include "mldb/base/parse_context.h"
 #include "mldb/types/value_description.h"
@@ -330,24 +331,16 @@ intersects(const TrancheSpec & other) const
     // do is map the other one's values to our modulus, and then
     // check to see if any of them hit our values
 
-    // TODO: optimize me
-
-    std::set<int> otherMapped;
+    RowBitmap ours, otherMapped;
     int mask = (1 << modulusShift) - 1;
 
-    for (auto s: other.set) {
-        int m = s & mask;
-        otherMapped.insert(m);
-    }
+    for (auto s: set)
+        ours.insert(s);
+    for (auto s: other.set)
+        otherMapped.insert(s & mask);
 
-    std::vector<int> inter;
-    std::set_intersection(set.begin(), set.end(),
-                          otherMapped.begin(), otherMapped.end(),
-                          std::back_inserter(inter));
-    //cerr << "me: " << *this << endl;
-    //cerr << "other: " << other << endl;
-    //cerr << "inter: " << inter << endl;
-    return !inter.empty();
+    otherMapped.andWith(ours);
+    return otherMapped.count() != 0;
 }
 
 TrancheSpec
@@ -357,10 +350,16 @@ complement() const
     if (totalTranches() == 0)
         return TrancheSpec(0,1);
 
+    // Co-iterate with the (sorted) set rather than doing one binary
+    // search per bucket
     vector<int> complement_set;
-    for (int i=0; i < totalTranches(); ++i)
-        if (!count(i))
+    auto it = set.begin();
+    for (int i=0; i < totalTranches(); ++i) {
+        while (it != set.end() && *it < i)
+            ++it;
+        if (it == set.end() || *it != i)
             complement_set.push_back(i);
+    }
 
     return TrancheSpec(complement_set, totalTranches());
 }
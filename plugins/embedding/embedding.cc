@@ -9,6 +9,8 @@
 
 #include "embedding.h"
 #include "mldb/utils/vantage_point_tree.h"
+#include "mldb/utils/hnsw_index.h"
+#include "mldb/utils/product_quantizer.h"
 #include "mldb/arch/rcu_protected.h"
 #include "mldb/rest/rest_request_binding.h"
 #include "mldb/arch/simd_vector.h"
@@ -58,6 +60,20 @@ operator >> (MLDB::DB::Store_Reader & store, Path & coords);
 /* EMBEDDING DATASET CONFIG                                                  */
 /*****************************************************************************/
 
+DEFINE_ENUM_DESCRIPTION(EmbeddingIndexType);
+
+EmbeddingIndexTypeDescription::
+EmbeddingIndexTypeDescription()
+{
+    addValue("vantage.point", EMBEDDING_INDEX_VPTREE,
+             "Vantage point tree.  Exact nearest neighbors; search cost "
+             "approaches a linear scan in high dimensions.");
+    addValue("hnsw", EMBEDDING_INDEX_HNSW,
+             "Hierarchical navigable small world graph.  Approximate "
+             "nearest neighbors with search cost that stays roughly "
+             "logarithmic in high dimensions.");
+}
+
 DEFINE_STRUCTURE_DESCRIPTION(EmbeddingDatasetConfig);
 
 EmbeddingDatasetConfigDescription::
@@ -71,6 +87,26 @@ EmbeddingDatasetConfigDescription()
              "good for normalized embeddings like the SVD) and 'euclidean' "
              "(which is good for geometric embeddings like the t-SNE "
              "algorithm).", METRIC_EUCLIDEAN);
+    addField("indexType", &EmbeddingDatasetConfig::indexType,
+             "Index built over the embedding at commit time.  "
+             "'vantage.point' (the default) gives exact results; 'hnsw' "
+             "gives approximate results with much faster lookups on "
+             "large, high dimensional embeddings.",
+             EMBEDDING_INDEX_VPTREE);
+    addField("pqSubspaces", &EmbeddingDatasetConfig::pqSubspaces,
+             "Number of product quantization subspaces.  Zero (the "
+             "default) stores exact float32 coordinates.  When non-zero, "
+             "each coordinate vector is compressed at commit time to one "
+             "8 bit code per subspace (for example, 32 subspaces compress "
+             "256 float32 columns 32x), and distances and column reads "
+             "become approximate.  More subspaces give better recall at "
+             "a higher memory cost.  New rows cannot be recorded once a "
+             "compressed dataset has been committed.", 0);
+    addField("pqTrainingIterations",
+             &EmbeddingDatasetConfig::pqTrainingIterations,
+             "Number of k-means iterations used to train the product "
+             "quantization codebooks at commit time.  More iterations "
+             "give better recall at a higher commit cost.", 10);
 }
 
 
@@ -80,15 +116,13 @@ EmbeddingDatasetConfigDescription()
 
 struct EmbeddingDatasetRepr {
     EmbeddingDatasetRepr(MetricSpace metric)
-        : vpTree(new MLDB::VantagePointTreeT<int>()),
-          distance(DistanceMetric::create(metric))
+        : distance(DistanceMetric::create(metric))
     {
     }
 
     EmbeddingDatasetRepr(std::vector<ColumnPath> columnNames,
                          MetricSpace metric)
         : columnNames(std::move(columnNames)), columns(this->columnNames.size()),
-          vpTree(new MLDB::VantagePointTreeT<int>()),
           distance(DistanceMetric::create(metric))
     {
         for (unsigned i = 0;  i < this->columnNames.size();  ++i) {
@@ -102,7 +136,11 @@ struct EmbeddingDatasetRepr {
           columnIndex(other.columnIndex),
           rows(other.rows),
           rowIndex(other.rowIndex),
-          vpTree(MLDB::VantagePointTreeT<int>::deepCopy(other.vpTree.get()))
+          vpTree(other.vpTree),
+          hnsw(other.hnsw
+               ? MLDB::HnswIndexT<int>::deepCopy(other.hnsw.get()) : nullptr),
+          pq(other.pq),
+          pqCodes(other.pqCodes)
     {
     }
 
@@ -131,7 +169,9 @@ struct EmbeddingDatasetRepr {
 
     bool initialized() const
     {
-        return !columns.empty();
+        // Column names are known as soon as anything has been recorded;
+        // the column major store itself is dropped in compressed mode
+        return !columnNames.empty();
     }
 
     struct Row {
@@ -151,6 +191,19 @@ struct EmbeddingDatasetRepr {
         }
     };
 
+    /** Return the coordinates of the given row, decoding them into
+        storage when they are stored as product quantization codes.
+    */
+    const distribution<float> &
+    getCoords(unsigned row, distribution<float> & storage) const
+    {
+        if (!pq)
+            return rows[row].coords;
+        storage.resize(columnNames.size());
+        pq->decode(&pqCodes[(size_t)row * pq->numSubspaces], storage.data());
+        return storage;
+    }
+
     float dist(unsigned row1, unsigned row2) const
     {
         ExcAssertLess(row1, rows.size());
@@ -158,11 +211,22 @@ struct EmbeddingDatasetRepr {
 
         if (row1 == row2)
             return 0.0f;
-        
+
+        if (pq) {
+            // Decoded coordinates are approximate, so don't use the
+            // cached per-row values inside the metric
+            distribution<float> storage1, storage2;
+            float result = distance->dist(-1, -1,
+                                          getCoords(row1, storage1),
+                                          getCoords(row2, storage2));
+            ExcAssert(isfinite(result));
+            return result;
+        }
+
         float result = distance->dist(row1, row2,
                                       rows[row1].coords,
                                       rows[row2].coords);
-        
+
         ExcAssert(isfinite(result));
         return result;
     }
@@ -170,8 +234,17 @@ struct EmbeddingDatasetRepr {
     float dist(unsigned row1, const distribution<float> & row2) const
     {
         ExcAssertLess(row1, rows.size());
-        ExcAssertEqual(row2.size(), columns.size());
-        
+        ExcAssertEqual(row2.size(), columnNames.size());
+
+        if (pq) {
+            distribution<float> storage;
+            float result = distance->dist(-1, -1,
+                                          getCoords(row1, storage),
+                                          row2);
+            ExcAssert(isfinite(result));
+            return result;
+        }
+
         float result = distance->dist(row1, -1,
                                       rows[row1].coords,
                                       row2);
@@ -207,7 +280,37 @@ struct EmbeddingDatasetRepr {
     std::vector<Row> rows;
     LightweightHash<uint64_t, int> rowIndex;
     
-    std::unique_ptr<MLDB::VantagePointTreeT<int> > vpTree;
+    /// Flattened VP tree, nodes in breadth-first order in contiguous
+    /// storage; empty until the first commit
+    MLDB::VantagePointTreeFlatT<int> vpTree;
+
+    /// Set instead of the VP tree when indexType is 'hnsw'
+    std::unique_ptr<MLDB::HnswIndexT<int> > hnsw;
+
+    /// Codebooks when pqSubspaces compression is enabled; null otherwise.
+    /// In compressed mode the per-row coords and the column major store
+    /// are released, and everything is served from the codes.
+    std::shared_ptr<const ProductQuantizer> pq;
+
+    /// One 8 bit code per row and subspace, row major
+    std::vector<uint8_t> pqCodes;
+
+    /** Return all values of the given column, decoding them from the
+        codes into storage in compressed mode.
+    */
+    const std::vector<float> &
+    columnValues(int column, std::vector<float> & storage) const
+    {
+        if (!pq)
+            return columns.at(column);
+
+        storage.resize(rows.size());
+        for (size_t i = 0;  i < rows.size();  ++i)
+            storage[i] = pq->decodeOne(&pqCodes[i * pq->numSubspaces],
+                                       column);
+        return storage;
+    }
+
     std::unique_ptr<DistanceMetric> distance;
 
     void save(const std::string & filename)
@@ -239,20 +342,28 @@ serialize(MLDB::DB::Store_Writer & store) const
     store << string("EMBEDDING_DATASET")
           << MLDB::DB::compact_size_t(1);  // version
     store << columnNames << columns << rows;
-    vpTree->serialize(store);
+    vpTree.serialize(store);
 }
 
 struct EmbeddingDataset::Itl
     : public MatrixView, public ColumnIndex {
-    Itl(MetricSpace metric)
-        : metric(metric), committed(lock, metric), uncommitted(nullptr),
+    Itl(const EmbeddingDatasetConfig & config = EmbeddingDatasetConfig())
+        : metric(config.metric), indexType(config.indexType),
+          pqSubspaces(config.pqSubspaces),
+          pqTrainingIterations(config.pqTrainingIterations),
+          committed(lock, config.metric), uncommitted(nullptr),
           logger(MLDB::getMldbLog<ProximateVoxelsFunction>())
     {
     }
 
     // TODO: make it loadable...
-    Itl(const std::string & address, MetricSpace metric)
-        : metric(metric), committed(lock, metric), uncommitted(nullptr), address(address),
+    Itl(const std::string & address,
+        const EmbeddingDatasetConfig & config = EmbeddingDatasetConfig())
+        : metric(config.metric), indexType(config.indexType),
+          pqSubspaces(config.pqSubspaces),
+          pqTrainingIterations(config.pqTrainingIterations),
+          committed(lock, config.metric), uncommitted(nullptr),
+          address(address),
           logger(MLDB::getMldbLog<ProximateVoxelsFunction>())
     {
     }
@@ -264,6 +375,9 @@ struct EmbeddingDataset::Itl
 
     MemorySerializer backingStore;  ///< Memory holding backing data
     MetricSpace metric;
+    EmbeddingIndexType indexType;
+    int pqSubspaces;
+    int pqTrainingIterations;
 
     GcLock lock;
     RcuProtected<EmbeddingDatasetRepr> committed;
@@ -388,10 +502,14 @@ struct EmbeddingDataset::Itl
 
         MatrixNamedRow result;
         result.rowHash = result.rowName = rowName;
-        result.columns.reserve(row.coords.size());
 
-        for (unsigned i = 0;  i < row.coords.size();  ++i) {
-            result.columns.emplace_back(repr->columnNames[i], row.coords[i],
+        distribution<float> coordStorage;
+        const distribution<float> & coords
+            = repr->getCoords(it->second, coordStorage);
+        result.columns.reserve(coords.size());
+
+        for (unsigned i = 0;  i < coords.size();  ++i) {
+            result.columns.emplace_back(repr->columnNames[i], coords[i],
                                         row.timestamp);
         }
         return result;
@@ -412,10 +530,14 @@ struct EmbeddingDataset::Itl
         MatrixRow result;
         result.rowHash = rowHash;
         result.rowName = row.rowName;
-        result.columns.reserve(row.coords.size());
 
-        for (unsigned i = 0;  i < row.coords.size();  ++i) {
-            result.columns.emplace_back(repr->columnNames[i], row.coords[i],
+        distribution<float> coordStorage;
+        const distribution<float> & coords
+            = repr->getCoords(it->second, coordStorage);
+        result.columns.reserve(coords.size());
+
+        for (unsigned i = 0;  i < coords.size();  ++i) {
+            result.columns.emplace_back(repr->columnNames[i], coords[i],
                                         row.timestamp);
         }
         return result;
@@ -501,7 +623,9 @@ struct EmbeddingDataset::Itl
         if (it == repr->columnIndex.end())
             throw AnnotatedException(400, "Can't get name of unknown column");
 
-        const vector<float> & columnVals = repr->columns.at(it->second);
+        vector<float> columnStorage;
+        const vector<float> & columnVals
+            = repr->columnValues(it->second, columnStorage);
 
         toStoreResult.isNumeric_ = true;
         toStoreResult.atMostOne_ = true;
@@ -526,7 +650,9 @@ struct EmbeddingDataset::Itl
         if (it == repr->columnIndex.end())
             throw AnnotatedException(400, "Can't get name of unknown column");
 
-        const vector<float> & columnVals = repr->columns.at(it->second);
+        vector<float> columnStorage;
+        const vector<float> & columnVals
+            = repr->columnValues(it->second, columnStorage);
 
         MatrixColumn result;
 
@@ -550,7 +676,9 @@ struct EmbeddingDataset::Itl
         if (it == repr->columnIndex.end())
             throw AnnotatedException(400, "Can't get name of unknown column");
 
-        const vector<float> & columnVals = repr->columns.at(it->second);
+        vector<float> columnStorage;
+        const vector<float> & columnVals
+            = repr->columnValues(it->second, columnStorage);
 
         std::vector<CellValue> result(columnVals.begin(), columnVals.end());
 
@@ -569,7 +697,9 @@ struct EmbeddingDataset::Itl
         if (it == repr->columnIndex.end())
             throw AnnotatedException(400, "Can't get name of unknown column");
 
-        const vector<float> & columnVals = repr->columns.at(it->second);
+        vector<float> columnStorage;
+        const vector<float> & columnVals
+            = repr->columnValues(it->second, columnStorage);
         auto sortedVals = columnVals;
         std::sort(sortedVals.begin(), sortedVals.end());
         sortedVals.erase(std::unique(sortedVals.begin(), sortedVals.end()),
@@ -681,6 +811,11 @@ struct EmbeddingDataset::Itl
                 uncommitted = new EmbeddingDatasetRepr(columnNames, metric);
             }
             else {
+                if (repr->pq)
+                    throw AnnotatedException
+                        (400, "Can't record new rows into an embedding "
+                         "dataset committed with product quantization: "
+                         "the exact coordinates were discarded on commit");
                 uncommitted = new EmbeddingDatasetRepr(*repr);
             }
         }
@@ -800,6 +935,11 @@ struct EmbeddingDataset::Itl
                 uncommitted = new EmbeddingDatasetRepr(columnNames, metric);
             }
             else {
+                if (repr->pq)
+                    throw AnnotatedException
+                        (400, "Can't record new rows into an embedding "
+                         "dataset committed with product quantization: "
+                         "the exact coordinates were discarded on commit");
                 uncommitted = new EmbeddingDatasetRepr(*repr);
             }
 
@@ -937,11 +1077,73 @@ struct EmbeddingDataset::Itl
                 return result;
             };
         
-        // Create the VP tree for indexed lookups on distance
-        (*uncommitted).vpTree.reset(MLDB::VantagePointTreeT<int>::createParallel(items, dist));
+        if (indexType == EMBEDDING_INDEX_HNSW) {
+            // Create the HNSW graph for approximate indexed lookups on
+            // distance
+            auto pairDist = [&] (int item1, int item2) -> float
+                {
+                    return (*uncommitted).dist(item1, item2);
+                };
+
+            (*uncommitted).hnsw.reset(MLDB::HnswIndexT<int>::create(items, pairDist));
+
+            INFO_MSG(logger) << "HNSW graph done in " << timer.elapsed();
+        }
+        else {
+            // Create the VP tree for indexed lookups on distance, then
+            // flatten it into contiguous breadth-first storage, which is
+            // what searches traverse
+            std::unique_ptr<MLDB::VantagePointTreeT<int> > tree
+                (MLDB::VantagePointTreeT<int>::createParallel(items, dist));
+            (*uncommitted).vpTree
+                = MLDB::VantagePointTreeFlatT<int>::freeze(tree.get());
+
+            INFO_MSG(logger) << "VP tree done in " << timer.elapsed();
+        }
+
+        if (pqSubspaces > 0 && !(*uncommitted).rows.empty()) {
+            // Compress the coordinates.  The index above was built on
+            // the exact values; searches are answered from the codes.
+            INFO_MSG(logger) << "training product quantizer";
+            Timer pqTimer;
+
+            size_t numRows = (*uncommitted).rows.size();
+            int numDims = (*uncommitted).columnNames.size();
+
+            auto getVector = [&] (size_t i) -> const float *
+                {
+                    return (*uncommitted).rows[i].coords.data();
+                };
+
+            std::shared_ptr<const ProductQuantizer> pq
+                (ProductQuantizer::train(getVector, numRows, numDims,
+                                         pqSubspaces,
+                                         pqTrainingIterations));
+
+            std::vector<uint8_t> codes(numRows * pq->numSubspaces);
+
+            auto encodeRow = [&] (size_t i)
+                {
+                    pq->encode((*uncommitted).rows[i].coords.data(),
+                               &codes[i * pq->numSubspaces]);
+                };
+
+            parallelMap(0, numRows, encodeRow);
+
+            (*uncommitted).pq = std::move(pq);
+            (*uncommitted).pqCodes = std::move(codes);
+
+            // Release the exact coordinates and the column major copy;
+            // this is where the memory saving comes from
+            for (auto & r: (*uncommitted).rows)
+                r.coords = distribution<float>();
+            (*uncommitted).columns.clear();
+            (*uncommitted).columns.shrink_to_fit();
+
+            INFO_MSG(logger) << "PQ compression done in "
+                             << pqTimer.elapsed();
+        }
 
-        INFO_MSG(logger) << "VP tree done in " << timer.elapsed();
-        
         committed.replace(uncommitted);
         uncommitted = nullptr;
 
@@ -951,6 +1153,35 @@ struct EmbeddingDataset::Itl
         }
     }
 
+    /** Distance from a query vector to an indexed item.  Uses the ADC
+        table fast path over the codes when the coordinates are product
+        quantized and the metric allows it; the caller must keep repr and
+        coord alive while the returned function is in use.
+    */
+    std::function<float (int)>
+    makeQueryDistance(const EmbeddingDatasetRepr & repr,
+                      const distribution<float> & coord) const
+    {
+        if (repr.pq && metric == METRIC_EUCLIDEAN) {
+            auto table = std::make_shared<std::vector<float> >
+                (repr.pq->buildQueryTable(coord.data()));
+            return [&repr, table] (int item) -> float
+                {
+                    size_t offset = (size_t)item * repr.pq->numSubspaces;
+                    return std::sqrt
+                        (repr.pq->adcSquaredDist(&repr.pqCodes[offset],
+                                                 table->data()));
+                };
+        }
+
+        return [&repr, &coord] (int item) -> float
+            {
+                float result = repr.dist(item, coord);
+                ExcAssert(isfinite(result));
+                return result;
+            };
+    }
+
     vector<tuple<RowPath, RowHash, float> >
     getNeighbors(const distribution<float> & coord,
                  int numNeighbors,
@@ -960,16 +1191,14 @@ struct EmbeddingDataset::Itl
         if (!repr->initialized())
             return {};
 
-        auto dist = [&] (int item) -> float
-        {
-            float result = repr->dist(item, coord);
-            ExcAssert(isfinite(result));
-            return result;
-        };
+        auto dist = makeQueryDistance(*repr, coord);
 
         //Timer timer;
 
-        auto neighbors = repr->vpTree->search(dist, numNeighbors, maxDistance);
+        auto neighbors
+            = repr->hnsw
+            ? repr->hnsw->search(dist, numNeighbors, maxDistance)
+            : repr->vpTree.search(dist, numNeighbors, maxDistance);
 
         //DEBUG_MSG(logger) << "neighbors took " << timer.elapsed();
 
@@ -985,6 +1214,40 @@ struct EmbeddingDataset::Itl
         return result;
     }
 
+    vector<vector<tuple<RowPath, RowHash, float> > >
+    getNeighborsBatch(const std::vector<distribution<float> > & coords,
+                      int numNeighbors,
+                      double maxDistance)
+    {
+        vector<vector<tuple<RowPath, RowHash, float> > > result(coords.size());
+
+        auto repr = committed();
+        if (!repr->initialized())
+            return result;
+
+        // One snapshot shared by every query; the queries themselves are
+        // independent so they run in parallel.
+        auto doQuery = [&] (size_t i)
+            {
+                auto dist = makeQueryDistance(*repr, coords[i]);
+
+                auto neighbors
+                    = repr->hnsw
+                    ? repr->hnsw->search(dist, numNeighbors, maxDistance)
+                    : repr->vpTree.search(dist, numNeighbors, maxDistance);
+
+                for (auto & n: neighbors) {
+                    result[i].emplace_back(repr->rows[n.second].rowName,
+                                           repr->rows[n.second].rowName,
+                                           n.first);
+                }
+            };
+
+        parallelMap(0, coords.size(), doQuery);
+
+        return result;
+    }
+
     vector<tuple<RowPath, RowHash, float> >
     getRowNeighbors(const RowPath & row, int numNeighbors, double maxDistance)
     {
@@ -1001,15 +1264,28 @@ struct EmbeddingDataset::Itl
         }
        
         //const EmbeddingDatasetRepr::Row & row = repr->rows[it->second];
-        
-        auto dist = [&] (int item) -> float
-            {
-                float result = repr->dist(item, it->second);
-                ExcAssert(isfinite(result));
-                return result;
-            };
 
-        auto neighbors = repr->vpTree->search(dist, numNeighbors, maxDistance);
+        std::function<float (int)> dist;
+        distribution<float> queryStorage;
+        if (repr->pq) {
+            // Decode the query row once rather than per distance
+            const distribution<float> & queryCoords
+                = repr->getCoords(it->second, queryStorage);
+            dist = makeQueryDistance(*repr, queryCoords);
+        }
+        else {
+            dist = [&] (int item) -> float
+                {
+                    float result = repr->dist(item, it->second);
+                    ExcAssert(isfinite(result));
+                    return result;
+                };
+        }
+
+        auto neighbors
+            = repr->hnsw
+            ? repr->hnsw->search(dist, numNeighbors, maxDistance)
+            : repr->vpTree.search(dist, numNeighbors, maxDistance);
 
         vector<tuple<RowPath, RowHash, float> > result;
         for (auto & n: neighbors) {
@@ -1044,7 +1320,7 @@ EmbeddingDataset(MldbEngine * owner,
 {
     this->datasetConfig = config.params.convert<EmbeddingDatasetConfig>();
 #if 1
-    itl.reset(new Itl(datasetConfig.metric));
+    itl.reset(new Itl(datasetConfig));
 #else // once persistence is done
 
     if (!config.address.empty()) {
@@ -1141,7 +1417,15 @@ getNeighbors(const distribution<float> & coord, int numNeighbors, double maxDist
 {
     return itl->getNeighbors(coord, numNeighbors, maxDistance);
 }
-    
+
+vector<vector<tuple<RowPath, RowHash, float> > >
+EmbeddingDataset::
+getNeighborsBatch(const std::vector<distribution<float> > & coords,
+                  int numNeighbors, double maxDistance) const
+{
+    return itl->getNeighborsBatch(coords, numNeighbors, maxDistance);
+}
+
 vector<tuple<RowPath, RowHash, float> >
 EmbeddingDataset::
 getRowNeighbors(const RowPath & row, int numNeighbors, double maxDistance) const
@@ -22,13 +22,27 @@ namespace MLDB {
 /* EMBEDDING DATASET CONFIG                                                  */
 /*****************************************************************************/
 
+/** Which index structure is built over the embedding at commit time. */
+enum EmbeddingIndexType {
+    EMBEDDING_INDEX_VPTREE,   ///< Exact search via a vantage point tree
+    EMBEDDING_INDEX_HNSW      ///< Approximate search via an HNSW graph
+};
+
+DECLARE_ENUM_DESCRIPTION(EmbeddingIndexType);
+
 struct EmbeddingDatasetConfig {
     EmbeddingDatasetConfig()
-        : metric(METRIC_EUCLIDEAN)
+        : metric(METRIC_EUCLIDEAN),
+          indexType(EMBEDDING_INDEX_VPTREE),
+          pqSubspaces(0),
+          pqTrainingIterations(10)
     {
     }
 
     MetricSpace metric;
+    EmbeddingIndexType indexType;
+    int pqSubspaces;
+    int pqTrainingIterations;
 };
 
 DECLARE_STRUCTURE_DESCRIPTION(EmbeddingDatasetConfig);
@@ -79,7 +93,17 @@ struct EmbeddingDataset: public Dataset {
     std::vector<std::tuple<RowPath, RowHash, float> >
     getNeighbors(const distribution<float> & coord, int numNeighbors,
                  double maxDistance) const;
-    
+
+    /** Answer many nearest neighbour queries in one call.  The index
+        snapshot is taken once and the queries run in parallel over it,
+        which amortizes traversal overhead when resolving hundreds of
+        query vectors at a time.  Results are in the same order as the
+        input coordinates.
+    */
+    std::vector<std::vector<std::tuple<RowPath, RowHash, float> > >
+    getNeighborsBatch(const std::vector<distribution<float> > & coords,
+                      int numNeighbors, double maxDistance) const;
+
     std::vector<std::tuple<RowPath, RowHash, float> >
     getRowNeighbors(const RowPath & row, int numNeighbors,
                     double maxDistance) const;
@@ -437,11 +437,74 @@ calcSvdBasis(const ColumnCorrelations & correlations,
      * n = ncol (y stores product vector).		              *
      **************************************************************/
 
+    // The Lanczos recurrence applies B over and over, so the multiply is
+    // where nearly all of the SVD time goes.  Correlation matrices over
+    // sparse or one-hot encoded columns are mostly zeros, so when the
+    // matrix is sparse enough we convert it once to compressed sparse
+    // rows and multiply those instead; either way the rows are
+    // partitioned in blocks over the thread pool (rows write disjoint
+    // outputs, so no accumulator merging is needed).
+
+    size_t numNonZero = 0;
+    for (unsigned i = 0;  i < ndims;  ++i)
+        for (unsigned j = 0;  j < ndims;  ++j)
+            numNonZero += correlations.correlations[i][j] != 0.0f;
+
+    bool sparseMultiply = numNonZero * 4 < (size_t)ndims * ndims;
+
+    std::vector<size_t> rowOffsets;
+    std::vector<uint32_t> colIndexes;
+    std::vector<float> nonZeroValues;
+
+    if (sparseMultiply) {
+        rowOffsets.reserve(ndims + 1);
+        rowOffsets.push_back(0);
+        colIndexes.reserve(numNonZero);
+        nonZeroValues.reserve(numNonZero);
+
+        for (unsigned i = 0;  i < ndims;  ++i) {
+            for (unsigned j = 0;  j < ndims;  ++j) {
+                float v = correlations.correlations[i][j];
+                if (v != 0.0f) {
+                    colIndexes.push_back(j);
+                    nonZeroValues.push_back(v);
+                }
+            }
+            rowOffsets.push_back(nonZeroValues.size());
+        }
+    }
+
+    INFO_MSG(logger) << "correlation matrix has " << numNonZero
+                     << " of " << (size_t)ndims * ndims
+                     << " entries non-zero; using "
+                     << (sparseMultiply ? "sparse" : "dense")
+                     << " multiply";
+
     auto opb_fn = [&] (const double * x, double * y)
     {
-        for (unsigned i = 0; i != ndims; i++) {
-            y[i] = MLDB::SIMD::vec_dotprod_dp(&correlations.correlations[i][0], x, ndims);
-        }
+        auto doRows = [&] (size_t i0, size_t i1)
+            {
+                if (sparseMultiply) {
+                    for (size_t i = i0;  i < i1;  ++i) {
+                        // Accumulate in double precision for accuracy
+                        double total = 0.0;
+                        for (size_t k = rowOffsets[i];
+                             k < rowOffsets[i + 1];  ++k)
+                            total += nonZeroValues[k] * x[colIndexes[k]];
+                        y[i] = total;
+                    }
+                }
+                else {
+                    for (size_t i = i0;  i < i1;  ++i)
+                        y[i] = MLDB::SIMD::vec_dotprod_dp
+                            (&correlations.correlations[i][0], x, ndims);
+                }
+            };
+
+        // Below this size, the parallelization overhead dominates
+        if (ndims < 256)
+            doRows(0, ndims);
+        else MLDB::parallelMapChunked(0, ndims, 64, doRows);
     };
 
     SVDParams params;
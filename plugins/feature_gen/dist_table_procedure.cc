@@ -27,6 +27,7 @@
 #include "mldb/vfs/filter_streams.h"
 #include "mldb/builtin/sql_config_validator.h"
 #include "mldb/base/parallel.h"
+#include "mldb/base/per_thread_accumulator.h"
 #include "mldb/utils/log.h"
 
 
@@ -112,6 +113,35 @@ increment(double value)
     last = value;
 }
 
+void
+DistTableStats::
+merge(const DistTableStats & other)
+{
+    if (other.count == 0)
+        return;
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+
+    uint64_t n = count + other.count;
+
+    // Chan et al. parallel combination of Welford accumulators
+    double delta = other.avg - avg;
+    avg += delta * other.count / n;
+    M2 += other.M2 + delta * delta * ((double)count * other.count / n);
+
+    count = n;
+    sum += other.sum;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+
+    if (count >= 2)
+        var = M2 / (count - 1);
+
+    last = other.last;
+}
+
 double
 DistTableStats::
 getStat(DISTTABLE_STATISTICS stat) const
@@ -165,6 +195,23 @@ increment(const Utf8String & featureValue, const vector<double> & targets)
     }
 }
 
+void
+DistTable::
+merge(DistTable && other)
+{
+    for (auto & entry: other.stats) {
+        auto it = stats.find(entry.first);
+        if (it == stats.end()) {
+            stats.emplace(entry.first, std::move(entry.second));
+        }
+        else {
+            vector<DistTableStats> & dest = it->second;
+            for (size_t i = 0;  i < dest.size();  ++i)
+                dest[i].merge(entry.second[i]);
+        }
+    }
+}
+
 const vector<DistTableStats> &
 DistTable::
 getStats(const Utf8String & featureValue) const
@@ -370,7 +417,18 @@ run(const ProcedureRunConfig & run,
         output = createDataset(engine, outputDataset, onProgress2, true /*overwrite*/);
     }
 
-    int num_req = 0;
+    // When no output dataset is requested, no row ever observes the
+    // statistics of the rows before it, so rows can be processed in
+    // parallel against per-thread copies of the tables and merged at
+    // the end.  With an output dataset, each row must be annotated
+    // with the statistics of all previous rows, which forces a
+    // sequential pass.
+    bool parallelTrain = !output;
+
+    PerThreadAccumulator<DistTablesMap> accum
+        ([&] () { return new DistTablesMap(distTablesMap); });
+
+    std::atomic<int> num_req(0);
     Date start = Date::now();
 
     const int nbOutcomes = runProcConf.outcomes.size();
@@ -380,9 +438,13 @@ run(const ProcedureRunConfig & run,
         {
             MatrixNamedRow row = row_.flattenDestructive();
 
-            if (num_req++ % 5000 == 0) {
+            DistTablesMap & tables
+                = parallelTrain ? accum.get() : distTablesMap;
+
+            int reqNum = num_req++;
+            if (reqNum % 5000 == 0) {
                 double secs = Date::now().secondsSinceEpoch() - start.secondsSinceEpoch();
-                string message = MLDB::format("done %d. %0.4f/sec", num_req, num_req / secs);
+                string message = MLDB::format("done %d. %0.4f/sec", reqNum, reqNum / secs);
                 Json::Value progress;
                 progress["message"] = message; 
                 onProgress(progress);
@@ -400,7 +462,7 @@ run(const ProcedureRunConfig & run,
 
             if (runProcConf.mode == DT_MODE_BAG_OF_WORDS) {
                 // there is only a single table
-                DistTable & distTable = distTablesMap.begin()->second;
+                DistTable & distTable = tables.begin()->second;
 
                 for (const std::tuple<ColumnPath, CellValue, Date> & col :
                         row.columns) {
@@ -441,7 +503,7 @@ run(const ProcedureRunConfig & run,
                 }
 
                 // for each of our feature column (or distribution table)
-                for (auto it = distTablesMap.begin(); it != distTablesMap.end(); it++) {
+                for (auto it = tables.begin(); it != tables.end(); it++) {
                     const ColumnPath & featureColumnName = it->first;
                     DistTable & distTable = it->second;
 
@@ -505,11 +567,19 @@ run(const ProcedureRunConfig & run,
                    runProcConf.trainingData.stm->when,
                    *runProcConf.trainingData.stm->where,
                    extra,
-                   {processor,false/*processInParallel*/},
+                   {processor,parallelTrain},
                    runProcConf.trainingData.stm->orderBy,
                    runProcConf.trainingData.stm->offset,
                    runProcConf.trainingData.stm->limit);
 
+    if (parallelTrain) {
+        accum.forEach([&] (DistTablesMap * m)
+            {
+                for (auto & entry: *m)
+                    distTablesMap[entry.first].merge(std::move(entry.second));
+            });
+    }
+
     if(output) {
         output->commit();
     }
@@ -621,7 +691,9 @@ DistTableFunction(MldbEngine * owner,
     if(mode != DT_MODE_BAG_OF_WORDS && mode != DT_MODE_FIXED_COLUMNS)
         throw MLDB::Exception("Unsupported DistTable mode");
 
+    DistTablesMap distTablesMap;
     store >> distTablesMap;
+    distTables.store(std::make_shared<DistTablesMap>(std::move(distTablesMap)));
 
     // build a cache of the names for quick access
     for(int i=0; i<DT_NUM_STATISTICS; i++)
@@ -681,34 +753,37 @@ DistTableFunction::
 increment(const vector<pair<Utf8String, Utf8String>> & keys,
           const vector<double> & outcomes) const
 {
-    // get exclusive access
-    std::unique_lock<std::shared_mutex> uniqueLock(_access);
+    // Copy-on-update: writers serialize among themselves, apply their
+    // changes to a copy of the current snapshot and publish it
+    // atomically.  Readers are never blocked, and a failed update
+    // leaves the published tables untouched.
+    std::unique_lock<std::mutex> guard(_updateMutex);
+
+    auto updated = std::make_shared<DistTablesMap>(*distTables.load());
 
     for(const auto & key : keys) {
         Path pKey(key.first);
-        auto table_it = distTablesMap.find(pKey);
-        if(table_it == distTablesMap.end())
+        auto table_it = updated->find(pKey);
+        if(table_it == updated->end())
             throw MLDB::Exception("Unknown dist table '"+
                         key.first.utf8String()+"'");
 
         //for(double outcome : outcomes)
         (*table_it).second.increment(key.second, outcomes);
     }
+
+    distTables.store(std::move(updated));
 }
 
 void
 DistTableFunction::
 persist(const Url & modelFileUrl) const
 {
-    // get exclusive access
-    DistTablesMap copiedMap;
-    {
-        std::shared_lock<std::shared_mutex> uniqueLock(_access);
-        copiedMap = DistTablesMap(distTablesMap);
-    }
+    // The snapshot is immutable, so no copy is needed
+    auto tables = distTables.load();
 
     DistTableProcedure::persist(modelFileUrl,
-            mode, copiedMap);
+            mode, *tables);
 }
 
 DistTableFunction::
@@ -746,6 +821,11 @@ apply(const FunctionApplier & applier,
 
 
     RowValue rtnRow;
+
+    // Lock-free read of the current snapshot; concurrent increments
+    // publish new snapshots without touching this one
+    auto tables = distTables.load();
+
     // TODO should we cache column names
     auto onAtomFixedColumns =
         [&] (const ColumnPath & columnName,
@@ -753,8 +833,8 @@ apply(const FunctionApplier & applier,
              const CellValue & val,
              Date ts)
     {
-        auto st = distTablesMap.find(columnName);
-        if (st == distTablesMap.end())
+        auto st = tables->find(columnName);
+        if (st == tables->end())
             return true;
 
         const DistTable & distTable = st->second;
@@ -781,7 +861,7 @@ apply(const FunctionApplier & applier,
         if (val.empty())
             return true;
 
-        const DistTable & distTable = distTablesMap.begin()->second;
+        const DistTable & distTable = tables->begin()->second;
         const auto & stats = distTable.getStats(columnName.toUtf8String());
         for (int i=0; i < distTable.outcome_names.size(); ++i) {
             for(DISTTABLE_STATISTICS sid : activeStats) {
@@ -796,17 +876,13 @@ apply(const FunctionApplier & applier,
         return true;
     };
 
-    // get reader lock
-    {
-        std::shared_lock<std::shared_mutex> lock(_access);
-        switch(mode) {
-            case DT_MODE_FIXED_COLUMNS:
-                arg.forEachAtom(onAtomFixedColumns);
-                break;
-            case DT_MODE_BAG_OF_WORDS:
-                arg.forEachAtom(onAtomBow);
-                break;
-        }
+    switch(mode) {
+        case DT_MODE_FIXED_COLUMNS:
+            arg.forEachAtom(onAtomFixedColumns);
+            break;
+        case DT_MODE_BAG_OF_WORDS:
+            arg.forEachAtom(onAtomBow);
+            break;
     }
 
     result.emplace_back("stats", ExpressionValue(std::move(rtnRow)));
@@ -17,7 +17,8 @@
 #include "mldb/types/optional.h"
 #include "mldb/types/string.h"
 #include "mldb/rest/rest_request_router.h"
-#include <shared_mutex>
+#include "mldb/utils/atomic_shared_ptr.h"
+#include <mutex>
 #include <unordered_map>
 
 
@@ -92,6 +93,13 @@ struct DistTableStats {
     double getStat(DISTTABLE_STATISTICS stat) const;
 
     void increment(double value);
+
+    // Fold the stats of another accumulator into this one, as if all of
+    // its values had been incremented here.  The variance is combined
+    // with the parallel form of Welford's algorithm.  Note that `last`
+    // is taken from the other accumulator when it is non-empty, so
+    // merging shards accumulated in parallel makes it order-dependent.
+    void merge(const DistTableStats & other);
 };
 
 
@@ -110,6 +118,10 @@ struct DistTable {
     void increment(const Utf8String & featureValue,
                    const std::vector<double> & targets);
 
+    // Fold another table accumulated over a disjoint set of rows into
+    // this one
+    void merge(DistTable && other);
+
     // returns the stats for a given featureValue
     // and outcome
     const std::vector<DistTableStats> & getStats(
@@ -240,7 +252,9 @@ struct DistTableFunction: public Function {
                   const RestRequest & request,
                   RestRequestParsingContext & context) const override;
 
-    mutable std::shared_mutex _access;
+    /// Serializes copy-on-update writers (increment); readers never
+    /// take it
+    mutable std::mutex _updateMutex;
 
     DistTableFunctionConfig functionConfig;
     DistTableMode mode;
@@ -248,7 +262,11 @@ struct DistTableFunction: public Function {
     std::string dtStatsNames[DT_NUM_STATISTICS];
 
     std::vector<DISTTABLE_STATISTICS> activeStats;
-    mutable DistTablesMap distTablesMap;
+
+    /// Immutable snapshot of the tables.  Readers load the current
+    /// snapshot without locking; increment copies it, applies the
+    /// update and atomically publishes the new version.
+    mutable atomic_shared_ptr<const DistTablesMap> distTables;
 
     RestRequestRouter router;
 };
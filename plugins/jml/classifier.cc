@@ -35,6 +35,7 @@
 #include "mldb/plugins/jml/jml/registry.h"
 #include "mldb/plugins/jml/jml/onevsall_generator.h"
 #include "mldb/base/map_reduce.h"
+#include "mldb/block/file_serializer.h"
 #include "mldb/utils/string_functions.h"
 #include "mldb/core/analytics.h"
 #include "mldb/base/per_thread_accumulator.h"
@@ -132,6 +133,15 @@ ClassifierConfigDescription()
              "is a good number to use for unbalanced probabilities. "
              "See the [classifier configuration documentation](../ClassifierConf.md.html) for details.",
              0.5);
+    addField("outOfCoreStaging", &ClassifierConfig::outOfCoreStaging,
+             "If true, feature vectors extracted from the training data "
+             "are staged in a memory mapped temporary file instead of "
+             "accumulating on the heap, which allows much larger training "
+             "sets to be extracted without downsampling.  The assembled "
+             "training set passed to the algorithm must still fit in "
+             "memory.  The row ordering stays deterministic, but may "
+             "differ from the default path when a dataset contains "
+             "duplicated row names.", false);
     addField("modelFileUrl", &ClassifierConfig::modelFileUrl,
              "URL where the model file (with extension '.cls') should be saved. "
              "This file can be loaded by the ![](%%doclink classifier function). "
@@ -403,6 +413,9 @@ run(const ProcedureRunConfig & run,
     struct ThreadAccum {
         std::vector<Fv> fvs;
 
+        /// Approximate encoded size of fvs, for out of core staging
+        size_t stagedBytes = 0;
+
         // These are for categorical variables only.  Since we need to create a
         // stable label ordering to enable determinism in model training,
         // but we don't know the label alphabet ahead of time, we accumulate the
@@ -475,6 +488,125 @@ run(const ProcedureRunConfig & run,
 
     PerThreadAccumulator<ThreadAccum> accum;
 
+    /** Stages finished batches of feature vectors in a memory mapped
+        temporary file so that extraction is not limited by the heap.
+        Each batch is sorted before it is written, which lets the
+        training set be assembled later with a streaming merge over the
+        runs; the sequential reads get kernel readahead for free.
+
+        Labels are written with their per-thread encoding, since the
+        global label alphabet is only known once extraction has
+        finished; the mapping is applied when the run is read back.
+    */
+    struct FvSpiller {
+        FvSpiller()
+            : serializer("tmp", "classifier-training-staging")
+        {
+        }
+
+        /// Spill a thread's batch once it exceeds this many encoded bytes
+        enum : size_t { SPILL_BATCH_BYTES = 128ULL << 20 };
+
+        TemporaryFileSerializer serializer;
+        std::mutex mutex;
+
+        struct Run {
+            FrozenMemoryRegion region;
+            size_t numRows;
+            const ThreadAccum * thread;  ///< For label remapping on read
+        };
+
+        std::vector<Run> runs;
+
+        static size_t encodedBytes(const Fv & fv)
+        {
+            return 8  // name length and feature count
+                + fv.rowName.toUtf8String().rawLength()
+                + fv.featureSet.features.size()
+                * sizeof(std::pair<ML::Feature, float>);
+        }
+
+        void spill(std::vector<Fv> fvs, const ThreadAccum * thread)
+        {
+            if (fvs.empty())
+                return;
+
+            std::sort(fvs.begin(), fvs.end());
+
+            size_t totalBytes = 0;
+            for (const Fv & fv: fvs)
+                totalBytes += encodedBytes(fv);
+
+            MutableMemoryRegion region;
+            {
+                std::unique_lock<std::mutex> guard(mutex);
+                region = serializer.allocateWritable(totalBytes, 1);
+            }
+
+            char * p = region.data();
+            for (const Fv & fv: fvs) {
+                std::string name = fv.rowName.toUtf8String().stealRawString();
+                uint32_t nameLen = name.size();
+                uint32_t numFeats = fv.featureSet.features.size();
+                std::memcpy(p, &nameLen, 4);          p += 4;
+                std::memcpy(p, name.data(), nameLen); p += nameLen;
+                std::memcpy(p, &numFeats, 4);         p += 4;
+                size_t featBytes
+                    = numFeats * sizeof(std::pair<ML::Feature, float>);
+                std::memcpy(p, fv.featureSet.features.data(), featBytes);
+                p += featBytes;
+            }
+            ExcAssertEqual(p - region.data(), totalBytes);
+
+            std::unique_lock<std::mutex> guard(mutex);
+            FrozenMemoryRegion frozen = serializer.freeze(region);
+            runs.emplace_back(Run{std::move(frozen), fvs.size(), thread});
+        }
+
+        /** Reads one run back, remapping labels as it goes. */
+        struct Cursor {
+            const char * p = nullptr;
+            size_t rowsLeft = 0;
+            const ThreadAccum * thread = nullptr;
+            Fv current;
+
+            void advance()
+            {
+                ExcAssertGreater(rowsLeft, 0);
+                uint32_t nameLen, numFeats;
+                std::memcpy(&nameLen, p, 4);  p += 4;
+                RowPath rowName = RowPath::parse(p, nameLen);
+                p += nameLen;
+                std::memcpy(&numFeats, p, 4);  p += 4;
+                ML::Mutable_Feature_Set::features_type feats(numFeats);
+                std::memcpy(feats.data(), p,
+                            numFeats * sizeof(std::pair<ML::Feature, float>));
+                p += numFeats * sizeof(std::pair<ML::Feature, float>);
+                --rowsLeft;
+
+                current = Fv(std::move(rowName),
+                             ML::Mutable_Feature_Set(std::move(feats)));
+
+                // Map the per-thread label onto the global alphabet,
+                // like ThreadAccum::sort() does for in-memory vectors
+                if (!thread->multilabelMapping.empty()) {
+                    float label = current.label();
+                    ExcAssert(thread->multilabelMapping.count(label));
+                    current.setLabel(thread->multilabelMapping.at(label));
+                }
+                else if (!thread->labelMapping.empty()) {
+                    float label = current.label();
+                    ExcAssert(thread->labelMapping.count(label));
+                    current.setLabel(thread->labelMapping.at(label));
+                }
+            }
+        };
+    };
+
+    std::unique_ptr<FvSpiller> spiller;
+    if (runProcConf.outOfCoreStaging)
+        spiller.reset(new FvSpiller());
+
     auto accumRow = [&] (float weight,
                          const MatrixNamedRow& row,
                          float encodedLabel,
@@ -517,6 +649,15 @@ run(const ProcedureRunConfig & run,
         }
 
         thr.fvs.emplace_back(row.rowName, std::move(features));
+
+        if (spiller) {
+            thr.stagedBytes += FvSpiller::encodedBytes(thr.fvs.back());
+            if (thr.stagedBytes >= FvSpiller::SPILL_BATCH_BYTES) {
+                spiller->spill(std::move(thr.fvs), &thr);
+                thr.fvs.clear();
+                thr.stagedBytes = 0;
+            }
+        }
     };
 
 
@@ -771,29 +912,48 @@ run(const ProcedureRunConfig & run,
 
     timer.restart();
 
-    parallelMergeSortRecursive(accum.threads, 0, accum.threads.size(),
-                               [] (const std::shared_ptr<ThreadAccum> & t)
-                               {
-                                   t->sort();
-                               },
-                               [] (const std::shared_ptr<ThreadAccum> & t1,
-                                   const std::shared_ptr<ThreadAccum> & t2)
-                               {
-                                   ThreadAccum::merge(*t1, *t2);
-                               },
-                               [] (const std::shared_ptr<ThreadAccum> & t)
-                               {
-                                   return t->fvs.size();
-                               },
-                               10000 /* thread threshold */);
-
-    INFO_MSG(logger) << "merged feature vectors in " << timer.elapsed();
-
-    if (!accum.threads.empty()) {
-        fvs = std::move(accum.threads[0]->fvs);
+    if (spiller) {
+        // Push the remaining batches out to the staging file with their
+        // per-thread labels still in place; the label mapping is applied
+        // when the runs are read back, so it must not be cleared here.
+        auto onThreadSpill = [&] (ThreadAccum * acc)
+            {
+                spiller->spill(std::move(acc->fvs), acc);
+                acc->fvs.clear();
+                acc->stagedBytes = 0;
+            };
+
+        accum.forEach(onThreadSpill);
+
+        INFO_MSG(logger) << "staged feature vectors in " << timer.elapsed()
+                         << " (" << spiller->runs.size() << " runs, "
+                         << spiller->serializer.getLength() << " bytes)";
     }
+    else {
+        parallelMergeSortRecursive(accum.threads, 0, accum.threads.size(),
+                                   [] (const std::shared_ptr<ThreadAccum> & t)
+                                   {
+                                       t->sort();
+                                   },
+                                   [] (const std::shared_ptr<ThreadAccum> & t1,
+                                       const std::shared_ptr<ThreadAccum> & t2)
+                                   {
+                                       ThreadAccum::merge(*t1, *t2);
+                                   },
+                                   [] (const std::shared_ptr<ThreadAccum> & t)
+                                   {
+                                       return t->fvs.size();
+                                   },
+                                   10000 /* thread threshold */);
+
+        INFO_MSG(logger) << "merged feature vectors in " << timer.elapsed();
+
+        if (!accum.threads.empty()) {
+            fvs = std::move(accum.threads[0]->fvs);
+        }
 
-    ExcAssertEqual(fvs.size(), numRows);
+        ExcAssertEqual(fvs.size(), numRows);
+    }
 
     int nx = numRows;
 
@@ -847,10 +1007,10 @@ run(const ProcedureRunConfig & run,
 
     distribution<float> exampleWeights(nx);
 
-    for (unsigned i = 0;  i < nx;  ++i) {
+    auto addTrainingRow = [&] (Fv & fv, unsigned i) {
 
-        float label  = fvs[i].label(); //IF MULTILABEL THIS LABEL IS A GLOBAL COMBINAISON LABEL
-        float weight = fvs[i].weight();
+        float label  = fv.label(); //IF MULTILABEL THIS LABEL IS A GLOBAL COMBINAISON LABEL
+        float weight = fv.weight();
 
         if (weight < 0)
             throw AnnotatedException(400, "classifier example weight cannot be negative");
@@ -866,7 +1026,7 @@ run(const ProcedureRunConfig & run,
                  "or preprocess your labels with `replace_not_finite(label, 0)`?");
         }
 
-        trainingSet.add_example(std::make_shared<ML::Mutable_Feature_Set>(std::move(fvs[i].featureSet)));
+        trainingSet.add_example(std::make_shared<ML::Mutable_Feature_Set>(std::move(fv.featureSet)));
 
         if(runProcConf.mode != CM_REGRESSION) {
 
@@ -888,6 +1048,40 @@ run(const ProcedureRunConfig & run,
         }
 
         exampleWeights[i]  = weight;
+    };
+
+    if (!spiller) {
+        for (unsigned i = 0;  i < nx;  ++i)
+            addTrainingRow(fvs[i], i);
+    }
+    else {
+        // Streaming merge of the sorted runs straight into the training
+        // set.  The regions are memory mapped and read sequentially, so
+        // only the pages at each run's cursor need to be resident.
+        std::vector<FvSpiller::Cursor> cursors;
+        for (auto & run: spiller->runs) {
+            FvSpiller::Cursor cursor;
+            cursor.p = run.region.data();
+            cursor.rowsLeft = run.numRows;
+            cursor.thread = run.thread;
+            cursor.advance();
+            cursors.emplace_back(std::move(cursor));
+        }
+
+        unsigned i = 0;
+        while (!cursors.empty()) {
+            size_t best = 0;
+            for (size_t c = 1;  c < cursors.size();  ++c) {
+                if (cursors[c].current < cursors[best].current)
+                    best = c;
+            }
+            addTrainingRow(cursors[best].current, i++);
+            if (cursors[best].rowsLeft == 0)
+                cursors.erase(cursors.begin() + best);
+            else cursors[best].advance();
+        }
+
+        ExcAssertEqual(i, nx);
     }
 
     ExcAssertEqual(nx, trainingSet.example_count());
@@ -74,6 +74,11 @@ struct ClassifierConfig : public ProcedureConfig {
     // Strategy to handle multilabel
     MultilabelStrategy multilabelStrategy = MULTILABEL_ONEVSALL;
 
+    /// If true, extracted feature vectors are staged in a memory mapped
+    /// temporary file instead of the heap while the training set is
+    /// assembled
+    bool outOfCoreStaging = false;
+
     // Function name
     Utf8String functionName;
 };
@@ -166,6 +166,34 @@ score(const distribution<float> & features) const
     return classifier_->predict(1, mapper_output, opt_info_);
 }
 
+void
+DenseClassifier::
+scoreBatch(const float * features, size_t stride, size_t n,
+           float * out) const
+{
+    size_t nv = mapping_.num_vars_expected_;
+
+    // Encode a block of rows at a time into a single reused buffer.
+    // The block is sized so that the encoded rows stay in cache while
+    // the classifier walks over them.
+    constexpr size_t BLOCK_SIZE = 64;
+    std::vector<float> encoded(std::min(n, BLOCK_SIZE) * nv);
+
+    for (size_t start = 0;  start < n;  start += BLOCK_SIZE) {
+        size_t end = std::min(n, start + BLOCK_SIZE);
+
+        for (size_t i = start;  i < end;  ++i)
+            classifier_fs_->encode(features + i * stride,
+                                   encoded.data() + (i - start) * nv,
+                                   *input_fs_,
+                                   mapping_);
+
+        for (size_t i = start;  i < end;  ++i)
+            out[i] = classifier_->predict
+                (1, encoded.data() + (i - start) * nv, opt_info_);
+    }
+}
+
 float
 DenseClassifier::
 scoreUnbiased(const distribution<float> & features,
@@ -61,6 +61,18 @@ struct DenseClassifier {
     /** Calculate the score for a given feature set. */
     float score(const distribution<float> & features) const;
 
+    /** Calculate scores for a batch of feature vectors.  Row i of the
+        batch starts at features + i * stride (stride is in floats, so a
+        packed layout passes stride == variableCount()).  Scores are
+        written to out[0..n-1].
+
+        This is equivalent to calling score() once per row, but encodes
+        rows in blocks through a single reused buffer so that the
+        per-call setup cost is amortized and the encoded block stays
+        cache resident across the predict calls. */
+    void scoreBatch(const float * features, size_t stride, size_t n,
+                    float * out) const;
+
     /** Calculate the score for a given feature set. */
     float scoreUnbiased(const distribution<float> & features,
                         PipelineExecutionContext & context) const;
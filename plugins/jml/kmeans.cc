@@ -11,6 +11,8 @@
 
 #include <random>
 #include "mldb/utils/smart_ptr_utils.h"
+#include "mldb/utils/compute_provider.h"
+#include "mldb/arch/simd_vector.h"
 
 namespace ML {
 namespace DB = MLDB::DB;
@@ -21,7 +23,8 @@ train(const std::vector<distribution<float>> & points,
       std::vector<int> & in_cluster,
       int nbClusters,
       int maxIterations,
-      int randomSeed
+      int randomSeed,
+      int miniBatchIterations
       )
 {
     using namespace std;
@@ -80,6 +83,82 @@ train(const std::vector<distribution<float>> & points,
         // cerr << "norm of best init centroid " << clusters[i].centroid.two_norm() << endl;
     }
 
+    // The triangle inequality bounds below only hold for a true metric,
+    // so they are only used with the euclidean distance (the cosine
+    // "distance" is not a metric; see its comment)
+    bool useBounds
+        = dynamic_cast<KMeansEuclideanMetric *>(metric.get()) != nullptr;
+
+    // Distance between two points, using the SIMD euclidean kernel over
+    // the contiguous coordinates when we can (the generic metric builds
+    // a temporary for the difference)
+    auto pointDistance = [&] (const distribution<float> & x,
+                              const distribution<float> & y) -> float
+        {
+            if (useBounds)
+                return std::sqrt(MLDB::SIMD::vec_euclid(x.data(), y.data(),
+                                                        x.size()));
+            return metric->distance(x, y);
+        };
+
+    // Optional mini batch warm start: assignment over a random subsample
+    // is enough to move the centroids most of the way, at a fraction of
+    // the cost of a full pass
+    size_t miniBatchSize
+        = std::min<size_t>(npoints,
+                           std::max<size_t>(100 * (size_t)nbClusters,
+                                            1 << 17));
+
+    for (int iter = 0;  iter < miniBatchIterations;  ++iter) {
+        std::vector<int> batch(miniBatchSize);
+        for (auto & b: batch)
+            b = rng() % npoints;
+
+        std::vector<int> batchCluster(miniBatchSize, -1);
+
+        auto assignOne = [&] (size_t j)
+            {
+                batchCluster[j] = this->assign(points[batch[j]]);
+            };
+
+        MLDB::parallelMap(0, miniBatchSize, assignOne);
+
+        std::vector<int> counts(nbClusters, 0);
+        for (auto & c: batchCluster)
+            ++counts[c];
+
+        for (unsigned c = 0;  c < nbClusters;  ++c)
+            if (counts[c] > 0)
+                std::fill(clusters[c].centroid.begin(),
+                          clusters[c].centroid.end(), 0.0);
+
+        std::vector<std::mutex> locks(nbClusters);
+
+        auto addBatchPoint = [&] (size_t j)
+            {
+                int cluster = batchCluster[j];
+                std::unique_lock<std::mutex> guard(locks[cluster]);
+                metric->contributeToAverage(clusters[cluster].centroid,
+                                            points[batch[j]],
+                                            1. / (double) counts[cluster]);
+            };
+
+        MLDB::parallelMap(0, miniBatchSize, addBatchPoint);
+
+        cerr << "done mini batch warm start iter " << iter << endl;
+    }
+
+    // Hamerly's bounds: for each point, an upper bound on the distance
+    // to its assigned centroid and a lower bound on the distance to any
+    // other centroid.  A point whose upper bound is below both the lower
+    // bound and half the distance from its centroid to the nearest other
+    // centroid provably keeps its assignment, without computing any
+    // distance at all.
+    std::vector<float> upperBound, lowerBound;
+    if (useBounds) {
+        upperBound.assign(npoints, INFINITY);
+        lowerBound.assign(npoints, 0.0f);
+    }
 
     for (int iter = 0;  iter < maxIterations;  ++iter) {
 
@@ -104,9 +183,84 @@ train(const std::vector<distribution<float>> & points,
 
         std::vector<AI> clusterNumMembers(nbClusters);
 
+        // Half the distance from each centroid to its nearest other
+        // centroid.  A point closer to its centroid than this cannot be
+        // closer to any other centroid (triangle inequality).  The
+        // centroid-to-centroid distance matrix goes through the compute
+        // provider, so it runs on an accelerator when one is registered.
+        std::vector<float> halfNearest;
+        if (useBounds) {
+            halfNearest.resize(nbClusters, INFINITY);
+
+            size_t dims = clusters[0].centroid.size();
+            std::vector<float> centroidsFlat(nbClusters * dims);
+            for (int c = 0;  c < nbClusters;  ++c)
+                std::copy(clusters[c].centroid.begin(),
+                          clusters[c].centroid.end(),
+                          &centroidsFlat[c * dims]);
+
+            std::vector<float> centroidDistSq((size_t)nbClusters * nbClusters);
+            MLDB::bestComputeProvider()
+                .pairwiseSquaredDistances(centroidsFlat.data(), nbClusters,
+                                          centroidsFlat.data(), nbClusters,
+                                          dims, centroidDistSq.data());
+
+            for (int c = 0;  c < nbClusters;  ++c) {
+                float distMin = INFINITY;
+                for (int k = 0;  k < nbClusters;  ++k)
+                    if (k != c)
+                        distMin = std::min(distMin,
+                                           centroidDistSq[c * (size_t)nbClusters + k]);
+                halfNearest[c] = 0.5f * std::sqrt(distMin);
+            }
+        }
+
         auto findNewCluster = [&] (int i) {
 
-            int best_cluster = this->assign(points[i]);
+            int best_cluster = in_cluster[i];
+
+            if (useBounds && best_cluster != -1) {
+                float bound = std::max(halfNearest[best_cluster],
+                                       lowerBound[i]);
+                if (upperBound[i] > bound) {
+                    // Tighten the upper bound before paying for the
+                    // full scan; most points stop here once the
+                    // clustering starts to settle
+                    upperBound[i]
+                        = pointDistance(points[i],
+                                        clusters[best_cluster].centroid);
+                }
+                if (upperBound[i] <= bound) {
+                    ++clusterNumMembers[best_cluster];
+                    return;
+                }
+            }
+
+            if (useBounds) {
+                // Full scan, keeping track of the distance to the
+                // second closest centroid to set the lower bound
+                float distMin = INFINITY, distSecond = INFINITY;
+                best_cluster = -1;
+                for (int c = 0;  c < nbClusters;  ++c) {
+                    float dist = pointDistance(points[i],
+                                               clusters[c].centroid);
+                    if (dist < distMin) {
+                        distSecond = distMin;
+                        distMin = dist;
+                        best_cluster = c;
+                    }
+                    else distSecond = std::min(distSecond, dist);
+                }
+                if (best_cluster == -1) {
+                    cerr << MLDB::format("something went wrong when assigning "
+                                         "this vector with norm [%f]",
+                                         points[i].two_norm()) << endl;
+                    best_cluster = 0;
+                }
+                upperBound[i] = distMin;
+                lowerBound[i] = distSecond;
+            }
+            else best_cluster = this->assign(points[i]);
 
             if (best_cluster != in_cluster[i]) {
                 ++changes;
@@ -143,6 +297,13 @@ train(const std::vector<distribution<float>> & points,
         // std::cerr << "\niter " << iter << std::endl;
 
         // Calculate means
+        std::vector<distribution<float> > oldCentroids;
+        if (useBounds) {
+            oldCentroids.reserve(nbClusters);
+            for (auto & c: clusters)
+                oldCentroids.push_back(c.centroid);
+        }
+
         for (auto & c : clusters)
             // If no member, we want to leave it there
             if (c.nbMembers > 0)
@@ -164,6 +325,26 @@ train(const std::vector<distribution<float>> & points,
 
         MLDB::parallelMap(0, points.size(), addToMeanForPoint);
 
+        if (useBounds) {
+            // The bounds degrade by how far the centroids moved: the
+            // assigned centroid's own drift for the upper bound, the
+            // largest drift of any centroid for the lower bound
+            std::vector<float> drift(nbClusters);
+            float maxDrift = 0.0f;
+            for (int c = 0;  c < nbClusters;  ++c) {
+                drift[c] = pointDistance(oldCentroids[c],
+                                         clusters[c].centroid);
+                maxDrift = std::max(maxDrift, drift[c]);
+            }
+
+            auto updateBounds = [&] (int i) {
+                upperBound[i] += drift[in_cluster[i]];
+                lowerBound[i] -= maxDrift;
+            };
+
+            MLDB::parallelMap(0, points.size(), updateBounds);
+        }
+
         // for (int i=0; i < clusters.size(); ++i) {
             // cerr << "cluster " << i << " had " << clusters[i].nbMembers
                  // << " members\n";
@@ -149,11 +149,17 @@ struct KMeans {
     std::vector<Cluster> clusters;
     std::shared_ptr<KMeansMetric> metric;
     
+    // Train the clustering.  When the metric is euclidean, assignment
+    // uses Hamerly's triangle inequality bounds to skip points whose
+    // cluster provably did not change.  miniBatchIterations cheap
+    // iterations over random subsamples can be run first to move the
+    // centroids most of the way before the full passes begin.
     void train(const std::vector<distribution<float> > & points,
                std::vector<int> & in_cluster,
                int nclusters=100,
                int maxIterations = 100,
-               int randomSeed = 1);
+               int randomSeed = 1,
+               int miniBatchIterations = 0);
 
     distribution<float> centroidDistances(const distribution<float> & point) const;
 
@@ -74,6 +74,12 @@ KmeansConfigDescription()
              "Maximum number of iterations to perform.  If no convergeance is "
              "reached within this number of iterations, the current clustering "
              "will be returned.", 100);
+    addField("miniBatchIterations", &KmeansConfig::miniBatchIterations,
+             "Number of mini-batch iterations to perform over random "
+             "subsamples of the input before the full iterations begin. "
+             "These move the centroids most of the way at a fraction of the "
+             "cost of a full pass, which speeds up convergence on large "
+             "datasets.  Zero (the default) disables the warm start.", 0);
     addField("metric", &KmeansConfig::metric,
              "Metric space in which the k-means distances will be calculated. "
              "Normally this will be Cosine for an orthonormal basis, and "
@@ -198,7 +204,8 @@ run(const ProcedureRunConfig & run,
     int numClusters = runProcConf.numClusters;
     int numIterations = runProcConf.maxIterations;
 
-    kmeans.train(vecs, inCluster, numClusters, numIterations);
+    kmeans.train(vecs, inCluster, numClusters, numIterations,
+                 1 /* random seed */, runProcConf.miniBatchIterations);
 
     bool saved = false;
     if (!runProcConf.modelFileUrl.empty()) {
@@ -294,6 +294,16 @@ struct PartitionData {
 
     typedef WT<ML::FixedPointAccum64> W;
 
+    /** Maximum number of histogram bins used to evaluate splits on a
+        single feature.  Ordinal features with more distinct buckets than
+        this are accumulated into fixed-width bins so that split
+        evaluation stays a small, cache friendly array walk no matter how
+        many distinct values the feature has.  Categorical features keep
+        their full resolution, since merging unrelated categories into
+        one bin would change the meaning of an equality split.
+    */
+    static constexpr int MAX_SPLIT_BUCKETS = 256;
+
     /** Split the partition here. */
     std::pair<PartitionData, PartitionData>
     split(int featureToSplitOn, int splitValue, const W & wLeft, const W & wRight, const W & wAll,
@@ -413,6 +423,10 @@ struct PartitionData {
         std::vector< std::vector<W> > w(nf);
         std::vector< int > maxSplits(nf);
 
+        // Number of raw buckets for features accumulated into fixed
+        // width histogram bins; zero for features at full resolution
+        std::vector< uint32_t > binnedBuckets(nf, 0);
+
         size_t totalNumBuckets = 0;
         size_t activeFeatures = 0;
 
@@ -420,8 +434,13 @@ struct PartitionData {
             if (!features[i].active)
                 continue;
             ++activeFeatures;
-            w[i].resize(features[i].buckets.numBuckets);
-            totalNumBuckets += features[i].buckets.numBuckets;
+            uint32_t numBuckets = features[i].buckets.numBuckets;
+            if (features[i].ordinal && numBuckets > MAX_SPLIT_BUCKETS) {
+                binnedBuckets[i] = numBuckets;
+                numBuckets = MAX_SPLIT_BUCKETS;
+            }
+            w[i].resize(numBuckets);
+            totalNumBuckets += numBuckets;
         }
 
         if (debug) {
@@ -448,6 +467,8 @@ struct PartitionData {
                 bool twoBuckets = false;
                 int lastBucket = -1;
 
+                uint64_t numRaw = binnedBuckets[i];
+
                 for (size_t j = 0;  j < rows.size();  ++j) {
                     auto & r = rows[j];
                     int bucket = features[i].buckets[r.exampleNum];
@@ -456,6 +477,11 @@ struct PartitionData {
                         || (lastBucket != -1 && bucket != lastBucket);
                     lastBucket = bucket;
 
+                    // Collapse high resolution ordinal features into
+                    // fixed width histogram bins
+                    if (numRaw != 0)
+                        bucket = bucket * MAX_SPLIT_BUCKETS / numRaw;
+
                     //ExcAssertLess(i, w.size());
                     //ExcAssertLess(bucket, w[i].size());
                     //ExcAssertLess(r.label, w[i][bucket].nl());
@@ -471,10 +497,15 @@ struct PartitionData {
                 maxSplits[i] = maxBucket;
             };
 
-        if (depth < 4 || true) {
+        if (depth < 4) {
+            // Near the root there are few nodes, so spread the work
+            // across features
             parallelMap(0, nf + 1, doFeature);
         }
         else {
+            // Deeper down, the node level parallelism in train() already
+            // keeps every thread busy; per-feature tasks would only add
+            // scheduling overhead
             for (unsigned i = 0;  i <= nf;  ++i)
                 doFeature(i);
         }
@@ -588,7 +619,20 @@ struct PartitionData {
 
             }
         }
-        
+
+        // A split on a binned feature is in bin space; convert it back
+        // to the raw bucket space used by split() and the tree itself.
+        // The left side of bin split j holds bins [0, j), so the
+        // equivalent raw split point is just before the first raw bucket
+        // of bin j.
+        if (bestFeature != -1 && binnedBuckets[bestFeature] != 0) {
+            uint64_t numRaw = binnedBuckets[bestFeature];
+            uint64_t firstRaw
+                = ((uint64_t)bestSplit * numRaw + MAX_SPLIT_BUCKETS - 1)
+                / MAX_SPLIT_BUCKETS;
+            bestSplit = firstRaw == 0 ? 0 : firstRaw - 1;
+        }
+
         if (debug) {
             std::cerr << "buckets: empty " << bucketsEmpty << " one " << bucketsOne
                  << " both " << bucketsBoth << std::endl;
@@ -36,6 +36,7 @@
 #include "mldb/utils/vantage_point_tree.h"
 #include <fstream>
 #include <functional>
+#include <mutex>
 
 using namespace std;
 
@@ -1582,6 +1583,12 @@ struct CalcRepContext {
             com[1] = ((node.centerOfMass[1] - inside*y[1]) * ncr) - y[1];
             distSq = com[0] * com[0] + com[1] * com[1];
         }
+        else if (nd == 3) {
+            com[0] = ((node.centerOfMass[0] - inside*y[0]) * ncr) - y[0];
+            com[1] = ((node.centerOfMass[1] - inside*y[1]) * ncr) - y[1];
+            com[2] = ((node.centerOfMass[2] - inside*y[2]) * ncr) - y[2];
+            distSq = com[0] * com[0] + com[1] * com[1] + com[2] * com[2];
+        }
         else {
             for (unsigned i = 0;  i < nd;  ++i) {
                 com[i] = ((node.centerOfMass[i] - inside*y[i]) * ncr) - y[i];
@@ -1613,8 +1620,23 @@ struct CalcRepContext {
 
             exampleZ += effectiveNumChildren * qCellZ;
 
-            for (unsigned i = 0;  i < nd;  ++i) {
-                FrepZ[i] += effectiveNumChildren * com[i] * qCellZ * qCellZ;
+            // Hoist the per-node factor out so that the per-dimension
+            // work is a single fused multiply-add
+            float repFactor = effectiveNumChildren * qCellZ * qCellZ;
+
+            if (nd == 2) {
+                FrepZ[0] += repFactor * com[0];
+                FrepZ[1] += repFactor * com[1];
+            }
+            else if (nd == 3) {
+                FrepZ[0] += repFactor * com[0];
+                FrepZ[1] += repFactor * com[1];
+                FrepZ[2] += repFactor * com[2];
+            }
+            else {
+                for (unsigned i = 0;  i < nd;  ++i) {
+                    FrepZ[i] += repFactor * com[i];
+                }
             }
 
             if (onNode) {
@@ -1800,16 +1822,124 @@ tsneApproxFromSparse(const std::vector<TsneSparseProbs> & exampleNeighbours,
             qtreePtr.reset(new Quadtree(minc, maxc));
             Quadtree & qtree = *qtreePtr;
 
-            // Insert the values into the quadtree
-            for (unsigned i = 0;  i < nx;  ++i) {
-                QCoord coord(nd);
-                for (unsigned j = 0;  j < nd;  ++j) {
-                    coord[j] = Y[i][j];
+            if (nx < 16384) {
+                // Insert the values into the quadtree
+                for (unsigned i = 0;  i < nx;  ++i) {
+                    QCoord coord(nd);
+                    for (unsigned j = 0;  j < nd;  ++j) {
+                        coord[j] = Y[i][j];
+                    }
+
+                    qtree.insert(coord);
+                }
+            }
+            else {
+                // For large point sets, the serial insertion dominates the
+                // iteration time.  Instead, partition the points by their
+                // cell two levels down (the first two digits of their
+                // Morton order), build each cell's subtree in parallel,
+                // and stitch the cells back under the root.  The node
+                // contents are identical to those of a serial insertion.
+                int nq = 1 << nd;
+                int ncells = nq * nq;
+
+                // Bounds of the given quadrant of a cell with the given
+                // bounds; same scheme as QuadtreeNode::insert()
+                auto quadrantBounds = [&] (const QCoord & mins,
+                                           const QCoord & maxs,
+                                           int quad,
+                                           QCoord & qmins,
+                                           QCoord & qmaxs)
+                    {
+                        qmins.resize(nd);
+                        qmaxs.resize(nd);
+                        for (unsigned i = 0;  i < nd;  ++i) {
+                            float center = 0.5f * (mins[i] + maxs[i]);
+                            bool less = quad & (1 << i);
+                            qmins[i] = less ? mins[i] : center;
+                            qmaxs[i] = less ? center : maxs[i];
+                        }
+                    };
+
+                QCoord rootCenter(nd);
+                for (unsigned i = 0;  i < nd;  ++i)
+                    rootCenter[i] = 0.5f * (minc[i] + maxc[i]);
+
+                std::vector<QCoord> quadCenters(nq, QCoord(nd));
+                for (int q = 0;  q < nq;  ++q) {
+                    QCoord qmins, qmaxs;
+                    quadrantBounds(minc, maxc, q, qmins, qmaxs);
+                    for (unsigned i = 0;  i < nd;  ++i)
+                        quadCenters[q][i] = 0.5f * (qmins[i] + qmaxs[i]);
                 }
 
-                qtree.insert(coord);
+                std::vector<QCoord> coords(nx);
+                std::vector<std::vector<int> > cellPoints(ncells);
+
+                for (unsigned i = 0;  i < nx;  ++i) {
+                    coords[i] = QCoord(&Y[i][0], &Y[i][0] + nd);
+                    int q1 = QuadtreeNode::quadrant(rootCenter, coords[i]);
+                    int q2 = QuadtreeNode::quadrant(quadCenters[q1],
+                                                    coords[i]);
+                    cellPoints[q1 * nq + q2].push_back(i);
+                }
+
+                std::vector<QuadtreeNode *> cellNodes(ncells, nullptr);
+
+                auto buildCell = [&] (int cell)
+                    {
+                        const std::vector<int> & pts = cellPoints[cell];
+                        if (pts.empty())
+                            return;
+                        int q1 = cell / nq, q2 = cell % nq;
+                        QCoord mins1, maxs1, mins2, maxs2;
+                        quadrantBounds(minc, maxc, q1, mins1, maxs1);
+                        quadrantBounds(mins1, maxs1, q2, mins2, maxs2);
+                        std::unique_ptr<QuadtreeNode> node
+                            (new QuadtreeNode(mins2, maxs2, coords[pts[0]]));
+                        for (unsigned i = 1;  i < pts.size();  ++i)
+                            node->insert(coords[pts[i]], 2 /* depth */);
+                        cellNodes[cell] = node.release();
+                    };
+
+                MLDB::parallelMap(0, ncells, buildCell);
+
+                // Stitch the cell subtrees back under the root, fixing up
+                // the counts and centers of mass (which are sums of the
+                // points underneath, so they aggregate by addition)
+                QuadtreeNode * root = qtree.root.get();
+                root->type = QuadtreeNode::NODE;
+
+                for (int q1 = 0;  q1 < nq;  ++q1) {
+                    QCoord mins1, maxs1;
+                    quadrantBounds(minc, maxc, q1, mins1, maxs1);
+
+                    std::unique_ptr<QuadtreeNode> node1;
+                    for (int q2 = 0;  q2 < nq;  ++q2) {
+                        QuadtreeNode * cellNode = cellNodes[q1 * nq + q2];
+                        if (!cellNode)
+                            continue;
+                        if (!node1) {
+                            node1.reset(new QuadtreeNode(mins1, maxs1));
+                            node1->type = QuadtreeNode::NODE;
+                        }
+                        node1->quadrants[q2] = cellNode;
+                        node1->numChildren += cellNode->numChildren;
+                        for (unsigned i = 0;  i < nd;  ++i)
+                            node1->centerOfMass[i]
+                                += cellNode->centerOfMass[i];
+                    }
+
+                    if (!node1)
+                        continue;
+
+                    root->numChildren += node1->numChildren;
+                    for (unsigned i = 0;  i < nd;  ++i)
+                        root->centerOfMass[i] += node1->centerOfMass[i];
+                    root->quadrants[q1] = node1.release();
+                }
             }
-        
+
             int numNodes MLDB_UNUSED = qtree.root->finish();
 
             return qtree;
@@ -2002,33 +2132,18 @@ tsneApproxFromSparse(const std::vector<TsneSparseProbs> & exampleNeighbours,
                 //         << endl;
             };
 
-#if 1
-        int totalThreads = std::max(1, std::min(16, MLDB::numCpus() / 2));
-
-        auto doThread = [&] (int n)
+        // Distribute the examples in chunks over the whole thread pool
+        // rather than statically pre-partitioning them: the per-example
+        // cost varies with the local density of the embedding, and a
+        // static partition leaves threads idle at the end of each
+        // iteration.
+        auto doChunk = [&] (size_t x0, size_t x1)
             {
-                int perThread = nx / totalThreads;
-                int start = n * perThread;
-                int end = start + perThread;
-                if (n == totalThreads)
-                    end = nx;
-
-                for (unsigned x = start;  x < end;  ++x)
+                for (size_t x = x0;  x < x1;  ++x)
                     calcExample(x);
-
-                //for (unsigned x = n;  x < nx;  x += totalThreads) {
-                //    calcExample(x);
-                //}
             };
 
-        MLDB::parallelMap(0, totalThreads, doThread);
-        //parallelMap(0, nx, calcExample);
-#else
-        // Each example proceeds more or less independently
-        for (unsigned x = 0;  x < nx;  ++x) {
-            calcExample(x);
-        }
-#endif
+        MLDB::parallelMapChunked(0, nx, 1024 /* chunk size */, doChunk);
 
         // Sort from smallest to largest to accumulate.  This minimises
         // rounding errors and makes the result independent of the order
@@ -309,6 +309,17 @@ run(const ProcedureRunConfig & run,
             if (iter == 1 || iter % 10 == 0)
                 INFO_MSG(logger) << "phase " << phase << " iter " << iter
                      << " cost " << cost;
+
+            // At the end of each iteration, stream the progress out to
+            // the caller, who can return false to stop the optimization
+            // early.  The embedding as it stands is then recorded as the
+            // result.
+            if (phase == "recenter" && onProgress) {
+                Json::Value progress;
+                progress["iteration"] = iter;
+                progress["cost"] = cost;
+                return onProgress(progress);
+            }
             return true;
         };
 
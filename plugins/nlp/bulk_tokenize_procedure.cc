@@ -0,0 +1,203 @@
+/** bulk_tokenize_procedure.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Procedure that tokenizes a whole column of documents in parallel.
+*/
+
+#include "bulk_tokenize_procedure.h"
+#include "mldb/core/mldb_engine.h"
+#include "mldb/core/analytics.h"
+#include "mldb/core/recorder.h"
+#include "mldb/core/dataset_scope.h"
+#include "mldb/sql/sql_expression.h"
+#include "mldb/base/parallel.h"
+#include "mldb/base/parse_context.h"
+#include "mldb/types/basic_value_descriptions.h"
+#include "mldb/types/any_impl.h"
+#include "mldb/builtin/sql_config_validator.h"
+#include "mldb/utils/log.h"
+#include <mutex>
+
+using namespace std;
+
+
+namespace MLDB {
+
+BulkTokenizeConfig::
+BulkTokenizeConfig()
+{
+    outputDataset.withType("tabular");
+    tokenization.splitchar = " ";
+}
+
+DEFINE_STRUCTURE_DESCRIPTION(BulkTokenizeConfig);
+
+BulkTokenizeConfigDescription::
+BulkTokenizeConfigDescription()
+{
+    addField("inputData", &BulkTokenizeConfig::inputData,
+             "An SQL query returning the documents to tokenize.  Each row "
+             "is one document: the row name is kept as the output row name "
+             "and the value of the first selected column is the text of "
+             "the document.");
+    addField("outputDataset", &BulkTokenizeConfig::outputDataset,
+             GENERIC_OUTPUT_DS_DESC,
+             PolyConfigT<Dataset>().withType("tabular"));
+    addField("tokenization", &BulkTokenizeConfig::tokenization,
+             "Options controlling how each document is split into terms.  "
+             "These are the same options that the `tokenize` builtin "
+             "function accepts as its second argument, except that "
+             "`splitChars` defaults to a space.");
+    addParent<ProcedureConfig>();
+
+    onPostValidate = validateQuery(&BulkTokenizeConfig::inputData,
+                                   MustContainFrom());
+}
+
+
+/*****************************************************************************/
+/* BULK TOKENIZE PROCEDURE                                                   */
+/*****************************************************************************/
+
+BulkTokenizeProcedure::
+BulkTokenizeProcedure(MldbEngine * owner,
+                      PolyConfig config,
+                      const std::function<bool (const Json::Value &)> & onProgress)
+    : Procedure(owner)
+{
+    procedureConfig = config.params.convert<BulkTokenizeConfig>();
+}
+
+Any
+BulkTokenizeProcedure::
+getStatus() const
+{
+    return Any();
+}
+
+RunOutput
+BulkTokenizeProcedure::
+run(const ProcedureRunConfig & run,
+    const std::function<bool (const Json::Value &)> & onProgress) const
+{
+    auto runProcConf = applyRunConfOverProcConf(procedureConfig, run);
+
+    SqlExpressionMldbScope context(engine);
+
+    ConvertProgressToJson convertProgressToJson(onProgress);
+    auto boundDataset = runProcConf.inputData.stm->from->bind(context, convertProgressToJson);
+
+    // First pass: pull the documents out of the input query.  The texts
+    // are collected up front so that tokenization can then run over
+    // fixed-size blocks on the thread pool, independently of how the
+    // input dataset iterates its rows.
+    struct Document {
+        RowPath rowName;
+        Utf8String text;
+        Date ts;
+    };
+
+    std::vector<Document> documents;
+    std::mutex documentsLock;
+
+    auto processor = [&] (NamedRowValue & row_)
+        {
+            MatrixNamedRow row = row_.flattenDestructive();
+            if (row.columns.empty()
+                || std::get<1>(row.columns[0]).empty())
+                return true;  // no text, so no terms to record
+
+            Document doc{std::move(row.rowName),
+                         std::get<1>(row.columns[0]).toUtf8String(),
+                         std::get<2>(row.columns[0])};
+
+            std::unique_lock<std::mutex> guard(documentsLock);
+            documents.emplace_back(std::move(doc));
+            return true;
+        };
+
+    iterateDataset(runProcConf.inputData.stm->select,
+                   *boundDataset.dataset, boundDataset.asName,
+                   runProcConf.inputData.stm->when,
+                   *runProcConf.inputData.stm->where,
+                   {processor, true /*processInParallel*/},
+                   runProcConf.inputData.stm->orderBy,
+                   runProcConf.inputData.stm->offset,
+                   runProcConf.inputData.stm->limit,
+                   convertProgressToJson);
+
+    auto output = createDataset(engine, runProcConf.outputDataset,
+                                onProgress, true /*overwrite*/);
+
+    Dataset::MultiChunkRecorder recorder = output->getChunkRecorder();
+
+    // Second pass: tokenize blocks of documents in parallel.  Each block
+    // records through its own chunk recorder, so rows land directly in
+    // per-block dataset chunks (TabularDatasetChunks for the default
+    // tabular output) with no synchronization on the recording path.
+    constexpr size_t BLOCK_SIZE = 1024;
+    size_t numBlocks = (documents.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    const TokenizeOptions & options = runProcConf.tokenization;
+
+    auto doBlock = [&] (size_t blockNum)
+        {
+            std::unique_ptr<Recorder> threadRecorder
+                = recorder.newChunk(blockNum);
+
+            size_t first = blockNum * BLOCK_SIZE;
+            size_t last = std::min(first + BLOCK_SIZE, documents.size());
+
+            // Reused across the block so the tables keep their capacity
+            std::unordered_map<Utf8String, int> bagOfWords;
+            std::vector<std::tuple<ColumnPath, CellValue, Date> > columns;
+
+            for (size_t i = first;  i < last;  ++i) {
+                Document & doc = documents[i];
+
+                ParseContext pcontext(doc.text.rawData(),
+                                      doc.text.rawData(),
+                                      doc.text.rawLength());
+                bagOfWords.clear();
+                tokenize(bagOfWords, pcontext, options);
+
+                columns.clear();
+                columns.reserve(bagOfWords.size());
+                for (auto & term: bagOfWords) {
+                    if (!options.value.empty())
+                        columns.emplace_back(ColumnPath(term.first),
+                                             options.value, doc.ts);
+                    else
+                        columns.emplace_back(ColumnPath(term.first),
+                                             term.second, doc.ts);
+                }
+
+                threadRecorder->recordRowDestructive(std::move(doc.rowName),
+                                                     std::move(columns));
+            }
+
+            threadRecorder->finishedChunk();
+        };
+
+    parallelMap(0, numBlocks, doBlock);
+
+    recorder.commit();
+    output->commit();
+
+    return output->getStatus();
+}
+
+namespace {
+
+RegisterProcedureType<BulkTokenizeProcedure, BulkTokenizeConfig>
+regBulkTokenize(builtinPackage(),
+                "Tokenize a column of documents into bags of words, "
+                "processing blocks of documents in parallel",
+                "procedures/BulkTokenizeProcedure.md.html");
+
+} // file scope
+
+} // namespace MLDB
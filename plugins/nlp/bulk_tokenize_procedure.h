@@ -0,0 +1,60 @@
+/** bulk_tokenize_procedure.h                                      -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Procedure that tokenizes a whole column of documents in parallel.
+*/
+
+#pragma once
+
+#include "mldb/core/dataset.h"
+#include "mldb/core/procedure.h"
+#include "mldb/sql/sql_expression.h"
+#include "mldb/sql/tokenize.h"
+
+
+namespace MLDB {
+
+struct BulkTokenizeConfig : public ProcedureConfig {
+    static constexpr const char * name = "tokenize.bulk";
+
+    BulkTokenizeConfig();
+
+    InputQuery inputData;
+    PolyConfigT<Dataset> outputDataset;
+    TokenizeOptions tokenization;
+};
+
+DECLARE_STRUCTURE_DESCRIPTION(BulkTokenizeConfig);
+
+
+/*****************************************************************************/
+/* BULK TOKENIZE PROCEDURE                                                   */
+/*****************************************************************************/
+
+/** Tokenizes every document returned by an input query and records one
+    bag-of-words row per document into the output dataset.
+
+    This does the same thing as selecting the `tokenize` builtin over the
+    input, but processes blocks of documents concurrently on the thread
+    pool and records each block through its own dataset chunk, so it
+    should be preferred when tokenizing large corpora.
+*/
+
+struct BulkTokenizeProcedure: public Procedure {
+
+    BulkTokenizeProcedure(MldbEngine * owner,
+                          PolyConfig config,
+                          const std::function<bool (const Json::Value &)> & onProgress);
+
+    virtual RunOutput run(const ProcedureRunConfig & run,
+                          const std::function<bool (const Json::Value &)> & onProgress) const;
+
+    virtual Any getStatus() const;
+
+    BulkTokenizeConfig procedureConfig;
+};
+
+} // namespace MLDB
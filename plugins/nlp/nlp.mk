@@ -7,6 +7,7 @@
 LIBMLDB_NLP_PLUGIN_SOURCES:= \
 	nlp_plugin.cc \
 	tfidf.cc \
+	bulk_tokenize_procedure.cc \
 	word2vec.cc \
 	nlp.cc \
 	sentiwordnet.cc \
@@ -14,6 +15,7 @@ LIBMLDB_NLP_PLUGIN_SOURCES:= \
 
 LIBMLDB_NLP_PLUGIN_LINK:= \
 	mldb_core \
+	block \
 	mldb_engine \
 	arch \
 	types \
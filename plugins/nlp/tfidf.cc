@@ -14,6 +14,7 @@
 #include "mldb/utils/distribution.h"
 #include "mldb/base/scope.h"
 #include "mldb/base/parallel.h"
+#include "mldb/base/per_thread_accumulator.h"
 #include "mldb/utils/pair_utils.h"
 #include "mldb/utils/vector_utils.h"
 #include "mldb/types/basic_value_descriptions.h"
@@ -153,6 +154,13 @@ TfidfConfigDescription()
              "If specified, an instance of the ![](%%doclink tfidf function) of this name will be created using "
              "the trained model. Note that to use this parameter, the `modelFileUrl` must "
              "also be provided.");
+    addField("incremental", &TfidfConfig::incremental,
+             "If true and a model already exists at `modelFileUrl`, its "
+             "term statistics are loaded and the documents selected by "
+             "`trainingData` are added to them, instead of the counts "
+             "being rebuilt from scratch.  This allows new documents to "
+             "be folded into an existing corpus without re-reading it.",
+             false);
     addParent<ProcedureConfig>();
 
     onPostValidate = chain(validateQuery(&TfidfConfig::trainingData,
@@ -200,14 +208,34 @@ run(const ProcedureRunConfig & run,
 
     //This will cummulate the number of documents each word is in
     std::unordered_map<Utf8String, uint64_t> dfs;
-    std::atomic<uint64_t> corpusSize(0);
+    uint64_t existingCorpusSize = 0;
+
+    // Incremental mode: start from the statistics of the existing model
+    // and fold the new documents into them
+    if (runProcConf.incremental && !runProcConf.modelFileUrl.empty()
+        && tryGetUriObjectInfo(runProcConf.modelFileUrl.toDecodedString())
+               .exists) {
+        load(runProcConf.modelFileUrl.toDecodedString(),
+             existingCorpusSize, dfs);
+        INFO_MSG(logger) << "tfidf.train: updating existing model with "
+                         << dfs.size() << " terms over "
+                         << existingCorpusSize << " documents";
+    }
+
+    std::atomic<uint64_t> corpusSize(existingCorpusSize);
+
+    // Document frequencies are accumulated per thread and merged below,
+    // so that documents can be counted in parallel without a lock on a
+    // shared map
+    PerThreadAccumulator<std::unordered_map<Utf8String, uint64_t> > accum;
 
     auto processor = [&] (NamedRowValue & row_)
         {
+            auto & threadDfs = accum.get();
             MatrixNamedRow row = row_.flattenDestructive();
             for (auto& col : row.columns) {
                 Utf8String word = get<0>(col).toUtf8String();
-                dfs[word] += 1;
+                threadDfs[word] += 1;
             }
             ++corpusSize;
 
@@ -217,12 +245,30 @@ run(const ProcedureRunConfig & run,
     iterateDataset(runProcConf.trainingData.stm->select, *boundDataset.dataset, boundDataset.asName,
                    runProcConf.trainingData.stm->when,
                    *runProcConf.trainingData.stm->where,
-                   {processor,false/*processInParallel*/},
+                   {processor,true/*processInParallel*/},
                    runProcConf.trainingData.stm->orderBy,
                    runProcConf.trainingData.stm->offset,
                    runProcConf.trainingData.stm->limit,
                    convertProgressToJson);
 
+    // Merge the per-thread counts, starting from the largest map so
+    // that most entries are inserted only once
+    std::vector<std::unordered_map<Utf8String, uint64_t> *> threadMaps;
+    accum.forEach([&] (std::unordered_map<Utf8String, uint64_t> * m)
+        {
+            threadMaps.push_back(m);
+        });
+    std::sort(threadMaps.begin(), threadMaps.end(),
+              [] (auto * m1, auto * m2) { return m1->size() > m2->size(); });
+    for (auto * m: threadMaps) {
+        if (dfs.empty())
+            dfs = std::move(*m);
+        else {
+            for (auto & df: *m)
+                dfs[df.first] += df.second;
+        }
+    }
+
     bool saved = false;
     if (!runProcConf.modelFileUrl.empty()) {
         try {
@@ -44,6 +44,7 @@ struct TfidfConfig : public ProcedureConfig {
     static constexpr char const * defaultOutputDatasetType = "sparse.mutable";
 
     Utf8String functionName;
+    bool incremental = false;
 };
 
 DECLARE_STRUCTURE_DESCRIPTION(TfidfConfig);
@@ -17,6 +17,10 @@
 #include "mldb/utils/log.h"
 #include "mldb/core/dataset_scope.h"
 #include "mldb/types/annotated_exception.h"
+#include "mldb/types/basic_value_descriptions.h"
+#include "mldb/block/zip_serializer.h"
+#include "mldb/builtin/pooling_function.h"
+#include <cstring>
 
 using namespace std;
 
@@ -110,6 +114,49 @@ struct SqlWord2VecScope: public SqlExpressionMldbScope {
 
 
 
+/*****************************************************************************/
+/* WORD2VEC MAPPED FORMAT                                                    */
+/*****************************************************************************/
+
+/** Metadata for the mapped word2vec layout.
+
+    The layout has four regions next to this metadata object:
+    - "terms":       the concatenated UTF-8 bytes of all terms;
+    - "termOffsets": numWords + 1 uint32 offsets into "terms";
+    - "index":       an open addressed hash table of indexSlots uint32
+                     term numbers, empty slots holding -1, probed
+                     linearly from the term's CellValue hash;
+    - "vectors":     numWords * numDims floats, row major.
+
+    All regions are stored uncompressed so that they can be served
+    directly from a file mapping, paging in only what a lookup touches.
+*/
+
+struct Word2VecMappedMetadata {
+    uint32_t version = 1;
+    uint32_t numWords = 0;
+    uint32_t numDims = 0;
+    uint32_t indexSlots = 0;
+};
+
+DECLARE_STRUCTURE_DESCRIPTION(Word2VecMappedMetadata);
+
+DEFINE_STRUCTURE_DESCRIPTION(Word2VecMappedMetadata);
+
+Word2VecMappedMetadataDescription::
+Word2VecMappedMetadataDescription()
+{
+    addField("version", &Word2VecMappedMetadata::version,
+             "Version of the mapped layout", (uint32_t)1);
+    addField("numWords", &Word2VecMappedMetadata::numWords,
+             "Number of words stored");
+    addField("numDims", &Word2VecMappedMetadata::numDims,
+             "Number of dimensions per embedding");
+    addField("indexSlots", &Word2VecMappedMetadata::indexSlots,
+             "Number of slots in the term hash index");
+}
+
+
 /*****************************************************************************/
 /* WORD2VEC IMPORTER                                                         */
 /*****************************************************************************/
@@ -125,6 +172,7 @@ struct Word2VecImporterConfig : ProcedureConfig {
 
     Url dataFileUrl;
     PolyConfigT<Dataset> output;
+    Url mappedUrl;
     uint64_t offset;
     int64_t limit;
     std::shared_ptr<SqlExpression> named;
@@ -142,6 +190,11 @@ Word2VecImporterConfigDescription()
     addField("outputDataset", &Word2VecImporterConfig::output,
              "Output dataset for result",
              PolyConfigT<Dataset>().withType("embedding"));
+    addField("mappedUrl", &Word2VecImporterConfig::mappedUrl,
+             "Optional URL to write a memory-mappable copy of the "
+             "embeddings to.  The resulting file can be served by the "
+             "pooling.word2vec function without being loaded into memory, "
+             "with lookups paging in only the vectors they touch.");
     addField("offset", &Word2VecImporterConfig::offset,
              "Start at word number (0 = start)", (uint64_t)0);
     addField("limit", &Word2VecImporterConfig::limit,
@@ -197,6 +250,31 @@ struct Word2VecImporter: public Procedure {
         vector<tuple<RowPath, vector<float>, Date> > rows;
         int64_t numRecorded = 0;
 
+        // Mapped output: stream the vectors into a structured layout
+        // that is served by mapping the file, not loading it
+        std::unique_ptr<ZipStructuredSerializer> mappedSerializer;
+        std::shared_ptr<MappedSerializer> mappedVectorsEntry;
+        MutableMemoryRegionT<float> mappedVectors;
+        std::string mappedTerms;
+        std::vector<uint32_t> mappedTermOffsets(1, 0);
+        std::vector<uint64_t> mappedTermHashes;
+
+        if (!runProcConf.mappedUrl.empty()) {
+            int64_t expectedWords
+                = numWords - std::min<uint64_t>(numWords, runProcConf.offset);
+            if (runProcConf.limit != -1)
+                expectedWords = std::min<int64_t>(expectedWords,
+                                                  runProcConf.limit);
+
+            makeUriDirectory(runProcConf.mappedUrl.toString());
+            mappedSerializer.reset(new ZipStructuredSerializer
+                                   (runProcConf.mappedUrl.toUtf8String()));
+            mappedVectorsEntry = mappedSerializer->newEntry("vectors");
+            mappedVectors = mappedVectorsEntry
+                ->allocateWritableT<float>(expectedWords * (size_t)numDims,
+                                           sizeof(float));
+        }
+
         SqlWord2VecScope scope(engine, info.lastModified);
         auto namedBound = config.named->bind(scope);
 
@@ -204,6 +282,11 @@ struct Word2VecImporter: public Procedure {
             std::string word;
             getline(stream, word, ' ');
 
+            // The binary format terminates each vector with '\n', which
+            // getline leaves at the front of the following word
+            if (!word.empty() && word[0] == '\n')
+                word.erase(0, 1);
+
             std::vector<float> vec(numDims);
             stream.read((char *)&vec[0], numDims * sizeof(float));
 
@@ -212,6 +295,14 @@ struct Word2VecImporter: public Procedure {
             if (runProcConf.limit != -1 && numRecorded >= runProcConf.limit)
                 break;
 
+            if (mappedSerializer) {
+                std::memcpy(mappedVectors.data() + numRecorded * numDims,
+                            vec.data(), numDims * sizeof(float));
+                mappedTerms.append(word);
+                mappedTermOffsets.push_back(mappedTerms.size());
+                mappedTermHashes.push_back(CellValue(Utf8String(word)).hash());
+            }
+
             auto row = scope.bindRow(word, info.lastModified);
             ExpressionValue nameStorage;
             RowPath rowName(namedBound(row, nameStorage, GET_ALL)
@@ -235,6 +326,52 @@ struct Word2VecImporter: public Procedure {
             output->commit();
         }
 
+        if (mappedSerializer) {
+            Word2VecMappedMetadata md;
+            md.numWords = numRecorded;
+            md.numDims = numDims;
+
+            // Open addressed hash index over terms, kept at most half
+            // full so that linear probe chains stay short
+            uint32_t slots = 16;
+            while (slots < 2 * (uint64_t)numRecorded)
+                slots *= 2;
+            md.indexSlots = slots;
+
+            std::vector<uint32_t> index(slots, (uint32_t)-1);
+            for (size_t i = 0;  i < mappedTermHashes.size();  ++i) {
+                size_t slot = mappedTermHashes[i] & (slots - 1);
+                while (index[slot] != (uint32_t)-1)
+                    slot = (slot + 1) & (slots - 1);
+                index[slot] = i;
+            }
+
+            auto writeRegion = [&] (const void * data, size_t bytes,
+                                    PathElement name)
+                {
+                    auto entry = mappedSerializer->newEntry(std::move(name));
+                    auto region = entry->allocateWritable(bytes, 8);
+                    std::memcpy(region.data(), data, bytes);
+                    region.freeze();
+                };
+
+            mappedSerializer->newObject("md", md);
+            writeRegion(mappedTerms.data(), mappedTerms.size(), "terms");
+            writeRegion(mappedTermOffsets.data(),
+                        mappedTermOffsets.size() * sizeof(uint32_t),
+                        "termOffsets");
+            writeRegion(index.data(), index.size() * sizeof(uint32_t),
+                        "index");
+
+            mappedVectors.freeze();
+            mappedVectorsEntry.reset();
+            mappedSerializer->commit();
+
+            INFO_MSG(logger) << "wrote mapped word2vec file with "
+                             << numRecorded << " words to "
+                             << runProcConf.mappedUrl.toString();
+        }
+
         RunOutput result;
         return result;
     }
@@ -251,5 +388,187 @@ regScript(builtinPackage(),
           "procedures/Word2VecImporter.md.html");
 
 
+/*****************************************************************************/
+/* WORD2VEC MAPPED POOLING FUNCTION                                          */
+/*****************************************************************************/
+
+/** Drop-in replacement for the pooling function that serves its lookups
+    directly from a mapped word2vec file written by import.word2vec with
+    mappedUrl set, instead of querying an embedding dataset.  Binding is
+    near instantaneous and only the pages holding the looked-up terms
+    are ever resident.
+*/
+
+struct MappedPoolingFunctionConfig {
+    MappedPoolingFunctionConfig()
+        : aggregators({"avg"})
+    {
+    }
+
+    std::vector<Utf8String> aggregators;
+    Url mappedFileUrl;
+};
+
+DECLARE_STRUCTURE_DESCRIPTION(MappedPoolingFunctionConfig);
+
+DEFINE_STRUCTURE_DESCRIPTION(MappedPoolingFunctionConfig);
+
+MappedPoolingFunctionConfigDescription::
+MappedPoolingFunctionConfigDescription()
+{
+    std::vector<Utf8String> defaultAgg = { "avg" };
+    addField("aggregators", &MappedPoolingFunctionConfig::aggregators,
+             "Aggregator functions. Valid values are: avg, min, max, sum",
+             defaultAgg);
+    addField("mappedFileUrl", &MappedPoolingFunctionConfig::mappedFileUrl,
+             "URL of a mapped word2vec file written by the import.word2vec "
+             "procedure with mappedUrl set");
+}
+
+struct MappedPoolingFunction
+    : public ValueFunctionT<PoolingInput, PoolingOutput> {
+
+    MappedPoolingFunction(MldbEngine * owner,
+                          PolyConfig config_,
+                          const std::function<bool (const Json::Value &)> & onProgress)
+        : BaseT(owner, config_)
+    {
+        functionConfig = config_.params.convert<MappedPoolingFunctionConfig>();
+
+        if (functionConfig.aggregators.empty())
+            functionConfig.aggregators.push_back("avg");
+
+        for (auto & agg: functionConfig.aggregators) {
+            if (agg != "avg" && agg != "min" && agg != "max" && agg != "sum")
+                throw MLDB::Exception("Unknown aggregator: " + agg.rawString());
+        }
+
+        auto info = getUriObjectInfo
+            (functionConfig.mappedFileUrl.toDecodedString());
+        fileTimestamp = info.lastModified;
+
+        // Map the file; the regions below are views of the mapping and
+        // are paged in lazily as lookups touch them
+        ZipStructuredReconstituter reconstituter
+            (functionConfig.mappedFileUrl);
+        reconstituter.getObject("md", md);
+        terms = reconstituter.getRegion("terms");
+        termOffsets = reconstituter.getRegionT<uint32_t>("termOffsets");
+        index = reconstituter.getRegionT<uint32_t>("index");
+        vectors = reconstituter.getRegionT<float>("vectors");
+    }
+
+    MappedPoolingFunctionConfig functionConfig;
+    Word2VecMappedMetadata md;
+    Date fileTimestamp;
+    FrozenMemoryRegion terms;
+    FrozenMemoryRegionT<uint32_t> termOffsets;
+    FrozenMemoryRegionT<uint32_t> index;
+    FrozenMemoryRegionT<float> vectors;
+
+    static constexpr uint32_t NO_SLOT = (uint32_t)-1;
+
+    /// Return the mapped vector for the given term, or nullptr if the
+    /// term is not in the vocabulary
+    const float * lookup(const Utf8String & term) const
+    {
+        if (md.indexSlots == 0)
+            return nullptr;
+
+        uint64_t hash = CellValue(term).hash();
+        uint32_t mask = md.indexSlots - 1;
+        size_t len = term.rawLength();
+
+        for (uint32_t slot = hash & mask; ; slot = (slot + 1) & mask) {
+            uint32_t i = index[slot];
+            if (i == NO_SLOT)
+                return nullptr;
+            size_t offset = termOffsets[i];
+            if (termOffsets[i + 1] - offset == len
+                && std::memcmp(terms.data() + offset,
+                               term.rawData(), len) == 0)
+                return vectors.data() + i * (size_t)md.numDims;
+        }
+    }
+
+    virtual PoolingOutput call(PoolingInput input) const override
+    {
+        size_t numDims = md.numDims;
+        size_t numAggs = functionConfig.aggregators.size();
+
+        distribution<double> sum(numDims, 0.0);
+        distribution<double> minVal(numDims, INFINITY);
+        distribution<double> maxVal(numDims, -INFINITY);
+        size_t numFound = 0;
+
+        Date outputTs = input.words.getEffectiveTimestamp();
+
+        auto onAtom = [&] (const ColumnPath & columnName,
+                           const ColumnPath & prefix,
+                           const CellValue & val,
+                           Date ts)
+            {
+                Utf8String term
+                    = columnName.size() == 1
+                    ? columnName[0].toUtf8String()
+                    : columnName.toUtf8String();
+
+                const float * vec = lookup(term);
+                if (!vec)
+                    return true;  // unknown words are skipped
+
+                ++numFound;
+                for (size_t i = 0;  i < numDims;  ++i) {
+                    double v = vec[i];
+                    sum[i] += v;
+                    if (v < minVal[i])
+                        minVal[i] = v;
+                    if (v > maxVal[i])
+                        maxVal[i] = v;
+                }
+                return true;
+            };
+
+        input.words.forEachAtom(onAtom);
+
+        std::vector<double> outputEmbedding;
+        outputEmbedding.reserve(numDims * numAggs);
+
+        if (numFound == 0) {
+            outputEmbedding.resize(numDims * numAggs, 0.0);
+        }
+        else {
+            for (auto & agg: functionConfig.aggregators) {
+                if (agg == "avg") {
+                    for (size_t i = 0;  i < numDims;  ++i)
+                        outputEmbedding.push_back(sum[i] / numFound);
+                }
+                else if (agg == "sum") {
+                    outputEmbedding.insert(outputEmbedding.end(),
+                                           sum.begin(), sum.end());
+                }
+                else if (agg == "min") {
+                    outputEmbedding.insert(outputEmbedding.end(),
+                                           minVal.begin(), minVal.end());
+                }
+                else {
+                    outputEmbedding.insert(outputEmbedding.end(),
+                                           maxVal.begin(), maxVal.end());
+                }
+            }
+            outputTs.setMax(fileTimestamp);
+        }
+
+        return {ExpressionValue(std::move(outputEmbedding), outputTs)};
+    }
+};
+
+static RegisterFunctionType<MappedPoolingFunction, MappedPoolingFunctionConfig>
+regMappedPoolingFunction(builtinPackage(),
+                         "pooling.word2vec",
+                         "Apply a pooling function over a mapped word2vec file",
+                         "functions/Pooling.md.html");
+
+
 } // namespace MLDB
 
@@ -6,6 +6,7 @@
 # Sparse plugins
 LIBMLDB_SPARSE_PLUGIN_SOURCES:= \
 	sparse_plugin.cc \
+	sparse_matrix.cc \
 	sparse_matrix_dataset.cc \
 
 
@@ -31,6 +32,7 @@ LIBMLDB_SPARSE_PLUGIN_LINK:= \
 	mldb_builtin_base \
 	mldb_builtin \
 	sql_types \
+	block \
 
 $(eval $(call library,mldb_sparse_plugin,$(LIBMLDB_SPARSE_PLUGIN_SOURCES),$(LIBMLDB_SPARSE_PLUGIN_LINK)))
 
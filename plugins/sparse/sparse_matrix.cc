@@ -0,0 +1,274 @@
+/** sparse_matrix.cc
+    Jeremy Barnes, 30 August 2026
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Frozen CSR representation of a committed sparse matrix generation.
+*/
+
+#include "sparse_matrix.h"
+#include "mldb/block/file_serializer.h"
+#include "mldb/base/exc_assert.h"
+#include <algorithm>
+
+using namespace std;
+
+
+namespace MLDB {
+
+/*****************************************************************************/
+/* FROZEN SPARSE ROWS                                                        */
+/*****************************************************************************/
+
+namespace {
+
+/// Rows per CSR block.  Also bounds the entry arrays: a block closes early
+/// if its entry count approaches the 32 bit row start offset limit.
+constexpr size_t CSR_BLOCK_ROWS = 65536;
+constexpr size_t CSR_BLOCK_MAX_ENTRIES = 1ULL << 31;
+
+} // file scope
+
+std::shared_ptr<const FrozenSparseRows>
+FrozenSparseRows::
+freeze(const RowMap & rows)
+{
+    auto result = std::make_shared<FrozenSparseRows>();
+    result->serializer
+        = std::make_shared<TemporaryFileSerializer>("tmp", "sparse-csr");
+
+    // Split the rows between the CSR arrays and the overflow map.  A row
+    // goes to overflow if any of its entries carries a metadata blob, as
+    // those don't fit the fixed-width layout.
+    std::vector<std::pair<uint64_t, const compact_vector<BaseEntry, 1> *> >
+        csrRows;
+    csrRows.reserve(rows.size());
+
+    for (auto & r: rows) {
+        bool hasMetadata = false;
+        for (auto & e: r.second) {
+            if (!e.metadata.empty()) {
+                hasMetadata = true;
+                break;
+            }
+        }
+        if (hasMetadata) {
+            result->overflow[r.first] = r.second;
+            result->overflowRowIds.push_back(r.first);
+        }
+        else csrRows.emplace_back(r.first, &r.second);
+    }
+
+    std::sort(result->overflowRowIds.begin(), result->overflowRowIds.end());
+    std::sort(csrRows.begin(), csrRows.end(),
+              [] (const auto & l, const auto & r)
+              {
+                  return l.first < r.first;
+              });
+
+    // Column dictionary: sorted distinct column ids, referenced from the
+    // entry arrays by 32 bit index.
+    std::vector<uint64_t> allCols;
+    size_t totalEntries = 0;
+    for (auto & r: csrRows) {
+        totalEntries += r.second->size();
+        for (auto & e: *r.second)
+            allCols.push_back(e.rowcol);
+    }
+    std::sort(allCols.begin(), allCols.end());
+    allCols.erase(std::unique(allCols.begin(), allCols.end()),
+                  allCols.end());
+    ExcAssertLess(allCols.size(), (1ULL << 32));
+
+    std::unordered_map<uint64_t, uint32_t> colToIndex;
+    colToIndex.reserve(allCols.size());
+    for (size_t i = 0;  i < allCols.size();  ++i)
+        colToIndex[allCols[i]] = i;
+
+    {
+        auto dict = result->serializer
+            ->allocateWritableT<uint64_t>(allCols.size());
+        std::copy(allCols.begin(), allCols.end(), dict.data());
+        result->columnDict = dict.freeze();
+    }
+
+    // Write the blocks
+    for (size_t row = 0;  row < csrRows.size();  /* no inc */) {
+        size_t blockRows = 0, blockEntries = 0;
+        while (row + blockRows < csrRows.size()
+               && blockRows < CSR_BLOCK_ROWS
+               && blockEntries + csrRows[row + blockRows].second->size()
+                   < CSR_BLOCK_MAX_ENTRIES) {
+            blockEntries += csrRows[row + blockRows].second->size();
+            ++blockRows;
+        }
+
+        auto rowIds = result->serializer
+            ->allocateWritableT<uint64_t>(blockRows);
+        auto rowStarts = result->serializer
+            ->allocateWritableT<uint32_t>(blockRows + 1);
+        auto columns = result->serializer
+            ->allocateWritableT<uint32_t>(blockEntries);
+        auto timestamps = result->serializer
+            ->allocateWritableT<uint64_t>(blockEntries);
+        auto vals = result->serializer
+            ->allocateWritableT<uint64_t>(blockEntries);
+        auto tags = result->serializer
+            ->allocateWritableT<uint32_t>(blockEntries);
+
+        size_t entry = 0;
+        for (size_t i = 0;  i < blockRows;  ++i) {
+            rowIds.data()[i] = csrRows[row + i].first;
+            rowStarts.data()[i] = entry;
+            for (auto & e: *csrRows[row + i].second) {
+                columns.data()[entry] = colToIndex[e.rowcol];
+                timestamps.data()[entry] = e.timestamp;
+                vals.data()[entry] = e.val;
+                tags.data()[entry] = e.tag;
+                ++entry;
+            }
+        }
+        rowStarts.data()[blockRows] = entry;
+        ExcAssertEqual(entry, blockEntries);
+
+        Block block;
+        block.rowIds = rowIds.freeze();
+        block.rowStarts = rowStarts.freeze();
+        block.columns = columns.freeze();
+        block.timestamps = timestamps.freeze();
+        block.vals = vals.freeze();
+        block.tags = tags.freeze();
+
+        result->blockStartIndex.push_back(result->csrRows);
+        result->blocks.emplace_back(std::move(block));
+        result->csrRows += blockRows;
+        row += blockRows;
+    }
+
+    result->serializer->commit();
+
+    return result;
+}
+
+bool
+FrozenSparseRows::
+iterateRow(uint64_t rowNum,
+           const std::function<bool (const BaseEntry & entry)> & onEntry) const
+{
+    // Which block could hold the row?  Blocks partition the sorted row id
+    // space, so it's the last one starting at or before rowNum.
+    auto blockIt
+        = std::upper_bound(blocks.begin(), blocks.end(), rowNum,
+                           [] (uint64_t rowNum, const Block & b)
+                           {
+                               return rowNum < b.rowIds[0];
+                           });
+
+    if (blockIt != blocks.begin()) {
+        const Block & b = *std::prev(blockIt);
+        const uint64_t * it
+            = std::lower_bound(b.rowIds.data(),
+                               b.rowIds.data() + b.rowIds.length(),
+                               rowNum);
+        if (it != b.rowIds.data() + b.rowIds.length() && *it == rowNum) {
+            size_t i = it - b.rowIds.data();
+            for (size_t e = b.rowStarts[i];  e < b.rowStarts[i + 1];  ++e) {
+                BaseEntry entry(columnDict[b.columns[e]],
+                                b.timestamps[e],
+                                b.vals[e],
+                                b.tags[e]);
+                if (!onEntry(entry))
+                    return false;
+            }
+        }
+    }
+
+    auto it = overflow.find(rowNum);
+    if (it != overflow.end()) {
+        for (auto & e: it->second) {
+            if (!onEntry(e))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+FrozenSparseRows::
+knownRow(uint64_t rowNum) const
+{
+    auto blockIt
+        = std::upper_bound(blocks.begin(), blocks.end(), rowNum,
+                           [] (uint64_t rowNum, const Block & b)
+                           {
+                               return rowNum < b.rowIds[0];
+                           });
+
+    if (blockIt != blocks.begin()) {
+        const Block & b = *std::prev(blockIt);
+        if (std::binary_search(b.rowIds.data(),
+                               b.rowIds.data() + b.rowIds.length(),
+                               rowNum))
+            return true;
+    }
+
+    return overflow.count(rowNum);
+}
+
+size_t
+FrozenSparseRows::
+rowCount() const
+{
+    return csrRows + overflow.size();
+}
+
+void
+FrozenSparseRows::
+appendRowIds(std::vector<uint64_t> & rowIds) const
+{
+    for (auto & b: blocks) {
+        rowIds.insert(rowIds.end(),
+                      b.rowIds.data(), b.rowIds.data() + b.rowIds.length());
+    }
+    rowIds.insert(rowIds.end(),
+                  overflowRowIds.begin(), overflowRowIds.end());
+}
+
+uint64_t
+FrozenSparseRows::
+rowIdAt(size_t index) const
+{
+    if (index >= csrRows) {
+        ExcAssertLess(index - csrRows, overflowRowIds.size());
+        return overflowRowIds[index - csrRows];
+    }
+
+    auto it = std::upper_bound(blockStartIndex.begin(),
+                               blockStartIndex.end(), index);
+    size_t block = it - blockStartIndex.begin() - 1;
+    return blocks[block].rowIds[index - blockStartIndex[block]];
+}
+
+void
+FrozenSparseRows::
+addToMap(RowMap & rows) const
+{
+    for (auto & b: blocks) {
+        for (size_t i = 0;  i < b.rowIds.length();  ++i) {
+            auto & vec = rows[b.rowIds[i]];
+            for (size_t e = b.rowStarts[i];  e < b.rowStarts[i + 1];  ++e) {
+                vec.emplace_back(columnDict[b.columns[e]],
+                                 b.timestamps[e],
+                                 b.vals[e],
+                                 b.tags[e]);
+            }
+        }
+    }
+
+    for (auto & r: overflow) {
+        auto & vec = rows[r.first];
+        vec.insert(vec.end(), r.second.begin(), r.second.end());
+    }
+}
+
+} // namespace MLDB
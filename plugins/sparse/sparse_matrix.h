@@ -11,6 +11,10 @@
 
 #include "mldb/utils/compact_vector.h"
 #include "mldb/types/value_description_fwd.h"
+#include "mldb/block/memory_region.h"
+#include <functional>
+#include <unordered_map>
+#include <vector>
 
 
 namespace MLDB {
@@ -68,6 +72,86 @@ struct BaseEntry {
     compact_vector<std::string, 0, uint32_t> metadata;
 };
 
+/*****************************************************************************/
+/* FROZEN SPARSE ROWS                                                        */
+/*****************************************************************************/
+
+/** Frozen, scan-optimized image of one committed generation of a base
+    matrix.
+
+    Rows are laid out as blocked compressed sparse row (CSR) arrays backed
+    by FrozenMemoryRegions: per block, a sorted row id array, a row start
+    offset array, and parallel per-entry arrays of column index, timestamp,
+    value and tag.  Column ids are indirected through a per-matrix sorted
+    dictionary, so each entry's column reference is 32 bits wide no matter
+    how wide the id space is.  A full scan is then a linear walk over a
+    handful of contiguous arrays instead of a pointer chase through a hash
+    table of small vectors.
+
+    Entries carrying metadata blobs don't fit fixed-width arrays; any row
+    containing one stays in an ordinary overflow map which is consulted
+    alongside the blocks.  The matrices holding the bulk of the data
+    (matrix and inverse) record no metadata, so for those the overflow map
+    is empty and every scan goes through the CSR arrays.
+
+    Instances are immutable.  Writes keep going to the mutable store and
+    the two generations are merged back together at the next commit.
+*/
+struct FrozenSparseRows {
+    typedef std::unordered_map<uint64_t, compact_vector<BaseEntry, 1> >
+        RowMap;
+
+    /** One block of rows in CSR layout.  Blocks close after a fixed
+        number of rows so that no single region grows unboundedly and so
+        the 32 bit row start offsets cannot overflow.
+    */
+    struct Block {
+        FrozenMemoryRegionT<uint64_t> rowIds;     ///< sorted row ids
+        FrozenMemoryRegionT<uint32_t> rowStarts;  ///< rowIds.length() + 1 offsets
+        FrozenMemoryRegionT<uint32_t> columns;    ///< per entry; index into columnDict
+        FrozenMemoryRegionT<uint64_t> timestamps; ///< per entry
+        FrozenMemoryRegionT<uint64_t> vals;       ///< per entry
+        FrozenMemoryRegionT<uint32_t> tags;       ///< per entry
+    };
+
+    /** Freeze the given merged row map.  The regions are written through
+        a temporary file serializer owned by the returned object, so the
+        frozen image lives in mappable storage rather than on the heap.
+    */
+    static std::shared_ptr<const FrozenSparseRows>
+    freeze(const RowMap & rows);
+
+    bool iterateRow(uint64_t rowNum,
+                    const std::function<bool (const BaseEntry & entry)> & onEntry) const;
+
+    bool knownRow(uint64_t rowNum) const;
+
+    size_t rowCount() const;
+
+    /** Append every row id (CSR blocks first, in sorted order, then
+        overflow rows) to the given vector. */
+    void appendRowIds(std::vector<uint64_t> & rowIds) const;
+
+    /** Row id at the given position, in the same order appendRowIds
+        produces them.  Used by streaming row scans. */
+    uint64_t rowIdAt(size_t index) const;
+
+    /** Put every entry back into a mutable row map, preserving per-row
+        entry order, so a newer generation can be merged in. */
+    void addToMap(RowMap & rows) const;
+
+    std::vector<Block> blocks;
+    FrozenMemoryRegionT<uint64_t> columnDict; ///< sorted distinct column ids
+    RowMap overflow;                 ///< rows with metadata-bearing entries
+    std::vector<uint64_t> overflowRowIds;     ///< sorted ids of overflow rows
+    std::vector<size_t> blockStartIndex;      ///< cumulative rows before each block
+    size_t csrRows = 0;                       ///< total rows in the blocks
+
+private:
+    /// Owns the file backing the frozen regions
+    std::shared_ptr<MappedSerializer> serializer;
+};
+
 struct MatrixWriteTransaction;
 
 struct MatrixReadTransaction {
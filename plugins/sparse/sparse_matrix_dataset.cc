@@ -21,6 +21,7 @@
 #include "mldb/base/parallel_merge_sort.h"
 #include "mldb/engine/dataset_utils.h"
 #include "mldb/utils/log.h"
+#include <condition_variable>
 #include <mutex>
 
 using namespace std;
@@ -1119,12 +1120,14 @@ struct MutableBaseData {
 
         Rows(Rows && other) noexcept
             : entries(std::move(other.entries)),
+              frozen(std::move(other.frozen)),
               cachedRowCount(other.cachedRowCount.load())
         {
         }
 
         Rows(const Rows & other)
             : entries(other.entries),
+              frozen(other.frozen),
               cachedRowCount(other.cachedRowCount.load())
         {
         }
@@ -1139,6 +1142,7 @@ struct MutableBaseData {
         Rows & operator = (Rows && other) noexcept
         {
             this->entries = std::move(other.entries);
+            this->frozen = std::move(other.frozen);
             this->cachedRowCount = other.cachedRowCount.load();
             return *this;
         }
@@ -1146,17 +1150,25 @@ struct MutableBaseData {
         Rows & operator = (const Rows & other)
         {
             this->entries = other.entries;
+            this->frozen = other.frozen;
             this->cachedRowCount = other.cachedRowCount.load();
             return *this;
         }
 
         std::vector<std::shared_ptr<const RowsEntry> > entries;
+
+        /// CSR image of the last committed generation; entries written
+        /// since then stack on top of it in entries
+        std::shared_ptr<const FrozenSparseRows> frozen;
         mutable std::atomic<int64_t> cachedRowCount;
         mutable std::mutex rowCountMutex;
         
         bool iterateRow(uint64_t rowNum,
                         const std::function<bool (const BaseEntry & entry)> & onEntry) const
         {
+            if (frozen && !frozen->iterateRow(rowNum, onEntry))
+                return false;
+
             for (auto & e: entries) {
                 auto it = e->find(rowNum);
                 if (it != e->end()) {
@@ -1174,6 +1186,9 @@ struct MutableBaseData {
         {
             std::vector<uint64_t> allRows;
 
+            if (frozen)
+                frozen->appendRowIds(allRows);
+
             for (auto & e: entries) {
                 for (auto & r: *e) {
                     allRows.emplace_back(r.first);
@@ -1181,7 +1196,7 @@ struct MutableBaseData {
             }
 
             std::vector<uint64_t>::iterator end;
-            if (entries.size() > 1) {
+            if (entries.size() + (frozen ? 1 : 0) > 1) {
                 //if we haven't commited the entries yet there can be duplicates
                 parallelQuickSortRecursive(allRows);
                 end = std::unique(allRows.begin(), allRows.end());
@@ -1189,7 +1204,7 @@ struct MutableBaseData {
             else{
                 end = allRows.end();
             }
- 
+
             for (auto it = allRows.begin(); it != end;  ++it) {
                 if (!onRow(*it))
                     return false;
@@ -1200,6 +1215,9 @@ struct MutableBaseData {
 
         bool knownRow(uint64_t rowNum) const
         {
+            if (frozen && frozen->knownRow(rowNum))
+                return true;
+
             for (auto & e: entries) {
                 if (e->count(rowNum))
                     return true;
@@ -1211,8 +1229,8 @@ struct MutableBaseData {
         size_t rowCount() const
         {
             if (entries.empty())
-                return 0;
-            if (entries.size() == 1)
+                return frozen ? frozen->rowCount() : 0;
+            if (entries.size() == 1 && !frozen)
                 return entries.back()->size();
             int64_t r = cachedRowCount.load();
             if (r != -1)
@@ -1222,6 +1240,9 @@ struct MutableBaseData {
             std::unique_lock<std::mutex> guard(rowCountMutex);
             std::vector<uint64_t> allRows;
 
+            if (frozen)
+                frozen->appendRowIds(allRows);
+
             for (auto & e: entries) {
                 for (auto & r: *e) {
                     allRows.emplace_back(r.first);
@@ -1230,7 +1251,7 @@ struct MutableBaseData {
 
             int64_t rowCount = 0;
 
-            if (entries.size() > 1) {
+            if (entries.size() + (frozen ? 1 : 0) > 1) {
                 //if we haven't commited the entries yet there can be duplicates
                 parallelQuickSortRecursive(allRows);
                 rowCount = std::unique(allRows.begin(), allRows.end()) - allRows.begin();
@@ -1249,7 +1270,19 @@ struct MutableBaseData {
 
             RowsEntry newEntries;
 
-            if (!entries.empty()) {
+            if (frozen) {
+                // Thaw the previous generation first so its entries stay
+                // oldest within each row
+                frozen->addToMap(newEntries);
+
+                for (auto & e: entries) {
+                    for (auto & v: *e) {
+                        auto & vec = newEntries[v.first];
+                        vec.insert(vec.end(), v.second.begin(), v.second.end());
+                    }
+                }
+            }
+            else if (!entries.empty()) {
                 newEntries = *entries.front();
 
                 for (unsigned i = 1;  i < entries.size();  ++i) {
@@ -1274,7 +1307,10 @@ struct MutableBaseData {
 
             nonReadableWrites.clear();
 
-            result.entries.emplace_back(new RowsEntry(std::move(newEntries)));
+            // Freeze the merged generation into CSR form; reads go through
+            // the frozen image and nothing stays behind in the hash table
+            result.frozen = FrozenSparseRows::freeze(newEntries);
+            result.cachedRowCount = result.frozen->rowCount();
             return result;
         }
 
@@ -1286,8 +1322,17 @@ struct MutableBaseData {
 
             void initAt(size_t start)
             {
+                frozenPos = frozenCount = 0;
+                if (source->frozen) {
+                    frozenCount = source->frozen->rowCount();
+                    frozenPos = std::min<size_t>(start, frozenCount);
+                    start -= frozenPos;
+                }
+
                 entriesIter = source->entries.begin();
-               
+                if (entriesIter == source->entries.end())
+                    return;
+
                 subIter = (*entriesIter)->begin();
                 size_t count = 0;
                 while (start - count > (*entriesIter)->size())
@@ -1307,6 +1352,9 @@ struct MutableBaseData {
 
             virtual uint64_t next()
             {
+                if (frozenPos < frozenCount)
+                    return source->frozen->rowIdAt(frozenPos++);
+
                 uint64_t value = subIter->first;
                 subIter++;
                 if (subIter == (*entriesIter)->end())  {
@@ -1321,9 +1369,14 @@ struct MutableBaseData {
 
             virtual uint64_t current() const
             {
+                if (frozenPos < frozenCount)
+                    return source->frozen->rowIdAt(frozenPos);
+
                 return subIter->first;
             }
 
+            size_t frozenPos = 0;
+            size_t frozenCount = 0;
             std::vector<std::shared_ptr<const RowsEntry> >::const_iterator entriesIter;
             RowsEntry::const_iterator subIter;
             const MutableBaseData::Rows* source;
@@ -1331,7 +1384,7 @@ struct MutableBaseData {
 
         bool isSingleReadEntry() const
         {
-            return entries.size() == 1;
+            return entries.size() + (frozen ? 1 : 0) == 1;
         }
 
     };
@@ -1360,13 +1413,71 @@ struct MutableBaseData {
     std::vector<std::shared_ptr<RowsEntry> > nonReadableWrites;
     shared_ptr<spdlog::logger> logger;
 
-    /** Commit and optimize everything that's been written up to here. */
+    /// True while a commit is merging and freezing the sealed generation
+    /// off-lock; makes the insert paths record what arrives in between
+    bool optimizeInProgress = false;
+    std::condition_variable optimizeDone;
+
+    /// Readable entries inserted since the current commit sealed its
+    /// generation; stacked back on top of the frozen image at publish
+    std::vector<std::shared_ptr<const RowsEntry> > writesSinceSeal;
+
+    /** Commit and optimize everything that's been written up to here.
+
+        The expensive part (merging the generations and freezing them to
+        CSR form) runs without the lock held: we seal the current
+        generation and steal the non-readable writes under the lock, do
+        the merge and freeze while new writes keep flowing, then publish
+        the frozen image with whatever arrived in between stacked on top
+        of it.  Ingestion only ever blocks for the two short critical
+        sections.
+    */
     void optimize()
     {
+        std::shared_ptr<Repr> sealed;
+        std::vector<std::shared_ptr<RowsEntry> > writes;
+
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+
+            // One freeze at a time; later committers wait for the
+            // in-flight one, then re-seal to pick up their own writes
+            optimizeDone.wait(guard, [&] { return !optimizeInProgress; });
+            optimizeInProgress = true;
+
+            sealed = repr.load();
+            writes.swap(nonReadableWrites);
+        }
+
+        Rows newRows;
+        try {
+            newRows = sealed->rows.optimize(writes);
+        } catch (...) {
+            std::unique_lock<std::mutex> guard(mutex);
+            // Put the stolen writes back so they aren't lost; the
+            // readable entries inserted since the seal are still in repr
+            nonReadableWrites.insert(nonReadableWrites.begin(),
+                                     std::make_move_iterator(writes.begin()),
+                                     std::make_move_iterator(writes.end()));
+            optimizeInProgress = false;
+            writesSinceSeal.clear();
+            optimizeDone.notify_all();
+            throw;
+        }
+
         std::unique_lock<std::mutex> guard(mutex);
-        auto newRows = repr.load()->rows.optimize(nonReadableWrites);
-        auto newRepr = std::make_shared<Repr>(std::move(newRows));
-        repr.store(std::move(newRepr));
+
+        if (!writesSinceSeal.empty()) {
+            newRows.entries.insert(newRows.entries.end(),
+                                   writesSinceSeal.begin(),
+                                   writesSinceSeal.end());
+            newRows.cachedRowCount = -1;
+            writesSinceSeal.clear();
+        }
+
+        optimizeInProgress = false;
+        repr.store(std::make_shared<Repr>(std::move(newRows)));
+        optimizeDone.notify_all();
     }
 
     /** Insert the given set of rows very quickly, but in a way that they
@@ -1385,19 +1496,30 @@ struct MutableBaseData {
     void insertReadable(std::shared_ptr<RowsEntry> written)
     {
         std::unique_lock<std::mutex> guard(this->mutex);
+        insertReadableLocked(std::move(written));
+    }
 
+    /** Append a readable entry to the current representation.  Must be
+        called with the mutex held.
+    */
+    void insertReadableLocked(std::shared_ptr<RowsEntry> written)
+    {
         auto r = repr.load();
         const Rows & oldRows = r->rows;
-        
+
+        if (optimizeInProgress)
+            writesSinceSeal.push_back(written);
+
         std::vector<std::shared_ptr<const RowsEntry> >
             newRows = oldRows.entries;
         newRows.emplace_back(std::move(written));
 
         auto newRepr = std::make_shared<Repr>(std::move(newRows),
                                               oldRows.cachedRowCount.load());
+        newRepr->rows.frozen = oldRows.frozen;
         repr.store(std::move(newRepr));
     }
-    
+
     /** Insert the given set of rows in a manner that may have significant
         latency but will be fast to read back afterwards.
     */
@@ -1406,6 +1528,14 @@ struct MutableBaseData {
         // Only one balancing at a time
         std::unique_lock<std::mutex> guard(this->mutex);
 
+        // Merging while a commit is freezing the sealed generation would
+        // destroy the identity of the entries the publish step stacks
+        // back on top, so just append; balancing resumes afterwards
+        if (optimizeInProgress) {
+            insertReadableLocked(std::move(written));
+            return;
+        }
+
         Timer timer;
 
         // Get a reference to the data
@@ -1472,6 +1602,7 @@ struct MutableBaseData {
 
         auto newRepr = std::make_shared<Repr>(std::move(newRows),
                                               oldRows.cachedRowCount.load());
+        newRepr->rows.frozen = oldRows.frozen;
         repr.store(std::move(newRepr));
     }
 
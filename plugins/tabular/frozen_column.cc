@@ -76,6 +76,99 @@ reconstituteMetadataHelper(StructuredReconstituter & reconstituter,
     context.forEachMember(onMember);
 }
 
+namespace {
+
+template<typename Float>
+void getRowRangeFallback(const FrozenColumn & col,
+                         size_t startRow, size_t numRows, Float * out)
+{
+    for (size_t i = 0;  i < numRows;  ++i) {
+        CellValue v = col.get(startRow + i);
+        out[i] = v.empty()
+            ? std::numeric_limits<Float>::quiet_NaN()
+            : (Float)v.toDouble();
+    }
+}
+
+} // file scope
+
+void
+FrozenColumn::
+getRowRange(size_t startRow, size_t numRows, double * out) const
+{
+    getRowRangeFallback(*this, startRow, numRows, out);
+}
+
+void
+FrozenColumn::
+getRowRange(size_t startRow, size_t numRows, float * out) const
+{
+    getRowRangeFallback(*this, startRow, numRows, out);
+}
+
+void
+FrozenColumn::
+filterRange(size_t startRow, size_t endRow,
+            const ColumnPredicate & predicate,
+            RowBitmap & out) const
+{
+    auto onRow = [&] (size_t rowNum, const CellValue & val)
+        {
+            if (rowNum >= endRow)
+                return false;
+            if (rowNum >= startRow && !val.empty()
+                && predicate.matches(val))
+                out.set(rowNum);
+            return true;
+        };
+
+    forEachDense(onRow);
+}
+
+void
+FrozenColumn::
+gather(const uint32_t * rows, size_t n, CellValue * out) const
+{
+    for (size_t i = 0;  i < n;  ++i)
+        out[i] = get(rows[i]);
+}
+
+
+/*****************************************************************************/
+/* COLUMN PREDICATE                                                          */
+/*****************************************************************************/
+
+bool
+ColumnPredicate::
+matches(const CellValue & value) const
+{
+    switch (op) {
+    case EQ:  return value == constant;
+    case NE:  return !(value == constant);
+    case LT:  return value < constant;
+    case LE:  return !(constant < value);
+    case GT:  return constant < value;
+    case GE:  return !(value < constant);
+    }
+    throw AnnotatedException(500, "Unknown column predicate operator");
+}
+
+bool
+ColumnPredicate::
+rangeCanMatch(const CellValue & minValue,
+              const CellValue & maxValue) const
+{
+    switch (op) {
+    case EQ:  return !(constant < minValue) && !(maxValue < constant);
+    case NE:  return true;  // only an all-equal range could be excluded
+    case LT:  return minValue < constant;
+    case LE:  return !(constant < minValue);
+    case GT:  return constant < maxValue;
+    case GE:  return !(maxValue < constant);
+    }
+    throw AnnotatedException(500, "Unknown column predicate operator");
+}
+
 
 /*****************************************************************************/
 /* DIRECT FROZEN COLUMN                                                      */
@@ -224,6 +317,11 @@ struct DirectFrozenColumn
         return numNonNullEntries;
     }
 
+    virtual void prefetch() const override
+    {
+        values.prefetch();
+    }
+
     FrozenCellValueTable values;
 
     virtual ColumnTypes getColumnTypes() const
@@ -389,18 +487,22 @@ struct TableFrozenColumn
     virtual bool forEachImpl(const ForEachRowFn & onRow,
                              bool keepNulls) const
     {
+        // Decode the dictionary once up front; each row then just copies
+        // a shared value rather than reconstituting it
+        const std::vector<CellValue> & decoded = table.decodedValues();
+
         for (size_t i = 0;  i < numEntries;  ++i) {
             uint64_t index = indexes.getDefault(i, 0);
 
             CellValue val;
             if (hasNulls) {
                 if (index > 0)
-                    val = table[index - 1];
+                    val = decoded[index - 1];
                 else if (!keepNulls)
                     continue;  // skip nulls
             }
             else {
-                val = table[index];
+                val = decoded[index];
             }
 
             if (!onRow(i + firstEntry, val))
@@ -430,13 +532,60 @@ struct TableFrozenColumn
             return result;
         ExcAssertLess(rowIndex, numEntries);
         uint64_t index = indexes.get(rowIndex);
+        const std::vector<CellValue> & decoded = table.decodedValues();
         if (hasNulls) {
             if (index == 0)
                 return result;
-            else return result = table[index - 1];
+            else return result = decoded[index - 1];
         }
         else {
-            return result = table[index];
+            return result = decoded[index];
+        }
+    }
+
+    virtual void filterRange(size_t startRow, size_t endRow,
+                             const ColumnPredicate & predicate,
+                             RowBitmap & out) const override
+    {
+        // Evaluate the predicate once per dictionary entry; the row
+        // loop is then a pure code lookup over the packed indexes.
+        // Code 0 is the null when hasNulls, and never matches.
+        const std::vector<CellValue> & decoded = table.decodedValues();
+        std::vector<char> matches(decoded.size() + hasNulls, false);
+        for (size_t i = 0;  i < decoded.size();  ++i)
+            matches[i + hasNulls]
+                = !decoded[i].empty() && predicate.matches(decoded[i]);
+
+        size_t first = startRow > firstEntry ? startRow - firstEntry : 0;
+        size_t last = endRow > firstEntry ? endRow - firstEntry : 0;
+        // Rows past the stored indexes are trailing nulls
+        last = std::min<size_t>(last, indexes.size());
+
+        indexes.forEachRange(first, last,
+                             [&] (size_t i, uint64_t code)
+                             {
+                                 if (matches[code])
+                                     out.set(i + firstEntry);
+                                 return true;
+                             });
+    }
+
+    virtual void gather(const uint32_t * rows, size_t n,
+                        CellValue * out) const override
+    {
+        // Decode the dictionary once; each row is then one packed index
+        // read and one shared-value copy
+        const std::vector<CellValue> & decoded = table.decodedValues();
+        for (size_t i = 0;  i < n;  ++i) {
+            uint32_t row = rows[i];
+            if (row < firstEntry || row - firstEntry >= indexes.size()) {
+                out[i] = CellValue();
+                continue;
+            }
+            uint64_t code = indexes.get(row - firstEntry);
+            if (hasNulls)
+                out[i] = code == 0 ? CellValue() : decoded[code - 1];
+            else out[i] = decoded[code];
         }
     }
 
@@ -461,17 +610,18 @@ struct TableFrozenColumn
             if (!fn(CellValue()))
                 return false;
         }
-        for (size_t i = 0;  i < table.size();  ++i) {
-            if (!fn(table[i]))
+        for (const CellValue & val: table.decodedValues()) {
+            if (!fn(val))
                 return false;
         }
-        
+
         return true;
     }
 
     virtual bool
     forEachDistinctValueWithRowCount(std::function<bool (const CellValue &, size_t)> fn) const
     {
+        const std::vector<CellValue> & decoded = table.decodedValues();
         auto onValue = [&] (auto index, size_t count)
         {
             if (hasNulls) {
@@ -479,7 +629,7 @@ struct TableFrozenColumn
                     return true;  // null
                 index -= 1;
             }
-            return fn(table[index], count);
+            return fn(decoded[index], count);
         };
 
         return indexes.forEachDistinctValueWithRowCount(onValue);
@@ -490,6 +640,12 @@ struct TableFrozenColumn
         return numNonNullEntries;
     }
 
+    virtual void prefetch() const override
+    {
+        indexes.prefetch();
+        table.prefetch();
+    }
+
     FrozenIntegerTable indexes;
     FrozenCellValueSet table;
 
@@ -648,18 +804,24 @@ struct SparseTableFrozenColumn
 
     virtual bool forEach(const ForEachRowFn & onRow) const
     {
+        // Decode the dictionary once up front; each row then just copies
+        // a shared value rather than reconstituting it
+        const std::vector<CellValue> & decoded = table.decodedValues();
+
         for (size_t i = 0;  i < numEntries();  ++i) {
             auto rowNum = this->rowNum.get(i);
             auto index = this->index.get(i);
-            if (!onRow(rowNum + firstEntry, table[index]))
+            if (!onRow(rowNum + firstEntry, decoded[index]))
                 return false;
         }
-        
+
         return true;
     }
 
     virtual bool forEachDense(const ForEachRowFn & onRow) const
     {
+        const std::vector<CellValue> & decoded = table.decodedValues();
+
         size_t lastRowNum = 0;
         for (size_t i = 0;  i < numEntries();  ++i) {
             auto rowNum = this->rowNum.get(i);
@@ -671,7 +833,7 @@ struct SparseTableFrozenColumn
                 ++lastRowNum;
             }
 
-            if (!onRow(firstEntry + rowNum, table[index]))
+            if (!onRow(firstEntry + rowNum, decoded[index]))
                 return false;
             ++lastRowNum;
         }
@@ -717,7 +879,7 @@ struct SparseTableFrozenColumn
 
             if (rowNum == rowIndex) {
                 ExcAssertLess(index, table.size());
-                return result = table[index];
+                return result = table.decodedValues()[index];
             }
 
             // Break out if the element isn't there
@@ -768,9 +930,10 @@ struct SparseTableFrozenColumn
     virtual bool
     forEachDistinctValueWithRowCount(std::function<bool (const CellValue &, size_t)> fn) const
     {
+        const std::vector<CellValue> & decoded = table.decodedValues();
         auto onValue = [&] (auto value, auto count)
         {
-            return fn(table[value], count);
+            return fn(decoded[value], count);
         };
         return index.forEachDistinctValueWithRowCount(onValue);
     }
@@ -780,6 +943,13 @@ struct SparseTableFrozenColumn
         return numEntries();
     }
 
+    virtual void prefetch() const override
+    {
+        table.prefetch();
+        rowNum.prefetch();
+        index.prefetch();
+    }
+
     virtual ColumnTypes getColumnTypes() const
     {
         return columnTypes;
@@ -1115,6 +1285,182 @@ struct IntegerFrozenColumn
         return decode(table.get(rowIndex));
     }
 
+    template<typename Float>
+    void getRowRangeImpl(size_t startRow, size_t numRows, Float * out) const
+    {
+        constexpr Float NaN = std::numeric_limits<Float>::quiet_NaN();
+
+        size_t o = 0;
+        for (; o < numRows && startRow + o < firstEntry;  ++o)
+            out[o] = NaN;
+
+        size_t first = startRow + o - firstEntry;
+        size_t last = std::min<size_t>(table.size(), first + (numRows - o));
+
+        // Decode straight out of the bit-packed table.  Hoisting the
+        // null test out of the loop leaves a branch-free body that the
+        // compiler can vectorize.
+        if (hasNulls) {
+            uint64_t offs = (uint64_t)offset - 1;
+            table.forEachRange(first, last, [&] (size_t, uint64_t val)
+                {
+                    out[o++] = (val == 0)
+                        ? NaN
+                        : (Float)(int64_t)(val + offs);
+                    return true;
+                });
+        }
+        else {
+            uint64_t offs = (uint64_t)offset;
+            table.forEachRange(first, last, [&] (size_t, uint64_t val)
+                {
+                    out[o++] = (Float)(int64_t)(val + offs);
+                    return true;
+                });
+        }
+
+        for (; o < numRows;  ++o)
+            out[o] = NaN;
+    }
+
+    virtual void getRowRange(size_t startRow, size_t numRows,
+                             double * out) const override
+    {
+        getRowRangeImpl(startRow, numRows, out);
+    }
+
+    virtual void getRowRange(size_t startRow, size_t numRows,
+                             float * out) const override
+    {
+        getRowRangeImpl(startRow, numRows, out);
+    }
+
+    virtual void filterRange(size_t startRow, size_t endRow,
+                             const ColumnPredicate & predicate,
+                             RowBitmap & out) const override
+    {
+        // Only numeric constants compare against the packed integers;
+        // anything else goes through the generic decoded path
+        if (!predicate.constant.isNumber()) {
+            FrozenColumn::filterRange(startRow, endRow, predicate, out);
+            return;
+        }
+
+        constexpr int64_t MIN = std::numeric_limits<int64_t>::min();
+        constexpr int64_t MAX = std::numeric_limits<int64_t>::max();
+
+        double cd = predicate.constant.toDouble();
+        if (std::isnan(cd)) {
+            // Leave NaN comparison semantics to CellValue
+            FrozenColumn::filterRange(startRow, endRow, predicate, out);
+            return;
+        }
+
+        // Turn the predicate into an inclusive range [lo, hi] of raw
+        // values, negated for !=.  Fractional constants round to the
+        // neighbouring integer; an unsatisfiable predicate becomes the
+        // empty range lo > hi.
+        auto satFloor = [&] (double d) -> int64_t
+            {
+                d = std::floor(d);
+                if (d < -9.2e18) return MIN;
+                if (d > 9.2e18) return MAX;
+                return (int64_t)d;
+            };
+        auto satCeil = [&] (double d) -> int64_t
+            {
+                d = std::ceil(d);
+                if (d < -9.2e18) return MIN;
+                if (d > 9.2e18) return MAX;
+                return (int64_t)d;
+            };
+
+        int64_t lo = MIN, hi = MAX;
+        bool negate = (predicate.op == ColumnPredicate::NE);
+
+        bool integral = predicate.constant.isInteger();
+        if (integral && cd > 0
+            && predicate.constant.toUInt() > (uint64_t)MAX) {
+            // A uint64 constant beyond anything this column can store
+            if (predicate.op != ColumnPredicate::LT
+                && predicate.op != ColumnPredicate::LE) {
+                lo = 0;
+                hi = -1;
+            }
+        }
+        else {
+            int64_t ci = integral ? predicate.constant.toInt() : 0;
+            switch (predicate.op) {
+            case ColumnPredicate::NE:
+            case ColumnPredicate::EQ:
+                if (integral)
+                    lo = hi = ci;
+                else { lo = 0;  hi = -1; }  // no integer equals it
+                break;
+            case ColumnPredicate::LT:
+                if (!integral)
+                    hi = satFloor(cd);
+                else if (ci == MIN) { lo = 0;  hi = -1; }
+                else hi = ci - 1;
+                break;
+            case ColumnPredicate::LE:
+                hi = integral ? ci : satFloor(cd);
+                break;
+            case ColumnPredicate::GT:
+                if (!integral)
+                    lo = satCeil(cd);
+                else if (ci == MAX) { lo = 0;  hi = -1; }
+                else lo = ci + 1;
+                break;
+            case ColumnPredicate::GE:
+                lo = integral ? ci : satCeil(cd);
+                break;
+            }
+        }
+
+        size_t first = startRow > firstEntry ? startRow - firstEntry : 0;
+        size_t last = endRow > firstEntry ? endRow - firstEntry : 0;
+        last = std::min<size_t>(last, table.size());
+
+        // Compare straight out of the bit-packed table; the body is a
+        // couple of adds and compares per row, with no CellValue
+        if (hasNulls) {
+            uint64_t offs = (uint64_t)offset - 1;
+            table.forEachRange(first, last,
+                               [&] (size_t i, uint64_t val)
+                               {
+                                   if (val != 0) {
+                                       int64_t raw = (int64_t)(val + offs);
+                                       if ((raw >= lo && raw <= hi) != negate)
+                                           out.set(i + firstEntry);
+                                   }
+                                   return true;
+                               });
+        }
+        else {
+            uint64_t offs = (uint64_t)offset;
+            table.forEachRange(first, last,
+                               [&] (size_t i, uint64_t val)
+                               {
+                                   int64_t raw = (int64_t)(val + offs);
+                                   if ((raw >= lo && raw <= hi) != negate)
+                                       out.set(i + firstEntry);
+                                   return true;
+                               });
+        }
+    }
+
+    virtual void gather(const uint32_t * rows, size_t n,
+                        CellValue * out) const override
+    {
+        for (size_t i = 0;  i < n;  ++i) {
+            uint32_t row = rows[i];
+            if (row < firstEntry || row - firstEntry >= table.size())
+                out[i] = CellValue();
+            else out[i] = decode(table.get(row - firstEntry));
+        }
+    }
+
     virtual size_t size() const
     {
         return table.size();
@@ -1152,6 +1498,11 @@ struct IntegerFrozenColumn
         return numNonNullRows;
     }
 
+    virtual void prefetch() const override
+    {
+        table.prefetch();
+    }
+
     FrozenIntegerTable table;
 
     virtual ColumnTypes getColumnTypes() const
@@ -1227,6 +1578,420 @@ struct IntegerFrozenColumnFormat: public FrozenColumnFormat {
 RegisterFrozenColumnFormatT<IntegerFrozenColumnFormat> regInteger;
 
 
+/*****************************************************************************/
+/* DELTA INTEGER FROZEN COLUMN                                               */
+/*****************************************************************************/
+
+struct DeltaIntegerFrozenColumnMetadata {
+    uint32_t numEntries = 0;
+    uint64_t firstEntry = 0;
+    int64_t offset = 0;
+    int64_t minDelta = 0;
+    ColumnTypes columnTypes;
+};
+
+IMPLEMENT_STRUCTURE_DESCRIPTION(DeltaIntegerFrozenColumnMetadata)
+{
+    setVersion(1);
+    addField("numEntries", &DeltaIntegerFrozenColumnMetadata::numEntries, "");
+    addField("firstEntry", &DeltaIntegerFrozenColumnMetadata::firstEntry, "");
+    addField("offset", &DeltaIntegerFrozenColumnMetadata::offset, "");
+    addField("minDelta", &DeltaIntegerFrozenColumnMetadata::minDelta, "");
+    addField("columnTypes", &DeltaIntegerFrozenColumnMetadata::columnTypes, "");
+}
+
+/// Frozen column for dense integer columns whose successive values are
+/// close together, like timestamps and near-monotonic ids.  Rows are
+/// split into fixed-size blocks; each block stores its first value
+/// (frame of reference) and the remaining rows store the delta from the
+/// previous row, biased by the smallest delta so they pack into a few
+/// bits each.  A constant-rate sequence thus costs almost nothing per
+/// row, while the per-block bases keep point lookups O(block size).
+/// Unsorted columns produce a huge delta range and lose the size
+/// competition to the plain integer format, so selection is automatic.
+struct DeltaIntegerFrozenColumn
+    : public FrozenColumn,
+      public DeltaIntegerFrozenColumnMetadata {
+
+    static constexpr size_t BLOCK_SIZE = 64;
+
+    struct SizingInfo {
+        SizingInfo(const TabularDatasetColumn & column)
+        {
+            if (!column.columnTypes.onlyIntegersAndNulls())
+                return;  // can't use this column type
+            if (column.columnTypes.numNulls > 0)
+                return;  // deltas don't represent nulls
+            if (column.columnTypes.maxPositiveInteger
+                > (uint64_t)std::numeric_limits<int64_t>::max())
+                return;  // out of range
+
+            numEntries = column.maxRowNumber - column.minRowNumber + 1;
+            if (column.sparseIndexes.size() != numEntries)
+                return;  // gaps are implicit nulls
+            if (numEntries < 2)
+                return;  // nothing to delta-encode
+
+            if (column.columnTypes.hasPositiveIntegers()
+                && column.columnTypes.hasNegativeIntegers()) {
+                offset = column.columnTypes.minNegativeInteger;
+            }
+            else if (column.columnTypes.hasPositiveIntegers()) {
+                offset = column.columnTypes.minPositiveInteger;
+            }
+            else if (column.columnTypes.hasNegativeIntegers()) {
+                offset = column.columnTypes.minNegativeInteger;
+            }
+            else return;  // only nulls or empty column
+
+            // The deltas are manipulated as signed 64 bit offsets, so
+            // we can't allow the encoded range to overflow them.
+            uint64_t range;
+            if (column.columnTypes.hasPositiveIntegers()
+                && column.columnTypes.hasNegativeIntegers()) {
+                range = column.columnTypes.maxPositiveInteger
+                    - column.columnTypes.minNegativeInteger;
+            }
+            else if (column.columnTypes.hasPositiveIntegers()) {
+                range = column.columnTypes.maxPositiveInteger
+                    - column.columnTypes.minPositiveInteger;
+            }
+            else {
+                range = column.columnTypes.maxNegativeInteger
+                    - column.columnTypes.minNegativeInteger;
+            }
+            if (range > (uint64_t)std::numeric_limits<int64_t>::max())
+                return;
+
+            // Encode relative to the minimum, in row order
+            std::vector<uint64_t> encoded;
+            encoded.reserve(numEntries);
+            for (auto & v: column.sparseIndexes) {
+                const CellValue & val = column.indexedVals[v.second];
+                // Unsigned arithmetic so that wrapping is defined
+                encoded.push_back((uint64_t)val.toInt() - (uint64_t)offset);
+            }
+
+            minDelta = std::numeric_limits<int64_t>::max();
+            for (size_t i = 1;  i < numEntries;  ++i) {
+                if (i % BLOCK_SIZE == 0)
+                    continue;
+                minDelta = std::min<int64_t>
+                    (minDelta, (int64_t)(encoded[i] - encoded[i - 1]));
+            }
+
+            size_t numBlocks = (numEntries + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            bases.reserve(numBlocks);
+            deltas.reserve(numEntries - numBlocks);
+
+            for (size_t i = 0;  i < numEntries;  ++i) {
+                if (i % BLOCK_SIZE == 0)
+                    bases.add(encoded[i]);
+                else deltas.add((uint64_t)
+                                ((int64_t)(encoded[i] - encoded[i - 1])
+                                 - minDelta));
+            }
+
+            bytesRequired = sizeof(DeltaIntegerFrozenColumn)
+                + bases.bytesRequired() + deltas.bytesRequired();
+        }
+
+        operator ssize_t () const
+        {
+            return bytesRequired;
+        }
+
+        ssize_t bytesRequired = -1;
+        size_t numEntries = 0;
+        int64_t offset = 0;
+        int64_t minDelta = 0;
+
+        MutableIntegerTable bases;
+        MutableIntegerTable deltas;
+    };
+
+    DeltaIntegerFrozenColumn(TabularDatasetColumn & column,
+                             SizingInfo & info,
+                             MappedSerializer & serializer)
+    {
+        this->columnTypes = std::move(column.columnTypes);
+        ExcAssertNotEqual(info.bytesRequired, -1);
+
+        this->firstEntry = column.minRowNumber;
+        this->numEntries = info.numEntries;
+        this->offset = info.offset;
+        this->minDelta = info.minDelta;
+
+        this->bases = info.bases.freeze(serializer);
+        this->deltas = info.deltas.freeze(serializer);
+    }
+
+    virtual std::string format() const
+    {
+        return "ID";
+    }
+
+    virtual bool forEach(const ForEachRowFn & onRow) const
+    {
+        // Dense column; there are never nulls to skip
+        return forEachDense(onRow);
+    }
+
+    virtual bool forEachDense(const ForEachRowFn & onRow) const
+    {
+        size_t row = 0;
+        for (size_t block = 0;  row < numEntries;  ++block) {
+            uint64_t val = bases.get(block);
+            if (!onRow(row + firstEntry,
+                       CellValue((int64_t)(val + (uint64_t)offset))))
+                return false;
+            ++row;
+            size_t blockEnd = std::min<size_t>(numEntries,
+                                               block * BLOCK_SIZE + BLOCK_SIZE);
+            size_t firstDelta = block * (BLOCK_SIZE - 1);
+            bool ok = deltas.forEachRange
+                (firstDelta, firstDelta + (blockEnd - row),
+                 [&] (size_t, uint64_t d)
+                 {
+                     val += d + (uint64_t)minDelta;
+                     return onRow(row++ + firstEntry,
+                                  CellValue((int64_t)(val + (uint64_t)offset)));
+                 });
+            if (!ok)
+                return false;
+        }
+        return true;
+    }
+
+    virtual CellValue get(uint32_t rowIndex) const
+    {
+        CellValue result;
+        if (rowIndex < firstEntry)
+            return result;
+        rowIndex -= firstEntry;
+        if (rowIndex >= numEntries)
+            return result;
+        size_t block = rowIndex / BLOCK_SIZE;
+        uint64_t val = bases.get(block);
+        size_t firstDelta = block * (BLOCK_SIZE - 1);
+        size_t numDeltas = rowIndex - block * BLOCK_SIZE;
+        deltas.forEachRange(firstDelta, firstDelta + numDeltas,
+                            [&] (size_t, uint64_t d)
+                            {
+                                val += d + (uint64_t)minDelta;
+                                return true;
+                            });
+        return CellValue((int64_t)(val + (uint64_t)offset));
+    }
+
+    template<typename Float>
+    void getRowRangeImpl(size_t startRow, size_t numRows, Float * out) const
+    {
+        constexpr Float NaN = std::numeric_limits<Float>::quiet_NaN();
+
+        size_t o = 0;
+        for (; o < numRows && startRow + o < firstEntry;  ++o)
+            out[o] = NaN;
+
+        size_t first = startRow + o - firstEntry;
+        size_t last = std::min<size_t>(numEntries, first + (numRows - o));
+
+        // Replay the deltas from the start of the block containing the
+        // first requested row; the running sum in the inner loop is
+        // branchless apart from the range test.
+        size_t block = first / BLOCK_SIZE;
+        size_t row = block * BLOCK_SIZE;
+        while (row < last) {
+            uint64_t val = bases.get(block);
+            size_t blockEnd = std::min<size_t>(last, row + BLOCK_SIZE);
+            if (row >= first)
+                out[o++] = (Float)(int64_t)(val + (uint64_t)offset);
+            ++row;
+            size_t firstDelta = block * (BLOCK_SIZE - 1);
+            deltas.forEachRange(firstDelta, firstDelta + (blockEnd - row),
+                                [&] (size_t, uint64_t d)
+                                {
+                                    val += d + (uint64_t)minDelta;
+                                    if (row >= first)
+                                        out[o++] = (Float)(int64_t)
+                                            (val + (uint64_t)offset);
+                                    ++row;
+                                    return true;
+                                });
+            ++block;
+        }
+
+        for (; o < numRows;  ++o)
+            out[o] = NaN;
+    }
+
+    virtual void getRowRange(size_t startRow, size_t numRows,
+                             double * out) const override
+    {
+        getRowRangeImpl(startRow, numRows, out);
+    }
+
+    virtual void getRowRange(size_t startRow, size_t numRows,
+                             float * out) const override
+    {
+        getRowRangeImpl(startRow, numRows, out);
+    }
+
+    virtual size_t size() const
+    {
+        return numEntries;
+    }
+
+    virtual size_t memusage() const
+    {
+        return sizeof(*this) + bases.memusage() + deltas.memusage();
+    }
+
+    std::vector<int64_t> decodeAll() const
+    {
+        std::vector<int64_t> allVals;
+        allVals.reserve(numEntries);
+        auto onRow = [&] (size_t, const CellValue & val)
+            {
+                allVals.emplace_back(val.toInt());
+                return true;
+            };
+        forEachDense(onRow);
+        return allVals;
+    }
+
+    virtual bool
+    forEachDistinctValue(std::function<bool (const CellValue &)> fn) const
+    {
+        std::vector<int64_t> allVals = decodeAll();
+        std::sort(allVals.begin(), allVals.end());
+        auto endIt = std::unique(allVals.begin(), allVals.end());
+
+        for (auto it = allVals.begin();  it != endIt;  ++it) {
+            if (!fn(*it))
+                return false;
+        }
+
+        return true;
+    }
+
+    virtual bool
+    forEachDistinctValueWithRowCount(std::function<bool (const CellValue &, size_t)> fn) const
+    {
+        std::vector<int64_t> allVals = decodeAll();
+        std::sort(allVals.begin(), allVals.end());
+
+        for (auto it = allVals.begin(), endIt = allVals.end();
+             it != endIt;  /* no inc */) {
+            auto it2 = it;
+            ++it2;
+            while (it2 != endIt && *it == *it2)
+                ++it2;
+            if (!fn(*it, it2 - it))
+                return false;
+            it = it2;
+        }
+
+        return true;
+    }
+
+    virtual size_t nonNullRowCount() const override
+    {
+        return numEntries;
+    }
+
+    virtual void prefetch() const override
+    {
+        bases.prefetch();
+        deltas.prefetch();
+    }
+
+    /// First encoded value of each block of BLOCK_SIZE rows
+    FrozenIntegerTable bases;
+
+    /// Per-row delta from the previous row, biased by minDelta; blocks
+    /// of BLOCK_SIZE rows each contribute BLOCK_SIZE - 1 entries
+    FrozenIntegerTable deltas;
+
+    virtual ColumnTypes getColumnTypes() const
+    {
+        return columnTypes;
+    }
+
+    virtual void serialize(StructuredSerializer & serializer) const
+    {
+        serializeMetadataT<DeltaIntegerFrozenColumnMetadata>(serializer, *this);
+        bases.serialize(*serializer.newStructure("b"));
+        deltas.serialize(*serializer.newStructure("d"));
+    }
+
+    /// Reconstitute constructor
+    DeltaIntegerFrozenColumn(StructuredReconstituter & reconstituter)
+    {
+        reconstituteMetadataT<DeltaIntegerFrozenColumnMetadata>
+            (reconstituter, *this);
+        bases.reconstitute(*reconstituter.getStructure("b"));
+        deltas.reconstitute(*reconstituter.getStructure("d"));
+    }
+};
+
+struct DeltaIntegerFrozenColumnFormat: public FrozenColumnFormat {
+
+    virtual ~DeltaIntegerFrozenColumnFormat()
+    {
+    }
+
+    virtual std::string format() const override
+    {
+        return "ID";
+    }
+
+    virtual bool isFeasible(const TabularDatasetColumn & column,
+                            const ColumnFreezeParameters & params,
+                            std::shared_ptr<void> & cachedInfo) const override
+    {
+        size_t numEntries = column.maxRowNumber - column.minRowNumber + 1;
+        return column.columnTypes.onlyIntegersAndNulls()
+            && column.columnTypes.numNulls == 0
+            && column.sparseIndexes.size() == numEntries
+            && numEntries >= 2
+            && column.columnTypes.maxPositiveInteger
+            <= (uint64_t)std::numeric_limits<int64_t>::max();
+    }
+
+    virtual ssize_t columnSize(const TabularDatasetColumn & column,
+                               const ColumnFreezeParameters & params,
+                               ssize_t previousBest,
+                               std::shared_ptr<void> & cachedInfo) const override
+    {
+        auto info = std::make_shared<DeltaIntegerFrozenColumn::SizingInfo>(column);
+        ssize_t result = info->bytesRequired;
+        cachedInfo = info;
+        return result;
+    }
+
+    virtual DeltaIntegerFrozenColumn *
+    freeze(TabularDatasetColumn & column,
+           MappedSerializer & serializer,
+           const ColumnFreezeParameters & params,
+           std::shared_ptr<void> cachedInfo) const override
+    {
+        auto infoCast
+            = std::static_pointer_cast<DeltaIntegerFrozenColumn::SizingInfo>
+            (std::move(cachedInfo));
+        return new DeltaIntegerFrozenColumn(column, *infoCast, serializer);
+    }
+
+    virtual DeltaIntegerFrozenColumn *
+    reconstitute(StructuredReconstituter & reconstituter) const override
+    {
+        return new DeltaIntegerFrozenColumn(reconstituter);
+    }
+};
+
+RegisterFrozenColumnFormatT<DeltaIntegerFrozenColumnFormat> regDeltaInteger;
+
+
 /*****************************************************************************/
 /* DOUBLE FROZEN COLUMN                                                     */
 /*****************************************************************************/
@@ -1340,6 +2105,93 @@ struct DoubleFrozenColumn
         return storage[rowIndex];
     }
 
+    template<typename Float>
+    void getRowRangeImpl(size_t startRow, size_t numRows, Float * out) const
+    {
+        constexpr Float NaN = std::numeric_limits<Float>::quiet_NaN();
+
+        size_t o = 0;
+        for (; o < numRows && startRow + o < firstEntry;  ++o)
+            out[o] = NaN;
+
+        // Nulls are stored as a NaN bit pattern, so the middle loop has
+        // no branches at all when decoding to double; for float the
+        // conversion also preserves the NaN.
+        size_t i = startRow + o - firstEntry;
+        for (; o < numRows && i < numEntries;  ++o, ++i) {
+            const Entry & entry = storage[i];
+            out[o] = entry.isNull() ? NaN : (Float)entry.value();
+        }
+
+        for (; o < numRows;  ++o)
+            out[o] = NaN;
+    }
+
+    virtual void getRowRange(size_t startRow, size_t numRows,
+                             double * out) const override
+    {
+        getRowRangeImpl(startRow, numRows, out);
+    }
+
+    virtual void getRowRange(size_t startRow, size_t numRows,
+                             float * out) const override
+    {
+        getRowRangeImpl(startRow, numRows, out);
+    }
+
+    virtual void filterRange(size_t startRow, size_t endRow,
+                             const ColumnPredicate & predicate,
+                             RowBitmap & out) const override
+    {
+        if (!predicate.constant.isNumber()
+            || std::isnan(predicate.constant.toDouble())) {
+            FrozenColumn::filterRange(startRow, endRow, predicate, out);
+            return;
+        }
+        double c = predicate.constant.toDouble();
+
+        size_t first = startRow > firstEntry ? startRow - firstEntry : 0;
+        size_t last = endRow > firstEntry ? endRow - firstEntry : 0;
+        last = std::min<size_t>(last, (size_t)numEntries);
+
+        // One tight loop per operator, comparing the raw doubles; the
+        // null test is one bit-pattern compare
+        auto scan = [&] (auto cmp)
+            {
+                for (size_t i = first;  i < last;  ++i) {
+                    const Entry & entry = storage[i];
+                    if (!entry.isNull() && cmp(entry.value()))
+                        out.set(i + firstEntry);
+                }
+            };
+
+        switch (predicate.op) {
+        case ColumnPredicate::EQ:
+            scan([&] (double v) { return v == c; });  break;
+        case ColumnPredicate::NE:
+            scan([&] (double v) { return v != c; });  break;
+        case ColumnPredicate::LT:
+            scan([&] (double v) { return v < c; });   break;
+        case ColumnPredicate::LE:
+            scan([&] (double v) { return v <= c; });  break;
+        case ColumnPredicate::GT:
+            scan([&] (double v) { return v > c; });   break;
+        case ColumnPredicate::GE:
+            scan([&] (double v) { return v >= c; });  break;
+        }
+    }
+
+    virtual void gather(const uint32_t * rows, size_t n,
+                        CellValue * out) const override
+    {
+        for (size_t i = 0;  i < n;  ++i) {
+            uint32_t row = rows[i];
+            if (row < firstEntry || row - firstEntry >= numEntries)
+                out[i] = CellValue();
+            else out[i] = storage[row - firstEntry];
+        }
+    }
+
     virtual size_t size() const
     {
         return numEntries;
@@ -1437,6 +2289,11 @@ struct DoubleFrozenColumn
         return numNonNullRows;
     }
 
+    virtual void prefetch() const override
+    {
+        storage.raw().prefetchRange(0);
+    }
+
     FrozenMemoryRegionT<Entry> storage;
 
     virtual ColumnTypes getColumnTypes() const
@@ -1545,8 +2402,26 @@ struct TimestampFrozenColumn
         column.valueIndex.clear();
         size_t numNulls = column.columnTypes.numNulls;
         column.columnTypes = ColumnTypes();
+
+        // If every timestamp is a whole number of seconds, unwrap to
+        // integers instead of doubles.  That makes the integer formats
+        // feasible, in particular the delta format which suits the
+        // near-monotonic event times these columns usually hold.
+        bool allIntegral = true;
+        for (auto & v: column.indexedVals) {
+            if (v.empty())
+                continue;
+            double d = v.coerceToNumber().toDouble();
+            if (!(d >= -9.2e18 && d <= 9.2e18) || d != (double)(int64_t)d) {
+                allIntegral = false;
+                break;
+            }
+        }
+
         for (auto & v: column.indexedVals) {
             v = v.coerceToNumber();
+            if (allIntegral && !v.empty())
+                v = CellValue((int64_t)v.toDouble());
             column.columnTypes.update(v);
         }
         column.columnTypes.numNulls = numNulls;
@@ -1625,6 +2500,11 @@ struct TimestampFrozenColumn
         return unwrapped->nonNullRowCount();
     }
 
+    virtual void prefetch() const override
+    {
+        unwrapped->prefetch();
+    }
+
     virtual ColumnTypes getColumnTypes() const
     {
         return columnTypes;
@@ -1862,7 +2742,48 @@ freeze(TabularDatasetColumn & column,
     if (!res.second) {
         throw AnnotatedException(500, "No column format found for column");
     }
-    return res.second(column, serializer);
+    auto result = res.second(column, serializer);
+
+    // Record the zone map while we still have the distinct values to hand
+    bool hasRange = false;
+    CellValue minValue, maxValue;
+    for (auto & v: column.indexedVals) {
+        if (v.empty())
+            continue;
+        if (!hasRange) {
+            minValue = maxValue = v;
+            hasRange = true;
+            continue;
+        }
+        if (v < minValue)
+            minValue = v;
+        if (maxValue < v)
+            maxValue = v;
+    }
+    if (hasRange)
+        result->setValueRange(std::move(minValue), std::move(maxValue));
+
+    return result;
+}
+
+bool
+FrozenColumn::
+getValueRange(CellValue & minValue, CellValue & maxValue) const
+{
+    if (!hasValueRange_)
+        return false;
+    minValue = minValue_;
+    maxValue = maxValue_;
+    return true;
+}
+
+void
+FrozenColumn::
+setValueRange(CellValue minValue, CellValue maxValue)
+{
+    minValue_ = std::move(minValue);
+    maxValue_ = std::move(maxValue);
+    hasValueRange_ = true;
 }
 
 void
@@ -9,7 +9,9 @@
 #pragma once
 
 #include "mldb/block/memory_region.h"
+#include "mldb/sql/cell_value.h"
 #include "column_types.h"
+#include "mldb/utils/row_bitmap.h"
 #include <functional>
 
 namespace MLDB {
@@ -25,6 +27,40 @@ struct ColumnFreezeParameters {
 };
 
 
+/*****************************************************************************/
+/* COLUMN PREDICATE                                                          */
+/*****************************************************************************/
+
+/** Comparison of a column's values against a constant, in a form the
+    frozen column kernels can specialize on (compare against the packed
+    representation, test the dictionary once, ...) rather than receiving
+    an opaque callback.  Nulls never match, whichever the operator, as
+    SQL WHERE semantics require.
+*/
+struct ColumnPredicate {
+    enum Op {
+        EQ,   ///< value =  constant
+        NE,   ///< value != constant
+        LT,   ///< value <  constant
+        LE,   ///< value <= constant
+        GT,   ///< value >  constant
+        GE    ///< value >= constant
+    };
+
+    Op op = EQ;
+    CellValue constant;
+
+    /// Row-at-a-time test, for the generic fallbacks.  The value must
+    /// not be null.
+    bool matches(const CellValue & value) const;
+
+    /// Can any value in [minValue, maxValue] match?  Used against the
+    /// zone maps to skip whole chunks.
+    bool rangeCanMatch(const CellValue & minValue,
+                       const CellValue & maxValue) const;
+};
+
+
 /*****************************************************************************/
 /* FROZEN COLUMN                                                             */
 /*****************************************************************************/
@@ -51,6 +87,41 @@ struct FrozenColumn {
 
     virtual bool forEachDense(const ForEachRowFn & onRow) const = 0;
 
+    /** Decode the values of rows [startRow, startRow + numRows) into the
+        given contiguous buffer, converting nulls to NaN.  The default
+        implementation calls get() once per row; formats whose underlying
+        storage allows a tight decode loop override it, which removes the
+        per-row virtual dispatch from bulk numeric scans.
+    */
+    virtual void getRowRange(size_t startRow, size_t numRows,
+                             double * out) const;
+
+    /** Same, but decoding to floats. */
+    virtual void getRowRange(size_t startRow, size_t numRows,
+                             float * out) const;
+
+    /** Set, in out, the rows in [startRow, endRow) whose value matches
+        the predicate.  Null values never match.  Row numbers are in the
+        same space as forEach and get.  The default implementation tests
+        one decoded value at a time; the packed formats override it with
+        kernels that compare against the stored representation (bit
+        packed integers, dictionary codes, raw doubles) in a tight loop,
+        replacing one virtual call per row with one per column scan.
+    */
+    virtual void filterRange(size_t startRow, size_t endRow,
+                             const ColumnPredicate & predicate,
+                             RowBitmap & out) const;
+
+    /** Decode the n rows given by rows (in any order) into out.  Rows
+        outside the column produce nulls.  The default implementation
+        calls get() per row; formats with cheap point access override it
+        to hoist the per-row virtual dispatch and dictionary setup out
+        of the loop.  Used to materialize the surviving rows after a
+        filter has run.
+    */
+    virtual void gather(const uint32_t * rows, size_t n,
+                        CellValue * out) const;
+
     virtual bool
     forEachDistinctValue(std::function<bool (const CellValue &)> fn)
         const = 0;
@@ -64,6 +135,26 @@ struct FrozenColumn {
     /** How many non-null rows are in this column? */
     virtual size_t nonNullRowCount() const = 0;
 
+    /** Hint that this column is about to be scanned.  Mapped columns
+        issue an asynchronous readahead of their backing storage (see
+        FrozenMemoryRegion::prefetchRange) so that a cold scan doesn't
+        pay one page fault at a time; scan loops call this a couple of
+        chunks ahead of the one being processed.
+    */
+    virtual void prefetch() const
+    {
+    }
+
+    /** Zone map: the range of the non-null values in this column, used
+        to skip chunks that can't match a range predicate.  Returns false
+        if the range is unknown, in which case the caller must scan.  It
+        is filled in when a column is frozen; columns reconstituted from
+        disk don't carry one, since the serialized format is unchanged.
+    */
+    bool getValueRange(CellValue & minValue, CellValue & maxValue) const;
+
+    void setValueRange(CellValue minValue, CellValue maxValue);
+
     /** Freeze the given column into the best fitting frozen column type. */
     static std::shared_ptr<FrozenColumn>
     freeze(TabularDatasetColumn & column,
@@ -100,6 +191,11 @@ protected:
     reconstituteMetadataHelper(StructuredReconstituter & reconstituter,
                                void * md,
                                const std::type_info & mdType);
+
+private:
+    /// Zone map over the non-null values; valid only when set at freeze
+    CellValue minValue_, maxValue_;
+    bool hasValueRange_ = false;
 };
 
 
@@ -414,6 +414,15 @@ size() const
     return itl->size();
 }
 
+void
+FrozenBlobTable::
+prefetch() const
+{
+    itl->blobData.prefetchRange(0);
+    itl->offset.prefetch();
+    itl->length.prefetch();
+}
+
 void
 FrozenBlobTable::
 serialize(StructuredSerializer & serializer) const
@@ -879,6 +888,29 @@ reconstitute(StructuredReconstituter & reconstituter)
 {
     offsets.reconstitute(reconstituter);
     cells = reconstituter.getRegion("c");
+
+    // Any previously decoded values belong to the old contents
+    decoded = std::make_shared<DecodedValues>();
+}
+
+const std::vector<CellValue> &
+FrozenCellValueSet::
+decodedValues() const
+{
+    DecodedValues & cache = *decoded;
+    if (!cache.filled.load(std::memory_order_acquire)) {
+        std::unique_lock<std::mutex> guard(cache.mutex);
+        if (!cache.filled.load(std::memory_order_relaxed)) {
+            std::vector<CellValue> values;
+            values.reserve(size());
+            for (size_t i = 0;  i < size();  ++i) {
+                values.emplace_back(operator [] (i));
+            }
+            cache.values = std::move(values);
+            cache.filled.store(true, std::memory_order_release);
+        }
+    }
+    return cache.values;
 }
 
 } // namespace MLDB
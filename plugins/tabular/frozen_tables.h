@@ -15,6 +15,8 @@
 #include "mldb/arch/endian.h"
 #include "mldb/sql/cell_value.h"
 #include "mldb/compiler/string_view.h"
+#include <atomic>
+#include <mutex>
 
 
 namespace MLDB {
@@ -72,6 +74,27 @@ struct FrozenIntegerTable {
         return true;
     }
 
+    /** Like forEach, but only over entries in [start, end), seeking the
+        bit extractor directly to the start rather than decoding from the
+        beginning.  Used by the bulk row-range decoders. */
+    template<typename Fn>
+    bool forEachRange(size_t start, size_t end, Fn && onVal) const
+    {
+        end = std::min<size_t>(end, md.numEntries);
+        if (start >= end)
+            return true;
+
+        MLDB::Bit_Extractor<uint64_t> bits(storage.data());
+        bits.advance(start * md.entryBits);
+
+        for (size_t i = start;  i < end;  ++i) {
+            int64_t val = bits.extract<uint64_t>(md.entryBits);
+            if (!onVal(i, decode(i, val)))
+                return false;
+        }
+        return true;
+    }
+
     template<typename Fn>
     bool forEachDistinctValue(Fn && onValue) const
     {
@@ -110,7 +133,13 @@ struct FrozenIntegerTable {
     uint64_t get(size_t i) const;
 
     uint64_t getDefault(size_t i, uint64_t def = -1) const;
-    
+
+    /// Asynchronously page in the backing storage ahead of a scan
+    void prefetch() const
+    {
+        storage.raw().prefetchRange(0);
+    }
+
     void serialize(StructuredSerializer & serializer) const;
 
     void reconstitute(StructuredReconstituter & reconstituter);
@@ -216,6 +245,7 @@ struct FrozenBlobTable {
     
     size_t memusage() const;
     size_t size() const;
+    void prefetch() const;
     void serialize(StructuredSerializer & serializer) const;
     void reconstitute(StructuredReconstituter & reconstituter);
 
@@ -250,6 +280,11 @@ struct MutableBlobTable {
 
 struct FrozenStringTable {
     FrozenBlobTable blobs;
+
+    void prefetch() const
+    {
+        blobs.prefetch();
+    }
 };
 
 struct MutableStringTable {
@@ -271,6 +306,11 @@ struct MutableStringTable {
 
 struct FrozenPathTable {
     FrozenBlobTable blobs;
+
+    void prefetch() const
+    {
+        blobs.prefetch();
+    }
 };
 
 struct MutablePathTable {
@@ -341,6 +381,11 @@ struct FrozenCellValueTable {
         return true;
     }
 
+    void prefetch() const
+    {
+        blobs.prefetch();
+    }
+
     void serialize(StructuredSerializer & serializer) const;
     void reconstitute(StructuredReconstituter & reconstituter);
 
@@ -420,12 +465,42 @@ struct FrozenCellValueSet {
         return true;
     }
 
+    void prefetch() const
+    {
+        offsets.prefetch();
+        cells.prefetchRange(0);
+    }
+
     void serialize(StructuredSerializer & serializer) const;
 
     void reconstitute(StructuredReconstituter & reconstituter);
 
+    /** Return the whole set decoded into CellValues, reconstituting each
+        value only on the first call.  These sets back the dictionary
+        style frozen columns, so they are small by construction: decoding
+        them once means per-row access can hand out reference-counted
+        copies of shared values (whose string hashes are computed once
+        and then cached in the shared representation) instead of
+        rebuilding each value from the mapped region on every access.
+
+        Thread safe; the returned reference stays valid for the life of
+        the set.
+    */
+    const std::vector<CellValue> & decodedValues() const;
+
     FrozenIntegerTable offsets;
     FrozenMemoryRegion cells;
+
+private:
+    /// Held behind a shared_ptr so that the set stays movable and copies
+    /// of the set share the one decoded table
+    struct DecodedValues {
+        std::mutex mutex;
+        std::atomic<bool> filled = false;
+        std::vector<CellValue> values;
+    };
+
+    std::shared_ptr<DecodedValues> decoded = std::make_shared<DecodedValues>();
 };
 
 struct MutableCellValueSet {
@@ -1,8 +1,9 @@
-/** frozen_column.cc                                               -*- C++ -*-
+/** string_frozen_column.cc                                        -*- C++ -*-
     Jeremy Barnes, 27 March 2016
     This file is part of MLDB. Copyright 2016 mldb.ai inc. All rights reserved.
 
-    Implementation of code to freeze columns into a binary format.
+    Implementation of a frozen column that stores long strings in
+    dictionary-compressed zstd blocks.
 */
 
 #include "frozen_tables.h"
@@ -10,146 +11,493 @@
 #include "tabular_dataset_column.h"
 #include "mldb/types/annotated_exception.h"
 #include "mldb/types/basic_value_descriptions.h"
+#include "mldb/block/decoded_block_cache.h"
 
 #include "mldb/ext/zstd/lib/zdict.h"
 #include "mldb/ext/zstd/lib/zstd.h"
 
 #include "mldb/utils/possibly_dynamic_buffer.h"
 
+#include <mutex>
+#include <atomic>
+#include <cstring>
+
 
 using namespace std;
 
 
 namespace MLDB {
 
+namespace {
+
+/** Train a zstd dictionary on the given string values.  Returns an empty
+    string if the training fails (eg, not enough distinct samples), in
+    which case the format should not be used for this column.
+*/
+std::string
+trainZstdDictionary(const std::vector<CellValue> & vals)
+{
+    static constexpr size_t DICTIONARY_SIZE = 131072;
+    static constexpr size_t TOTAL_SAMPLE_SIZE = 1024 * 1024;
+
+    std::string dictionary(DICTIONARY_SIZE, '\0');
+
+    // Accumulate the first 1MB of strings in a contiguous buffer
+    std::string sampleBuffer;
+    sampleBuffer.reserve(2 * TOTAL_SAMPLE_SIZE);
+
+    std::vector<size_t> sampleSizes;
+
+    for (auto & v: vals) {
+        if (sampleBuffer.length() > TOTAL_SAMPLE_SIZE)
+            break;
+        size_t len = v.toStringLength();
+        sampleBuffer.append(v.stringChars(), len);
+        sampleSizes.push_back(len);
+    }
+
+    size_t res = ZDICT_trainFromBuffer(dictionary.data(),
+                                       dictionary.size(),
+                                       sampleBuffer.data(),
+                                       sampleSizes.data(),
+                                       sampleSizes.size());
+    if (ZDICT_isError(res))
+        return std::string();
+
+    dictionary.resize(res);
+    return dictionary;
+}
+
+} // file scope
+
+
 /*****************************************************************************/
-/* STRING FROZEN COLUMN                                                      */
+/* ZSTD STRING FROZEN COLUMN                                                 */
 /*****************************************************************************/
 
-/// Frozen column that stores each value as a string
-struct CompressedStringFrozenColumn: public FrozenColumn {
+struct ZstdStringFrozenColumnMetadata {
+    uint32_t numEntries = 0;
+    uint64_t firstEntry = 0;
+    uint32_t numNonNullEntries = 0;
+    bool hasNulls = false;
+    uint32_t numValues = 0;
+    uint32_t numBlocks = 0;
+    ColumnTypes columnTypes;
+};
 
-    // This stores the underlying doubles or CellValues 
-    std::shared_ptr<const FrozenColumn> unwrapped;
+IMPLEMENT_STRUCTURE_DESCRIPTION(ZstdStringFrozenColumnMetadata)
+{
+    setVersion(1);
+    addField("numEntries", &ZstdStringFrozenColumnMetadata::numEntries, "");
+    addField("firstEntry", &ZstdStringFrozenColumnMetadata::firstEntry, "");
+    addField("numNonNullEntries", &ZstdStringFrozenColumnMetadata::numNonNullEntries, "");
+    addField("hasNulls", &ZstdStringFrozenColumnMetadata::hasNulls, "");
+    addField("numValues", &ZstdStringFrozenColumnMetadata::numValues, "");
+    addField("numBlocks", &ZstdStringFrozenColumnMetadata::numBlocks, "");
+    addField("columnTypes", &ZstdStringFrozenColumnMetadata::columnTypes, "");
+}
+
+/** Frozen column for long string values (URLs, user agents, ...) that
+    don't repeat enough for the table representation to pay off.  The
+    distinct values are laid out contiguously, cut into blocks of around
+    64kb, and each block is compressed with zstd against a dictionary
+    trained on the column.  Blocks are decompressed lazily on access and
+    cached in the process-wide DecodedBlockCache, so repeat queries over
+    the same hot columns don't pay the decompression again.
+*/
+struct ZstdStringFrozenColumn
+    : public FrozenColumn,
+      public ZstdStringFrozenColumnMetadata {
 
-    CompressedStringFrozenColumn(TabularDatasetColumn & column,
-                                 MappedSerializer & serializer,
-                                 const ColumnFreezeParameters & params)
-        : columnTypes(column.columnTypes)
+    /// Uncompressed bytes per block, before compression
+    static constexpr size_t BLOCK_SIZE = 65536;
+
+    ZstdStringFrozenColumn(TabularDatasetColumn & column,
+                           MappedSerializer & serializer,
+                           const std::string & dictionary)
     {
-        ExcAssert(!column.isFrozen);
-        // Convert the values to unwrapped doubles
-        column.valueIndex.clear();
-        size_t numNulls = column.columnTypes.numNulls;
-        column.columnTypes = ColumnTypes();
-        for (auto & v: column.indexedVals) {
-            v = v.coerceToNumber();
-            column.columnTypes.update(v);
+        this->columnTypes = std::move(column.columnTypes);
+        firstEntry = column.minRowNumber;
+        numEntries = column.maxRowNumber - column.minRowNumber + 1;
+        hasNulls = column.sparseIndexes.size() < numEntries;
+        numNonNullEntries = column.sparseIndexes.size();
+        numValues = column.indexedVals.size();
+
+        // Per-row indexes into the value table, in the same way as the
+        // table frozen column (zero means null when hasNulls is set).
+        // Unlike there we keep the values in their original order, so
+        // no remapping is needed.
+        MutableIntegerTable mutableIndexes;
+        mutableIndexes.reserve(numEntries);
+
+        if (!hasNulls) {
+            for (size_t i = 0;  i < column.sparseIndexes.size();  ++i) {
+                ExcAssertEqual(column.sparseIndexes[i].first, i);
+                mutableIndexes.add(column.sparseIndexes[i].second);
+            }
+        }
+        else {
+            size_t index = 0;
+            for (auto & r_i: column.sparseIndexes) {
+                while (index < r_i.first) {
+                    mutableIndexes.add(0);
+                    ++index;
+                }
+                mutableIndexes.add(r_i.second + 1);
+                ++index;
+            }
+        }
+
+        indexes = mutableIndexes.freeze(serializer);
+
+        // Now lay the values out into blocks and compress each one
+        std::shared_ptr<ZSTD_CDict> cdict
+            (ZSTD_createCDict(dictionary.data(), dictionary.length(),
+                              5 /* compression level */),
+             ZSTD_freeCDict);
+        std::shared_ptr<ZSTD_CCtx> context
+            (ZSTD_createCCtx(), ZSTD_freeCCtx);
+
+        MutableIntegerTable mutableValueOffsets;  // cumulative, per value
+        MutableIntegerTable mutableBlockStarts;   // first value per block
+        MutableIntegerTable mutableBlockOffsets;  // cumulative, per block
+
+        mutableValueOffsets.reserve(numValues);
+
+        std::string blockBuffer;
+        blockBuffer.reserve(BLOCK_SIZE + 4096);
+        std::string compressed;
+
+        auto flushBlock = [&] ()
+            {
+                PossiblyDynamicBuffer<char, 65536>
+                    buf(ZSTD_compressBound(blockBuffer.length()));
+
+                size_t res
+                    = ZSTD_compress_usingCDict(context.get(),
+                                               buf.data(), buf.size(),
+                                               blockBuffer.data(),
+                                               blockBuffer.length(),
+                                               cdict.get());
+                if (ZSTD_isError(res)) {
+                    throw AnnotatedException(500, "Error with compressing: "
+                                             + string(ZSTD_getErrorName(res)));
+                }
+
+                compressed.append(buf.data(), res);
+                mutableBlockOffsets.add(compressed.length());
+                blockBuffer.clear();
+            };
+
+        uint64_t currentOffset = 0;
+        for (size_t i = 0;  i < column.indexedVals.size();  ++i) {
+            const CellValue & v = column.indexedVals[i];
+            if (blockBuffer.empty())
+                mutableBlockStarts.add(i);
+            size_t len = v.toStringLength();
+            blockBuffer.append(v.stringChars(), len);
+            currentOffset += len;
+            mutableValueOffsets.add(currentOffset);
+            if (blockBuffer.length() >= BLOCK_SIZE)
+                flushBlock();
         }
-        column.columnTypes.numNulls = numNulls;
+        if (!blockBuffer.empty())
+            flushBlock();
+
+        numBlocks = mutableBlockStarts.size();
+
+        valueOffsets = mutableValueOffsets.freeze(serializer);
+        blockStarts = mutableBlockStarts.freeze(serializer);
+        blockOffsets = mutableBlockOffsets.freeze(serializer);
+
+        auto blockRegion
+            = serializer.allocateWritable(compressed.length(), 1);
+        std::memcpy(blockRegion.data(), compressed.data(),
+                    compressed.length());
+        blockData = blockRegion.freeze();
+
+        auto dictRegion
+            = serializer.allocateWritable(dictionary.length(), 1);
+        std::memcpy(dictRegion.data(), dictionary.data(),
+                    dictionary.length());
+        dict = dictRegion.freeze();
+    }
 
-        unwrapped = column.freeze(serializer, params);
+    /// Reconstitute constructor
+    ZstdStringFrozenColumn(StructuredReconstituter & reconstituter)
+    {
+        reconstituteMetadataT<ZstdStringFrozenColumnMetadata>
+            (reconstituter, *this);
+        indexes.reconstitute(*reconstituter.getStructure("ix"));
+        valueOffsets.reconstitute(*reconstituter.getStructure("vo"));
+        blockStarts.reconstitute(*reconstituter.getStructure("bs"));
+        blockOffsets.reconstitute(*reconstituter.getStructure("bo"));
+        blockData = reconstituter.getRegion("blk");
+        dict = reconstituter.getRegion("dict");
     }
 
-    // Wrap a double (or null) into a string (or null)
-    static CellValue wrap(CellValue val)
+    ~ZstdStringFrozenColumn()
     {
-        if (val.empty())
-            return val;
-        return val.coerceToString();
+        DecodedBlockCache::instance().evictOwner(this);
+
+        ZSTD_DDict * prev = ddict.exchange(nullptr);
+        if (prev)
+            ZSTD_freeDDict(prev);
     }
 
+    virtual std::string format() const
+    {
+        return "Sz";
+    }
 
-    virtual bool forEach(const ForEachRowFn & onRow) const
+    /** Return the decompressed contents of the given block, from the
+        process-wide cache if it's there.
+    */
+    std::shared_ptr<const std::string> getBlock(uint32_t blockNumber) const
     {
-        auto onRow2 = [&] (size_t rowNum, const CellValue & val)
-            {
-                return onRow(rowNum, wrap(val));
-            };
+        ExcAssertLess(blockNumber, numBlocks);
+
+        auto cached = DecodedBlockCache::instance().get(this, blockNumber);
+        if (cached)
+            return cached;
+
+        std::unique_lock<std::mutex> guard(decompressLock);
+
+        if (!ddict.load()) {
+            ZSTD_DDict * newDict = ZSTD_createDDict(dict.data(),
+                                                    dict.length());
+            ZSTD_DDict * previous = nullptr;
+            if (!ddict.compare_exchange_strong(previous, newDict))
+                ZSTD_freeDDict(newDict);
+        }
+        if (!dctx) {
+            dctx.reset(ZSTD_createDCtx(),
+                       [] (ZSTD_DCtx * c) { ZSTD_freeDCtx(c); });
+        }
+
+        size_t compressedStart
+            = blockNumber == 0 ? 0 : blockOffsets.get(blockNumber - 1);
+        size_t compressedEnd = blockOffsets.get(blockNumber);
+
+        size_t firstValue = blockStarts.get(blockNumber);
+        size_t uncompressedStart
+            = firstValue == 0 ? 0 : valueOffsets.get(firstValue - 1);
+        size_t lastValue = blockNumber == numBlocks - 1
+            ? numValues : blockStarts.get(blockNumber + 1);
+        size_t uncompressedEnd = valueOffsets.get(lastValue - 1);
+
+        auto data = std::make_shared<std::string>();
+        data->resize(uncompressedEnd - uncompressedStart);
+
+        size_t res
+            = ZSTD_decompress_usingDDict(dctx.get(),
+                                         data->data(), data->length(),
+                                         blockData.data() + compressedStart,
+                                         compressedEnd - compressedStart,
+                                         ddict.load());
+        if (ZSTD_isError(res)) {
+            throw AnnotatedException(500, "Error with decompressing: "
+                                     + string(ZSTD_getErrorName(res)));
+        }
+        ExcAssertEqual(res, data->length());
+
+        DecodedBlockCache::instance().put(this, blockNumber, data);
 
-        return unwrapped->forEach(onRow2);
+        return data;
     }
 
-    virtual bool forEachDense(const ForEachRowFn & onRow) const
+    /// Which block does the given value live in?
+    uint32_t findBlock(uint32_t valueNumber) const
     {
-        auto onRow2 = [&] (size_t rowNum, const CellValue & val)
-            {
-                return onRow(rowNum, wrap(val));
-            };
+        // Binary search over the (monotonic) first-value-per-block table
+        uint32_t lo = 0, hi = numBlocks;
+        while (hi - lo > 1) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (blockStarts.get(mid) <= valueNumber)
+                lo = mid;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    CellValue getValue(uint32_t valueNumber) const
+    {
+        ExcAssertLess(valueNumber, numValues);
+
+        uint32_t blockNumber = findBlock(valueNumber);
+        auto data = getBlock(blockNumber);
 
-        return unwrapped->forEachDense(onRow2);
+        size_t firstValue = blockStarts.get(blockNumber);
+        size_t blockStart
+            = firstValue == 0 ? 0 : valueOffsets.get(firstValue - 1);
+        size_t valueStart
+            = valueNumber == 0 ? 0 : valueOffsets.get(valueNumber - 1);
+        size_t valueEnd = valueOffsets.get(valueNumber);
+
+        return CellValue(data->data() + (valueStart - blockStart),
+                         valueEnd - valueStart);
+    }
+
+    virtual bool forEachImpl(const ForEachRowFn & onRow,
+                             bool keepNulls) const
+    {
+        for (size_t i = 0;  i < numEntries;  ++i) {
+            uint64_t index = indexes.getDefault(i, 0);
+
+            CellValue val;
+            if (hasNulls) {
+                if (index > 0)
+                    val = getValue(index - 1);
+                else if (!keepNulls)
+                    continue;  // skip nulls
+            }
+            else {
+                val = getValue(index);
+            }
+
+            if (!onRow(i + firstEntry, val))
+                return false;
+        }
+
+        return true;
+    }
+
+    virtual bool forEach(const ForEachRowFn & onRow) const
+    {
+        return forEachImpl(onRow, false /* keep nulls */);
+    }
+
+    virtual bool forEachDense(const ForEachRowFn & onRow) const
+    {
+        return forEachImpl(onRow, true /* keep nulls */);
     }
 
     virtual CellValue get(uint32_t rowIndex) const
     {
-        return wrap(unwrapped->get(rowIndex));
+        CellValue result;
+        if (rowIndex < firstEntry)
+            return result;
+        rowIndex -= firstEntry;
+        if (rowIndex >= indexes.size())
+            return result;
+        ExcAssertLess(rowIndex, numEntries);
+        uint64_t index = indexes.get(rowIndex);
+        if (hasNulls) {
+            if (index == 0)
+                return result;
+            return getValue(index - 1);
+        }
+        else {
+            return getValue(index);
+        }
     }
 
     virtual size_t size() const
     {
-        return unwrapped->size();
+        return numEntries;
     }
 
     virtual size_t memusage() const
     {
-        return sizeof(*this)
-            + unwrapped->memusage();
+        size_t result = sizeof(*this);
+        result += indexes.memusage();
+        result += valueOffsets.memusage();
+        result += blockStarts.memusage();
+        result += blockOffsets.memusage();
+        result += blockData.memusage();
+        result += dict.memusage();
+        // decompressed blocks live in the shared cache, so don't count
+        return result;
     }
 
     virtual bool
     forEachDistinctValue(std::function<bool (const CellValue &)> fn) const
     {
-        auto fn2 = [&] (const CellValue & v)
-            {
-                return fn(wrap(v));
-            };
+        if (hasNulls) {
+            if (!fn(CellValue()))
+                return false;
+        }
+        // Scanning in order means each block is decompressed exactly once
+        for (size_t i = 0;  i < numValues;  ++i) {
+            if (!fn(getValue(i)))
+                return false;
+        }
 
-        return unwrapped->forEachDistinctValue(fn2);
+        return true;
     }
 
     virtual bool
     forEachDistinctValueWithRowCount(std::function<bool (const CellValue &, size_t)> fn) const
     {
-        auto fn2 = [&] (const CellValue & v, size_t n)
-            {
-                return fn(wrap(v), n);
-            };
+        auto onValue = [&] (auto index, size_t count)
+        {
+            if (hasNulls) {
+                if (index == 0)
+                    return true;  // null
+                index -= 1;
+            }
+            return fn(getValue(index), count);
+        };
 
-        return unwrapped->forEachDistinctValueWithRowCount(fn2);
+        return indexes.forEachDistinctValueWithRowCount(onValue);
     }
 
     virtual size_t nonNullRowCount() const override
     {
-        return unwrapped->nonNullRowCount();
+        return numNonNullEntries;
     }
 
-    ColumnTypes columnTypes;
-
-    virtual ColumnTypes getColumnTypes() const
+    virtual void prefetch() const override
     {
-        return columnTypes;
+        indexes.prefetch();
+        valueOffsets.prefetch();
+        blockStarts.prefetch();
+        blockOffsets.prefetch();
+        blockData.prefetchRange(0);
+        dict.prefetchRange(0);
     }
 
-    virtual std::string format() const
+    virtual ColumnTypes getColumnTypes() const
     {
-        return "Sc";
+        return columnTypes;
     }
 
     virtual void serialize(StructuredSerializer & serializer) const
     {
-        unwrapped->serialize(serializer);
+        serializeMetadataT<ZstdStringFrozenColumnMetadata>(serializer, *this);
+        indexes.serialize(*serializer.newStructure("ix"));
+        valueOffsets.serialize(*serializer.newStructure("vo"));
+        blockStarts.serialize(*serializer.newStructure("bs"));
+        blockOffsets.serialize(*serializer.newStructure("bo"));
+        serializer.addRegion(blockData, "blk");
+        serializer.addRegion(dict, "dict");
     }
+
+    FrozenIntegerTable indexes;       ///< Per-row value number
+    FrozenIntegerTable valueOffsets;  ///< Cumulative length per value
+    FrozenIntegerTable blockStarts;   ///< First value number per block
+    FrozenIntegerTable blockOffsets;  ///< Cumulative compressed length per block
+    FrozenMemoryRegion blockData;     ///< Compressed blocks, back to back
+    FrozenMemoryRegion dict;          ///< Trained zstd dictionary
+
+private:
+    // Lazily created decompression dictionary
+    mutable std::atomic<ZSTD_DDict *> ddict = nullptr;
+
+    // Covers the decompression context
+    mutable std::mutex decompressLock;
+    mutable std::shared_ptr<ZSTD_DCtx> dctx;
 };
 
-struct CompressedStringFrozenColumnFormat: public FrozenColumnFormat {
-    
-    virtual ~CompressedStringFrozenColumnFormat()
+struct ZstdStringFrozenColumnFormat: public FrozenColumnFormat {
+
+    virtual ~ZstdStringFrozenColumnFormat()
     {
     }
 
     virtual std::string format() const override
     {
-        return "Sc";
+        return "Sz";
     }
 
     struct CachedInfo {
@@ -166,16 +514,17 @@ struct CompressedStringFrozenColumnFormat: public FrozenColumnFormat {
         cachedInfo = info;
 
         for (auto & v: column.indexedVals) {
-            if (v.isString()) {
-                info->totalBytes += v.toStringLength();
-                info->totalStrings += 1;
-            }
+            if (!v.isString())
+                return false;
+            info->totalBytes += v.toStringLength();
+            info->totalStrings += 1;
         }
 
         return column.columnTypes.numStrings
             && column.columnTypes.onlyStringsAndNulls()
-            && info->totalBytes > 50000000 // 50MB
-            && info->totalBytes / info->totalStrings > 64;
+            && info->totalStrings > 0
+            && info->totalBytes > 10000000 // 10MB
+            && info->totalBytes / info->totalStrings > 32;
     }
 
     virtual ssize_t columnSize(const TabularDatasetColumn & column,
@@ -185,124 +534,88 @@ struct CompressedStringFrozenColumnFormat: public FrozenColumnFormat {
     {
         auto info = std::static_pointer_cast<CachedInfo>(cachedInfo);
 
-        // Let the dictionary size be 5% of the total
-        size_t dictionarySize = 131072;//32768; //info->totalBytes / 20;
-
-        std::string dictionary(dictionarySize, '\0');
-
-        static constexpr size_t TOTAL_SAMPLE_SIZE = 1024 * 1024;
-
-        // Give it the first 1MB to train on
-        std::string sampleBuffer;
-        sampleBuffer.reserve(2 * TOTAL_SAMPLE_SIZE);
-
-        std::vector<size_t> sampleSizes;
-        size_t currentOffset = 0;
-        size_t valNumber = 0;
-
-        // Accumulate the first 1MB of strings in a contiguous buffer
-
-        for (auto & v: column.indexedVals) {
-            if (currentOffset > TOTAL_SAMPLE_SIZE)
-                break;
-            size_t sampleSize = v.toStringLength();
-            sampleBuffer.append(v.toUtf8String().rawString());
-            sampleSizes.push_back(sampleSize);
-            currentOffset += sampleSize;
-            valNumber += 1;
-        }
+        info->dict = trainZstdDictionary(column.indexedVals);
+        if (info->dict.empty())
+            return CANT_STORE;
 
-        Date before = Date::now();
-
-        // Perform the dictionary training
-        size_t result = ZDICT_trainFromBuffer(&dictionary[0],
-                                              dictionary.size(),
-                                              sampleBuffer.data(),
-                                              sampleSizes.data(),
-                                              sampleSizes.size());
-        if (ZDICT_isError(result)) {
-            throw AnnotatedException(500, "Error with dictionary: "
-                                      + string(ZDICT_getErrorName(result)));
-        }
-        
-        Date after = Date::now();
-        double elapsed = after.secondsSince(before);
-        before = after;
-
-        cerr << "created dictionary of " << result << " bytes from "
-             << currentOffset << " bytes of samples in "
-             << elapsed << " seconds" << endl;
-
-        // Now compress another 1MB to see what the ratio is...
-        std::shared_ptr<ZSTD_CDict> dict
-            (ZSTD_createCDict(dictionary.data(), result, 1 /* compression level */),
+        // Compress a sample of blocks to estimate the ratio
+        std::shared_ptr<ZSTD_CDict> cdict
+            (ZSTD_createCDict(info->dict.data(), info->dict.length(),
+                              5 /* compression level */),
              ZSTD_freeCDict);
-        
         std::shared_ptr<ZSTD_CCtx> context
             (ZSTD_createCCtx(), ZSTD_freeCCtx);
 
-        size_t compressedBytes = 0;
-        size_t numSamples = 0;
-        size_t uncompressedBytes = 0;
-        for (size_t i = 0 /*valNumber*/;  i < column.indexedVals.size();  ++i) {
-            const CellValue & v = column.indexedVals[i];
-            size_t len = v.toStringLength();
-            PossiblyDynamicBuffer<char, 65536> buf(ZSTD_compressBound(len));
+        static constexpr size_t SAMPLE_BYTES = 4 * 1024 * 1024;
 
-            size_t result
-                = ZSTD_compress_usingCDict(context.get(),
-                                           buf.data(), buf.size(),
-                                           v.stringChars(), len,
-                                           dict.get());
-
-            if (ZSTD_isError(result)) {
-                throw AnnotatedException(500, "Error with compressing: "
-                                          + string(ZSTD_getErrorName(result)));
-            }
+        std::string blockBuffer;
+        size_t sampledBytes = 0;
+        size_t compressedBytes = 0;
 
-            uncompressedBytes += len;
-            compressedBytes += result;
-            numSamples += 1;
+        auto flushBlock = [&] ()
+            {
+                PossiblyDynamicBuffer<char, 65536>
+                    buf(ZSTD_compressBound(blockBuffer.length()));
+                size_t res
+                    = ZSTD_compress_usingCDict(context.get(),
+                                               buf.data(), buf.size(),
+                                               blockBuffer.data(),
+                                               blockBuffer.length(),
+                                               cdict.get());
+                if (ZSTD_isError(res)) {
+                    throw AnnotatedException(500, "Error with compressing: "
+                                             + string(ZSTD_getErrorName(res)));
+                }
+                sampledBytes += blockBuffer.length();
+                compressedBytes += res;
+                blockBuffer.clear();
+            };
 
-            //if (uncompressedBytes > 1024 * 1024)
-            //    break;
+        for (auto & v: column.indexedVals) {
+            if (sampledBytes > SAMPLE_BYTES)
+                break;
+            blockBuffer.append(v.stringChars(), v.toStringLength());
+            if (blockBuffer.length() >= ZstdStringFrozenColumn::BLOCK_SIZE)
+                flushBlock();
         }
+        if (!blockBuffer.empty())
+            flushBlock();
 
-        after = Date::now();
-        elapsed = after.secondsSince(before);
+        double ratio = 1.0 * compressedBytes / std::max<size_t>(sampledBytes, 1);
 
-        cerr << "compressed " << numSamples << " samples with "
-             << uncompressedBytes << " bytes to " << compressedBytes
-             << " bytes at " << 100.0 * compressedBytes / uncompressedBytes
-             << "% compression at "
-             << numSamples / elapsed << "/s" << endl;
+        size_t numEntries = column.maxRowNumber - column.minRowNumber + 1;
+        bool hasNulls = column.sparseIndexes.size() < numEntries;
 
-        ssize_t totalBytesRequired = sizeof(CompressedStringFrozenColumn)
-            + dictionarySize
-            + compressedBytes
-            + 4 * column.indexedVals.size();
-
-        cerr << "result is " << totalBytesRequired << endl;
+        ssize_t result = sizeof(ZstdStringFrozenColumn)
+            + info->dict.length()
+            + info->totalBytes * ratio
+            + numEntries
+              * bitsToHoldCount(info->totalStrings + hasNulls) / 8
+            + column.indexedVals.size() * sizeof(uint32_t);  // offsets
 
         return result;
     }
-    
+
     virtual FrozenColumn *
     freeze(TabularDatasetColumn & column,
            MappedSerializer & serializer,
            const ColumnFreezeParameters & params,
            std::shared_ptr<void> cachedInfo) const override
     {
-        return new CompressedStringFrozenColumn(column, serializer, params);
+        auto info = std::static_pointer_cast<CachedInfo>(cachedInfo);
+        if (info->dict.empty())
+            info->dict = trainZstdDictionary(column.indexedVals);
+        ExcAssert(!info->dict.empty());
+        return new ZstdStringFrozenColumn(column, serializer, info->dict);
     }
 
     virtual FrozenColumn *
     reconstitute(StructuredReconstituter & reconstituter) const override
     {
-        throw AnnotatedException(600, "Tabular reconstitution not finished");
+        return new ZstdStringFrozenColumn(reconstituter);
     }
 };
 
-//static RegisterFrozenColumnFormatT<CompressedStringFrozenColumnFormat> regCompressedString;
+RegisterFrozenColumnFormatT<ZstdStringFrozenColumnFormat> regZstdString;
 
 } // namespace MLDB
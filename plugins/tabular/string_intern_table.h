@@ -0,0 +1,100 @@
+/** string_intern_table.h                                          -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Dataset-wide intern table for string cell values, shared across the
+    chunks of a tabular dataset while it's being recorded.
+*/
+
+#pragma once
+
+#include "mldb/sql/cell_value.h"
+#include "mldb/utils/lightweight_hash.h"
+#include <mutex>
+
+namespace MLDB {
+
+/*****************************************************************************/
+/* STRING INTERN TABLE                                                       */
+/*****************************************************************************/
+
+/** Intern table for string values, shared between all of the mutable
+    chunks of a dataset.  A string that appears in many chunks is stored
+    once: intern() returns a copy of the canonical CellValue, and since
+    long strings are reference counted, every chunk's copy shares the
+    canonical representation.  Comparisons between two interned copies
+    of the same string then take the pointer-equality fast path in
+    CellValue::operator ==, without touching the characters.
+
+    Each distinct value also gets a stable code, assigned in insertion
+    order, which identifies it for the lifetime of the table.
+
+    The table is sharded on the value hash so that the recording threads
+    don't serialize on a single lock.  As with the per-chunk value index
+    in TabularDatasetColumn, values are keyed on their 64 bit hash alone.
+*/
+struct StringInternTable {
+    static constexpr size_t NUM_SHARDS = 32;
+
+    /** Return the canonical copy of the given value, inserting it if
+        it's the first time it has been seen.  If code is non-null, it
+        is set to the value's stable code.
+
+        Only long strings gain from sharing (short strings are stored
+        inline in the CellValue), but interning is cheap enough that the
+        caller doesn't need to distinguish.
+    */
+    CellValue intern(CellValue val, uint64_t * code = nullptr)
+    {
+        uint64_t h = val.hash();
+        size_t shardNum = h % NUM_SHARDS;
+        Shard & shard = shards[shardNum];
+
+        std::unique_lock<std::mutex> guard(shard.mutex);
+        auto it = shard.index.find(h);
+        uint32_t idx;
+        if (it == shard.index.end()) {
+            idx = shard.values.size();
+            shard.index[h] = idx;
+            shard.values.emplace_back(std::move(val));
+        }
+        else idx = it->second;
+
+        if (code)
+            *code = (uint64_t)idx * NUM_SHARDS + shardNum;
+
+        return shard.values[idx];
+    }
+
+    /** Look up a value from its code, as returned by intern(). */
+    CellValue get(uint64_t code) const
+    {
+        const Shard & shard = shards[code % NUM_SHARDS];
+        std::unique_lock<std::mutex> guard(shard.mutex);
+        return shard.values.at(code / NUM_SHARDS);
+    }
+
+    /** Number of distinct values interned so far. */
+    size_t size() const
+    {
+        size_t result = 0;
+        for (auto & shard: shards) {
+            std::unique_lock<std::mutex> guard(shard.mutex);
+            result += shard.values.size();
+        }
+        return result;
+    }
+
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        LightweightHash<uint64_t, uint32_t> index;  ///< value hash -> code / NUM_SHARDS
+        std::vector<CellValue> values;              ///< canonical copies
+    };
+
+    Shard shards[NUM_SHARDS];
+};
+
+} // namespace MLDB
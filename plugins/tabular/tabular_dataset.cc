@@ -10,6 +10,7 @@
 #include "frozen_column.h"
 #include "tabular_dataset_column.h"
 #include "tabular_dataset_chunk.h"
+#include "mldb/utils/row_bitmap.h"
 #include "mldb/arch/timers.h"
 #include "mldb/types/basic_value_descriptions.h"
 #include "mldb/utils/smart_ptr_utils.h"
@@ -34,6 +35,12 @@
 #include "mldb/engine/dataset_utils.h"
 #include "mldb/types/db/persistent.h"
 #include "mldb/block/zip_serializer.h"
+#include "mldb/compiler/filesystem.h"
+#include "mldb/sql/sql_expression_operations.h"
+#include "mldb/sql/sql_utils.h"
+#include "mldb/core/dataset_scope.h"
+#include "mldb/utils/hyperloglog.h"
+#include "mldb/utils/quantile_sketch.h"
 #include <mutex>
 
 
@@ -52,7 +59,7 @@ struct PathIndex;
 /*****************************************************************************/
 
 struct MutablePathIndex {
-    static constexpr size_t INDEX_SHARDS=32;
+    static constexpr size_t INDEX_SHARDS=64;
 
     struct Recorder {
 
@@ -66,7 +73,13 @@ struct MutablePathIndex {
         void record(const Path & path,
                     uint32_t indexInChunk)
         {
-            uint64_t hash = path.hash();
+            recordHashed(path.hash(), indexInChunk);
+        }
+
+        /// Record a row whose hash was already computed, typically in
+        /// bulk via Path::hashMany()
+        void recordHashed(uint64_t hash, uint32_t indexInChunk)
+        {
             int shard = getShard(hash);
             toInsert[shard].emplace_back(hash, indexInChunk);
             maxChunkIndex = std::max(maxChunkIndex, indexInChunk);
@@ -77,18 +90,23 @@ struct MutablePathIndex {
         {
             size_t result = 0;
 
+            // Fold our maxima into the shared ones; these are atomic
+            // so we don't need to funnel them through any one shard's
+            // lock
+            auto atomicMax = [] (std::atomic<uint32_t> & val, uint32_t newVal)
+                {
+                    uint32_t current = val.load(std::memory_order_relaxed);
+                    while (current < newVal
+                           && !val.compare_exchange_weak(current, newVal));
+                };
+
+            atomicMax(owner->maxChunkIndex, maxChunkIndex);
+            atomicMax(owner->maxChunkNumber, chunkNumber);
+
             for (size_t i = 0;  i < INDEX_SHARDS;  ++i) {
                 size_t shard = (i + chunkNumber) % INDEX_SHARDS;
                 std::unique_lock<std::mutex> guard(owner->indexLock[shard]);
 
-                // NOTE: shard == 0, not i == 0!
-                if (shard == 0) {
-                    owner->maxChunkIndex
-                        = std::max(owner->maxChunkIndex, maxChunkIndex);
-                    owner->maxChunkNumber
-                        = std::max(owner->maxChunkNumber, chunkNumber);
-                }
-
                 for (auto & e: toInsert[shard]) {
                     uint64_t hash = e.first;
                     int32_t indexInChunk = e.second;
@@ -120,13 +138,12 @@ struct MutablePathIndex {
     std::mutex indexLock[INDEX_SHARDS];
     std::vector<std::tuple<uint64_t, int, int> > index[INDEX_SHARDS];
 
-    // These are protected by indexLock[0]
-    uint32_t maxChunkIndex = 0;
-    uint32_t maxChunkNumber = 0;
+    std::atomic<uint32_t> maxChunkIndex = 0;
+    std::atomic<uint32_t> maxChunkNumber = 0;
 
-    static int getShard(uint64_t hash)
+    static int getShard(uint64_t hash, size_t numShards = INDEX_SHARDS)
     {
-        return (hash >> 23) % INDEX_SHARDS;
+        return (hash >> 23) % numShards;
     }
 };
 
@@ -307,6 +324,17 @@ struct PathIndexShard: public PathIndexMetadata {
         return result;
     }
 
+    /// Pull the cache line holding the bucket the hash probes, ahead
+    /// of pathPossibleChunks() on a batch of lookups
+    void prefetchHash(uint64_t hash) const
+    {
+        if (numEntries == 0)
+            return;
+        size_t bucket = getBucket(hash);
+        __builtin_prefetch(storage.data()
+                           + (chunkBits + offsetBits) * bucket / 32);
+    }
+
     size_t memusage() const
     {
         return sizeof(*this) + storage.memusage();
@@ -352,8 +380,6 @@ struct PathIndexShard: public PathIndexMetadata {
 
 
 struct PathIndex {
-    static constexpr size_t INDEX_SHARDS=MutablePathIndex::INDEX_SHARDS;
-
     compact_vector<std::pair<int, int>, 4>
     pathPossibleChunks(const Path & path) const
     {
@@ -363,10 +389,21 @@ struct PathIndex {
     compact_vector<std::pair<int, int>, 4>
     pathPossibleChunks(uint64_t hash) const
     {
-        int shard = MutablePathIndex::getShard(hash);
+        if (shards.empty())
+            return {};
+        int shard = MutablePathIndex::getShard(hash, shards.size());
         return shards[shard].pathPossibleChunks(hash);
     }
 
+    /// See PathIndexShard::prefetchHash()
+    void prefetchHash(uint64_t hash) const
+    {
+        if (shards.empty())
+            return;
+        int shard = MutablePathIndex::getShard(hash, shards.size());
+        shards[shard].prefetchHash(hash);
+    }
+
     size_t memusage() const
     {
         size_t result = sizeof(*this);
@@ -378,17 +415,17 @@ struct PathIndex {
 
     void serialize(StructuredSerializer & serializer) const
     {
-        for (size_t i = 0;  i < INDEX_SHARDS;  ++i) {
+        for (size_t i = 0;  i < shards.size();  ++i) {
             shards[i].serialize(*serializer.newStructure(i));
         }
     }
 
     void reconstitute(StructuredReconstituter & reconstituter)
     {
-        // TODO: make it possible to reconstitute a different number of
-        // shards.
-        ExcAssertEqual(reconstituter.getDirectory().size(), INDEX_SHARDS);
-        for (size_t i = 0;  i < INDEX_SHARDS;  ++i) {
+        // The shard count is a property of the serialized index, so an
+        // index written with a different sharding is still readable
+        shards.resize(reconstituter.getDirectory().size());
+        for (size_t i = 0;  i < shards.size();  ++i) {
             shards[i].reconstitute(*reconstituter.getStructure(i));
         }
     }
@@ -397,7 +434,7 @@ struct PathIndex {
     // hash range)
     // It returns the chunk number that contains that hash portion
     // linear chaining
-    PathIndexShard shards[INDEX_SHARDS];
+    std::vector<PathIndexShard> shards;
 };
 
 std::pair<PathIndex, std::vector<std::tuple<int, int, int, int> > >
@@ -407,6 +444,7 @@ freeze(MappedSerializer & serializer)
     //cerr << "freeze: maxChunkNumber " << maxChunkNumber << " maxChunkIndex " << maxChunkIndex << endl;
 
     PathIndex result;
+    result.shards.resize(INDEX_SHARDS);
     std::vector<std::tuple<int, int, int, int> >
         possibleCollisions[INDEX_SHARDS];
     std::atomic<size_t> totalPossibleCollisions(0);
@@ -434,6 +472,21 @@ freeze(MappedSerializer & serializer)
 }
 
 
+/*****************************************************************************/
+/* COLUMN BITMAP INDEX                                                       */
+/*****************************************************************************/
+
+/** Per-value row bitmaps for one low-cardinality column.  Null values
+    are in no bitmap, so both polarities of a predicate naturally
+    exclude them, as the SQL WHERE semantics require.
+*/
+struct ColumnBitmapIndex {
+    static constexpr size_t MAX_CARDINALITY = 256;
+
+    std::map<CellValue, RowBitmap> valueBitmaps;
+};
+
+
 /*****************************************************************************/
 /* TABULAR DATA STORE METADATA                                               */
 /*****************************************************************************/
@@ -454,6 +507,109 @@ IMPLEMENT_STRUCTURE_DESCRIPTION(TabularDataStoreMetadata)
     addField("numFixedColumns", &TabularDataStoreMetadata::numFixedColumns, "");
 }
 
+/*****************************************************************************/
+/* COLD CHUNK CACHE                                                          */
+/*****************************************************************************/
+
+/** Bounded local disk cache of chunks fetched back from cold storage.
+
+    Files are keyed on the URL they were fetched from.  When the cache
+    grows past its limit, the least recently used files are unlinked.
+    Chunks mapped from an unlinked file keep working: the pages stay
+    valid until the last mapping goes away.
+*/
+
+struct ColdChunkCache {
+
+    void init(std::string dir, int64_t maxBytes)
+    {
+        if (dir.empty()) {
+            dir = (std::filesystem::temp_directory_path()
+                   / "mldb-tabular-cold").string();
+        }
+        this->dir = std::move(dir);
+        this->maxBytes = maxBytes;
+        std::filesystem::create_directories(this->dir);
+    }
+
+    /** Return a local file with the contents of the given URL, fetching
+        it if it isn't already cached.
+    */
+    std::string fetch(const Url & url)
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        ExcAssert(!dir.empty());  // init() must have been called
+
+        std::string urlStr = url.toString();
+        std::string basename = urlStr.substr(urlStr.rfind('/') + 1);
+        std::string local
+            = dir + "/" + MLDB::format("%016llx",
+                                       (unsigned long long)
+                                       std::hash<std::string>()(urlStr))
+            + "-" + basename;
+
+        std::error_code ec;
+        if (std::filesystem::exists(local, ec)) {
+            // Touch it so eviction knows it was recently used
+            std::filesystem::last_write_time
+                (local, std::filesystem::file_time_type::clock::now(), ec);
+            return local;
+        }
+
+        // Fetch to a temporary name and rename, so a partial download
+        // is never mistaken for a cached chunk
+        std::string tmp = local + ".download";
+        {
+            filter_istream in(urlStr);
+            filter_ostream out(tmp);
+            out << in.rdbuf();
+            out.close();
+        }
+        std::filesystem::rename(tmp, local);
+
+        evict(local);
+
+        return local;
+    }
+
+private:
+    /** Unlink least recently used files until the cache fits in its
+        limit again, sparing the file that was just fetched.  Must be
+        called with the mutex held.
+    */
+    void evict(const std::string & justFetched)
+    {
+        std::vector<std::pair<std::filesystem::file_time_type,
+                              std::string> > files;
+        int64_t totalBytes = 0;
+
+        std::error_code ec;
+        for (auto & entry: std::filesystem::directory_iterator(dir, ec)) {
+            if (!entry.is_regular_file(ec))
+                continue;
+            totalBytes += entry.file_size(ec);
+            if (entry.path().string() != justFetched)
+                files.emplace_back(entry.last_write_time(ec),
+                                   entry.path().string());
+        }
+
+        std::sort(files.begin(), files.end());
+
+        for (auto & f: files) {
+            if (totalBytes <= maxBytes)
+                break;
+            int64_t size = std::filesystem::file_size(f.second, ec);
+            if (std::filesystem::remove(f.second, ec))
+                totalBytes -= size;
+        }
+    }
+
+    std::mutex mutex;
+    std::string dir;
+    int64_t maxBytes = 0;
+};
+
+
 /*****************************************************************************/
 /* TABULAR DATA STORE                                                        */
 /*****************************************************************************/
@@ -485,7 +641,7 @@ struct TabularDataset::TabularDataStore
                      TabularDatasetConfig config,
                      shared_ptr<spdlog::logger> logger)
         : engine(engine),
-          serializer(new MemorySerializer),
+          serializer(new MemorySerializer(config.useHugePages)),
           currentState(std::make_shared<CurrentState>(this, logger)),
           config(std::move(config)),
           backgroundJobsActive(0), logger(std::move(logger))
@@ -493,6 +649,11 @@ struct TabularDataset::TabularDataStore
         ExcAssert(this->logger);
         initRoutes();
 
+        if (!this->config.coldStorageUrl.empty()) {
+            coldChunkCache.init(this->config.coldStorageCacheDir,
+                                this->config.coldStorageCacheMB * 1000000);
+        }
+
         if (!config.dataFileUrl.empty()) {
             load(config.dataFileUrl);
         }
@@ -552,9 +713,71 @@ struct TabularDataset::TabularDataStore
         /// List of all chunks in the dataset
         std::vector<std::shared_ptr<const TabularDatasetChunk> > chunks;
 
+        /// Which chunks have been offloaded to cold storage (parallel
+        /// to chunks; maintained by applyTiering)
+        std::vector<bool> chunkIsCold;
+
         Date earliestTs = Date::positiveInfinity();
         Date  latestTs = Date::negativeInfinity();
 
+        /// Lazily built bitmap indexes for low cardinality columns, keyed
+        /// on column number.  A null entry means the column was scanned
+        /// and found to have too many distinct values to index.  Copying
+        /// the state (for a commit) resets the cache, since row numbering
+        /// changes as chunks are added.
+        struct BitmapIndexCache {
+            BitmapIndexCache() = default;
+            BitmapIndexCache(const BitmapIndexCache &) {}
+            BitmapIndexCache & operator = (const BitmapIndexCache &)
+            {
+                indexes.clear();
+                return *this;
+            }
+
+            std::mutex mutex;
+            std::map<int, std::shared_ptr<const ColumnBitmapIndex> > indexes;
+        };
+
+        mutable BitmapIndexCache bitmapIndexCache;
+
+        /// Cache of per-column distinct-count estimates, keyed on column
+        /// number and built lazily by sketching the distinct values of
+        /// each chunk.  Copying the state (for a commit) resets the
+        /// cache, since the new chunks change the counts.
+        struct DistinctEstimateCache {
+            DistinctEstimateCache() = default;
+            DistinctEstimateCache(const DistinctEstimateCache &) {}
+            DistinctEstimateCache & operator = (const DistinctEstimateCache &)
+            {
+                estimates.clear();
+                return *this;
+            }
+
+            std::mutex mutex;
+            std::map<int, uint64_t> estimates;
+        };
+
+        mutable DistinctEstimateCache distinctEstimateCache;
+
+        /// Cache of per-column quantile sketches, keyed on column number
+        /// and built lazily from the per-chunk distinct values and their
+        /// row counts.  Copying the state (for a commit) resets the
+        /// cache, since the new chunks change the distribution.
+        struct QuantileSketchCache {
+            QuantileSketchCache() = default;
+            QuantileSketchCache(const QuantileSketchCache &) {}
+            QuantileSketchCache & operator = (const QuantileSketchCache &)
+            {
+                sketches.clear();
+                return *this;
+            }
+
+            std::mutex mutex;
+            std::map<int, std::shared_ptr<const QuantileSketch> > sketches;
+        };
+
+        mutable QuantileSketchCache quantileSketchCache;
+
         virtual Any getStatus() const override
         {
             Json::Value status;
@@ -715,7 +938,43 @@ struct TabularDataset::TabularDataStore
                     size_t chunkRows = column.size();
                     WritableBucketList result(chunkRows, desc.numBuckets(),
                                               *owner->serializer);
-                    
+
+                    // For purely numeric columns, gather the values and
+                    // bucketize the whole chunk in one call; the
+                    // interleaved branch-free searches in bucketizeAll
+                    // go much faster than one binary search per row.
+                    if (desc.isOnlyNumeric()) {
+                        std::vector<double> vals(chunkRows);
+                        std::vector<char> isNull(chunkRows, false);
+
+                        auto onRowGather
+                            = [&] (size_t rowNum, const CellValue & val)
+                        {
+                            if (val.empty())
+                                isNull[rowNum] = true;
+                            else if (val.isNumber())
+                                vals[rowNum] = val.toDouble();
+                            else return false;  // fall back to slow path
+                            return true;
+                        };
+
+                        if (column.forEachDense(onRowGather)) {
+                            std::vector<uint32_t> bucketNums(chunkRows);
+                            desc.numeric.bucketizeAll(vals.data(),
+                                                      bucketNums.data(),
+                                                      chunkRows);
+
+                            // Bucket writes are a sequential bit stream,
+                            // so they stay out of the batched search loop
+                            for (size_t r = 0;  r < chunkRows;  ++r) {
+                                uint32_t bucket = isNull[r] ? 0 : bucketNums[r];
+                                ExcAssertLess(bucket, desc.numBuckets());
+                                result.write(bucket);
+                            }
+                            return result;
+                        }
+                    }
+
                     auto onRow = [&] (size_t rowNum, const CellValue & val)
                     {
                         uint32_t bucket = desc.getBucket(val);
@@ -970,6 +1229,62 @@ struct TabularDataset::TabularDataStore
                 ->getRowExpr(rowInChunk, owner->fixedColumns);
         }
 
+        /** Batch point lookup.  Hashes the whole batch up front,
+            probes the row index with the hash table line for upcoming
+            probes prefetched, then decodes the rows sorted by chunk
+            and row number so that consecutive decodes touch the same
+            frozen columns.  Results come back in input order.
+        */
+        std::vector<ExpressionValue>
+        getRowsExpr(const std::vector<RowPath> & rowNames) const
+        {
+            std::vector<ExpressionValue> result(rowNames.size());
+
+            std::vector<uint64_t> hashes(rowNames.size());
+            Path::hashMany(rowNames.data(), rowNames.size(),
+                           hashes.data());
+
+            // (chunk, rowInChunk, input position), sortable for
+            // decode locality
+            std::vector<std::tuple<int, int, size_t> > locations;
+            locations.reserve(rowNames.size());
+
+            constexpr size_t PREFETCH_AHEAD = 8;
+            for (size_t i = 0;  i < rowNames.size();  ++i) {
+                if (i + PREFETCH_AHEAD < rowNames.size())
+                    rowIndex.prefetchHash(hashes[i + PREFETCH_AHEAD]);
+
+                int chunkNumber = -1, rowInChunk = -1;
+                for (auto & c: rowIndex.pathPossibleChunks(hashes[i])) {
+                    Path storage;
+                    if (c.second < this->chunks[c.first]->rowCount()
+                        && this->chunks[c.first]
+                            ->getRowPath(c.second, storage)
+                            == rowNames[i]) {
+                        chunkNumber = c.first;
+                        rowInChunk = c.second;
+                        break;
+                    }
+                }
+                if (chunkNumber == -1)
+                    throw AnnotatedException
+                        (400, "Row not found in tabular dataset: "
+                         + rowNames[i].toUtf8String(),
+                         "rowName", rowNames[i]);
+                locations.emplace_back(chunkNumber, rowInChunk, i);
+            }
+
+            std::sort(locations.begin(), locations.end());
+
+            for (auto & l: locations) {
+                result[std::get<2>(l)]
+                    = chunks[std::get<0>(l)]
+                    ->getRowExpr(std::get<1>(l), owner->fixedColumns);
+            }
+
+            return result;
+        }
+
         virtual RowPath getRowPath(const RowHash & rowHash) const override
         {
             int chunkNumber;
@@ -1024,9 +1339,104 @@ struct TabularDataset::TabularDataStore
 
             stats.isNumeric_ = isNumeric && !chunks.empty();
             stats.rowCount_ = rowCount;
+            stats.distinctValues_ = stats.values.size();
             return stats;
         }
 
+        /** Estimate the number of distinct values of the given column,
+            building the sketch on first use.  Each chunk contributes
+            only its distinct values (cheap for the dictionary-coded
+            columns), and the sketch collapses the duplicates between
+            chunks, so this never materializes a global value set.
+        */
+        uint64_t getDistinctEstimate(int columnNum) const
+        {
+            std::unique_lock<std::mutex> guard(distinctEstimateCache.mutex);
+
+            auto it = distinctEstimateCache.estimates.find(columnNum);
+            if (it != distinctEstimateCache.estimates.end())
+                return it->second;
+
+            HyperLogLog sketch;
+
+            for (auto & c: columns.at(columnNum).chunks) {
+                auto onValue = [&] (const CellValue & value)
+                    {
+                        if (!value.empty())
+                            sketch.add(value.hash());
+                        return true;
+                    };
+                c.second->forEachDistinctValue(onValue);
+            }
+
+            uint64_t result = sketch.estimate();
+            distinctEstimateCache.estimates[columnNum] = result;
+            return result;
+        }
+
+        virtual uint64_t
+        getColumnDistinctEstimate(const ColumnPath & column) const override
+        {
+            auto it = columnIndex.find(column.oldHash());
+            if (it == columnIndex.end())
+                return 0;
+            return getDistinctEstimate(it->second);
+        }
+
+        /** Return the quantile sketch for the given column, building it
+            on first use.  Each chunk contributes its distinct values
+            weighted by their row counts (cheap for the dictionary-coded
+            columns), and the sketch folds the chunks together, so this
+            never sorts or materializes the column.
+        */
+        std::shared_ptr<const QuantileSketch>
+        getQuantileSketch(int columnNum) const
+        {
+            std::unique_lock<std::mutex> guard(quantileSketchCache.mutex);
+
+            auto it = quantileSketchCache.sketches.find(columnNum);
+            if (it != quantileSketchCache.sketches.end())
+                return it->second;
+
+            auto sketch = std::make_shared<QuantileSketch>();
+
+            for (auto & c: columns.at(columnNum).chunks) {
+                auto onValue = [&] (const CellValue & value, size_t rowCount)
+                    {
+                        if (value.isNumber())
+                            sketch->add(value.toDouble(), rowCount);
+                        return true;
+                    };
+                c.second->forEachDistinctValueWithRowCount(onValue);
+            }
+
+            sketch->compress();
+            quantileSketchCache.sketches[columnNum] = sketch;
+            return sketch;
+        }
+
+        virtual std::vector<double>
+        getColumnQuantiles(const ColumnPath & column,
+                           const std::vector<double> & quantiles)
+            const override
+        {
+            auto it = columnIndex.find(column.oldHash());
+            if (it == columnIndex.end()) {
+                throw AnnotatedException
+                    (400, "Tabular dataset contains no column with given hash",
+                     "columnPath", column,
+                     "knownColumns", getColumnPaths(0, -1));
+            }
+
+            auto sketch = getQuantileSketch(it->second);
+
+            std::vector<double> result;
+            result.reserve(quantiles.size());
+            for (double q: quantiles)
+                result.push_back(sketch->quantile(q));
+            return result;
+        }
+
         virtual uint64_t getRowCount() const override
         {
             return rowCount;
@@ -1042,6 +1452,448 @@ struct TabularDataset::TabularDataStore
             return { earliestTs, latestTs };
         }
 
+        /** Return the bitmap index for the given column, building it on
+            first use.  Returns a null pointer if the column has too many
+            distinct values to be worth indexing.
+        */
+        std::shared_ptr<const ColumnBitmapIndex>
+        getBitmapIndex(int columnNum) const
+        {
+            std::unique_lock<std::mutex> guard(bitmapIndexCache.mutex);
+
+            auto it = bitmapIndexCache.indexes.find(columnNum);
+            if (it != bitmapIndexCache.indexes.end())
+                return it->second;
+
+            // Row numbers are global across chunks, in chunk order
+            std::vector<uint64_t> chunkOffsets(chunks.size() + 1, 0);
+            for (size_t i = 0;  i < chunks.size();  ++i)
+                chunkOffsets[i + 1] = chunkOffsets[i] + chunks[i]->rowCount();
+
+            auto index = std::make_shared<ColumnBitmapIndex>();
+            bool tooManyValues = false;
+
+            for (auto & c: columns.at(columnNum).chunks) {
+                uint64_t base = chunkOffsets.at(c.first);
+
+                auto onRow = [&] (size_t rowNum, const CellValue & val)
+                    {
+                        if (val.empty())
+                            return true;  // nulls are in no bitmap
+                        auto vit = index->valueBitmaps.find(val);
+                        if (vit == index->valueBitmaps.end()) {
+                            if (index->valueBitmaps.size()
+                                >= ColumnBitmapIndex::MAX_CARDINALITY) {
+                                tooManyValues = true;
+                                return false;
+                            }
+                            vit = index->valueBitmaps
+                                .emplace(val, RowBitmap()).first;
+                        }
+                        vit->second.set(base + rowNum);
+                        return true;
+                    };
+
+                if (!c.second->forEach(onRow))
+                    break;
+            }
+
+            if (tooManyValues)
+                index = nullptr;
+
+            bitmapIndexCache.indexes[columnNum] = index;
+            return index;
+        }
+
+        /** Attempt to evaluate the given WHERE expression entirely from
+            bitmap indexes.  Handles AND, OR and NOT, equality comparisons
+            of a column against a constant, and bare boolean columns, over
+            columns of low enough cardinality to index.  Since null values
+            appear in no bitmap, both polarities of each predicate exclude
+            them, matching the SQL semantics of WHERE.
+
+            Returns false if the expression can't be answered this way, in
+            which case the caller should fall back to scanning.
+        */
+        bool tryGetFilterBitmap(const SqlExpression & where,
+                                const Utf8String & alias,
+                                bool negate,
+                                RowBitmap & result) const
+        {
+            // Union of the bitmaps of all values matching a predicate
+            auto columnWhere = [&] (const ColumnPath & columnName,
+                                    auto && predicate,
+                                    RowBitmap & out) -> bool
+                {
+                    ColumnPath name = removeTableName(alias, columnName);
+                    auto it = columnIndex.find(name.oldHash());
+                    if (it == columnIndex.end())
+                        return false;
+                    auto index = getBitmapIndex(it->second);
+                    if (!index)
+                        return false;  // too many values to index
+                    for (auto & v: index->valueBitmaps) {
+                        if (predicate(v.first))
+                            out.orWith(v.second);
+                    }
+                    return true;
+                };
+
+            const auto * boolean
+                = dynamic_cast<const BooleanOperatorExpression *>(&where);
+            if (boolean) {
+                if (boolean->op == "NOT" && !boolean->lhs) {
+                    return tryGetFilterBitmap(*boolean->rhs, alias,
+                                              !negate, result);
+                }
+                if ((boolean->op == "AND" || boolean->op == "OR")
+                    && boolean->lhs && boolean->rhs) {
+                    RowBitmap lBitmap, rBitmap;
+                    if (!tryGetFilterBitmap(*boolean->lhs, alias,
+                                            negate, lBitmap)
+                        || !tryGetFilterBitmap(*boolean->rhs, alias,
+                                               negate, rBitmap))
+                        return false;
+                    // De Morgan: negation swaps the combining operation
+                    bool isAnd = (boolean->op == "AND") != negate;
+                    result = std::move(lBitmap);
+                    if (isAnd)
+                        result.andWith(rBitmap);
+                    else result.orWith(rBitmap);
+                    return true;
+                }
+                return false;
+            }
+
+            const auto * comparison
+                = dynamic_cast<const ComparisonExpression *>(&where);
+            if (comparison
+                && (comparison->op == "=" || comparison->op == "!=")) {
+                auto column = dynamic_cast<const ReadColumnExpression *>
+                    (comparison->lhs.get());
+                auto constant = dynamic_cast<const ConstantExpression *>
+                    (comparison->rhs.get());
+                if (!column || !constant) {
+                    column = dynamic_cast<const ReadColumnExpression *>
+                        (comparison->rhs.get());
+                    constant = dynamic_cast<const ConstantExpression *>
+                        (comparison->lhs.get());
+                }
+                if (!column || !constant
+                    || !constant->constant.isAtom())
+                    return false;
+                CellValue constantCell = constant->constant.getAtom();
+                if (constantCell.empty())
+                    return false;  // comparison with null is never true
+
+                bool wantEqual = (comparison->op == "=") != negate;
+                return columnWhere(column->columnName,
+                                   [&] (const CellValue & v)
+                                   {
+                                       return (v == constantCell)
+                                           == wantEqual;
+                                   },
+                                   result);
+            }
+
+            // A bare column used as a boolean
+            const auto * column
+                = dynamic_cast<const ReadColumnExpression *>(&where);
+            if (column) {
+                return columnWhere(column->columnName,
+                                   [&] (const CellValue & v)
+                                   {
+                                       return v.isTrue() != negate;
+                                   },
+                                   result);
+            }
+
+            return false;
+        }
+
+        /** Attempt to turn a range comparison of a column against a
+            constant into a chunk-pruned scan: the zone map (min/max of
+            the non-null values) recorded on each frozen column when it
+            was frozen lets us skip whole chunks whose value range can't
+            satisfy the predicate, and only surviving chunks are decoded
+            and tested row by row.  This makes range predicates over
+            roughly time-ordered appends touch only the chunks that can
+            match.
+
+            Returns the empty function when the expression isn't a
+            column-versus-constant comparison, leaving the caller to
+            fall back to scanning.
+        */
+        GenerateRowsWhereFunction
+        tryGenerateRangeScan(const Utf8String & alias,
+                             const SqlExpression & where) const
+        {
+            const auto * comparison
+                = dynamic_cast<const ComparisonExpression *>(&where);
+            if (!comparison)
+                return GenerateRowsWhereFunction();
+
+            std::string op = comparison->op;
+            auto column = dynamic_cast<const ReadColumnExpression *>
+                (comparison->lhs.get());
+            auto constant = dynamic_cast<const ConstantExpression *>
+                (comparison->rhs.get());
+            if (!column || !constant) {
+                column = dynamic_cast<const ReadColumnExpression *>
+                    (comparison->rhs.get());
+                constant = dynamic_cast<const ConstantExpression *>
+                    (comparison->lhs.get());
+                // Constant on the left means the comparison is mirrored
+                if (op == "<") op = ">";
+                else if (op == "<=") op = ">=";
+                else if (op == ">") op = "<";
+                else if (op == ">=") op = "<=";
+            }
+            if (!column || !constant || !constant->constant.isAtom())
+                return GenerateRowsWhereFunction();
+            CellValue c = constant->constant.getAtom();
+            if (c.empty())
+                return GenerateRowsWhereFunction();
+
+            ColumnPredicate pred;
+            pred.constant = c;
+            if (op == "<")
+                pred.op = ColumnPredicate::LT;
+            else if (op == "<=")
+                pred.op = ColumnPredicate::LE;
+            else if (op == ">")
+                pred.op = ColumnPredicate::GT;
+            else if (op == ">=")
+                pred.op = ColumnPredicate::GE;
+            else if (op == "=" || op == "==")
+                pred.op = ColumnPredicate::EQ;
+            else return GenerateRowsWhereFunction();
+
+            ColumnPath name = removeTableName(alias, column->columnName);
+            auto it = columnIndex.find(name.oldHash());
+            if (it == columnIndex.end())
+                return GenerateRowsWhereFunction();
+
+            // Capture by value so the chunks outlive any state swap
+            auto entryChunks = columns[it->second].chunks;
+            auto chunksCopy = chunks;
+
+            auto exec = [=]
+                (ssize_t numToGenerate, Any token,
+                 const BoundParameters & params,
+                 const ProgressFunc & onProgress)
+                -> std::pair<std::vector<RowPath>, Any>
+                {
+                    std::vector<RowPath> rows;
+
+                    // Zone maps are in-memory metadata, so work out up
+                    // front which chunks survive pruning; the prefetch
+                    // lookahead below then never touches a pruned chunk.
+                    std::vector<size_t> toScan;
+                    for (size_t i = 0;  i < entryChunks.size();  ++i) {
+                        CellValue mn, mx;
+                        if (entryChunks[i].second->getValueRange(mn, mx)
+                            && !pred.rangeCanMatch(mn, mx))
+                            continue;  // whole chunk can't match
+                        toScan.push_back(i);
+                    }
+
+                    // Warm the first chunks before we start scanning
+                    for (size_t i = 0;  i < toScan.size() && i < 2;  ++i)
+                        entryChunks[toScan[i]].second->prefetch();
+
+                    for (size_t i = 0;  i < toScan.size();  ++i) {
+                        // Keep two chunks of readahead in flight while
+                        // we scan this one
+                        if (i + 2 < toScan.size())
+                            entryChunks[toScan[i + 2]].second->prefetch();
+
+                        auto & c2 = entryChunks[toScan[i]];
+                        const auto & chunk = chunksCopy.at(c2.first);
+
+                        // The format-specific kernel compares against
+                        // the packed representation; only survivors get
+                        // their row path materialized
+                        RowBitmap matching;
+                        c2.second->filterRange(0, chunk->rowCount(),
+                                               pred, matching);
+                        matching.forEach([&] (uint64_t rowNum)
+                            {
+                                rows.emplace_back(chunk->getRowPath(rowNum));
+                                return true;
+                            });
+                    }
+
+                    return { std::move(rows), Any() };
+                };
+
+            return { exec,
+                     "tabular zone-map pruned scan for " + where.surface,
+                     GenerateRowsWhereFunction::BETTER_THAN_TABLESCAN };
+        }
+
+        /** Late-materialized scan for WHERE expressions that the bitmap
+            and zone-map paths can't answer.  The generic fallback in
+            Dataset::generateRowsWhere materializes every column of every
+            row just to evaluate the predicate; here only the columns the
+            predicate actually references are decoded, chunk by chunk,
+            and just the row names of the survivors are produced.  The
+            remaining columns are then decoded only for those rows when
+            the select materializes them through getRowExpr().
+
+            Returns the empty function when the expression needs more
+            than its named columns (wildcards, joins, full-row functions
+            like columnCount(), structured column access), leaving the
+            generic scan to define the semantics.
+        */
+        GenerateRowsWhereFunction
+        tryGenerateLateMaterializedScan(const SqlBindingScope & context,
+                                        const Utf8String & alias,
+                                        const SqlExpression & where) const
+        {
+            UnboundEntities unbound = where.getUnbound();
+
+            if (unbound.vars.empty()
+                || !unbound.tables.empty()
+                || !unbound.wildcards.empty())
+                return GenerateRowsWhereFunction();
+
+            // columnCount() sees every column of the row, not just the
+            // ones the predicate names
+            if (unbound.funcs.count("columnCount"))
+                return GenerateRowsWhereFunction();
+
+            // Every referenced column must be exactly a column of the
+            // dataset.  A name that's a prefix of flattened columns
+            // (structured access) or unknown won't resolve here, and the
+            // generic path keeps its semantics.
+            std::vector<ColumnPath> names;
+            std::vector<int> entryIndexes;
+            for (auto & v: unbound.vars) {
+                ColumnPath name = removeTableName(alias, v.first);
+                auto it = columnIndex.find(name.oldHash());
+                if (it == columnIndex.end())
+                    return GenerateRowsWhereFunction();
+                names.push_back(columns[it->second].columnName);
+                entryIndexes.push_back(it->second);
+            }
+
+            // Bind the where expression against the dataset, exactly as
+            // the generic scanning fallback would
+            SqlExpressionDatasetScope dsScope(*this, alias);
+            auto whereBound = where.bind(dsScope);
+
+            // Row names are only needed per candidate row when the
+            // expression calls rowName() and friends; otherwise only the
+            // survivors get theirs materialized
+            bool needRowName = !unbound.funcs.empty();
+
+            // Per-column, per-chunk frozen columns for the predicate set.
+            // Sparse columns can be absent from some chunks.
+            std::vector<std::vector<std::shared_ptr<const FrozenColumn> > >
+                byChunk;
+            for (int i: entryIndexes) {
+                std::vector<std::shared_ptr<const FrozenColumn> >
+                    cols(chunks.size());
+                for (auto & c: columns[i].chunks)
+                    cols.at(c.first) = c.second;
+                byChunk.emplace_back(std::move(cols));
+            }
+
+            // Capture by value so the chunks outlive any state swap
+            auto chunksCopy = chunks;
+
+            auto exec = [=]
+                (ssize_t numToGenerate, Any token,
+                 const BoundParameters & params,
+                 const ProgressFunc & onProgress)
+                -> std::pair<std::vector<RowPath>, Any>
+                {
+                    std::vector<std::vector<RowPath> > kept(chunksCopy.size());
+
+                    auto doChunk = [&] (size_t chunkIdx)
+                        {
+                            const TabularDatasetChunk & chunk
+                                = *chunksCopy[chunkIdx];
+                            size_t nRows = chunk.rowCount();
+                            auto & survivors = kept[chunkIdx];
+
+                            // Decode the predicate columns for this
+                            // chunk first
+                            std::vector<std::vector<CellValue> >
+                                vals(names.size());
+                            for (size_t c = 0;  c < names.size();  ++c) {
+                                auto & col = byChunk[c][chunkIdx];
+                                auto & v = vals[c];
+                                v.resize(nRows);
+                                if (!col)
+                                    continue;  // sparse; all null here
+                                auto onVal = [&] (size_t rowNum,
+                                                  const CellValue & val)
+                                    {
+                                        v[rowNum] = val;
+                                        return true;
+                                    };
+                                col->forEachDense(onVal);
+                            }
+
+                            // Now evaluate the predicate row by row over
+                            // just those columns
+                            MatrixNamedRow row;
+                            for (size_t r = 0;  r < nRows;  ++r) {
+                                row.columns.clear();
+                                Date ts = chunk.timestamps->get(r)
+                                    .mustCoerceToTimestamp();
+                                for (size_t c = 0; c < names.size(); ++c) {
+                                    if (!vals[c][r].empty())
+                                        row.columns.emplace_back
+                                            (names[c],
+                                             std::move(vals[c][r]), ts);
+                                }
+                                if (needRowName) {
+                                    row.rowName = chunk.getRowPath(r);
+                                    row.rowHash = row.rowName;
+                                }
+
+                                auto rowScope = SqlExpressionDatasetScope
+                                    ::getRowScope(row, &params);
+
+                                if (!whereBound(rowScope, GET_LATEST)
+                                    .isTrue())
+                                    continue;
+
+                                if (needRowName)
+                                    survivors.emplace_back
+                                        (std::move(row.rowName));
+                                else survivors.emplace_back
+                                         (chunk.getRowPath(r));
+                            }
+                        };
+
+                    parallelMap(0, chunksCopy.size(), doChunk);
+
+                    // Concatenating in chunk order keeps the output
+                    // deterministic
+                    size_t totalRows = 0;
+                    for (auto & k: kept)
+                        totalRows += k.size();
+
+                    std::vector<RowPath> rows;
+                    rows.reserve(totalRows);
+                    for (auto & k: kept) {
+                        rows.insert(rows.end(),
+                                    std::make_move_iterator(k.begin()),
+                                    std::make_move_iterator(k.end()));
+                    }
+
+                    return { std::move(rows), Any() };
+                };
+
+            return { exec,
+                     "tabular late-materialized scan for " + where.surface,
+                     GenerateRowsWhereFunction::BETTER_THAN_TABLESCAN };
+        }
+
         virtual GenerateRowsWhereFunction
         generateRowsWhere(const SqlBindingScope & context,
                           const Utf8String& alias,
@@ -1049,8 +1901,65 @@ struct TabularDataset::TabularDataStore
                           ssize_t offset,
                           ssize_t limit) const
         {
-            GenerateRowsWhereFunction result;
-            return result;
+            auto bitmap = std::make_shared<RowBitmap>();
+            if (!tryGetFilterBitmap(where, alias, false /* negate */,
+                                    *bitmap)) {
+                // Not answerable from bitmaps; try a zone-map pruned
+                // range scan before falling back to a full scan
+                return tryGenerateRangeScan(alias, where);
+            }
+
+            // Capture the chunks by value so that the row paths stay
+            // available even if a commit swaps in a new state.
+            auto chunksCopy = chunks;
+
+            auto exec = [bitmap, chunksCopy]
+                (ssize_t numToGenerate, Any token,
+                 const BoundParameters & params,
+                 const ProgressFunc & onProgress)
+                -> std::pair<std::vector<RowPath>, Any>
+                {
+                    std::vector<RowPath> rows;
+                    rows.reserve(bitmap->count());
+
+                    // Walk the set rows in order, tracking which chunk
+                    // the current row number falls in as we go
+                    size_t chunkIdx = 0;
+                    uint64_t chunkStart = 0;
+                    uint64_t chunkEnd
+                        = chunksCopy.empty()
+                        ? 0 : chunksCopy[0]->rowCount();
+
+                    // Only the row names are touched here; warm those of
+                    // the first chunks, and keep two chunks of readahead
+                    // in flight as we cross each chunk boundary.
+                    for (size_t i = 0;  i < chunksCopy.size() && i < 3;  ++i)
+                        chunksCopy[i]->rowNames->prefetch();
+
+                    auto onRow = [&] (uint64_t row)
+                        {
+                            while (row >= chunkEnd) {
+                                ++chunkIdx;
+                                chunkStart = chunkEnd;
+                                chunkEnd += chunksCopy.at(chunkIdx)
+                                    ->rowCount();
+                                if (chunkIdx + 2 < chunksCopy.size())
+                                    chunksCopy[chunkIdx + 2]
+                                        ->rowNames->prefetch();
+                            }
+                            rows.emplace_back(chunksCopy[chunkIdx]
+                                              ->getRowPath(row - chunkStart));
+                            return true;
+                        };
+
+                    bitmap->forEach(onRow);
+
+                    return { std::move(rows), Any() };
+                };
+
+            return { exec,
+                     "tabular bitmap index scan for " + where.surface,
+                     GenerateRowsWhereFunction::BETTER_THAN_TABLESCAN };
         }
 
         void serialize(StructuredSerializer & serializer) const
@@ -1108,22 +2017,36 @@ struct TabularDataset::TabularDataStore
             
             auto chunkStructure = reconstituter.getStructure("ch");
             auto entries = chunkStructure->getDirectory();
-                
+
             std::vector<std::shared_ptr<TabularDatasetChunk> > newChunks;
             newChunks.resize(entries.size());
-         
-            for (auto & e: entries) {
-                int chunkNumber = e.name.toIndex();
-                if (chunkNumber < 0 || chunkNumber >= newChunks.size()) {
-                    throw AnnotatedException
-                        (400, "Corrupt Tabular Dataset: chunk index out of range");
-                }
-                if (newChunks[chunkNumber]) {
+
+            // Thawing a chunk only parses its metadata and takes
+            // references into the mapped file; the column data itself is
+            // paged in lazily on first touch.  But with thousands of
+            // chunks even the metadata adds up, so thaw them in
+            // parallel.  Chunk numbers are unique as the directory is
+            // keyed by name.
+            auto thawChunk = [&] (size_t i)
+                {
+                    auto & e = entries[i];
+                    int chunkNumber = e.name.toIndex();
+                    if (chunkNumber < 0 || chunkNumber >= newChunks.size()) {
+                        throw AnnotatedException
+                            (400, "Corrupt Tabular Dataset: chunk index out of range");
+                    }
+
+                    newChunks[chunkNumber]
+                        .reset(new TabularDatasetChunk(*e.getStructure()));
+                };
+
+            parallelMap(0, entries.size(), thawChunk);
+
+            for (auto & c: newChunks) {
+                if (!c) {
                     throw AnnotatedException
-                        (400, "Corrupt Tabular Dataset: duplicate chunk index");
+                        (400, "Corrupt Tabular Dataset: missing chunk index");
                 }
-
-                newChunks[chunkNumber].reset(new TabularDatasetChunk(*e.getStructure()));
             }
 
             // Add these chunks properly...
@@ -1209,16 +2132,28 @@ struct TabularDataset::TabularDataStore
             auto indexChunk = [&] (int chunkNum)
                 {
                     auto recorder = index.getRecorder(chunkNum);
-                    for (unsigned j = 0;
-                         j < chunks[chunkNum]->rowCount();
-                         ++j) {
-                        RowPath rowNameStorage;
-                        const RowPath & rowName
-                            = chunks[chunkNum]
-                            ->getRowPath(j, rowNameStorage);
-                        recorder.record(rowName, j);
+
+                    // Hash the row names a block at a time; the bulk
+                    // hash amortizes the per-call setup that dominates
+                    // on millions of short keys.
+                    static constexpr size_t ROWS_AT_ONCE = 1024;
+                    std::vector<RowPath> names(ROWS_AT_ONCE);
+                    std::vector<uint64_t> hashes(ROWS_AT_ONCE);
+
+                    size_t numRows = chunks[chunkNum]->rowCount();
+                    for (size_t start = 0;  start < numRows;
+                         start += ROWS_AT_ONCE) {
+                        size_t blockRows
+                            = std::min(ROWS_AT_ONCE, numRows - start);
+                        for (size_t j = 0;  j < blockRows;  ++j)
+                            names[j] = chunks[chunkNum]
+                                ->getRowPath(start + j);
+                        Path::hashMany(names.data(), blockRows,
+                                       hashes.data());
+                        for (size_t j = 0;  j < blockRows;  ++j)
+                            recorder.recordHashed(hashes[j], start + j);
                     }
-                
+
                     recorder.commit();
                 };
         
@@ -1237,11 +2172,16 @@ struct TabularDataset::TabularDataStore
 
             std::set<Path> duplicateRowNames;
             bool extraDuplicates = false;
-            
+            std::vector<std::tuple<int, int, int, int> > trueDuplicates;
+
             for (auto & c: possibleCollisions) {
                 Path name1 = chunks[std::get<0>(c)]->getRowPath(std::get<1>(c));
                 Path name2 = chunks[std::get<2>(c)]->getRowPath(std::get<3>(c));
                 if (name1 == name2) {
+                    if (owner->config.upsert) {
+                        trueDuplicates.emplace_back(c);
+                        continue;
+                    }
                     duplicateRowNames.emplace(std::move(name1));
                 }
                 if (duplicateRowNames.size() > 1000) {
@@ -1250,6 +2190,15 @@ struct TabularDataset::TabularDataStore
                 }
             }
 
+            if (!trueDuplicates.empty()) {
+                // Upserting: the older version of each duplicated row
+                // is superseded.  Compact it out of its chunk and
+                // rebuild the index over the compacted chunks.
+                dropSupersededRows(trueDuplicates);
+                reIndex();
+                return;
+            }
+
             if (!duplicateRowNames.empty()) {
                 Utf8String duplicateNames;
                 for (auto & n: duplicateRowNames) {
@@ -1273,6 +2222,88 @@ struct TabularDataset::TabularDataStore
                  << endl;
             cerr << "row index took " << rowIndexTimer.elapsed();
         }
+
+        /** Remove the superseded version of each upserted row.  Takes
+            the (chunk1, row1, chunk2, row2) duplicate pairs found while
+            indexing; in each pair the occurrence from the earlier chunk
+            (or the earlier row within the same chunk) loses.  Only the
+            chunks that actually hold a superseded row are rewritten;
+            chunk numbering is preserved so that column entries and cold
+            storage identifiers stay stable.
+        */
+        void dropSupersededRows(const std::vector<std::tuple<int, int, int, int> > & duplicates)
+        {
+            // Row numbers to drop, per chunk
+            std::map<int, std::set<uint32_t> > toDrop;
+
+            for (auto & d: duplicates) {
+                int chunk1, row1, chunk2, row2;
+                std::tie(chunk1, row1, chunk2, row2) = d;
+                if (std::tie(chunk1, row1) > std::tie(chunk2, row2)) {
+                    std::swap(chunk1, chunk2);
+                    std::swap(row1, row2);
+                }
+                toDrop[chunk1].insert(row1);
+            }
+
+            cerr << "upsert: compacting " << toDrop.size()
+                 << " chunks holding superseded rows" << endl;
+
+            for (auto & d: toDrop) {
+                chunks[d.first]
+                    = owner->compactChunk(*chunks[d.first], d.second,
+                                          d.first);
+                if ((size_t)d.first < chunkIsCold.size())
+                    chunkIsCold[d.first] = false;
+            }
+
+            // Rebuild the column entries and the row count from the
+            // compacted chunk list; the entries hold per-chunk column
+            // pointers, so patching them in place would be fiddlier
+            // than redoing them.
+            rowCount = 0;
+            columns.clear();
+            columnIndex.clear();
+            columnHashIndex.clear();
+
+            columns.reserve(owner->fixedColumns.size());
+            for (size_t i = 0;  i < owner->fixedColumns.size();  ++i) {
+                const ColumnPath & c = owner->fixedColumns[i];
+                ColumnEntry entry;
+                entry.columnName = c;
+                columns.emplace_back(entry);
+                columnIndex[c.oldHash()] = i;
+                columnHashIndex[c] = i;
+            }
+
+            for (size_t i = 0;  i < chunks.size();  ++i) {
+                const TabularDatasetChunk & chunk = *chunks[i];
+                rowCount += chunk.rowCount();
+                for (size_t j = 0;  j < chunk.columns.size();  ++j) {
+                    columns[j].chunks.emplace_back(i, chunk.columns[j]);
+                    columns[j].nonNullRowCount
+                        += chunk.columns[j]->nonNullRowCount();
+                }
+                for (auto & c: chunk.sparseColumns) {
+                    auto it = columnIndex
+                        .insert(make_pair(c.first.oldHash(),
+                                          columns.size()))
+                        .first;
+                    if (it->second == columns.size()) {
+                        ColumnEntry entry;
+                        entry.columnName = c.first;
+                        columns.emplace_back(entry);
+                        columnHashIndex[c.first] = it->second;
+                    }
+                    columns[it->second].chunks.emplace_back(i, c.second);
+                    columns[it->second].nonNullRowCount
+                        += c.second->nonNullRowCount();
+                }
+            }
+
+            ExcAssertEqual(columns.size(), columnIndex.size());
+            ExcAssertEqual(columns.size(), columnHashIndex.size());
+        }
     };
 
     /** A stream of row names used to incrementally query available rows
@@ -1443,12 +2474,70 @@ struct TabularDataset::TabularDataStore
             }
         }
 
+        /** Numeric extraction goes column by column over a whole block
+            of rows at once, asking each FrozenColumn to decode the row
+            range into a contiguous buffer in a single virtual call and
+            then interleaving into the row-major output.  This replaces
+            one virtual get() per (row, column) pair with one bulk decode
+            per (block, column) pair.
+        */
+        template<typename T>
+        void extractNumericT(size_t numValues,
+                             const std::vector<ColumnPath> & columnNames,
+                             T * output)
+        {
+            size_t nc = columnNames.size();
+
+            // 1.  Index each of the columns
+            std::vector<int> columnIndexes;
+            columnIndexes.reserve(nc);
+            for (auto & c: columnNames) {
+                auto it = state->columnIndex.find(c.oldHash());
+                if (it == state->columnIndex.end()) {
+                    columnIndexes.emplace_back(-1);
+                }
+                else {
+                    columnIndexes.emplace_back(it->second);
+                }
+            }
+
+            std::vector<T> colBuf;
+
+            // 2.  Go through chunk by chunk
+            size_t n = 0;
+            while (n < numValues) {
+                size_t todo = std::min(numValues - n, rowCount - rowIndex);
+                colBuf.resize(todo);
+
+                for (size_t i = 0;  i < nc;  ++i) {
+                    const FrozenColumn * column
+                        = (*chunkiter)->maybeGetColumn(columnIndexes[i],
+                                                       columnNames[i]);
+                    if (!column)
+                        throw AnnotatedException
+                            (400,
+                             "Couldn't find column "
+                             + columnNames[i].toUtf8String());
+
+                    column->getRowRange(rowIndex, todo, colBuf.data());
+
+                    T * op = output + n * nc + i;
+                    for (size_t r = 0;  r < todo;  ++r)
+                        op[r * nc] = colBuf[r];
+                }
+
+                n += todo;
+                rowIndex += todo - 1;
+                advance();  // moves to the next chunk at a boundary
+            }
+        }
+
         virtual void
         extractNumbers(size_t numValues,
                        const std::vector<ColumnPath> & columnNames,
                        double * output) override
         {
-            return extractT<double>(numValues, columnNames, output);
+            return extractNumericT<double>(numValues, columnNames, output);
         }
 
         virtual void
@@ -1456,7 +2545,7 @@ struct TabularDataset::TabularDataStore
                        const std::vector<ColumnPath> & columnNames,
                        float * output) override
         {
-            return extractT<float>(numValues, columnNames, output);
+            return extractNumericT<float>(numValues, columnNames, output);
         }
 
         virtual void
@@ -1553,9 +2642,24 @@ struct TabularDataset::TabularDataStore
     /// All chunks we've added but haven't yet committed
     std::vector<std::shared_ptr<TabularDatasetChunk> > frozenChunks;
 
+    /// Dataset-wide string intern table, shared by every mutable chunk
+    /// so that a string recorded into many chunks is stored once
+    std::shared_ptr<StringInternTable> stringIntern
+        = std::make_shared<StringInternTable>();
+
     /// Configuration passed in.  Constant after initialization.
     TabularDatasetConfig config;
 
+    /// Local disk cache for chunks fetched back from cold storage.
+    /// Initialized in the constructor when tiering is enabled.
+    ColdChunkCache coldChunkCache;
+
+    /// Number of times each chunk has been rewritten by upsert
+    /// compaction, keyed on chunk number; folded into cold storage
+    /// names so a rewritten chunk is re-offloaded rather than reloaded
+    /// from its stale serialized copy.  Protected by the dataset lock.
+    std::map<size_t, uint32_t> chunkCompactionGeneration;
+
     /// The number of background jobs that we're currently waiting for
     std::atomic<size_t> backgroundJobsActive;
 
@@ -1633,6 +2737,12 @@ struct TabularDataset::TabularDataStore
         return currentState.load()->getRowExpr(rowName);
     }
 
+    std::vector<ExpressionValue>
+    getRowsExpr(const std::vector<RowPath> & rowNames) const
+    {
+        return currentState.load()->getRowsExpr(rowNames);
+    }
+
     virtual RowPath getRowPath(const RowHash & rowHash) const override
     {
         return currentState.load()->getRowPath(rowHash);
@@ -1649,6 +2759,19 @@ struct TabularDataset::TabularDataStore
         return currentState.load()->getColumnStats(column, stats);
     }
 
+    virtual uint64_t
+    getColumnDistinctEstimate(const ColumnPath & column) const override
+    {
+        return currentState.load()->getColumnDistinctEstimate(column);
+    }
+
+    virtual std::vector<double>
+    getColumnQuantiles(const ColumnPath & column,
+                       const std::vector<double> & quantiles) const override
+    {
+        return currentState.load()->getColumnQuantiles(column, quantiles);
+    }
+
     virtual uint64_t getRowCount() const override
     {
         return currentState.load()->getRowCount();
@@ -1661,6 +2784,8 @@ struct TabularDataset::TabularDataStore
 
     virtual std::pair<Date, Date> getTimestampRange() const
     {
+        if (config.uniformTimestamp.isADate())
+            return { config.uniformTimestamp, config.uniformTimestamp };
         return currentState.load()->getTimestampRange();
     }
 
@@ -1675,6 +2800,15 @@ struct TabularDataset::TabularDataStore
             ->generateRowsWhere(context, alias, where, offset, limit);
     }
 
+    GenerateRowsWhereFunction
+    tryGenerateLateMaterializedScan(const SqlBindingScope & context,
+                                    const Utf8String & alias,
+                                    const SqlExpression & where) const
+    {
+        return currentState.load()
+            ->tryGenerateLateMaterializedScan(context, alias, where);
+    }
+
     void initRoutes()
     {
         addRouteSyncJsonReturn(router, "/saves", {"POST"},
@@ -1780,16 +2914,28 @@ struct TabularDataset::TabularDataStore
             auto indexChunk = [&] (int chunkNum)
                 {
                     auto recorder = index.getRecorder(chunkNum);
-                    for (unsigned j = 0;
-                         j < newState->chunks[chunkNum]->rowCount();
-                         ++j) {
-                        RowPath rowNameStorage;
-                        const RowPath & rowName
-                            = newState->chunks[chunkNum]
-                            ->getRowPath(j, rowNameStorage);
-                        recorder.record(rowName, j);
+
+                    // Hash the row names a block at a time; the bulk
+                    // hash amortizes the per-call setup that dominates
+                    // on millions of short keys.
+                    static constexpr size_t ROWS_AT_ONCE = 1024;
+                    std::vector<RowPath> names(ROWS_AT_ONCE);
+                    std::vector<uint64_t> hashes(ROWS_AT_ONCE);
+
+                    size_t numRows = newState->chunks[chunkNum]->rowCount();
+                    for (size_t start = 0;  start < numRows;
+                         start += ROWS_AT_ONCE) {
+                        size_t blockRows
+                            = std::min(ROWS_AT_ONCE, numRows - start);
+                        for (size_t j = 0;  j < blockRows;  ++j)
+                            names[j] = newState->chunks[chunkNum]
+                                ->getRowPath(start + j);
+                        Path::hashMany(names.data(), blockRows,
+                                       hashes.data());
+                        for (size_t j = 0;  j < blockRows;  ++j)
+                            recorder.recordHashed(hashes[j], start + j);
                     }
-                
+
                     rowsIndexed += recorder.commit();
                 };
         
@@ -1898,6 +3044,10 @@ struct TabularDataset::TabularDataStore
             INFO_MSG(logger) << "row index took " << rowIndexTimer.elapsed();
         }
 
+        // Push old chunks out to cold storage before the state becomes
+        // visible to queries
+        applyTiering(*newState);
+
         return newState;
     }
 
@@ -1954,7 +3104,190 @@ struct TabularDataset::TabularDataStore
 
         reconstitute(reconstituter);
     }
-    
+
+    /** URL under which the chunk with the given number is offloaded.
+        Chunk numbers are stable identifiers, as chunks are only ever
+        appended; upsert compaction rewrites a chunk's contents in
+        place, so each rewrite bumps a generation that is folded into
+        the name to avoid reloading the stale serialized copy.
+    */
+    Url coldChunkUrl(size_t chunkNumber) const
+    {
+        std::string name = "/chunk-" + to_string(chunkNumber);
+        auto it = chunkCompactionGeneration.find(chunkNumber);
+        if (it != chunkCompactionGeneration.end())
+            name += "-g" + to_string(it->second);
+        return Url(config.coldStorageUrl.toString() + name + ".zip");
+    }
+
+    /** Rewrite a frozen chunk without the given rows, which hold
+        superseded versions of upserted rows.  The surviving rows are
+        re-recorded into a mutable chunk and refrozen; row numbering
+        within the chunk changes, so the caller must rebuild the row
+        index afterwards.  Must be called with the dataset lock held.
+    */
+    std::shared_ptr<TabularDatasetChunk>
+    compactChunk(const TabularDatasetChunk & chunk,
+                 const std::set<uint32_t> & rowsToDrop,
+                 size_t chunkNumber)
+    {
+        size_t numKept = chunk.rowCount() - rowsToDrop.size();
+
+        MutableTabularDatasetChunk compacted
+            (fixedColumns.size(), std::max<size_t>(numKept, 1),
+             stringIntern);
+
+        std::vector<CellValue> vals(fixedColumns.size());
+        std::vector<std::pair<Path, CellValue> > extra;
+
+        for (size_t j = 0;  j < chunk.rowCount();  ++j) {
+            if (rowsToDrop.count(j))
+                continue;
+            Path rowName = chunk.getRowPath(j);
+            Date ts = chunk.timestamps->get(j).mustCoerceToTimestamp();
+            for (size_t i = 0;  i < fixedColumns.size();  ++i)
+                vals[i] = chunk.columns[i]->get(j);
+            extra.clear();
+            for (auto & c: chunk.sparseColumns) {
+                CellValue v = c.second->get(j);
+                if (!v.empty())
+                    extra.emplace_back(c.first, std::move(v));
+            }
+            int added = compacted.add(rowName, ts, vals.data(),
+                                      vals.size(), extra);
+            ExcAssertEqual(added, MutableTabularDatasetChunk::ADD_SUCCEEDED);
+        }
+
+        ExcAssertEqual(compacted.rowCount(), numKept);
+
+        ++chunkCompactionGeneration[chunkNumber];
+
+        ColumnFreezeParameters params;
+        return std::make_shared<TabularDatasetChunk>
+            (compacted.freeze(*serializer, params));
+    }
+
+    /** Offload one chunk: serialize it to cold storage (unless a
+        previous commit already did), fetch it back through the disk
+        cache, and return an equivalent chunk mapped from the cached
+        file.  The mapped chunk holds references into the mapping, so
+        its column data stays out of anonymous memory and is paged in
+        only when a query touches it.
+
+        Zone maps are carried over from the resident columns, since
+        they are not part of the serialized format; this keeps chunk
+        pruning of range predicates working without touching cold data.
+    */
+    std::shared_ptr<TabularDatasetChunk>
+    offloadChunk(const TabularDatasetChunk & chunk, size_t chunkNumber)
+    {
+        Url url = coldChunkUrl(chunkNumber);
+
+        if (!tryGetUriObjectInfo(url.toString()).exists) {
+            makeUriDirectory(url.toString());
+            ZipStructuredSerializer serializer(url.toUtf8String());
+            chunk.serialize(serializer);
+            serializer.commit();
+        }
+
+        std::string local = coldChunkCache.fetch(url);
+
+        ZipStructuredReconstituter reconstituter(Url("file://" + local));
+        auto mapped = std::make_shared<TabularDatasetChunk>(reconstituter);
+
+        ExcAssertEqual(mapped->rowCount(), chunk.rowCount());
+        ExcAssertEqual(mapped->fixedColumnCount(), chunk.fixedColumnCount());
+
+        auto copyValueRange = [] (const FrozenColumn & from,
+                                  FrozenColumn & to)
+            {
+                CellValue minValue, maxValue;
+                if (from.getValueRange(minValue, maxValue))
+                    to.setValueRange(std::move(minValue),
+                                     std::move(maxValue));
+            };
+
+        for (size_t j = 0;  j < chunk.columns.size();  ++j) {
+            copyValueRange(*chunk.columns[j], *mapped->columns[j]);
+        }
+        for (auto & c: chunk.sparseColumns) {
+            auto it = mapped->sparseColumns.find(c.first);
+            if (it != mapped->sparseColumns.end())
+                copyValueRange(*c.second, *it->second);
+        }
+
+        return mapped;
+    }
+
+    /** Offload all but the most recent hotChunks chunks of the given
+        state to cold storage, replacing them with versions mapped from
+        the local disk cache.  Must be called with the dataset lock
+        held, on a state that has not yet been published.
+    */
+    void applyTiering(CurrentState & state)
+    {
+        if (config.coldStorageUrl.empty())
+            return;
+
+        ssize_t hot = std::max<int64_t>(config.hotChunks, 0);
+        state.chunkIsCold.resize(state.chunks.size(), false);
+
+        std::vector<size_t> toOffload;
+        for (ssize_t i = 0;  i + hot < (ssize_t)state.chunks.size();  ++i) {
+            if (!state.chunkIsCold[i] && state.chunks[i]->rowCount() != 0)
+                toOffload.push_back(i);
+        }
+        if (toOffload.empty())
+            return;
+
+        std::vector<std::shared_ptr<TabularDatasetChunk> >
+            offloaded(toOffload.size());
+
+        // Serializing and fetching is I/O bound, so do the chunks in
+        // parallel; the transfers themselves are already multipart.
+        auto onChunk = [&] (size_t n)
+            {
+                offloaded[n] = offloadChunk(*state.chunks[toOffload[n]],
+                                            toOffload[n]);
+            };
+        parallelMap(0, toOffload.size(), onChunk);
+
+        // Patch the column entries to point at the mapped columns, then
+        // swap in the mapped chunks.  Row numbering and the row index
+        // are unchanged, since the data is identical.
+        for (size_t n = 0;  n < toOffload.size();  ++n) {
+            size_t i = toOffload[n];
+            auto & mapped = offloaded[n];
+
+            auto patch = [&] (size_t columnNum,
+                              const std::shared_ptr<FrozenColumn> & newColumn)
+                {
+                    for (auto & e: state.columns.at(columnNum).chunks) {
+                        if (e.first == i) {
+                            e.second = newColumn;
+                            return;
+                        }
+                    }
+                    ExcAssert(false);  // the column entry must exist
+                };
+
+            for (size_t j = 0;  j < mapped->columns.size();  ++j) {
+                patch(j, mapped->columns[j]);
+            }
+            for (auto & c: mapped->sparseColumns) {
+                auto it = state.columnIndex.find(c.first.oldHash());
+                ExcAssert(it != state.columnIndex.end());
+                patch(it->second, c.second);
+            }
+
+            state.chunks[i] = mapped;
+            state.chunkIsCold[i] = true;
+        }
+
+        INFO_MSG(logger) << "offloaded " << toOffload.size()
+                         << " cold chunks to " << config.coldStorageUrl;
+    }
+
     /** This is a recorder that allows parallel records from multiple
         threads. */
     struct BasicRecorder: public Recorder {
@@ -2123,7 +3456,8 @@ struct TabularDataset::TabularDataStore
                 chunk.reset
                     (new MutableTabularDatasetChunk
                      (orderedVals.size(),
-                      chunkSizeForNumColumns(orderedVals.size())));
+                      chunkSizeForNumColumns(orderedVals.size()),
+                      store->stringIntern));
             }
         }
 
@@ -2161,9 +3495,14 @@ struct TabularDataset::TabularDataStore
         {
             if (!chunk || chunk->rowCount() == 0)
                 return;
-            ColumnFreezeParameters params;
-            auto frozen = chunk->freeze(*store->serializer, params);
-            store->addFrozenChunk(std::move(frozen));
+
+            // Hand the full chunk off to the thread pool rather than
+            // freezing it here, so that this thread can go back to
+            // recording straight away and the freeze (type analysis
+            // and compression) overlaps with continued ingestion.
+            // The final commit drains the background jobs before it
+            // finalizes, so it only ever waits for the stragglers.
+            store->freezeChunkInBackground(std::move(chunk));
         }
 
         virtual
@@ -2183,6 +3522,9 @@ struct TabularDataset::TabularDataStore
                         CellValue * vals, size_t numVals,
                         std::vector<std::pair<ColumnPath, CellValue> > extra)
                 {
+                    if (store->config.uniformTimestamp.isADate())
+                        timestamp = store->config.uniformTimestamp;
+
                     if (!chunk) {
                         {
                             std::unique_lock<std::mutex> guard(store->datasetMutex);
@@ -2215,7 +3557,8 @@ struct TabularDataset::TabularDataStore
                         chunk.reset
                             (new MutableTabularDatasetChunk
                              (columnNames.size(),
-                              chunkSizeForNumColumns(columnNames.size())));
+                              chunkSizeForNumColumns(columnNames.size()),
+                              store->stringIntern));
                     }
                 };
         }
@@ -2228,7 +3571,8 @@ struct TabularDataset::TabularDataStore
 
         for (auto & c: *newChunks) {
             auto newChunk = std::make_shared<MutableTabularDatasetChunk>
-                (fixedColumns.size(), chunkSizeForNumColumns(fixedColumns.size()));
+                (fixedColumns.size(), chunkSizeForNumColumns(fixedColumns.size()),
+                 stringIntern);
             c.store(std::move(newChunk));
         }
             
@@ -2326,6 +3670,42 @@ struct TabularDataset::TabularDataStore
 
     }
 
+    /** Take a copy-free, epoch-consistent snapshot of the dataset.
+
+        Works like a commit: the mutable tail is rotated out and frozen
+        while writers continue recording into fresh chunks.  The
+        immutable state that results is returned; it shares its chunks
+        with the dataset rather than copying them, and later writes
+        don't affect it.
+    */
+    std::shared_ptr<const CurrentState> snapshot()
+    {
+        // Fast path: nothing recorded since the last commit, so the
+        // committed state already is an up to date snapshot
+        bool clean;
+        {
+            std::unique_lock<std::mutex> guard(datasetMutex);
+            clean = frozenChunks.empty();
+        }
+        if (clean) {
+            auto mc = mutableChunks.load();
+            if (mc) {
+                for (auto & c: *mc) {
+                    auto p = c.load();
+                    if (p && p->rowCount() != 0) {
+                        clean = false;
+                        break;
+                    }
+                }
+            }
+            if (clean)
+                return currentState.load();
+        }
+
+        commit();
+        return currentState.load();
+    }
+
     // freezes a new chunk in the background, and adds it to frozenChunks.
     // Updates the number of background jobs atomically so that we can know
     // when everything is finished.
@@ -2371,26 +3751,34 @@ struct TabularDataset::TabularDataStore
             (fixedColumns.size(),
              expectedSize == -1
              ? chunkSizeForNumColumns(fixedColumns.size())
-             : expectedSize);
+             : expectedSize,
+             stringIntern);
     }
 
     /** Analyze the first row to know what the columns are. */
     void createFirstChunks(const std::vector<std::tuple<ColumnPath, CellValue, Date> > & vals)
+    {
+        //The first recorded row will determine the columns
+        vector<ColumnPath> columnNames;
+        for (unsigned i = 0;  i < vals.size();  ++i)
+            columnNames.push_back(std::get<0>(vals[i]));
+
+        createFirstChunks(std::move(columnNames));
+    }
+
+    /** Same, but from an explicit list of column names. */
+    void createFirstChunks(std::vector<ColumnPath> columnNames)
     {
         // Must be done with the dataset lock held
         if (!mutableChunks.load()) {
             //need to create the mutable chunk
-            vector<ColumnPath> columnNames;
-
-            //The first recorded row will determine the columns
             LightweightHash<uint64_t, int> inputColumnIndex;
-            for (unsigned i = 0;  i < vals.size();  ++i) {
-                const ColumnPath & c = std::get<0>(vals[i]);
+            for (unsigned i = 0;  i < columnNames.size();  ++i) {
+                const ColumnPath & c = columnNames[i];
                 uint64_t ch(c.oldHash());
                 if (!inputColumnIndex.insert(make_pair(ch, i)).second)
                     throw AnnotatedException(400, "Duplicate column name in tabular dataset entry",
                                               "columnName", c.toUtf8String());
-                columnNames.push_back(c);
             }
 
             initialize(std::move(columnNames));
@@ -2399,7 +3787,8 @@ struct TabularDataset::TabularDataStore
 
             for (auto & c: *newChunks) {
                 auto newChunk = std::make_shared<MutableTabularDatasetChunk>
-                    (fixedColumns.size(), chunkSizeForNumColumns(fixedColumns.size()));
+                    (fixedColumns.size(), chunkSizeForNumColumns(fixedColumns.size()),
+                     stringIntern);
                 c.store(std::move(newChunk));
             }
             
@@ -2418,7 +3807,12 @@ struct TabularDataset::TabularDataStore
     prepareRow(Vals&& vals)
     {
         std::vector<CellValue> orderedVals(fixedColumns.size());
-        Date ts = Date::negativeInfinity();
+
+        // With a declared uniform timestamp, the per-value timestamps
+        // are ignored and the scan for the row timestamp is skipped
+        const bool uniformTs = config.uniformTimestamp.isADate();
+        Date ts = uniformTs
+            ? config.uniformTimestamp : Date::negativeInfinity();
 
         std::vector<std::pair<ColumnPath, CellValue> > newColumns;
 
@@ -2445,7 +3839,8 @@ struct TabularDataset::TabularDataStore
 
             orderedVals[iter->second] = std::move(std::get<1>(vals[i]));
 
-            ts = std::max(ts, std::get<2>(vals[i]));
+            if (!uniformTs)
+                ts = std::max(ts, std::get<2>(vals[i]));
         }
 
         return std::make_tuple(std::move(orderedVals),
@@ -2477,11 +3872,23 @@ struct TabularDataset::TabularDataStore
             = std::get<1>(rowVals);
         Date ts = std::get<2>(rowVals);
 
-        int chunkNum = (rowName.hash() >> 32) % mc->n;
+        addRowToChunk(std::move(rowName), ts, orderedVals, newColumns, *mc);
+    }
+
+    /** Add a single prepared row (values already in fixed column order)
+        to one of the mutable chunks, rotating and background-freezing
+        the chunk if it's full.  The values are consumed.
+    */
+    void addRowToChunk(RowPath rowName, Date ts,
+                       std::vector<CellValue> & orderedVals,
+                       std::vector<std::pair<ColumnPath, CellValue> > & newColumns,
+                       ChunkList & mc)
+    {
+        int chunkNum = (rowName.hash() >> 32) % mc.n;
 
         for (int written = MutableTabularDatasetChunk::ADD_PERFORM_ROTATION;
              written != MutableTabularDatasetChunk::ADD_SUCCEEDED;) {
-            auto chunkPtr = mc->chunks[chunkNum].load();
+            auto chunkPtr = mc.chunks[chunkNum].load();
             ExcAssert(chunkPtr);
             written = chunkPtr->add(rowName, ts,
                                     orderedVals.data(),
@@ -2493,8 +3900,9 @@ struct TabularDataset::TabularDataStore
                      == MutableTabularDatasetChunk::ADD_PERFORM_ROTATION) {
                 // We need a rotation, and we've been selected to do it
                 auto newChunk = std::make_shared<MutableTabularDatasetChunk>
-                    (fixedColumns.size(), chunkSizeForNumColumns(fixedColumns.size()));
-                if (mc->chunks[chunkNum]
+                    (fixedColumns.size(), chunkSizeForNumColumns(fixedColumns.size()),
+                     stringIntern);
+                if (mc.chunks[chunkNum]
                     .compare_exchange_strong(chunkPtr, newChunk)) {
                     // Successful rotation.  First we background freeze
                     // the chunk.  Then the old one goes in the list of
@@ -2505,6 +3913,80 @@ struct TabularDataset::TabularDataStore
             }
         }
     }
+
+    /** Columnar batch record: one buffer of cells per column.  The
+        input columns are resolved against the fixed columns once for
+        the whole batch, and the cells then stream straight into the
+        chunk columns without passing through per-cell (column, value,
+        timestamp) tuples.
+    */
+    void recordColumnar(const std::vector<RowPath> & rowNames,
+                        const std::vector<ColumnPath> & columnNames,
+                        std::vector<std::vector<CellValue> > columns,
+                        Date ts)
+    {
+        if (rowNames.empty())
+            return;
+
+        if (config.uniformTimestamp.isADate())
+            ts = config.uniformTimestamp;
+
+        auto mc = mutableChunks.load();
+
+        if (!mc) {
+            std::unique_lock<std::mutex> guard(datasetMutex);
+            createFirstChunks(columnNames);
+            mc = mutableChunks.load();
+        }
+
+        ExcAssert(mc);
+
+        // Resolve each input column once per batch, not once per cell
+        constexpr int IGNORE_COLUMN = -1;
+        constexpr int SPARSE_COLUMN = -2;
+
+        std::vector<int> fixedIndex(columnNames.size(), IGNORE_COLUMN);
+        for (unsigned i = 0;  i < columnNames.size();  ++i) {
+            auto iter = fixedColumnIndex.find(columnNames[i].oldHash());
+            if (iter != fixedColumnIndex.end()) {
+                fixedIndex[i] = iter->second;
+                continue;
+            }
+            switch (config.unknownColumns) {
+            case UC_ERROR:
+                throw AnnotatedException
+                    (400,
+                     "New column name while recording row in tabular dataset "
+                     "with unknownColumns=ERROR",
+                     "columnName", columnNames[i].toUtf8String(),
+                     "knownColumns", fixedColumns);
+            case UC_IGNORE:
+                break;
+            case UC_ADD:
+                fixedIndex[i] = SPARSE_COLUMN;
+                break;
+            }
+        }
+
+        // Both buffers are re-used from row to row; add() leaves the
+        // moved-from cells empty
+        std::vector<CellValue> orderedVals(fixedColumns.size());
+        std::vector<std::pair<ColumnPath, CellValue> > newColumns;
+
+        for (size_t r = 0;  r < rowNames.size();  ++r) {
+            for (size_t i = 0;  i < columns.size();  ++i) {
+                int idx = fixedIndex[i];
+                if (idx >= 0)
+                    orderedVals[idx] = std::move(columns[i][r]);
+                else if (idx == SPARSE_COLUMN && !columns[i][r].empty())
+                    newColumns.emplace_back(columnNames[i],
+                                            std::move(columns[i][r]));
+            }
+
+            addRowToChunk(rowNames[r], ts, orderedVals, newColumns, *mc);
+            newColumns.clear();
+        }
+    }
 };
 
 TabularDataset::
@@ -2567,6 +4049,13 @@ getRowExpr(const RowPath & row) const
     return itl->getRowExpr(row);
 }
 
+std::vector<ExpressionValue>
+TabularDataset::
+getRowsExpr(const std::vector<RowPath> & rows) const
+{
+    return itl->getRowsExpr(rows);
+}
+
 GenerateRowsWhereFunction
 TabularDataset::
 generateRowsWhere(const SqlBindingScope & context,
@@ -2579,6 +4068,17 @@ generateRowsWhere(const SqlBindingScope & context,
         = itl->generateRowsWhere(context, alias, where, offset, limit);
     if (!fn)
         fn = Dataset::generateRowsWhere(context, alias, where, offset, limit);
+
+    // If all the generic path could offer is a full scan that
+    // materializes every column per row, see whether we can evaluate the
+    // predicate off just the columns it references instead
+    if (fn.complexity == GenerateRowsWhereFunction::TABLESCAN) {
+        GenerateRowsWhereFunction late
+            = itl->tryGenerateLateMaterializedScan(context, alias, where);
+        if (late)
+            fn = std::move(late);
+    }
+
     return fn;
 }
 
@@ -2593,7 +4093,23 @@ void
 TabularDataset::
 commit()
 {
-    return itl->commit();
+    itl->commit();
+
+    // The new state is now visible to readers; fire any registered
+    // commit callbacks (materialized views, etc)
+    Dataset::commit();
+}
+
+std::shared_ptr<Dataset>
+TabularDataset::
+snapshot()
+{
+    auto state = itl->snapshot();
+
+    // The state only exposes const (query) operations, so sharing it
+    // non-const follows the same pattern as its getMatrixView()
+    return std::const_pointer_cast<TabularDataStore::CurrentState>
+        (std::move(state));
 }
 
 Dataset::MultiChunkRecorder
@@ -2628,6 +4144,37 @@ recordRows(const std::vector<std::pair<RowPath, std::vector<std::tuple<ColumnPat
         itl->recordRow(r.first, r.second);
 }
 
+void
+TabularDataset::
+recordColumnar(const std::vector<RowPath> & rowNames,
+               const std::vector<ColumnPath> & columnNames,
+               std::vector<std::vector<CellValue> > columns,
+               Date timestamp)
+{
+    if (columns.size() != columnNames.size())
+        throw AnnotatedException(400, "recordColumnar: one column buffer "
+                                 "required per column name",
+                                 "numColumnNames", columnNames.size(),
+                                 "numColumns", columns.size());
+    for (auto & c: columns) {
+        if (c.size() != rowNames.size())
+            throw AnnotatedException(400, "recordColumnar: each column buffer "
+                                     "must have one value per row",
+                                     "numRows", rowNames.size(),
+                                     "columnLength", c.size());
+    }
+    for (auto & r: rowNames) {
+        if (r.empty())
+            throw AnnotatedException(400, "empty row names are not allowed");
+    }
+    for (auto & c: columnNames) {
+        if (c.empty())
+            throw AnnotatedException(400, "empty column names are not allowed");
+    }
+
+    itl->recordColumnar(rowNames, columnNames, std::move(columns), timestamp);
+}
+
 RestRequestMatchResult
 TabularDataset::
 handleRequest(RestConnection & connection,
@@ -2668,12 +4215,46 @@ TabularDatasetConfigDescription()
             "Action to take on unknown columns.  Values are 'ignore', "
              "'error' (default), or 'add' which will allow an unlimited "
             "number of sparse columns to be added.");
+    addAuto("upsert", &TabularDatasetConfig::upsert,
+            "When true, recording a row whose name already exists "
+            "supersedes the earlier version instead of raising a "
+            "duplicate row name error.  Superseded rows are compacted "
+            "out of the chunks holding them when the new rows are "
+            "committed, so updating a small number of rows rewrites "
+            "only the affected chunks.");
     addField("dataFileUrl", &TabularDatasetConfig::dataFileUrl,
              "URL (which must currently be on the local filesystem, ie "
              "file://...) from which the data will be memory mapped.  In "
              "the case that the given URL does not exist, it will be "
              "created and the file used as a memory mapped backing for "
              "the data file.");
+    addField("coldStorageUrl", &TabularDatasetConfig::coldStorageUrl,
+             "URL prefix (eg s3://bucket/path) under which chunks beyond "
+             "the `hotChunks` most recent are offloaded on commit.  Cold "
+             "chunks keep their metadata and zone maps in memory; queries "
+             "that touch their data fetch it through a bounded local disk "
+             "cache.  Empty (the default) keeps all chunks in memory.");
+    addAuto("hotChunks", &TabularDatasetConfig::hotChunks,
+            "Number of most recently committed chunks kept resident in "
+            "memory when `coldStorageUrl` is set.");
+    addAuto("coldStorageCacheDir", &TabularDatasetConfig::coldStorageCacheDir,
+            "Local directory used to cache fetched cold chunks.  Empty "
+            "picks a default under the system temporary directory.");
+    addAuto("coldStorageCacheMB", &TabularDatasetConfig::coldStorageCacheMB,
+            "Upper bound on the size of the cold chunk disk cache, in "
+            "megabytes.  Least recently used chunks are evicted first.");
+    addAuto("uniformTimestamp", &TabularDatasetConfig::uniformTimestamp,
+            "When set, all values recorded into the dataset take this "
+            "timestamp and per-value timestamps on input are ignored.  "
+            "For snapshot-style data this elides timestamp storage (the "
+            "timestamp column freezes to a constant) and skips per-value "
+            "timestamp handling during recording; the constant is "
+            "synthesized on output.");
+    addAuto("useHugePages", &TabularDatasetConfig::useHugePages,
+            "Back large frozen column allocations with 2MB huge pages "
+            "to reduce TLB pressure when scanning very large datasets. "
+            "Falls back to transparent huge pages, then normal pages, "
+            "when no hugetlb pool is configured.");
 }
 
 namespace {
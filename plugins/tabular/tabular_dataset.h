@@ -31,6 +31,38 @@ DECLARE_ENUM_DESCRIPTION(UnknownColumnAction);
 
 struct TabularDatasetConfig: public PersistentDatasetConfig {
     UnknownColumnAction unknownColumns = UC_ERROR;
+
+    /// When true, recording a row whose name already exists supersedes
+    /// the earlier version instead of raising a duplicate row name
+    /// error.  Superseded rows are compacted out of the chunks holding
+    /// them when the new rows are committed, so a small delta rewrites
+    /// only the affected chunks rather than the whole dataset.
+    bool upsert = false;
+
+    /// URL prefix under which cold chunks are offloaded.  Empty (the
+    /// default) disables tiering and keeps all chunks resident.
+    Url coldStorageUrl;
+
+    /// Number of most recently committed chunks kept resident in memory
+    /// when tiering is enabled; older chunks are offloaded on commit.
+    int64_t hotChunks = 16;
+
+    /// Local directory used to cache fetched cold chunks.  Empty picks
+    /// a default under the system temporary directory.
+    std::string coldStorageCacheDir;
+
+    /// Upper bound on the size of the cold chunk disk cache, in MB.
+    int64_t coldStorageCacheMB = 4096;
+
+    /// Back large frozen column allocations with 2MB huge pages to
+    /// reduce TLB pressure when scanning very large datasets.
+    bool useHugePages = false;
+
+    /// When set, every recorded value takes this timestamp and the
+    /// per-value timestamps on input are ignored.  The timestamp
+    /// column then freezes to a constant and recording skips per-value
+    /// timestamp handling; the constant is synthesized on output.
+    Date uniformTimestamp = Date::notADate();
 };
 
 DECLARE_STRUCTURE_DESCRIPTION(TabularDatasetConfig);
@@ -52,7 +84,10 @@ struct TabularDataset : public Dataset {
     virtual std::shared_ptr<RowStream> getRowStream() const;
 
     virtual ExpressionValue getRowExpr(const RowPath & row) const;
-    
+
+    virtual std::vector<ExpressionValue>
+    getRowsExpr(const std::vector<RowPath> & rows) const override;
+
     virtual std::pair<Date, Date> getTimestampRange() const;
 
     virtual GenerateRowsWhereFunction
@@ -67,6 +102,17 @@ struct TabularDataset : public Dataset {
     /** Commit changes to the database. */
     virtual void commit();
 
+    /** Take a copy-free, epoch-consistent snapshot of the dataset.
+
+        The mutable tail is rotated out and frozen, with concurrent
+        writers continuing into fresh chunks, and the resulting
+        immutable state is returned as a dataset that can be queried
+        independently of any later writes.  The snapshot shares its
+        chunks with this dataset rather than copying them, and remains
+        valid for the lifetime of this object.
+    */
+    std::shared_ptr<Dataset> snapshot();
+
     virtual MultiChunkRecorder getChunkRecorder();
 
     virtual void
@@ -76,7 +122,18 @@ struct TabularDataset : public Dataset {
     virtual void
     recordRows(const std::vector<std::pair<RowPath,
                std::vector<std::tuple<ColumnPath, CellValue, Date> > > > & rows);
-    
+
+    /** Columnar batch record.  The input columns are resolved against
+        the dataset's fixed columns once per batch, and the cell buffers
+        stream straight into the mutable chunk storage without going
+        through per-cell tuples.
+    */
+    virtual void
+    recordColumnar(const std::vector<RowPath> & rowNames,
+                   const std::vector<ColumnPath> & columnNames,
+                   std::vector<std::vector<CellValue> > columns,
+                   Date timestamp) override;
+
     virtual RestRequestMatchResult
     handleRequest(RestConnection & connection,
                   const RestRequest & request,
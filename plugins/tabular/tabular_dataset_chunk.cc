@@ -271,15 +271,19 @@ TabularDatasetChunk(StructuredReconstituter & reconstituter)
 /*****************************************************************************/
 
 MutableTabularDatasetChunk::
-MutableTabularDatasetChunk(size_t numColumns, size_t maxSize)
+MutableTabularDatasetChunk(size_t numColumns, size_t maxSize,
+                           std::shared_ptr<StringInternTable> stringIntern)
     : maxSize(maxSize), rowCount_(0),
       columns(numColumns), isFrozen(false),
+      stringIntern(std::move(stringIntern)),
       addFailureNotified(false)
 {
     timestamps.reserve(maxSize);
     rowNames.reserve(maxSize);
-    for (unsigned i = 0;  i < numColumns;  ++i)
+    for (unsigned i = 0;  i < numColumns;  ++i) {
         columns[i].reserve(maxSize);
+        columns[i].intern = this->stringIntern;
+    }
 }
 
 TabularDatasetChunk
@@ -344,8 +348,10 @@ add(RowPath & rowName,
     }
 
     for (auto & e: extra) {
-        auto it = sparseColumns.emplace(std::move(e.first), TabularDatasetColumn()).first;
-        it->second.add(numRows, std::move(e.second));
+        auto res = sparseColumns.emplace(std::move(e.first), TabularDatasetColumn());
+        if (res.second)
+            res.first->second.intern = stringIntern;
+        res.first->second.add(numRows, std::move(e.second));
     }
 
     ++rowCount_;
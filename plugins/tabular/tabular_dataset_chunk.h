@@ -12,6 +12,7 @@
 #include "mldb/types/path.h"
 #include "mldb/types/date.h"
 #include "tabular_dataset_column.h"
+#include "string_intern_table.h"
 #include "tabular_dataset.h"
 #include <mutex>
 
@@ -136,7 +137,9 @@ private:
 
 struct MutableTabularDatasetChunk {
 
-    MutableTabularDatasetChunk(size_t numColumns, size_t maxSize);
+    MutableTabularDatasetChunk(size_t numColumns, size_t maxSize,
+                               std::shared_ptr<StringInternTable> stringIntern
+                                   = nullptr);
 
     MutableTabularDatasetChunk(MutableTabularDatasetChunk && other) noexcept = delete;
     MutableTabularDatasetChunk & operator = (MutableTabularDatasetChunk && other) noexcept = delete;
@@ -166,6 +169,10 @@ struct MutableTabularDatasetChunk {
     /// Set of sparse columns
     std::unordered_map<Path, TabularDatasetColumn> sparseColumns;
 
+    /// Dataset-wide string intern table, propagated to each column
+    /// (including sparse columns created as rows come in)
+    std::shared_ptr<StringInternTable> stringIntern;
+
     /// Ordered list of row names
     TabularDatasetColumn rowNames;
 
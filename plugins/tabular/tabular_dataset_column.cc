@@ -6,6 +6,7 @@
 */
 
 #include "tabular_dataset_column.h"
+#include "string_intern_table.h"
 
 
 
@@ -80,6 +81,15 @@ getIndex(CellValue & val)
     int index = -1;
     if (it == valueIndex.end()) {
         columnTypes.update(val);
+
+        // Swap in the dataset-wide canonical copy of string values, so
+        // that every chunk recording this string shares one underlying
+        // representation and comparisons against it take the pointer
+        // equality fast path.  Doing it here costs one intern per
+        // distinct value per chunk, not one per row.
+        if (intern && val.isString())
+            val = intern->intern(std::move(val));
+
         index = indexedVals.size();
         lastValue = val;
         valueIndex[hash] = index;
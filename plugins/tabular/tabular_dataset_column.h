@@ -15,6 +15,8 @@
 
 namespace MLDB {
 
+struct StringInternTable;
+
 
 /*****************************************************************************/
 /* TABULAR DATASET COLUMN                                                    */
@@ -58,6 +60,11 @@ struct TabularDatasetColumn {
     ColumnTypes columnTypes;
     bool isFrozen;
 
+    /// Dataset-wide string intern table.  When set, each new distinct
+    /// string value is replaced by the shared canonical copy, so that
+    /// a string recorded in many chunks is stored once.
+    std::shared_ptr<StringInternTable> intern;
+
     std::shared_ptr<FrozenColumn>
     freeze(MappedSerializer & serializer,
            const ColumnFreezeParameters & params);
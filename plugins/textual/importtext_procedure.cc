@@ -28,6 +28,7 @@
 #include "mldb/base/parse_context.h"
 #include "mldb/sql/sql_expression_operations.h"
 #include "mldb/base/optimized_path.h"
+#include <cstring>
 
 
 using namespace std;
@@ -362,12 +363,12 @@ parseFixedWidthCsvRow(const char * & line,
             bool parseColumn = colNum >= columnIsUsed.size()
                 || columnIsUsed[colNum];
             
-            auto pushChar = [&] (char c)
+            auto pushChars = [&] (const char * p, size_t n)
                 {
-                    if (!parseColumn)
+                    if (!parseColumn || n == 0)
                         return;
-                    
-                    if (len == buflen) {
+
+                    while (len + n > buflen) {
                         std::unique_ptr<char[]> newBuf(new char[buflen * 2]);
                         std::copy(s, s + len, newBuf.get());
                         sdynamic.swap(newBuf);
@@ -375,37 +376,43 @@ parseFixedWidthCsvRow(const char * & line,
                         buflen *= 2;
                     }
 
-
-                    ExcAssertLess(len, buflen);
-                    eightBit = eightBit || !isascii(c);
-                    s[len++] = c;
+                    for (size_t i = 0;  i < n;  ++i)
+                        eightBit = eightBit || !isascii(p[i]);
+                    std::memcpy(s + len, p, n);
+                    len += n;
                 };
 
-            for (; line < lineEnd;  ++line) {
-                const char c = *line;
-                if (c == quote) {
+            // Scan for the closing quote with memchr and copy literal
+            // runs in bulk, rather than going character by character.
+            while (line < lineEnd) {
+                const char * q = (const char *)
+                    memchr(line, quote, lineEnd - line);
+                if (!q) {
+                    line = lineEnd;
+                    break;  // unclosed quote
+                }
+
+                pushChars(line, q - line);
+                line = q + 1;
+
+                if (line >= lineEnd) {
+                    ok = true;
+                    break;
+                }
+                else if (*line == separator) {
+                    ok = true;
+                    ++line;
+                    break;
+                }
+                else if (*line == quote) {
+                    // doubled quote; take a literal value
+                    pushChars(&quote, 1);
                     ++line;
-                    if (line >= lineEnd) {
-                        ok = true;
-                        break;
-                    }
-                    else if (*line == separator) {
-                        ok = true;
-                        ++line;
-                        break;
-                    }
-                    else if (*line == quote) {
-                        // doubled quote; take a literal value
-                        pushChar(quote);
-                    }
-                    else {
-                        // Error
-                        errorMsg = "Garbage after closing quote";
-                        break;
-                    }
                 }
                 else {
-                    pushChar(c);
+                    // Error
+                    errorMsg = "Garbage after closing quote";
+                    break;
                 }
             }
 
@@ -464,14 +471,23 @@ parseFixedWidthCsvRow(const char * & line,
             bool eightBit = !isascii(c);
             size_t len = 1;
 
-            for (; line < lineEnd;  ++line, ++len) {
-                const char c = *line;
-                if (c == separator && !isTextLine) {
-                    ++line;
-                    break;
+            if (isTextLine) {
+                for (; line < lineEnd;  ++line, ++len) {
+                    if (!isascii(*line))
+                        eightBit = true;
                 }
-                if (!isascii(c))
-                    eightBit = true;
+            }
+            else {
+                // Find the end of the field with memchr, then do a
+                // separate pass for non-ASCII characters; both scans
+                // run at memory speed instead of byte by byte.
+                const char * sep = (const char *)
+                    memchr(line, separator, lineEnd - line);
+                const char * fieldEnd = sep ? sep : lineEnd;
+                for (const char * p = line;  p < fieldEnd;  ++p)
+                    eightBit = eightBit || !isascii(*p);
+                len += fieldEnd - line;
+                line = sep ? sep + 1 : lineEnd;
             }
 
             values[colNum++] = finishString(start, len, eightBit);
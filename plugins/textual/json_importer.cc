@@ -13,6 +13,7 @@
 #include "mldb/types/structure_description.h"
 #include "mldb/vfs/filter_streams.h"
 #include "mldb/types/any_impl.h"
+#include "mldb/types/json_parsing.h"
 #include "mldb/utils/for_each_line.h"
 #include "mldb/types/annotated_exception.h"
 #include "mldb/vfs/filter_streams.h"
@@ -288,6 +289,11 @@ struct JSONImporter: public Procedure {
             /// Recorder object for this thread that the dataset gives us
             /// to record into the dataset.
             std::unique_ptr<Recorder> threadRecorder;
+
+            /// Reusable JSON parser for this thread.  Re-initializing it
+            /// per line keeps the path stack and its allocations alive
+            /// across documents instead of rebuilding them each time.
+            StreamingJsonParsingContext parser;
         };
 
         PerThreadAccumulator<ThreadAccum> accum;
@@ -334,8 +340,17 @@ struct JSONImporter: public Procedure {
             if(lineLength == 0)
                 return handleError("empty line", actualLineNum, "");
 
-            StreamingJsonParsingContext parser(filename, line, lineLength,
-                                               actualLineNum);
+            // The line is already in memory, so parse directly from it with
+            // a stack-allocated ParseContext rather than heap-allocating a
+            // fresh one inside the parser for every document
+            ParseContext lineContext(filename, line, lineLength,
+                                     actualLineNum);
+            StreamingJsonParsingContext & parser = threadAccum.parser;
+            // A parse error on a previous line can leave entries on the
+            // path stack; unwind them before reusing the parser
+            while (parser.pathLength())
+                parser.popPath();
+            parser.init(lineContext);
 
             skipJsonWhitespace(*parser.context);
             if (parser.context->eof()) {
@@ -0,0 +1,1440 @@
+/* parquet_importer.cc
+   Jeremy Barnes, 30 August 2026
+
+   This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+   Native importer for Parquet files.  Reads the columnar format directly
+   instead of round-tripping through CSV: the file footer is parsed from
+   the Thrift compact encoding, column chunks are decoded straight from
+   their dictionary and RLE pages, and row groups whose statistics can't
+   satisfy the where clause are skipped without being read at all.
+*/
+
+#include "mldb/core/procedure.h"
+#include "mldb/core/dataset.h"
+#include "mldb/types/structure_description.h"
+#include "mldb/types/any_impl.h"
+#include "mldb/types/annotated_exception.h"
+#include "mldb/vfs/filter_streams.h"
+#include "mldb/vfs/fs_utils.h"
+#include "mldb/vfs/compressor.h"
+#include "mldb/block/memory_region.h"
+#include "mldb/base/parallel.h"
+#include "mldb/base/exc_assert.h"
+#include "mldb/arch/timers.h"
+#include "mldb/rest/cancellation_exception.h"
+#include "mldb/sql/sql_expression_operations.h"
+#include "mldb/utils/progress.h"
+#include "mldb/utils/log.h"
+#include "sql_csv_scope.h"
+
+#include <atomic>
+#include <mutex>
+
+using namespace std;
+
+
+namespace MLDB {
+
+namespace {
+
+/*****************************************************************************/
+/* THRIFT COMPACT PROTOCOL                                                   */
+/*****************************************************************************/
+
+/* Parquet metadata is serialized with the Thrift compact protocol.  This
+   is a minimal reader for it: varints, zigzag integers, binary fields and
+   the field/list headers, with a generic skip for anything the importer
+   doesn't care about, so files written with newer metadata fields still
+   load.
+*/
+
+enum ThriftType {
+    TT_STOP = 0,
+    TT_TRUE = 1,
+    TT_FALSE = 2,
+    TT_BYTE = 3,
+    TT_I16 = 4,
+    TT_I32 = 5,
+    TT_I64 = 6,
+    TT_DOUBLE = 7,
+    TT_BINARY = 8,
+    TT_LIST = 9,
+    TT_SET = 10,
+    TT_MAP = 11,
+    TT_STRUCT = 12
+};
+
+struct ThriftReader {
+    ThriftReader(const uint8_t * p, const uint8_t * end)
+        : p(p), end(end)
+    {
+    }
+
+    const uint8_t * p;
+    const uint8_t * end;
+
+    uint8_t readByte()
+    {
+        if (p >= end)
+            throw AnnotatedException(400, "Truncated Parquet metadata");
+        return *p++;
+    }
+
+    uint64_t readUnsignedVarint()
+    {
+        uint64_t result = 0;
+        int shift = 0;
+        for (;;) {
+            uint8_t b = readByte();
+            result |= uint64_t(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return result;
+            shift += 7;
+            if (shift > 63)
+                throw AnnotatedException(400, "Invalid varint in Parquet metadata");
+        }
+    }
+
+    int64_t readZigzag()
+    {
+        uint64_t v = readUnsignedVarint();
+        return (v >> 1) ^ -int64_t(v & 1);
+    }
+
+    std::string readBinary()
+    {
+        uint64_t len = readUnsignedVarint();
+        if (uint64_t(end - p) < len)
+            throw AnnotatedException(400, "Truncated Parquet metadata");
+        std::string result((const char *)p, len);
+        p += len;
+        return result;
+    }
+
+    /** Read a field header.  Returns false at the stop field; otherwise
+        sets the (cumulative) field id and the wire type. */
+    bool readFieldHeader(int16_t & fieldId, int & type)
+    {
+        uint8_t b = readByte();
+        if (b == TT_STOP)
+            return false;
+        type = b & 0xf;
+        int delta = b >> 4;
+        if (delta == 0)
+            fieldId = readZigzag();
+        else fieldId += delta;
+        return true;
+    }
+
+    /** Read a list header, returning the element type and count. */
+    size_t readListHeader(int & elemType)
+    {
+        uint8_t b = readByte();
+        elemType = b & 0xf;
+        size_t size = b >> 4;
+        if (size == 15)
+            size = readUnsignedVarint();
+        return size;
+    }
+
+    void skip(int type)
+    {
+        switch (type) {
+        case TT_TRUE:
+        case TT_FALSE:
+            return;
+        case TT_BYTE:
+            readByte();
+            return;
+        case TT_I16:
+        case TT_I32:
+        case TT_I64:
+            readZigzag();
+            return;
+        case TT_DOUBLE:
+            if (end - p < 8)
+                throw AnnotatedException(400, "Truncated Parquet metadata");
+            p += 8;
+            return;
+        case TT_BINARY:
+            readBinary();
+            return;
+        case TT_LIST:
+        case TT_SET: {
+            int elemType;
+            size_t n = readListHeader(elemType);
+            for (size_t i = 0;  i < n;  ++i)
+                skip(elemType);
+            return;
+        }
+        case TT_MAP: {
+            size_t n = readUnsignedVarint();
+            if (n > 0) {
+                uint8_t kv = readByte();
+                for (size_t i = 0;  i < n;  ++i) {
+                    skip(kv >> 4);
+                    skip(kv & 0xf);
+                }
+            }
+            return;
+        }
+        case TT_STRUCT: {
+            int16_t fieldId = 0;
+            int fieldType;
+            while (readFieldHeader(fieldId, fieldType))
+                skip(fieldType);
+            return;
+        }
+        default:
+            throw AnnotatedException(400, "Unknown Thrift type in Parquet "
+                                     "metadata: " + to_string(type));
+        }
+    }
+};
+
+
+/*****************************************************************************/
+/* PARQUET METADATA                                                          */
+/*****************************************************************************/
+
+// Physical types
+enum PqType {
+    PQ_BOOLEAN = 0,
+    PQ_INT32 = 1,
+    PQ_INT64 = 2,
+    PQ_INT96 = 3,
+    PQ_FLOAT = 4,
+    PQ_DOUBLE = 5,
+    PQ_BYTE_ARRAY = 6,
+    PQ_FIXED_LEN_BYTE_ARRAY = 7
+};
+
+// Converted (logical) types the importer understands
+enum PqConvertedType {
+    PQ_CT_UTF8 = 0,
+    PQ_CT_DATE = 6,
+    PQ_CT_TIMESTAMP_MILLIS = 9,
+    PQ_CT_TIMESTAMP_MICROS = 10
+};
+
+// Encodings
+enum PqEncoding {
+    PQ_ENC_PLAIN = 0,
+    PQ_ENC_PLAIN_DICTIONARY = 2,
+    PQ_ENC_RLE = 3,
+    PQ_ENC_RLE_DICTIONARY = 8
+};
+
+// Page types
+enum PqPageType {
+    PQ_PAGE_DATA = 0,
+    PQ_PAGE_DICTIONARY = 2,
+    PQ_PAGE_DATA_V2 = 3
+};
+
+struct PqStatistics {
+    bool hasMin = false;
+    bool hasMax = false;
+    std::string minValue;
+    std::string maxValue;
+};
+
+struct PqColumnChunk {
+    int type = -1;
+    std::vector<std::string> pathInSchema;
+    int codec = 0;
+    int64_t numValues = 0;
+    int64_t dataPageOffset = -1;
+    int64_t dictionaryPageOffset = -1;
+    int64_t totalCompressedSize = 0;
+    PqStatistics stats;
+};
+
+struct PqRowGroup {
+    std::vector<PqColumnChunk> columns;
+    int64_t numRows = 0;
+};
+
+struct PqSchemaElement {
+    int type = -1;
+    int typeLength = 0;
+    int repetitionType = 0;  // 0 required, 1 optional, 2 repeated
+    std::string name;
+    int numChildren = 0;
+    int convertedType = -1;
+};
+
+struct PqFileMetaData {
+    std::vector<PqSchemaElement> schema;
+    int64_t numRows = 0;
+    std::vector<PqRowGroup> rowGroups;
+};
+
+PqStatistics readStatistics(ThriftReader & tr)
+{
+    PqStatistics result;
+    int16_t fieldId = 0;
+    int type;
+    while (tr.readFieldHeader(fieldId, type)) {
+        switch (fieldId) {
+        case 1:  // max (deprecated, used when max_value is absent)
+            if (!result.hasMax) {
+                result.maxValue = tr.readBinary();
+                result.hasMax = true;
+            }
+            else tr.skip(type);
+            break;
+        case 2:  // min (deprecated)
+            if (!result.hasMin) {
+                result.minValue = tr.readBinary();
+                result.hasMin = true;
+            }
+            else tr.skip(type);
+            break;
+        case 5:  // max_value
+            result.maxValue = tr.readBinary();
+            result.hasMax = true;
+            break;
+        case 6:  // min_value
+            result.minValue = tr.readBinary();
+            result.hasMin = true;
+            break;
+        default:
+            tr.skip(type);
+        }
+    }
+    return result;
+}
+
+PqColumnChunk readColumnMetaData(ThriftReader & tr)
+{
+    PqColumnChunk result;
+    int16_t fieldId = 0;
+    int type;
+    while (tr.readFieldHeader(fieldId, type)) {
+        switch (fieldId) {
+        case 1:
+            result.type = tr.readZigzag();
+            break;
+        case 3: {
+            int elemType;
+            size_t n = tr.readListHeader(elemType);
+            for (size_t i = 0;  i < n;  ++i)
+                result.pathInSchema.emplace_back(tr.readBinary());
+            break;
+        }
+        case 4:
+            result.codec = tr.readZigzag();
+            break;
+        case 5:
+            result.numValues = tr.readZigzag();
+            break;
+        case 7:
+            result.totalCompressedSize = tr.readZigzag();
+            break;
+        case 9:
+            result.dataPageOffset = tr.readZigzag();
+            break;
+        case 11:
+            result.dictionaryPageOffset = tr.readZigzag();
+            break;
+        case 12:
+            result.stats = readStatistics(tr);
+            break;
+        default:
+            tr.skip(type);
+        }
+    }
+    return result;
+}
+
+PqColumnChunk readColumnChunk(ThriftReader & tr)
+{
+    PqColumnChunk result;
+    int16_t fieldId = 0;
+    int type;
+    while (tr.readFieldHeader(fieldId, type)) {
+        switch (fieldId) {
+        case 1:
+            if (!tr.readBinary().empty())
+                throw AnnotatedException(400, "Parquet files with external "
+                                         "column data are not supported");
+            break;
+        case 3:
+            result = readColumnMetaData(tr);
+            break;
+        default:
+            tr.skip(type);
+        }
+    }
+    return result;
+}
+
+PqRowGroup readRowGroup(ThriftReader & tr)
+{
+    PqRowGroup result;
+    int16_t fieldId = 0;
+    int type;
+    while (tr.readFieldHeader(fieldId, type)) {
+        switch (fieldId) {
+        case 1: {
+            int elemType;
+            size_t n = tr.readListHeader(elemType);
+            for (size_t i = 0;  i < n;  ++i)
+                result.columns.emplace_back(readColumnChunk(tr));
+            break;
+        }
+        case 3:
+            result.numRows = tr.readZigzag();
+            break;
+        default:
+            tr.skip(type);
+        }
+    }
+    return result;
+}
+
+PqSchemaElement readSchemaElement(ThriftReader & tr)
+{
+    PqSchemaElement result;
+    int16_t fieldId = 0;
+    int type;
+    while (tr.readFieldHeader(fieldId, type)) {
+        switch (fieldId) {
+        case 1:
+            result.type = tr.readZigzag();
+            break;
+        case 2:
+            result.typeLength = tr.readZigzag();
+            break;
+        case 3:
+            result.repetitionType = tr.readZigzag();
+            break;
+        case 4:
+            result.name = tr.readBinary();
+            break;
+        case 5:
+            result.numChildren = tr.readZigzag();
+            break;
+        case 6:
+            result.convertedType = tr.readZigzag();
+            break;
+        default:
+            tr.skip(type);
+        }
+    }
+    return result;
+}
+
+PqFileMetaData readFileMetaData(ThriftReader & tr)
+{
+    PqFileMetaData result;
+    int16_t fieldId = 0;
+    int type;
+    while (tr.readFieldHeader(fieldId, type)) {
+        switch (fieldId) {
+        case 2: {
+            int elemType;
+            size_t n = tr.readListHeader(elemType);
+            for (size_t i = 0;  i < n;  ++i)
+                result.schema.emplace_back(readSchemaElement(tr));
+            break;
+        }
+        case 3:
+            result.numRows = tr.readZigzag();
+            break;
+        case 4: {
+            int elemType;
+            size_t n = tr.readListHeader(elemType);
+            for (size_t i = 0;  i < n;  ++i)
+                result.rowGroups.emplace_back(readRowGroup(tr));
+            break;
+        }
+        default:
+            tr.skip(type);
+        }
+    }
+    return result;
+}
+
+struct PqPageHeader {
+    int type = -1;
+    int32_t uncompressedPageSize = 0;
+    int32_t compressedPageSize = 0;
+
+    // Data page (v1) / dictionary page
+    int32_t numValues = 0;
+    int encoding = -1;
+
+    // Data page v2
+    int32_t numNulls = 0;
+    int32_t defLevelsByteLength = 0;
+    int32_t repLevelsByteLength = 0;
+    bool isCompressed = true;
+};
+
+PqPageHeader readPageHeader(ThriftReader & tr)
+{
+    PqPageHeader result;
+    int16_t fieldId = 0;
+    int type;
+    while (tr.readFieldHeader(fieldId, type)) {
+        switch (fieldId) {
+        case 1:
+            result.type = tr.readZigzag();
+            break;
+        case 2:
+            result.uncompressedPageSize = tr.readZigzag();
+            break;
+        case 3:
+            result.compressedPageSize = tr.readZigzag();
+            break;
+        case 5:    // DataPageHeader
+        case 7: {  // DictionaryPageHeader
+            int16_t subId = 0;
+            int subType;
+            while (tr.readFieldHeader(subId, subType)) {
+                switch (subId) {
+                case 1:
+                    result.numValues = tr.readZigzag();
+                    break;
+                case 2:
+                    result.encoding = tr.readZigzag();
+                    break;
+                default:
+                    tr.skip(subType);
+                }
+            }
+            break;
+        }
+        case 8: {  // DataPageHeaderV2
+            int16_t subId = 0;
+            int subType;
+            while (tr.readFieldHeader(subId, subType)) {
+                switch (subId) {
+                case 1:
+                    result.numValues = tr.readZigzag();
+                    break;
+                case 2:
+                    result.numNulls = tr.readZigzag();
+                    break;
+                case 4:
+                    result.encoding = tr.readZigzag();
+                    break;
+                case 5:
+                    result.defLevelsByteLength = tr.readZigzag();
+                    break;
+                case 6:
+                    result.repLevelsByteLength = tr.readZigzag();
+                    break;
+                case 7:
+                    result.isCompressed = (subType == TT_TRUE);
+                    break;
+                default:
+                    tr.skip(subType);
+                }
+            }
+            break;
+        }
+        default:
+            tr.skip(type);
+        }
+    }
+    return result;
+}
+
+
+/*****************************************************************************/
+/* PAGE DECODING                                                             */
+/*****************************************************************************/
+
+std::string decompressPage(const char * data, size_t len,
+                           int codec, size_t uncompressedSize)
+{
+    const char * name;
+    switch (codec) {
+    case 1:  name = "snappy";  break;
+    case 2:  name = "gzip";    break;
+    case 6:  name = "zstd";    break;
+    default:
+        throw AnnotatedException(400, "Unsupported Parquet compression codec "
+                                 + to_string(codec) + "; supported codecs are "
+                                 "uncompressed, snappy, gzip and zstd");
+    }
+
+    std::unique_ptr<Decompressor> decompressor(Decompressor::create(name));
+    ExcAssert(decompressor);
+
+    std::string result;
+    result.reserve(uncompressedSize);
+    auto onData = [&] (const char * data, size_t len) -> size_t
+        {
+            result.append(data, len);
+            return len;
+        };
+    decompressor->decompress(data, len, onData);
+    decompressor->finish(onData);
+    return result;
+}
+
+/** Decode count values from the RLE / bit-packed hybrid encoding used for
+    definition levels and dictionary indices. */
+void decodeRleBitPacked(const uint8_t * p, const uint8_t * end,
+                        int bitWidth, size_t count,
+                        std::vector<uint32_t> & out)
+{
+    out.clear();
+    out.reserve(count);
+
+    // The width comes from the file (dictionary pages carry it in their
+    // first data byte); wider than 32 can't be a valid level or index
+    // and would make the shifts below undefined
+    if (bitWidth < 0 || bitWidth > 32)
+        throw AnnotatedException(400, "Invalid Parquet level bit width "
+                                 + to_string(bitWidth));
+
+    int byteWidth = (bitWidth + 7) / 8;
+
+    while (out.size() < count) {
+        if (p >= end)
+            throw AnnotatedException(400, "Truncated Parquet level run");
+        uint64_t header = 0;
+        int shift = 0;
+        for (;;) {
+            if (p >= end)
+                throw AnnotatedException(400, "Truncated Parquet level run");
+            uint8_t b = *p++;
+            header |= uint64_t(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                break;
+            shift += 7;
+            if (shift > 63)
+                throw AnnotatedException(400, "Invalid varint in Parquet "
+                                         "level run");
+        }
+
+        if (header & 1) {
+            // Bit-packed run of (header >> 1) groups of 8 values
+            size_t numGroups = header >> 1;
+
+            // Checked multiply: a crafted group count must not wrap the
+            // byte count and slip past the truncation test below
+            if (bitWidth > 0
+                && numGroups > size_t(end - p) / size_t(bitWidth))
+                throw AnnotatedException(400, "Truncated Parquet level run");
+            size_t numBytes = numGroups * size_t(bitWidth);
+
+            // Cap the value count at what is still needed, so a huge
+            // group count can't overflow it either
+            size_t numVals = count - out.size();
+            if (numGroups < (numVals + 7) / 8)
+                numVals = numGroups * 8;
+            uint64_t bitPos = 0;
+            for (size_t i = 0;  i < numVals && out.size() < count;  ++i) {
+                uint32_t v = 0;
+                for (int b = 0;  b < bitWidth;  ++b, ++bitPos)
+                    v |= uint32_t((p[bitPos >> 3] >> (bitPos & 7)) & 1) << b;
+                out.push_back(v);
+            }
+            p += numBytes;
+        }
+        else {
+            // RLE run: one value repeated (header >> 1) times
+            size_t runLength = header >> 1;
+            if (size_t(end - p) < size_t(byteWidth))
+                throw AnnotatedException(400, "Truncated Parquet level run");
+            uint32_t v = 0;
+            for (int b = 0;  b < byteWidth;  ++b)
+                v |= uint32_t(p[b]) << (8 * b);
+            p += byteWidth;
+            for (size_t i = 0;  i < runLength && out.size() < count;  ++i)
+                out.push_back(v);
+        }
+    }
+}
+
+Date dateFromJulianNanos(const uint8_t * p)
+{
+    uint64_t nanos = 0;
+    for (int i = 0;  i < 8;  ++i)
+        nanos |= uint64_t(p[i]) << (8 * i);
+    uint32_t julianDay
+        = p[8] | (p[9] << 8) | (p[10] << 16) | (uint32_t(p[11]) << 24);
+    // 2440588 is the julian day of the unix epoch
+    double seconds = (int64_t(julianDay) - 2440588) * 86400.0 + nanos * 1e-9;
+    return Date::fromSecondsSinceEpoch(seconds);
+}
+
+/** Reads PLAIN-encoded values one at a time, converting to CellValue. */
+struct PlainDecoder {
+    PlainDecoder(const uint8_t * p, const uint8_t * end,
+                 const PqSchemaElement & elem)
+        : p(p), end(end), elem(elem), bitPos(0)
+    {
+    }
+
+    const uint8_t * p;
+    const uint8_t * end;
+    const PqSchemaElement & elem;
+    uint64_t bitPos;  ///< for bit-packed booleans
+
+    void need(size_t n) const
+    {
+        if (size_t(end - p) < n)
+            throw AnnotatedException(400, "Truncated Parquet data page");
+    }
+
+    int32_t readInt32()
+    {
+        need(4);
+        int32_t v = p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
+        p += 4;
+        return v;
+    }
+
+    int64_t readInt64()
+    {
+        need(8);
+        uint64_t v = 0;
+        for (int i = 0;  i < 8;  ++i)
+            v |= uint64_t(p[i]) << (8 * i);
+        p += 8;
+        return v;
+    }
+
+    CellValue next()
+    {
+        switch (elem.type) {
+        case PQ_BOOLEAN: {
+            need((bitPos >> 3) + 1);
+            bool v = (p[bitPos >> 3] >> (bitPos & 7)) & 1;
+            ++bitPos;
+            return CellValue(v);
+        }
+        case PQ_INT32: {
+            int32_t v = readInt32();
+            if (elem.convertedType == PQ_CT_DATE)
+                return CellValue(Date::fromSecondsSinceEpoch(v * 86400.0));
+            return CellValue(v);
+        }
+        case PQ_INT64: {
+            int64_t v = readInt64();
+            if (elem.convertedType == PQ_CT_TIMESTAMP_MILLIS)
+                return CellValue(Date::fromSecondsSinceEpoch(v / 1000.0));
+            if (elem.convertedType == PQ_CT_TIMESTAMP_MICROS)
+                return CellValue(Date::fromSecondsSinceEpoch(v / 1000000.0));
+            return CellValue(v);
+        }
+        case PQ_INT96: {
+            need(12);
+            Date d = dateFromJulianNanos(p);
+            p += 12;
+            return CellValue(d);
+        }
+        case PQ_FLOAT: {
+            need(4);
+            float v;
+            std::memcpy(&v, p, 4);
+            p += 4;
+            return CellValue(double(v));
+        }
+        case PQ_DOUBLE: {
+            need(8);
+            double v;
+            std::memcpy(&v, p, 8);
+            p += 8;
+            return CellValue(v);
+        }
+        case PQ_BYTE_ARRAY: {
+            need(4);
+            uint32_t len = readInt32();
+            need(len);
+            const char * data = (const char *)p;
+            p += len;
+            if (elem.convertedType == PQ_CT_UTF8)
+                return CellValue(Utf8String(data, size_t(len)));
+            return CellValue::blob(data, len);
+        }
+        case PQ_FIXED_LEN_BYTE_ARRAY: {
+            need(elem.typeLength);
+            const char * data = (const char *)p;
+            p += elem.typeLength;
+            return CellValue::blob(data, elem.typeLength);
+        }
+        default:
+            throw AnnotatedException(400, "Unsupported Parquet physical type "
+                                     + to_string(elem.type));
+        }
+    }
+};
+
+/** Decode a single plain-encoded statistics value (min or max) for
+    pruning.  Statistics store the bare value, without the length prefix
+    byte arrays carry in data pages. */
+CellValue decodeStatValue(const std::string & raw, const PqSchemaElement & elem)
+{
+    if (elem.type == PQ_BYTE_ARRAY) {
+        if (elem.convertedType == PQ_CT_UTF8)
+            return CellValue(Utf8String(raw));
+        return CellValue::blob(raw.data(), raw.size());
+    }
+    PlainDecoder decoder((const uint8_t *)raw.data(),
+                         (const uint8_t *)raw.data() + raw.size(), elem);
+    return decoder.next();
+}
+
+/** Decode one column chunk of a row group into one CellValue per row,
+    with nulls as empty CellValues. */
+std::vector<CellValue>
+decodeColumnChunk(const FrozenMemoryRegion & file,
+                  const PqSchemaElement & elem,
+                  const PqColumnChunk & chunk,
+                  int64_t numRows)
+{
+    std::vector<CellValue> result;
+    result.reserve(numRows);
+
+    bool optional = (elem.repetitionType == 1);
+
+    int64_t offset = chunk.dataPageOffset;
+    if (chunk.dictionaryPageOffset > 0
+        && chunk.dictionaryPageOffset < offset)
+        offset = chunk.dictionaryPageOffset;
+
+    std::vector<CellValue> dictionary;
+    std::vector<uint32_t> defLevels;
+    std::vector<uint32_t> indices;
+
+    int64_t valuesDone = 0;
+
+    while (valuesDone < chunk.numValues) {
+        if (offset < 0 || size_t(offset) >= file.length())
+            throw AnnotatedException(400, "Parquet page offset out of range");
+
+        ThriftReader tr((const uint8_t *)file.data() + offset,
+                        (const uint8_t *)file.data() + file.length());
+        PqPageHeader header = readPageHeader(tr);
+
+        const char * pageData = (const char *)tr.p;
+        if (size_t(pageData - file.data()) + header.compressedPageSize
+            > file.length())
+            throw AnnotatedException(400, "Truncated Parquet page");
+        offset = (pageData - file.data()) + header.compressedPageSize;
+
+        if (header.type == PQ_PAGE_DICTIONARY) {
+            std::string buffer;
+            const char * data = pageData;
+            size_t len = header.compressedPageSize;
+            if (chunk.codec != 0) {
+                buffer = decompressPage(pageData, len, chunk.codec,
+                                        header.uncompressedPageSize);
+                data = buffer.data();
+                len = buffer.size();
+            }
+            PlainDecoder decoder((const uint8_t *)data,
+                                 (const uint8_t *)data + len, elem);
+            dictionary.clear();
+            dictionary.reserve(header.numValues);
+            for (int32_t i = 0;  i < header.numValues;  ++i)
+                dictionary.emplace_back(decoder.next());
+            continue;
+        }
+
+        const uint8_t * values;
+        const uint8_t * valuesEnd;
+        size_t numNonNull;
+        std::string buffer;
+
+        if (header.type == PQ_PAGE_DATA) {
+            const char * data = pageData;
+            size_t len = header.compressedPageSize;
+            if (chunk.codec != 0) {
+                buffer = decompressPage(pageData, len, chunk.codec,
+                                        header.uncompressedPageSize);
+                data = buffer.data();
+                len = buffer.size();
+            }
+
+            const uint8_t * p = (const uint8_t *)data;
+            const uint8_t * end = p + len;
+
+            if (optional) {
+                // Definition levels: 4 byte length prefix, then the
+                // RLE / bit-packed hybrid at bit width 1
+                if (end - p < 4)
+                    throw AnnotatedException(400, "Truncated Parquet page");
+                uint32_t levelLen
+                    = p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
+                p += 4;
+                if (size_t(end - p) < levelLen)
+                    throw AnnotatedException(400, "Truncated Parquet page");
+                decodeRleBitPacked(p, p + levelLen, 1, header.numValues,
+                                   defLevels);
+                p += levelLen;
+            }
+            else {
+                defLevels.assign(header.numValues, 1);
+            }
+
+            numNonNull = 0;
+            for (auto l: defLevels)
+                numNonNull += (l != 0);
+
+            values = p;
+            valuesEnd = end;
+        }
+        else if (header.type == PQ_PAGE_DATA_V2) {
+            // Levels are stored first and never compressed; only the
+            // values section is.
+            if (header.repLevelsByteLength > 0)
+                throw AnnotatedException(400, "Nested (repeated) Parquet "
+                                         "columns are not supported");
+
+            // The level lengths come from the file; bound them against
+            // both page sizes before using them to partition the page
+            if (header.repLevelsByteLength < 0
+                || header.defLevelsByteLength < 0
+                || int64_t(header.repLevelsByteLength)
+                   + header.defLevelsByteLength > header.compressedPageSize
+                || int64_t(header.repLevelsByteLength)
+                   + header.defLevelsByteLength > header.uncompressedPageSize)
+                throw AnnotatedException(400, "Truncated Parquet page");
+
+            const uint8_t * p = (const uint8_t *)pageData;
+            size_t levelBytes
+                = size_t(header.repLevelsByteLength)
+                + size_t(header.defLevelsByteLength);
+
+            if (optional && header.defLevelsByteLength > 0) {
+                // No length prefix in v2
+                decodeRleBitPacked(p + header.repLevelsByteLength,
+                                   p + levelBytes, 1, header.numValues,
+                                   defLevels);
+            }
+            else {
+                defLevels.assign(header.numValues, 1);
+            }
+
+            numNonNull = header.numValues - header.numNulls;
+
+            const char * data = pageData + levelBytes;
+            size_t len = header.compressedPageSize - levelBytes;
+            if (chunk.codec != 0 && header.isCompressed) {
+                buffer = decompressPage(data, len, chunk.codec,
+                                        header.uncompressedPageSize
+                                        - levelBytes);
+                data = buffer.data();
+                len = buffer.size();
+            }
+            values = (const uint8_t *)data;
+            valuesEnd = values + len;
+        }
+        else {
+            // Index or unknown page; skip it
+            continue;
+        }
+
+        // Decode the values for the non-null slots
+        std::vector<CellValue> decoded;
+        decoded.reserve(numNonNull);
+
+        if (header.encoding == PQ_ENC_PLAIN) {
+            PlainDecoder decoder(values, valuesEnd, elem);
+            for (size_t i = 0;  i < numNonNull;  ++i)
+                decoded.emplace_back(decoder.next());
+        }
+        else if (header.encoding == PQ_ENC_PLAIN_DICTIONARY
+                 || header.encoding == PQ_ENC_RLE_DICTIONARY) {
+            if (dictionary.empty() && numNonNull > 0)
+                throw AnnotatedException(400, "Parquet dictionary-encoded "
+                                         "page without a dictionary");
+            if (values >= valuesEnd)
+                throw AnnotatedException(400, "Truncated Parquet page");
+            int bitWidth = *values++;
+            decodeRleBitPacked(values, valuesEnd, bitWidth, numNonNull,
+                               indices);
+            for (auto ix: indices) {
+                if (ix >= dictionary.size())
+                    throw AnnotatedException(400, "Parquet dictionary index "
+                                             "out of range");
+                decoded.emplace_back(dictionary[ix]);
+            }
+        }
+        else {
+            throw AnnotatedException(400, "Unsupported Parquet encoding "
+                                     + to_string(header.encoding)
+                                     + "; supported encodings are plain "
+                                     "and dictionary");
+        }
+
+        // Interleave values and nulls following the definition levels
+        size_t valueIn = 0;
+        for (auto l: defLevels) {
+            if (l != 0)
+                result.emplace_back(std::move(decoded.at(valueIn++)));
+            else result.emplace_back();
+        }
+
+        valuesDone += header.numValues;
+    }
+
+    if ((int64_t)result.size() != numRows)
+        throw AnnotatedException(400, "Parquet column chunk decoded "
+                                 + to_string(result.size()) + " rows; "
+                                 "expected " + to_string(numRows));
+
+    return result;
+}
+
+
+/*****************************************************************************/
+/* ROW GROUP PRUNING                                                         */
+/*****************************************************************************/
+
+/* The same idea as the zone-map chunk pruning in the tabular dataset:
+   extract column-versus-constant comparisons from the where clause and
+   test them against the row-group statistics in the footer, so row
+   groups that can't contain a matching row are never read or decoded.
+*/
+
+struct PruneBound {
+    ColumnPath column;
+    std::string op;  // <, <=, >, >=, =
+    CellValue constant;
+};
+
+void extractPruneBounds(const SqlExpression & where,
+                        std::vector<PruneBound> & out)
+{
+    const auto * boolean
+        = dynamic_cast<const BooleanOperatorExpression *>(&where);
+    if (boolean && boolean->op == "AND") {
+        extractPruneBounds(*boolean->lhs, out);
+        extractPruneBounds(*boolean->rhs, out);
+        return;
+    }
+
+    const auto * comparison
+        = dynamic_cast<const ComparisonExpression *>(&where);
+    if (!comparison)
+        return;
+
+    std::string op = comparison->op;
+    auto column = dynamic_cast<const ReadColumnExpression *>
+        (comparison->lhs.get());
+    auto constant = dynamic_cast<const ConstantExpression *>
+        (comparison->rhs.get());
+    if (!column || !constant) {
+        column = dynamic_cast<const ReadColumnExpression *>
+            (comparison->rhs.get());
+        constant = dynamic_cast<const ConstantExpression *>
+            (comparison->lhs.get());
+        // Constant on the left means the comparison is mirrored
+        if (op == "<") op = ">";
+        else if (op == "<=") op = ">=";
+        else if (op == ">") op = "<";
+        else if (op == ">=") op = "<=";
+    }
+    if (!column || !constant || !constant->constant.isAtom())
+        return;
+    CellValue c = constant->constant.getAtom();
+    if (c.empty())
+        return;
+    if (op != "<" && op != "<=" && op != ">" && op != ">=" && op != "=")
+        return;
+
+    out.emplace_back(PruneBound{column->columnName, op, std::move(c)});
+}
+
+/** Can any row of the given row group match all of the bounds? */
+bool rowGroupCanMatch(const PqRowGroup & rowGroup,
+                      const std::vector<PqSchemaElement> & leaves,
+                      const std::vector<ColumnPath> & columnNames,
+                      const std::vector<PruneBound> & bounds)
+{
+    for (auto & bound: bounds) {
+        for (size_t i = 0;  i < columnNames.size()
+                 && i < rowGroup.columns.size();  ++i) {
+            if (columnNames[i] != bound.column)
+                continue;
+            const PqStatistics & stats = rowGroup.columns[i].stats;
+            if (!stats.hasMin || !stats.hasMax)
+                break;
+
+            CellValue minVal, maxVal;
+            try {
+                minVal = decodeStatValue(stats.minValue, leaves[i]);
+                maxVal = decodeStatValue(stats.maxValue, leaves[i]);
+            } MLDB_CATCH_ALL {
+                break;  // unreadable statistics; don't prune
+            }
+
+            // Only prune when the statistics and the constant order the
+            // same way; comparing across kinds would prune wrongly
+            bool comparable
+                = (minVal.isNumber() && maxVal.isNumber()
+                   && bound.constant.isNumber())
+                || (minVal.isString() && maxVal.isString()
+                    && bound.constant.isString());
+            if (!comparable)
+                break;
+
+            if (bound.op == "<" && !(minVal < bound.constant))
+                return false;
+            if (bound.op == "<=" && !(minVal <= bound.constant))
+                return false;
+            if (bound.op == ">" && !(maxVal > bound.constant))
+                return false;
+            if (bound.op == ">=" && !(maxVal >= bound.constant))
+                return false;
+            if (bound.op == "="
+                && !(minVal <= bound.constant && bound.constant <= maxVal))
+                return false;
+            break;
+        }
+    }
+    return true;
+}
+
+} // file scope
+
+
+/*****************************************************************************/
+/* PARQUET IMPORTER                                                          */
+/*****************************************************************************/
+
+struct ParquetImporterConfig : ProcedureConfig {
+
+    static constexpr const char * name = "import.parquet";
+
+    ParquetImporterConfig()
+        : limit(-1),
+          offset(0),
+          select(SelectExpression::STAR),
+          where(SqlExpression::TRUE),
+          named(SqlExpression::parse("lineNumber()"))
+    {
+        outputDataset.withType("tabular");
+    }
+
+    Url dataFileUrl;
+    PolyConfigT<Dataset> outputDataset;
+
+    int64_t limit;
+    int64_t offset;
+    SelectExpression select;
+    std::shared_ptr<SqlExpression> where;
+    std::shared_ptr<SqlExpression> named;
+};
+
+DECLARE_STRUCTURE_DESCRIPTION(ParquetImporterConfig);
+
+DEFINE_STRUCTURE_DESCRIPTION(ParquetImporterConfig);
+
+ParquetImporterConfigDescription::
+ParquetImporterConfigDescription()
+{
+    addField("dataFileUrl", &ParquetImporterConfig::dataFileUrl,
+             "URL of the Parquet file to load");
+    addField("outputDataset", &ParquetImporterConfig::outputDataset,
+             "Configuration for output dataset",
+             PolyConfigT<Dataset>().withType("tabular"));
+    addField("limit", &ParquetImporterConfig::limit,
+             "Maximum number of rows to process", int64_t(-1));
+    addField("offset", &ParquetImporterConfig::offset,
+             "Skip the first n rows", int64_t(0));
+    addField("select", &ParquetImporterConfig::select,
+             "Which columns to use.",
+             SelectExpression::STAR);
+    addField("where", &ParquetImporterConfig::where,
+             "Which rows to use to create rows.  Column-versus-constant "
+             "comparisons are additionally pushed down onto the row-group "
+             "statistics in the file footer, so row groups that can't "
+             "match are skipped without being read.",
+             SqlExpression::TRUE);
+    addField("named", &ParquetImporterConfig::named,
+             "Row name expression for output dataset. Note that each row "
+             "must have a unique name and that names cannot be objects.",
+             SqlExpression::parse("lineNumber()"));
+
+    addParent<ProcedureConfig>();
+
+    onPostValidate = [] (ParquetImporterConfig * config,
+                         JsonParsingContext & context)
+    {
+        if (config->dataFileUrl.empty()) {
+            throw AnnotatedException(
+                400,
+                "dataFileUrl is a required property and must not be empty");
+        }
+    };
+}
+
+struct ParquetImporter: public Procedure {
+
+    ParquetImporter(MldbEngine * owner,
+                    PolyConfig config_,
+                    const std::function<bool (const Json::Value &)> & onProgress)
+        : Procedure(owner)
+    {
+        config = config_.params.convert<ParquetImporterConfig>();
+    }
+
+    ParquetImporterConfig config;
+
+    /** Get the whole file as a memory region: mapped for local files,
+        slurped through a filter stream otherwise. */
+    static FrozenMemoryRegion
+    getFileRegion(const Url & url, Date & timestamp)
+    {
+        timestamp = tryGetUriObjectInfo(url.toDecodedString()).lastModified;
+
+        if (url.scheme() == "file") {
+            try {
+                return mapFile(url);
+            } MLDB_CATCH_ALL {
+                // Fall through to streaming the contents
+            }
+        }
+
+        filter_istream stream(url.toDecodedString());
+        auto contents = std::make_shared<std::string>
+            (std::istreambuf_iterator<char>(stream),
+             std::istreambuf_iterator<char>());
+        const char * data = contents->data();
+        size_t length = contents->length();
+        return FrozenMemoryRegion(std::move(contents), data, length);
+    }
+
+    virtual RunOutput run(const ProcedureRunConfig & run,
+                          const std::function<bool (const Json::Value &)> & onProgress) const
+    {
+        auto runProcConf = applyRunConfOverProcConf(config, run);
+        Progress progress;
+
+        std::shared_ptr<Step> iterationStep = progress.steps({
+            make_pair("iterating", "rows")
+        });
+
+        std::string filename = runProcConf.dataFileUrl.toDecodedString();
+
+        Date timestamp;
+        FrozenMemoryRegion file
+            = getFileRegion(runProcConf.dataFileUrl, timestamp);
+
+        // Magic at both ends, 4 byte footer length before the trailing one
+        if (file.length() < 12
+            || std::memcmp(file.data(), "PAR1", 4) != 0
+            || std::memcmp(file.data() + file.length() - 4, "PAR1", 4) != 0)
+            throw AnnotatedException(400, "File is not in Parquet format",
+                                     "dataFileUrl", runProcConf.dataFileUrl);
+
+        const uint8_t * tail
+            = (const uint8_t *)file.data() + file.length() - 8;
+        uint32_t footerLength
+            = tail[0] | (tail[1] << 8) | (tail[2] << 16)
+            | (uint32_t(tail[3]) << 24);
+        if (footerLength + 12 > file.length())
+            throw AnnotatedException(400, "Corrupt Parquet footer",
+                                     "dataFileUrl", runProcConf.dataFileUrl);
+
+        ThriftReader tr(tail - footerLength, tail);
+        PqFileMetaData metadata = readFileMetaData(tr);
+
+        if (metadata.schema.empty())
+            throw AnnotatedException(400, "Parquet file has no schema",
+                                     "dataFileUrl", runProcConf.dataFileUrl);
+
+        // Flatten the schema; only flat (non-nested) files are supported
+        std::vector<PqSchemaElement> leaves;
+        std::vector<ColumnPath> columnNames;
+        for (size_t i = 1;  i < metadata.schema.size();  ++i) {
+            const PqSchemaElement & elem = metadata.schema[i];
+            if (elem.numChildren > 0 || elem.repetitionType == 2)
+                throw AnnotatedException(400, "Nested Parquet schemas are "
+                                         "not supported; flatten the file "
+                                         "before importing",
+                                         "column", elem.name);
+            leaves.push_back(elem);
+            columnNames.emplace_back(PathElement(elem.name));
+        }
+
+        // Create the output dataset
+        if (runProcConf.outputDataset.type == "tabular") {
+            if (runProcConf.outputDataset.params == nullptr) {
+                Json::Value params;
+                params["unknownColumns"] = "add";
+                runProcConf.outputDataset.params = params;
+            }
+            else {
+                auto params =
+                    runProcConf.outputDataset.params.as<Json::Value>();
+                if (!params.isMember("unknownColumns")) {
+                    params["unknownColumns"] = "add";
+                    runProcConf.outputDataset.params = params;
+                }
+            }
+        }
+        auto outputDataset = createDataset(engine, runProcConf.outputDataset,
+                                           onProgress, true);
+        if (!outputDataset)
+            throw MLDB::Exception("Unable to obtain output dataset");
+
+        bool useSelect = runProcConf.select != SelectExpression::STAR;
+        bool useWhere = runProcConf.where != SqlExpression::TRUE;
+
+        SqlCsvScope scope(engine, columnNames, timestamp,
+                          Utf8String(filename));
+        auto selectBound = runProcConf.select.bind(scope);
+        auto whereBound = runProcConf.where->bind(scope);
+        auto namedBound = runProcConf.named->bind(scope);
+
+        // Push comparisons down onto the row group statistics
+        std::vector<PruneBound> pruneBounds;
+        if (useWhere)
+            extractPruneBounds(*runProcConf.where, pruneBounds);
+
+        // Work out which row groups we process at all: those within the
+        // offset/limit range whose statistics can satisfy the where
+        int64_t firstRow = runProcConf.offset;
+        int64_t lastRow = runProcConf.limit == -1
+            ? std::numeric_limits<int64_t>::max()
+            : firstRow + runProcConf.limit;
+
+        struct GroupTask {
+            size_t groupIndex;
+            int64_t startRow;  ///< index in the file of the group's first row
+        };
+
+        std::vector<GroupTask> tasks;
+        size_t prunedGroups = 0;
+        int64_t rowNumber = 0;
+        for (size_t i = 0;  i < metadata.rowGroups.size();  ++i) {
+            const PqRowGroup & group = metadata.rowGroups[i];
+            int64_t startRow = rowNumber;
+            rowNumber += group.numRows;
+            if (rowNumber <= firstRow || startRow >= lastRow)
+                continue;
+            if (!pruneBounds.empty()
+                && !rowGroupCanMatch(group, leaves, columnNames, pruneBounds)) {
+                ++prunedGroups;
+                continue;
+            }
+            tasks.emplace_back(GroupTask{i, startRow});
+        }
+
+        auto recorder = outputDataset->getChunkRecorder();
+
+        std::atomic<int64_t> recordedRows(0);
+        std::atomic<bool> keepGoing(true);
+        std::mutex progressMutex;
+
+        auto doGroup = [&] (size_t taskIndex)
+            {
+                if (!keepGoing)
+                    return;
+
+                const GroupTask & task = tasks[taskIndex];
+                const PqRowGroup & group = metadata.rowGroups[task.groupIndex];
+
+                if (group.columns.size() != leaves.size())
+                    throw AnnotatedException(400, "Parquet row group has a "
+                                             "different number of columns "
+                                             "than the schema");
+
+                // Decode each column chunk of the group
+                std::vector<std::vector<CellValue> > columns(leaves.size());
+                for (size_t i = 0;  i < leaves.size();  ++i)
+                    columns[i] = decodeColumnChunk(file, leaves[i],
+                                                   group.columns[i],
+                                                   group.numRows);
+
+                auto chunkRecorder = recorder.newChunk(task.groupIndex);
+
+                std::vector<CellValue> rowValues(leaves.size());
+
+                for (int64_t row = 0;  row < group.numRows && keepGoing;
+                     ++row) {
+                    int64_t globalRow = task.startRow + row;
+                    if (globalRow < firstRow || globalRow >= lastRow)
+                        continue;
+
+                    for (size_t i = 0;  i < leaves.size();  ++i)
+                        rowValues[i] = columns[i][row];
+
+                    auto rowScope = SqlCsvScope::bindRow(rowValues.data(),
+                                                         timestamp,
+                                                         globalRow + 1,
+                                                         0 /* lineOffset */);
+
+                    ExpressionValue storage;
+                    if (useWhere
+                        && !whereBound(rowScope, storage, GET_ALL).isTrue())
+                        continue;
+
+                    RowPath rowName = namedBound(rowScope, storage, GET_ALL)
+                        .coerceToPath();
+
+                    if (useSelect) {
+                        ExpressionValue selected
+                            = selectBound(rowScope, storage, GET_ALL);
+                        chunkRecorder->recordRowExprDestructive
+                            (std::move(rowName), std::move(selected));
+                    }
+                    else {
+                        std::vector<std::tuple<ColumnPath, CellValue, Date> >
+                            vals;
+                        vals.reserve(leaves.size());
+                        for (size_t i = 0;  i < leaves.size();  ++i) {
+                            if (!rowValues[i].empty())
+                                vals.emplace_back(columnNames[i],
+                                                  std::move(rowValues[i]),
+                                                  timestamp);
+                        }
+                        chunkRecorder->recordRowDestructive(std::move(rowName),
+                                                            std::move(vals));
+                    }
+
+                    int64_t numRows = recordedRows.fetch_add(1);
+                    if (numRows % PROGRESS_RATE_LOW == 0) {
+                        lock_guard<mutex> l(progressMutex);
+                        if (numRows > iterationStep->value)
+                            iterationStep->value = numRows;
+                        if (!onProgress(jsonEncode(progress)))
+                            keepGoing = false;
+                    }
+                }
+
+                chunkRecorder->finishedChunk();
+            };
+
+        parallelMap(0, tasks.size(), doGroup);
+
+        if (!keepGoing)
+            throw MLDB::CancellationException
+                ("Procedure import.parquet cancelled");
+
+        recorder.commit();
+
+        Json::Value result;
+        result["rowCount"] = (Json::UInt)recordedRows.load();
+        result["numRowGroups"] = (Json::UInt)metadata.rowGroups.size();
+        result["numRowGroupsPruned"] = (Json::UInt)prunedGroups;
+        return RunOutput(result);
+    }
+
+    virtual Any getStatus() const
+    {
+        return Any();
+    }
+};
+
+static RegisterProcedureType<ParquetImporter, ParquetImporterConfig>
+regParquet(builtinPackage(),
+           "Import a Parquet file into MLDB, reading the columnar format "
+           "natively",
+           "procedures/ParquetImporter.md.html");
+
+
+} // namespace MLDB
@@ -10,6 +10,7 @@ LIBMLDB_TEXTUAL_PLUGIN_SOURCES:= \
 	csv_writer.cc \
 	json_importer.cc \
 	importtext_procedure.cc \
+	parquet_importer.cc \
 	sql_csv_scope.cc \
 	tokensplit.cc \
 
@@ -36,6 +37,7 @@ LIBMLDB_TEXTUAL_PLUGIN_LINK:= \
 	mldb_builtin_base \
 	mldb_builtin \
 	sql_types \
+	block \
 
 $(eval $(call library,mldb_textual_plugin,$(LIBMLDB_TEXTUAL_PLUGIN_SOURCES),$(LIBMLDB_TEXTUAL_PLUGIN_LINK)))
 
@@ -28,6 +28,8 @@ struct AsioPeerConnection: public PeerConnection {
 
     virtual void shutdown();
     virtual void send(std::string && data);
+    virtual void sendBulk(std::string && header,
+                          std::vector<FrozenMemoryRegion> && regions);
 
     virtual void startReading(std::function<bool (std::string && data)> onRecv);
     virtual void stopReading();
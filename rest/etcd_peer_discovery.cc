@@ -32,7 +32,8 @@ Logging::Category logEtcd("etcd", false /* enabled by default */);
 EtcdPeerDiscovery::
 EtcdPeerDiscovery(RestEntity * parent, const std::string & etcdUri,
                   const std::string & etcdPath)
-    : PeerDiscovery(parent), etcd(etcdUri, etcdPath), shutdown_(false)
+    : PeerDiscovery(parent), etcd(etcdUri, etcdPath), generation(0),
+      shutdown_(false)
 {
 }
 
@@ -130,8 +131,11 @@ void
 EtcdPeerDiscovery::
 runDiscoveryThread()
 {
-    // Every now and again, scan to see what new things have the behaviours
-    // that we're after.
+    // Do a full synchronization once at startup and after etcd loses our
+    // watch index, then follow the etcd watch stream incrementally.  The
+    // cached peer set is only modified from events or successful full
+    // listings; etcd outages leave it untouched, so peer connections
+    // survive an etcd flap.
     //etcd.proxy.debug = true;
 
     int64_t lastKnownIndex = 0;
@@ -141,15 +145,19 @@ runDiscoveryThread()
     string localPeerName = ourInfo.peerName;
     string fromPeersAddress = ourInfo.uri;
 
-    while (!shutdown_) {
+    /// Exponential backoff for etcd outages
+    double backoffSeconds = 0.0;
+    Date nextAttempt = Date::now();
+    bool needFullSync = true;
 
-        //cerr << "discovery loop starting; lastKnownIndex = " << lastKnownIndex
-        //     << endl;
-        // Wait for either a watch event or for one second to elapse.  We don't actually
-        // take the output of the watch; we just use it to know when to wake up.
+    auto backOff = [&] ()
+        {
+            backoffSeconds = backoffSeconds == 0.0
+                ? 0.5 : std::min(backoffSeconds * 2, 30.0);
+            nextAttempt = Date::now().plusSeconds(backoffSeconds);
+        };
 
-        //cerr << "lastKnownIndex = " << lastKnownIndex
-        //     << " res = " << jsonEncode(res) << endl;
+    while (!shutdown_) {
 
         // 1.  Update our node on etcd, giving ourselves another 5 seconds
         //     We simply publish the tcp address and port of our zeromq
@@ -208,138 +216,190 @@ runDiscoveryThread()
             }
             lastRefreshed = Date::now();
         }
-        
-        // 1.  Get a list of everything that is running
-        // Go to the configuration service
+
+        // 2.  If we're backing off after an etcd error, wait it out in
+        //     small slices so keepalive refreshes and shutdown stay
+        //     responsive.  The cached peer set keeps being served.
+        if (Date::now() < nextAttempt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+
+        // 3.  Resynchronize fully when needed (startup, or after losing
+        //     our place in the etcd event stream).
+        if (needFullSync) {
+            try {
+                syncAllPeers(lastKnownIndex);
+                needFullSync = false;
+                backoffSeconds = 0.0;
+            } catch (const std::exception & exc) {
+                cerr << "error scanning peers: " << exc.what() << endl;
+                errors.trigger("error scanning peers", std::current_exception());
+                backOff();
+            }
+            continue;
+        }
+
+        // 4.  Otherwise follow the watch stream incrementally.  We wait
+        //     at most until the next keepalive refresh is due.
+        double secondsToWait
+            = 1.0 - Date::now().secondsSince(lastRefreshed);
+        if (secondsToWait <= 0)
+            continue;
 
         EtcdResponse watchResult;
-        if (lastKnownIndex != 0) {
-            double secondsToWait
-                = 1.0 - Date::now().secondsSince(lastRefreshed);
-            if (secondsToWait > 0) { 
-                try {
-                    //cerr << "watching for " << secondsToWait << " seconds"
-                    //     << endl;
-                    //Date beforeWatch = Date::now();
-                    watchResult
-                        = etcd.watch("peers/" + serviceType, true,
+        try {
+            watchResult = etcd.watch("peers/" + serviceType, true,
                                      secondsToWait,
                                      lastKnownIndex + 1);
-                    //Date afterWatch = Date::now();
-
-                    //cerr << "watch for " << localPeerName << " returned in "
-                    //     << afterWatch.secondsSince(beforeWatch) << "s: "
-                    //     << jsonEncode(watchResult);
-                
-                    //cerr << "watch elapsed " << afterWatch.secondsSince(beforeWatch)
-                    //<< " seconds; action is " << watchResult.action
-                    //     << endl;
-                } catch (const std::exception & exc) {
-                    cerr << "error watching with etcd: " << exc.what() << endl;
-                    errors.trigger("error watching etcd", std::current_exception());
-                    // TODO: notify of error
-                    continue;
-                }
-            }
+            backoffSeconds = 0.0;
+        } catch (const std::exception & exc) {
+            cerr << "error watching with etcd: " << exc.what() << endl;
+            errors.trigger("error watching etcd", std::current_exception());
+            backOff();
+            needFullSync = true;
+            continue;
         }
 
         if (shutdown_)
             continue;
 
-        // Only do the rest of the watch found that something actually changed.
-        if (lastKnownIndex != 0 && watchResult.action.empty())
+        if (watchResult.errorCode != 0) {
+            // Normally our watch index fell out of etcd's event window.
+            // Etcd itself answered, so resynchronize without backing off.
+            needFullSync = true;
             continue;
+        }
 
-        // 3.  Look for new peers
-        // (peer name, path in config service) pairs, one per peer
-        vector<pair<string, PeerInfo> > endpoints;
+        // Timed out without anything changing
+        if (watchResult.action.empty())
+            continue;
 
-        
         try {
-            auto foundPeers = etcd.listDir("peers/" + serviceType, true);
-
-            //cerr << "foundPeers returned "
-            //     << jsonEncode(foundPeers)
-            //     << endl;
-
-            lastKnownIndex = foundPeers.index;
-
-            for (auto & n: foundPeers.node->nodes) {
-                vector<string> nameComponents = MLDB::split(n.key, '/');
-                //cerr << "nameComponents = " << nameComponents << endl;
-                if (nameComponents.size() < 4) {
-                    cerr << "warning: invalid entry in peers etcd: "
-                         << n.key << endl;
-                    continue;
-                }
-
-                string peerName = nameComponents.back();
-
-                //cerr << "peer " << peerName << endl;
-                string p2pUri;
-                for (auto & c: n.nodes) {
-                    if (c.key.rfind("/p2p") == string::npos)
-                        continue;
-                    p2pUri = c.value;
-                    break;
-                }
+            applyWatchEvent(watchResult, lastKnownIndex);
+        } catch (const std::exception & exc) {
+            cerr << "error applying peer change: " << exc.what() << endl;
+            errors.trigger("error applying peer change",
+                           std::current_exception());
+            needFullSync = true;
+        }
+    }
+}
 
-                if (!p2pUri.empty())
-                    endpoints.push_back(make_pair(peerName, jsonDecodeStr<PeerInfo>(p2pUri)));
-            }
+void
+EtcdPeerDiscovery::
+syncAllPeers(int64_t & lastKnownIndex)
+{
+    auto foundPeers = etcd.listDir("peers/" + ourInfo.serviceType, true);
 
-            //cerr << "foundPeers " << jsonEncode(foundPeers) << endl;
-            //cerr << "endpoints are " << endpoints << endl;
+    if (foundPeers.errorCode != 0 || !foundPeers.node)
+        throw MLDB::Exception("error listing peers directory: "
+                              + foundPeers.message);
 
-            std::set<std::string> peersDone;
+    lastKnownIndex = foundPeers.index;
+    ++generation;
 
-            // For each endpoint, find how to connect to its zeromq socket
-            for (auto & e: endpoints) {
+    for (auto & n: foundPeers.node->nodes) {
+        vector<string> nameComponents = MLDB::split(n.key, '/');
+        if (nameComponents.size() < 4) {
+            cerr << "warning: invalid entry in peers etcd: "
+                 << n.key << endl;
+            continue;
+        }
 
-                string peerName = e.first;
-                const PeerInfo & info = e.second;
-                peersDone.insert(peerName);
+        string peerName = nameComponents.back();
 
-                auto entry = knownPeers.tryGetExistingEntry(peerName);
-                if (entry) {
-                    if (jsonEncode(*entry) == jsonEncode(info))
-                        continue;   // still the same as before
-                    else {
-                        // Info has changed.  We remove the old one
-                        knownPeers.replaceEntry(peerName, std::make_shared<PeerInfo>(info));
-                    }
-                }
-                else {
-                    // New entry
-                    knownPeers.addEntry(peerName, std::make_shared<PeerInfo>(info));
-                }
-            }
+        string p2pUri;
+        for (auto & c: n.nodes) {
+            if (c.key.rfind("/p2p") == string::npos)
+                continue;
+            p2pUri = c.value;
+            break;
+        }
 
-            std::vector<std::string> peersToDelete;
+        if (!p2pUri.empty())
+            updatePeer(peerName, jsonDecodeStr<PeerInfo>(p2pUri));
+    }
 
-            auto onPeer = [&] (std::string peerName, const PeerInfo & peer)
-                {
-                    //cerr << "checking peer " << peerName << endl;
-                    if (peersDone.count(peerName))
-                        return true;
+    // Anything not seen in this generation is no longer published
+    std::vector<std::string> peersToDelete;
 
-                    // Disconnect from the peer
-                    peersToDelete.push_back(peerName);
+    auto onPeer = [&] (std::string peerName, const PeerInfo & peer)
+        {
+            auto it = peerGeneration.find(peerName);
+            if (it == peerGeneration.end() || it->second != generation)
+                peersToDelete.push_back(peerName);
+            return true;
+        };
 
-                    return true;
-                };
+    knownPeers.forEachEntry(onPeer);
 
-            knownPeers.forEachEntry(onPeer);
+    for (auto & p: peersToDelete) {
+        peerGeneration.erase(p);
+        knownPeers.deleteEntry(p);
+    }
+}
 
-            for (auto & p: peersToDelete) {
-                knownPeers.deleteEntry(p);
-            }
-        } catch (const std::exception & exc) {
-            cerr << "error scanning peers: " << exc.what() << endl;
-            errors.trigger("error scanning peers", std::current_exception());
-            continue;
+void
+EtcdPeerDiscovery::
+applyWatchEvent(const EtcdResponse & event, int64_t & lastKnownIndex)
+{
+    if (!event.node)
+        return;
+
+    lastKnownIndex = std::max(lastKnownIndex, event.node->modifiedIndex);
+
+    // Keys look like <base>/peers/<serviceType>/<peerName>[/p2p]
+    vector<string> nameComponents = MLDB::split(event.node->key, '/');
+    if (nameComponents.size() < 4)
+        return;
+
+    if (event.action == "set"
+        || event.action == "create"
+        || event.action == "update"
+        || event.action == "compareAndSwap") {
+        // Only the p2p key carries connection info; the locked key and
+        // directory refreshes don't affect the peer set.
+        if (nameComponents.back() != "p2p")
+            return;
+
+        string peerName = nameComponents[nameComponents.size() - 2];
+        updatePeer(peerName, jsonDecodeStr<PeerInfo>(event.node->value));
+    }
+    else if (event.action == "delete"
+             || event.action == "expire"
+             || event.action == "compareAndDelete") {
+        // A peer is gone when its directory or its p2p key goes away
+        string peerName;
+        if (nameComponents.back() == "p2p")
+            peerName = nameComponents[nameComponents.size() - 2];
+        else if (event.node->dir)
+            peerName = nameComponents.back();
+
+        if (!peerName.empty() && peerGeneration.count(peerName)) {
+            peerGeneration.erase(peerName);
+            knownPeers.deleteEntry(peerName);
         }
     }
 }
 
+void
+EtcdPeerDiscovery::
+updatePeer(const std::string & peerName, const PeerInfo & info)
+{
+    peerGeneration[peerName] = generation;
+
+    auto entry = knownPeers.tryGetExistingEntry(peerName);
+    if (entry) {
+        if (jsonEncode(*entry) == jsonEncode(info))
+            return;   // still the same as before; don't churn the connection
+        // Info has changed.  We remove the old one
+        knownPeers.replaceEntry(peerName, std::make_shared<PeerInfo>(info));
+    }
+    else {
+        // New entry
+        knownPeers.addEntry(peerName, std::make_shared<PeerInfo>(info));
+    }
+}
+
 } // namespace MLDB
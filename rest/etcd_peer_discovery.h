@@ -8,6 +8,7 @@
 
 #include "peer_discovery.h"
 #include "etcd_client.h"
+#include <map>
 
 
 namespace MLDB {
@@ -49,9 +50,33 @@ private:
     void runDiscoveryThread();
     std::unique_ptr<std::thread> discoveryThread;
 
+    /** Bring the cached peer set fully in line with etcd.  Bumps the
+        generation number, and removes any peer that wasn't seen in the
+        new listing.  Throws on etcd errors, leaving the cached set
+        untouched.
+    */
+    void syncAllPeers(int64_t & lastKnownIndex);
+
+    /** Apply a single etcd watch event incrementally to the cached
+        peer set.
+    */
+    void applyWatchEvent(const EtcdResponse & event, int64_t & lastKnownIndex);
+
+    /** Add or update a cached peer entry.  Peers whose published info
+        hasn't changed are left alone so that their connections don't
+        churn.
+    */
+    void updatePeer(const std::string & peerName, const PeerInfo & info);
+
     /** Client to the etcd service used for peer discovery. */
     EtcdClient etcd;
 
+    /// Generation of the last full synchronization with etcd
+    int64_t generation;
+
+    /// Generation at which each known peer was last seen
+    std::map<std::string, int64_t> peerGeneration;
+
     std::atomic<int> shutdown_;
 };
 
@@ -0,0 +1,137 @@
+/* metrics_registry.cc
+   Jeremy Barnes, 30 August 2026
+   Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+   This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+   Always-on counters and latency histograms.
+*/
+
+#include "metrics_registry.h"
+#include <vector>
+
+
+namespace MLDB {
+
+/*****************************************************************************/
+/* LATENCY HISTOGRAM                                                         */
+/*****************************************************************************/
+
+Json::Value
+LatencyHistogram::
+scrape() const
+{
+    std::vector<uint64_t> merged(NUM_BUCKETS, 0);
+    uint64_t count = 0;
+    uint64_t totalMicros = 0;
+
+    auto & cells = const_cast<PerThreadAccumulator<Cells> &>(this->cells);
+    cells.forEach([&] (Cells * c)
+                  {
+                      for (int i = 0;  i < NUM_BUCKETS;  ++i) {
+                          uint64_t n
+                              = c->counts[i].load(std::memory_order_relaxed);
+                          merged[i] += n;
+                          count += n;
+                      }
+                      totalMicros += c->totalMicros
+                          .load(std::memory_order_relaxed);
+                  });
+
+    Json::Value result;
+    result["count"] = (Json::UInt)count;
+
+    if (count == 0)
+        return result;
+
+    result["mean"] = totalMicros / 1000000.0 / count;
+
+    // Walk the merged buckets once, emitting each quantile as its rank
+    // is crossed.  Quantile values are bucket lower bounds, ie within
+    // one sub-bucket (~6%) of the true value.
+    static const std::pair<const char *, double> quantiles[] = {
+        { "p50", 0.5 }, { "p90", 0.9 }, { "p99", 0.99 }, { "p999", 0.999 }
+    };
+
+    int quantile = 0;
+    uint64_t seen = 0;
+    int highest = 0;
+    for (int i = 0;  i < NUM_BUCKETS;  ++i) {
+        if (merged[i] == 0)
+            continue;
+        seen += merged[i];
+        highest = i;
+        while (quantile < 4 && seen >= quantiles[quantile].second * count) {
+            result[quantiles[quantile].first]
+                = bucketLowerBound(i) / 1000000.0;
+            ++quantile;
+        }
+    }
+
+    result["max"] = bucketLowerBound(highest) / 1000000.0;
+
+    return result;
+}
+
+
+/*****************************************************************************/
+/* METRICS REGISTRY                                                          */
+/*****************************************************************************/
+
+MetricsRegistry &
+MetricsRegistry::
+instance()
+{
+    static MetricsRegistry result;
+    return result;
+}
+
+MetricsCounter &
+MetricsRegistry::
+counter(const std::string & name)
+{
+    std::unique_lock<std::mutex> guard(mutex);
+    auto & entry = counters[name];
+    if (!entry)
+        entry = std::make_shared<MetricsCounter>();
+    return *entry;
+}
+
+LatencyHistogram &
+MetricsRegistry::
+histogram(const std::string & name)
+{
+    std::unique_lock<std::mutex> guard(mutex);
+    auto & entry = histograms[name];
+    if (!entry)
+        entry = std::make_shared<LatencyHistogram>();
+    return *entry;
+}
+
+Json::Value
+MetricsRegistry::
+scrape() const
+{
+    // Copy the maps under the lock, then aggregate outside of it so
+    // that scraping never blocks a counter or histogram lookup
+    std::map<std::string, std::shared_ptr<MetricsCounter> > counters;
+    std::map<std::string, std::shared_ptr<LatencyHistogram> > histograms;
+
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        counters = this->counters;
+        histograms = this->histograms;
+    }
+
+    Json::Value result;
+    result["counters"] = Json::Value(Json::objectValue);
+    result["histograms"] = Json::Value(Json::objectValue);
+
+    for (auto & c: counters)
+        result["counters"][c.first] = (Json::UInt)c.second->total();
+    for (auto & h: histograms)
+        result["histograms"][h.first] = h.second->scrape();
+
+    return result;
+}
+
+} // namespace MLDB
@@ -0,0 +1,166 @@
+/* metrics_registry.h                                              -*- C++ -*-
+   Jeremy Barnes, 30 August 2026
+   Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+   This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+   Always-on counters and latency histograms, cheap enough to record on
+   hot paths and aggregated only when scraped.
+*/
+
+#pragma once
+
+#include "mldb/base/per_thread_accumulator.h"
+#include "mldb/arch/bitops.h"
+#include "mldb/ext/jsoncpp/json.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+
+namespace MLDB {
+
+
+/*****************************************************************************/
+/* METRICS COUNTER                                                           */
+/*****************************************************************************/
+
+/** Monotonic counter.  Each thread increments its own cache line; the
+    per-thread values are summed only when the registry is scraped, so
+    incrementing never contends with other threads or with scrapes.
+*/
+
+struct MetricsCounter {
+
+    void add(uint64_t count = 1)
+    {
+        cells.get().value.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    uint64_t total() const
+    {
+        uint64_t result = 0;
+        auto & cells = const_cast<PerThreadAccumulator<Cell> &>(this->cells);
+        cells.forEach([&] (Cell * cell)
+                      {
+                          result += cell->value.load(std::memory_order_relaxed);
+                      });
+        return result;
+    }
+
+private:
+    struct Cell {
+        std::atomic<uint64_t> value = 0;
+    };
+
+    PerThreadAccumulator<Cell> cells;
+};
+
+
+/*****************************************************************************/
+/* LATENCY HISTOGRAM                                                         */
+/*****************************************************************************/
+
+/** HDR-style latency histogram over microsecond values.
+
+    Values are recorded into log-linear buckets (16 linear sub-buckets
+    per power of two, ie about 6% relative error), one array of relaxed
+    atomic counters per thread.  Recording is a couple of bit operations
+    plus one uncontended increment; quantiles are computed from the
+    merged buckets only when scraped.
+*/
+
+struct LatencyHistogram {
+
+    /** Record a latency, in seconds. */
+    void recordSeconds(double seconds)
+    {
+        if (seconds < 0)
+            seconds = 0;
+        record((uint64_t)(seconds * 1000000.0));
+    }
+
+    /** Record a latency, in microseconds. */
+    void record(uint64_t micros)
+    {
+        Cells & c = cells.get();
+        c.counts[bucketFor(micros)].fetch_add(1, std::memory_order_relaxed);
+        c.totalMicros.fetch_add(micros, std::memory_order_relaxed);
+    }
+
+    /** Aggregate the per-thread buckets and render count, mean, max and
+        the p50/p90/p99/p999 quantiles (all times in seconds).
+    */
+    Json::Value scrape() const;
+
+private:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    static int bucketFor(uint64_t micros)
+    {
+        if (micros < SUB_BUCKETS)
+            return micros;
+        int shift = highest_bit(micros) - SUB_BUCKET_BITS;
+        return (shift + 1) * SUB_BUCKETS
+            + ((micros >> shift) & (SUB_BUCKETS - 1));
+    }
+
+    /** Lowest microsecond value falling into the given bucket. */
+    static uint64_t bucketLowerBound(int bucket)
+    {
+        int row = bucket / SUB_BUCKETS;
+        uint64_t sub = bucket % SUB_BUCKETS;
+        if (row == 0)
+            return sub;
+        return (SUB_BUCKETS + sub) << (row - 1);
+    }
+
+    struct Cells {
+        std::atomic<uint64_t> counts[NUM_BUCKETS] = {};
+        std::atomic<uint64_t> totalMicros = 0;
+    };
+
+    PerThreadAccumulator<Cells> cells;
+};
+
+
+/*****************************************************************************/
+/* METRICS REGISTRY                                                          */
+/*****************************************************************************/
+
+/** Process-wide registry of named counters and latency histograms.
+
+    Lookups take a mutex and should be done once per call site (cache
+    the returned reference, typically in a static); the returned objects
+    live for the lifetime of the process and recording into them is
+    lock-free.  The whole registry is rendered to JSON by scrape(),
+    which is what the /v1/metrics endpoint returns.
+*/
+
+struct MetricsRegistry {
+
+    static MetricsRegistry & instance();
+
+    /** Return the counter with the given name, creating it on first
+        use.  The reference stays valid forever.
+    */
+    MetricsCounter & counter(const std::string & name);
+
+    /** Return the latency histogram with the given name, creating it on
+        first use.  The reference stays valid forever.
+    */
+    LatencyHistogram & histogram(const std::string & name);
+
+    /** Aggregate everything that has been recorded so far. */
+    Json::Value scrape() const;
+
+private:
+    mutable std::mutex mutex;
+    std::map<std::string, std::shared_ptr<MetricsCounter> > counters;
+    std::map<std::string, std::shared_ptr<LatencyHistogram> > histograms;
+};
+
+} // namespace MLDB
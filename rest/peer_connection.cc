@@ -40,6 +40,23 @@ stopReading()
     this->onRecv = nullptr;
 }
 
+void
+PeerConnection::
+sendBulk(std::string && header,
+         std::vector<FrozenMemoryRegion> && regions)
+{
+    // Fallback for transports without scatter-gather support: flatten
+    // into a single message
+    std::string data = std::move(header);
+    size_t total = data.size();
+    for (auto & r: regions)
+        total += r.length();
+    data.reserve(total);
+    for (auto & r: regions)
+        data.append(r.data(), r.length());
+    send(std::move(data));
+}
+
 
 /*****************************************************************************/
 /* MIRROR PEER CONNECTION                                                    */
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "mldb/watch/watch.h"
+#include "mldb/block/memory_region.h"
 #include "peer_info.h"
 #include "peer_message.h"
 
@@ -75,6 +76,19 @@ struct PeerConnection {
     // Synchronous send
     virtual void send(std::string && data) = 0;
 
+    /** Synchronous bulk send: transmit the message formed by the header
+        bytes followed by the given regions.  Framing on the wire is
+        identical to send() of the concatenated bytes, so the receiver
+        needs no changes; the point is that gather-capable transports can
+        write mapped dataset pages straight from the page cache without
+        ever concatenating them in user space.
+
+        The base implementation flattens into one string and delegates
+        to send().
+    */
+    virtual void sendBulk(std::string && header,
+                          std::vector<FrozenMemoryRegion> && regions);
+
     // Asynchronous send.  onSend should return false if there is nothing left
     // to send, in which case writing will stop until startWriting is called
     // again.  Calling startWriting with writing already happening is a nop.
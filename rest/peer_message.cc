@@ -69,6 +69,52 @@ encode() const
     return msg;
 }
 
+std::string
+PeerMessage::
+encodeStr() const
+{
+    size_t totalSize
+        = sizeof(MessageHeader)
+        + payload.size() * 4;   // Size headers per chunk
+
+    for (auto & m: payload) {
+        totalSize += m.size();
+    }
+
+    std::string result(totalSize, '\0');
+    char * mem = &result[0];
+
+    MessageHeader header;
+    header.version = 1;
+    header.ts = timeSent;
+    header.id = messageId;
+    header.layer = layer;
+    header.messageType = type;
+    header.deadline = deadline;
+    header.dir = direction;
+    header.numParts = payload.size();
+    header.size = totalSize;
+
+    std::memcpy(mem, &header, sizeof(header));
+
+    // Parts start where decode() reads them: the header's tail padding
+    // is reused for the first part, as in the EncodedMessage layout
+    char * p = mem + sizeof(MessageHeader) - 4;
+
+    for (auto & m: payload) {
+        // 4 bytes of part size
+        uint32_t sz = m.size();
+        std::memcpy(p, &sz, sizeof(sz));
+        p += sizeof(sz);
+
+        // payload of part
+        std::memcpy(p, m.data(), m.size());
+        p += m.size();
+    }
+
+    return result;
+}
+
 PeerMessage
 PeerMessage::
 decode(const std::string & msg)
@@ -29,8 +29,10 @@ enum MessagePriority {
 };
 
 enum MessageDirection {
-    DIR_REQUEST,    ///< Message is a new request
-    DIR_RESPONSE    ///< Message is a response to an existing request
+    DIR_REQUEST,        ///< Message is a new request
+    DIR_RESPONSE,       ///< Message is a response to an existing request
+    DIR_REQUEST_CUMACK  ///< Request needing no individual response; receipt
+                        ///< is confirmed by a cumulative acknowledgement
 };
 
 /** Binary structure that goes on the header of messages send back
@@ -114,6 +116,12 @@ struct PeerMessage {
     std::unique_ptr<EncodedMessage, EncodedMessage::Deleter>
     encode() const;
 
+    /** Encode directly into a string, producing the same bytes as
+        encode() without the intermediate buffer for callers that hand
+        the result to a transport as a std::string.
+    */
+    std::string encodeStr() const;
+
     // Synchronously receive it from the socket
     static PeerMessage recv(boost::asio::ip::tcp::socket & socket);
 
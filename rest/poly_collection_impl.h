@@ -157,6 +157,9 @@ std::shared_ptr<Entity>
 PolyCollection<Entity>::
 getExistingEntity(const Utf8String & key) const
 {
+    // First access to an entity deferred by loadConfigLazily() loads it
+    const_cast<PolyCollection *>(this)->ensureEntryLoaded(key);
+
     return std::static_pointer_cast<Entity>
         (PolyCollectionBase::getExistingEntry(key));
 }
@@ -166,6 +169,13 @@ std::shared_ptr<Entity>
 PolyCollection<Entity>::
 tryGetExistingEntity(const Utf8String & key) const
 {
+    try {
+        const_cast<PolyCollection *>(this)->ensureEntryLoaded(key);
+    } catch (const std::exception & exc) {
+        // Deferred load failed; behave as if the entity doesn't exist
+        return nullptr;
+    }
+
     return std::static_pointer_cast<Entity>
         (PolyCollectionBase::tryGetExistingEntry(key));
 }
@@ -38,7 +38,8 @@ RemotePeer(ServicePeer * owner)
       responsesSent(0),
       currentMessageId(0),
       shutdown_(false),
-      localWatchNumber(0), localLinkNumber(0)
+      localWatchNumber(0), localLinkNumber(0),
+      highestAckable(-1), lastAckSent(-1), unackedCount(0)
 {
     //cerr << "construction: " << this << endl;
 }
@@ -200,6 +201,16 @@ start()
                              this->checkConnectionState();
                          });
 
+    // Cumulative acks go out at most four times a second, well inside
+    // the one second deadline of the messages they cover
+    this->ackTimer = connection->getTimer(Date::now().plusSeconds(0.25), 0.25);
+    this->ackTimer.bind([=] (Date)
+                        {
+                            if (!this->connection)
+                                return;
+                            this->flushAcks();
+                        });
+
     startWriting();
 }
 
@@ -237,7 +248,9 @@ sendMessage(MessagePriority priority,
             OnError onError)
 {
     PeerMessage peerMessage;
-    peerMessage.direction = DIR_REQUEST;
+    // Requests with no response handler don't need an individual
+    // response; the remote end acknowledges them cumulatively instead
+    peerMessage.direction = onResponse ? DIR_REQUEST : DIR_REQUEST_CUMACK;
     peerMessage.messageId = currentMessageId.fetch_add(1);
     peerMessage.priority = priority;
     peerMessage.deadline = deadline;
@@ -350,13 +363,14 @@ getMessage(std::string & payload)
         }
 #endif
 
-        auto encoded = msg.encode();
-        payload = std::string(encoded->begin(), encoded->end());
+        // Encode straight into the output string; the encoded message
+        // was previously built in a scratch buffer and copied over
+        payload = msg.encodeStr();
 
         //cerr << "payload.size() = " << payload.size() << endl;
 
-        if (msg.direction == DIR_REQUEST) {
-        
+        if (msg.direction != DIR_RESPONSE) {
+
             if (msg.deadline <= now) {
                 // deadline already expired
                 msg.state = PeerMessage::TIMEOUT_SEND;
@@ -435,6 +449,7 @@ shutdown()
     
     heartbeat = WatchT<Date>();
     earliestMessageExpiry = WatchT<Date>();
+    ackTimer = WatchT<Date>();
 
     if (connection) {
         connection->shutdown();
@@ -488,10 +503,17 @@ handleMessageIn(PeerMessage && message)
             auto work = [messagePtr,this] ()
                 {
                     PeerMessage & message = *messagePtr;
-                    
+
                     handleLayerOneMessage(message);
-                    
-                    if (!message.payload.empty()) {
+
+                    if (message.header.dir == DIR_REQUEST_CUMACK) {
+                        // No individual response wanted; acknowledge
+                        // cumulatively (but never ack an ack, which
+                        // would ping-pong between the peers)
+                        if (message.type != ACK)
+                            recordAckable(message.messageId);
+                    }
+                    else if (!message.payload.empty()) {
                         sendResponse(std::move(message));
                     }
                 };
@@ -1110,6 +1132,12 @@ handleLayerOneMessage(PeerMessage & message)
         handleRemoteLinkInbound(message.payload);
         return;
     }
+
+    case ACK: {
+        // The other peer acknowledges everything up to a message id
+        handleRemoteAck(message.payload);
+        return;
+    }
     }
     
     //throw MLDB::Exception("got unknown layer 0 message type %d", type);
@@ -1597,6 +1625,71 @@ handleRemoteLinkOutbound(std::vector<std::string> & message)
 
 }
 
+void
+RemotePeer::
+handleRemoteAck(std::vector<std::string> & message)
+{
+    ExcAssertEqual(message.size(), 1);
+    int64_t upTo = jsonDecodeStr<int64_t>(message[0]);
+
+    message.clear();
+
+    std::unique_lock<std::mutex> guard(messagesMutex);
+
+    // Everything up to upTo with no response handler is now known to
+    // have been received; no individual response will ever come for it
+    for (auto it = awaitingResponse.begin();
+         it != awaitingResponse.end() && it->first <= upTo;  /* no inc */) {
+        if (it->second.onResponse) {
+            ++it;
+            continue;
+        }
+        deadlines.erase(std::make_pair(it->second.deadline, it->first));
+        it = awaitingResponse.erase(it);
+        messagesAcknowledged += 1;
+    }
+}
+
+void
+RemotePeer::
+recordAckable(int64_t messageId)
+{
+    bool flushNow = false;
+
+    {
+        std::unique_lock<std::mutex> guard(messagesMutex);
+        highestAckable = std::max(highestAckable, messageId);
+        ++unackedCount;
+        flushNow = unackedCount >= 64;
+    }
+
+    if (flushNow)
+        flushAcks();
+}
+
+void
+RemotePeer::
+flushAcks()
+{
+    int64_t upTo;
+
+    {
+        std::unique_lock<std::mutex> guard(messagesMutex);
+        if (highestAckable <= lastAckSent)
+            return;  // nothing new to acknowledge
+        upTo = highestAckable;
+        lastAckSent = upTo;
+        unackedCount = 0;
+    }
+
+    std::vector<std::string> msg;
+    msg.emplace_back(jsonEncodeStr(upTo));
+
+    sendMessage(PRI_NORMAL, Date::now().plusSeconds(1),
+                1, ACK, std::move(msg),
+                nullptr /* no response */, nullptr /* ignore errors */);
+}
+
 void
 RemotePeer::
 startWriting()
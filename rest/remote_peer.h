@@ -192,6 +192,8 @@ struct RemotePeer: public RestEntity {
         LINKSTATEOURS,  ///< Our link changed state
         LINKOUTBOUND,   ///< Outbound link message (source to dest)
         LINKINBOUND,    ///< Inbound link message (dest to source)
+
+        ACK,            ///< Cumulative acknowledgement of received messages
     };
 
     void checkMessageQueue();
@@ -306,6 +308,27 @@ struct RemotePeer: public RestEntity {
     void handleRemoteLinkInbound(std::vector<std::string> & message);
     void handleRemoteLinkOutbound(std::vector<std::string> & message);
 
+    void handleRemoteAck(std::vector<std::string> & message);
+
+    /** Record that the given received message wants a cumulative
+        acknowledgement; flushes immediately once enough accumulate.
+    */
+    void recordAckable(int64_t messageId);
+
+    /** Send a cumulative acknowledgement covering everything received so
+        far, if anything new has arrived since the last one.
+    */
+    void flushAcks();
+
+    /// Cumulative acknowledgement state; protected by messagesMutex.
+    /// highestAckable is the highest message id received that asked for
+    /// a cumulative ack; lastAckSent is the last value acknowledged.
+    int64_t highestAckable;
+    int64_t lastAckSent;
+    int unackedCount;
+
+    WatchT<Date> ackTimer;
+
     void deletePeerWatch(int64_t externalWatchId);
     void sendPeerWatchFired(int64_t externalWatchId, const Any & ev);
     void startWriting();
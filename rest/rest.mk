@@ -9,13 +9,16 @@ $(eval $(call include_sub_make,opstats))
 LIBREST_SOURCES := \
 	rest_request.cc \
 	rest_request_router.cc \
+	rest_request_coroutine.cc \
 	rest_request_binding.cc \
 	rest_request_params.cc \
 	in_process_rest_connection.cc \
+	rest_response_cache.cc \
 	rest_service_endpoint.cc \
 	http_rest_endpoint.cc \
 	http_rest_service.cc \
 	cancellation_exception.cc \
+	metrics_registry.cc \
 
 LIBLINK_SOURCES := \
 	call_me_back.cc \
@@ -45,9 +48,9 @@ LIBSERVICE_PEER_SOURCES := \
 REST_INDIRECT_DEPS := http value_description cityhash io_base vfs db any googleurl
 LINK_INDIRECT_DEPS := value_description arch gc types any
 REST_ENTITY_INDIRECT_DEPS := value_description types arch watch rest vfs
-SERVICE_PEER_INDIRECT_DEPS := arch value_description types watch log http io_base any utils logging link $(LINK_INDIRECT_DEPS) rest_entity $(REST_ENTITY_INDIRECT_DEPS)
+SERVICE_PEER_INDIRECT_DEPS := arch value_description types watch log http io_base any utils logging link block $(LINK_INDIRECT_DEPS) rest_entity $(REST_ENTITY_INDIRECT_DEPS)
 
-$(eval $(call library,rest,$(LIBREST_SOURCES),arch types utils log $(REST_INDIRECT_DEPS)))
+$(eval $(call library,rest,$(LIBREST_SOURCES),arch base types utils log $(REST_INDIRECT_DEPS)))
 $(eval $(call library,link,$(LIBLINK_SOURCES),watch $(LINK_INDIRECT_DEPS)))
 $(eval $(call library,rest_entity,$(LIBREST_ENTITY_SOURCES),gc link any json_diff $(REST_ENTITY_INDIRECT_DEPS)))
 $(eval $(call library,service_peer,$(LIBSERVICE_PEER_SOURCES),rest gc link rest_entity $(SERVICE_PEER_INDIRECT_DEPS)))
@@ -17,6 +17,8 @@
 #include "link.h"
 #include <map>
 #include <atomic>
+#include <mutex>
+#include <thread>
 
 
 namespace MLDB {
@@ -491,6 +493,30 @@ struct RestConfigurableCollection: public RestCollection<Key, Value> {
     */
     virtual void loadConfig();
 
+    /** Like loadConfig(), but registers the stored configurations without
+        constructing the entities, so the collection can start serving
+        immediately.  Deferred entities are listed in getKeys() and are
+        constructed one at a time by a background thread (oldest first);
+        accessing one before its turn constructs it at that point, ahead
+        of the queue.  Once construction starts, progress and errors are
+        reported through the normal background task machinery, exactly as
+        for loadConfig().
+    */
+    virtual void loadConfigLazily();
+
+    /** If the given key has a configuration registered by
+        loadConfigLazily() that hasn't been constructed yet, construct it
+        now, synchronously.  Returns true if a construction was done,
+        false if the key wasn't deferred (including when another caller
+        got to it first).
+    */
+    bool ensureEntryLoaded(const Key & key);
+
+    /** Keys of the collection, including entities whose construction has
+        been deferred by loadConfigLazily().
+    */
+    virtual std::vector<Key> getKeys() const;
+
     /** Return whether this object has required persistence.  Default
         implementation returns true.
     */
@@ -662,6 +688,18 @@ protected:
     bool backgroundCreate;
     /* return true if the object is being created in a background thread */
     bool handlePutItl(Key key, Config config, const OnDone & onDone, bool mustBeNew);
+
+    /// Configurations registered by loadConfigLazily() whose entities
+    /// haven't been constructed yet
+    mutable std::mutex deferredConfigsLock;
+    std::map<Key, Config> deferredConfigs;
+
+    /// Thread that works through the deferred configurations
+    std::thread deferredLoaderThread;
+    std::atomic<bool> deferredLoaderStopping;
+
+    void runDeferredLoader();
+    void stopDeferredLoader();
 };
 
 #define REST_COLLECTION_INSTANTIATIONS_IMPL(extern, Key, Value, Config, Status) \
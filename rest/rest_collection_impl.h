@@ -11,6 +11,7 @@
 #include "rest_collection.h"
 #include "mldb/watch/watch_impl.h"
 #include "mldb/arch/rcu_protected.h"
+#include <array>
 #include <future>
 #include "collection_config_store.h"
 #include "mldb/types/utility_descriptions.h"
@@ -63,13 +64,45 @@ getChildEntity(T * val,
 
 template<typename Key, class Value>
 struct RestCollection<Key, Value>::Impl {
-    Impl()
-        : entries(entriesLock)
+    /** Number of shards the key space is split over.  Power of two so the
+        modulo reduces to a mask.  Sixteen keeps the per-shard RCU copies
+        small with tens of thousands of entries while staying cheap for
+        collections with a handful of them.
+    */
+    static constexpr size_t NUM_SHARDS = 16;
+
+    /** Each shard independently RCU-protects its slice of the entries, so
+        a mutation copies only its own shard and a lookup on the request
+        path touches only its own shard's lock.  The locks use distributed
+        epochs so that entering the read side publishes to a per-thread
+        slot rather than contending on a shared counter.
+    */
+    struct Shard {
+        Shard()
+            : entries(entriesLock)
+        {
+        }
+
+        mutable GcLock entriesLock{GcLockBase::EM_DISTRIBUTED};
+        RcuProtected<Entries> entries;
+    };
+
+    std::array<Shard, NUM_SHARDS> shards;
+
+    static size_t shardIndex(const Key & key)
     {
+        return std::hash<Key>()(key) % NUM_SHARDS;
     }
 
-    mutable GcLock entriesLock;
-    RcuProtected<Entries> entries;
+    Shard & shardFor(const Key & key)
+    {
+        return shards[shardIndex(key)];
+    }
+
+    const Shard & shardFor(const Key & key) const
+    {
+        return shards[shardIndex(key)];
+    }
 
     /// Watches on the children
     WatchesT<ChildEvent> childWatches;
@@ -150,9 +183,6 @@ clear()
     using namespace std;
     //cerr << "clearing collection with " << size() << " entries" << endl;
 
-    auto cleanup = impl->entries.replaceCustomCleanup(new Entries());
-    impl->entriesLock.visibleBarrier();
-
     // TODO CONCURRENCY: all of these watches should complete before we
     // make any other notifications, to avoid events from other events
     // being interleaved.  This will allow us to weaken the locking
@@ -161,34 +191,39 @@ clear()
     // 5% of performance.
     // auto exclusiveLock = impl->childWatches.getExclusiveAccess();
 
-    for (auto & e: *cleanup) {
-        // First, wait until it has actually be cleaned up
-        if (e.second.underConstruction) {
-            // Stop it, and wait for it to finish
-            e.second.underConstruction->cancel();
-            ExcAssert(!e.second.underConstruction->running);
-
-            // Note that even if there is a race condition where the
-            // construction finished after we swapped the collections,
-            // it will be blocked on the mutateMutex in addEntryItl,
-            // and once this routine exits (and the mutex is released),
-            // it will see that it was cancelled and the add will abort.
-        }
-        else {
-            // Let the watch know it's being deleted
-            if (!impl->childWatches.empty()) {
-                ChildEvent event;
-                event.event = CE_DELETED;
-                event.parent = event.parentCollection = this;
-                event.key = e.first;
-                event.name = restEncode(event.key);
-                event.object = e.second.value.get();
-                event.entity = getChildEntity(e.second.value.get());
-                event.value = e.second.value;
-
-                //cerr << "triggering child watch for delete on " << event.name << endl;
-
-                impl->childWatches.trigger(event);
+    for (auto & shard: impl->shards) {
+        auto cleanup = shard.entries.replaceCustomCleanup(new Entries());
+        shard.entriesLock.visibleBarrier();
+
+        for (auto & e: *cleanup) {
+            // First, wait until it has actually be cleaned up
+            if (e.second.underConstruction) {
+                // Stop it, and wait for it to finish
+                e.second.underConstruction->cancel();
+                ExcAssert(!e.second.underConstruction->running);
+
+                // Note that even if there is a race condition where the
+                // construction finished after we swapped the collections,
+                // it will be blocked on the mutateMutex in addEntryItl,
+                // and once this routine exits (and the mutex is released),
+                // it will see that it was cancelled and the add will abort.
+            }
+            else {
+                // Let the watch know it's being deleted
+                if (!impl->childWatches.empty()) {
+                    ChildEvent event;
+                    event.event = CE_DELETED;
+                    event.parent = event.parentCollection = this;
+                    event.key = e.first;
+                    event.name = restEncode(event.key);
+                    event.object = e.second.value.get();
+                    event.entity = getChildEntity(e.second.value.get());
+                    event.value = e.second.value;
+
+                    //cerr << "triggering child watch for delete on " << event.name << endl;
+
+                    impl->childWatches.trigger(event);
+                }
             }
         }
     }
@@ -418,12 +453,13 @@ getKeys() const
 {
     std::vector<Key> result;
 
-    // NOTE: Should not be necessary... investigation needed
-    GcLock::SharedGuard guard(impl->entriesLock);
+    for (auto & shard: impl->shards) {
+        GcLock::SharedGuard guard(shard.entriesLock);
 
-    auto es = impl->entries.getImmutable();
-    for (auto & e: *es) {
-        result.push_back(e.first);
+        auto es = shard.entries.getImmutable();
+        for (auto & e: *es) {
+            result.push_back(e.first);
+        }
     }
     return result;
 }
@@ -433,11 +469,14 @@ size_t
 RestCollection<Key, Value>::
 size() const
 {
-    // NOTE: Should not be necessary... investigation needed
-    GcLock::SharedGuard guard(impl->entriesLock);
+    size_t result = 0;
+    for (auto & shard: impl->shards) {
+        GcLock::SharedGuard guard(shard.entriesLock);
 
-    auto es = impl->entries.getImmutable();
-    return es->size();
+        auto es = shard.entries.getImmutable();
+        result += es->size();
+    }
+    return result;
 }
 
 template<typename Key, class Value>
@@ -445,11 +484,14 @@ bool
 RestCollection<Key, Value>::
 empty() const
 {
-    // NOTE: Should not be necessary... investigation needed
-    GcLock::SharedGuard guard(impl->entriesLock);
+    for (auto & shard: impl->shards) {
+        GcLock::SharedGuard guard(shard.entriesLock);
 
-    auto es = impl->entries.getImmutable();
-    return es->empty();
+        auto es = shard.entries.getImmutable();
+        if (!es->empty())
+            return false;
+    }
+    return true;
 }
 
 template<typename Key, class Value>
@@ -525,11 +567,13 @@ addBackgroundJobInThread(Key key,
 {
     using namespace std;
 
+    auto & shard = impl->shardFor(key);
+
     // NOTE: Should not be necessary... investigation needed
-    GcLock::SharedGuard guard(impl->entriesLock);
+    GcLock::SharedGuard guard(shard.entriesLock);
 
     for (;;) {
-        auto oldEntries = impl->entries();
+        auto oldEntries = shard.entries();
         std::unique_ptr<Entries> newEntries(new Entries(*oldEntries));
 
         auto it = newEntries->find(key);
@@ -615,7 +659,7 @@ addBackgroundJobInThread(Key key,
 
         std::atomic_thread_fence(std::memory_order_release);
 
-        if (impl->entries.cmp_xchg(oldEntries, newEntries, true)) {
+        if (shard.entries.cmp_xchg(oldEntries, newEntries, true)) {
             // Now we can start the task, since the commit succeeded
             task->running = true;
             std::thread thread(toRun);
@@ -693,11 +737,13 @@ addEntryItl(Key key,
     if (state == BackgroundTaskBase::State::CANCELLED)
         return false;
 
+    auto & shard = impl->shardFor(key);
+
     // NOTE: Should not be necessary... investigation needed
-    GcLock::SharedGuard guard(impl->entriesLock);
+    GcLock::SharedGuard guard(shard.entriesLock);
 
     for (;;) {
-        auto oldEntries = impl->entries();
+        auto oldEntries = shard.entries();
 
         auto it = oldEntries->find(key);
         if (it != oldEntries->end() && it->second.value) {
@@ -719,7 +765,7 @@ addEntryItl(Key key,
 
         std::atomic_thread_fence(std::memory_order_release);
 
-        if (impl->entries.cmp_xchg(oldEntries, newEntries, true)) {
+        if (shard.entries.cmp_xchg(oldEntries, newEntries, true)) {
 
             if (!impl->childWatches.empty()) {
                 ChildEvent event;
@@ -759,11 +805,13 @@ replaceEntryItl(Key key,
     if (state == BackgroundTaskBase::State::CANCELLED)
         return false;
 
+    auto & shard = impl->shardFor(key);
+
     // NOTE: Should not be necessary... investigation needed
-    GcLock::SharedGuard guard(impl->entriesLock);
+    GcLock::SharedGuard guard(shard.entriesLock);
 
     for (;;) {
-        auto oldEntries = impl->entries();
+        auto oldEntries = shard.entries();
 
         std::unique_ptr<Entries> newEntries(new Entries(*oldEntries));
 
@@ -782,7 +830,7 @@ replaceEntryItl(Key key,
 
         std::atomic_thread_fence(std::memory_order_release);
 
-        if (impl->entries.cmp_xchg(oldEntries, newEntries, true)) {
+        if (shard.entries.cmp_xchg(oldEntries, newEntries, true)) {
 
             if (!impl->childWatches.empty()) {
                 ChildEvent event;
@@ -813,11 +861,13 @@ deleteEntry(Key key)
 {
     std::unique_lock<typename Impl::MutateMutex> mutateGuard(impl->mutateMutex);
 
+    auto & shard = impl->shardFor(key);
+
     // NOTE: Should not be necessary... investigation needed
-    GcLock::SharedGuard guard(impl->entriesLock);
+    GcLock::SharedGuard guard(shard.entriesLock);
 
     for (;;) {
-        auto oldEntries = impl->entries();
+        auto oldEntries = shard.entries();
 
         auto it = oldEntries->find(key);
         if (it == oldEntries->end())
@@ -832,7 +882,7 @@ deleteEntry(Key key)
 
         std::atomic_thread_fence(std::memory_order_release);
 
-        if (impl->entries.cmp_xchg(oldEntries, newEntries, true /* defer */)) {
+        if (shard.entries.cmp_xchg(oldEntries, newEntries, true /* defer */)) {
             using namespace std;
 
             // Make sure children are cleared before we get rid of the
@@ -898,10 +948,12 @@ std::pair<std::shared_ptr<Value>,
 RestCollection<Key, Value>::
 tryGetEntry(Key key) const
 {
+    auto & shard = impl->shardFor(key);
+
     // NOTE: Should not be necessary... investigation needed
-    GcLock::SharedGuard guard(impl->entriesLock);
+    GcLock::SharedGuard guard(shard.entriesLock);
 
-    auto es = impl->entries.getImmutable();
+    auto es = shard.entries.getImmutable();
 
     auto it = es->find(key);
     if (it != es->end())
@@ -915,10 +967,12 @@ std::shared_ptr<Value>
 RestCollection<Key, Value>::
 getExistingEntry(Key key) const
 {
+    auto & shard = impl->shardFor(key);
+
     // NOTE: Should not be necessary... investigation needed
-    GcLock::SharedGuard guard(impl->entriesLock);
+    GcLock::SharedGuard guard(shard.entriesLock);
 
-    auto es = impl->entries.getImmutable();
+    auto es = shard.entries.getImmutable();
 
     auto it = es->find(key);
     if (it != es->end() && it->second.value)
@@ -935,10 +989,12 @@ std::shared_ptr<Value>
 RestCollection<Key, Value>::
 tryGetExistingEntry(Key key) const
 {
+    auto & shard = impl->shardFor(key);
+
     // NOTE: Should not be necessary... investigation needed
-    GcLock::SharedGuard guard(impl->entriesLock);
+    GcLock::SharedGuard guard(shard.entriesLock);
 
-    auto es = impl->entries.getImmutable();
+    auto es = shard.entries.getImmutable();
 
     auto it = es->find(key);
     if (it != es->end())
@@ -977,21 +1033,22 @@ bool
 RestCollection<Key, Value>::
 forEachEntry(const std::function<bool (Key key, Value & value)> & fn)
 {
-    // NOTE: Should not be necessary... investigation needed
-    GcLock::SharedGuard guard(impl->entriesLock);
+    for (auto & shard: impl->shards) {
+        GcLock::SharedGuard guard(shard.entriesLock);
+
+        auto es = shard.entries.getImmutable();
 
-    auto es = impl->entries.getImmutable();
+        size_t sz = es->size();
 
-    size_t sz = es->size();
+        for (auto & e: *es) {
+            ExcAssertEqual(es->size(), sz);
+            if (e.second.value && !fn(e.first, *e.second.value))
+                return false;
+        }
 
-    for (auto & e: *es) {
         ExcAssertEqual(es->size(), sz);
-        if (e.second.value && !fn(e.first, *e.second.value))
-            return false;
     }
 
-    ExcAssertEqual(es->size(), sz);
-
     return true;
 }
 
@@ -1000,13 +1057,14 @@ bool
 RestCollection<Key, Value>::
 forEachEntry(const std::function<bool (Key key, const Value & value)> & fn) const
 {
-    // NOTE: Should not be necessary... investigation needed
-    GcLock::SharedGuard guard(impl->entriesLock);
+    for (auto & shard: impl->shards) {
+        GcLock::SharedGuard guard(shard.entriesLock);
 
-    auto es = impl->entries.getImmutable();
-    for (auto & e: *es) {
-        if (e.second.value && !fn(e.first, *e.second.value))
-            return false;
+        auto es = shard.entries.getImmutable();
+        for (auto & e: *es) {
+            if (e.second.value && !fn(e.first, *e.second.value))
+                return false;
+        }
     }
 
     return true;
@@ -1079,22 +1137,24 @@ watchElements(const Utf8String & spec, bool catchUp, Any info)
     // entry causing problems.  We need a better way to ask for this.
     if (spec == "*" || true) {
 
-        GcLock::SharedGuard guard(impl->entriesLock);
-        auto es = impl->entries.getImmutable();
-
-        for (auto & e: *es) {
-            if (e.second.value) {
-                ChildEvent event;
-                event.event = CE_NEW;
-                event.parent = event.parentCollection = this;
-                event.key = e.first;
-                event.name = restEncode(e.first);
-                event.object = e.second.value.get();
-                event.entity = getChildEntity(e.second.value.get());
-                event.value = e.second.value;
-                using namespace std;
-                //cerr << "catching up ChildEvent " << event.name << endl;
-                res.trigger(event);
+        for (auto & shard: impl->shards) {
+            GcLock::SharedGuard guard(shard.entriesLock);
+            auto es = shard.entries.getImmutable();
+
+            for (auto & e: *es) {
+                if (e.second.value) {
+                    ChildEvent event;
+                    event.event = CE_NEW;
+                    event.parent = event.parentCollection = this;
+                    event.key = e.first;
+                    event.name = restEncode(e.first);
+                    event.object = e.second.value.get();
+                    event.entity = getChildEntity(e.second.value.get());
+                    event.value = e.second.value;
+                    using namespace std;
+                    //cerr << "catching up ChildEvent " << event.name << endl;
+                    res.trigger(event);
+                }
             }
         }
     }
@@ -1253,7 +1313,8 @@ RestConfigurableCollection(const Utf8String & nounSingular,
                            const Utf8String & nounPlural,
                            RestEntity * parent)
     : Base(nounSingular, nounPlural, parent),
-      childWatchActive(false), backgroundCreate(true)
+      childWatchActive(false), backgroundCreate(true),
+      deferredLoaderStopping(false)
 {
     this->childWatch = this->watchElements("*", true /* catchUp */,
                                            Utf8String("internal child watch"));
@@ -1267,6 +1328,7 @@ template<typename Key, typename Value,
 RestConfigurableCollection<Key, Value, Config, Status>::
 ~RestConfigurableCollection()
 {
+    this->stopDeferredLoader();
     this->shutdown();
 }
 
@@ -1281,6 +1343,8 @@ obtainAsync(Config config,
     Key key = getKey(config);
 
     auto value = this->tryGetExistingEntry(key);
+    if (!value && ensureEntryLoaded(key))
+        value = this->tryGetExistingEntry(key);
     if (value) {
         onDone(value);
         return key;
@@ -1374,11 +1438,13 @@ mustCreateSync(Config config,
     //    mutateGuard(this->impl->mutateMutex);
 
     {
+        auto & shard = this->impl->shardFor(key);
+
         // NOTE: Should not be necessary... investigation needed.  See
         // the comment above.
-        GcLock::SharedGuard guard(this->impl->entriesLock);
+        GcLock::SharedGuard guard(shard.entriesLock);
 
-        auto es = this->impl->entries.getImmutable();
+        auto es = shard.entries.getImmutable();
 
         if (es->count(key)) {
             if (!overwrite)
@@ -1436,6 +1502,9 @@ handleGetValue(Key key,
                const RestRequest & request,
                const RestRequestParsingContext & context)
 {
+    // First access to an entity deferred by loadConfigLazily() loads it
+    ensureEntryLoaded(key);
+
     connection.sendResponse(200, jsonEncodeStr(getStatus(key)),
                             "application/json");
     return RestRequestRouter::MR_YES;
@@ -1740,6 +1809,108 @@ loadConfig()
     }
 }
 
+template<typename Key, typename Value,
+         typename Config, typename Status>
+void
+RestConfigurableCollection<Key, Value, Config, Status>::
+loadConfigLazily()
+{
+    if (!configStore) return;
+
+    {
+        std::unique_lock<std::mutex> guard(deferredConfigsLock);
+
+        for (const auto & key_config: configStore->getAll()) {
+            Key key = restDecode(key_config.first, (Key *)0);
+            Config config = jsonDecode<Config>(key_config.second);
+            deferredConfigs.emplace(std::move(key), std::move(config));
+        }
+
+        if (deferredConfigs.empty())
+            return;
+    }
+
+    deferredLoaderThread
+        = std::thread(&RestConfigurableCollection::runDeferredLoader, this);
+}
+
+template<typename Key, typename Value,
+         typename Config, typename Status>
+bool
+RestConfigurableCollection<Key, Value, Config, Status>::
+ensureEntryLoaded(const Key & key)
+{
+    Config config;
+
+    {
+        std::unique_lock<std::mutex> guard(deferredConfigsLock);
+        auto it = deferredConfigs.find(key);
+        if (it == deferredConfigs.end())
+            return false;
+        config = std::move(it->second);
+        deferredConfigs.erase(it);
+    }
+
+    handlePutSync(key, std::move(config), false /* must be new */);
+    return true;
+}
+
+template<typename Key, typename Value,
+         typename Config, typename Status>
+std::vector<Key>
+RestConfigurableCollection<Key, Value, Config, Status>::
+getKeys() const
+{
+    std::vector<Key> result = Base::getKeys();
+
+    std::unique_lock<std::mutex> guard(deferredConfigsLock);
+    for (const auto & key_config: deferredConfigs)
+        result.push_back(key_config.first);
+
+    return result;
+}
+
+template<typename Key, typename Value,
+         typename Config, typename Status>
+void
+RestConfigurableCollection<Key, Value, Config, Status>::
+runDeferredLoader()
+{
+    while (!deferredLoaderStopping) {
+        Key key;
+
+        {
+            std::unique_lock<std::mutex> guard(deferredConfigsLock);
+            if (deferredConfigs.empty())
+                return;
+            key = deferredConfigs.begin()->first;
+        }
+
+        try {
+            ensureEntryLoaded(key);
+        } catch (const std::exception & exc) {
+            // The error stays visible on the (failed) entry itself; keep
+            // working through the rest of the queue
+            using namespace std;
+            cerr << "error loading deferred " << this->nounSingular
+                 << " " << restEncode(key) << ": " << exc.what() << endl;
+        }
+    }
+}
+
+template<typename Key, typename Value,
+         typename Config, typename Status>
+void
+RestConfigurableCollection<Key, Value, Config, Status>::
+stopDeferredLoader()
+{
+    if (!deferredLoaderThread.joinable())
+        return;
+    deferredLoaderStopping = true;
+    deferredLoaderThread.join();
+    deferredLoaderStopping = false;
+}
+
 template<typename Key, typename Value,
          typename Config, typename Status>
 bool
@@ -1932,12 +2103,14 @@ watchConfig(const Utf8String & spec, bool catchUp, Any info)
     // in an event between when it was created and when it was caught up
     auto res = configWatches.add(std::move(info), filter);
 
-    GcLock::SharedGuard guard(this->impl->entriesLock);
+    for (auto & shard: this->impl->shards) {
+        GcLock::SharedGuard guard(shard.entriesLock);
 
-    auto es = this->impl->entries.getImmutable();
-    for (auto & e: *es) {
-        if (e.second.value) {
-            res.trigger(e.first, getConfig(e.first, *e.second.value));
+        auto es = shard.entries.getImmutable();
+        for (auto & e: *es) {
+            if (e.second.value) {
+                res.trigger(e.first, getConfig(e.first, *e.second.value));
+            }
         }
     }
 
@@ -1979,12 +2152,14 @@ watchStatus(const Utf8String & spec, bool catchUp, Any info)
     // in an event between when it was created and when it was caught up
     auto res = statusWatches.add(std::move(info), filter);
 
-    GcLock::SharedGuard guard(this->impl->entriesLock);
+    for (auto & shard: this->impl->shards) {
+        GcLock::SharedGuard guard(shard.entriesLock);
 
-    auto es = this->impl->entries.getImmutable();
-    for (auto & e: *es) {
-        if (e.second.value) {
-            res.trigger(e.first, std::make_shared<Status>(std::move(getStatus(e.first))));
+        auto es = shard.entries.getImmutable();
+        for (auto & e: *es) {
+            if (e.second.value) {
+                res.trigger(e.first, std::make_shared<Status>(std::move(getStatus(e.first))));
+            }
         }
     }
 
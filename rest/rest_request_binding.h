@@ -18,6 +18,7 @@
 #include "mldb/types/json_printing.h"
 #include "mldb/rest/rest_request_params.h"
 #include "mldb/rest/rest_request_params_types.h"
+#include "mldb/rest/rest_response_cache.h"
 #include "mldb/utils/positioned_types.h"
 
 namespace MLDB {
@@ -1433,10 +1434,44 @@ addRouteAsync(RestRequestRouter & router,
         ::bindAsync(getIgnoredArgs(filter), pmf, ptr, std::forward<Params>(params)...);
     auto & cb = res.first;
     auto & help = res.second;
-        
+
     router.addRoute(path, filter, description, cb, help);
 }
 
+/** Like addRouteAsync, but wraps the bound handler with
+    cacheRestResponses() so that successful responses are cached in the
+    RestResponseCache and replayed until the next dataset commit.  Only
+    use for GET routes whose response is a pure function of the request
+    and committed data; shouldCache may exclude individual requests
+    (such as stateful cursor continuations) from the cache.
+*/
+template<typename Return, typename Obj, typename... Args, typename Ptr,
+         typename... Params>
+void
+addRouteAsyncCached(RestRequestRouter & router,
+                    PathSpec path, RequestFilter filter,
+                    const std::string & description,
+                    std::function<bool (const RestRequest &)> shouldCache,
+                    Return (Obj::* pmf) (Args...) const,
+                    Ptr ptr,
+                    Params&&... params)
+{
+    static_assert(sizeof...(Args) == sizeof...(Params),
+                  "member function and parameter arity must match");
+
+    typedef TypeList<Args...> ArgsList;
+    typedef TypeList<Params...> ParamsList;
+    typedef PositionedDualTypeList<0, ArgsList, ParamsList> PositionedTypes;
+
+    auto res = RestRequestBinder<typename PositionedTypes::List>
+        ::bindAsync(getIgnoredArgs(filter), pmf, ptr, std::forward<Params>(params)...);
+    auto & cb = res.first;
+    auto & help = res.second;
+
+    router.addRoute(path, filter, description,
+                    cacheRestResponses(cb, std::move(shouldCache)), help);
+}
+
 template<typename Return, typename... Args,
          typename... Params, typename ThenFn>
 void
@@ -1480,11 +1515,17 @@ addRouteSyncJsonReturn(RestRequestRouter & router,
                     const RestRequestParsingContext &)
         {
             static std::shared_ptr<ValueDescription> desc(getDefaultDescription((Return *)0));
-            std::ostringstream out;
-            StreamJsonPrintingContext context(out);
+            std::string out;
+            char buf[65536];
+            BufferedJsonPrintingContext context
+                (buf, sizeof(buf),
+                 [&] (const char * p, size_t len) { out.append(p, len); });
             desc->printJson(&ret, context);
-            out << std::endl;
-            connection.sendResponse(200, out.str(), "application/json");
+            context.finish();
+            out += '\n';
+            connection.sendResponse(200,
+                                    Utf8String(std::move(out), false /* check */),
+                                    "application/json");
             return RestRequestRouter::MR_YES;
         };
 
@@ -1536,11 +1577,17 @@ addRouteSyncJsonReturnContext(RestRequestRouter & router,
                     const RestRequestParsingContext &)
         {
             static std::shared_ptr<ValueDescription> desc(getDefaultDescription((Return *)0));
-            std::ostringstream out;
-            StreamJsonPrintingContext context(out);
+            std::string out;
+            char buf[65536];
+            BufferedJsonPrintingContext context
+                (buf, sizeof(buf),
+                 [&] (const char * p, size_t len) { out.append(p, len); });
             desc->printJson(&ret, context);
-            out << std::endl;
-            connection.sendResponse(200, out.str(), "application/json");
+            context.finish();
+            out += '\n';
+            connection.sendResponse(200,
+                                    Utf8String(std::move(out), false /* check */),
+                                    "application/json");
             return RestRequestRouter::MR_YES;
         };
 
@@ -0,0 +1,91 @@
+/** rest_request_coroutine.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Coroutine support for REST request handlers.
+*/
+
+#include "rest_request_coroutine.h"
+#include "mldb/rest/rest_request_router.h"
+#include "mldb/io/message_loop.h"
+
+using namespace std;
+
+
+namespace MLDB {
+
+/*****************************************************************************/
+/* REST REQUEST COROUTINE                                                    */
+/*****************************************************************************/
+
+void
+RestRequestCoroutine::promise_type::
+unhandled_exception()
+{
+    if (state)
+        state->failed = true;
+
+    if (!connection || connection->responseSent())
+        return;
+
+    try {
+        std::rethrow_exception(std::current_exception());
+    } catch (const std::exception & exc) {
+        sendExceptionResponse(*connection, exc);
+    } catch (...) {
+        connection->sendJsonErrorResponse(500, "unknown exception");
+    }
+}
+
+OnProcessRestRequest
+makeCoroutineRequestHandler(OnProcessCoroRestRequest handler)
+{
+    return [handler = std::move(handler)]
+        (RestConnection & connection,
+         const RestRequest & request,
+         RestRequestParsingContext & context)
+        -> RestRequestMatchResult
+    {
+        auto state = std::make_shared<RestRequestCoroutine::State>();
+
+        // The coroutine can outlive this frame, so hand it a captured
+        // connection it can respond through at any point.  The state is
+        // piggybacked so a client disconnect releases it.
+        std::shared_ptr<RestConnection> captured
+            = connection.captureInConnection(state);
+
+        // Created suspended at the initial suspend point; the body does
+        // not run until the resume below
+        RestRequestCoroutine coro = handler(captured, request, context);
+
+        auto & promise = coro.handle.promise();
+        promise.state = state;
+        promise.connection = captured;
+
+        // Run the body up to its first suspension (or to completion).
+        // Past this point the frame owns itself and may already be gone.
+        coro.handle.resume();
+
+        if (state->failed)
+            return RestRequestRouter::MR_ERROR;
+        if (state->finished)
+            return RestRequestRouter::MR_YES;
+        return RestRequestRouter::MR_ASYNC;
+    };
+}
+
+
+/*****************************************************************************/
+/* AWAITABLES                                                                */
+/*****************************************************************************/
+
+void
+ResumeOnMessageLoop::
+await_suspend(std::coroutine_handle<> handle)
+{
+    loop.runInMessageLoopThread([handle] () { handle.resume(); });
+}
+
+} // namespace MLDB
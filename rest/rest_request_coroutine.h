@@ -0,0 +1,206 @@
+/** rest_request_coroutine.h                                       -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Coroutine support for REST request handlers.  A handler written as a
+    C++20 coroutine can suspend while slow work happens elsewhere, freeing
+    the worker thread that accepted the request to serve other connections
+    instead of blocking until the response is ready.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+#include "mldb/rest/rest_request_fwd.h"
+#include "mldb/rest/rest_connection.h"
+#include "mldb/base/thread_pool.h"
+
+namespace MLDB {
+
+struct MessageLoop;
+
+
+/*****************************************************************************/
+/* REST REQUEST COROUTINE                                                    */
+/*****************************************************************************/
+
+/** Return type for REST handlers written as coroutines.
+
+    A coroutine handler receives a captured connection it can respond
+    through at any point, before or after suspending.  The section of the
+    body up to the first co_await runs synchronously on the thread that
+    routed the request, so anything needed from the request or the parsing
+    context should be copied out before the first suspension; the
+    references do not survive it.
+
+    The coroutine frame owns itself: it is destroyed automatically when
+    the body finishes, whichever thread that happens on.  Exceptions that
+    escape the body are turned into the same error responses that
+    synchronous handlers produce.
+
+    Handlers are bound into a router with makeCoroutineRequestHandler,
+    which takes care of capturing the connection and of reporting MR_YES
+    or MR_ASYNC depending on whether the body ran to completion before
+    suspending.
+*/
+
+struct RestRequestCoroutine {
+
+    /// State shared between the coroutine frame and the router adapter,
+    /// since either may outlive the other
+    struct State {
+        std::atomic<bool> finished = { false };
+        std::atomic<bool> failed = { false };
+    };
+
+    struct promise_type {
+        /// Filled in by the adapter before the body first runs
+        std::shared_ptr<State> state;
+        std::shared_ptr<RestConnection> connection;
+
+        RestRequestCoroutine get_return_object()
+        {
+            return RestRequestCoroutine
+                (std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        /// Start suspended so the adapter can fill in the fields above
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        /// Record completion, then let the frame clean itself up
+        std::suspend_never final_suspend() noexcept
+        {
+            if (state)
+                state->finished = true;
+            return {};
+        }
+
+        void return_void() {}
+
+        /// Send the same error response a synchronous handler throwing the
+        /// same exception would have produced
+        void unhandled_exception();
+    };
+
+    RestRequestCoroutine(std::coroutine_handle<promise_type> handle)
+        : handle(handle)
+    {
+    }
+
+    /// Owned by the frame itself once started; only the adapter touches it
+    std::coroutine_handle<promise_type> handle;
+};
+
+
+/// Signature of a coroutine REST handler.  The connection is captured and
+/// safe to respond through after suspension; the request and context
+/// references are only valid until the first co_await.
+typedef std::function<RestRequestCoroutine
+                      (std::shared_ptr<RestConnection> connection,
+                       const RestRequest & request,
+                       const RestRequestParsingContext & context)>
+OnProcessCoroRestRequest;
+
+/** Wrap a coroutine handler so it can be bound anywhere an
+    OnProcessRestRequest is accepted (RestRequestRouter::addRoute and
+    friends).  Returns MR_YES (or MR_ERROR) if the body ran to completion
+    before suspending, MR_ASYNC otherwise.
+*/
+OnProcessRestRequest
+makeCoroutineRequestHandler(OnProcessCoroRestRequest handler);
+
+
+/*****************************************************************************/
+/* AWAITABLES                                                                */
+/*****************************************************************************/
+
+/** Awaitable that reschedules the coroutine onto the given message loop.
+    Useful to get back onto the serving thread after blocking work, so
+    that everything after the co_await runs where the rest of the I/O
+    does.  Must not be awaited from the message loop thread itself.
+*/
+struct ResumeOnMessageLoop {
+    MessageLoop & loop;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle);
+    void await_resume() const noexcept {}
+};
+
+inline ResumeOnMessageLoop resumeOn(MessageLoop & loop)
+{
+    return { loop };
+}
+
+/** Awaitable that runs a blocking function on a thread pool and resumes
+    the coroutine with its result (or its exception) once it finishes.
+    This is how a handler lets go of its worker thread across a slow
+    operation like a dataset load or a remote fetch: the operation itself
+    still blocks, but it blocks a pool thread, and the threads that route
+    requests stay free to serve other connections.
+*/
+template<typename Fn>
+struct RunBlockingAwaitable {
+    typedef std::invoke_result_t<Fn> Result;
+
+    ThreadPool & pool;
+    Fn fn;
+
+    struct VoidResult {};
+    typedef std::conditional_t<std::is_void_v<Result>,
+                               VoidResult,
+                               std::optional<Result>> Stored;
+
+    Stored result;
+    std::exception_ptr exception;
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        // The awaitable lives in the coroutine frame, so it stays valid
+        // until the resume below has run
+        pool.add([this, handle] () {
+            try {
+                if constexpr (std::is_void_v<Result>)
+                    fn();
+                else
+                    result.emplace(fn());
+            } catch (...) {
+                exception = std::current_exception();
+            }
+            handle.resume();
+        });
+    }
+
+    Result await_resume()
+    {
+        if (exception)
+            std::rethrow_exception(exception);
+        if constexpr (!std::is_void_v<Result>)
+            return std::move(*result);
+    }
+};
+
+template<typename Fn>
+RunBlockingAwaitable<Fn> runBlocking(ThreadPool & pool, Fn fn)
+{
+    return { pool, std::move(fn) };
+}
+
+template<typename Fn>
+RunBlockingAwaitable<Fn> runBlocking(Fn fn)
+{
+    return { ThreadPool::instance(), std::move(fn) };
+}
+
+} // namespace MLDB
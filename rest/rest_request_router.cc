@@ -28,27 +28,65 @@ namespace MLDB {
 /* PATH SPEC                                                                 */
 /*****************************************************************************/
 
+namespace {
+
+/* Classify a route regex for fast matching.  Returns the literal prefix
+   of the pattern (the bytes any match must start with) and sets the
+   match kind if the whole pattern is a literal prefix followed by a
+   single "next segment" or "rest of path" capture, which covers nearly
+   every regex route in the tree. */
+std::string
+compileFastMatch(const Utf8String & surface, PathSpec::FastMatch & fastMatch)
+{
+    const std::string & raw = surface.rawString();
+    static const std::string metachars = "\\^$.|?*+()[]{}";
+
+    std::string prefix;
+    size_t i = 0;
+    for (; i < raw.size() && metachars.find(raw[i]) == std::string::npos; ++i)
+        prefix += raw[i];
+
+    if (i < raw.size() && (raw[i] == '?' || raw[i] == '*' || raw[i] == '+'
+                           || raw[i] == '{')) {
+        // Quantifier applies to the last literal character, which is
+        // therefore not guaranteed to be present
+        if (!prefix.empty())
+            prefix.pop_back();
+    }
+
+    std::string rest(raw, i);
+    if (rest == "([^/]*)")
+        fastMatch = PathSpec::FM_SEGMENT;
+    else if (rest == "(.*)")
+        fastMatch = PathSpec::FM_REST;
+    else fastMatch = PathSpec::FM_NONE;
+
+    return prefix;
+}
+
+} // file scope
+
 PathSpec::
 PathSpec()
     : type(NONE)
 {
 }
-        
+
 PathSpec::
 PathSpec(const std::string & fullPath)
-    : type(STRING), path(fullPath)
+    : type(STRING), path(fullPath), literalPrefix(fullPath)
 {
 }
 
 PathSpec::
 PathSpec(const Utf8String & fullPath)
-    : type(STRING), path(fullPath)
+    : type(STRING), path(fullPath), literalPrefix(fullPath.rawString())
 {
 }
 
 PathSpec::
 PathSpec(const char * fullPath)
-    : type(STRING), path(fullPath)
+    : type(STRING), path(fullPath), literalPrefix(fullPath)
 {
 }
 
@@ -58,6 +96,7 @@ PathSpec(Regex rex)
       path(rex.surface()),
       rex(std::move(rex))
 {
+    literalPrefix = compileFastMatch(path, fastMatch);
 }
 
 void
@@ -437,6 +476,30 @@ matchPath(RestRequestParsingContext & context) const
         else return false;
     }
     case PathSpec::REGEX: {
+        // Fast path for the common "literal prefix plus one capture"
+        // shapes: scan the bytes in place instead of running the regex
+        if (path.fastMatch != PathSpec::FM_NONE) {
+            const std::string & rem = context.remaining.rawString();
+            if (rem.compare(0, path.literalPrefix.size(),
+                            path.literalPrefix) != 0)
+                return false;
+            size_t captureStart = path.literalPrefix.size();
+            size_t captureEnd
+                = (path.fastMatch == PathSpec::FM_SEGMENT)
+                ? std::min(rem.find('/', captureStart), rem.size())
+                : rem.size();
+
+            // Same two entries the regex would produce: the whole match
+            // followed by the capture
+            Utf8String whole(rem.substr(0, captureEnd));
+            Utf8String capture(rem.substr(captureStart,
+                                          captureEnd - captureStart));
+            context.resources.emplace_back(Url::decodeUri(whole));
+            context.resources.emplace_back(Url::decodeUri(capture));
+            context.remaining = Utf8String(rem.substr(captureEnd));
+            break;
+        }
+
         MatchResults results;
         bool found
             = regex_search(context.remaining, results, path.rex,
@@ -506,6 +569,14 @@ process(const RestRequest & request,
             return MR_NO;
     }
 
+    // Cheap rejection on the precompiled literal prefix before anything
+    // else: most sibling routes fail here, and the state guard below
+    // copies the remaining path
+    if (!path.literalPrefix.empty()
+        && context.remaining.rawString()
+               .compare(0, path.literalPrefix.size(), path.literalPrefix) != 0)
+        return MR_NO;
+
     // At the end, make sure we put the context back to how it was
     RestRequestParsingContext::StateGuard guard(&context);
 
@@ -63,6 +63,26 @@ struct PathSpec {
     Regex rex;         ///< Parsed regex, if type == REGEX
     Utf8String desc;   ///< Description for help
 
+    /** Fast-path classification of the regex, computed once at
+        construction so that request-time matching can usually avoid the
+        regex engine.  Nearly all regex routes in the tree are a literal
+        prefix followed by a single capture of either the next path
+        segment or everything remaining.
+    */
+    enum FastMatch {
+        FM_NONE,     ///< No fast path; run the full regex
+        FM_SEGMENT,  ///< literal prefix + ([^/]*) capture
+        FM_REST      ///< literal prefix + (.*) capture
+    } fastMatch = FM_NONE;
+
+    /** Literal bytes the remaining path must start with for this spec to
+        match.  For STRING specs this is the whole path; for REGEX specs
+        it is the guaranteed literal prefix of the pattern (possibly
+        empty).  Lets the router reject most candidate routes with a
+        single memcmp, before any state is saved or regex is run.
+    */
+    std::string literalPrefix;
+
     /// Return the number of captured elements for this specification.  This is the
     /// number of strings that will be appended to the resources field of the context
     /// object.
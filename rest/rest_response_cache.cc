@@ -0,0 +1,241 @@
+/** rest_response_cache.cc
+    Jeremy Barnes, 30 August 2026
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Opt-in cache of responses for deterministic GET routes.
+*/
+
+#include "rest_response_cache.h"
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <mutex>
+
+#include "mldb/rest/rest_request.h"
+#include "mldb/rest/in_process_rest_connection.h"
+
+using namespace std;
+
+
+namespace MLDB {
+
+
+/*****************************************************************************/
+/* REST RESPONSE CACHE                                                       */
+/*****************************************************************************/
+
+static uint64_t defaultMaxBytes()
+{
+    static const uint64_t result = [] () -> uint64_t {
+        char * value = ::getenv("REST_RESPONSE_CACHE_SIZE_MB");
+        if (value)
+            return uint64_t(std::max(0L, atol(value))) * 1024 * 1024;
+        return 0;  // disabled unless explicitly enabled
+    } ();
+    return result;
+}
+
+struct RestResponseCache::Itl {
+
+    Itl()
+        : maxBytes(defaultMaxBytes())
+    {
+    }
+
+    struct Node {
+        std::string key;
+        std::shared_ptr<const Entry> entry;
+        uint64_t bytes = 0;
+    };
+
+    mutable std::mutex mutex;
+
+    /// Most recently used entries at the front
+    std::list<Node> lru;
+    std::map<std::string, std::list<Node>::iterator> index;
+
+    uint64_t currentBytes = 0;
+    uint64_t maxBytes;
+    uint64_t epoch = 0;
+
+    std::shared_ptr<const Entry> get(const std::string & key)
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        auto it = index.find(key);
+        if (it == index.end())
+            return nullptr;
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->entry;
+    }
+
+    void put(const std::string & key, std::shared_ptr<const Entry> entry)
+    {
+        uint64_t bytes
+            = key.size() + entry->body.rawLength()
+            + entry->contentType.size() + sizeof(Node);
+
+        std::unique_lock<std::mutex> guard(mutex);
+
+        // An entry bigger than the whole budget can never be admitted
+        if (bytes > maxBytes)
+            return;
+
+        if (index.count(key))
+            return;  // lost a race with another thread; keep the original
+
+        while (currentBytes + bytes > maxBytes && !lru.empty()) {
+            currentBytes -= lru.back().bytes;
+            index.erase(lru.back().key);
+            lru.pop_back();
+        }
+
+        lru.push_front({ key, std::move(entry), bytes });
+        index[key] = lru.begin();
+        currentBytes += bytes;
+    }
+
+    void invalidate()
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        lru.clear();
+        index.clear();
+        currentBytes = 0;
+        ++epoch;
+    }
+};
+
+RestResponseCache::
+RestResponseCache()
+    : itl(new Itl())
+{
+}
+
+RestResponseCache::
+~RestResponseCache()
+{
+}
+
+RestResponseCache &
+RestResponseCache::
+instance()
+{
+    static RestResponseCache cache;
+    return cache;
+}
+
+std::string
+RestResponseCache::
+keyFor(const RestRequest & request) const
+{
+    // Canonicalize the query parameters so that reordered but otherwise
+    // identical requests share an entry
+    RestParams params = request.params;
+    std::sort(params.begin(), params.end());
+
+    uint64_t epoch;
+    {
+        std::unique_lock<std::mutex> guard(itl->mutex);
+        epoch = itl->epoch;
+    }
+
+    std::string key
+        = to_string(epoch) + "\n"
+        + request.verb + "\n"
+        + request.resource;
+    for (auto & p: params)
+        key += "\n" + p.first.rawString() + "=" + p.second.rawString();
+    return key;
+}
+
+std::shared_ptr<const RestResponseCache::Entry>
+RestResponseCache::
+get(const std::string & key)
+{
+    return itl->get(key);
+}
+
+void
+RestResponseCache::
+put(const std::string & key, std::shared_ptr<const Entry> entry)
+{
+    itl->put(key, std::move(entry));
+}
+
+void
+RestResponseCache::
+invalidate()
+{
+    itl->invalidate();
+}
+
+void
+RestResponseCache::
+setMaxBytes(uint64_t maxBytes)
+{
+    std::unique_lock<std::mutex> guard(itl->mutex);
+    itl->maxBytes = maxBytes;
+}
+
+bool
+RestResponseCache::
+enabled() const
+{
+    std::unique_lock<std::mutex> guard(itl->mutex);
+    return itl->maxBytes > 0;
+}
+
+
+/*****************************************************************************/
+/* CACHED ROUTE HANDLER                                                      */
+/*****************************************************************************/
+
+OnProcessRestRequest
+cacheRestResponses(OnProcessRestRequest handler,
+                   std::function<bool (const RestRequest &)> shouldCache)
+{
+    return [handler = std::move(handler),
+            shouldCache = std::move(shouldCache)]
+        (RestConnection & connection,
+         const RestRequest & request,
+         RestRequestParsingContext & context) -> RestRequestMatchResult
+    {
+        auto & cache = RestResponseCache::instance();
+
+        if (!cache.enabled()
+            || (shouldCache && !shouldCache(request)))
+            return handler(connection, request, context);
+
+        std::string key = cache.keyFor(request);
+
+        if (auto entry = cache.get(key)) {
+            connection.sendResponse(entry->responseCode, entry->body,
+                                    entry->contentType);
+            return MR_YES;
+        }
+
+        // Miss: run the handler against a recording connection so the
+        // response can be stored as well as forwarded
+        auto recorded = InProcessRestConnection::create();
+        RestRequestMatchResult result = handler(*recorded, request, context);
+        if (result != MR_YES && result != MR_ASYNC)
+            return result;
+        recorded->waitForResponse();
+
+        auto entry = std::make_shared<RestResponseCache::Entry>();
+        entry->responseCode = recorded->responseCode();
+        entry->contentType = recorded->contentType();
+        entry->body = recorded->stealResponse();
+
+        // Only successful responses are worth replaying
+        if (entry->responseCode == 200)
+            cache.put(key, entry);
+
+        connection.sendResponse(entry->responseCode, entry->body,
+                                entry->contentType);
+        return MR_YES;
+    };
+}
+
+
+} // namespace MLDB
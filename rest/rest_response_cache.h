@@ -0,0 +1,104 @@
+/** rest_response_cache.h                                          -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Opt-in cache of responses for deterministic GET routes.
+*/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include "mldb/rest/rest_request_fwd.h"
+#include "mldb/types/string.h"
+
+
+namespace MLDB {
+
+
+/*****************************************************************************/
+/* REST RESPONSE CACHE                                                       */
+/*****************************************************************************/
+
+/** Process-wide, size-bounded cache of serialized REST responses, used
+    by routes that are deterministic over committed data (dashboards
+    re-issuing the same query route hundreds of times between commits).
+
+    Entries are keyed on the request verb, resource and canonicalized
+    query parameters, plus a data epoch that is bumped every time a
+    dataset commits; a commit therefore invalidates everything at once,
+    and an entry computed while a commit was in flight can never be hit
+    afterwards.  Eviction is least-recently-used over a byte budget.
+
+    The cache is disabled by default; setting the
+    REST_RESPONSE_CACHE_SIZE_MB environment variable to a non-zero
+    budget enables it.  Workloads that query data recorded since the
+    last commit should leave it off, since only commits invalidate.
+*/
+
+struct RestResponseCache {
+
+    static RestResponseCache & instance();
+
+    /** A cached response, ready to be replayed on a connection. */
+    struct Entry {
+        int responseCode = 0;
+        std::string contentType;
+        Utf8String body;
+    };
+
+    /** Build the cache key for the given request, folding in the
+        current data epoch.  Query parameters are sorted so that
+        equivalent requests with reordered parameters share an entry.
+    */
+    std::string keyFor(const RestRequest & request) const;
+
+    /** Look up a response.  Returns nullptr on a miss. */
+    std::shared_ptr<const Entry> get(const std::string & key);
+
+    /** Store a response under the given key, evicting least-recently
+        used entries to stay within the byte budget.
+    */
+    void put(const std::string & key, std::shared_ptr<const Entry> entry);
+
+    /** Drop all entries and bump the data epoch.  Called from
+        Dataset::commit() whenever new data becomes visible.
+    */
+    void invalidate();
+
+    void setMaxBytes(uint64_t maxBytes);
+
+    /** Returns true iff the byte budget is non-zero. */
+    bool enabled() const;
+
+private:
+    RestResponseCache();
+    ~RestResponseCache();
+
+    struct Itl;
+    std::unique_ptr<Itl> itl;
+};
+
+
+/** Wrap a terminal route handler so that its successful (200) responses
+    are cached and replayed.  Only wrap GET routes whose response is a
+    pure function of the request and committed dataset contents; any
+    dataset commit invalidates the whole cache.
+
+    On a miss the handler runs against a recording connection, so
+    handlers that rely on connection capture() must not be wrapped.
+
+    When given, shouldCache excludes individual requests from the cache
+    (for example the stateful cursor continuations of an otherwise
+    deterministic query route); excluded requests go straight to the
+    handler.  The wrapper is also a straight pass-through while the
+    cache is disabled.
+*/
+OnProcessRestRequest
+cacheRestResponses(OnProcessRestRequest handler,
+                   std::function<bool (const RestRequest &)> shouldCache
+                       = nullptr);
+
+
+} // namespace MLDB
@@ -0,0 +1,92 @@
+// This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+/* metrics_registry_test.cc
+   Jeremy Barnes, 30 August 2026
+   Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+   Test of the always-on metrics registry.
+*/
+
+#include "mldb/rest/metrics_registry.h"
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace MLDB;
+
+BOOST_AUTO_TEST_CASE( test_counter_multithreaded )
+{
+    MetricsCounter & counter
+        = MetricsRegistry::instance().counter("test.counter");
+
+    constexpr int numThreads = 8;
+    constexpr int perThread = 10000;
+
+    std::vector<std::thread> threads;
+    for (int i = 0;  i < numThreads;  ++i) {
+        threads.emplace_back([&] ()
+                             {
+                                 for (int j = 0;  j < perThread;  ++j)
+                                     counter.add();
+                             });
+    }
+    for (auto & t: threads)
+        t.join();
+
+    BOOST_CHECK_EQUAL(counter.total(), numThreads * perThread);
+
+    // The same name returns the same counter
+    MetricsCounter & again
+        = MetricsRegistry::instance().counter("test.counter");
+    BOOST_CHECK_EQUAL(&again, &counter);
+}
+
+BOOST_AUTO_TEST_CASE( test_histogram_quantiles )
+{
+    LatencyHistogram & histogram
+        = MetricsRegistry::instance().histogram("test.histogram");
+
+    // Record 1..1000 microseconds, once each
+    for (int i = 1;  i <= 1000;  ++i)
+        histogram.record(i);
+
+    Json::Value scraped = histogram.scrape();
+
+    BOOST_CHECK_EQUAL(scraped["count"].asUInt(), 1000);
+
+    // Mean of 1..1000 us is 500.5us, tracked exactly
+    BOOST_CHECK_CLOSE(scraped["mean"].asDouble(), 500.5e-6, 0.001);
+
+    // Quantiles are bucket lower bounds, so accurate to one sub-bucket
+    // (about 6% relative error)
+    BOOST_CHECK_CLOSE(scraped["p50"].asDouble(), 500e-6, 7.0);
+    BOOST_CHECK_CLOSE(scraped["p90"].asDouble(), 900e-6, 7.0);
+    BOOST_CHECK_CLOSE(scraped["p99"].asDouble(), 990e-6, 7.0);
+    BOOST_CHECK_CLOSE(scraped["p999"].asDouble(), 999e-6, 7.0);
+    BOOST_CHECK_CLOSE(scraped["max"].asDouble(), 1000e-6, 7.0);
+}
+
+BOOST_AUTO_TEST_CASE( test_histogram_empty )
+{
+    LatencyHistogram & histogram
+        = MetricsRegistry::instance().histogram("test.empty");
+
+    Json::Value scraped = histogram.scrape();
+    BOOST_CHECK_EQUAL(scraped["count"].asUInt(), 0);
+    BOOST_CHECK(!scraped.isMember("p50"));
+}
+
+BOOST_AUTO_TEST_CASE( test_registry_scrape )
+{
+    Json::Value scraped = MetricsRegistry::instance().scrape();
+
+    BOOST_CHECK(scraped["counters"].isMember("test.counter"));
+    BOOST_CHECK_EQUAL(scraped["counters"]["test.counter"].asUInt(), 80000);
+    BOOST_CHECK(scraped["histograms"].isMember("test.histogram"));
+    BOOST_CHECK(scraped["histograms"].isMember("test.empty"));
+}
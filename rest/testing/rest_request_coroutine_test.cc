@@ -0,0 +1,266 @@
+/** rest_request_coroutine_test.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Tests of coroutine REST request handlers.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include "mldb/rest/rest_request_router.h"
+#include "mldb/rest/rest_request_coroutine.h"
+#include "mldb/rest/in_process_rest_connection.h"
+#include "mldb/io/message_loop.h"
+#include "mldb/base/thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace MLDB;
+
+
+BOOST_AUTO_TEST_CASE( test_synchronous_completion )
+{
+    RestRequestRouter router;
+
+    auto handler = [] (std::shared_ptr<RestConnection> connection,
+                       const RestRequest & request,
+                       const RestRequestParsingContext & context)
+        -> RestRequestCoroutine
+    {
+        connection->sendResponse(200, "sync coro", "text/plain");
+        co_return;
+    };
+
+    router.addRoute("/sync", { "GET" }, "Synchronous coroutine",
+                    makeCoroutineRequestHandler(handler), Json::Value());
+
+    RestRequest request;
+    request.verb = "GET";
+    request.resource = "/sync";
+
+    auto conn = InProcessRestConnection::create();
+    RestRequestParsingContext context(request);
+    auto result = router.processRequest(*conn, request, context);
+    conn->waitForResponse();
+
+    BOOST_CHECK_EQUAL(result, RestRequestRouter::MR_YES);
+    BOOST_CHECK_EQUAL(conn->responseCode(), 200);
+    BOOST_CHECK_EQUAL(conn->response(), "sync coro");
+}
+
+BOOST_AUTO_TEST_CASE( test_suspend_on_blocking_work )
+{
+    RestRequestRouter router;
+    ThreadPool pool(2);
+
+    auto handler = [&] (std::shared_ptr<RestConnection> connection,
+                        const RestRequest & request,
+                        const RestRequestParsingContext & context)
+        -> RestRequestCoroutine
+    {
+        // References are only valid up to the first co_await
+        Utf8String resource = request.resource;
+
+        int answer = co_await runBlocking(pool, [] () { return 42; });
+
+        connection->sendResponse(200,
+                                 resource + " says " + to_string(answer),
+                                 "text/plain");
+    };
+
+    router.addRoute("/slow", { "GET" }, "Suspending coroutine",
+                    makeCoroutineRequestHandler(handler), Json::Value());
+
+    RestRequest request;
+    request.verb = "GET";
+    request.resource = "/slow";
+
+    auto conn = InProcessRestConnection::create();
+    router.handleRequest(*conn, request);
+    conn->waitForResponse();
+
+    BOOST_CHECK_EQUAL(conn->responseCode(), 200);
+    BOOST_CHECK_EQUAL(conn->response(), "/slow says 42");
+}
+
+BOOST_AUTO_TEST_CASE( test_resume_on_message_loop )
+{
+    RestRequestRouter router;
+    ThreadPool pool(2);
+
+    MessageLoop loop;
+    loop.start();
+
+    std::thread::id loopThread;
+    std::atomic<bool> loopThreadKnown(false);
+    loop.runInMessageLoopThread([&] () {
+        loopThread = std::this_thread::get_id();
+        loopThreadKnown = true;
+    });
+    while (!loopThreadKnown)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    std::atomic<bool> resumedOnLoop(false);
+
+    auto handler = [&] (std::shared_ptr<RestConnection> connection,
+                        const RestRequest & request,
+                        const RestRequestParsingContext & context)
+        -> RestRequestCoroutine
+    {
+        co_await runBlocking(pool, [] () { /* slow work */ });
+        co_await resumeOn(loop);
+
+        resumedOnLoop = std::this_thread::get_id() == loopThread;
+        connection->sendResponse(200, "done", "text/plain");
+    };
+
+    router.addRoute("/loop", { "GET" }, "Resumes on the message loop",
+                    makeCoroutineRequestHandler(handler), Json::Value());
+
+    RestRequest request;
+    request.verb = "GET";
+    request.resource = "/loop";
+
+    auto conn = InProcessRestConnection::create();
+    router.handleRequest(*conn, request);
+    conn->waitForResponse();
+
+    BOOST_CHECK_EQUAL(conn->response(), "done");
+    BOOST_CHECK(resumedOnLoop);
+
+    loop.shutdown();
+}
+
+BOOST_AUTO_TEST_CASE( test_exception_before_suspension )
+{
+    RestRequestRouter router;
+
+    auto handler = [] (std::shared_ptr<RestConnection> connection,
+                       const RestRequest & request,
+                       const RestRequestParsingContext & context)
+        -> RestRequestCoroutine
+    {
+        throw AnnotatedException(418, "early failure");
+        co_return;
+    };
+
+    router.addRoute("/throw", { "GET" }, "Throws before suspending",
+                    makeCoroutineRequestHandler(handler), Json::Value());
+
+    RestRequest request;
+    request.verb = "GET";
+    request.resource = "/throw";
+
+    auto conn = InProcessRestConnection::create();
+    RestRequestParsingContext context(request);
+    auto result = router.processRequest(*conn, request, context);
+    conn->waitForResponse();
+
+    BOOST_CHECK_EQUAL(result, RestRequestRouter::MR_ERROR);
+    BOOST_CHECK_EQUAL(conn->responseCode(), 418);
+}
+
+BOOST_AUTO_TEST_CASE( test_exception_after_suspension )
+{
+    RestRequestRouter router;
+    ThreadPool pool(2);
+
+    auto handler = [&] (std::shared_ptr<RestConnection> connection,
+                        const RestRequest & request,
+                        const RestRequestParsingContext & context)
+        -> RestRequestCoroutine
+    {
+        co_await runBlocking(pool, [] () {
+            throw AnnotatedException(503, "late failure");
+        });
+        connection->sendResponse(200, "unreachable", "text/plain");
+    };
+
+    router.addRoute("/throwlate", { "GET" }, "Throws after suspending",
+                    makeCoroutineRequestHandler(handler), Json::Value());
+
+    RestRequest request;
+    request.verb = "GET";
+    request.resource = "/throwlate";
+
+    auto conn = InProcessRestConnection::create();
+    router.handleRequest(*conn, request);
+    conn->waitForResponse();
+
+    BOOST_CHECK_EQUAL(conn->responseCode(), 503);
+}
+
+BOOST_AUTO_TEST_CASE( test_many_in_flight_requests )
+{
+    // Many suspended requests multiplexed over a pool much smaller than
+    // the request count: all of them park on a gate, then finish together
+
+    RestRequestRouter router;
+    ThreadPool pool(4);
+
+    constexpr int numRequests = 64;
+
+    std::mutex gateMutex;
+    std::condition_variable gateCond;
+    bool gateOpen = false;
+
+    auto handler = [&] (std::shared_ptr<RestConnection> connection,
+                        const RestRequest & request,
+                        const RestRequestParsingContext & context)
+        -> RestRequestCoroutine
+    {
+        co_await runBlocking(pool, [&] () {
+            std::unique_lock<std::mutex> guard(gateMutex);
+            gateCond.wait(guard, [&] () { return gateOpen; });
+        });
+        connection->sendResponse(200, "released", "text/plain");
+    };
+
+    router.addRoute("/gated", { "GET" }, "Waits on the gate",
+                    makeCoroutineRequestHandler(handler), Json::Value());
+
+    RestRequest request;
+    request.verb = "GET";
+    request.resource = "/gated";
+
+    // ThreadPool::add may run a job inline on the submitting thread when
+    // its queues are full, so the gate has to open without our help
+    std::thread opener([&] () {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        {
+            std::unique_lock<std::mutex> guard(gateMutex);
+            gateOpen = true;
+        }
+        gateCond.notify_all();
+    });
+
+    int numAsync = 0;
+
+    std::vector<std::shared_ptr<InProcessRestConnection> > connections;
+    for (int i = 0;  i < numRequests;  ++i) {
+        auto conn = InProcessRestConnection::create();
+        RestRequestParsingContext context(request);
+        auto result = router.processRequest(*conn, request, context);
+        numAsync += (result == RestRequestRouter::MR_ASYNC);
+        connections.push_back(conn);
+    }
+
+    for (auto & conn: connections) {
+        conn->waitForResponse();
+        BOOST_CHECK_EQUAL(conn->response(), "released");
+    }
+
+    cerr << numAsync << " of " << numRequests
+         << " requests were in flight at once" << endl;
+
+    opener.join();
+}
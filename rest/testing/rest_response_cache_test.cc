@@ -0,0 +1,165 @@
+// This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+/* rest_response_cache_test.cc
+   Jeremy Barnes, 30 August 2026
+   Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+   Test of the opt-in REST response cache.
+*/
+
+#include "mldb/rest/rest_response_cache.h"
+#include "mldb/rest/rest_request.h"
+#include "mldb/rest/rest_request_router.h"
+#include "mldb/rest/in_process_rest_connection.h"
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace MLDB;
+
+namespace {
+
+/* Run one request through the given handler on an in-process
+   connection, returning the response body. */
+Utf8String
+doRequest(const OnProcessRestRequest & handler, const RestRequest & request)
+{
+    auto connection = InProcessRestConnection::create();
+    RestRequestParsingContext context(request);
+    RestRequestMatchResult result = handler(*connection, request, context);
+    BOOST_CHECK(result == MR_YES);
+    connection->waitForResponse();
+    return connection->response();
+}
+
+} // file scope
+
+BOOST_AUTO_TEST_CASE( test_hit_miss_and_invalidation )
+{
+    auto & cache = RestResponseCache::instance();
+    cache.setMaxBytes(1024 * 1024);
+
+    int calls = 0;
+    OnProcessRestRequest handler = [&] (RestConnection & connection,
+                                        const RestRequest & request,
+                                        RestRequestParsingContext & context)
+        -> RestRequestMatchResult
+        {
+            ++calls;
+            connection.sendResponse(200,
+                                    Utf8String("response " + to_string(calls)),
+                                    "text/plain");
+            return MR_YES;
+        };
+
+    auto cached = cacheRestResponses(handler);
+
+    RestRequest request("GET", "/v1/query",
+                        { { "q", "select 1" }, { "format", "full" } }, "");
+
+    // Miss: the handler runs
+    BOOST_CHECK_EQUAL(doRequest(cached, request), "response 1");
+    BOOST_CHECK_EQUAL(calls, 1);
+
+    // Hit: the stored response is replayed without running the handler
+    BOOST_CHECK_EQUAL(doRequest(cached, request), "response 1");
+    BOOST_CHECK_EQUAL(calls, 1);
+
+    // Reordered but equivalent parameters share the entry
+    RestRequest reordered("GET", "/v1/query",
+                          { { "format", "full" }, { "q", "select 1" } }, "");
+    BOOST_CHECK_EQUAL(doRequest(cached, reordered), "response 1");
+    BOOST_CHECK_EQUAL(calls, 1);
+
+    // Different parameters are a different entry
+    RestRequest other("GET", "/v1/query",
+                      { { "q", "select 2" }, { "format", "full" } }, "");
+    BOOST_CHECK_EQUAL(doRequest(cached, other), "response 2");
+    BOOST_CHECK_EQUAL(calls, 2);
+
+    // Invalidation (what Dataset::commit() calls) empties the cache and
+    // bumps the epoch, so the next request runs the handler again
+    cache.invalidate();
+    BOOST_CHECK_EQUAL(doRequest(cached, request), "response 3");
+    BOOST_CHECK_EQUAL(calls, 3);
+
+    cache.invalidate();
+}
+
+BOOST_AUTO_TEST_CASE( test_errors_not_cached )
+{
+    auto & cache = RestResponseCache::instance();
+    cache.setMaxBytes(1024 * 1024);
+
+    int calls = 0;
+    OnProcessRestRequest handler = [&] (RestConnection & connection,
+                                        const RestRequest & request,
+                                        RestRequestParsingContext & context)
+        -> RestRequestMatchResult
+        {
+            ++calls;
+            connection.sendResponse(400, Utf8String("bad request"),
+                                    "text/plain");
+            return MR_YES;
+        };
+
+    auto cached = cacheRestResponses(handler);
+
+    RestRequest request("GET", "/v1/query", { { "q", "select x from" } }, "");
+
+    doRequest(cached, request);
+    doRequest(cached, request);
+    BOOST_CHECK_EQUAL(calls, 2);
+
+    cache.invalidate();
+}
+
+BOOST_AUTO_TEST_CASE( test_predicate_and_disabled_bypass )
+{
+    auto & cache = RestResponseCache::instance();
+    cache.setMaxBytes(1024 * 1024);
+
+    int calls = 0;
+    OnProcessRestRequest handler = [&] (RestConnection & connection,
+                                        const RestRequest & request,
+                                        RestRequestParsingContext & context)
+        -> RestRequestMatchResult
+        {
+            ++calls;
+            connection.sendResponse(200,
+                                    Utf8String("response " + to_string(calls)),
+                                    "text/plain");
+            return MR_YES;
+        };
+
+    auto shouldCache = [] (const RestRequest & request)
+        {
+            return !request.params.hasValue("cursor");
+        };
+
+    auto cached = cacheRestResponses(handler, shouldCache);
+
+    // Excluded requests always reach the handler
+    RestRequest stateful("GET", "/v1/query", { { "cursor", "abc" } }, "");
+    BOOST_CHECK_EQUAL(doRequest(cached, stateful), "response 1");
+    BOOST_CHECK_EQUAL(doRequest(cached, stateful), "response 2");
+    BOOST_CHECK_EQUAL(calls, 2);
+
+    // Included requests are cached as usual
+    RestRequest request("GET", "/v1/query", { { "q", "select 1" } }, "");
+    BOOST_CHECK_EQUAL(doRequest(cached, request), "response 3");
+    BOOST_CHECK_EQUAL(doRequest(cached, request), "response 3");
+    BOOST_CHECK_EQUAL(calls, 3);
+
+    // A zero budget turns the wrapper into a pass-through
+    cache.setMaxBytes(0);
+    BOOST_CHECK_EQUAL(doRequest(cached, request), "response 4");
+    BOOST_CHECK_EQUAL(doRequest(cached, request), "response 5");
+    BOOST_CHECK_EQUAL(calls, 5);
+
+    cache.setMaxBytes(1024 * 1024);
+    cache.invalidate();
+}
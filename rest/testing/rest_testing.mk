@@ -10,6 +10,8 @@ ETCD_MANUAL:=$(if $(HAS_ETCD),,manual)
 REST_TESTING_EXTRA_LIBS:=watch any arch value_description types rest $(REST_INDIRECT_DEPS) rest_entity $(REST_ENTITY_INDIRECT_DEPS) gc
 
 $(eval $(call test,link_test,link $(LINK_INDIRECT_DEPS) watch,boost timed valgrind))
+$(eval $(call test,metrics_registry_test,rest $(REST_INDIRECT_DEPS) arch,boost timed))
+$(eval $(call test,rest_response_cache_test,rest $(REST_INDIRECT_DEPS) arch,boost timed))
 $(eval $(call test,rest_collection_test,service_peer $(SERVICE_PEER_INDIRECT_DEPS) $(REST_TESTING_EXTRA_LIBS),boost timed))
 $(eval $(call test,rest_collection_stress_test,service_peer $(SERVICE_PEER_INDIRECT_DEPS) $(REST_TESTING_EXTRA_LIBS),boost timed))
 $(eval $(call test,service_peer_test,service_peer $(SERVICE_PEER_INDIRECT_DEPS) $(REST_TESTING_EXTRA_LIBS),boost $(ETCD_MANUAL) timed))
@@ -35,5 +37,6 @@ $(TESTS)/service_peer_process_discovery_test: \
 
 $(eval $(call test,rest_service_endpoint_test,rest $(REST_TESTING_EXTRA_LIBS),boost manual))
 $(eval $(call test,rest_request_router_test,rest $(REST_TESTING_EXTRA_LIBS),boost))
+$(eval $(call test,rest_request_coroutine_test,rest base io_base $(REST_TESTING_EXTRA_LIBS),boost))
 $(eval $(call test,rest_request_binding_test,rest $(REST_TESTING_EXTRA_LIBS),boost))
 
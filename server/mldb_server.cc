@@ -31,16 +31,29 @@
 #include "mldb/engine/sensor_collection.h"
 #include "mldb/engine/procedure_run_collection.h"
 #include "mldb/core/dataset_scope.h"
+#include "mldb/block/decoded_block_cache.h"
 #include "mldb/vfs/fs_utils.h"
 #include "mldb/vfs/filter_streams.h"
 #include "mldb/core/analytics.h"
+#include "mldb/core/query_profile.h"
+#include "mldb/core/slow_query_log.h"
+#include "mldb/core/cancellation.h"
+#include "mldb/rest/metrics_registry.h"
+#include "mldb/arch/sampling_profiler.h"
 #include "mldb/types/meta_value_description.h"
 #include "mldb/types/basic_value_descriptions.h"
 #include "mldb/arch/simd.h"
 #include "mldb/utils/log.h"
+#include "mldb/base/optimized_path.h"
+#include "mldb/base/thread_pool.h"
+#include "mldb/base/work_class.h"
+#include "mldb/arch/simd_dispatch.h"
 #include "mldb/builtin/shared_library_plugin.h"
 #include "mldb/types/any_impl.h"
 #include "mldb/utils/vector_utils.h"
+#include <condition_variable>
+#include <random>
+#include <thread>
 
 using namespace std;
 
@@ -55,6 +68,42 @@ bool supportsSystemRequirements() {
     return true;
 #endif
 }
+
+/** Parse a SELECT statement, caching the result.  A serving tier
+    typically issues a small number of query shapes over and over at
+    high rates, so the parse cost can be amortized over all of them.
+    The parsed expression trees are immutable once built, so handing
+    out copies of the cached statement is safe; binding can't be cached
+    the same way since it captures the datasets themselves, which may
+    change between requests.
+*/
+SelectStatement parseSelectStatementCached(const std::string & query)
+{
+    static std::mutex mutex;
+    static std::unordered_map<std::string, SelectStatement> cache;
+
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        auto it = cache.find(query);
+        if (it != cache.end())
+            return it->second;
+    }
+
+    SelectStatement stm = SelectStatement::parse(query);
+
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        // A serving tier has a bounded set of shapes; if something is
+        // generating unbounded distinct queries, just start over rather
+        // than growing forever.
+        if (cache.size() >= 1000)
+            cache.clear();
+        cache.emplace(query, stm);
+    }
+
+    return stm;
+}
+
 } // file scope
 
 
@@ -199,14 +248,366 @@ initRoutes()
                          handleShutdown,
                          Json::Value());
 
+    RestRequestRouter::OnProcessRequest handleBlockCacheStats
+        = [=] (RestConnection & connection,
+               const RestRequest & request,
+               const RestRequestParsingContext & context) {
+
+        auto stats = DecodedBlockCache::instance().getStats();
+
+        Json::Value result;
+        result["hits"] = (Json::UInt)stats.hits;
+        result["misses"] = (Json::UInt)stats.misses;
+        result["admitted"] = (Json::UInt)stats.admitted;
+        result["rejected"] = (Json::UInt)stats.rejected;
+        result["evicted"] = (Json::UInt)stats.evicted;
+        result["currentBytes"] = (Json::UInt)stats.currentBytes;
+        result["currentBlocks"] = (Json::UInt)stats.currentBlocks;
+        result["maxBytes"] = (Json::UInt)stats.maxBytes;
+
+        connection.sendJsonResponse(200, result);
+        return RestRequestRouter::MR_YES;
+    };
+
+    versionNode.addRoute("/blockCacheStats", "GET",
+                         "Return decoded block cache statistics",
+                         handleBlockCacheStats,
+                         Json::Value());
+
+    RestRequestRouter::OnProcessRequest handleMetrics
+        = [=] (RestConnection & connection,
+               const RestRequest & request,
+               const RestRequestParsingContext & context) {
+
+        connection.sendJsonResponse(200, MetricsRegistry::instance().scrape());
+        return RestRequestRouter::MR_YES;
+    };
+
+    versionNode.addRoute("/metrics", "GET",
+                         "Return always-on counters and latency histograms",
+                         handleMetrics,
+                         Json::Value());
+
+    RestRequestRouter::OnProcessRequest handleSlowQueries
+        = [=] (RestConnection & connection,
+               const RestRequest & request,
+               const RestRequestParsingContext & context) {
+
+        connection.sendJsonResponse
+            (200, jsonEncode(SlowQueryLog::instance().entries()));
+        return RestRequestRouter::MR_YES;
+    };
+
+    versionNode.addRoute("/slowQueries", "GET",
+                         "Return recently captured queries that exceeded "
+                         "the latency budget, most recent first",
+                         handleSlowQueries,
+                         Json::Value());
+
+    RestRequestRouter::OnProcessRequest handlePluginLoadTimes
+        = [=] (RestConnection & connection,
+               const RestRequest & request,
+               const RestRequestParsingContext & context) {
+
+        Json::Value result;
+        {
+            std::unique_lock<std::mutex> guard(pluginLoadTimesLock);
+            for (auto & entry: pluginLoadTimes)
+                result[entry.first] = entry.second;
+        }
+        connection.sendJsonResponse(200, result);
+        return RestRequestRouter::MR_YES;
+    };
+
+    versionNode.addRoute("/pluginLoadTimes", "GET",
+                         "Return the wall-clock time taken to load each "
+                         "scanned plugin, in seconds",
+                         handlePluginLoadTimes,
+                         Json::Value());
+
+    auto workClassesJson = [] ()
+    {
+        Json::Value result(Json::arrayValue);
+        for (auto & cls: getWorkClassStats()) {
+            Json::Value entry;
+            entry["name"] = cls.name;
+            entry["weight"] = cls.weight;
+            entry["maxConcurrency"] = cls.maxConcurrency;
+            entry["running"] = cls.running;
+            entry["admitted"] = (Json::UInt)cls.admitted;
+            entry["throttled"] = (Json::UInt)cls.throttled;
+            result.append(entry);
+        }
+        return result;
+    };
+
+    RestRequestRouter::OnProcessRequest handleGetWorkClasses
+        = [=] (RestConnection & connection,
+               const RestRequest & request,
+               const RestRequestParsingContext & context) {
+
+        connection.sendJsonResponse(200, workClassesJson());
+        return RestRequestRouter::MR_YES;
+    };
+
+    versionNode.addRoute("/workClasses", "GET",
+                         "Return the work classes used for admission "
+                         "control of parallel work, with their weights, "
+                         "caps and current occupancy",
+                         handleGetWorkClasses,
+                         Json::Value());
+
+    RestRequestRouter::OnProcessRequest handlePutWorkClass
+        = [=] (RestConnection & connection,
+               const RestRequest & request,
+               const RestRequestParsingContext & context) {
+
+        Json::Value config = Json::parse(request.payload);
+        if (!config.isMember("name") || !config["name"].isString()) {
+            connection.sendJsonErrorResponse(400, "work class configuration "
+                                             "requires a 'name' field");
+            return RestRequestRouter::MR_YES;
+        }
+
+        std::string name = config["name"].asString();
+        int weight = config.get("weight", 1).asInt();
+        int maxConcurrency = config.get("maxConcurrency", -1).asInt();
+        configureWorkClass(name, weight, maxConcurrency);
+
+        connection.sendJsonResponse(200, workClassesJson());
+        return RestRequestRouter::MR_YES;
+    };
+
+    versionNode.addRoute("/workClasses", "PUT",
+                         "Create a work class or re-weight it live; takes "
+                         "a JSON body with name, weight and an optional "
+                         "maxConcurrency cap",
+                         handlePutWorkClass,
+                         Json::Value());
+
+    RestRequestRouter::OnProcessRequest handleGetSimdKernels
+        = [=] (RestConnection & connection,
+               const RestRequest & request,
+               const RestRequestParsingContext & context) {
+
+        Json::Value result;
+        result["cpuLevel"] = simdLevelName(highestSupportedSimdLevel());
+        Json::Value kernels(Json::arrayValue);
+        for (auto & kernel: listSimdKernels()) {
+            Json::Value entry;
+            entry["key"] = kernel.key;
+            entry["chosen"] = kernel.chosen;
+            Json::Value available(Json::arrayValue);
+            for (auto & variant: kernel.available)
+                available.append(variant);
+            entry["available"] = available;
+            kernels.append(entry);
+        }
+        result["kernels"] = kernels;
+        connection.sendJsonResponse(200, result);
+        return RestRequestRouter::MR_YES;
+    };
+
+    versionNode.addRoute("/simdKernels", "GET",
+                         "Return the registered SIMD kernel variants and "
+                         "which one runtime dispatch chose for this CPU",
+                         handleGetSimdKernels,
+                         Json::Value());
+
+    auto optimizationLevelName = [] (int level) -> std::string
+    {
+        if (level == OptimizedPath::ALWAYS)
+            return "always";
+        else if (level == OptimizedPath::NEVER)
+            return "never";
+        else if (level == OptimizedPath::SOMETIMES)
+            return "sometimes";
+        else if (level == OptimizedPath::DEFAULT)
+            return "default";
+        else return std::to_string(level);
+    };
+
+    auto optimizationsJson = [=] ()
+    {
+        Json::Value result(Json::arrayValue);
+        for (auto & path: OptimizedPath::stats()) {
+            Json::Value entry;
+            entry["name"] = path.name;
+            entry["level"] = optimizationLevelName(path.level);
+            entry["taken"] = (Json::UInt)path.taken;
+            entry["notTaken"] = (Json::UInt)path.notTaken;
+            entry["ineligible"] = (Json::UInt)path.ineligible;
+            result.append(entry);
+        }
+        return result;
+    };
+
+    RestRequestRouter::OnProcessRequest handleGetOptimizations
+        = [=] (RestConnection & connection,
+               const RestRequest & request,
+               const RestRequestParsingContext & context) {
+
+        connection.sendJsonResponse(200, optimizationsJson());
+        return RestRequestRouter::MR_YES;
+    };
+
+    versionNode.addRoute("/optimizations", "GET",
+                         "Return the registered optimized code paths with "
+                         "their current policy and how often each engaged "
+                         "(taken), fell back (notTaken) or did not apply "
+                         "(ineligible)",
+                         handleGetOptimizations,
+                         Json::Value());
+
+    RestRequestRouter::OnProcessRequest handlePutOptimizations
+        = [=] (RestConnection & connection,
+               const RestRequest & request,
+               const RestRequestParsingContext & context) {
+
+        Json::Value config = Json::parse(request.payload);
+        if (!config.isMember("path") || !config["path"].isString()
+            || !config.isMember("level")) {
+            connection.sendJsonErrorResponse
+                (400, "optimization policy requires a 'path' name regex "
+                 "and a 'level' field");
+            return RestRequestRouter::MR_YES;
+        }
+
+        int frequency;
+        const Json::Value & level = config["level"];
+        if (level.isIntegral()) {
+            frequency = level.asInt();
+        }
+        else if (level.asString() == "always") {
+            frequency = OptimizedPath::ALWAYS;
+        }
+        else if (level.asString() == "never") {
+            frequency = OptimizedPath::NEVER;
+        }
+        else if (level.asString() == "sometimes") {
+            frequency = OptimizedPath::SOMETIMES;
+        }
+        else if (level.asString() == "default") {
+            frequency = OptimizedPath::DEFAULT;
+        }
+        else {
+            connection.sendJsonErrorResponse
+                (400, "unknown optimization level '" + level.asString()
+                 + "'; options are 'always', 'sometimes', 'never', "
+                 "'default' or a frequency");
+            return RestRequestRouter::MR_YES;
+        }
+
+        size_t matched = OptimizedPath::setOptimizationRegex
+            (config["path"].asString(), frequency);
+        if (matched == 0) {
+            connection.sendJsonErrorResponse
+                (404, "no optimized path matches '"
+                 + config["path"].asString() + "'");
+            return RestRequestRouter::MR_YES;
+        }
+
+        connection.sendJsonResponse(200, optimizationsJson());
+        return RestRequestRouter::MR_YES;
+    };
+
+    versionNode.addRoute("/optimizations", "PUT",
+                         "Change the policy of optimized code paths live; "
+                         "takes a JSON body with a 'path' name regex and "
+                         "the 'level' to apply to the matching paths",
+                         handlePutOptimizations,
+                         Json::Value());
+
+    RestRequestRouter::OnProcessRequest handleGetOperations
+        = [=] (RestConnection & connection,
+               const RestRequest & request,
+               const RestRequestParsingContext & context) {
+
+        Json::Value result(Json::arrayValue);
+        for (auto & op: listOperations()) {
+            Json::Value entry;
+            entry["id"] = (Json::Int)op.id;
+            entry["description"] = op.description;
+            entry["started"] = jsonEncode(op.started);
+            entry["cancelled"] = op.cancelled;
+            result.append(entry);
+        }
+        connection.sendJsonResponse(200, result);
+        return RestRequestRouter::MR_YES;
+    };
+
+    versionNode.addRoute("/operations", "GET",
+                         "Return the in-flight cancellable operations, "
+                         "oldest first",
+                         handleGetOperations,
+                         Json::Value());
+
+    RestRequestRouter::OnProcessRequest handleCancelOperation
+        = [=] (RestConnection & connection,
+               const RestRequest & request,
+               const RestRequestParsingContext & context) {
+
+        int64_t id = std::stoll(context.resources.back().rawString());
+        if (!cancelOperation(id)) {
+            connection.sendJsonErrorResponse
+                (404, "no in-flight operation with id "
+                 + std::to_string(id));
+            return RestRequestRouter::MR_YES;
+        }
+        Json::Value response;
+        response["id"] = (Json::Int)id;
+        response["cancelled"] = true;
+        connection.sendJsonResponse(200, response);
+        return RestRequestRouter::MR_YES;
+    };
+
+    versionNode.addRoute(Rx("/operations/([0-9]+)", "/operations/<id>"),
+                         "DELETE",
+                         "Cancel the in-flight operation with the given "
+                         "id; its scan loops stop within milliseconds at "
+                         "the next per-morsel checkpoint",
+                         handleCancelOperation,
+                         Json::Value());
+
+    addRouteAsync(
+        versionNode, "/profiler/sample", { "GET" },
+        "Sample all thread stacks and return them in collapsed-stack "
+        "format for flamegraph rendering.  The request blocks for the "
+        "duration of the sampling run.",
+        &MldbServer::runProfilerSample, this,
+        PassConnectionId(),
+        HybridParamDefault<int>("durationSeconds",
+                                "How long to sample for, in seconds",
+                                5),
+        HybridParamDefault<int>("frequencyHz",
+                                "Stack samples per second per thread",
+                                200));
+
 
    // MLDB-1380 - make sure that the CPU support the minimal instruction sets
     if (supportsSystemRequirements()) {
         const auto queryStringDef = "The string representing the SQL query. "
                                     "Must be defined either as a query string "
                                     "parameter or the JSON body.";
-        addRouteAsync(
+
+        // Query responses are replayed from the response cache (when it
+        // is enabled) until the next dataset commit.  Paginated
+        // execution is stateful -- every page fetch advances the cursor
+        // -- so those requests always go to the handler.
+        auto cacheableQuery = [] (const RestRequest & request) -> bool
+            {
+                if (request.params.hasValue("cursor")
+                    && !request.params.getValue("cursor").empty())
+                    return false;
+                if (request.params.hasValue("pageSize")
+                    && request.params.getValue("pageSize") != "0")
+                    return false;
+                return true;
+            };
+
+        addRouteAsyncCached(
             versionNode, "/query", { "GET" }, "Select from dataset",
+            cacheableQuery,
             &MldbServer::runHttpQuery, this,
             HybridParamDefault<Utf8String>("q", queryStringDef, ""),
             PassConnectionId(),
@@ -224,7 +625,24 @@ initRoutes()
                                      false),
             HybridParamDefault<bool>("sortColumns",
                                      "Do we sort the column names",
-                                     false));
+                                     false),
+            HybridParamDefault<bool>("profile",
+                                     "Do we return per-stage profiling "
+                                     "information alongside the results "
+                                     "(implies the full output format)",
+                                     false),
+            HybridParamDefault<int>("pageSize",
+                                    "If non-zero, return at most this many "
+                                    "rows along with a continuation cursor; "
+                                    "the query executes once and later pages "
+                                    "resume where the previous one stopped "
+                                    "(implies the full output format)",
+                                    0),
+            HybridParamDefault<std::string>("cursor",
+                                            "Continuation cursor from a "
+                                            "previous paginated call; q is "
+                                            "ignored when this is set",
+                                            ""));
 
         addRouteAsync(
             versionNode, "/redirect/get", {"POST"}, "Redirect POST as GET with body. "
@@ -258,6 +676,139 @@ initRoutes()
     }
 }
 
+namespace {
+
+/*****************************************************************************/
+/* QUERY CURSORS                                                             */
+/*****************************************************************************/
+
+/* Paginating by re-running a query with a growing OFFSET re-executes the
+   scan for every page.  A query cursor instead keeps one incremental
+   execution alive between requests: the producer thread runs the query
+   through the streaming queryFromStatement and pauses once it is a page
+   ahead of the consumer, so each page request just drains what has been
+   produced and wakes the producer for the next one.  The bound plan holds
+   shared pointers to the datasets it reads, so a cursor sees the snapshot
+   it was opened against even if the dataset is replaced meanwhile.
+*/
+
+struct QueryCursor {
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    /// Rows produced but not yet delivered
+    std::vector<MatrixNamedRow> buffer;
+
+    /// Producer pauses when the buffer reaches this size
+    size_t highWater = 0;
+
+    bool done = false;
+    bool cancelled = false;
+    std::exception_ptr error;
+
+    Date lastUsed = Date::now();
+    int64_t rowsDelivered = 0;
+
+    std::thread worker;
+
+    ~QueryCursor()
+    {
+        finish();
+    }
+
+    /** Cancel the execution if it is still running, and join the
+        producer thread. */
+    void finish()
+    {
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+            cancelled = true;
+        }
+        cv.notify_all();
+        if (worker.joinable())
+            worker.join();
+    }
+};
+
+struct QueryCursorRegistry {
+
+    /// Cursors idle longer than this are cancelled and dropped
+    static constexpr double IDLE_TIMEOUT_SECONDS = 600.0;
+
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<QueryCursor> > cursors;
+
+    std::string add(std::shared_ptr<QueryCursor> cursor)
+    {
+        static std::mt19937_64 rng(std::random_device{}());
+
+        std::vector<std::shared_ptr<QueryCursor> > expired = sweep();
+
+        std::string token;
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+            do {
+                token = MLDB::format("%016llx%016llx",
+                                     (unsigned long long)rng(),
+                                     (unsigned long long)rng());
+            } while (cursors.count(token));
+            cursors[token] = std::move(cursor);
+        }
+
+        // Joining the expired workers happens outside the registry lock
+        for (auto & c: expired)
+            c->finish();
+
+        return token;
+    }
+
+    std::shared_ptr<QueryCursor> get(const std::string & token)
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        auto it = cursors.find(token);
+        if (it == cursors.end())
+            return nullptr;
+        return it->second;
+    }
+
+    void remove(const std::string & token)
+    {
+        std::shared_ptr<QueryCursor> cursor;
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+            auto it = cursors.find(token);
+            if (it == cursors.end())
+                return;
+            cursor = std::move(it->second);
+            cursors.erase(it);
+        }
+        cursor->finish();
+    }
+
+    /** Remove expired cursors from the registry, returning them so the
+        caller can join their workers without holding the lock. */
+    std::vector<std::shared_ptr<QueryCursor> > sweep()
+    {
+        Date cutoff = Date::now().plusSeconds(-IDLE_TIMEOUT_SECONDS);
+        std::vector<std::shared_ptr<QueryCursor> > expired;
+        std::unique_lock<std::mutex> guard(mutex);
+        for (auto it = cursors.begin();  it != cursors.end();  /* no inc */) {
+            std::unique_lock<std::mutex> cursorGuard(it->second->mutex);
+            if (it->second->lastUsed < cutoff) {
+                cursorGuard.unlock();
+                expired.emplace_back(std::move(it->second));
+                it = cursors.erase(it);
+            }
+            else ++it;
+        }
+        return expired;
+    }
+};
+
+static QueryCursorRegistry queryCursorRegistry;
+
+} // file scope
+
 void
 MldbServer::
 runHttpQuery(const Utf8String& query,
@@ -266,9 +817,175 @@ runHttpQuery(const Utf8String& query,
              bool createHeaders,
              bool rowNames,
              bool rowHashes,
-             bool sortColumns) const
+             bool sortColumns,
+             bool profile,
+             int pageSize,
+             const std::string & cursor) const
 {
-    auto stm = SelectStatement::parse(query.rawString());
+    if (pageSize > 0 || !cursor.empty()) {
+        if (pageSize <= 0)
+            throw AnnotatedException(400, "A continuation cursor needs a "
+                                     "positive pageSize");
+
+        std::string token = cursor;
+        std::shared_ptr<QueryCursor> queryCursor;
+
+        if (token.empty()) {
+            // First page: start an incremental execution of the query
+            // that pauses whenever it gets a page ahead of the consumer
+            queryCursor = std::make_shared<QueryCursor>();
+            queryCursor->highWater = pageSize;
+
+            auto producer = [this, queryCursor, query] ()
+                {
+                    ScopedOperation operation("query (cursor): "
+                                              + query.rawString());
+                    try {
+                        auto stm = parseSelectStatementCached
+                            (query.rawString());
+                        SqlExpressionMldbScope mldbContext(this);
+
+                        std::function<bool (Path &, ExpressionValue &)> onRow
+                            = [&] (Path & path, ExpressionValue & val) -> bool
+                            {
+                                std::unique_lock<std::mutex>
+                                    guard(queryCursor->mutex);
+                                queryCursor->cv.wait
+                                    (guard, [&] ()
+                                     {
+                                         return queryCursor->cancelled
+                                             || queryCursor->buffer.size()
+                                                 < queryCursor->highWater;
+                                     });
+                                if (queryCursor->cancelled)
+                                    return false;
+
+                                MatrixNamedRow row;
+                                row.rowName = std::move(path);
+                                row.rowHash = row.rowName;
+                                Path prefix;
+                                val.appendToRowDestructive(prefix,
+                                                           row.columns);
+                                queryCursor->buffer.emplace_back
+                                    (std::move(row));
+                                guard.unlock();
+                                queryCursor->cv.notify_all();
+                                return true;
+                            };
+
+                        queryFromStatement(onRow, stm, mldbContext);
+                    } MLDB_CATCH_ALL {
+                        std::unique_lock<std::mutex>
+                            guard(queryCursor->mutex);
+                        queryCursor->error = std::current_exception();
+                    }
+
+                    {
+                        std::unique_lock<std::mutex>
+                            guard(queryCursor->mutex);
+                        queryCursor->done = true;
+                    }
+                    queryCursor->cv.notify_all();
+                };
+
+            queryCursor->worker = std::thread(producer);
+            token = queryCursorRegistry.add(queryCursor);
+        }
+        else {
+            queryCursor = queryCursorRegistry.get(token);
+            if (!queryCursor)
+                throw AnnotatedException(404, "Unknown or expired query "
+                                         "cursor", "cursor", token);
+        }
+
+        std::vector<MatrixNamedRow> page;
+        bool complete = false;
+        std::exception_ptr error;
+
+        {
+            std::unique_lock<std::mutex> guard(queryCursor->mutex);
+            queryCursor->highWater = pageSize;
+            queryCursor->cv.notify_all();
+            queryCursor->cv.wait
+                (guard, [&] ()
+                 {
+                     return queryCursor->error || queryCursor->done
+                         || queryCursor->buffer.size() >= size_t(pageSize);
+                 });
+
+            error = queryCursor->error;
+            if (!error) {
+                size_t n = std::min<size_t>(pageSize,
+                                            queryCursor->buffer.size());
+                page.assign
+                    (std::make_move_iterator(queryCursor->buffer.begin()),
+                     std::make_move_iterator(queryCursor->buffer.begin() + n));
+                queryCursor->buffer.erase(queryCursor->buffer.begin(),
+                                          queryCursor->buffer.begin() + n);
+                queryCursor->rowsDelivered += n;
+                complete = queryCursor->done && queryCursor->buffer.empty();
+            }
+            queryCursor->lastUsed = Date::now();
+        }
+        queryCursor->cv.notify_all();
+
+        if (error) {
+            queryCursorRegistry.remove(token);
+            std::rethrow_exception(error);
+        }
+        if (complete)
+            queryCursorRegistry.remove(token);
+
+        Json::Value response;
+        response["results"] = jsonEncode(page);
+        response["complete"] = complete;
+        if (!complete)
+            response["cursor"] = token;
+        connection.sendJsonResponse(200, response);
+        return;
+    }
+
+    // Register as a cancellable operation: the scan loops poll the
+    // token, so DELETE /v1/operations/<id> stops the query promptly
+    ScopedOperation operation("query: " + query.rawString());
+
+    SlowQueryLog::Scope slowQueryScope(query);
+
+    if (profile) {
+        // Profiled queries return a JSON object with the per-stage
+        // profile next to the (full format) results, so the extra
+        // information doesn't need to fit into the other formats.
+        QueryProfile queryProfile;
+        std::vector<MatrixNamedRow> results;
+
+        {
+            QueryProfile::Scope profileScope(queryProfile);
+
+            Timer parseTimer;
+            auto stm = parseSelectStatementCached(query.rawString());
+            queryProfile.recordStage("parse", parseTimer);
+
+            SqlExpressionMldbScope mldbContext(this);
+
+            results = queryFromStatement(stm, mldbContext,
+                                         nullptr /*onProgress*/);
+        }
+
+        Json::Value response;
+        response["profile"] = jsonEncode(queryProfile);
+        response["results"] = jsonEncode(results);
+
+        slowQueryScope.profile = std::move(queryProfile);
+
+        connection.sendJsonResponse(200, response);
+        return;
+    }
+
+    // Profile into the slow query scope, so that queries over the
+    // latency budget are captured with their per-stage timings
+    QueryProfile::Scope profileScope(slowQueryScope.profile);
+
+    auto stm = parseSelectStatementCached(query.rawString());
     SqlExpressionMldbScope mldbContext(this);
 
     auto runQuery = [&] ()
@@ -281,6 +998,19 @@ runHttpQuery(const Utf8String& query,
                        rowNames, rowHashes, sortColumns);
 }
 
+void
+MldbServer::
+runProfilerSample(RestConnection & connection,
+                  int durationSeconds,
+                  int frequencyHz) const
+{
+    std::string collapsed
+        = SamplingProfiler::sampleAllThreads(durationSeconds, frequencyHz);
+
+    connection.sendResponse(200, Utf8String(std::move(collapsed)),
+                            "text/plain");
+}
+
 void
 MldbServer::
 handleRedirectToGet(RestConnection & connection,
@@ -317,7 +1047,7 @@ std::vector<MatrixNamedRow>
 MldbServer::
 query(const Utf8String& query) const
 {
-    auto stm = SelectStatement::parse(query.rawString());
+    auto stm = parseSelectStatementCached(query.rawString());
     SqlExpressionMldbScope mldbContext(this);
 
     return queryFromStatement(stm, mldbContext, nullptr /*onProgress*/);
@@ -379,7 +1109,12 @@ initCollections(std::string credentialsPath,
     types = createTypeClassCollection(this, *routeManager);
 
     plugins->loadConfig();
-    datasets->loadConfig();
+
+    // Datasets are rehydrated lazily: their configurations are registered
+    // now (so startup doesn't wait for every dataset to reload), and each
+    // one is materialized on first access or by the background loader
+    datasets->loadConfigLazily();
+
     procedures->loadConfig();
     functions->loadConfig();
     sensors->loadConfig();
@@ -419,12 +1154,23 @@ start()
     ServicePeer::start();
     // Graphite logging: just log a message bracketing service startup
     recordHit("serviceStarted");
+
+    // Watchdog for the slow query log: capture queries that are over
+    // the latency budget but still running
+    slowQueryWatchdog
+        = getTimer(Date::now().plusSeconds(1.0), 1.0,
+                   [] (Date)
+                   {
+                       SlowQueryLog::instance().checkStalled();
+                   });
 }
 
 void
 MldbServer::
 shutdown()
 {
+    slowQueryWatchdog = WatchT<Date>();
+
     httpEndpoint->closePeer();
 
     ServicePeer::shutdown();
@@ -474,6 +1220,13 @@ scanPlugins(const std::string & dir_)
 
     std::string dir = dir_;
 
+    struct ScannedPlugin {
+        std::string dir;
+        PluginManifest manifest;
+    };
+
+    std::vector<ScannedPlugin> scanned;
+
     auto foundPlugin = [&] (const std::string & dir,
                             std::istream & stream)
         {
@@ -486,22 +1239,18 @@ scanPlugins(const std::string & dir_)
                     shlibConfig.allowInsecureLoading = true;
 
                     manifest.config.params = shlibConfig;
-
-                    auto plugin = plugins->obtainEntitySync(
-                        manifest.config, nullptr /* on progress */);
                 }
                 else if (manifest.config.type == "python" ||
                          manifest.config.type == "javascript") {
                     auto config = manifest.config.params.convert<PluginResource>();
                     config.address = dir;
                     manifest.config.params = config;
-                    auto plugin = plugins->obtainEntitySync(
-                        manifest.config, nullptr /* on progress */);
                 }
                 else {
                     throw AnnotatedException(
                         500, "unknown plugin type to autoload at " + dir);
                 }
+                scanned.emplace_back(ScannedPlugin{dir, std::move(manifest)});
             } catch (const AnnotatedException & exc) {
                 logger->error() << "loading plugin " << dir << ": " << exc.what();
                 logger->error() << "details:";
@@ -558,6 +1307,97 @@ scanPlugins(const std::string & dir_)
             return;
         }
     }
+
+    if (scanned.empty())
+        return;
+
+    /* Load the scanned plugins in dependency order.  All plugins whose
+       declared dependencies are satisfied load concurrently; each wave
+       of loads unblocks the next. */
+
+    std::set<Utf8String> loaded;
+
+    auto isSatisfied = [&] (const PluginManifest & manifest)
+        {
+            for (auto & dep: manifest.dependencies) {
+                Utf8String depId(dep);
+                if (loaded.count(depId))
+                    continue;
+                // Loaded before this scan (eg a builtin or an earlier
+                // plugin directory)
+                if (plugins->tryGetExistingEntity(depId))
+                    continue;
+                return false;
+            }
+            return true;
+        };
+
+    auto loadOne = [&] (const ScannedPlugin & plugin)
+        {
+            Date start = Date::now();
+
+            try {
+                plugins->obtainEntitySync(plugin.manifest.config,
+                                          nullptr /* on progress */);
+            } catch (const AnnotatedException & exc) {
+                logger->error() << "loading plugin " << plugin.dir << ": "
+                                << exc.what();
+                logger->error() << "details:";
+                logger->error() << jsonEncode(exc.details);
+                logger->error() << "plugin will be ignored";
+                return;
+            } catch (const std::exception & exc) {
+                logger->error() << "loading plugin " << plugin.dir << ": "
+                                << exc.what();
+                logger->error() << "plugin will be ignored";
+                return;
+            }
+
+            double elapsed = Date::now().secondsSince(start);
+            std::string name = plugin.manifest.config.id.empty()
+                ? plugin.dir : plugin.manifest.config.id.rawString();
+
+            std::unique_lock<std::mutex> guard(pluginLoadTimesLock);
+            pluginLoadTimes[name] = elapsed;
+        };
+
+    std::vector<ScannedPlugin> remaining = std::move(scanned);
+
+    while (!remaining.empty()) {
+        std::vector<ScannedPlugin> wave, blocked;
+        for (auto & plugin: remaining) {
+            if (isSatisfied(plugin.manifest))
+                wave.emplace_back(std::move(plugin));
+            else blocked.emplace_back(std::move(plugin));
+        }
+
+        if (wave.empty()) {
+            // Dependency cycle or missing dependency.  Load what's left
+            // in scan order rather than dropping it.
+            for (auto & plugin: blocked)
+                logger->error() << "plugin " << plugin.dir
+                                << " has unsatisfied dependencies; "
+                                << "loading it anyway";
+            wave = std::move(blocked);
+            blocked.clear();
+        }
+
+        if (wave.size() == 1)
+            loadOne(wave[0]);
+        else {
+            ThreadPool tp(int(wave.size()));
+            for (auto & plugin: wave)
+                tp.add([&loadOne, &plugin] () { loadOne(plugin); });
+            tp.waitForAll();
+        }
+
+        for (auto & plugin: wave) {
+            if (!plugin.manifest.config.id.empty())
+                loaded.insert(plugin.manifest.config.id);
+        }
+
+        remaining = std::move(blocked);
+    }
 }
 
 Utf8String
@@ -693,7 +1533,12 @@ MldbServer::
 handleRequest(RestConnection & connection,
               const RestRequest & request) const
 {
+    static LatencyHistogram & latency
+        = MetricsRegistry::instance().histogram("rest.request.latencySeconds");
+
+    Timer timer;
     ServicePeer::handleRequest(connection, request);
+    latency.recordSeconds(timer.elapsed_wall());
 }
 
 OnProcessRestRequest
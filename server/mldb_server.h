@@ -15,6 +15,8 @@
 #include "mldb/types/string.h"
 #include "mldb/rest/event_service.h"
 #include "mldb/utils/log_fwd.h"
+#include <map>
+#include <mutex>
 
 
 namespace MLDB {
@@ -123,9 +125,19 @@ struct MldbServer: public MldbEngine, public ServicePeer, public EventRecorder {
                       bool createHeaders,
                       bool rowNames,
                       bool rowHashes,
-                      bool sortColumns) const;
+                      bool sortColumns,
+                      bool profile,
+                      int pageSize,
+                      const std::string & cursor) const;
 
-    /** Redirect POST request as a GET with body.  
+    /** Sample all thread stacks for the given duration and return
+        collapsed stacks for flamegraph rendering on the connection.
+    */
+    void runProfilerSample(RestConnection & connection,
+                           int durationSeconds,
+                           int frequencyHz) const;
+
+    /** Redirect POST request as a GET with body.
         This is for client that do not support GET with body.
     */
     void handleRedirectToGet(RestConnection & connection,
@@ -148,6 +160,9 @@ struct MldbServer: public MldbEngine, public ServicePeer, public EventRecorder {
     std::string httpBoundAddress;
     std::string httpBaseUrl;
 
+    /// Periodic timer that captures stalled queries for the slow query log
+    WatchT<Date> slowQueryWatchdog;
+
     std::shared_ptr<InProcessRestConnection> restPerform(
         const std::string & verb,
         const Utf8String & resource,
@@ -281,6 +296,11 @@ private:
     RestRequestRouter * versionNode;
     std::string cacheDirectory_;
     std::shared_ptr<spdlog::logger> logger;
+
+    /// Wall-clock load time of each scanned plugin, in seconds, keyed on
+    /// the plugin ID (or its directory when no ID is declared)
+    mutable std::mutex pluginLoadTimesLock;
+    std::map<std::string, double> pluginLoadTimes;
 };
 
 } // namespace MLDB
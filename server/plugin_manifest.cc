@@ -7,6 +7,7 @@
 
 #include "plugin_manifest.h"
 #include "mldb/types/basic_value_descriptions.h"
+#include "mldb/types/vector_description.h"
 
 
 namespace MLDB {
@@ -19,6 +20,9 @@ PluginManifestDescription()
 {
     addField("config", &PluginManifest::config,
              "Configuration of plugin loading");
+    addField("dependencies", &PluginManifest::dependencies,
+             "IDs of plugins that must be initialized before this one",
+             std::vector<std::string>());
 }
 
 
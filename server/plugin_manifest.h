@@ -10,6 +10,8 @@
 
 #include "mldb/types/value_description_fwd.h"
 #include "mldb/core/plugin.h"
+#include <string>
+#include <vector>
 
 
 namespace MLDB {
@@ -21,6 +23,10 @@ namespace MLDB {
 
 struct PluginManifest {
     PolyConfig config;
+
+    /// IDs of plugins that must be initialized before this one.  Plugins
+    /// with no ordering constraint between them may load concurrently.
+    std::vector<std::string> dependencies;
 };
 
 DECLARE_STRUCTURE_DESCRIPTION(PluginManifest);
@@ -12,6 +12,7 @@
 #include "mldb/utils/csv.h"
 #include "mldb/types/vector_description.h"
 #include "mldb/base/optimized_path.h"
+#include "mldb/arch/simd_vector.h"
 #include <array>
 #include <unordered_set>
 
@@ -59,6 +60,23 @@ struct RegisterAggregator {
 static const OptimizedPath optimizeDenseAggregators
 ("mldb.sql.optimizeDenseAggregators");
 
+/// Allow control over whether aggregates over numeric embeddings are
+/// accumulated a whole row at a time with the SIMD kernels.
+static const OptimizedPath optimizeEmbeddingAggregators
+("mldb.sql.optimizeEmbeddingAggregators");
+
+/** Detect whether an accumulator can absorb totals produced by the SIMD
+    embedding fast path (see absorbBulk() on the accumulators that can).
+*/
+template<typename T, typename = void>
+struct HasAbsorbBulk: std::false_type {};
+
+template<typename T>
+struct HasAbsorbBulk
+    <T, std::void_t<decltype(std::declval<T &>()
+                             .absorbBulk(0.0, (uint64_t)0, Date()))> >
+    : std::true_type {};
+
 
 template<typename State>
 struct AggregatorT {
@@ -191,15 +209,74 @@ struct AggregatorT {
         std::vector<PathElement> columnNames;
         std::vector<State> columnState;
 
+        /// Per-column totals for the embedding fast path, contiguous so
+        /// that the SIMD kernels can accumulate whole rows; folded back
+        /// into columnState before anything reads it
+        std::vector<double> bulkTotals;
+        uint64_t bulkRows = 0;
+        Date bulkTs = Date::negativeInfinity();
+
+        /// Whether the embedding fast path applies: -1 = not yet
+        /// determined, 0 = no, 1 = yes
+        int bulkOk = -1;
+
         /// If we guessed wrong about denseness, this is the sparse
         /// state we can fall back on
         std::unique_ptr<SparseRowState> fallback;
 
+        /** The bulk path accumulates by position, so it's only valid
+            when the column names are exactly the embedding indexes in
+            order.
+        */
+        bool bulkNamesMatch() const
+        {
+            if (columnNames.empty())
+                return false;
+            for (unsigned i = 0;  i < columnNames.size();  ++i) {
+                if (columnNames[i] != PathElement(i))
+                    return false;
+            }
+            return true;
+        }
+
+        /** Accumulate a whole embedding row at once with the SIMD
+            kernels, rather than dispatching it element by element.
+        */
+        void processBulk(const ExpressionValue & val)
+        {
+            if constexpr (HasAbsorbBulk<State>::value) {
+                if (bulkTotals.empty())
+                    bulkTotals.resize(columnNames.size(), 0.0);
+                distribution<double> vals
+                    = val.getEmbeddingDouble(columnNames.size());
+                SIMD::vec_add(bulkTotals.data(), vals.data(),
+                              bulkTotals.data(), bulkTotals.size());
+                bulkRows += 1;
+                bulkTs.setMax(val.getEffectiveTimestamp());
+            }
+        }
+
+        /** Fold the bulk totals back into the per-column states. */
+        void flushBulk()
+        {
+            if constexpr (HasAbsorbBulk<State>::value) {
+                if (bulkTotals.empty())
+                    return;
+                for (unsigned i = 0;  i < columnState.size();  ++i)
+                    columnState[i].absorbBulk(bulkTotals[i], bulkRows,
+                                              bulkTs);
+                bulkTotals.clear();
+                bulkRows = 0;
+                bulkTs = Date::negativeInfinity();
+            }
+        }
+
         /** Fill in the sparse row state as a fallback, and process
             based upon that for when we have non-uniform columns.
         */
         void pessimize()
         {
+            flushBulk();
             ExcAssert(!fallback.get());
             fallback.reset(new SparseRowState());
             for (unsigned i = 0;  i < columnNames.size();  ++i) {
@@ -223,6 +300,19 @@ struct AggregatorT {
             if (val.empty())
                 return;
 
+            // Numeric embeddings can be accumulated a whole row at a
+            // time with the SIMD kernels, for those accumulators that
+            // know how to absorb the totals.
+            if (bulkOk == -1) {
+                bulkOk = optimizeEmbeddingAggregators
+                    (HasAbsorbBulk<State>::value && bulkNamesMatch());
+            }
+            if (bulkOk && val.isEmbedding()
+                && val.rowLength() == columnNames.size()) {
+                processBulk(val);
+                return;
+            }
+
             // Check if the column names or number don't match, and
             // pessimize back to the sparse version if it's the case.
             bool needToPessimize = columnNames.size() != val.rowLength();
@@ -274,6 +364,8 @@ struct AggregatorT {
                 return fallback->extract();
             }
 
+            flushBulk();
+
             StructValue result;
 
             for (unsigned i = 0;  i < columnNames.size();  ++i) {
@@ -288,6 +380,8 @@ struct AggregatorT {
 
         void merge(DenseRowState* from)
         {
+            from->flushBulk();
+
             if (from->fallback.get()) {
                 if (!fallback.get())
                     pessimize();
@@ -295,6 +389,8 @@ struct AggregatorT {
                 return;
             }
 
+            flushBulk();
+
             for (unsigned i = 0;  i < columnNames.size();  ++i) {
                 columnState[i].merge(&from->columnState[i]);
             }
@@ -544,7 +640,15 @@ struct AverageAccum {
         n += from->n;
         ts.setMax(from->ts);
     }
-    
+
+    /** Absorb totals accumulated by the SIMD embedding fast path. */
+    void absorbBulk(double bulkTotal, uint64_t bulkRows, Date bulkTs)
+    {
+        total += bulkTotal;
+        n += bulkRows;
+        ts.setMax(bulkTs);
+    }
+
     double total;
     double n;
     Date ts;
@@ -588,6 +692,18 @@ struct ValueAccum {
         ts.setMax(src->ts);
     }
 
+    /** Absorb totals accumulated by the SIMD embedding fast path.  Only
+        the summing instantiation can, since the bulk kernel adds.
+    */
+    template<typename O = Op,
+             typename = std::enable_if_t
+                 <std::is_same<O, std::plus<double> >::value> >
+    void absorbBulk(double bulkTotal, uint64_t bulkRows, Date bulkTs)
+    {
+        value += bulkTotal;
+        ts.setMax(bulkTs);
+    }
+
     double value;
     Date ts;
 };
@@ -290,7 +290,40 @@ struct RegisterBuiltinUnaryNumericScalar: public RegisterBuiltinUnaryScalar {
     }
 };
 
+namespace {
+
+std::mutex builtinKernelsMutex;
+std::map<Utf8String, UnaryDoubleKernel> builtinKernels;
+
+} // file scope
+
+void
+registerBuiltinKernel(const Utf8String & name, UnaryDoubleKernel kernel)
+{
+    std::unique_lock<std::mutex> guard(builtinKernelsMutex);
+    if (!builtinKernels.insert({name, kernel}).second) {
+        throw MLDB::Exception("Builtin kernel '" + name.rawString()
+                              + "' was registered twice");
+    }
+}
+
+UnaryDoubleKernel
+lookupBuiltinKernel(const Utf8String & name)
+{
+    std::unique_lock<std::mutex> guard(builtinKernelsMutex);
+    auto it = builtinKernels.find(name);
+    return it == builtinKernels.end() ? nullptr : it->second;
+}
+
 #define WRAP_UNARY_MATH_OP(name, op)             \
+    struct name##Op { static double call(double v) { return op(v); } }; \
+    RegisterBuiltinUnaryNumericScalar<name##Op> register##name(#name); \
+    RegisterBuiltinKernel registerKernel##name(#name, &name##Op::call);
+
+/* Same, but for NaN-testing predicates, which cannot run as typed
+   kernels: the vectorized mode encodes null as NaN, so they would map
+   null inputs to numbers. */
+#define WRAP_UNARY_MATH_TEST(name, op)           \
     struct name##Op { static double call(double v) { return op(v); } }; \
     RegisterBuiltinUnaryNumericScalar<name##Op> register##name(#name);
 
@@ -874,9 +907,9 @@ WRAP_UNARY_MATH_OP(acosh, std::acosh);
 WRAP_UNARY_MATH_OP(atanh, std::atanh);
 WRAP_UNARY_MATH_OP(ln, Builtins::ln);
 WRAP_UNARY_MATH_OP(sqrt, Builtins::sqrt);
-WRAP_UNARY_MATH_OP(isfinite, std::isfinite);
-WRAP_UNARY_MATH_OP(isinf, std::isinf);
-WRAP_UNARY_MATH_OP(isnan, std::isnan);
+WRAP_UNARY_MATH_TEST(isfinite, std::isfinite);
+WRAP_UNARY_MATH_TEST(isinf, std::isinf);
+WRAP_UNARY_MATH_TEST(isnan, std::isnan);
 
 CellValue quantize(const CellValue & x, const CellValue & q)
 {
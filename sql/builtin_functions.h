@@ -176,7 +176,45 @@ struct RegisterBuiltin {
     }
 
     std::vector<std::shared_ptr<void> > handles;
-    
+
+};
+
+
+/*****************************************************************************/
+/* BUILTIN KERNELS                                                           */
+/*****************************************************************************/
+
+/** Typed kernel form of a unary numeric builtin: double in, double out,
+    with null represented as NaN on both sides (the convention of the
+    vectorized execution mode).  Only NaN-propagating functions qualify;
+    a function that maps NaN to a value (like isnan) would turn nulls
+    into numbers.
+*/
+
+typedef double (*UnaryDoubleKernel) (double);
+
+/** Register the typed kernel for the builtin with the given name, which
+    must also be registered through the rich ExpressionValue interface.
+    The vectorized execution mode applies the kernel directly over
+    batches of unboxed doubles, skipping per-call boxing, timestamp
+    propagation and atom extraction; everything else (non-numeric
+    arguments, rows, embeddings) keeps going through the rich interface.
+*/
+void registerBuiltinKernel(const Utf8String & name, UnaryDoubleKernel kernel);
+
+/** Return the registered typed kernel for the given builtin, or nullptr
+    if it has none.
+*/
+UnaryDoubleKernel lookupBuiltinKernel(const Utf8String & name);
+
+/** Helper that registers a typed kernel at static initialization time,
+    alongside the RegisterBuiltin* object for the same function.
+*/
+struct RegisterBuiltinKernel {
+    RegisterBuiltinKernel(const char * name, UnaryDoubleKernel kernel)
+    {
+        registerBuiltinKernel(name, kernel);
+    }
 };
 
 
@@ -334,11 +334,9 @@ CellValue(const CellValue & other)
         || other.type == ST_UTF8_LONG_STRING
         || other.type == ST_LONG_BLOB
         || other.type == ST_LONG_PATH) {
-        void * mem = malloc(sizeof(StringRepr) + other.strLength + 1);
-        longString = new (mem) StringRepr;
-        std::copy(other.longString->repr, other.longString->repr + strLength,
-                  longString->repr);
-        longString->repr[strLength] = 0;
+        // The repr is immutable (apart from the cached hash), so copies
+        // share it rather than reallocating; the last owner frees it
+        other.longString->ref.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
@@ -445,13 +443,20 @@ toUtf8String() const
     switch (type) {
     case ST_UTF8_SHORT_STRING:
     case ST_ASCII_SHORT_STRING:
-    case ST_SHORT_BLOB:
     case ST_SHORT_PATH:
+        // String content was validated when the cell was created, so
+        // don't re-scan it for UTF-8 validity on every conversion
+        return Utf8String((const char *)shortString, (size_t)strLength,
+                          false /* check */);
+    case ST_SHORT_BLOB:
+        // Blobs hold arbitrary bytes, so the validity check stays
         return Utf8String((const char *)shortString, (size_t)strLength);
     case ST_UTF8_LONG_STRING:
     case ST_ASCII_LONG_STRING:
-    case ST_LONG_BLOB:
     case ST_LONG_PATH:
+        return Utf8String(longString->repr, (size_t)strLength,
+                          false /* check */);
+    case ST_LONG_BLOB:
         try {
             return Utf8String(longString->repr, (size_t)strLength);
         } catch (...) {
@@ -477,7 +482,7 @@ toWideString() const
         
     case ST_UTF8_SHORT_STRING:
     case ST_UTF8_LONG_STRING: {
-        Utf8String str(stringChars(), (size_t)strLength);
+        Utf8String str(stringChars(), (size_t)strLength, false /* check */);
         return std::basic_string<char32_t>(str.begin(), str.end());
     }
     default: {
@@ -1074,6 +1079,10 @@ operator == (const CellValue & other) const
     case ST_UTF8_LONG_STRING:
     case ST_LONG_BLOB:
     case ST_LONG_PATH:
+        // Values copied from the same original share their representation,
+        // so equality doesn't need to touch the bytes
+        if (longString == other.longString)
+            return true;
         return strLength == other.strLength
             && strncmp(longString->repr, other.longString->repr, strLength) == 0;
     case ST_TIMESTAMP:
@@ -1376,8 +1385,10 @@ CellValue::
 deleteString()
 {
     if (longString) {
-        longString->~StringRepr();
-        free(longString);
+        if (longString->ref.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            longString->~StringRepr();
+            free(longString);
+        }
     }
     type = ST_EMPTY;
     longString = nullptr;
@@ -511,12 +511,12 @@ private:
 
     struct StringRepr {
         StringRepr() noexcept
-            : hash(0), ref(0)
+            : hash(0), ref(1)
         {
         }
 
         std::atomic<uint64_t> hash;
-        std::atomic<int> ref;
+        std::atomic<int> ref;  ///< Number of CellValues sharing this repr
         char repr[0];
     };
 
@@ -54,13 +54,9 @@ evalSql(SqlBindingScope & scope,
         info.emplace_back(argsVec[i].getSpecializedValueInfo(false /*isconst*/));
     }
 
-    SqlExpressionEvalScope evalScope(scope, info);
+    PreparedSqlExpression prepared(scope, expr, std::move(info));
 
-    auto bound = bindSql(evalScope, expr, info);
-    
-    auto innerRowScope = evalScope.getRowScope(rowScope, argsVec, numArgs);
-    
-    return bound(innerRowScope, GET_ALL);
+    return prepared.run(rowScope, argsVec, numArgs);
 }
 
 ExpressionValue evalSql(SqlBindingScope & scope,
@@ -71,5 +67,58 @@ ExpressionValue evalSql(SqlBindingScope & scope,
     return evalSql(scope, expr, rowScope, argsVec.data(), argsVec.size());
 }
 
+
+/*****************************************************************************/
+/* PREPARED SQL EXPRESSION                                                   */
+/*****************************************************************************/
+
+PreparedSqlExpression::
+PreparedSqlExpression(SqlBindingScope & scope,
+                      const Utf8String & expr,
+                      std::vector<std::shared_ptr<ExpressionValueInfo> >
+                          argInfo)
+    : evalScope(new SqlExpressionEvalScope(scope, std::move(argInfo)))
+{
+    bound = bindSql(*evalScope, expr, evalScope->argInfo);
+}
+
+PreparedSqlExpression::
+~PreparedSqlExpression() = default;
+
+PreparedSqlExpression::
+PreparedSqlExpression(PreparedSqlExpression &&) noexcept = default;
+
+PreparedSqlExpression &
+PreparedSqlExpression::
+operator = (PreparedSqlExpression &&) noexcept = default;
+
+ExpressionValue
+PreparedSqlExpression::
+run(const SqlRowScope & rowScope,
+    const ExpressionValue * args,
+    size_t numArgs) const
+{
+    ExcAssertEqual(numArgs, evalScope->argInfo.size());
+
+    auto innerRowScope = evalScope->getRowScope(rowScope, args, numArgs);
+
+    return bound(innerRowScope, GET_ALL);
+}
+
+ExpressionValue
+PreparedSqlExpression::
+run(const SqlRowScope & rowScope,
+    const std::vector<ExpressionValue> & args) const
+{
+    return run(rowScope, args.data(), args.size());
+}
+
+const std::shared_ptr<ExpressionValueInfo> &
+PreparedSqlExpression::
+getResultInfo() const
+{
+    return bound.info;
+}
+
 } // namespace MLDB
 
@@ -13,6 +13,8 @@
 
 namespace MLDB {
 
+struct SqlExpressionEvalScope;
+
 /** Bind the given SQL expression with the given argument info into a
     function object that can be invoked to evaluate the expression.
 */
@@ -104,5 +106,65 @@ ExpressionValue evalSql(SqlBindingScope & scope,
     return evalSql(scope, expr, rowScope, argsArray, sizeof...(args));
 }
 
+
+/*****************************************************************************/
+/* PREPARED SQL EXPRESSION                                                   */
+/*****************************************************************************/
+
+/** An SQL expression that is parsed and bound once, against a declared
+    argument schema, and can afterwards be evaluated many times with
+    different argument values.  Evaluation skips SqlExpression::parse and
+    bind entirely, leaving only the cost of the bound expression itself,
+    which is what makes it suitable for tight loops that run the same
+    expression over millions of inputs.
+
+    The argInfo vector declares the types of the $1, $2, ... parameters
+    that the expression may refer to; each run() call must pass exactly
+    that many arguments.  The scope passed to the constructor must outlive
+    the prepared expression.
+*/
+
+struct PreparedSqlExpression {
+    PreparedSqlExpression(SqlBindingScope & scope,
+                          const Utf8String & expr,
+                          std::vector<std::shared_ptr<ExpressionValueInfo> >
+                              argInfo);
+    ~PreparedSqlExpression();
+
+    PreparedSqlExpression(PreparedSqlExpression &&) noexcept;
+    PreparedSqlExpression & operator = (PreparedSqlExpression &&) noexcept;
+
+    /** Evaluate with the given arguments, which must match the declared
+        argument schema in number.
+    */
+    ExpressionValue run(const SqlRowScope & rowScope,
+                        const ExpressionValue * args,
+                        size_t numArgs) const;
+
+    ExpressionValue run(const SqlRowScope & rowScope,
+                        const std::vector<ExpressionValue> & args) const;
+
+    /** Evaluate, converting each argument through bindSqlArg() as the
+        evalSql free function does.
+    */
+    template<typename... Args>
+    ExpressionValue run(const SqlRowScope & rowScope, Args&&... args) const
+    {
+        ExpressionValue argsArray[sizeof...(args)]
+            = { bindSqlArg(std::forward<Args>(args))... };
+        return run(rowScope, argsArray, sizeof...(args));
+    }
+
+    /** Value info of the expression's result, known from binding. */
+    const std::shared_ptr<ExpressionValueInfo> & getResultInfo() const;
+
+private:
+    /// Scope holding the declared argument types; bound into by the
+    /// expression, so it must stay at a stable address
+    std::unique_ptr<SqlExpressionEvalScope> evalScope;
+
+    BoundSqlExpression bound;
+};
+
 } // namespace MLDB
 
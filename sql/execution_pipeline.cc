@@ -10,7 +10,11 @@
 #include "mldb/types/annotated_exception.h"
 #include "mldb/types/basic_value_descriptions.h"
 #include "mldb/utils/smart_ptr_utils.h"
+#include "mldb/base/thread_pool.h"
 #include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
 
 
 using namespace std;
@@ -386,11 +390,112 @@ bool
 ElementExecutor::
 takeAll(std::function<bool (std::shared_ptr<PipelineResults> &)> onResult)
 {
-    std::shared_ptr<PipelineResults> res;
-    while ((res = take()))
-        if (!onResult(res))
-            return false;
-    return true;
+    // Peel off the chain of per-row stages that can run partitioned.
+    // Whatever is left underneath (a table scan, a join, ...) is pulled
+    // from serially, a morsel of rows at a time.
+    std::vector<ElementExecutor *> stages;
+    ElementExecutor * source = this;
+    while (ElementExecutor * upstream = source->partitionedSource()) {
+        stages.push_back(source);
+        source = upstream;
+    }
+
+    if (stages.empty()) {
+        std::shared_ptr<PipelineResults> res;
+        while ((res = take()))
+            if (!onResult(res))
+                return false;
+        return true;
+    }
+
+    // Stages were collected from the output end inwards; each row runs
+    // through them source-first.
+    std::reverse(stages.begin(), stages.end());
+
+    constexpr size_t MORSEL_SIZE = 256;
+
+    std::atomic<bool> stop(false);
+
+    // Rows are handed to onResult in source order: each finished morsel
+    // parks its output here until all of its predecessors have been
+    // emitted, and whichever thread completes the run drains it.
+    std::mutex emitMutex;
+    size_t nextToEmit = 0;
+    std::map<size_t, std::vector<std::shared_ptr<PipelineResults> > >
+        finished;
+
+    ThreadWorkGroup tp;
+
+    size_t morselNumber = 0;
+    bool sourceDone = false;
+
+    while (!sourceDone && !stop && !tp.hasException()) {
+        auto morsel = std::make_shared
+            <std::vector<std::shared_ptr<PipelineResults> > >();
+        morsel->reserve(MORSEL_SIZE);
+        while (morsel->size() < MORSEL_SIZE) {
+            std::shared_ptr<PipelineResults> row = source->take();
+            if (!row) {
+                sourceDone = true;
+                break;
+            }
+            morsel->emplace_back(std::move(row));
+        }
+
+        size_t myNumber = morselNumber++;
+
+        auto processMorsel = [&, morsel, myNumber] ()
+            {
+                std::vector<std::shared_ptr<PipelineResults> > out;
+                out.reserve(morsel->size());
+                for (auto & row: *morsel) {
+                    std::shared_ptr<PipelineResults> current
+                        = std::move(row);
+                    for (ElementExecutor * stage: stages) {
+                        current = stage->processPartitioned(std::move(current));
+                        if (!current)
+                            break;
+                    }
+                    if (current)
+                        out.emplace_back(std::move(current));
+                }
+
+                std::unique_lock<std::mutex> guard(emitMutex);
+                finished[myNumber] = std::move(out);
+                while (!finished.empty()
+                       && finished.begin()->first == nextToEmit) {
+                    for (auto & row: finished.begin()->second) {
+                        if (!stop && !onResult(row)) {
+                            stop = true;
+                            break;
+                        }
+                    }
+                    finished.erase(finished.begin());
+                    ++nextToEmit;
+                }
+            };
+
+        tp.add(std::move(processMorsel));
+    }
+
+    tp.waitForAll();
+
+    return !stop;
+}
+
+ElementExecutor *
+ElementExecutor::
+partitionedSource() const
+{
+    return nullptr;
+}
+
+std::shared_ptr<PipelineResults>
+ElementExecutor::
+processPartitioned(std::shared_ptr<PipelineResults> input) const
+{
+    throw AnnotatedException
+        (500, "Executor does not support partitioned execution");
 }
 
 /*****************************************************************************/
@@ -561,6 +666,14 @@ partition(int numElements)
     return std::make_shared<PartitionElement>(shared_from_this(), numElements);
 }
 
+std::shared_ptr<PipelineElement>
+PipelineElement::
+window(size_t numWindowCalls)
+{
+    return std::make_shared<WindowElement>(shared_from_this(),
+                                           numWindowCalls);
+}
+
 std::shared_ptr<PipelineElement>
 PipelineElement::
 statement(const SelectStatement& stm, GetParamInfo getParamInfo)
@@ -579,7 +692,13 @@ statement(const SelectStatement& stm, GetParamInfo getParamInfo)
         hasGroupBy = true;
     }
 
+    size_t numWindowCalls = WindowElement::countWindowCalls(stm.select);
+
     if (hasGroupBy) {
+        if (numWindowCalls != 0)
+            throw AnnotatedException
+                (400, "window functions are not supported together with "
+                 "GROUP BY or aggregators");
         return root
             ->params(getParamInfo)
             ->from(stm.from, stm.when,
@@ -597,18 +716,32 @@ statement(const SelectStatement& stm, GetParamInfo getParamInfo)
     }
     else {
         if (stm.from && stm.from->getType() != "null") {
-            return root
+            auto pipeline = root
             ->params(getParamInfo)
             ->from(stm.from, stm.when,
                    SelectExpression::STAR, stm.where,
                    OrderByExpression(), getParamInfo)
             ->where(stm.where)
             ->select(stm.orderBy)
-            ->sort(stm.orderBy)
+            ->sort(stm.orderBy);
+
+            if (numWindowCalls != 0) {
+                // Window frames are defined over the statement's ORDER BY
+                if (stm.orderBy.clauses.empty())
+                    throw AnnotatedException
+                        (400, "window functions require an ORDER BY clause "
+                         "to define the frame order");
+                pipeline = pipeline->window(numWindowCalls);
+            }
+
+            return pipeline
             ->select(stm.rowName)  // second last element is rowname
             ->select(stm.select);
         }
         else {
+            if (numWindowCalls != 0)
+                throw AnnotatedException
+                    (400, "window functions require a FROM clause");
             return root
             ->params(getParamInfo)
             ->from(stm.from, stm.when,
@@ -233,6 +233,22 @@ struct ElementExecutor {
     */
     virtual bool takeAll(std::function<bool (std::shared_ptr<PipelineResults> &)> onResult);
 
+    /** If this executor is a pure per-row transformation of a single
+        upstream executor, return that upstream executor so that
+        takeAll() can hand morsels of its rows out to the thread pool.
+        Returns null (the default) for executors that carry state from
+        one row to the next, such as joins and order by.
+    */
+    virtual ElementExecutor * partitionedSource() const;
+
+    /** Apply this executor's per-row work to one input row, without
+        touching the source.  Returns null if the row is filtered out.
+        Must be thread-safe; only called on executors whose
+        partitionedSource() is non-null.
+    */
+    virtual std::shared_ptr<PipelineResults>
+    processPartitioned(std::shared_ptr<PipelineResults> input) const;
+
     /** Restart the executor from the start. */
     virtual void restart() = 0;
 };
@@ -383,7 +399,10 @@ struct PipelineElement: public std::enable_shared_from_this<PipelineElement> {
 
     std::shared_ptr<PipelineElement>
     partition(int numElements);
-    
+
+    std::shared_ptr<PipelineElement>
+    window(size_t numWindowCalls);
+
     std::shared_ptr<PipelineElement>
     select(SelectExpression select);
 
@@ -8,16 +8,20 @@
 */
 
 #include "execution_pipeline_impl.h"
+#include "mldb/core/dataset.h"
 #include "mldb/types/annotated_exception.h"
 #include "mldb/types/basic_value_descriptions.h"
 #include "mldb/types/set_description.h"
 #include "mldb/types/tuple_description.h"
 #include "table_expression_operations.h"
 #include <algorithm>
+#include <deque>
 #include "mldb/sql/sql_expression_operations.h"
 #include "mldb/types/vector_description.h"
 #include "mldb/base/scope.h"
 #include "mldb/utils/log.h"
+#include "mldb/utils/environment.h"
+#include "mldb/block/file_serializer.h"
 
 using namespace std;
 
@@ -817,11 +821,26 @@ JoinElement(std::shared_ptr<PipelineElement> root,
     : root(root),
       left(left), boundLeft(boundLeft), right(right), boundRight(boundRight),
       on(on), select(select), where(where), orderBy(orderBy),
-      condition(left, right, on, where, joinQualification), joinQualification(joinQualification)
-{
+      condition(left, right, on, where, joinQualification),
+      joinQualification(joinQualification),
+      buildHashTableOnLeft(false)
+{
+    // The hash join holds its build side in memory, so when both sides
+    // are plain datasets whose row counts are known, build over the
+    // smaller one.  Statistics aren't available for sub-selects and the
+    // like; those keep the default of building on the right.
+    if (condition.style == AnnotatedJoinCondition::EQUIJOIN
+        && joinQualification == JOIN_INNER
+        && boundLeft.dataset && boundRight.dataset) {
+        uint64_t leftRows = boundLeft.dataset->getMatrixView()->getRowCount();
+        uint64_t rightRows = boundRight.dataset->getMatrixView()->getRowCount();
+        buildHashTableOnLeft = leftRows < rightRows;
+    }
+
     switch (condition.style) {
     case AnnotatedJoinCondition::CROSS_JOIN:
     case AnnotatedJoinCondition::EQUIJOIN:
+    case AnnotatedJoinCondition::RANGE_JOIN:
         break;
     default:
         throw AnnotatedException(400, "Join expression requires an equality operator; needs to be in the form f(left) = f(right)",
@@ -865,8 +884,15 @@ JoinElement(std::shared_ptr<PipelineElement> root,
             clauses.clauses.push_back(complementExpr);
         };
 
-    fixOuterSide(leftCondition, condition.left, leftclauses);      
-    fixOuterSide(rightCondition, condition.right, rightclauses);      
+    fixOuterSide(leftCondition, condition.left, leftclauses);
+    fixOuterSide(rightCondition, condition.right, rightclauses);
+
+    // The range join sweep also needs the upper bound of each right-side
+    // window.  It goes after the side condition, so that the
+    // [value, condition] layout shared with the other join styles is
+    // unchanged.
+    if (condition.style == AnnotatedJoinCondition::RANGE_JOIN)
+        rightclauses.clauses.push_back(condition.rangeUpperExpression);
 
     if (outerLeft || outerRight)
         constantWhere = SqlExpression::TRUE;
@@ -897,7 +923,8 @@ bind() const
                                    leftImpl->bind(),
                                    rightImpl->bind(),
                                    condition,
-                                   joinQualification);
+                                   joinQualification,
+                                   buildHashTableOnLeft);
 }
 
 
@@ -1573,6 +1600,654 @@ restart()
 }
 
 
+/*****************************************************************************/
+/* HASH JOIN EXECUTOR                                                        */
+/*****************************************************************************/
+
+namespace {
+
+/* When set to a non-zero number of megabytes, hash joins account for the
+   bytes pinned by their build side and, once over budget, become a grace
+   hash join: both sides are partitioned by key hash into temporary-file
+   runs and the partition pairs joined one at a time, so the join's
+   memory use stays near the budget however large the build side is.
+*/
+static EnvOption<int, true> QUERY_JOIN_MEMORY_LIMIT_MB
+    ("MLDB_QUERY_JOIN_MEMORY_LIMIT_MB", 0);
+
+static constexpr bool JOIN_SPILL_EXACT_BYTES = false;
+
+/* Approximate bytes a pipeline row pins while held for the join.  Used
+   for the budget accounting, not for allocation, so it only needs to be
+   in the right ballpark. */
+size_t rowMemUsage(const PipelineResults & row)
+{
+    size_t result = sizeof(PipelineResults);
+    for (const ExpressionValue & val: row.values) {
+        result += sizeof(ExpressionValue);
+        if (val.empty())
+            continue;
+        if (val.isAtom()) {
+            result += val.getAtom().memusage();
+            continue;
+        }
+        auto onAtom = [&] (const Path & columnName,
+                           const Path & prefix,
+                           const CellValue & cell,
+                           Date ts)
+            {
+                result += columnName.memusage() + cell.memusage()
+                    + sizeof(Date);
+                return true;
+            };
+        val.forEachAtom(onAtom);
+    }
+    return result;
+}
+
+/** A value spills as a count followed by its atoms: -2 for null, -1 for
+    an atom (cell, timestamp), or n >= 0 for a flattened row of n
+    (column path, cell, timestamp) triples.  The CellValue binary
+    serialization round trips atoms, paths and timestamps exactly.
+*/
+template<typename Fn>
+void encodeValue(const ExpressionValue & val, Fn && onCell)
+{
+    if (val.empty()) {
+        onCell(CellValue((int64_t)-2));
+        return;
+    }
+    if (val.isAtom()) {
+        onCell(CellValue((int64_t)-1));
+        onCell(val.getAtom());
+        onCell(CellValue(val.getEffectiveTimestamp()));
+        return;
+    }
+
+    onCell(CellValue((int64_t)val.getAtomCount()));
+    auto onAtom = [&] (const Path & columnName,
+                       const Path & prefix,
+                       const CellValue & cell,
+                       Date ts)
+        {
+            onCell(CellValue(prefix + columnName));
+            onCell(cell);
+            onCell(CellValue(ts));
+            return true;
+        };
+    val.forEachAtom(onAtom);
+}
+
+template<typename Fn>
+void encodePipelineRow(const PipelineResults & row, Fn && onCell)
+{
+    onCell(CellValue((int64_t)row.values.size()));
+    for (const ExpressionValue & val: row.values)
+        encodeValue(val, onCell);
+}
+
+CellValue nextSpilledCell(const char * & p, size_t & remaining)
+{
+    auto res = CellValue::reconstitute
+        (p, remaining,
+         CellValue::serializationFormat(JOIN_SPILL_EXACT_BYTES),
+         JOIN_SPILL_EXACT_BYTES);
+    p += res.second;
+    remaining -= res.second;
+    return std::move(res.first);
+}
+
+ExpressionValue decodeValue(const char * & p, size_t & remaining)
+{
+    int64_t n = nextSpilledCell(p, remaining).toInt();
+    if (n == -2)
+        return ExpressionValue();
+    if (n == -1) {
+        CellValue cell = nextSpilledCell(p, remaining);
+        Date ts = nextSpilledCell(p, remaining).toTimestamp();
+        return ExpressionValue(std::move(cell), ts);
+    }
+
+    RowValue rowValue;
+    rowValue.reserve(n);
+    for (int64_t i = 0;  i < n;  ++i) {
+        Path columnName = nextSpilledCell(p, remaining).coerceToPath();
+        CellValue cell = nextSpilledCell(p, remaining);
+        Date ts = nextSpilledCell(p, remaining).toTimestamp();
+        rowValue.emplace_back(std::move(columnName), std::move(cell), ts);
+    }
+    return ExpressionValue(std::move(rowValue));
+}
+
+/* Decoded rows copy everything but the values from a prototype row of
+   their side, so the scope bookkeeping a PipelineResults carries
+   survives the round trip to disk. */
+std::shared_ptr<PipelineResults>
+decodePipelineRow(const PipelineResults & proto,
+                  const char * & p, size_t & remaining)
+{
+    auto row = std::make_shared<PipelineResults>(proto);
+    int64_t n = nextSpilledCell(p, remaining).toInt();
+    row->values.clear();
+    row->values.reserve(n);
+    for (int64_t i = 0;  i < n;  ++i)
+        row->values.emplace_back(decodeValue(p, remaining));
+    return row;
+}
+
+} // file scope
+
+/** Grace-hash state: both sides partitioned by key hash into
+    temporary-file runs, joined one partition pair at a time.  A
+    partition whose build side still exceeds the budget is re-split with
+    the next level of hash bits, recursively, until it fits or the key
+    is so skewed that splitting stops helping.  The spilled regions are
+    memory mapped, so the probe side streams back without pulling a run
+    into memory at once.
+*/
+struct JoinElement::HashJoinExecutor::Grace {
+
+    static constexpr size_t NUM_PARTITIONS = 32;
+    static constexpr int MAX_SALT = 4;
+
+    TemporaryFileSerializer serializer;
+    uint64_t budgetBytes;
+
+    /// One side of one partition: spilled runs plus the buffer of rows
+    /// not yet written out
+    struct Side {
+        std::vector<std::pair<FrozenMemoryRegion, size_t> > runs;
+        std::vector<std::shared_ptr<PipelineResults> > buffer;
+        uint64_t bufferBytes = 0;
+        uint64_t totalBytes = 0;    ///< in-memory estimate of all rows
+    };
+
+    struct Partition {
+        int salt = 0;
+        Side build, probe;
+    };
+
+    /// Partition pairs waiting to be joined
+    std::deque<Partition> work;
+
+    std::shared_ptr<PipelineResults> buildProto, probeProto;
+
+    /// Probe-side read cursor over the partition being joined
+    std::vector<std::pair<FrozenMemoryRegion, size_t> > probeRuns;
+    size_t probeRun = 0;
+    const char * probeP = nullptr;
+    size_t probeRemaining = 0;
+    size_t probeRowsLeft = 0;
+
+    Grace(uint64_t budgetBytes)
+        : serializer("tmp", "query-join-spill"),
+          budgetBytes(budgetBytes)
+    {
+        work.resize(NUM_PARTITIONS);
+    }
+
+    /** Each split level consumes a fresh slice of the key hash, so the
+        rows of a partition respread over its children. */
+    static size_t partitionOf(uint64_t hash, int salt)
+    {
+        return (hash >> (5 * salt + 7)) % NUM_PARTITIONS;
+    }
+
+    uint64_t flushThreshold() const
+    {
+        return std::max<uint64_t>(1 << 20, budgetBytes / NUM_PARTITIONS);
+    }
+
+    void add(Side & side, std::shared_ptr<PipelineResults> row)
+    {
+        side.bufferBytes += rowMemUsage(*row);
+        side.buffer.emplace_back(std::move(row));
+        if (side.bufferBytes >= flushThreshold())
+            flush(side);
+    }
+
+    void addBuild(std::shared_ptr<PipelineResults> row)
+    {
+        if (!buildProto)
+            buildProto = row;
+        uint64_t hash = row->values.back().getColumn(0, GET_ALL).hash();
+        add(work[partitionOf(hash, 0)].build, std::move(row));
+    }
+
+    void addProbe(std::shared_ptr<PipelineResults> row)
+    {
+        if (!probeProto)
+            probeProto = row;
+        uint64_t hash = row->values.back().getColumn(0, GET_ALL).hash();
+        add(work[partitionOf(hash, 0)].probe, std::move(row));
+    }
+
+    /** Write the buffered rows of a side out as one frozen run. */
+    void flush(Side & side)
+    {
+        if (side.buffer.empty())
+            return;
+
+        uint64_t totalBytes = 0;
+        auto measure = [&] (const CellValue & cell)
+            {
+                totalBytes += cell.serializedBytes(JOIN_SPILL_EXACT_BYTES);
+            };
+        for (auto & row: side.buffer)
+            encodePipelineRow(*row, measure);
+
+        MutableMemoryRegion region
+            = serializer.allocateWritable(totalBytes, 1 /* alignment */);
+
+        char * p = region.data();
+        char * end = p + totalBytes;
+        auto write = [&] (const CellValue & cell)
+            {
+                p = cell.serialize(p, end - p, JOIN_SPILL_EXACT_BYTES);
+                ExcAssert(p);
+            };
+        for (auto & row: side.buffer)
+            encodePipelineRow(*row, write);
+        ExcAssertEqual((const void *)p, (const void *)end);
+
+        side.runs.emplace_back(serializer.freeze(region), side.buffer.size());
+        side.totalBytes += side.bufferBytes;
+        side.buffer.clear();
+        side.bufferBytes = 0;
+    }
+
+    void finishSpill()
+    {
+        for (auto & partition: work) {
+            flush(partition.build);
+            flush(partition.probe);
+        }
+    }
+
+    /** Re-spread one oversized partition over a fresh set of children
+        using the next slice of hash bits. */
+    void split(Partition partition)
+    {
+        int salt = partition.salt + 1;
+        std::vector<Partition> children(NUM_PARTITIONS);
+        for (auto & child: children)
+            child.salt = salt;
+
+        auto repartition = [&] (Side & from, bool buildSide)
+            {
+                const PipelineResults & proto
+                    = buildSide ? *buildProto : *probeProto;
+                for (auto & run: from.runs) {
+                    const char * p = run.first.data();
+                    size_t remaining = run.first.length();
+                    for (size_t i = 0;  i < run.second;  ++i) {
+                        auto row = decodePipelineRow(proto, p, remaining);
+                        uint64_t hash = row->values.back()
+                            .getColumn(0, GET_ALL).hash();
+                        Partition & child
+                            = children[partitionOf(hash, salt)];
+                        add(buildSide ? child.build : child.probe,
+                            std::move(row));
+                    }
+                }
+            };
+        repartition(partition.build, true /* buildSide */);
+        repartition(partition.probe, false /* buildSide */);
+
+        for (auto & child: children) {
+            flush(child.build);
+            flush(child.probe);
+            work.emplace_back(std::move(child));
+        }
+    }
+
+    /** Move to the next partition pair that can produce matches,
+        splitting oversized ones, and rebuild the executor's hash table
+        over its build rows.  False once every partition is joined.
+    */
+    bool loadNext(HashJoinExecutor & exec)
+    {
+        while (!work.empty()) {
+            Partition partition = std::move(work.front());
+            work.pop_front();
+
+            // An inner join needs both sides present to match anything
+            if (partition.build.runs.empty() || partition.probe.runs.empty())
+                continue;
+
+            if (partition.build.totalBytes > budgetBytes
+                && partition.salt < MAX_SALT) {
+                split(std::move(partition));
+                continue;
+            }
+
+            exec.keyToBucket.clear();
+            exec.buckets.clear();
+            for (auto & run: partition.build.runs) {
+                const char * p = run.first.data();
+                size_t remaining = run.first.length();
+                for (size_t i = 0;  i < run.second;  ++i) {
+                    auto row = decodePipelineRow(*buildProto, p, remaining);
+                    ExpressionValue key
+                        = row->values.back().getColumn(0, GET_ALL);
+                    exec.insertBuildRow(std::move(key), std::move(row));
+                }
+            }
+
+            probeRuns = std::move(partition.probe.runs);
+            probeRun = 0;
+            probeRowsLeft = 0;
+            return true;
+        }
+        return false;
+    }
+
+    std::shared_ptr<PipelineResults> nextProbeRow()
+    {
+        while (probeRowsLeft == 0) {
+            if (probeRun >= probeRuns.size())
+                return nullptr;
+            probeP = probeRuns[probeRun].first.data();
+            probeRemaining = probeRuns[probeRun].first.length();
+            probeRowsLeft = probeRuns[probeRun].second;
+            ++probeRun;
+        }
+        --probeRowsLeft;
+        return decodePipelineRow(*probeProto, probeP, probeRemaining);
+    }
+};
+
+JoinElement::HashJoinExecutor::
+HashJoinExecutor(const Bound * parent,
+                 std::shared_ptr<ElementExecutor> root,
+                 std::shared_ptr<ElementExecutor> left,
+                 std::shared_ptr<ElementExecutor> right,
+                 size_t leftAdded,
+                 size_t rightAdded,
+                 bool buildLeft)
+    : parent(parent),
+      root(std::move(root)),
+      left(std::move(left)),
+      right(std::move(right)),
+      currentBucket(nullptr),
+      currentRow(0),
+      leftAdded(leftAdded),
+      rightAdded(rightAdded),
+      buildLeft(buildLeft),
+      buildBytes(0)
+{
+    buildHashTable();
+}
+
+void
+JoinElement::HashJoinExecutor::
+insertBuildRow(ExpressionValue key, std::shared_ptr<PipelineResults> row)
+{
+    uint64_t hash = key.hash();
+
+    auto it = keyToBucket.find(hash);
+    if (it == keyToBucket.end()) {
+        keyToBucket[hash] = buckets.size();
+        buckets.emplace_back(Bucket{std::move(key), {std::move(row)}, -1});
+        return;
+    }
+
+    // Walk the (normally unit-length) chain of buckets on this hash
+    int i = it->second;
+    while (!(buckets[i].key == key) && buckets[i].nextWithSameHash != -1)
+        i = buckets[i].nextWithSameHash;
+
+    if (buckets[i].key == key)
+        buckets[i].rows.emplace_back(std::move(row));
+    else {
+        buckets[i].nextWithSameHash = buckets.size();
+        buckets.emplace_back(Bucket{std::move(key), {std::move(row)}, -1});
+    }
+}
+
+void
+JoinElement::HashJoinExecutor::
+buildHashTable()
+{
+    keyToBucket.clear();
+    buckets.clear();
+    grace.reset();
+    buildBytes = 0;
+
+    uint64_t budgetBytes
+        = (uint64_t)QUERY_JOIN_MEMORY_LIMIT_MB.get() << 20;
+
+    ElementExecutor & buildSide = buildLeft ? *left : *right;
+
+    std::shared_ptr<PipelineResults> row;
+    while ((row = buildSide.take())) {
+        const ExpressionValue & rEmbedding = row->values.back();
+
+        // A build row whose side condition is false can never join
+        if (!rEmbedding.getColumn(1, GET_ALL).isTrue())
+            continue;
+
+        ExpressionValue key = rEmbedding.getColumn(0, GET_ALL);
+        if (budgetBytes)
+            buildBytes += rowMemUsage(*row);
+        insertBuildRow(std::move(key), std::move(row));
+
+        if (!budgetBytes || buildBytes <= budgetBytes)
+            continue;
+
+        // Over budget: tip the rows collected so far into grace
+        // partitions on disk, spill the rest of both sides after them,
+        // and join partition pairs one at a time instead
+        grace = std::make_shared<Grace>(budgetBytes);
+
+        for (auto & bucket: buckets)
+            for (auto & brow: bucket.rows)
+                grace->addBuild(std::move(brow));
+        keyToBucket.clear();
+        buckets.clear();
+        buildBytes = 0;
+
+        while ((row = buildSide.take())) {
+            if (!row->values.back().getColumn(1, GET_ALL).isTrue())
+                continue;
+            grace->addBuild(std::move(row));
+        }
+
+        ElementExecutor & probeSide = buildLeft ? *right : *left;
+        while ((row = probeSide.take())) {
+            if (!row->values.back().getColumn(1, GET_ALL).isTrue())
+                continue;
+            grace->addProbe(std::move(row));
+        }
+
+        grace->finishSpill();
+
+        // Table over the first joinable partition pair; when no
+        // partition has rows on both sides, nothing can ever match
+        grace->loadNext(*this);
+        return;
+    }
+}
+
+std::shared_ptr<PipelineResults>
+JoinElement::HashJoinExecutor::
+take()
+{
+    while (true) {
+
+        // Emit the remaining matches of the current probe row.  The
+        // output layout is always [left values..., right values...],
+        // whichever side the table was built over.
+        while (currentBucket && currentRow < currentBucket->rows.size()) {
+            const std::shared_ptr<PipelineResults> & brow
+                = currentBucket->rows[currentRow++];
+
+            const std::shared_ptr<PipelineResults> & lrow
+                = buildLeft ? brow : l;
+            const std::shared_ptr<PipelineResults> & rrow
+                = buildLeft ? l : brow;
+
+            // Return a copy, since the build row stays in the table
+            auto result = std::make_shared<PipelineResults>(*lrow);
+            // Pop the selected join conditions from left
+            result->values.pop_back();
+
+            for (size_t i = 0;  i < rightAdded;  ++i)
+                result->values.push_back(rrow->values[i]);
+
+            ExpressionValue storage;
+            if (parent->crossWhere_(*result, storage, GET_LATEST).isTrue())
+                return result;
+        }
+
+        currentBucket = nullptr;
+        currentRow = 0;
+
+        // On to the next probe row, skipping those whose side condition
+        // is false.  In grace mode the probe rows stream back from the
+        // current partition's spilled runs, rebuilding the table over
+        // the next partition pair whenever one runs dry.
+        if (grace) {
+            l = grace->nextProbeRow();
+            while (!l) {
+                if (!grace->loadNext(*this))
+                    return nullptr;
+                l = grace->nextProbeRow();
+            }
+        }
+        else {
+            ElementExecutor & probeSide = buildLeft ? *right : *left;
+            do {
+                l = probeSide.take();
+                if (!l)
+                    return nullptr;
+            } while (!l->values.back().getColumn(1, GET_ALL).isTrue());
+        }
+
+        ExpressionValue lField = l->values.back().getColumn(0, GET_ALL);
+
+        auto it = keyToBucket.find(lField.hash());
+        if (it == keyToBucket.end())
+            continue;
+
+        int i = it->second;
+        while (i != -1 && !(buckets[i].key == lField))
+            i = buckets[i].nextWithSameHash;
+        if (i == -1)
+            continue;
+
+        currentBucket = &buckets[i];
+    }
+}
+
+void
+JoinElement::HashJoinExecutor::
+restart()
+{
+    left->restart();
+    right->restart();
+    l.reset();
+    currentBucket = nullptr;
+    currentRow = 0;
+    buildHashTable();
+}
+
+
+/*****************************************************************************/
+/* RANGE JOIN EXECUTOR                                                       */
+/*****************************************************************************/
+
+JoinElement::RangeJoinExecutor::
+RangeJoinExecutor(const Bound * parent,
+                  std::shared_ptr<ElementExecutor> root,
+                  std::shared_ptr<ElementExecutor> left,
+                  std::shared_ptr<ElementExecutor> right,
+                  size_t leftAdded,
+                  size_t rightAdded)
+    : parent(parent),
+      root(std::move(root)),
+      left(std::move(left)),
+      right(std::move(right)),
+      currentActive(0),
+      leftAdded(leftAdded),
+      rightAdded(rightAdded)
+{
+    r = this->right->take();
+}
+
+std::shared_ptr<PipelineResults>
+JoinElement::RangeJoinExecutor::
+take()
+{
+    while (true) {
+
+        // Pair the current probe row with the windows that cover it.
+        // crossWhere_ re-checks the exact range condition, which also
+        // takes care of strict bounds and of null values: the sweep
+        // only ever produces a superset of the matching pairs.
+        while (l && currentActive < active.size()) {
+            const std::shared_ptr<PipelineResults> & rrow
+                = active[currentActive++];
+
+            // Return a copy, since the right row stays in the active list
+            auto result = std::make_shared<PipelineResults>(*l);
+            // Pop the selected join conditions from left
+            result->values.pop_back();
+
+            for (size_t i = 0;  i < rightAdded;  ++i)
+                result->values.push_back(rrow->values[i]);
+
+            ExpressionValue storage;
+            if (parent->crossWhere_(*result, storage, GET_LATEST).isTrue())
+                return result;
+        }
+
+        // On to the next probe row, skipping those whose side condition
+        // is false
+        do {
+            l = left->take();
+            if (!l)
+                return nullptr;
+        } while (!l->values.back().getColumn(1, GET_ALL).isTrue());
+
+        ExpressionValue probe = l->values.back().getColumn(0, GET_ALL);
+
+        // Admit the windows that have opened (lower bound not past the
+        // probe).  Both sides arrive sorted, so each right row is
+        // admitted exactly once.
+        while (r && !(probe < r->values.back().getColumn(0, GET_ALL))) {
+            if (r->values.back().getColumn(1, GET_ALL).isTrue())
+                active.emplace_back(std::move(r));
+            r = right->take();
+        }
+
+        // Retire the windows that have closed (upper bound before the
+        // probe); probe values only increase, so these can never match
+        // again
+        auto closed = [&] (const std::shared_ptr<PipelineResults> & rrow)
+            {
+                return rrow->values.back().getColumn(2, GET_ALL) < probe;
+            };
+        active.erase(std::remove_if(active.begin(), active.end(), closed),
+                     active.end());
+
+        currentActive = 0;
+    }
+}
+
+void
+JoinElement::RangeJoinExecutor::
+restart()
+{
+    left->restart();
+    right->restart();
+    l.reset();
+    r = right->take();
+    active.clear();
+    currentActive = 0;
+}
+
+
 /*****************************************************************************/
 /* BOUND JOIN EXECUTOR                                                       */
 /*****************************************************************************/
@@ -1582,14 +2257,16 @@ Bound(std::shared_ptr<BoundPipelineElement> root,
       std::shared_ptr<BoundPipelineElement> left,
       std::shared_ptr<BoundPipelineElement> right,
       AnnotatedJoinCondition condition,
-      JoinQualification joinQualification)
+      JoinQualification joinQualification,
+      bool buildHashTableOnLeft)
     : root_(std::move(root)),
       left_(std::move(left)),
       right_(std::move(right)),
       outputScope_(createOutputScope()),
       crossWhere_(condition.crossWhere->bind(*outputScope_)),
       condition_(std::move(condition)),
-      joinQualification_(joinQualification)
+      joinQualification_(joinQualification),
+      buildHashTableOnLeft_(buildHashTableOnLeft)
 {
 }
 
@@ -1657,6 +2334,19 @@ start(const BoundParameters & getParam) const
     }
 
     case AnnotatedJoinCondition::EQUIJOIN:
+        // Inner joins have no ordering obligations towards unmatched
+        // rows, so they can use the hash join; outer joins keep the
+        // merge-style scan.
+        if (joinQualification_ == JOIN_INNER) {
+            return std::make_shared<HashJoinExecutor>
+                (this,
+                 root_->start(getParam),
+                 left_->start(getParam),
+                 right_->start(getParam),
+                 leftAdded,
+                 rightAdded,
+                 buildHashTableOnLeft_);
+        }
         return std::make_shared<EquiJoinExecutor>
             (this,
              root_->start(getParam),
@@ -1665,6 +2355,17 @@ start(const BoundParameters & getParam) const
              leftAdded,
              rightAdded);
 
+    case AnnotatedJoinCondition::RANGE_JOIN:
+        // Only detected for inner joins
+        ExcAssert(joinQualification_ == JOIN_INNER);
+        return std::make_shared<RangeJoinExecutor>
+            (this,
+             root_->start(getParam),
+             left_->start(getParam),
+             right_->start(getParam),
+             leftAdded,
+             rightAdded);
+
     default:
         throw AnnotatedException(400, "Can't execute that kind of join",
                                   "condition", condition_);
@@ -1953,20 +2654,38 @@ take()
         // If nothing left to give, then return an empty vector
         if (!input)
             return input;
-                
-        // Evaluate the where expression...
-        ExpressionValue storage;
-        const ExpressionValue & pass = parent_->where_(*input, storage, GET_LATEST);
-                
-        // If it doesn't evaluate to true, then on to the next row
-        if (!pass.isTrue())
-            continue;
 
-        // Otherwise, we have our result
-        return input;
+        std::shared_ptr<PipelineResults> output
+            = processPartitioned(std::move(input));
+
+        // If it was filtered out, then on to the next row
+        if (output)
+            return output;
     }
 }
 
+ElementExecutor *
+FilterWhereElement::Executor::
+partitionedSource() const
+{
+    return source_.get();
+}
+
+std::shared_ptr<PipelineResults>
+FilterWhereElement::Executor::
+processPartitioned(std::shared_ptr<PipelineResults> input) const
+{
+    // Evaluate the where expression...
+    ExpressionValue storage;
+    const ExpressionValue & pass = parent_->where_(*input, storage, GET_LATEST);
+
+    // If it doesn't evaluate to true, then the row is filtered out
+    if (!pass.isTrue())
+        return nullptr;
+
+    return input;
+}
+
 void
 FilterWhereElement::Executor::
 restart()
@@ -2048,20 +2767,32 @@ std::shared_ptr<PipelineResults>
 SelectElement::Executor::
 take()
 {
-    while (true) {
-        std::shared_ptr<PipelineResults> input = source->take();
+    std::shared_ptr<PipelineResults> input = source->take();
 
-        // If nothing left to give, then return an empty vector
-        if (!input)
-            return input;
+    // If nothing left to give, then return an empty vector
+    if (!input)
+        return input;
 
-        // Run the select expression in this input's context
-        ExpressionValue selected = parent->select_(*input, GET_ALL);
+    return processPartitioned(std::move(input));
+}
 
-        input->values.emplace_back(std::move(selected));
+ElementExecutor *
+SelectElement::Executor::
+partitionedSource() const
+{
+    return source.get();
+}
 
-        return input;
-    }
+std::shared_ptr<PipelineResults>
+SelectElement::Executor::
+processPartitioned(std::shared_ptr<PipelineResults> input) const
+{
+    // Run the select expression in this input's context
+    ExpressionValue selected = parent->select_(*input, GET_ALL);
+
+    input->values.emplace_back(std::move(selected));
+
+    return input;
 }
 
 void
@@ -2510,6 +3241,338 @@ outputScope() const
 }
 
 
+/*****************************************************************************/
+/* WINDOW LEXICAL SCOPE                                                      */
+/*****************************************************************************/
+
+WindowLexicalScope::
+WindowLexicalScope(std::shared_ptr<PipelineExpressionScope> inner,
+                   std::shared_ptr<std::vector<WindowCall> > calls,
+                   size_t numCalls)
+    : inner(std::move(inner)), calls(std::move(calls)), numCalls_(numCalls)
+{
+}
+
+ColumnGetter
+WindowLexicalScope::
+doGetColumn(const ColumnPath & columnName, int fieldOffset)
+{
+    // Columns pass through to the scope underneath
+    return inner->doGetColumn(Utf8String(), columnName);
+}
+
+GetAllColumnsOutput
+WindowLexicalScope::
+doGetAllColumns(const Utf8String & tableName,
+                const ColumnFilter& keep,
+                int fieldOffset)
+{
+    // Window outputs are only addressable through their function call,
+    // so a wildcard sees exactly what it would without the window
+    return inner->doGetAllColumns(tableName, keep);
+}
+
+BoundFunction
+WindowLexicalScope::
+doGetFunction(const Utf8String & functionName,
+              const std::vector<BoundSqlExpression> & args,
+              int fieldOffset,
+              SqlBindingScope & argScope)
+{
+    if (!WindowElement::isWindowFunction(functionName))
+        return inner->doGetFunction(Utf8String(), functionName, args,
+                                    argScope);
+
+    if (args.empty())
+        throw AnnotatedException
+            (400, "window function '" + functionName
+             + "' requires a value argument");
+
+    int64_t distance = 1;
+    if (functionName == "rolling_sum") {
+        if (args.size() != 2)
+            throw AnnotatedException
+                (400, "rolling_sum requires a value and a frame width, "
+                 "eg rolling_sum(x, 10)");
+    }
+    else if (args.size() > 2) {
+        throw AnnotatedException
+            (400, "window function '" + functionName
+             + "' takes a value and an optional row distance");
+    }
+
+    if (args.size() == 2) {
+        if (!args[1].expr->isConstant())
+            throw AnnotatedException
+                (400, "the distance argument of window function '"
+                 + functionName + "' must be constant");
+        distance = args[1].expr->constantValue().toInt();
+        if (distance < 1)
+            throw AnnotatedException
+                (400, "the distance argument of window function '"
+                 + functionName + "' must be at least one");
+    }
+
+    if (calls->size() == numCalls_)
+        throw AnnotatedException
+            (400, "window function '" + functionName
+             + "' is only supported in the SELECT expression");
+
+    // Register the call site with the element; the executor fills the
+    // slot and we simply read it back for the current row
+    size_t index = calls->size();
+    calls->push_back({functionName, args[0], distance});
+
+    auto info = functionName == "rolling_sum"
+        ? std::shared_ptr<ExpressionValueInfo>
+            (std::make_shared<Float64ValueInfo>())
+        : args[0].info;
+
+    auto exec = [=] (const std::vector<ExpressionValue> & argValues,
+                     const SqlRowScope & rowScope) -> ExpressionValue
+        {
+            auto & row = rowScope.as<PipelineResults>();
+            return row.values.at(fieldOffset + index);
+        };
+
+    return { exec, info };
+}
+
+Utf8String
+WindowLexicalScope::
+as() const
+{
+    return Utf8String();
+}
+
+std::vector<std::shared_ptr<ExpressionValueInfo> >
+WindowLexicalScope::
+outputAdded() const
+{
+    // The call sites are only discovered once the expressions above are
+    // bound, so declare every slot with an open type
+    return std::vector<std::shared_ptr<ExpressionValueInfo> >
+        (numCalls_, std::make_shared<AnyValueInfo>());
+}
+
+
+/*****************************************************************************/
+/* WINDOW ELEMENT                                                            */
+/*****************************************************************************/
+
+WindowElement::
+WindowElement(std::shared_ptr<PipelineElement> source,
+              size_t numCalls)
+    : source(std::move(source)), numCalls(numCalls)
+{
+}
+
+bool
+WindowElement::
+isWindowFunction(const Utf8String & functionName)
+{
+    return functionName == "lag"
+        || functionName == "lead"
+        || functionName == "rolling_sum";
+}
+
+size_t
+WindowElement::
+countWindowCalls(const SelectExpression & select)
+{
+    std::function<size_t (const SqlExpression &)> count
+        = [&] (const SqlExpression & expr) -> size_t
+        {
+            size_t result = 0;
+            auto call = dynamic_cast<const FunctionCallExpression *>(&expr);
+            if (call && call->tableName.empty()
+                && isWindowFunction(call->functionName))
+                result += 1;
+            for (auto & child: expr.getChildren())
+                result += count(*child);
+            return result;
+        };
+
+    return count(select);
+}
+
+std::shared_ptr<BoundPipelineElement>
+WindowElement::
+bind() const
+{
+    return std::make_shared<Bound>(source->bind(), numCalls);
+}
+
+
+/*****************************************************************************/
+/* WINDOW ELEMENT EXECUTOR                                                   */
+/*****************************************************************************/
+
+WindowElement::Executor::
+Executor(const Bound * parent,
+         std::shared_ptr<ElementExecutor> source)
+    : parent(parent), source(std::move(source)), numDone(-1)
+{
+}
+
+void
+WindowElement::Executor::
+computeWindows()
+{
+    // Materialize the (already sorted) input; window frames are defined
+    // over the statement's ORDER BY order
+    while (true) {
+        std::shared_ptr<PipelineResults> input = source->take();
+        if (!input)
+            break;
+        rows.emplace_back(std::move(input));
+    }
+
+    const std::vector<WindowCall> & calls = *parent->calls_;
+    ExcAssertEqual(calls.size(), parent->numCalls_);
+
+    size_t n = rows.size();
+
+    for (const WindowCall & call: calls) {
+
+        // Evaluate the value expression once per row, in frame order
+        std::vector<ExpressionValue> vals(n);
+        for (size_t i = 0;  i < n;  ++i)
+            vals[i] = call.value(*rows[i], GET_LATEST);
+
+        if (call.functionName == "lag") {
+            for (size_t i = 0;  i < n;  ++i)
+                rows[i]->values.emplace_back
+                    (i >= (size_t)call.distance
+                     ? vals[i - call.distance]
+                     : ExpressionValue::null(Date::notADate()));
+        }
+        else if (call.functionName == "lead") {
+            for (size_t i = 0;  i < n;  ++i)
+                rows[i]->values.emplace_back
+                    (i + call.distance < n
+                     ? vals[i + call.distance]
+                     : ExpressionValue::null(Date::notADate()));
+        }
+        else if (call.functionName == "rolling_sum") {
+            // Single pass with a running sum over the trailing frame.
+            // Non-numeric and null values occupy their frame position
+            // but don't contribute.  Timestamps take the max over the
+            // frame, tracked with a monotonic deque.
+            double sum = 0.0;
+            size_t numeric = 0;
+            std::deque<std::pair<size_t, Date> > maxTs;
+
+            auto numericValue = [] (const ExpressionValue & v,
+                                    double & out)
+                {
+                    if (v.empty() || !v.isAtom())
+                        return false;
+                    const CellValue & atom = v.getAtom();
+                    if (!atom.isNumber())
+                        return false;
+                    out = atom.toDouble();
+                    return true;
+                };
+
+            for (size_t i = 0;  i < n;  ++i) {
+                double d;
+                if (numericValue(vals[i], d)) {
+                    sum += d;
+                    numeric += 1;
+                    Date ts = vals[i].getEffectiveTimestamp();
+                    while (!maxTs.empty() && maxTs.back().second <= ts)
+                        maxTs.pop_back();
+                    maxTs.emplace_back(i, ts);
+                }
+
+                if (i >= (size_t)call.distance) {
+                    size_t evicted = i - call.distance;
+                    if (numericValue(vals[evicted], d)) {
+                        sum -= d;
+                        numeric -= 1;
+                    }
+                    if (!maxTs.empty() && maxTs.front().first == evicted)
+                        maxTs.pop_front();
+                }
+
+                rows[i]->values.emplace_back
+                    (numeric > 0
+                     ? ExpressionValue(sum, maxTs.front().second)
+                     : ExpressionValue::null(Date::notADate()));
+            }
+        }
+        else {
+            throw AnnotatedException
+                (500, "unknown window function '" + call.functionName + "'");
+        }
+    }
+
+    numDone = 0;
+}
+
+std::shared_ptr<PipelineResults>
+WindowElement::Executor::
+take()
+{
+    if (numDone == -1)
+        computeWindows();
+
+    if (numDone == rows.size()) {
+        rows.clear();
+        return nullptr;
+    }
+
+    return rows[numDone++];
+}
+
+void
+WindowElement::Executor::
+restart()
+{
+    // Don't recompute the windows...
+    numDone = 0;
+}
+
+
+/*****************************************************************************/
+/* BOUND WINDOW ELEMENT                                                      */
+/*****************************************************************************/
+
+WindowElement::Bound::
+Bound(std::shared_ptr<BoundPipelineElement> source,
+      size_t numCalls)
+    : source_(std::move(source)),
+      calls_(std::make_shared<std::vector<WindowCall> >()),
+      outputScope_(source_->outputScope()
+                   ->tableScope(std::make_shared<WindowLexicalScope>
+                                (source_->outputScope(), calls_, numCalls))),
+      numCalls_(numCalls)
+{
+}
+
+std::shared_ptr<ElementExecutor>
+WindowElement::Bound::
+start(const BoundParameters & getParam) const
+{
+    return std::make_shared<Executor>(this, source_->start(getParam));
+}
+
+std::shared_ptr<BoundPipelineElement>
+WindowElement::Bound::
+boundSource() const
+{
+    return source_;
+}
+
+std::shared_ptr<PipelineExpressionScope>
+WindowElement::Bound::
+outputScope() const
+{
+    return outputScope_;
+}
+
+
 /*****************************************************************************/
 /* PARAMS ELEMENT                                                            */
 /*****************************************************************************/
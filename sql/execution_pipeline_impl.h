@@ -10,6 +10,7 @@
 #include "execution_pipeline.h"
 #include "join_utils.h"
 #include "mldb/utils/log_fwd.h"
+#include "mldb/utils/lightweight_hash.h"
 #include <list>
 
 
@@ -326,6 +327,12 @@ struct JoinElement: public PipelineElement {
     AnnotatedJoinCondition condition;
     JoinQualification joinQualification;
 
+    /** For the hash join: build the table over the left side instead of
+        the right.  Chosen from the row counts of the two sides when both
+        are known, since the build side must fit in memory.
+    */
+    bool buildHashTableOnLeft;
+
     std::shared_ptr<PipelineElement> leftImpl;
     std::shared_ptr<PipelineElement> rightImpl;
 
@@ -424,6 +431,111 @@ struct JoinElement: public PipelineElement {
         virtual void restart();
     };
 
+    /** Execution builds a hash table over the right side, keyed on the
+        pivot value, and then streams the left side through it probing
+        for matches.  Complexity is O(left rows) + O(right rows)
+        regardless of how the pivot values are distributed, but the
+        whole build side must fit in memory, so when the row counts of
+        both sides are known the smaller one is built (eg, a dimension
+        table joined against a fact table).  Used for inner equi-joins;
+        outer joins need the ordered scan of the EquiJoinExecutor to
+        emit unmatched rows.
+    */
+    struct HashJoinExecutor: public ElementExecutor {
+        HashJoinExecutor(const Bound * parent,
+                         std::shared_ptr<ElementExecutor> root,
+                         std::shared_ptr<ElementExecutor> left,
+                         std::shared_ptr<ElementExecutor> right,
+                         size_t leftAdded,
+                         size_t rightAdded,
+                         bool buildLeft);
+
+        const Bound * parent;
+        std::shared_ptr<ElementExecutor> root, left, right;
+
+        /// All build-side rows sharing a pivot value, in side order
+        struct Bucket {
+            ExpressionValue key;
+            std::vector<std::shared_ptr<PipelineResults> > rows;
+            int nextWithSameHash;  ///< chains 64 bit hash collisions
+        };
+
+        /// Hash of the pivot value -> index of its first bucket
+        LightweightHash<uint64_t, int> keyToBucket;
+        std::vector<Bucket> buckets;
+
+        /// Current probe row and the bucket of build rows it matches
+        std::shared_ptr<PipelineResults> l;
+        const Bucket * currentBucket;
+        size_t currentRow;
+
+        const size_t leftAdded, rightAdded;
+
+        /// True to build the table over the left side and probe with
+        /// the right, rather than the reverse
+        const bool buildLeft;
+
+        /// Approximate bytes pinned by the in-memory build rows,
+        /// compared against the join memory budget
+        uint64_t buildBytes;
+
+        /** Grace-hash spill state, engaged when the build side grows
+            past the join memory budget: both sides are partitioned by
+            key hash into temporary-file runs and the partitions joined
+            one at a time, re-splitting any partition whose build side
+            still doesn't fit.  Null while the join fits in memory.
+        */
+        struct Grace;
+        std::shared_ptr<Grace> grace;
+
+        void buildHashTable();
+        void insertBuildRow(ExpressionValue key,
+                            std::shared_ptr<PipelineResults> row);
+
+        virtual std::shared_ptr<PipelineResults> take();
+
+        virtual void restart();
+    };
+
+    /** Execution sweeps both sides in order: the left side sorted by the
+        probed expression and the right side by the lower bound of its
+        window.  An active-window list holds the right rows whose window
+        can still cover the current probe value; each left row is paired
+        against only those, with the cross where condition re-checking
+        the exact bounds.  Complexity is O(left rows) + O(right rows) +
+        O(matches) when windows overlap little, instead of the
+        O(left rows) * O(right rows) of the cross join with filter.  The
+        canonical example is `SELECT * FROM e JOIN w ON e.ts BETWEEN
+        w.start AND w.end`.  Used for inner joins only.
+    */
+    struct RangeJoinExecutor: public ElementExecutor {
+        RangeJoinExecutor(const Bound * parent,
+                          std::shared_ptr<ElementExecutor> root,
+                          std::shared_ptr<ElementExecutor> left,
+                          std::shared_ptr<ElementExecutor> right,
+                          size_t leftAdded,
+                          size_t rightAdded);
+
+        const Bound * parent;
+        std::shared_ptr<ElementExecutor> root, left, right;
+
+        /// Current probe row, and the next right row not yet admitted
+        std::shared_ptr<PipelineResults> l, r;
+
+        /// Right rows whose window can still cover the current or a
+        /// later probe value, in window start order
+        std::vector<std::shared_ptr<PipelineResults> > active;
+
+        /// Next entry of the active list to pair with the current probe
+        size_t currentActive;
+
+        const size_t leftAdded, rightAdded;
+
+        virtual std::shared_ptr<PipelineResults> take();
+
+        virtual void restart();
+    };
+
     struct Bound: public BoundPipelineElement {
 
         /** Bind this in.  The main difficulty is with the output scope, which
@@ -434,7 +546,8 @@ struct JoinElement: public PipelineElement {
               std::shared_ptr<BoundPipelineElement> left,
               std::shared_ptr<BoundPipelineElement> right,
               AnnotatedJoinCondition condition,
-              JoinQualification joinQualification);
+              JoinQualification joinQualification,
+              bool buildHashTableOnLeft = false);
 
         std::shared_ptr<BoundPipelineElement> root_;
         std::shared_ptr<BoundPipelineElement> left_;
@@ -443,6 +556,7 @@ struct JoinElement: public PipelineElement {
         BoundSqlExpression crossWhere_;
         AnnotatedJoinCondition condition_;
         JoinQualification joinQualification_;
+        bool buildHashTableOnLeft_;
 
         /** Our output scope has:
             - The left and right tables
@@ -569,6 +683,11 @@ struct FilterWhereElement: public PipelineElement {
 
         virtual std::shared_ptr<PipelineResults> take();
 
+        virtual ElementExecutor * partitionedSource() const;
+
+        virtual std::shared_ptr<PipelineResults>
+        processPartitioned(std::shared_ptr<PipelineResults> input) const;
+
         virtual void restart();
     };
 
@@ -623,6 +742,11 @@ struct SelectElement: public PipelineElement {
 
         virtual std::shared_ptr<PipelineResults> take();
 
+        virtual ElementExecutor * partitionedSource() const;
+
+        virtual std::shared_ptr<PipelineResults>
+        processPartitioned(std::shared_ptr<PipelineResults> input) const;
+
         virtual void restart();
     };
 
@@ -808,6 +932,128 @@ struct PartitionElement: public PipelineElement {
 };
 
 
+/*****************************************************************************/
+/* WINDOW LEXICAL SCOPE                                                      */
+/*****************************************************************************/
+
+/** One window function call site found while binding the expressions
+    above a WindowElement.  The value expression is evaluated per input
+    row by the element's executor, and the result of the call is stored
+    at slot index within the values the element appends to each row.
+*/
+struct WindowCall {
+    Utf8String functionName;   ///< lag, lead or rolling_sum
+    BoundSqlExpression value;  ///< value expression of the call
+    int64_t distance;          ///< rows back/forward, or frame width
+};
+
+/** Scope introduced by a WindowElement.  Columns and ordinary functions
+    pass through to the underlying scope; the window functions register
+    their call site with the element and read back the value it computed
+    for the current row.
+*/
+struct WindowLexicalScope: public LexicalScope {
+
+    WindowLexicalScope(std::shared_ptr<PipelineExpressionScope> inner,
+                       std::shared_ptr<std::vector<WindowCall> > calls,
+                       size_t numCalls);
+
+    std::shared_ptr<PipelineExpressionScope> inner;
+    std::shared_ptr<std::vector<WindowCall> > calls;
+    size_t numCalls_;
+
+    virtual ColumnGetter
+    doGetColumn(const ColumnPath & columnName, int fieldOffset);
+
+    virtual GetAllColumnsOutput
+    doGetAllColumns(const Utf8String & tableName,
+                    const ColumnFilter& keep,
+                    int fieldOffset);
+
+    virtual BoundFunction
+    doGetFunction(const Utf8String & functionName,
+                  const std::vector<BoundSqlExpression> & args,
+                  int fieldOffset,
+                  SqlBindingScope & argsScope);
+
+    /** Window scopes aren't addressable by name. */
+    virtual Utf8String as() const;
+
+    /** One output slot per window call site. */
+    virtual std::vector<std::shared_ptr<ExpressionValueInfo> >
+    outputAdded() const;
+};
+
+
+/*****************************************************************************/
+/* WINDOW ELEMENT                                                            */
+/*****************************************************************************/
+
+/** Evaluates window function calls (lag, lead, rolling_sum) over the
+    ordered rows coming out of the sort element, in a single streaming
+    pass with a ring-buffer frame, and appends one value per call site
+    to each row.  The frame order is the statement's ORDER BY.
+*/
+struct WindowElement: public PipelineElement {
+    WindowElement(std::shared_ptr<PipelineElement> source,
+                  size_t numCalls);
+
+    /** Is this function name evaluated by the window element? */
+    static bool isWindowFunction(const Utf8String & functionName);
+
+    /** Count the window function call sites within the expression, so
+        the element can declare its output slots before the calls are
+        bound.
+    */
+    static size_t countWindowCalls(const SelectExpression & select);
+
+    std::shared_ptr<PipelineElement> source;
+    size_t numCalls;
+
+    struct Bound;
+
+    struct Executor: public ElementExecutor {
+        Executor(const Bound * parent,
+                 std::shared_ptr<ElementExecutor> source);
+
+        const Bound * parent;
+        std::shared_ptr<ElementExecutor> source;
+
+        std::vector<std::shared_ptr<PipelineResults> > rows;
+        ssize_t numDone;
+
+        virtual std::shared_ptr<PipelineResults> take();
+
+        virtual void restart();
+
+    private:
+        void computeWindows();
+    };
+
+    struct Bound: public BoundPipelineElement {
+
+        Bound(std::shared_ptr<BoundPipelineElement> source,
+              size_t numCalls);
+
+        std::shared_ptr<BoundPipelineElement> source_;
+        std::shared_ptr<std::vector<WindowCall> > calls_;
+        std::shared_ptr<PipelineExpressionScope> outputScope_;
+        size_t numCalls_;
+
+        std::shared_ptr<ElementExecutor>
+        start(const BoundParameters & getParam) const;
+
+        virtual std::shared_ptr<BoundPipelineElement>
+        boundSource() const;
+
+        virtual std::shared_ptr<PipelineExpressionScope> outputScope() const;
+    };
+
+    std::shared_ptr<BoundPipelineElement>
+    bind() const;
+};
+
+
 /*****************************************************************************/
 /* PARAMS ELEMENT                                                            */
 /*****************************************************************************/
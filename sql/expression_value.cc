@@ -1611,7 +1611,9 @@ ExpressionValue(const Json::Value & val, Date timestamp)
 
     if (val.isObject()) {
         for (auto it = val.begin(), end = val.end();  it != end;  ++it) {
-            PathElement columnName(it.memberName());
+            const char * memberName = it.memberNameC();
+            PathElement columnName
+                = PathElement::intern(memberName, strlen(memberName));
             row.emplace_back(columnName, ExpressionValue(*it, timestamp));
         }
     }
@@ -1649,7 +1651,7 @@ parseJson(JsonParsingContext & context,
             {
                 const char * fieldName = context.fieldNamePtr();
                 out.emplace_back
-                    (PathElement(fieldName, strlen(fieldName)),
+                    (PathElement::intern(fieldName, strlen(fieldName)),
                  parseJson(context, timestamp, arrays));
             };
         context.forEachMember(onObjectField);
@@ -1785,6 +1787,97 @@ flattenLevel(RowValue::iterator first,
 };
 
 
+void
+RowValueSoA::
+sortByColumn()
+{
+    std::vector<uint32_t> order(columns.size());
+    for (size_t i = 0;  i < order.size();  ++i)
+        order[i] = i;
+
+    std::sort(order.begin(), order.end(),
+              [&] (uint32_t i1, uint32_t i2)
+              {
+                  return columns[i1] < columns[i2];
+              });
+
+    std::vector<Path> newColumns;
+    std::vector<CellValue> newValues;
+    std::vector<Date> newTimestamps;
+    newColumns.reserve(columns.size());
+    newValues.reserve(values.size());
+    newTimestamps.reserve(timestamps.size());
+
+    for (uint32_t i: order) {
+        newColumns.emplace_back(std::move(columns[i]));
+        newValues.emplace_back(std::move(values[i]));
+        newTimestamps.emplace_back(timestamps[i]);
+    }
+
+    columns = std::move(newColumns);
+    values = std::move(newValues);
+    timestamps = std::move(newTimestamps);
+}
+
+RowValue
+RowValueSoA::
+toRowValue() &&
+{
+    RowValue result;
+    result.reserve(columns.size());
+    for (size_t i = 0;  i < columns.size();  ++i) {
+        result.emplace_back(std::move(columns[i]),
+                            std::move(values[i]),
+                            timestamps[i]);
+    }
+    columns.clear();
+    values.clear();
+    timestamps.clear();
+    return result;
+}
+
+RowValueSoA
+RowValueSoA::
+fromRowValue(RowValue row)
+{
+    RowValueSoA result;
+    result.reserve(row.size());
+    for (auto & r: row) {
+        result.emplace_back(std::move(std::get<0>(r)),
+                            std::move(std::get<1>(r)),
+                            std::get<2>(r));
+    }
+    return result;
+}
+
+ExpressionValue::
+ExpressionValue(RowValueSoA row) noexcept
+    : type_(Type::NONE)
+{
+    // Same reconstitution as the RowValue constructor below, but the
+    // sortedness scan and the sort comparisons touch only the columns
+    // array, and sorting moves each value exactly once rather than
+    // shuffling whole (Path, CellValue, Date) tuples around.
+    bool isSorted = true;
+    for (size_t i = 1;  i < row.columns.size() && isSorted;  ++i) {
+        if (row.columns[i - 1] > row.columns[i])
+            isSorted = false;
+    }
+
+    if (!isSorted)
+        row.sortByColumn();
+
+    // Materialize the legacy layout in sorted order for the
+    // structuring pass, which works on ranges of tuples
+    RowValue flat = std::move(row).toRowValue();
+
+    auto topLevel = flattenLevel(flat.begin(), flat.end(), 0 /* level */);
+
+    initStructured(std::move(topLevel.first),
+                   false /* needs sorting */,
+                   topLevel.second /* has duplicates */);
+}
+
 ExpressionValue::
 ExpressionValue(RowValue row) noexcept
 : type_(Type::NONE)
@@ -1959,7 +2052,7 @@ ExpressionValue(std::vector<CellValue> values,
 {
     ExcAssertEqual(values.size(), (*cols).size());
 
-    RowValue row;
+    RowValueSoA row;
     row.reserve(cols->size());
     for (size_t i = 0;  i < cols->size();  ++i) {
         row.emplace_back(cols->at(i), std::move(values[i]), ts);
@@ -1977,7 +2070,7 @@ ExpressionValue(const std::vector<double> & values,
 {
     ExcAssertEqual(values.size(), (*cols).size());
 
-    RowValue row;
+    RowValueSoA row;
     row.reserve(cols->size());
     for (size_t i = 0;  i < cols->size();  ++i) {
         row.emplace_back(cols->at(i), values[i], ts);
@@ -2166,6 +2259,17 @@ getEmbeddingType() const
     throw AnnotatedException(500, "Querying embedding type on non-embedding value");
 }
 
+std::pair<std::shared_ptr<const void>, size_t>
+ExpressionValue::
+tryGetEmbeddingRaw(StorageType storageType) const
+{
+    if (type_ != Type::EMBEDDING
+        || embedding_->storageType_ != storageType)
+        return { nullptr, 0 };
+
+    return { embedding_->data_, embedding_->length() };
+}
+
 ExpressionValue
 ExpressionValue::
 superpose(std::vector<ExpressionValue> vals)
@@ -2906,6 +3010,18 @@ distribution<float, std::vector<float> >
 ExpressionValue::
 getEmbedding(ssize_t knownLength) const
 {
+    // Fast path: already stored as contiguous floats; copy once rather
+    // than converting through doubles and back.
+    auto span = tryGetEmbeddingSpan<float>();
+    if (span.first) {
+        if (knownLength != -1 && span.second != (size_t)knownLength)
+            throw AnnotatedException
+                (400, Utf8String("Expected ") + to_string(knownLength)
+                 + " elements in embedding, got " + to_string(span.second));
+        return distribution<float>(span.first.get(),
+                                   span.first.get() + span.second);
+    }
+
     return getEmbeddingDouble(knownLength).cast<float>();
 }
 
@@ -3082,6 +3198,18 @@ distribution<double, std::vector<double> >
 ExpressionValue::
 getEmbeddingDouble(ssize_t knownLength) const
 {
+    // Fast path: already stored as contiguous doubles; skip the
+    // per-atom iteration below.
+    auto span = tryGetEmbeddingSpan<double>();
+    if (span.first) {
+        if (knownLength != -1 && span.second != (size_t)knownLength)
+            throw AnnotatedException
+                (400, Utf8String("Expected ") + to_string(knownLength)
+                 + " elements in embedding, got " + to_string(span.second));
+        return distribution<double>(span.first.get(),
+                                    span.first.get() + span.second);
+    }
+
     // TODO: this is inefficient.  We should be able to have the
     // info function return us one that does it much more
     // efficiently.
@@ -42,6 +42,49 @@ struct EmbeddingValueInfo;
 /** A row in an expression value is a set of (key, atom, timestamp) pairs. */
 typedef std::vector<std::tuple<Path, CellValue, Date> > RowValue;
 
+/** Structure-of-arrays version of RowValue: parallel arrays of columns,
+    values and timestamps sharing one length.  Assembling rows here
+    rather than in a vector of tuples keeps the columns (the only field
+    that row structuring compares and sorts on) contiguous in memory,
+    and sorting permutes each array with one move per element instead
+    of shuffling whole tuples.  Convertible to the legacy layout at API
+    boundaries.
+*/
+struct RowValueSoA {
+    std::vector<Path> columns;
+    std::vector<CellValue> values;
+    std::vector<Date> timestamps;
+
+    size_t size() const { return columns.size(); }
+    bool empty() const { return columns.empty(); }
+
+    void reserve(size_t n)
+    {
+        columns.reserve(n);
+        values.reserve(n);
+        timestamps.reserve(n);
+    }
+
+    void emplace_back(Path column, CellValue value, Date ts)
+    {
+        columns.emplace_back(std::move(column));
+        values.emplace_back(std::move(value));
+        timestamps.emplace_back(ts);
+    }
+
+    /** Sort by column name.  Comparisons touch only the columns array;
+        the three arrays are then permuted with one move per element.
+    */
+    void sortByColumn();
+
+    /** Convert to the legacy array-of-tuples layout, leaving this
+        empty.  Used at API boundaries that still take a RowValue.
+    */
+    RowValue toRowValue() &&;
+
+    static RowValueSoA fromRowValue(RowValue row);
+};
+
 /** A struct in an expression value is a set of (key, value) pairs. */
 typedef std::vector<std::tuple<PathElement, ExpressionValue> > StructValue;
 
@@ -833,6 +876,7 @@ struct ExpressionValue {
 
     ExpressionValue(CellValue atom, Date ts) noexcept;
     ExpressionValue(RowValue row) noexcept;
+    ExpressionValue(RowValueSoA row) noexcept;
 
     enum Sorting {
         SORTED,
@@ -1086,6 +1130,33 @@ struct ExpressionValue {
     */
     StorageType getEmbeddingType() const;
 
+    /** Return a non-owning typed view over the embedding's underlying
+        storage, when the value is an embedding already stored
+        contiguously as type T.  The returned pointer shares ownership
+        of the storage, so it stays valid independently of the lifetime
+        of this object and no data is copied.
+
+        Returns {nullptr, 0} when the value is not an embedding or is
+        stored as a different type; callers should fall back to the
+        copying accessors (getEmbedding, convertEmbedding) in that case.
+    */
+    template<typename T>
+    std::pair<std::shared_ptr<const T>, size_t>
+    tryGetEmbeddingSpan() const
+    {
+        auto raw = tryGetEmbeddingRaw(GetStorageType<T>::val);
+        return { std::shared_ptr<const T>
+                     (raw.first, reinterpret_cast<const T *>(raw.first.get())),
+                 raw.second };
+    }
+
+    /** Type-erased implementation of tryGetEmbeddingSpan().  Returns
+        the shared storage and element count when this is an embedding
+        of exactly the given storage type, otherwise {nullptr, 0}.
+    */
+    std::pair<std::shared_ptr<const void>, size_t>
+    tryGetEmbeddingRaw(StorageType storageType) const;
+
     /** Iterate over the child expression, with an ExpressionValue at each
         level.  Note that if isRow() is false, than this function will
         NOT call the callback; it's only called for row-valued values.
@@ -407,7 +407,116 @@ AnnotatedJoinCondition(std::shared_ptr<TableExpression> leftTable,
             }
         }
 
-        if (style != EQUIJOIN) {
+        if (style != EQUIJOIN && joinQualification == JOIN_INNER) {
+            // No equality pivot.  Before we give up and fall back to a
+            // cross join with filter, look for an interval constraint of
+            // the form lower(right) <= probe(left) <= upper(right), as in
+            // `e.ts BETWEEN w.start AND w.end`, written either as a
+            // BETWEEN or as a pair of inequalities.  Such joins can be
+            // executed by sweeping both sides in probe order with an
+            // active-window list.  Only inner joins qualify: outer joins
+            // need the unmatched-row bookkeeping of the generic
+            // executors.
+
+            std::shared_ptr<SqlExpression> probeExpr, lowerExpr, upperExpr;
+
+            // One side of a range written as two inequalities: a bound
+            // on the right constraining a probed value on the left
+            struct HalfRange {
+                std::shared_ptr<SqlExpression> probe;
+                std::shared_ptr<SqlExpression> bound;
+                bool isUpper;
+            };
+            std::vector<HalfRange> halfRanges;
+
+            for (auto & c: crossConditions) {
+                if (probeExpr)
+                    break;
+
+                auto between
+                    = std::dynamic_pointer_cast<BetweenExpression>(c.expr);
+                if (between && !between->notBetween) {
+                    AnnotatedClause probeAnnotated(between->expr,
+                                                   leftTables, rightTables);
+                    AnnotatedClause lowerAnnotated(between->lower,
+                                                   leftTables, rightTables);
+                    AnnotatedClause upperAnnotated(between->upper,
+                                                   leftTables, rightTables);
+                    if (probeAnnotated.role == AnnotatedClause::LEFT
+                        && lowerAnnotated.role == AnnotatedClause::RIGHT
+                        && upperAnnotated.role == AnnotatedClause::RIGHT) {
+                        probeExpr = between->expr;
+                        lowerExpr = between->lower;
+                        upperExpr = between->upper;
+                    }
+                    continue;
+                }
+
+                auto cmpExpr
+                    = std::dynamic_pointer_cast<ComparisonExpression>(c.expr);
+                if (!cmpExpr)
+                    continue;
+                bool lessOp = cmpExpr->op == "<" || cmpExpr->op == "<=";
+                bool greaterOp = cmpExpr->op == ">" || cmpExpr->op == ">=";
+                if (!lessOp && !greaterOp)
+                    continue;
+
+                AnnotatedClause lhsAnnotated(cmpExpr->lhs,
+                                             leftTables, rightTables);
+                AnnotatedClause rhsAnnotated(cmpExpr->rhs,
+                                             leftTables, rightTables);
+
+                if (lhsAnnotated.role == AnnotatedClause::LEFT
+                    && rhsAnnotated.role == AnnotatedClause::RIGHT) {
+                    // probe OP bound: < or <= makes it an upper bound
+                    halfRanges.push_back({cmpExpr->lhs, cmpExpr->rhs,
+                                          lessOp});
+                }
+                else if (lhsAnnotated.role == AnnotatedClause::RIGHT
+                         && rhsAnnotated.role == AnnotatedClause::LEFT) {
+                    // bound OP probe: > or >= makes it an upper bound
+                    halfRanges.push_back({cmpExpr->rhs, cmpExpr->lhs,
+                                          greaterOp});
+                }
+            }
+
+            if (!probeExpr) {
+                // Pair a lower and an upper half-range over the same
+                // probed expression
+                for (size_t i = 0; i < halfRanges.size() && !probeExpr; ++i) {
+                    if (halfRanges[i].isUpper)
+                        continue;
+                    for (size_t j = 0; j < halfRanges.size(); ++j) {
+                        if (!halfRanges[j].isUpper)
+                            continue;
+                        if (halfRanges[i].probe->print()
+                            != halfRanges[j].probe->print())
+                            continue;
+                        probeExpr = halfRanges[i].probe;
+                        lowerExpr = halfRanges[i].bound;
+                        upperExpr = halfRanges[j].bound;
+                        break;
+                    }
+                }
+            }
+
+            if (probeExpr) {
+                // The left side is sorted by the probed value and the
+                // right side by the start of its window; the upper bound
+                // travels along with the right rows.  The range clauses
+                // stay in crossWhere, which re-checks the exact
+                // condition (including strict bounds) on each candidate
+                // pair.
+                style = RANGE_JOIN;
+                leftEqualExpression = probeExpr;
+                rightEqualExpression = lowerExpr;
+                rangeUpperExpression
+                    = removeTableNameFromExpression(*upperExpr,
+                                                    rightTable->getAs());
+            }
+        }
+
+        if (style != EQUIJOIN && style != RANGE_JOIN) {
             style = CROSS_JOIN;
             leftEqualExpression
                 = rightEqualExpression
@@ -507,6 +616,9 @@ AnnotatedJoinConditionDescription()
     addField("constantConditions", &AnnotatedJoinCondition::constantConditions,
              "Conditions involving neither side");
 
+    addField("rangeUpperExpression",
+             &AnnotatedJoinCondition::rangeUpperExpression,
+             "Upper bound of the right-side window for a range join");
     addField("crossWhere", &AnnotatedJoinCondition::crossWhere,
              "Filtered where expression for cross join");
     addField("constantWhere", &AnnotatedJoinCondition::constantWhere,
@@ -522,6 +634,8 @@ AnnotatedJoinConditionStyleDescription()
     addValue("EMPTY", AnnotatedJoinCondition::EMPTY, "Returns nothing");
     addValue("CROSS_JOIN", AnnotatedJoinCondition::CROSS_JOIN, "Cross-join");
     addValue("EQUIJOIN", AnnotatedJoinCondition::EQUIJOIN, "Join on equality");
+    addValue("RANGE_JOIN", AnnotatedJoinCondition::RANGE_JOIN,
+             "Join on a range over an ordered expression");
     addValue("UNKNOWN", AnnotatedJoinCondition::UNKNOWN, "Unknown join type");
 }
 
@@ -113,6 +113,7 @@ struct AnnotatedJoinCondition {
         EMPTY,        ///< Returns nothing
         CROSS_JOIN,   ///< Cross-join
         EQUIJOIN,     ///< Join on f(leftrow) = f(rightrow)
+        RANGE_JOIN,   ///< Join on g(rightrow) <= f(leftrow) <= h(rightrow)
         UNKNOWN       ///< Unknown join style; naive implementation
     };
 
@@ -173,6 +174,13 @@ struct AnnotatedJoinCondition {
     // Constant conditions, that don't depend on either row
     std::vector<AnnotatedClause> constantConditions;
 
+    /** For a RANGE_JOIN, the upper bound of the right-side window,
+        localized to the right table (the lower bound is the right side's
+        selectExpression, and the probed value is the left side's).
+        Null for the other styles.
+    */
+    std::shared_ptr<SqlExpression> rangeUpperExpression;
+
     /// Filter expression to apply AFTER the rows have been joined
     std::shared_ptr<SqlExpression> crossWhere;
 
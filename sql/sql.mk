@@ -32,6 +32,9 @@ SQL_EXPRESSION_SOURCES := \
 	execution_pipeline_impl.cc \
 	sql_utils.cc \
 	sql_expression_operations.cc \
+	sql_expression_cse.cc \
+	sql_expression_optimizer.cc \
+	sql_expression_vm.cc \
 	eval_sql.cc \
 	expression_value_conversions.cc \
 	expression_value_description.cc
@@ -41,7 +44,7 @@ SQL_EXPRESSION_SOURCES := \
 $(eval $(call set_compile_option,cell_value.cc builtin_geo_functions.cc,$(S2_COMPILE_OPTIONS) $(S2_WARNING_OPTIONS)))
 
 # NOTE: the SQL library should NOT depend on MLDB.  See the comment in testing/testing.mk
-$(eval $(call library,sql_expression,$(SQL_EXPRESSION_SOURCES),arch base types value_description vfs sql_types utils value_description any json_diff highwayhash hash s2 edlib log pffft easyexif progress magic))
+$(eval $(call library,sql_expression,$(SQL_EXPRESSION_SOURCES),arch base types value_description vfs sql_types utils value_description any json_diff highwayhash hash s2 edlib log pffft easyexif progress magic block))
 
 $(eval $(call include_sub_make,sql_testing,testing,sql_testing.mk))
 
@@ -20,6 +20,7 @@
 #include "mldb/types/pointer_description.h"
 #include "mldb/types/set_description.h"
 #include "sql_expression_operations.h"
+#include "sql_expression_optimizer.h"
 #include "table_expression_operations.h"
 #include "interval.h"
 #include "tokenize.h"
@@ -4330,6 +4331,13 @@ SelectStatement::parse(ParseContext& context, bool acceptUtf8)
         }
     }
 
+    // WHERE and HAVING are only ever evaluated for their truth value, so
+    // they can be algebraically simplified: constants folded, neutral
+    // boolean operands removed and BETWEEN turned into the range forms
+    // the row generators optimize
+    statement.where = optimizeBooleanExpression(statement.where);
+    statement.having = optimizeBooleanExpression(statement.having);
+
     statement.surface = MLDB::trim(token.captured());
 
     skip_whitespace(context);
@@ -78,6 +78,8 @@ struct BasicRowGenerator;
 struct WhenExpression;
 struct TableOperations;
 struct RowStream;
+struct MemoryArena;
+struct SqlExpressionCseCache;
 
 extern const OrderByExpression ORDER_BY_NOTHING;
 
@@ -890,6 +892,24 @@ struct SqlRowScope {
     {
     }
 
+    /** Optional scratch arena, set by the executor driving the query.
+        It is valid only while the current row is being processed: the
+        executor resets it between rows, so nothing allocated from it may
+        escape into the query output.  Evaluation code that needs per-row
+        temporary storage can draw from it (when non-null) to avoid
+        hitting the heap once per row.
+    */
+    MemoryArena * arena = nullptr;
+
+    /** Memoization slots for subexpressions shared by the bind-time CSE
+        pass (see sql_expression_cse.h); null unless the expression being
+        evaluated was bound with one.  Like the arena, it is only valid
+        for the current row: the bound expression that installs it removes
+        it before returning.  Mutable because evaluation only sees the
+        scope by const reference.
+    */
+    mutable SqlExpressionCseCache * cseCache = nullptr;
+
     /** In some circumstances, such as calling functions, we want to signal
         that there is no row available even though the functions require
         one to be passed.
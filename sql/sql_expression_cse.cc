@@ -0,0 +1,274 @@
+/** sql_expression_cse.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Bind-time common subexpression elimination for SQL expressions.
+*/
+
+#include "sql_expression_cse.h"
+#include "mldb/base/scope.h"
+
+#include <map>
+#include <set>
+
+using namespace std;
+
+
+namespace MLDB {
+
+namespace {
+
+/** Node types whose evaluation depends only on the current row and the
+    query parameters.  Anything else (in particular function calls, which
+    may be non-deterministic) makes the subtree unshareable.
+*/
+bool isCacheableType(const std::string & type)
+{
+    static const std::set<std::string> cacheableTypes = {
+        "arith", "compare", "bitwise", "boolean", "case", "between",
+        "type", "nottype", "cast", "variable", "constant", "param"
+    };
+
+    return cacheableTypes.count(type);
+}
+
+
+/*****************************************************************************/
+/* SHARED SUBEXPRESSION                                                      */
+/*****************************************************************************/
+
+/** Synthetic node standing in for one occurrence of a shared subtree.
+    All occurrences of the same subtree reference the same State and thus
+    the same memoization slot; whichever occurrence evaluates first for a
+    row fills the slot, and the others read it back.
+*/
+
+struct SharedSubexpression: public SqlExpression {
+
+    struct State {
+        size_t slot = 0;
+    };
+
+    SharedSubexpression(std::shared_ptr<SqlExpression> inner,
+                        std::shared_ptr<State> state)
+        : inner(std::move(inner)),
+          state(std::move(state))
+    {
+    }
+
+    std::shared_ptr<SqlExpression> inner;
+    std::shared_ptr<State> state;
+
+    virtual BoundSqlExpression bind(SqlBindingScope & scope) const override
+    {
+        BoundSqlExpression boundInner = inner->bind(scope);
+        size_t slot = state->slot;
+
+        auto exec = [=] (const SqlRowScope & row,
+                         ExpressionValue & storage,
+                         const VariableFilter & filter)
+            -> const ExpressionValue &
+            {
+                SqlExpressionCseCache * cache = row.cseCache;
+                if (!cache || slot >= cache->slots.size())
+                    return boundInner(row, storage, filter);
+
+                auto & s = cache->slots[slot];
+
+                if (!s.filled) {
+                    ExpressionValue innerStorage;
+                    const ExpressionValue & val
+                        = boundInner(row, innerStorage, filter);
+                    if (&val == &innerStorage)
+                        s.value = std::move(innerStorage);
+                    else s.value = val;
+                    s.filter = filter;
+                    s.filled = true;
+                }
+                else if (s.filter != filter) {
+                    // Cached under a different variable filter; leave the
+                    // slot alone and evaluate this occurrence directly
+                    return boundInner(row, storage, filter);
+                }
+
+                // Copy out of the slot: the cache only lives for the
+                // current row, so a reference into it must not escape
+                storage = s.value;
+                return storage;
+            };
+
+        return { std::move(exec), this, boundInner.info };
+    }
+
+    virtual Utf8String print() const override
+    {
+        return inner->print();
+    }
+
+    virtual std::shared_ptr<SqlExpression>
+    transform(const TransformArgs & transformArgs) const override
+    {
+        auto result = std::make_shared<SharedSubexpression>(*this);
+        auto newArgs = transformArgs({ inner });
+        result->inner = newArgs.at(0);
+        return result;
+    }
+
+    virtual std::string getType() const override
+    {
+        return "shared";
+    }
+
+    virtual Utf8String getOperation() const override
+    {
+        return Utf8String();
+    }
+
+    virtual std::vector<std::shared_ptr<SqlExpression> >
+    getChildren() const override
+    {
+        return { inner };
+    }
+};
+
+
+/*****************************************************************************/
+/* CSE PASS                                                                  */
+/*****************************************************************************/
+
+struct CsePass {
+
+    /// How often each cacheable compound subtree occurs, keyed on its
+    /// printed form
+    std::map<Utf8String, int> counts;
+
+    /// Shared state (and slot) per distinct shared subtree
+    std::map<Utf8String, std::shared_ptr<SharedSubexpression::State> > states;
+
+    size_t numSharedOccurrences = 0;
+
+    /** First pass: count cacheable compound subtrees.  Returns whether
+        the subtree rooted here is cacheable.
+    */
+    bool count(const SqlExpression & expr)
+    {
+        bool cacheable = isCacheableType(expr.getType());
+
+        auto children = expr.getChildren();
+        for (auto & c: children) {
+            if (!c)
+                continue;
+            if (!count(*c))
+                cacheable = false;
+        }
+
+        // Leaves (column reads, constants, parameters) are cheap enough
+        // that sharing them would cost more than re-evaluating
+        if (cacheable && !children.empty())
+            counts[expr.print()] += 1;
+
+        return cacheable;
+    }
+
+    /** Second pass: rebuild the tree, wrapping each occurrence of a
+        repeated cacheable subtree in a SharedSubexpression.  Children
+        are rewritten first so that nested sharing still works.
+    */
+    std::shared_ptr<SqlExpression>
+    rewriteChildren(const SqlExpression & expr)
+    {
+        TransformArgs doChildren = [&] (const std::vector<std::shared_ptr<SqlExpression> > & children)
+            {
+                std::vector<std::shared_ptr<SqlExpression> > result;
+                result.reserve(children.size());
+                for (auto & c: children)
+                    result.emplace_back(c ? rewrite(c) : c);
+                return result;
+            };
+
+        return expr.transform(doChildren);
+    }
+
+    std::shared_ptr<SqlExpression>
+    rewrite(const std::shared_ptr<SqlExpression> & node)
+    {
+        auto result = rewriteChildren(*node);
+
+        Utf8String key = node->print();
+        auto it = counts.find(key);
+        if (it != counts.end() && it->second > 1) {
+            auto & state = states[key];
+            if (!state) {
+                state = std::make_shared<SharedSubexpression::State>();
+                state->slot = states.size() - 1;
+            }
+            ++numSharedOccurrences;
+            result = std::make_shared<SharedSubexpression>(std::move(result),
+                                                           state);
+        }
+
+        return result;
+    }
+};
+
+} // file scope
+
+
+BoundSqlExpression
+bindWithCommonSubexpressions(const SqlExpression & expr,
+                             SqlBindingScope & scope,
+                             size_t * numSharedNodes,
+                             size_t * numSharedOccurrences)
+{
+    CsePass pass;
+    pass.count(expr);
+
+    bool anyShared = false;
+    for (auto & c: pass.counts) {
+        if (c.second > 1) {
+            anyShared = true;
+            break;
+        }
+    }
+
+    if (!anyShared) {
+        if (numSharedNodes)
+            *numSharedNodes = 0;
+        if (numSharedOccurrences)
+            *numSharedOccurrences = 0;
+        return expr.bind(scope);
+    }
+
+    std::shared_ptr<SqlExpression> rewritten = pass.rewriteChildren(expr);
+
+    if (numSharedNodes)
+        *numSharedNodes = pass.states.size();
+    if (numSharedOccurrences)
+        *numSharedOccurrences = pass.numSharedOccurrences;
+
+    BoundSqlExpression bound = rewritten->bind(scope);
+
+    size_t numSlots = pass.states.size();
+    auto innerExec = bound.exec;
+
+    // Install a fresh cache on the row scope for the duration of each
+    // evaluation; the shared nodes copy values out of their slots, so
+    // nothing can reference the cache once it is removed
+    bound.exec = [=] (const SqlRowScope & row,
+                      ExpressionValue & storage,
+                      const VariableFilter & filter)
+        -> const ExpressionValue &
+        {
+            SqlExpressionCseCache cache(numSlots);
+            SqlExpressionCseCache * saved = row.cseCache;
+            row.cseCache = &cache;
+            Scope_Exit(row.cseCache = saved);
+            return innerExec(row, storage, filter);
+        };
+
+    return bound;
+}
+
+} // namespace MLDB
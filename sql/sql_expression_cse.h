@@ -0,0 +1,69 @@
+/** sql_expression_cse.h                                           -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Bind-time common subexpression elimination for SQL expressions.
+*/
+
+#pragma once
+
+#include "mldb/sql/sql_expression.h"
+
+
+namespace MLDB {
+
+/*****************************************************************************/
+/* SQL EXPRESSION CSE CACHE                                                  */
+/*****************************************************************************/
+
+/** Per-row memoization slots for subexpressions shared by the bind-time
+    CSE pass.  One slot per distinct shared subtree; a slot holds the
+    subtree's value for the current row once the first occurrence has
+    evaluated it.  The cache is installed on the row scope by the
+    top-level bound expression for the duration of one evaluation and
+    removed afterwards, so slots never outlive the row.
+*/
+
+struct SqlExpressionCseCache {
+
+    struct Slot {
+        bool filled = false;
+        VariableFilter filter = GET_ALL;
+        ExpressionValue value;
+    };
+
+    SqlExpressionCseCache(size_t numSlots)
+        : slots(numSlots)
+    {
+    }
+
+    std::vector<Slot> slots;
+};
+
+
+/** Bind the given expression, sharing the evaluation of repeated pure
+    subtrees.
+
+    Subtrees are keyed on their printed form; a subtree that occurs more
+    than once and is built only from deterministic node types (arithmetic,
+    comparisons, boolean operators, CASE, BETWEEN, casts, column reads,
+    constants and query parameters) is evaluated once per row and its
+    value served from a memoization slot for the other occurrences.
+    Function calls are never shared, as a function may be non-
+    deterministic.
+
+    When nothing is shareable this is equivalent to expr.bind(scope).
+
+    numSharedNodes and numSharedOccurrences, when non-null, receive the
+    number of distinct shared subtrees and the total number of
+    occurrences they replace, for reporting in query explain output.
+*/
+BoundSqlExpression
+bindWithCommonSubexpressions(const SqlExpression & expr,
+                             SqlBindingScope & scope,
+                             size_t * numSharedNodes = nullptr,
+                             size_t * numSharedOccurrences = nullptr);
+
+} // namespace MLDB
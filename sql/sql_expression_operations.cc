@@ -17,6 +17,7 @@
 #include "mldb/core/dataset_scope.h"
 #include "mldb/base/scope.h"
 #include "mldb/sql/sql_utils.h"
+#include "mldb/sql/sql_expression_vm.h"
 #include "mldb/utils/distribution.h"
 #include "mldb/base/optimized_path.h"
 
@@ -86,31 +87,35 @@ bind(SqlBindingScope & scope) const
     auto boundLhs = lhs->bind(scope);
     auto boundRhs = rhs->bind(scope);
 
+    BoundSqlExpression bound;
     if (op == "=" || op == "==") {
-        return doComparison(this, boundLhs, boundRhs,
-                            &ExpressionValue::operator ==);
+        bound = doComparison(this, boundLhs, boundRhs,
+                             &ExpressionValue::operator ==);
     }
     else if (op == "!=") {
-        return doComparison(this, boundLhs, boundRhs,
-                            &ExpressionValue::operator !=);
+        bound = doComparison(this, boundLhs, boundRhs,
+                             &ExpressionValue::operator !=);
     }
     else if (op == ">") {
-        return doComparison(this, boundLhs, boundRhs,
-                            &ExpressionValue::operator > );
+        bound = doComparison(this, boundLhs, boundRhs,
+                             &ExpressionValue::operator > );
     }
     else if (op == "<") {
-        return doComparison(this, boundLhs, boundRhs,
-                            &ExpressionValue::operator < );
+        bound = doComparison(this, boundLhs, boundRhs,
+                             &ExpressionValue::operator < );
     }
     else if (op == ">=") {
-        return doComparison(this, boundLhs, boundRhs,
-                            &ExpressionValue::operator >=);
+        bound = doComparison(this, boundLhs, boundRhs,
+                             &ExpressionValue::operator >=);
     }
     else if (op == "<=") {
-        return doComparison(this, boundLhs, boundRhs,
-                            &ExpressionValue::operator <=);
+        bound = doComparison(this, boundLhs, boundRhs,
+                             &ExpressionValue::operator <=);
     }
     else throw AnnotatedException(400, "Unknown comparison op " + op);
+
+    // Opt-in compiled tier for numeric comparison trees
+    return wrapWithExpressionVm(this, scope, std::move(bound));
 }
 
 Utf8String
@@ -1266,29 +1271,33 @@ bind(SqlBindingScope & scope) const
     auto boundLhs = lhs ? lhs->bind(scope) : BoundSqlExpression();
     auto boundRhs = rhs->bind(scope);
 
+    BoundSqlExpression bound;
     if (op == "+" && lhs) {
-        return BinaryOpHelper<BinaryPlusOp>::bind(this, boundLhs, boundRhs);
+        bound = BinaryOpHelper<BinaryPlusOp>::bind(this, boundLhs, boundRhs);
     }
     else if (op == "-" && lhs) {
-        return BinaryOpHelper<BinaryMinusOp>::bind(this, boundLhs, boundRhs);
+        bound = BinaryOpHelper<BinaryMinusOp>::bind(this, boundLhs, boundRhs);
     }
     else if (op == "-" && !lhs) {
-        return doUnaryArithmetic<AtomValueInfo>(this, boundRhs, &unaryMinus);
+        bound = doUnaryArithmetic<AtomValueInfo>(this, boundRhs, &unaryMinus);
     }
     else if (op == "*" && lhs) {
-        return BinaryOpHelper<BinaryMultiplicationOp>
+        bound = BinaryOpHelper<BinaryMultiplicationOp>
             ::bind(this, boundLhs, boundRhs);
     }
     else if (op == "/" && lhs) {
-        return BinaryOpHelper<BinaryDivisionOp>
+        bound = BinaryOpHelper<BinaryDivisionOp>
             ::bind(this, boundLhs, boundRhs);
     }
     else if (op == "%" && lhs) {
-        return BinaryOpHelper<BinaryModulusOp>
+        bound = BinaryOpHelper<BinaryModulusOp>
             ::bind(this, boundLhs, boundRhs);
     }
     else throw AnnotatedException(400, "Unknown arithmetic op " + op
                                    + (lhs ? " binary" : " unary"));
+
+    // Opt-in compiled tier for arithmetic-dense trees
+    return wrapWithExpressionVm(this, scope, std::move(bound));
 }
 
 Utf8String
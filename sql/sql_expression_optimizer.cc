@@ -0,0 +1,157 @@
+/** sql_expression_optimizer.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Algebraic simplification of parsed SQL expressions.
+*/
+
+#include "sql_expression_optimizer.h"
+#include "sql_expression_operations.h"
+
+using namespace std;
+
+
+namespace MLDB {
+
+namespace {
+
+std::shared_ptr<SqlExpression>
+makeConstant(ExpressionValue value, const Utf8String & surface)
+{
+    auto result = std::make_shared<ConstantExpression>(std::move(value));
+    result->surface = surface;
+    return result;
+}
+
+const ConstantExpression *
+getConstant(const std::shared_ptr<SqlExpression> & expr)
+{
+    return dynamic_cast<const ConstantExpression *>(expr.get());
+}
+
+std::shared_ptr<SqlExpression>
+optimize(const std::shared_ptr<SqlExpression> & node)
+{
+    if (!node)
+        return node;
+
+    // Simplify the children first, so that constants have already
+    // bubbled up into ConstantExpressions by the time we look at this
+    // node's shape
+    TransformArgs doChildren = [&] (const std::vector<std::shared_ptr<SqlExpression> > & children)
+        {
+            std::vector<std::shared_ptr<SqlExpression> > result;
+            result.reserve(children.size());
+            for (auto & c: children)
+                result.emplace_back(optimize(c));
+            return result;
+        };
+
+    std::shared_ptr<SqlExpression> expr = node->transform(doChildren);
+    expr->surface = node->surface;
+
+    // Generic constant folding.  isConstant() guarantees that
+    // constantValue() succeeds; evaluation happens in a scope with only
+    // builtin functions, exactly as the per-row evaluation would.
+    if (!getConstant(expr) && expr->isConstant())
+        return makeConstant(expr->constantValue(), node->surface);
+
+    // One-sided constants in boolean operators.  These mirror the
+    // constant handling in BooleanOperatorExpression::bind: a constant
+    // false (resp. true for OR) dominates, a constant NULL turns the
+    // result NULL, and a neutral constant leaves the other side's truth
+    // value unchanged.
+    auto boolean = dynamic_cast<const BooleanOperatorExpression *>(expr.get());
+    if (boolean && boolean->lhs) {
+        auto cl = getConstant(boolean->lhs);
+        auto cr = getConstant(boolean->rhs);
+
+        if (boolean->op == "AND") {
+            if ((cl && cl->constant.isFalse()) || (cr && cr->constant.isFalse()))
+                return makeConstant(ExpressionValue(false, Date::negativeInfinity()),
+                                    node->surface);
+            if ((cl && cl->constant.empty()) || (cr && cr->constant.empty()))
+                return makeConstant(ExpressionValue::null(Date::negativeInfinity()),
+                                    node->surface);
+            if (cl && cl->constant.isTrue())
+                return boolean->rhs;
+            if (cr && cr->constant.isTrue())
+                return boolean->lhs;
+        }
+        else if (boolean->op == "OR") {
+            if ((cl && cl->constant.isTrue()) || (cr && cr->constant.isTrue()))
+                return makeConstant(ExpressionValue(true, Date::negativeInfinity()),
+                                    node->surface);
+            if ((cl && cl->constant.empty()) || (cr && cr->constant.empty()))
+                return makeConstant(ExpressionValue::null(Date::negativeInfinity()),
+                                    node->surface);
+            if (cl && cl->constant.isFalse())
+                return boolean->rhs;
+            if (cr && cr->constant.isFalse())
+                return boolean->lhs;
+        }
+    }
+
+    // NULL propagation: a comparison against a constant NULL is NULL for
+    // every row.  Only applied when the other side calls no functions,
+    // since a function call could be the point of the expression.
+    auto comparison = dynamic_cast<const ComparisonExpression *>(expr.get());
+    if (comparison) {
+        auto cl = getConstant(comparison->lhs);
+        auto cr = getConstant(comparison->rhs);
+
+        if ((cl && cl->constant.empty()) || (cr && cr->constant.empty())) {
+            auto & other = (cl && cl->constant.empty())
+                ? comparison->rhs : comparison->lhs;
+            if (other->functionNames().empty())
+                return makeConstant(ExpressionValue::null(Date::negativeInfinity()),
+                                    node->surface);
+        }
+    }
+
+    // 'column BETWEEN c1 AND c2' becomes 'column >= c1 AND column <= c2'
+    // (and NOT BETWEEN the disjunction of the complements), the shapes
+    // the column-scan and chunk-pruning layers in the row generators
+    // recognize.  Restricted to plain column reads so the rewrite never
+    // duplicates the evaluation of a compound expression.
+    auto between = dynamic_cast<const BetweenExpression *>(expr.get());
+    if (between
+        && dynamic_cast<const ReadColumnExpression *>(between->expr.get())
+        && getConstant(between->lower) && getConstant(between->upper)) {
+
+        std::shared_ptr<SqlExpression> lowerCmp, upperCmp;
+        if (!between->notBetween) {
+            lowerCmp = std::make_shared<ComparisonExpression>
+                (between->expr, between->lower, ">=");
+            upperCmp = std::make_shared<ComparisonExpression>
+                (between->expr, between->upper, "<=");
+        }
+        else {
+            lowerCmp = std::make_shared<ComparisonExpression>
+                (between->expr, between->lower, "<");
+            upperCmp = std::make_shared<ComparisonExpression>
+                (between->expr, between->upper, ">");
+        }
+        lowerCmp->surface = node->surface;
+        upperCmp->surface = node->surface;
+
+        auto result = std::make_shared<BooleanOperatorExpression>
+            (lowerCmp, upperCmp, between->notBetween ? "OR" : "AND");
+        result->surface = node->surface;
+        return result;
+    }
+
+    return expr;
+}
+
+} // file scope
+
+std::shared_ptr<SqlExpression>
+optimizeBooleanExpression(std::shared_ptr<SqlExpression> expr)
+{
+    return optimize(expr);
+}
+
+} // namespace MLDB
@@ -0,0 +1,40 @@
+/** sql_expression_optimizer.h                                     -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Algebraic simplification of parsed SQL expressions.
+*/
+
+#pragma once
+
+#include "mldb/sql/sql_expression.h"
+
+
+namespace MLDB {
+
+/** Simplify an expression that is evaluated in a boolean context (WHERE
+    or HAVING), returning an equivalent expression that is cheaper to
+    evaluate per row and easier for the row generators to optimize:
+
+    - constant subtrees are folded to their value;
+    - comparisons against a constant NULL become NULL;
+    - one-sided constants in AND/OR are eliminated ('x AND true' becomes
+      x, 'x AND false' becomes false, mirroring the NULL handling of
+      BooleanOperatorExpression::bind);
+    - 'column BETWEEN c1 AND c2' is rewritten into the conjunction of two
+      range comparisons, the shape the column-scan and chunk-pruning
+      optimizations in the row generators recognize.
+
+    The result is guaranteed to have the same truth value (true, false or
+    NULL) as the input for every row; the non-boolean value of truthy
+    expressions is not preserved, so this must not be used on expressions
+    whose value is returned to the user.
+
+    A null input is returned unchanged.
+*/
+std::shared_ptr<SqlExpression>
+optimizeBooleanExpression(std::shared_ptr<SqlExpression> expr);
+
+} // namespace MLDB
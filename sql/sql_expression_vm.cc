@@ -0,0 +1,408 @@
+/** sql_expression_vm.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Opt-in bytecode compilation tier for scalar SQL expressions.
+*/
+
+#include "sql_expression_vm.h"
+#include "sql_expression_operations.h"
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+
+namespace MLDB {
+
+bool
+sqlExpressionVmEnabled()
+{
+    static const bool enabled = [] () -> bool
+        {
+            const char * p = getenv("MLDB_SQL_EXPRESSION_VM");
+            return p && *p && strcmp(p, "0") != 0;
+        }();
+    return enabled;
+}
+
+namespace {
+
+/// Don't adopt the compiled form for fewer interior operations than this;
+/// below it the per-row setup costs as much as the tree walk it replaces.
+constexpr size_t VM_MIN_OPS = 4;
+
+/// Register indexes are encoded on 16 bits; stay well under that so a
+/// pathological expression falls back to the interpreter instead
+constexpr size_t VM_MAX_REGISTERS = 4096;
+
+/// Largest integer magnitude that round-trips exactly through a double.
+/// Inputs beyond it are evaluated by the fallback to keep 64 bit integer
+/// comparisons exact.
+constexpr double VM_MAX_EXACT_INTEGER = 9007199254740992.0;  // 2^53
+
+enum Opcode : uint8_t {
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_MOD,
+    OP_NEG,
+    OP_LT,
+    OP_LE,
+    OP_GT,
+    OP_GE,
+    OP_RET
+};
+
+struct Instr {
+    Opcode op;
+    uint16_t dest;
+    uint16_t a;
+    uint16_t b;
+};
+
+/** A register holds a double and a null flag; SQL NULL propagates through
+    every operation the same way the CellValue operations do for empty
+    values.
+*/
+struct Reg {
+    double val;
+    bool null;
+};
+
+struct VmProgram {
+    std::vector<Instr> instrs;            ///< ends with OP_RET
+    std::vector<Reg> initialRegs;         ///< constants filled in, rest zero
+
+    /// Register index and bound expression for each leaf the bytecode
+    /// doesn't lower; evaluated into its register before dispatch
+    std::vector<std::pair<uint16_t, BoundSqlExpression> > inputs;
+
+    uint16_t resultReg = 0;
+    bool returnsBool = false;             ///< root is a comparison
+
+    /// Integer inputs change the result representation of % and of a root
+    /// unary minus, so those shapes fall back whenever one is seen
+    bool strictIntegerGate = false;
+
+    /// Leaves under a comparison are evaluated with GET_LATEST in the
+    /// interpreter; mirror that instead of forwarding the caller's filter
+    bool useLatestFilter = false;
+
+    /// Timestamp contribution of the constants in the expression
+    Date constTs = Date::negativeInfinity();
+};
+
+/** Numeric ordering with NaN sorting first, matching the ST_FLOAT
+    comparison paths of CellValue::operator <.
+*/
+inline bool lessNanFirst(double a, double b)
+{
+    bool nana = std::isnan(a), nanb = std::isnan(b);
+    if (MLDB_UNLIKELY(nana || nanb))
+        return nana && !nanb;
+    return a < b;
+}
+
+/** Run the bytecode over the given register file.  Computed-goto dispatch
+    where the compiler supports labels as values, a plain switch loop
+    otherwise.
+*/
+void runVm(const VmProgram & prog, Reg * regs)
+{
+    const Instr * pc = prog.instrs.data();
+
+#define VM_BINARY(expr_)                                    \
+    do {                                                    \
+        const Reg & a = regs[pc->a];                        \
+        const Reg & b = regs[pc->b];                        \
+        Reg & d = regs[pc->dest];                           \
+        d.null = a.null || b.null;                          \
+        d.val = (expr_);                                    \
+    } while (0)
+
+#if defined(__GNUC__)
+
+    static const void * const dispatch[] = {
+        &&do_add, &&do_sub, &&do_mul, &&do_div, &&do_mod,
+        &&do_neg, &&do_lt, &&do_le, &&do_gt, &&do_ge, &&do_ret
+    };
+
+#define VM_NEXT() goto *dispatch[(++pc)->op]
+
+    goto *dispatch[pc->op];
+
+ do_add: VM_BINARY(a.val + b.val);  VM_NEXT();
+ do_sub: VM_BINARY(a.val - b.val);  VM_NEXT();
+ do_mul: VM_BINARY(a.val * b.val);  VM_NEXT();
+ do_div: VM_BINARY(a.val / b.val);  VM_NEXT();
+ do_mod: VM_BINARY(fmod(a.val, b.val));  VM_NEXT();
+ do_neg: {
+        const Reg & a = regs[pc->a];
+        Reg & d = regs[pc->dest];
+        d.null = a.null;
+        d.val = -a.val;
+    }
+    VM_NEXT();
+ do_lt: VM_BINARY(lessNanFirst(a.val, b.val));   VM_NEXT();
+ do_le: VM_BINARY(!lessNanFirst(b.val, a.val));  VM_NEXT();
+ do_gt: VM_BINARY(lessNanFirst(b.val, a.val));   VM_NEXT();
+ do_ge: VM_BINARY(!lessNanFirst(a.val, b.val));  VM_NEXT();
+ do_ret: return;
+
+#undef VM_NEXT
+
+#else // no computed goto
+
+    for (;; ++pc) {
+        switch (pc->op) {
+        case OP_ADD: VM_BINARY(a.val + b.val);  break;
+        case OP_SUB: VM_BINARY(a.val - b.val);  break;
+        case OP_MUL: VM_BINARY(a.val * b.val);  break;
+        case OP_DIV: VM_BINARY(a.val / b.val);  break;
+        case OP_MOD: VM_BINARY(fmod(a.val, b.val));  break;
+        case OP_NEG: {
+            const Reg & a = regs[pc->a];
+            Reg & d = regs[pc->dest];
+            d.null = a.null;
+            d.val = -a.val;
+            break;
+        }
+        case OP_LT: VM_BINARY(lessNanFirst(a.val, b.val));   break;
+        case OP_LE: VM_BINARY(!lessNanFirst(b.val, a.val));  break;
+        case OP_GT: VM_BINARY(lessNanFirst(b.val, a.val));   break;
+        case OP_GE: VM_BINARY(!lessNanFirst(a.val, b.val));  break;
+        case OP_RET: return;
+        }
+    }
+
+#endif
+
+#undef VM_BINARY
+}
+
+/** Lower an expression tree into a VmProgram.  Interior arithmetic and
+    ordering comparisons become instructions; any other subtree is bound
+    through the scope and becomes an input register.  Compilation fails
+    (and the caller keeps the interpreted form) on non-numeric constants,
+    register exhaustion or too few lowered operations to pay for itself.
+*/
+struct VmCompiler {
+    VmCompiler(SqlBindingScope & scope)
+        : scope(scope)
+    {
+    }
+
+    SqlBindingScope & scope;
+    VmProgram prog;
+    size_t numOps = 0;
+    bool failed = false;
+
+    int allocReg()
+    {
+        if (prog.initialRegs.size() >= VM_MAX_REGISTERS) {
+            failed = true;
+            return 0;
+        }
+        prog.initialRegs.push_back({0.0, false});
+        return prog.initialRegs.size() - 1;
+    }
+
+    int emitBinary(Opcode op, int a, int b)
+    {
+        int dest = allocReg();
+        prog.instrs.push_back({op, (uint16_t)dest, (uint16_t)a, (uint16_t)b});
+        ++numOps;
+        return dest;
+    }
+
+    int compileNode(const SqlExpression * node)
+    {
+        if (failed)
+            return 0;
+
+        auto arith = dynamic_cast<const ArithmeticExpression *>(node);
+        if (arith) {
+            if (arith->lhs) {
+                Opcode op;
+                if (arith->op == "+")       op = OP_ADD;
+                else if (arith->op == "-")  op = OP_SUB;
+                else if (arith->op == "*")  op = OP_MUL;
+                else if (arith->op == "/")  op = OP_DIV;
+                else if (arith->op == "%")  op = OP_MOD;
+                else return compileLeaf(node);
+
+                if (op == OP_MOD)
+                    prog.strictIntegerGate = true;
+                int a = compileNode(arith->lhs.get());
+                int b = compileNode(arith->rhs.get());
+                return emitBinary(op, a, b);
+            }
+            else if (arith->op == "-") {
+                int a = compileNode(arith->rhs.get());
+                int dest = allocReg();
+                prog.instrs.push_back({OP_NEG, (uint16_t)dest,
+                                       (uint16_t)a, 0});
+                ++numOps;
+                return dest;
+            }
+            return compileLeaf(node);
+        }
+
+        auto cmp = dynamic_cast<const ComparisonExpression *>(node);
+        if (cmp) {
+            // Equality stays interpreted: CellValue equality is
+            // representation-sensitive (integer vs float, NaN bit
+            // patterns) and can't be reproduced in the double domain
+            Opcode op;
+            if (cmp->op == "<")        op = OP_LT;
+            else if (cmp->op == "<=")  op = OP_LE;
+            else if (cmp->op == ">")   op = OP_GT;
+            else if (cmp->op == ">=")  op = OP_GE;
+            else return compileLeaf(node);
+
+            prog.useLatestFilter = true;
+            int a = compileNode(cmp->lhs.get());
+            int b = compileNode(cmp->rhs.get());
+            return emitBinary(op, a, b);
+        }
+
+        auto constant = dynamic_cast<const ConstantExpression *>(node);
+        if (constant) {
+            const ExpressionValue & value = constant->constant;
+            int reg = allocReg();
+            if (value.empty()) {
+                prog.initialRegs[reg].null = true;
+            }
+            else if (value.isAtom() && value.getAtom().isNumber()) {
+                const CellValue & cell = value.getAtom();
+                double d = cell.toDouble();
+                if ((cell.isInteger() || cell.isUnsignedInteger())
+                    && (d > VM_MAX_EXACT_INTEGER || d < -VM_MAX_EXACT_INTEGER)) {
+                    failed = true;
+                    return 0;
+                }
+                prog.initialRegs[reg].val = d;
+                prog.constTs.setMax(value.getEffectiveTimestamp());
+            }
+            else {
+                // A non-numeric constant means the numeric specialization
+                // can never run; keep the interpreted form
+                failed = true;
+                return 0;
+            }
+            return reg;
+        }
+
+        return compileLeaf(node);
+    }
+
+    int compileLeaf(const SqlExpression * node)
+    {
+        int reg = allocReg();
+        if (failed)
+            return 0;
+        prog.inputs.emplace_back((uint16_t)reg, node->bind(scope));
+        return reg;
+    }
+};
+
+} // file scope
+
+BoundSqlExpression
+wrapWithExpressionVm(const SqlExpression * expr,
+                     SqlBindingScope & scope,
+                     BoundSqlExpression bound)
+{
+    if (!sqlExpressionVmEnabled())
+        return bound;
+    if (bound.info && bound.info->isConst())
+        return bound;  // will be folded, not evaluated per row
+
+    VmCompiler compiler(scope);
+    int resultReg = compiler.compileNode(expr);
+    if (compiler.failed || compiler.numOps < VM_MIN_OPS)
+        return bound;
+
+    compiler.prog.resultReg = resultReg;
+    compiler.prog.instrs.push_back({OP_RET, 0, 0, 0});
+    compiler.prog.returnsBool
+        = dynamic_cast<const ComparisonExpression *>(expr) != nullptr;
+    // A root unary minus keeps integer inputs integer in the interpreter
+    auto arith = dynamic_cast<const ArithmeticExpression *>(expr);
+    if (arith && !arith->lhs)
+        compiler.prog.strictIntegerGate = true;
+
+    auto prog = std::make_shared<VmProgram>(std::move(compiler.prog));
+    auto fallback = bound.exec;
+
+    bound.exec = [prog, fallback]
+        (const SqlRowScope & row,
+         ExpressionValue & storage,
+         const VariableFilter & filter) -> const ExpressionValue &
+        {
+            size_t numRegs = prog->initialRegs.size();
+
+            Reg stackRegs[64];
+            std::vector<Reg> heapRegs;
+            Reg * regs;
+            if (numRegs <= 64) {
+                regs = stackRegs;
+                std::memcpy(regs, prog->initialRegs.data(),
+                            numRegs * sizeof(Reg));
+            }
+            else {
+                heapRegs = prog->initialRegs;
+                regs = heapRegs.data();
+            }
+
+            Date ts = prog->constTs;
+
+            for (auto & input: prog->inputs) {
+                ExpressionValue istorage;
+                const ExpressionValue & v
+                    = input.second(row, istorage,
+                                   prog->useLatestFilter ? GET_LATEST : filter);
+                ts.setMax(v.getEffectiveTimestamp());
+
+                Reg & r = regs[input.first];
+                if (v.empty()) {
+                    r.null = true;
+                    continue;
+                }
+                if (!v.isAtom())
+                    return fallback(row, storage, filter);
+                const CellValue & cell = v.getAtom();
+                if (cell.isInteger() || cell.isUnsignedInteger()) {
+                    double d = cell.toDouble();
+                    if (prog->strictIntegerGate
+                        || d > VM_MAX_EXACT_INTEGER
+                        || d < -VM_MAX_EXACT_INTEGER)
+                        return fallback(row, storage, filter);
+                    r.val = d;
+                }
+                else if (cell.isNumber()) {
+                    r.val = cell.toDouble();
+                }
+                else {
+                    return fallback(row, storage, filter);
+                }
+            }
+
+            runVm(*prog, regs);
+
+            const Reg & result = regs[prog->resultReg];
+            if (result.null)
+                return storage = ExpressionValue::null(ts);
+            if (prog->returnsBool)
+                return storage = ExpressionValue(result.val != 0.0, ts);
+            return storage = ExpressionValue(result.val, ts);
+        };
+
+    return bound;
+}
+
+} // namespace MLDB
@@ -0,0 +1,51 @@
+/** sql_expression_vm.h                                            -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Opt-in bytecode compilation tier for scalar SQL expressions.
+*/
+
+#pragma once
+
+#include "mldb/sql/sql_expression.h"
+
+
+namespace MLDB {
+
+/** Return whether the compiled expression tier is enabled.  It is off by
+    default and turned on by setting MLDB_SQL_EXPRESSION_VM in the
+    environment to anything but 0.
+*/
+bool sqlExpressionVmEnabled();
+
+/** Attempt to replace the execution of a bound expression with a compact
+    register bytecode specialized for numeric evaluation.
+
+    The compiler lowers subtrees made of binary arithmetic (+ - * / %),
+    unary minus and the ordering comparisons (< <= > >=) into straight-line
+    instructions over a flat register file of doubles with null flags,
+    dispatched with computed gotos.  Anything else in the tree (column
+    reads, function calls, CASE, ...) is bound normally and evaluated into
+    an input register, so arbitrary leaves are supported.  Evaluating the
+    bytecode avoids a std::function call, an ExpressionValue round trip and
+    a timestamp merge per interior node, which is where the per-row time
+    goes in arithmetic-dense transform expressions.
+
+    Exactness is preserved by gating at runtime rather than restricting at
+    compile time: each row whose inputs are not all numeric scalars (or
+    integers too large to round-trip through a double, or integers at all
+    when the tree contains %, whose integer form has its own semantics)
+    falls back to the normally bound expression, which is always kept.
+
+    Returns 'bound' unchanged when the tier is disabled, when the
+    expression is constant, when its shape doesn't lower, or when it is too
+    small for the dispatch overhead to be worth paying.
+*/
+BoundSqlExpression
+wrapWithExpressionVm(const SqlExpression * expr,
+                     SqlBindingScope & scope,
+                     BoundSqlExpression bound);
+
+} // namespace MLDB
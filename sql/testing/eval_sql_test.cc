@@ -33,3 +33,21 @@ BOOST_AUTO_TEST_CASE(test_element_compare)
                       .extractJson().toString(),
                       "[4,6]\n");
 }
+
+BOOST_AUTO_TEST_CASE(test_prepared_expression)
+{
+    SqlBindingScope scope;
+
+    SqlRowScope rowScope;
+
+    std::vector<std::shared_ptr<ExpressionValueInfo> > argInfo
+        = { std::make_shared<IntegerValueInfo>(),
+            std::make_shared<IntegerValueInfo>() };
+
+    PreparedSqlExpression prepared(scope, "$1 + $2", argInfo);
+
+    // Same prepared expression, evaluated repeatedly with new arguments
+    BOOST_CHECK_EQUAL(prepared.run(rowScope, 1, 2).getAtom(), 3);
+    BOOST_CHECK_EQUAL(prepared.run(rowScope, 5, 20).getAtom(), 25);
+    BOOST_CHECK_EQUAL(prepared.run(rowScope, -1, 1).getAtom(), 0);
+}
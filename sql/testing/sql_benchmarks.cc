@@ -0,0 +1,294 @@
+/** sql_benchmarks.cc
+    This file is part of MLDB. Copyright 2016 mldb.ai inc. All rights reserved.
+
+    Microbenchmarks for the SQL expression engine: parsing, binding,
+    per-row evaluation of common operators and ExpressionValue
+    construction.  Each benchmark reports ns/op and allocations/op so
+    that latency and allocation regressions show up in the numbers, not
+    in production.
+
+    These are benchmarks, not correctness tests: the assertions only
+    check that the benchmarked code really ran.
+*/
+
+#include "mldb/sql/binding_contexts.h"
+#include "mldb/sql/eval_sql.h"
+#include "mldb/sql/sql_expression.h"
+#include "mldb/types/date.h"
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+using namespace std;
+
+using namespace MLDB;
+
+
+/*****************************************************************************/
+/* ALLOCATION COUNTING                                                       */
+/*****************************************************************************/
+
+/* Count every allocation made by the binary so that each benchmark can
+   report allocations per operation alongside its timing. */
+
+namespace {
+
+std::atomic<uint64_t> numAllocations(0);
+
+} // file scope
+
+void * operator new(std::size_t size)
+{
+    ++numAllocations;
+    void * p = std::malloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void * operator new[](std::size_t size)
+{
+    ++numAllocations;
+    void * p = std::malloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void * p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void * p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void * p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void * p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+
+/*****************************************************************************/
+/* BENCHMARK HARNESS                                                         */
+/*****************************************************************************/
+
+namespace {
+
+/** Run fn numIter times after a warmup pass, and report ns/op and
+    allocations/op.
+*/
+template<typename Fn>
+void benchmark(const std::string & name, size_t numIter, Fn && fn)
+{
+    fn();  // warmup: first-call initialization shouldn't count
+
+    uint64_t allocsBefore = numAllocations;
+    Date before = Date::now();
+
+    for (size_t i = 0;  i < numIter;  ++i)
+        fn();
+
+    Date after = Date::now();
+    uint64_t allocs = numAllocations - allocsBefore;
+
+    double nsPerOp = after.secondsSince(before) * 1e9 / numIter;
+    double allocsPerOp = 1.0 * allocs / numIter;
+
+    cerr << name << ": " << nsPerOp << " ns/op, "
+         << allocsPerOp << " allocs/op (" << numIter << " iterations)"
+         << endl;
+}
+
+} // file scope
+
+
+/*****************************************************************************/
+/* BENCHMARKS                                                                */
+/*****************************************************************************/
+
+BOOST_AUTO_TEST_CASE( benchmark_parse )
+{
+    size_t parsed = 0;
+
+    benchmark("parse simple arithmetic", 100000, [&] ()
+        {
+            auto expr = SqlExpression::parse("$1 + $2 * 3");
+            parsed += (expr != nullptr);
+        });
+
+    benchmark("parse function calls", 100000, [&] ()
+        {
+            auto expr = SqlExpression::parse
+                ("upper($1) + lower($2) + length($3)");
+            parsed += (expr != nullptr);
+        });
+
+    benchmark("parse nested expression", 100000, [&] ()
+        {
+            auto expr = SqlExpression::parse
+                ("CASE WHEN $1 > 10 THEN sqrt($1 * $1 + $2 * $2) "
+                 "ELSE abs($1 - $2) END");
+            parsed += (expr != nullptr);
+        });
+
+    BOOST_CHECK_GT(parsed, 0);
+}
+
+BOOST_AUTO_TEST_CASE( benchmark_bind )
+{
+    SqlBindingScope scope;
+
+    std::vector<std::shared_ptr<ExpressionValueInfo> > argInfo
+        = { std::make_shared<IntegerValueInfo>(),
+            std::make_shared<IntegerValueInfo>() };
+
+    size_t bound = 0;
+
+    // PreparedSqlExpression parses and binds; subtract the parse numbers
+    // above to isolate binding
+    benchmark("parse+bind arithmetic", 20000, [&] ()
+        {
+            PreparedSqlExpression prepared(scope, "$1 + $2 * 3", argInfo);
+            bound += (prepared.getResultInfo() != nullptr);
+        });
+
+    benchmark("parse+bind case expression", 20000, [&] ()
+        {
+            PreparedSqlExpression prepared
+                (scope,
+                 "CASE WHEN $1 > 10 THEN $1 * $2 ELSE $1 - $2 END",
+                 argInfo);
+            bound += (prepared.getResultInfo() != nullptr);
+        });
+
+    BOOST_CHECK_GT(bound, 0);
+}
+
+BOOST_AUTO_TEST_CASE( benchmark_evaluate_arithmetic )
+{
+    SqlBindingScope scope;
+    SqlRowScope rowScope;
+
+    std::vector<std::shared_ptr<ExpressionValueInfo> > argInfo
+        = { std::make_shared<IntegerValueInfo>(),
+            std::make_shared<IntegerValueInfo>() };
+
+    PreparedSqlExpression addMul(scope, "$1 + $2 * 3", argInfo);
+    PreparedSqlExpression divMod(scope, "$1 / ($2 + 1) + $1 % 7", argInfo);
+
+    int64_t total = 0;
+
+    benchmark("evaluate add/multiply", 200000, [&] ()
+        {
+            total += addMul.run(rowScope, 123, 456).getAtom().toInt();
+        });
+
+    benchmark("evaluate divide/modulus", 200000, [&] ()
+        {
+            total += divMod.run(rowScope, 12345, 17).getAtom().toInt();
+        });
+
+    BOOST_CHECK_NE(total, 0);
+}
+
+BOOST_AUTO_TEST_CASE( benchmark_evaluate_string )
+{
+    SqlBindingScope scope;
+    SqlRowScope rowScope;
+
+    std::vector<std::shared_ptr<ExpressionValueInfo> > argInfo
+        = { std::make_shared<Utf8StringValueInfo>() };
+
+    PreparedSqlExpression upper(scope, "upper($1)", argInfo);
+    PreparedSqlExpression len(scope, "length($1)", argInfo);
+
+    string arg = "the quick brown fox jumps over the lazy dog";
+
+    size_t total = 0;
+
+    benchmark("evaluate upper()", 100000, [&] ()
+        {
+            total += upper.run(rowScope, arg).getAtom().toString().size();
+        });
+
+    benchmark("evaluate length()", 100000, [&] ()
+        {
+            total += len.run(rowScope, arg).getAtom().toInt();
+        });
+
+    BOOST_CHECK_GT(total, 0);
+}
+
+BOOST_AUTO_TEST_CASE( benchmark_evaluate_temporal )
+{
+    SqlBindingScope scope;
+    SqlRowScope rowScope;
+
+    std::vector<std::shared_ptr<ExpressionValueInfo> > argInfo
+        = { std::make_shared<TimestampValueInfo>() };
+
+    PreparedSqlExpression hourOf(scope, "date_part('hour', $1)", argInfo);
+
+    Date when = Date(2016, 6, 14, 11, 30, 15);
+
+    size_t total = 0;
+
+    benchmark("evaluate date_part()", 100000, [&] ()
+        {
+            total += hourOf.run(rowScope, CellValue(when)).getAtom().toInt();
+        });
+
+    BOOST_CHECK_GT(total, 0);
+}
+
+BOOST_AUTO_TEST_CASE( benchmark_expression_value_construction )
+{
+    Date ts = Date::now();
+
+    size_t total = 0;
+
+    benchmark("construct integer atom", 1000000, [&] ()
+        {
+            ExpressionValue val(1234, ts);
+            total += !val.empty();
+        });
+
+    benchmark("construct string atom", 500000, [&] ()
+        {
+            ExpressionValue val(string("hello world"), ts);
+            total += !val.empty();
+        });
+
+    benchmark("construct embedding of 100 doubles", 100000, [&] ()
+        {
+            std::vector<double> values(100, 1.5);
+            ExpressionValue val(std::move(values), ts);
+            total += !val.empty();
+        });
+
+    benchmark("construct row of 10 columns", 100000, [&] ()
+        {
+            RowValue row;
+            row.reserve(10);
+            for (unsigned i = 0;  i < 10;  ++i)
+                row.emplace_back(Path(PathElement(i)), CellValue(i), ts);
+            ExpressionValue val(std::move(row));
+            total += !val.empty();
+        });
+
+    BOOST_CHECK_GT(total, 0);
+}
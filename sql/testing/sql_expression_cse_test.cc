@@ -0,0 +1,128 @@
+/** sql_expression_cse_test.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Test of bind-time common subexpression elimination.
+*/
+
+#include "mldb/sql/sql_expression_cse.h"
+#include "mldb/sql/expression_value.h"
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <map>
+
+using namespace std;
+
+using namespace MLDB;
+
+namespace {
+
+struct TestRowScope: public SqlRowScope {
+    std::map<Utf8String, double> columns;
+};
+
+/** Binding scope over TestRowScope that counts how many times each
+    column getter actually runs, so we can verify that shared subtrees
+    are only evaluated once per row.
+*/
+struct TestBindingScope: public SqlBindingScope {
+
+    std::shared_ptr<std::map<Utf8String, int> > reads
+        = std::make_shared<std::map<Utf8String, int> >();
+
+    virtual ColumnGetter doGetColumn(const Utf8String & tableName,
+                                     const ColumnPath & columnName) override
+    {
+        Utf8String name = columnName.toUtf8String();
+        auto reads = this->reads;
+
+        return {[=] (const SqlRowScope & scope,
+                     ExpressionValue & storage,
+                     const VariableFilter & filter) -> const ExpressionValue &
+                {
+                    ++(*reads)[name];
+                    auto & row = scope.as<TestRowScope>();
+                    return storage = ExpressionValue(row.columns.at(name),
+                                                     Date());
+                },
+                std::make_shared<Float64ValueInfo>()};
+    }
+};
+
+double evaluate(const BoundSqlExpression & bound,
+                double a, double b)
+{
+    TestRowScope row;
+    row.columns[Utf8String("a")] = a;
+    row.columns[Utf8String("b")] = b;
+    return bound(row, GET_LATEST).getAtom().toDouble();
+}
+
+} // file scope
+
+BOOST_AUTO_TEST_CASE( test_repeated_subtree_evaluated_once )
+{
+    auto expr = SqlExpression::parse("(a + b) * (a + b)");
+
+    TestBindingScope scope;
+    size_t numSharedNodes = 0, numSharedOccurrences = 0;
+    auto bound = bindWithCommonSubexpressions(*expr, scope,
+                                              &numSharedNodes,
+                                              &numSharedOccurrences);
+
+    BOOST_CHECK_EQUAL(numSharedNodes, 1);
+    BOOST_CHECK_EQUAL(numSharedOccurrences, 2);
+
+    BOOST_CHECK_EQUAL(evaluate(bound, 2, 3), 25);
+
+    // Each column was read once, not once per occurrence
+    BOOST_CHECK_EQUAL((*scope.reads)[Utf8String("a")], 1);
+    BOOST_CHECK_EQUAL((*scope.reads)[Utf8String("b")], 1);
+
+    // A second row gets fresh slots
+    BOOST_CHECK_EQUAL(evaluate(bound, 1, 1), 4);
+    BOOST_CHECK_EQUAL((*scope.reads)[Utf8String("a")], 2);
+}
+
+BOOST_AUTO_TEST_CASE( test_case_shares_condition_and_result )
+{
+    auto expr = SqlExpression::parse
+        ("CASE WHEN a + b > 1 THEN a + b ELSE (a + b) * 10 END");
+
+    TestBindingScope scope;
+    size_t numSharedNodes = 0, numSharedOccurrences = 0;
+    auto bound = bindWithCommonSubexpressions(*expr, scope,
+                                              &numSharedNodes,
+                                              &numSharedOccurrences);
+
+    BOOST_CHECK_EQUAL(numSharedNodes, 1);
+    BOOST_CHECK_EQUAL(numSharedOccurrences, 3);
+
+    BOOST_CHECK_EQUAL(evaluate(bound, 2, 3), 5);
+    BOOST_CHECK_EQUAL((*scope.reads)[Utf8String("a")], 1);
+
+    BOOST_CHECK_EQUAL(evaluate(bound, 0.25, 0.25), 5);
+}
+
+BOOST_AUTO_TEST_CASE( test_no_sharing_is_plain_bind )
+{
+    auto expr = SqlExpression::parse("a + b");
+
+    TestBindingScope scope;
+    size_t numSharedNodes = 1, numSharedOccurrences = 1;
+    auto bound = bindWithCommonSubexpressions(*expr, scope,
+                                              &numSharedNodes,
+                                              &numSharedOccurrences);
+
+    BOOST_CHECK_EQUAL(numSharedNodes, 0);
+    BOOST_CHECK_EQUAL(numSharedOccurrences, 0);
+
+    BOOST_CHECK_EQUAL(evaluate(bound, 2, 3), 5);
+    BOOST_CHECK_EQUAL((*scope.reads)[Utf8String("a")], 1);
+    BOOST_CHECK_EQUAL((*scope.reads)[Utf8String("b")], 1);
+}
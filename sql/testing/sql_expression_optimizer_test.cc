@@ -0,0 +1,128 @@
+/** sql_expression_optimizer_test.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Test of algebraic simplification of parsed SQL expressions.
+*/
+
+#include "mldb/sql/sql_expression_optimizer.h"
+#include "mldb/sql/sql_expression_operations.h"
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+using namespace MLDB;
+
+namespace {
+
+std::shared_ptr<SqlExpression> optimized(const std::string & expr)
+{
+    return optimizeBooleanExpression(SqlExpression::parse(expr));
+}
+
+const ConstantExpression * asConstant(const std::shared_ptr<SqlExpression> & expr)
+{
+    return dynamic_cast<const ConstantExpression *>(expr.get());
+}
+
+} // file scope
+
+BOOST_AUTO_TEST_CASE( test_constant_folding )
+{
+    auto expr = optimized("1 + 2 < 4");
+    auto constant = asConstant(expr);
+    BOOST_REQUIRE(constant);
+    BOOST_CHECK(constant->constant.isTrue());
+
+    expr = optimized("3 * 4");
+    constant = asConstant(expr);
+    BOOST_REQUIRE(constant);
+    BOOST_CHECK_EQUAL(constant->constant.getAtom().toInt(), 12);
+}
+
+BOOST_AUTO_TEST_CASE( test_boolean_simplification )
+{
+    // Neutral constants disappear
+    auto expr = optimized("x AND true");
+    BOOST_CHECK_EQUAL(expr->getType(), "variable");
+
+    expr = optimized("false OR x");
+    BOOST_CHECK_EQUAL(expr->getType(), "variable");
+
+    // Dominant constants decide the expression
+    expr = optimized("x AND false");
+    auto constant = asConstant(expr);
+    BOOST_REQUIRE(constant);
+    BOOST_CHECK(constant->constant.isFalse());
+
+    expr = optimized("x OR true");
+    constant = asConstant(expr);
+    BOOST_REQUIRE(constant);
+    BOOST_CHECK(constant->constant.isTrue());
+
+    // Nested: the whole conjunction collapses
+    expr = optimized("(x AND true) AND true");
+    BOOST_CHECK_EQUAL(expr->getType(), "variable");
+}
+
+BOOST_AUTO_TEST_CASE( test_null_propagation )
+{
+    auto expr = optimized("x < NULL");
+    auto constant = asConstant(expr);
+    BOOST_REQUIRE(constant);
+    BOOST_CHECK(constant->constant.empty());
+
+    expr = optimized("NULL = x");
+    constant = asConstant(expr);
+    BOOST_REQUIRE(constant);
+    BOOST_CHECK(constant->constant.empty());
+
+    // ... and a NULL comparison is absorbed by an AND
+    expr = optimized("y > 2 AND x < NULL");
+    constant = asConstant(expr);
+    BOOST_REQUIRE(constant);
+    BOOST_CHECK(constant->constant.empty());
+}
+
+BOOST_AUTO_TEST_CASE( test_between_rewrite )
+{
+    auto expr = optimized("ts BETWEEN 3 AND 5");
+
+    auto boolean = dynamic_cast<const BooleanOperatorExpression *>(expr.get());
+    BOOST_REQUIRE(boolean);
+    BOOST_CHECK_EQUAL(boolean->op, "AND");
+
+    auto lower = dynamic_cast<const ComparisonExpression *>(boolean->lhs.get());
+    auto upper = dynamic_cast<const ComparisonExpression *>(boolean->rhs.get());
+    BOOST_REQUIRE(lower);
+    BOOST_REQUIRE(upper);
+    BOOST_CHECK_EQUAL(lower->op, ">=");
+    BOOST_CHECK_EQUAL(upper->op, "<=");
+
+    expr = optimized("ts NOT BETWEEN 3 AND 5");
+    boolean = dynamic_cast<const BooleanOperatorExpression *>(expr.get());
+    BOOST_REQUIRE(boolean);
+    BOOST_CHECK_EQUAL(boolean->op, "OR");
+
+    // Compound left-hand sides are left alone: the rewrite would
+    // duplicate their evaluation
+    expr = optimized("ts + 1 BETWEEN 3 AND 5");
+    BOOST_CHECK_EQUAL(expr->getType(), "between");
+}
+
+BOOST_AUTO_TEST_CASE( test_statement_where_is_optimized )
+{
+    auto stm = SelectStatement::parse("SELECT 1 FROM t WHERE x AND true");
+    BOOST_CHECK_EQUAL(stm.where->getType(), "variable");
+
+    stm = SelectStatement::parse("SELECT 1 FROM t WHERE 1 < 2");
+    auto constant = asConstant(stm.where);
+    BOOST_REQUIRE(constant);
+    BOOST_CHECK(constant->constant.isTrue());
+}
@@ -0,0 +1,140 @@
+/** sql_expression_vm_test.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Test of the bytecode compilation tier for scalar SQL expressions.
+*/
+
+#include "mldb/sql/sql_expression_vm.h"
+#include "mldb/sql/eval_sql.h"
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+
+using namespace std;
+
+using namespace MLDB;
+
+// The tier is opt-in; turn it on before the enable flag is first read
+static const bool vmEnabled = [] ()
+    {
+        setenv("MLDB_SQL_EXPRESSION_VM", "1", 1 /* overwrite */);
+        return true;
+    }();
+
+namespace {
+
+ExpressionValue run(const Utf8String & expr,
+                    const std::vector<ExpressionValue> & args)
+{
+    SqlBindingScope scope;
+    SqlRowScope rowScope;
+    return evalSql(scope, expr, rowScope, args);
+}
+
+ExpressionValue arg(double d)
+{
+    return ExpressionValue(d, Date());
+}
+
+} // file scope
+
+BOOST_AUTO_TEST_CASE( test_vm_is_enabled )
+{
+    BOOST_CHECK(vmEnabled);
+    BOOST_CHECK(sqlExpressionVmEnabled());
+}
+
+BOOST_AUTO_TEST_CASE( test_arithmetic )
+{
+    // Four operations, enough for the compiled form to be adopted
+    auto result = run("$1 * $2 + $3 * $4 - $5",
+                      { arg(2), arg(3), arg(4), arg(5), arg(6) });
+    BOOST_CHECK_EQUAL(result.getAtom().toDouble(), 20.0);
+
+    result = run("-($1 + $2 + $3 + $4)",
+                 { arg(1.5), arg(2.5), arg(3), arg(4) });
+    BOOST_CHECK_EQUAL(result.getAtom().toDouble(), -11.0);
+}
+
+BOOST_AUTO_TEST_CASE( test_null_propagation )
+{
+    auto result = run("$1 * $2 + $3 * $4",
+                      { arg(2), ExpressionValue::null(Date()),
+                        arg(4), arg(5) });
+    BOOST_CHECK(result.empty());
+
+    result = run("$1 + $2 < $3 * $4 + $5",
+                 { ExpressionValue::null(Date()), arg(1),
+                   arg(2), arg(3), arg(4) });
+    BOOST_CHECK(result.empty());
+}
+
+BOOST_AUTO_TEST_CASE( test_comparisons )
+{
+    auto result = run("$1 * $2 < $3 + $4 + $5",
+                      { arg(2), arg(3), arg(1), arg(2), arg(4) });
+    BOOST_CHECK_EQUAL(result.getAtom(), CellValue(true));
+
+    result = run("$1 * $2 >= $3 + $4 + $5",
+                 { arg(2), arg(3), arg(1), arg(2), arg(4) });
+    BOOST_CHECK_EQUAL(result.getAtom(), CellValue(false));
+
+    // NaN sorts before every number, as in the interpreted comparison
+    result = run("$1 / $2 < $3 + $4 + $5",
+                 { arg(0), arg(0), arg(0), arg(0), arg(-1000) });
+    BOOST_CHECK_EQUAL(result.getAtom(), CellValue(true));
+}
+
+BOOST_AUTO_TEST_CASE( test_integer_fallback )
+{
+    // % over integers has integer semantics; the VM must fall back to the
+    // interpreter and keep the exact integer result
+    auto result = run("($1 % $2) + $3 * $4",
+                      { ExpressionValue(7, Date()),
+                        ExpressionValue(4, Date()),
+                        arg(0), arg(0) });
+    BOOST_CHECK_EQUAL(result.getAtom().toInt(), 3);
+
+    // Integers too large for a double round trip compare exactly
+    int64_t big = (1LL << 60) + 1;
+    auto result2 = run("$1 + $2 + $3 < $4 + $5",
+                       { ExpressionValue(big, Date()),
+                         arg(0), arg(0),
+                         ExpressionValue(big, Date()), arg(0) });
+    BOOST_CHECK_EQUAL(result2.getAtom(), CellValue(false));
+}
+
+BOOST_AUTO_TEST_CASE( test_non_numeric_fallback )
+{
+    // A string operand can't run in the double domain; the fallback path
+    // must produce the interpreted result for that row
+    auto result = run("$1 + $2 + $3 + $4 < $5",
+                      { arg(1), arg(2), arg(3), arg(4), arg(11) });
+    BOOST_CHECK_EQUAL(result.getAtom(), CellValue(true));
+
+    result = run("$1 + $2 + $3 + $4 < $5",
+                 { arg(1), arg(2), arg(3), arg(4),
+                   ExpressionValue(CellValue("hello"), Date()) });
+    // Numbers sort before strings, exactly as interpreted
+    BOOST_CHECK_EQUAL(result.getAtom(), CellValue(true));
+}
+
+BOOST_AUTO_TEST_CASE( test_timestamps )
+{
+    Date early = Date::fromSecondsSinceEpoch(1000);
+    Date late = Date::fromSecondsSinceEpoch(2000);
+
+    auto result = run("$1 + $2 + $3 + $4",
+                      { ExpressionValue(1.0, early),
+                        ExpressionValue(2.0, late),
+                        ExpressionValue(3.0, early),
+                        ExpressionValue(4.0, early) });
+    BOOST_CHECK_EQUAL(result.getAtom().toDouble(), 10.0);
+    BOOST_CHECK_EQUAL(result.getEffectiveTimestamp(), late);
+}
@@ -6,3 +6,7 @@ $(eval $(call test,path_test,sql_types vfs arch types base value_description,boo
 $(eval $(call test,path_order_test,sql_types vfs arch types base value_description,boost))
 $(eval $(call test,path_benchmark,sql_types vfs arch types base value_description,boost))
 $(eval $(call test,eval_sql_test,sql_expression vfs arch types base value_description,boost))
+$(eval $(call test,sql_expression_cse_test,sql_expression vfs arch types base value_description,boost))
+$(eval $(call test,sql_expression_optimizer_test,sql_expression vfs arch types base value_description,boost))
+$(eval $(call test,sql_expression_vm_test,sql_expression vfs arch types base value_description,boost))
+$(eval $(call test,sql_benchmarks,sql_expression vfs arch types base value_description,boost manual))
@@ -77,6 +77,26 @@ BOOST_AUTO_TEST_CASE( test_basics )
     // 5.  Scientific notation
 }
 
+BOOST_AUTO_TEST_CASE( test_long_string_copies )
+{
+    // Copies of long strings share the underlying representation; make
+    // sure the contents survive the original being destroyed or reassigned
+    std::string contents(100, 'x');
+    CellValue copy;
+    {
+        CellValue original(contents);
+        copy = original;
+        BOOST_CHECK_EQUAL(copy, original);
+        original = CellValue(1);
+    }
+    BOOST_CHECK_EQUAL(copy.toString(), contents);
+    BOOST_CHECK_EQUAL(copy, CellValue(contents));
+
+    CellValue copy2 = copy;
+    copy = CellValue();
+    BOOST_CHECK_EQUAL(copy2.toString(), contents);
+}
+
 void checkOrdering(const CellValue & v1,
                    const CellValue & v2)
 {
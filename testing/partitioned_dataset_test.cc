@@ -0,0 +1,198 @@
+// This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+/* partitioned_dataset_test.cc
+   Jeremy Barnes, 30 August 2026
+   Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+   Test of the partitioned dataset over two local member datasets:
+   partial-aggregate merging of GROUP BY queries, row naming parity
+   with the same query against a single dataset holding all the rows,
+   and rejection of the query shapes that cannot be merged.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <set>
+
+#include "mldb/server/mldb_server.h"
+#include "mldb/http/http_rest_proxy.h"
+#include "mldb/types/value_description.h"
+
+using namespace std;
+using namespace MLDB;
+
+namespace {
+
+void createSparseDataset(HttpRestProxy & proxy, const string & id)
+{
+    Json::Value config;
+    config["type"] = "sparse.mutable";
+    auto res = proxy.put("/v1/datasets/" + id, jsonEncode(config));
+    BOOST_REQUIRE_EQUAL(res.code(), 201);
+}
+
+void recordRow(HttpRestProxy & proxy, const string & dataset,
+               const string & rowName, const string & g, int x)
+{
+    Json::Value row;
+    row["rowName"] = rowName;
+    Json::Value col0;
+    col0.append("g");
+    col0.append(g);
+    col0.append(0);
+    Json::Value col1;
+    col1.append("x");
+    col1.append(x);
+    col1.append(0);
+    row["columns"].append(col0);
+    row["columns"].append(col1);
+    auto res = proxy.post("/v1/datasets/" + dataset + "/rows",
+                          jsonEncode(row));
+    BOOST_REQUIRE_LT(res.code(), 400);
+}
+
+void commitDataset(HttpRestProxy & proxy, const string & dataset)
+{
+    auto res = proxy.post("/v1/datasets/" + dataset + "/commit");
+    BOOST_REQUIRE_LT(res.code(), 400);
+}
+
+/// Query results as rowName -> column name -> numeric value, dropping
+/// the timestamps, so results compare across datasets and row orders
+map<string, map<string, double> >
+queryToMap(HttpRestProxy & proxy, const string & q)
+{
+    auto res = proxy.get("/v1/query", { { "q", q }, { "format", "full" } });
+    BOOST_REQUIRE_EQUAL(res.code(), 200);
+    map<string, map<string, double> > result;
+    for (auto & row: res.jsonBody()) {
+        auto & cols = result[row["rowName"].asString()];
+        for (auto & col: row["columns"])
+            cols[col[0].asString()] = col[1].asDouble();
+    }
+    return result;
+}
+
+} // file scope
+
+BOOST_AUTO_TEST_CASE( test_partitioned_dataset )
+{
+    MldbServer server;
+    server.init();
+    string httpBoundAddress = server.bindTcp(PortRange(17000, 18000),
+                                             "127.0.0.1");
+    cerr << "http listening on " << httpBoundAddress << endl;
+    server.start();
+    HttpRestProxy proxy(httpBoundAddress);
+
+    // Two shards, plus one dataset holding all the rows to compare
+    // against: a partitioned query must be indistinguishable from the
+    // same query against the whole
+    createSparseDataset(proxy, "shard1");
+    createSparseDataset(proxy, "shard2");
+    createSparseDataset(proxy, "whole");
+
+    auto record = [&] (const string & shard, const string & rowName,
+                       const string & g, int x)
+        {
+            recordRow(proxy, shard, rowName, g, x);
+            recordRow(proxy, "whole", rowName, g, x);
+        };
+
+    record("shard1", "r1", "a", 1);
+    record("shard1", "r2", "b", 2);
+    record("shard1", "r3", "a", 3);
+    record("shard2", "r4", "a", 5);
+    record("shard2", "r5", "b", 10);
+    record("shard2", "r6", "b", 0);
+
+    commitDataset(proxy, "shard1");
+    commitDataset(proxy, "shard2");
+    commitDataset(proxy, "whole");
+
+    {
+        Json::Value config;
+        config["type"] = "partitioned";
+        Json::Value shard1;
+        shard1["dataset"]["id"] = "shard1";
+        Json::Value shard2;
+        shard2["dataset"]["id"] = "shard2";
+        config["params"]["shards"].append(shard1);
+        config["params"]["shards"].append(shard2);
+        auto res = proxy.put("/v1/datasets/part", jsonEncode(config));
+        BOOST_REQUIRE_EQUAL(res.code(), 201);
+    }
+
+    // 1.  GROUP BY merging: every partial kind, including avg, whose
+    //     per-shard averages (2 and 5 for group a) must not be averaged
+    //     again but rebuilt from the summed parts
+    {
+        auto part = queryToMap(proxy, "SELECT count(x) AS c, sum(x) AS s, "
+                               "min(x) AS mn, max(x) AS mx, avg(x) AS a "
+                               "FROM part GROUP BY g");
+        auto whole = queryToMap(proxy, "SELECT count(x) AS c, sum(x) AS s, "
+                                "min(x) AS mn, max(x) AS mx, avg(x) AS a "
+                                "FROM whole GROUP BY g");
+
+        // Row naming parity: the merged groups come back under the very
+        // names the single dataset produces
+        BOOST_CHECK(part == whole);
+        BOOST_REQUIRE_EQUAL(part.size(), 2);
+        BOOST_REQUIRE(part.count("[\"a\"]"));
+        BOOST_REQUIRE(part.count("[\"b\"]"));
+        BOOST_CHECK_EQUAL(part["[\"a\"]"]["c"], 3);
+        BOOST_CHECK_EQUAL(part["[\"a\"]"]["s"], 9);
+        BOOST_CHECK_EQUAL(part["[\"a\"]"]["mn"], 1);
+        BOOST_CHECK_EQUAL(part["[\"a\"]"]["mx"], 5);
+        BOOST_CHECK_EQUAL(part["[\"a\"]"]["a"], 3);
+        BOOST_CHECK_EQUAL(part["[\"b\"]"]["c"], 3);
+        BOOST_CHECK_EQUAL(part["[\"b\"]"]["s"], 12);
+        BOOST_CHECK_EQUAL(part["[\"b\"]"]["mn"], 0);
+        BOOST_CHECK_EQUAL(part["[\"b\"]"]["mx"], 10);
+        BOOST_CHECK_EQUAL(part["[\"b\"]"]["a"], 4);
+    }
+
+    // Ungrouped aggregates merge the same way
+    {
+        auto part = queryToMap(proxy,
+                               "SELECT sum(x) AS s, avg(x) AS a FROM part");
+        auto whole = queryToMap(proxy,
+                                "SELECT sum(x) AS s, avg(x) AS a FROM whole");
+        BOOST_CHECK(part == whole);
+        BOOST_REQUIRE_EQUAL(part.size(), 1);
+        BOOST_CHECK_EQUAL(part.begin()->second["s"], 21);
+        BOOST_CHECK_EQUAL(part.begin()->second["a"], 3.5);
+    }
+
+    // 2.  Plain row queries concatenate the shards, keeping the member
+    //     datasets' row names
+    {
+        auto part = queryToMap(proxy, "SELECT x FROM part WHERE x > 1");
+        auto whole = queryToMap(proxy, "SELECT x FROM whole WHERE x > 1");
+        BOOST_CHECK(part == whole);
+        BOOST_CHECK_EQUAL(part.size(), 4);
+        BOOST_CHECK_EQUAL(part["r5"]["x"], 10);
+    }
+
+    // 3.  Unsupported shapes are rejected with a 400, not answered
+    //     wrongly
+    auto queryCode = [&] (const string & q)
+        {
+            return proxy.get("/v1/query", { { "q", q } }).code();
+        };
+
+    // ORDER BY cannot be merged from unordered shard results
+    BOOST_CHECK_EQUAL(queryCode("SELECT x FROM part ORDER BY x"), 400);
+    // HAVING cannot be evaluated on partial aggregates
+    BOOST_CHECK_EQUAL(queryCode("SELECT sum(x) AS s FROM part "
+                                "GROUP BY g HAVING s > 3"), 400);
+    // Aggregate expressions other than a bare decomposable call
+    BOOST_CHECK_EQUAL(queryCode("SELECT sum(x) + 1 AS t FROM part "
+                                "GROUP BY g"), 400);
+    // No row-level random access
+    BOOST_CHECK_EQUAL(proxy.get("/v1/datasets/part/rows").code(), 400);
+}
@@ -453,6 +453,9 @@ $(eval $(call mldb_unit_test,import_text_test.py))
 $(eval $(call mldb_unit_test,alias_resolving_test.py))
 $(eval $(call mldb_unit_test,MLDB-1753_useragent_function.py,html))
 $(eval $(call test,MLDB-1742-tabular-dataset-integer-columns,mldb $(MLDB_AUTO_LIBS) mldb_tabular_plugin block,boost))
+$(eval $(call test,parquet_import_test,mldb $(MLDB_AUTO_LIBS) mldb_textual_plugin mldb_tabular_plugin,boost))
+$(eval $(call test,buffered_recorder_test,mldb $(MLDB_AUTO_LIBS) mldb_tabular_plugin,boost))
+$(eval $(call test,partitioned_dataset_test,mldb $(MLDB_AUTO_LIBS) mldb_sparse_plugin,boost))
 $(eval $(call mldb_unit_test,summary_stats_proc_test.py))
 $(eval $(call mldb_unit_test,MLDB-1766_dt_categorical.py))
 $(eval $(call mldb_unit_test,MLDB-1750-dist-tables.py))
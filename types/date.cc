@@ -88,6 +88,190 @@ expectFixedWidthInt(ParseContext & context,
 const boost::posix_time::ptime
 epoch(boost::gregorian::date(1970, 1, 1));
 
+inline bool isDigitChar(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/** Days since the epoch for the given civil date in the proleptic
+    Gregorian calendar.  Straight arithmetic (Howard Hinnant's
+    days_from_civil); the inverse of civilFromDays below.
+*/
+int64_t daysFromCivil(int y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);                   // [0, 399]
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1; // [0, 365]
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;       // [0, 146096]
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+/** Civil date for the given number of days since the epoch. */
+void civilFromDays(int64_t z, int & y, unsigned & m, unsigned & d)
+{
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = (unsigned)(z - era * 146097);                // [0, 146096]
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int64_t yr = (int64_t)yoe + era * 400;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);     // [0, 365]
+    const unsigned mp = (5 * doy + 2) / 153;                          // [0, 11]
+    d = doy - (153 * mp + 2) / 5 + 1;                                 // [1, 31]
+    m = mp + (mp < 10 ? 3 : -9);                                      // [1, 12]
+    y = (int)(yr + (m <= 2));
+}
+
+/** Fast path for the overwhelmingly common fixed ISO-8601 layout
+    YYYY-MM-DDTHH:MM:SS with an optional fractional part and an
+    optional trailing Z (a space separator is also accepted, as in the
+    general parser).  Validates the layout with straight arithmetic --
+    no strptime and no ParseContext allocation -- and memoizes the last
+    seen day prefix per thread, since timestamped files typically carry
+    millions of values within the same day.
+
+    Returns false for anything it does not recognize (timezone
+    offsets, week dates, ordinal dates, out-of-range fields...), in
+    which case the caller falls back to the general parser, which
+    reproduces the historical behavior exactly.
+*/
+bool tryParseIso8601Fixed(const char * s, size_t len, double & result)
+{
+    if (len < 19)
+        return false;
+    if (s[4] != '-' || s[7] != '-' || (s[10] != 'T' && s[10] != ' ')
+        || s[13] != ':' || s[16] != ':')
+        return false;
+    static constexpr int digitPositions[] =
+        { 0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, 17, 18 };
+    for (int p: digitPositions)
+        if (!isDigitChar(s[p]))
+            return false;
+
+    static thread_local struct {
+        char prefix[10];
+        int64_t midnight;
+        bool valid = false;
+    } lastSeenDay;
+
+    int64_t midnight;
+    if (lastSeenDay.valid && memcmp(s, lastSeenDay.prefix, 10) == 0) {
+        midnight = lastSeenDay.midnight;
+    }
+    else {
+        int year = (s[0] - '0') * 1000 + (s[1] - '0') * 100
+                 + (s[2] - '0') * 10 + (s[3] - '0');
+        unsigned month = (s[5] - '0') * 10 + (s[6] - '0');
+        unsigned day = (s[8] - '0') * 10 + (s[9] - '0');
+
+        // The general parser accepts years from 1400 up
+        if (year < 1400)
+            return false;
+        if (month < 1 || month > 12)
+            return false;
+        static constexpr unsigned daysInMonth[12]
+            = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        bool leap = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+        unsigned dim = daysInMonth[month - 1] + (month == 2 && leap);
+        if (day < 1 || day > dim)
+            return false;
+
+        midnight = daysFromCivil(year, month, day) * 86400;
+        memcpy(lastSeenDay.prefix, s, 10);
+        lastSeenDay.midnight = midnight;
+        lastSeenDay.valid = true;
+    }
+
+    unsigned hour = (s[11] - '0') * 10 + (s[12] - '0');
+    unsigned minute = (s[14] - '0') * 10 + (s[15] - '0');
+    unsigned second = (s[17] - '0') * 10 + (s[18] - '0');
+    if (hour > 23 || minute > 59 || second > 60)
+        return false;
+
+    int64_t whole = midnight + 3600 * hour + 60 * minute + second;
+
+    size_t pos = 19;
+    if (pos < len && s[pos] == '.') {
+        size_t fracStart = ++pos;
+        while (pos < len && isDigitChar(s[pos]))
+            ++pos;
+        size_t fracDigits = pos - fracStart;
+        if (fracDigits == 0 || fracDigits > 32)
+            return false;
+
+        // Combine whole and fractional parts through strtod, exactly
+        // like the general parser does, so results are bit-identical
+        char buf[64];
+        int n = snprintf(buf, sizeof(buf), "%lld.%.*s",
+                         (long long)whole, (int)fracDigits, s + fracStart);
+        if (n <= 0 || n >= (int)sizeof(buf))
+            return false;
+        result = strtod(buf, nullptr);
+    }
+    else result = whole;
+
+    if (pos == len)
+        return true;
+    if (s[pos] == 'Z' && pos + 1 == len)
+        return true;
+
+    return false;
+}
+
+/** Format t as YYYY-MM-DD<sep>HH:MM:SS into out (exactly 19
+    characters, no terminator), memoizing the last printed day per
+    thread.  Returns false for years outside [0, 9999], which need the
+    variable-width strftime path.
+*/
+bool formatIso8601Fixed(time_t t, char sep, char * out)
+{
+    int64_t day = t / 86400;
+    int64_t secondOfDay = t - day * 86400;
+    if (secondOfDay < 0) {
+        secondOfDay += 86400;
+        --day;
+    }
+
+    auto put2 = [] (char * p, unsigned v)
+        {
+            p[0] = '0' + v / 10;
+            p[1] = '0' + v % 10;
+        };
+
+    static thread_local struct {
+        int64_t day = std::numeric_limits<int64_t>::min();
+        char prefix[10];
+    } lastPrintedDay;
+
+    if (day == lastPrintedDay.day) {
+        memcpy(out, lastPrintedDay.prefix, 10);
+    }
+    else {
+        int year;
+        unsigned month, dayOfMonth;
+        civilFromDays(day, year, month, dayOfMonth);
+        if (year < 0 || year > 9999)
+            return false;
+        put2(out, year / 100);
+        put2(out + 2, year % 100);
+        out[4] = '-';
+        put2(out + 5, month);
+        out[7] = '-';
+        put2(out + 8, dayOfMonth);
+        lastPrintedDay.day = day;
+        memcpy(lastPrintedDay.prefix, out, 10);
+    }
+
+    out[10] = sep;
+    put2(out + 11, secondOfDay / 3600);
+    out[13] = ':';
+    put2(out + 14, (secondOfDay / 60) % 60);
+    out[16] = ':';
+    put2(out + 17, secondOfDay % 60);
+
+    return true;
+}
+
 }
 
 namespace MLDB {
@@ -195,6 +379,11 @@ parseIso8601DateTime(const std::string & dateTimeStr)
     else if (dateTimeStr == "-Inf")
         return negativeInfinity();
     else {
+        double seconds;
+        if (tryParseIso8601Fixed(dateTimeStr.data(), dateTimeStr.length(),
+                                 seconds))
+            return fromSecondsSinceEpoch(seconds);
+
         Date date;
         Iso8601Parser parser(dateTimeStr);
         if (!parser.matchDateTime(date))
@@ -374,11 +563,18 @@ printIso8601(int seconds_digits) const
         else return "-Inf";
     }
 
-    string result = print("%Y-%m-%dT%H:%M:%S");
+    // Same saturation thresholds as print()
+    if (secondsSinceEpoch() >= 100000000000)
+        return "Inf";
+    if (secondsSinceEpoch() <= -1000000000000)
+        return "-Inf";
+
+    string result;
+    char buf[19];
+    if (formatIso8601Fixed((time_t)secondsSinceEpoch(), 'T', buf))
+        result.assign(buf, buf + 19);
+    else result = print("%Y-%m-%dT%H:%M:%S");
 
-    if (result == "Inf" || result == "-Inf" || result == "NaD")
-        return result;
-    
     addFractionalSeconds(result, secondsSinceEpoch(), seconds_digits);
 
     result += "Z";
@@ -399,6 +595,16 @@ printClassic() const
         else return "-Inf";
     }
 
+    // Same saturation thresholds as print()
+    if (secondsSinceEpoch() >= 100000000000)
+        return "Inf";
+    if (secondsSinceEpoch() <= -1000000000000)
+        return "-Inf";
+
+    char buf[19];
+    if (formatIso8601Fixed((time_t)secondsSinceEpoch(), ' ', buf))
+        return string(buf, buf + 19);
+
     return print("%Y-%m-%d %H:%M:%S");
 }
 
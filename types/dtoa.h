@@ -11,6 +11,8 @@
 #pragma once
 
 #include <string>
+#include <cstring>
+#include <cstdio>
 
 extern "C" {
 
@@ -107,5 +109,70 @@ inline std::string dtoa(double floatVal)
     return toReturn;
 }
 
+/** Render as above, but into a caller-provided buffer of at least 64
+    bytes, without allocating the result.  Returns the number of
+    characters written.  Produces exactly the same rendering as the
+    std::string overload.
+*/
+inline size_t dtoa(double floatVal, char * buf)
+{
+    // if exactly 0 then return 0.0
+    if (floatVal == 0.0) {
+        buf[0] = '0';  buf[1] = '.';  buf[2] = '0';
+        return 3;
+    }
+
+    int decpt;
+    int sign;
+    char * rve;
+
+    char * result = soa_dtoa(floatVal, 1, -1 /* ndigits */,
+                             &decpt, &sign, &rve);
+    size_t len = rve - result;
+
+    char * p = buf;
+    if (sign)
+        *p++ = '-';
+
+    if (decpt == 9999) {
+        // Infinity or NaN; digits pass through as-is
+        std::memcpy(p, result, len);
+        p += len;
+    }
+    else if (decpt > 0 && decpt <= (int)len) {
+        std::memcpy(p, result, decpt);
+        p += decpt;
+        *p++ = '.';
+        if (decpt == (int)len)
+            *p++ = '0';
+        else {
+            std::memcpy(p, result + decpt, len - decpt);
+            p += len - decpt;
+        }
+    }
+    else if (decpt <= 0 && decpt > -6) {
+        *p++ = '0';
+        *p++ = '.';
+        for (int i = 0;  i < -decpt;  ++i)
+            *p++ = '0';
+        std::memcpy(p, result, len);
+        p += len;
+    }
+    else {
+        *p++ = result[0];
+        if (len > 1) {
+            *p++ = '.';
+            std::memcpy(p, result + 1, len - 1);
+            p += len - 1;
+        }
+        *p++ = 'e';
+        p += std::sprintf(p, "%d", decpt - 1);
+    }
+
+    soa_freedtoa(result);
+
+    return p - buf;
+}
+
 
 } // namespace MLDB
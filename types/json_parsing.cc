@@ -203,6 +203,27 @@ std::string expectJsonStringAsciiPermissive(ParseContext & context, char sub)
     return result;
 }
 
+namespace {
+
+/* Character class of bytes that can be copied verbatim from inside a JSON
+   string: printable ASCII except the closing quote and the escape
+   character.  Everything else (escapes, control characters, bytes >= 128)
+   drops back to the per-character path below.  Used with
+   ParseContext::match_run_of_class to consume long plain runs in bulk. */
+struct JsonStringPlainChars {
+    JsonStringPlainChars()
+    {
+        for (unsigned i = 0;  i < 256;  ++i)
+            table[i] = (i >= 32 && i < 127 && i != '"' && i != '\\');
+    }
+
+    bool table[256];
+};
+
+const JsonStringPlainChars jsonStringPlainChars;
+
+} // file scope
+
 ssize_t expectJsonStringAscii(ParseContext & context, char * buffer, size_t maxLength)
 {
     skipJsonWhitespace(context);
@@ -213,6 +234,15 @@ ssize_t expectJsonStringAscii(ParseContext & context, char * buffer, size_t maxL
 
     // Try multiple times to make it fit
     while (!context.match_literal('"')) {
+        // Bulk-copy any run of plain characters before falling back to
+        // the character-at-a-time path for escapes and invalid bytes
+        size_t n = context.match_run_of_class(jsonStringPlainChars.table,
+                                              buffer + pos, bufferSize - pos);
+        if (n) {
+            pos += n;
+            continue;
+        }
+
         int c = *context++;
         if (c == '\\') {
             c = *context++;
@@ -263,15 +293,17 @@ std::string expectJsonStringAscii(ParseContext & context)
 
     // Try multiple times to make it fit
     while (!context.match_literal('"')) {
-
-#if 0 // attempt to do it a block at a time
-        char * bufferEnd = cbuffer + bufferSize;
-
-        int charsMatched
-            = context.match_text(buffer + pos, buffer + bufferSize,
-                                 "\"\\");
-        pos += charsMatched;
-#endif
+        // Bulk-copy any run of plain characters before falling back to
+        // the character-at-a-time path for escapes and invalid bytes
+        if (pos < bufferSize) {
+            size_t n = context.match_run_of_class(jsonStringPlainChars.table,
+                                                  buffer + pos,
+                                                  bufferSize - pos);
+            if (n) {
+                pos += n;
+                continue;
+            }
+        }
 
         int c = *context++;
         if (c == '\\') {
@@ -382,8 +414,17 @@ Utf8String expectJsonStringUtf8(ParseContext & context)
             bufferSize = newBufferSize;
         }
 
+        // Bulk-copy any run of plain ASCII characters; escapes, control
+        // characters and multi-byte sequences take the path below
+        size_t n = context.match_run_of_class(jsonStringPlainChars.table,
+                                              buffer + pos, bufferSize - pos);
+        if (n) {
+            pos += n;
+            continue;
+        }
+
         int c = *context;
-        
+
         //cerr << "c = " << c << " " << (char)c << endl;
 
         if (c < 0 || c > 127) {
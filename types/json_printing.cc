@@ -12,6 +12,8 @@
 #include "json_printing.h"
 #include "dtoa.h"
 #include <cmath>
+#include <cstring>
+#include <cstdint>
 #include <iostream>
 #include "mldb/ext/jsoncpp/value.h"
 
@@ -94,6 +96,50 @@ char * jsonEscapeCore(const char * str, size_t strLen, char * p, char * end)
 
 static constexpr size_t MAX_STACK_CHARS = 16384;
 
+/** Return a mask with the high bit set in every byte of the word that
+    needs JSON escaping (control characters, '"' and '\\').  Bytes at or
+    above 0x80 are UTF-8 lead or continuation bytes and pass through.
+    Branchless; the caller turns the mask into a clean-run length.
+*/
+static inline uint64_t jsonEscapeNeededMask(uint64_t w)
+{
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t high = 0x8080808080808080ULL;
+
+    // Classic SWAR tests: haszero flags zero bytes, hasless flags bytes
+    // below the (sub-0x80) threshold
+    uint64_t quotes     = (w ^ (ones * '"'));
+    uint64_t backslash  = (w ^ (ones * '\\'));
+    uint64_t isQuote    = (quotes - ones) & ~quotes & high;
+    uint64_t isBslash   = (backslash - ones) & ~backslash & high;
+    uint64_t isControl  = (w - (ones * 0x20)) & ~w & high;
+
+    return isQuote | isBslash | isControl;
+}
+
+/** Number of leading bytes of [p, p + len) that need no JSON escaping.
+    Scans a word at a time; assumes a little-endian byte order, like the
+    rest of the low-level string handling in this tree.
+*/
+static size_t jsonEscapeCleanPrefix(const char * p, size_t len)
+{
+    size_t n = 0;
+    while (n + 8 <= len) {
+        uint64_t w;
+        std::memcpy(&w, p + n, 8);
+        uint64_t mask = jsonEscapeNeededMask(w);
+        if (mask)
+            return n + __builtin_ctzll(mask) / 8;
+        n += 8;
+    }
+    for (; n < len;  ++n) {
+        unsigned char c = p[n];
+        if (c < 0x20 || c == '\"' || c == '\\')
+            break;
+    }
+    return n;
+}
+
 } // file scope
 
 bool isJsonValidAscii(char c)
@@ -837,6 +883,302 @@ Utf8StringJsonPrintingContext(Utf8String & str)
 }
 
 
+/*****************************************************************************/
+/* BUFFERED JSON PRINTING CONTEXT                                            */
+/*****************************************************************************/
+
+BufferedJsonPrintingContext::
+BufferedJsonPrintingContext(char * buffer, size_t bufferSize,
+                            OnWrite onWrite)
+    : buffer(buffer), capacity(bufferSize), pos(0),
+      onWrite(std::move(onWrite))
+{
+    ExcAssertGreaterEqual(bufferSize, 64);
+}
+
+void
+BufferedJsonPrintingContext::
+finish()
+{
+    flush();
+}
+
+void
+BufferedJsonPrintingContext::
+flush()
+{
+    if (pos != 0) {
+        onWrite(buffer, pos);
+        pos = 0;
+    }
+}
+
+void
+BufferedJsonPrintingContext::
+ensure(size_t n)
+{
+    if (pos + n > capacity)
+        flush();
+}
+
+void
+BufferedJsonPrintingContext::
+put(char c)
+{
+    ensure(1);
+    buffer[pos++] = c;
+}
+
+void
+BufferedJsonPrintingContext::
+put(const char * s, size_t len)
+{
+    if (len >= capacity) {
+        // Too big to ever fit; hand it to the sink directly, keeping
+        // the output ordered
+        flush();
+        onWrite(s, len);
+        return;
+    }
+    ensure(len);
+    std::memcpy(buffer + pos, s, len);
+    pos += len;
+}
+
+void
+BufferedJsonPrintingContext::
+writeEscaped(const char * s, size_t len)
+{
+    size_t i = 0;
+    while (i < len) {
+        size_t clean = jsonEscapeCleanPrefix(s + i, len - i);
+        put(s + i, clean);
+        i += clean;
+        if (i == len)
+            break;
+
+        unsigned char c = s[i++];
+        ensure(6);
+        switch (c) {
+        case '\t': buffer[pos++] = '\\';  buffer[pos++] = 't';  break;
+        case '\n': buffer[pos++] = '\\';  buffer[pos++] = 'n';  break;
+        case '\r': buffer[pos++] = '\\';  buffer[pos++] = 'r';  break;
+        case '\f': buffer[pos++] = '\\';  buffer[pos++] = 'f';  break;
+        case '\b': buffer[pos++] = '\\';  buffer[pos++] = 'b';  break;
+        case '\\':
+        case '\"': buffer[pos++] = '\\';  buffer[pos++] = c;  break;
+        case '\0':
+            throw MLDB::Exception("JSON strings cannot contain null characters");
+        default:
+            // Remaining ASCII control codes
+            buffer[pos++] = '\\';
+            buffer[pos++] = 'u';
+            buffer[pos++] = '0';
+            buffer[pos++] = '0';
+            buffer[pos++] = hexDigit((c >> 4) & 15);
+            buffer[pos++] = hexDigit((c >> 0) & 15);
+        }
+    }
+}
+
+void
+BufferedJsonPrintingContext::
+startObject()
+{
+    path.push_back(true /* isObject */);
+    put('{');
+}
+
+void
+BufferedJsonPrintingContext::
+startMember(const Utf8String & memberName)
+{
+    startMember(memberName.rawData(), memberName.rawLength());
+}
+
+void
+BufferedJsonPrintingContext::
+startMember(const char * memberNameStr, size_t memberNameLen)
+{
+    ExcAssert(path.back().isObject);
+    ++path.back().memberNum;
+    if (path.back().memberNum != 0)
+        put(',');
+    put('\"');
+    writeEscaped(memberNameStr, memberNameLen);
+    put('\"');
+    put(':');
+}
+
+void
+BufferedJsonPrintingContext::
+endObject()
+{
+    ExcAssert(path.back().isObject);
+    path.pop_back();
+    put('}');
+}
+
+void
+BufferedJsonPrintingContext::
+startArray(int knownSize)
+{
+    path.push_back(false /* isObject */);
+    put('[');
+}
+
+void
+BufferedJsonPrintingContext::
+newArrayElement()
+{
+    ExcAssert(!path.back().isObject);
+    ++path.back().memberNum;
+    if (path.back().memberNum != 0)
+        put(',');
+}
+
+void
+BufferedJsonPrintingContext::
+endArray()
+{
+    ExcAssert(!path.back().isObject);
+    path.pop_back();
+    put(']');
+}
+
+void
+BufferedJsonPrintingContext::
+skip()
+{
+    put("null", 4);
+}
+
+void
+BufferedJsonPrintingContext::
+writeNull()
+{
+    put("null", 4);
+}
+
+void
+BufferedJsonPrintingContext::
+writeInt(int i)
+{
+    ensure(32);
+    pos += sprintf(buffer + pos, "%i", i);
+}
+
+void
+BufferedJsonPrintingContext::
+writeUnsignedInt(unsigned int i)
+{
+    ensure(32);
+    pos += sprintf(buffer + pos, "%u", i);
+}
+
+void
+BufferedJsonPrintingContext::
+writeLong(long int i)
+{
+    ensure(32);
+    pos += sprintf(buffer + pos, "%li", i);
+}
+
+void
+BufferedJsonPrintingContext::
+writeUnsignedLong(unsigned long int i)
+{
+    ensure(32);
+    pos += sprintf(buffer + pos, "%lu", i);
+}
+
+void
+BufferedJsonPrintingContext::
+writeLongLong(long long int i)
+{
+    ensure(32);
+    pos += sprintf(buffer + pos, "%lli", i);
+}
+
+void
+BufferedJsonPrintingContext::
+writeUnsignedLongLong(unsigned long long int i)
+{
+    ensure(32);
+    pos += sprintf(buffer + pos, "%llu", i);
+}
+
+void
+BufferedJsonPrintingContext::
+writeFloat(float f)
+{
+    writeDouble(f);
+}
+
+void
+BufferedJsonPrintingContext::
+writeDouble(double d)
+{
+    if (std::isfinite(d)) {
+        ensure(64);
+        pos += MLDB::dtoa(d, buffer + pos);
+    }
+    else {
+        put('\"');
+        string s = std::to_string(d);
+        put(s.data(), s.size());
+        put('\"');
+    }
+}
+
+void
+BufferedJsonPrintingContext::
+writeString(const std::string & s)
+{
+    writeString(s.data(), s.size());
+}
+
+void
+BufferedJsonPrintingContext::
+writeString(const char * p, size_t len)
+{
+    put('\"');
+    writeEscaped(p, len);
+    put('\"');
+}
+
+void
+BufferedJsonPrintingContext::
+writeStringUtf8(const Utf8String & s)
+{
+    writeString(s.rawData(), s.rawLength());
+}
+
+void
+BufferedJsonPrintingContext::
+writeStringUtf8(const char * p, size_t len)
+{
+    writeString(p, len);
+}
+
+void
+BufferedJsonPrintingContext::
+writeJson(const Json::Value & val)
+{
+    string s = val.toStringNoNewLine();
+    put(s.data(), s.size());
+}
+
+void
+BufferedJsonPrintingContext::
+writeBool(bool b)
+{
+    if (b)
+        put("true", 4);
+    else put("false", 5);
+}
+
+
 /*****************************************************************************/
 /* STRUCTURED JSON PRINTING CONTEXT                                          */
 /*****************************************************************************/
@@ -12,6 +12,7 @@
 #include <string>
 #include <ostream>
 #include <vector>
+#include <functional>
 
 namespace Json {
 struct Value;
@@ -236,6 +237,117 @@ struct Utf8StringJsonPrintingContext
 };
 
 
+/*****************************************************************************/
+/* BUFFERED JSON PRINTING CONTEXT                                            */
+/*****************************************************************************/
+
+/** JSON printing context that renders into a caller-provided buffer and
+    hands full buffers to a sink callback, avoiding the per-token ostream
+    virtual calls of StreamJsonPrintingContext and the per-character
+    appends of StringJsonPrintingContext.  Doubles are formatted straight
+    into the buffer via dtoa, and strings are escaped by scanning eight
+    bytes at a time for runs that need no escaping and copying each run
+    in bulk.
+
+    Strings passed to writeString and writeStringUtf8 must be valid
+    UTF-8; multi-byte sequences are passed through unescaped.
+
+    finish() must be called once printing is complete to push the tail of
+    the buffer to the sink.
+*/
+
+struct BufferedJsonPrintingContext
+    : public JsonPrintingContext {
+
+    typedef std::function<void (const char *, size_t)> OnWrite;
+
+    /** The buffer must stay valid for the lifetime of the context and be
+        at least 64 bytes long; 64kB amortizes the sink callback over
+        large renderings while staying cache friendly.
+    */
+    BufferedJsonPrintingContext(char * buffer, size_t bufferSize,
+                                OnWrite onWrite);
+
+    /** Push whatever is left in the buffer to the sink.  Must be called
+        exactly once, after the value has been printed. */
+    void finish();
+
+    struct PathEntry {
+        PathEntry(bool isObject)
+            : isObject(isObject), memberNum(-1)
+        {
+        }
+
+        bool isObject;
+        int memberNum;
+    };
+
+    std::vector<PathEntry> path;
+
+    virtual void startObject();
+
+    virtual void startMember(const Utf8String & memberName);
+    virtual void startMember(const char * memberNameStr, size_t memberNameLen);
+
+    virtual void endObject();
+
+    virtual void startArray(int knownSize = -1);
+
+    virtual void newArrayElement();
+
+    virtual void endArray();
+
+    virtual void skip();
+
+    virtual void writeNull();
+
+    virtual void writeInt(int i);
+
+    virtual void writeUnsignedInt(unsigned int i);
+
+    virtual void writeLong(long int i);
+
+    virtual void writeUnsignedLong(unsigned long int i);
+
+    virtual void writeLongLong(long long int i);
+
+    virtual void writeUnsignedLongLong(unsigned long long int i);
+
+    virtual void writeFloat(float f);
+
+    virtual void writeDouble(double d);
+
+    virtual void writeString(const std::string & s);
+    virtual void writeString(const char * start, size_t len);
+
+    virtual void writeStringUtf8(const Utf8String & s);
+    virtual void writeStringUtf8(const char * start, size_t len);
+
+    virtual void writeJson(const Json::Value & val);
+
+    virtual void writeBool(bool b);
+
+private:
+    /// Make room for n more bytes, flushing if necessary; n must not
+    /// exceed the buffer size
+    void ensure(size_t n);
+
+    /// Push the current buffer contents to the sink
+    void flush();
+
+    void put(char c);
+    void put(const char * s, size_t len);
+
+    /// Escape and write the body of a JSON string (without the quotes)
+    void writeEscaped(const char * s, size_t len);
+
+    char * buffer;
+    size_t capacity;
+    size_t pos;
+    OnWrite onWrite;
+};
+
+
 /*****************************************************************************/
 /* STRUCTURED JSON PRINTING CONTEXT                                          */
 /*****************************************************************************/
@@ -14,6 +14,7 @@
 #include "mldb/ext/highwayhash.h"
 #include "mldb/types/itoa.h"
 #include "mldb/utils/json_utils.h"
+#include "mldb/utils/lightweight_hash.h"
 #include "mldb/ext/cityhash/src/city.h"
 
 using namespace std;
@@ -644,6 +645,36 @@ newHash256() const
     return highwayHash256(defaultSeedStable.u64, data(), dataLength());
 }
 
+PathElement
+PathElement::
+intern(const char * str, size_t len)
+{
+    // Thread-local so that no locking is needed; importers construct
+    // names from many threads, and each thread sees the same small set
+    // of names over and over again.
+    static constexpr size_t MAX_CACHED_ELEMENTS = 8192;
+    static thread_local LightweightHash<uint64_t, PathElement> cache;
+
+    uint64_t h = highwayHash(defaultSeedStable.u64, str, len);
+
+    auto it = cache.find(h);
+    if (it != cache.end()) {
+        const PathElement & el = it->second;
+        // Guard against the (unlikely) hash collision by verifying the
+        // bytes before handing back the cached element.
+        if (el.dataLength() == len
+            && std::memcmp(el.data(), str, len) == 0)
+            return el;
+        return PathElement(str, len);
+    }
+
+    PathElement result(str, len);
+    if (cache.size() >= MAX_CACHED_ELEMENTS)
+        cache.clear();
+    cache.insert({h, result});
+    return result;
+}
+
 Path
 PathElement::
 operator + (const PathElement & other) const
@@ -1382,6 +1413,45 @@ newHash256() const
     return result;
 }
 
+void
+Path::
+hashMany(const Path * paths, size_t numPaths, uint64_t * out)
+{
+    // Far enough ahead to cover the memory latency of paths whose
+    // bytes spilled out of the inline storage, close enough that the
+    // prefetched lines are still resident when we get there.
+    constexpr size_t PREFETCH_AHEAD = 8;
+
+    for (size_t i = 0;  i < numPaths;  ++i) {
+        if (i + PREFETCH_AHEAD < numPaths)
+            __builtin_prefetch(paths[i + PREFETCH_AHEAD].data());
+        const Path & p = paths[i];
+        if (MLDB_LIKELY(p.length_ == 1)) {
+            auto sv = p.getStringView(0);
+            out[i] = CityHash64(sv.first, sv.second);
+        }
+        else out[i] = p.oldHash();
+    }
+}
+
+void
+Path::
+newHashMany(const Path * paths, size_t numPaths, uint64_t * out)
+{
+    constexpr size_t PREFETCH_AHEAD = 8;
+
+    for (size_t i = 0;  i < numPaths;  ++i) {
+        if (i + PREFETCH_AHEAD < numPaths)
+            __builtin_prefetch(paths[i + PREFETCH_AHEAD].data());
+        const Path & p = paths[i];
+        if (MLDB_LIKELY(p.length_ == 1)) {
+            auto sv = p.getStringView(0);
+            out[i] = highwayHash(defaultSeedStable.u64, sv.first, sv.second);
+        }
+        else out[i] = p.newHash();
+    }
+}
+
 uint64_t
 Path::
 oldHashElement(size_t el) const
@@ -80,6 +80,15 @@ struct PathElement {
     static PathElement parse(const char * p, size_t l);
     static PathElement parsePartial(const char * & p, const char * e);
 
+    /** Construct a PathElement for the given string through a
+        thread-local cache of recently seen elements.  Workloads that
+        re-construct the same few thousand names millions of times (CSV
+        and JSON import, notably) then share the validation and digit
+        scanning work, and for names too long for the inline storage,
+        avoid re-allocating per instance.
+    */
+    static PathElement intern(const char * str, size_t len);
+
     /** Attempt to parse.  Returns the element, plus a boolean flag which indicates
         whether it was successfully parsed or not.
     */
@@ -601,6 +610,21 @@ struct Path {
     std::array<uint64_t, 2> newHash128() const;
     std::array<uint64_t, 4> newHash256() const;
 
+    /** Hash numPaths paths at once, writing one hash() value per path
+        into out.  Produces exactly the same values as calling hash()
+        on each path in turn, but keeps the whole batch in one tight
+        loop with the single-element case inlined and the string bytes
+        of upcoming paths prefetched while the current one is hashed.
+        Meant for bulk operations (row name indexing on commit, hash
+        table builds) that hash millions of short keys.
+    */
+    static void hashMany(const Path * paths, size_t numPaths,
+                         uint64_t * out);
+
+    /** Same as hashMany(), but producing newHash() values. */
+    static void newHashMany(const Path * paths, size_t numPaths,
+                            uint64_t * out);
+
     size_t size() const
     {
         return length_;
@@ -17,6 +17,7 @@
 #include "mldb/ext/concurrentqueue/concurrentqueue.h"
 
 #include <mutex>
+#include <unordered_map>
 #include <iostream>
 
 
@@ -440,12 +441,79 @@ operator = (const Regex & other) noexcept
     swap(newMe);
     return *this;
 }
-    
+
+namespace {
+
+static const OptimizedPath cacheCompiledRegexes("mldb.regex.cacheCompiled");
+
+/** Process-wide cache of compiled regular expressions, keyed by the
+    surface form and the syntax flags.  Compiling a pattern (especially
+    the boost ICU version) is far more expensive than matching a short
+    string against it, and workloads like log parsing recompile the same
+    handful of patterns over and over from non-constant expressions.
+
+    An Impl is immutable once constructed apart from members that are
+    internally synchronized (the lazy boost compilation and the RE2
+    instance pool), so a single compiled instance can safely back any
+    number of Regex objects on any number of threads.
+*/
+struct RegexCache {
+    std::shared_ptr<Regex::Impl>
+    obtain(const Utf8String & surface, std::regex::flag_type flags)
+    {
+        // Flags go first so that the key is unambiguous no matter what
+        // characters the pattern contains
+        std::string key = std::to_string(flags) + ":" + surface.rawString();
+
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+            auto it = entries.find(key);
+            if (it != entries.end())
+                return it->second;
+        }
+
+        // Compile outside the lock; a pattern that fails to compile
+        // throws here and is never cached.
+        auto impl = std::make_shared<Regex::Impl>(surface, flags);
+
+        std::unique_lock<std::mutex> guard(mutex);
+        auto it = entries.find(key);
+        if (it != entries.end())
+            return it->second;  // another thread compiled it first
+
+        // Workloads that generate patterns dynamically would otherwise
+        // grow the cache without bound.  Clearing wholesale is crude but
+        // cheap and rare, and costs the hot patterns one recompilation
+        // each.
+        if (entries.size() >= MAX_ENTRIES)
+            entries.clear();
+
+        entries.emplace(std::move(key), impl);
+        return impl;
+    }
+
+    static constexpr size_t MAX_ENTRIES = 1024;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Regex::Impl> > entries;
+};
+
+RegexCache & regexCache()
+{
+    static RegexCache cache;
+    return cache;
+}
+
+} // file scope
+
 Regex &
 Regex::
 assign(const Utf8String & r, std::regex::flag_type flags)
 {
-    impl.reset(new Impl(r, flags));
+    if (cacheCompiledRegexes.take())
+        impl = regexCache().obtain(r, flags);
+    else
+        impl.reset(new Impl(r, flags));
     return *this;
 }
 
@@ -453,24 +521,21 @@ Regex &
 Regex::
 assign(const std::string & r, std::regex::flag_type flags)
 {
-    impl.reset(new Impl(r, flags));
-    return *this;
+    return assign(Utf8String(r), flags);
 }
 
 Regex &
 Regex::
 assign(const char * r, std::regex::flag_type flags)
 {
-    impl.reset(new Impl(r, flags));
-    return *this;
+    return assign(Utf8String(r), flags);
 }
 
 Regex &
 Regex::
 assign(const wchar_t * r, std::regex::flag_type flags)
 {
-    impl.reset(new Impl(r, flags));
-    return *this;
+    return assign(Utf8String(r), flags);
 }
 
 void
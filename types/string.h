@@ -144,9 +144,14 @@ public:
     Utf8String& operator += (char32_t ch);
 
     /*
-     * Returns access to the underlying representation - unsafe
+     * Returns access to the underlying representation - unsafe.
+     * The non-const overload moves the storage out, leaving the string
+     * empty; on a const string the storage has to be copied (note that
+     * std::move of a const member degrades to a copy, so the const
+     * overload was never a steal).
      */
-    std::string stealRawString() const { return std::move(data_); }
+    std::string stealRawString() { return std::move(data_); }
+    std::string stealRawString() const { return data_; }
     const std::string & rawString() const { return data_; }
     const std::string & utf8String() const { return data_; }
     const char * rawData() const { return data_.c_str(); }
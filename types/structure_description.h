@@ -84,6 +84,26 @@ struct StructureDescriptionBase {
     typedef std::map<const char *, FieldDescription, StrCompare> Fields;
     Fields fields;
 
+    /** Open-addressed hash table over the field names, rebuilt as fields
+        are registered.  Field name lookup is the hottest part of config
+        and REST-body decoding; probing this costs one hash and (almost
+        always) a single string compare, where the ordered map costs a
+        string compare per tree level.  Entries point into the fields map,
+        whose nodes are stable.
+    */
+    std::vector<std::pair<const char *, const FieldDescription *> > fieldHash;
+
+    /** Rebuild fieldHash from the current contents of fields.  Must be
+        called after any change to the field set; registration happens at
+        construction time, before any concurrent use.
+    */
+    void rebuildFieldHash();
+
+    /** Look up a field by name via the hash table; returns nullptr if
+        there is no such field.
+    */
+    const FieldDescription * findField(const char * name) const;
+
     /* A deleter that works with buffers allocated with malloc */
     struct FreeDeleter {
         void operator () (void * p)
@@ -213,6 +233,7 @@ struct StructureDescription
         fd.width = sizeof(V);
         fd.fieldNum = fields.size() - 1;
         orderedFields.push_back(it);
+        rebuildFieldHash();
         //using namespace std;
         //cerr << "offset = " << fd.offset << endl;
     }
@@ -248,6 +269,7 @@ struct StructureDescription
         fd.width = sizeof(V);
         fd.fieldNum = fields.size() - 1;
         orderedFields.push_back(it);
+        rebuildFieldHash();
     }
 
     /** Add a description with an automatic default value derived
@@ -434,6 +456,8 @@ addParent(ValueDescriptionT<V> * description_)
         fd.fieldNum = fields.size() - 1;
         orderedFields.push_back(it);
     }
+
+    rebuildFieldHash();
 }
 
 } // namespace MLDB
@@ -75,6 +75,53 @@ BOOST_AUTO_TEST_CASE(test_utf8_bad_string)
     BOOST_CHECK_THROW(context.expectStringUtf8(), ParseContext::Exception);
 }
 
+BOOST_AUTO_TEST_CASE(test_buffered_printing_context)
+{
+    // The buffered context must produce the same bytes as the string
+    // context, including across buffer flushes and for strings longer
+    // than the buffer itself
+
+    string expected;
+    string actual;
+
+    StringJsonPrintingContext stringContext(expected);
+
+    char buf[64];
+    BufferedJsonPrintingContext bufferedContext
+        (buf, sizeof(buf),
+         [&] (const char * p, size_t len) { actual.append(p, len); });
+
+    string longString(1000, 'x');
+    longString += "\ttail with \"quotes\" and a caf\xc3\xa9";
+
+    auto printTo = [&] (JsonPrintingContext & context)
+        {
+            context.startObject();
+            context.startMember("num");
+            context.writeDouble(0.1);
+            context.startMember("neg");
+            context.writeDouble(-3.25e-9);
+            context.startMember("int");
+            context.writeLongLong(-1234567890123LL);
+            context.startMember("str");
+            context.writeStringUtf8(Utf8String(longString));
+            context.startMember("arr");
+            context.startArray();
+            context.newArrayElement();
+            context.writeBool(true);
+            context.newArrayElement();
+            context.writeNull();
+            context.endArray();
+            context.endObject();
+        };
+
+    printTo(stringContext);
+    printTo(bufferedContext);
+    bufferedContext.finish();
+
+    BOOST_CHECK_EQUAL(actual, expected);
+}
+
 BOOST_AUTO_TEST_CASE(test_json_encode_decode_long_strings)
 {
     string needsEscaping;
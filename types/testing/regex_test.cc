@@ -0,0 +1,62 @@
+/** regex_test.cc
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Test of the UTF-8 aware regex class, in particular the process-wide
+    compiled pattern cache.
+*/
+
+#include "mldb/types/regex.h"
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace MLDB;
+
+BOOST_AUTO_TEST_CASE( test_compiled_pattern_cache )
+{
+    // Two regexes built from the same pattern and flags share one
+    // compiled implementation
+    Regex r1("[a-z]+[0-9]{2}");
+    Regex r2("[a-z]+[0-9]{2}");
+    BOOST_CHECK_EQUAL(r1.impl.get(), r2.impl.get());
+
+    // ... but different flags compile separately
+    Regex r3("[a-z]+[0-9]{2}", std::regex_constants::ECMAScript
+                               | std::regex_constants::icase);
+    BOOST_CHECK(r1.impl.get() != r3.impl.get());
+
+    // ... as do different patterns
+    Regex r4("[a-z]+[0-9]{3}");
+    BOOST_CHECK(r1.impl.get() != r4.impl.get());
+}
+
+BOOST_AUTO_TEST_CASE( test_cached_regex_matches )
+{
+    // The shared implementation behaves identically for every owner
+    Regex r1("h[ée]llo .*");
+    Regex r2("h[ée]llo .*");
+
+    BOOST_CHECK(regex_match(Utf8String("héllo world"), r1));
+    BOOST_CHECK(regex_match(Utf8String("hello world"), r2));
+    BOOST_CHECK(!regex_match(Utf8String("goodbye world"), r1));
+
+    MatchResults matches;
+    BOOST_CHECK(regex_match(Utf8String("aaa12"), matches, Regex("(a+)([0-9]+)")));
+    BOOST_REQUIRE_EQUAL(matches.size(), 3);
+    BOOST_CHECK_EQUAL(matches.str(1), "aaa");
+    BOOST_CHECK_EQUAL(matches.str(2), "12");
+}
+
+BOOST_AUTO_TEST_CASE( test_invalid_patterns_are_not_cached )
+{
+    // An invalid pattern throws every time it's compiled, not just the
+    // first
+    BOOST_CHECK_THROW(Regex("(unclosed"), std::exception);
+    BOOST_CHECK_THROW(Regex("(unclosed"), std::exception);
+}
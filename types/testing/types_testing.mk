@@ -6,6 +6,7 @@ $(eval $(call test,date_test,$(TYPES_TESTING_EXTRA_LIBS),boost))
 $(eval $(call test,localdate_test,$(TYPES_TESTING_EXTRA_LIBS),boost valgrind))
 $(eval $(call test,string_test,$(TYPES_TESTING_EXTRA_LIBS) boost_regex icui18n icuuc,boost))
 $(eval $(call set_compile_option,string_test.cc,-I$(ICU_INCLUDE_PATH) -Wno-unused))
+$(eval $(call test,regex_test,$(TYPES_TESTING_EXTRA_LIBS) boost_regex icui18n icuuc,boost))
 $(eval $(call test,json_handling_test,$(TYPES_TESTING_EXTRA_LIBS),boost))
 $(eval $(call test,value_description_test,$(TYPES_TESTING_EXTRA_LIBS),boost))
 $(eval $(call test,periodic_utils_test,$(TYPES_TESTING_EXTRA_LIBS),boost))
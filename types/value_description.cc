@@ -459,6 +459,8 @@ operator = (const StructureDescriptionBase & other)
             .first;
         orderedFields.push_back(it);
     }
+
+    rebuildFieldHash();
 }
 
 void
@@ -471,9 +473,62 @@ operator = (StructureDescriptionBase && other)
     fields = std::move(other.fields);
     fieldNames = std::move(other.fieldNames);
     orderedFields = std::move(other.orderedFields);
+    fieldHash = std::move(other.fieldHash);
     // don't set owner
 }
 
+namespace {
+
+/* FNV-1a over the field name bytes; cheap and good enough for the small
+   tables involved. */
+uint32_t hashFieldName(const char * name)
+{
+    uint32_t h = 2166136261U;
+    for (const char * p = name;  *p;  ++p) {
+        h ^= (unsigned char)*p;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+} // file scope
+
+void
+StructureDescriptionBase::
+rebuildFieldHash()
+{
+    size_t sz = 8;
+    while (sz < fields.size() * 2)
+        sz *= 2;
+
+    fieldHash.assign(sz, { nullptr, nullptr });
+
+    for (auto & f: fields) {
+        size_t bucket = hashFieldName(f.first) & (sz - 1);
+        while (fieldHash[bucket].first)
+            bucket = (bucket + 1) & (sz - 1);
+        fieldHash[bucket] = { f.first, &f.second };
+    }
+}
+
+const ValueDescription::FieldDescription *
+StructureDescriptionBase::
+findField(const char * name) const
+{
+    if (fieldHash.empty())
+        return nullptr;
+
+    size_t mask = fieldHash.size() - 1;
+    for (size_t bucket = hashFieldName(name) & mask;
+         fieldHash[bucket].first;
+         bucket = (bucket + 1) & mask) {
+        if (std::strcmp(fieldHash[bucket].first, name) == 0)
+            return fieldHash[bucket].second;
+    }
+
+    return nullptr;
+}
+
 StructureDescriptionBase::Exception::
 Exception(JsonParsingContext & context,
           const std::string & message)
@@ -529,14 +584,13 @@ parseJson(void * output, JsonParsingContext & context) const
                 try {
                     auto n = context.fieldNamePtr();
 
-                    auto it = fields.find(n);
-                    if (it == fields.end()) {
+                    const FieldDescription * fd = findField(n);
+                    if (!fd) {
                         context.onUnknownField(owner);
                     }
                     else {
-                        it->second.description
-                        ->parseJson(addOffset(output,
-                                              it->second.offset),
+                        fd->description
+                        ->parseJson(addOffset(output, fd->offset),
                                     context);
                     }
                 }
@@ -0,0 +1,281 @@
+/* async_log_sink.cc
+   Jeremy Barnes, 30 August 2026
+
+   This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+   Asynchronous spdlog sink that never blocks the logging thread.
+*/
+
+#include "async_log_sink.h"
+#include "mldb/arch/tick_counter.h"
+#include "mldb/ext/spdlog/include/spdlog/sinks/stdout_sinks.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace MLDB {
+
+namespace {
+
+/// One formatted message waiting to be written
+struct Entry {
+    uint64_t ticks = 0;
+    spdlog::level::level_enum level = spdlog::level::info;
+    std::string text;
+};
+
+/** Bounded lock-free ring (Vyukov bounded queue).  Multiple producers,
+    one consumer (the flush thread); pushes fail rather than block when
+    the ring is full.
+*/
+struct Ring {
+
+    Ring(size_t size)
+        : slots(size), mask(size - 1)
+    {
+        for (size_t i = 0;  i < size;  ++i)
+            slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    bool tryPush(Entry && entry)
+    {
+        uint64_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot & slot = slots[pos & mask];
+            uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            int64_t diff = (int64_t)seq - (int64_t)pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak
+                        (pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.entry = std::move(entry);
+                    slot.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;  // full
+            }
+            else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(Entry & entry)
+    {
+        uint64_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Slot & slot = slots[pos & mask];
+        uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        if ((int64_t)seq - (int64_t)(pos + 1) < 0)
+            return false;  // empty
+        dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        entry = std::move(slot.entry);
+        slot.seq.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return dequeuePos.load(std::memory_order_acquire)
+            == enqueuePos.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> seq;
+        Entry entry;
+    };
+
+    std::vector<Slot> slots;
+    size_t mask;
+    std::atomic<uint64_t> enqueuePos = 0;
+    std::atomic<uint64_t> dequeuePos = 0;
+};
+
+size_t roundUpToPowerOfTwo(size_t n)
+{
+    size_t result = 1;
+    while (result < n)
+        result <<= 1;
+    return result;
+}
+
+} // file scope
+
+
+/*****************************************************************************/
+/* ASYNC LOG SINK                                                            */
+/*****************************************************************************/
+
+struct AsyncLogSink::Itl {
+
+    Itl(std::shared_ptr<spdlog::sinks::sink> target, size_t queueSize)
+        : target(std::move(target))
+    {
+        size_t size = roundUpToPowerOfTwo(queueSize);
+        for (size_t i = 0;  i < NUM_LEVELS;  ++i) {
+            rings.emplace_back(new Ring(size));
+            dropped[i] = 0;
+        }
+        flushThread = std::thread([this] () { this->run(); });
+    }
+
+    ~Itl()
+    {
+        shutdown = true;
+        flushThread.join();
+
+        // The producers are gone; drain whatever is left
+        drainOnce();
+        target->flush();
+    }
+
+    static constexpr size_t NUM_LEVELS = 7;  // trace..off
+
+    std::shared_ptr<spdlog::sinks::sink> target;
+    std::vector<std::unique_ptr<Ring> > rings;  // one per severity
+    std::atomic<uint64_t> dropped[NUM_LEVELS];
+    uint64_t reportedDropped = 0;               // flush thread only
+    std::atomic<bool> shutdown = false;
+
+    std::thread flushThread;
+
+    void push(const spdlog::details::log_msg & msg)
+    {
+        Entry entry;
+        entry.ticks = ticks();
+        entry.level = msg.level;
+        entry.text.assign(msg.formatted.data(), msg.formatted.size());
+
+        size_t level = std::min<size_t>(msg.level, NUM_LEVELS - 1);
+        if (!rings[level]->tryPush(std::move(entry)))
+            dropped[level].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** Pop everything currently queued, merge it into tick order and
+        write it out.  Returns whether anything was written.
+    */
+    bool drainOnce()
+    {
+        std::vector<Entry> batch;
+
+        Entry entry;
+        for (auto & ring: rings) {
+            while (ring->tryPop(entry))
+                batch.emplace_back(std::move(entry));
+        }
+
+        if (batch.empty())
+            return false;
+
+        std::sort(batch.begin(), batch.end(),
+                  [] (const Entry & e1, const Entry & e2)
+                  {
+                      return e1.ticks < e2.ticks;
+                  });
+
+        for (auto & e: batch)
+            write(e.level, e.text);
+
+        return true;
+    }
+
+    void write(spdlog::level::level_enum level, const std::string & text)
+    {
+        spdlog::details::log_msg msg;
+        msg.level = level;
+        msg.formatted << text;
+        target->log(msg);
+    }
+
+    void reportDrops()
+    {
+        uint64_t total = totalDropped();
+        if (total == reportedDropped)
+            return;
+
+        write(spdlog::level::warn,
+              "async logger dropped "
+              + std::to_string(total - reportedDropped)
+              + " messages since last report\n");
+        reportedDropped = total;
+    }
+
+    uint64_t totalDropped() const
+    {
+        uint64_t result = 0;
+        for (size_t i = 0;  i < NUM_LEVELS;  ++i)
+            result += dropped[i].load(std::memory_order_relaxed);
+        return result;
+    }
+
+    bool allEmpty() const
+    {
+        for (auto & ring: rings) {
+            if (!ring->empty())
+                return false;
+        }
+        return true;
+    }
+
+    void run()
+    {
+        while (!shutdown.load(std::memory_order_relaxed)) {
+            if (!drainOnce()) {
+                reportDrops();
+                target->flush();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+};
+
+AsyncLogSink::
+AsyncLogSink(std::shared_ptr<spdlog::sinks::sink> target, size_t queueSize)
+    : itl(new Itl(std::move(target), queueSize))
+{
+}
+
+AsyncLogSink::
+~AsyncLogSink()
+{
+}
+
+void
+AsyncLogSink::
+log(const spdlog::details::log_msg & msg)
+{
+    itl->push(msg);
+}
+
+void
+AsyncLogSink::
+flush()
+{
+    // The flush thread owns the consumer side; wait for it to catch up
+    while (!itl->allEmpty() && !itl->shutdown)
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    itl->target->flush();
+}
+
+uint64_t
+AsyncLogSink::
+droppedMessages() const
+{
+    return itl->totalDropped();
+}
+
+std::shared_ptr<AsyncLogSink> asyncStdoutSink()
+{
+    static std::shared_ptr<AsyncLogSink> result
+        = std::make_shared<AsyncLogSink>
+            (std::make_shared<spdlog::sinks::stdout_sink_mt>());
+    return result;
+}
+
+} // namespace MLDB
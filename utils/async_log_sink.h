@@ -0,0 +1,67 @@
+/* async_log_sink.h                                                -*- C++ -*-
+   Jeremy Barnes, 30 August 2026
+
+   This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+   Asynchronous spdlog sink that never blocks the logging thread.
+*/
+
+#pragma once
+
+#include "mldb/ext/spdlog/include/spdlog/sinks/sink.h"
+#include <memory>
+
+
+namespace MLDB {
+
+/*****************************************************************************/
+/* ASYNC LOG SINK                                                            */
+/*****************************************************************************/
+
+/** Sink that decouples log producers from the (synchronous) sink it
+    wraps.
+
+    Formatted messages are pushed onto a bounded lock-free ring per
+    severity and written to the wrapped sink by a dedicated flush
+    thread, so a worker thread is never stalled behind a slow write,
+    even in an error storm.  When a ring is full the message is dropped
+    and counted rather than blocking; the flush thread periodically
+    emits a summary of anything dropped.  Messages are stamped with the
+    CPU tick counter on entry and merged across the severity rings in
+    tick order, so interleaving is preserved at nanosecond resolution.
+*/
+
+struct AsyncLogSink : public spdlog::sinks::sink {
+
+    /** Wrap the given sink.  queueSize (rounded up to a power of two)
+        is the capacity of each per-severity ring.
+    */
+    AsyncLogSink(std::shared_ptr<spdlog::sinks::sink> target,
+                 size_t queueSize = 8192);
+
+    virtual ~AsyncLogSink();
+
+    /** Enqueue the message; drops (and counts) if the ring for its
+        severity is full.  Never blocks.
+    */
+    virtual void log(const spdlog::details::log_msg & msg) override;
+
+    /** Wait for everything queued so far to reach the wrapped sink,
+        then flush it.
+    */
+    virtual void flush() override;
+
+    /** Number of messages dropped so far because a ring was full. */
+    uint64_t droppedMessages() const;
+
+private:
+    struct Itl;
+    std::unique_ptr<Itl> itl;
+};
+
+/** The shared stdout-backed async sink used by the standard loggers
+    when async logging is enabled.
+*/
+std::shared_ptr<AsyncLogSink> asyncStdoutSink();
+
+} // namespace MLDB
@@ -0,0 +1,105 @@
+/** compute_provider.cc
+    Jeremy Barnes, 30 August 2026
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    CPU implementation and registry for the compute provider interface.
+*/
+
+#include "compute_provider.h"
+#include "mldb/arch/simd_vector.h"
+#include "mldb/base/parallel.h"
+#include "mldb/utils/environment.h"
+#include <mutex>
+
+namespace MLDB {
+
+namespace {
+
+EnvOption<std::string> COMPUTE_PROVIDER("COMPUTE_PROVIDER", "");
+
+
+/*****************************************************************************/
+/* CPU COMPUTE PROVIDER                                                      */
+/*****************************************************************************/
+
+struct CpuComputeProvider: public ComputeProvider {
+
+    virtual std::string name() const
+    {
+        return "cpu";
+    }
+
+    virtual void denseMatVec(const float * A, size_t n,
+                             const double * x, double * y) const
+    {
+        auto doRows = [&] (size_t i0, size_t i1)
+            {
+                for (size_t i = i0;  i < i1;  ++i) {
+                    const float * row = A + i * n;
+                    // Accumulate in double precision for accuracy
+                    double total = 0.0;
+                    for (size_t j = 0;  j < n;  ++j)
+                        total += row[j] * x[j];
+                    y[i] = total;
+                }
+            };
+
+        // Below this size, the parallelization overhead dominates
+        if (n < 256)
+            doRows(0, n);
+        else parallelMapChunked(0, n, 64, doRows);
+    }
+
+    virtual void pairwiseSquaredDistances(const float * a, size_t numA,
+                                          const float * b, size_t numB,
+                                          size_t dims,
+                                          float * distances) const
+    {
+        auto doRows = [&] (size_t i0, size_t i1)
+            {
+                for (size_t i = i0;  i < i1;  ++i) {
+                    const float * ai = a + i * dims;
+                    float * out = distances + i * numB;
+                    for (size_t j = 0;  j < numB;  ++j)
+                        out[j] = SIMD::vec_euclid(ai, b + j * dims, dims);
+                }
+            };
+
+        if (numA * numB < 16384)
+            doRows(0, numA);
+        else parallelMapChunked(0, numA, 16, doRows);
+    }
+};
+
+std::mutex registryMutex;
+std::shared_ptr<ComputeProvider> acceleratorProvider;
+
+} // file scope
+
+ComputeProvider &
+cpuComputeProvider()
+{
+    static CpuComputeProvider provider;
+    return provider;
+}
+
+void
+registerComputeProvider(std::shared_ptr<ComputeProvider> provider)
+{
+    std::unique_lock<std::mutex> guard(registryMutex);
+    acceleratorProvider = std::move(provider);
+}
+
+ComputeProvider &
+bestComputeProvider()
+{
+    if (COMPUTE_PROVIDER.get() == "cpu")
+        return cpuComputeProvider();
+
+    std::unique_lock<std::mutex> guard(registryMutex);
+    if (acceleratorProvider)
+        return *acceleratorProvider;
+    return cpuComputeProvider();
+}
+
+} // namespace MLDB
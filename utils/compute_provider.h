@@ -0,0 +1,61 @@
+/** compute_provider.h                                             -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Execution provider interface for dense numeric kernels.  Callers go
+    through bestComputeProvider(), which returns an accelerator provider
+    when one has been registered (for example by a CUDA plugin at startup)
+    and otherwise the built-in CPU provider, so the fallback is transparent
+    to the call site.
+
+    The surface is deliberately narrow: only kernels whose arithmetic
+    intensity justifies a device round trip belong here.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace MLDB {
+
+/*****************************************************************************/
+/* COMPUTE PROVIDER                                                          */
+/*****************************************************************************/
+
+struct ComputeProvider {
+    virtual ~ComputeProvider() = default;
+
+    /** Human readable name of the provider, eg "cpu" or "cuda". */
+    virtual std::string name() const = 0;
+
+    /** y = A x for a dense row-major n x n matrix of floats.  The input
+        and output vectors are double precision, as required by Lanczos
+        style iterations that apply the matrix repeatedly. */
+    virtual void denseMatVec(const float * A, size_t n,
+                             const double * x, double * y) const = 0;
+
+    /** distances[i * numB + j] = squared euclidean distance between row i
+        of a (numA x dims, row-major) and row j of b (numB x dims). */
+    virtual void pairwiseSquaredDistances(const float * a, size_t numA,
+                                          const float * b, size_t numB,
+                                          size_t dims,
+                                          float * distances) const = 0;
+};
+
+/** The built-in CPU provider: SIMD kernels distributed over the thread
+    pool.  Always available. */
+ComputeProvider & cpuComputeProvider();
+
+/** Register an accelerator provider.  The most recently registered
+    provider wins; passing a null pointer unregisters. */
+void registerComputeProvider(std::shared_ptr<ComputeProvider> provider);
+
+/** The provider that kernel calls should go through: the registered
+    accelerator provider if there is one, otherwise the CPU provider.
+    Setting the COMPUTE_PROVIDER environment variable to "cpu" forces the
+    CPU provider even when an accelerator is registered. */
+ComputeProvider & bestComputeProvider();
+
+} // namespace MLDB
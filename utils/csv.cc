@@ -19,6 +19,29 @@ namespace MLDB {
 
 namespace {
 static const string literalDoubleQuote("\"\"");
+
+/* Character class of bytes that can be copied verbatim from an unquoted
+   CSV field: everything except the quote, the separator and line endings.
+   Cached per thread and rebuilt only when the separator changes. */
+struct CsvPlainChars {
+    char separator = 0;
+    bool valid = false;
+    bool table[256];
+
+    const bool * forSeparator(char sep)
+    {
+        if (!valid || sep != separator) {
+            for (unsigned i = 0;  i < 256;  ++i)
+                table[i] = (i != '"' && i != '\n' && i != '\r'
+                            && i != (unsigned char)sep);
+            separator = sep;
+            valid = true;
+        }
+        return table;
+    }
+};
+
+thread_local CsvPlainChars csvPlainChars;
 } // file scope
 
 std::string expect_csv_field(ParseContext & context, bool & another,
@@ -39,6 +62,11 @@ std::string expect_csv_field(ParseContext & context, bool & another,
         
         if (quoted) {
 
+            // Everything up to the next quote is literal; copy it in bulk.
+            // Hitting the end of the file first is handled below.
+            if (!context.skip_to_char('\"', &result))
+                break;
+
             if (context.match_literal(literalDoubleQuote)) {
                 result += '\"';
                 continue;
@@ -61,6 +89,12 @@ std::string expect_csv_field(ParseContext & context, bool & another,
             }
         }
         else {
+            // Bulk-copy a run of plain characters; the quote, separator
+            // and line endings are dealt with below
+            if (context.match_run_of_class(csvPlainChars.forSeparator(separator),
+                                           result))
+                continue;
+
             if (context.match_literal('\"')) {
                 if (result == "") {
                     quoted = true;
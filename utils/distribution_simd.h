@@ -141,6 +141,26 @@ operator * (const distribution<float> & d1,
     return result;
 }
 
+template<>
+inline distribution<float, std::vector<float> >
+distribution<float, std::vector<float> >::
+operator * (float val) const
+{
+    distribution<float> result(this->size());
+    SIMD::vec_scale(this->data(), val, result.data(), this->size());
+    return result;
+}
+
+template<>
+inline distribution<double, std::vector<double> >
+distribution<double, std::vector<double> >::
+operator * (double val) const
+{
+    distribution<double> result(this->size());
+    SIMD::vec_scale(this->data(), val, result.data(), this->size());
+    return result;
+}
+
 inline distribution<float> &
 operator *= (distribution<float> & d,
              float factor)
@@ -169,6 +189,78 @@ operator += (const distribution<float, std::vector<float> > & d)
     return *this;
 }
 
+template<>
+template<>
+inline distribution<float> &
+distribution<float, std::vector<float> >::
+operator += (const distribution<float, std::vector<float> > & d)
+{
+    if (this->size() != d.size())
+        wrong_sizes_exception("+= simd", this->size(), d.size());
+    SIMD::vec_add(this->data(), d.data(), this->data(), d.size());
+    return *this;
+}
+
+template<>
+template<>
+inline distribution<double> &
+distribution<double, std::vector<double> >::
+operator += (const distribution<double, std::vector<double> > & d)
+{
+    if (this->size() != d.size())
+        wrong_sizes_exception("+= simd", this->size(), d.size());
+    SIMD::vec_add(this->data(), d.data(), this->data(), d.size());
+    return *this;
+}
+
+template<>
+template<>
+inline distribution<float> &
+distribution<float, std::vector<float> >::
+operator -= (const distribution<float, std::vector<float> > & d)
+{
+    if (this->size() != d.size())
+        wrong_sizes_exception("-= simd", this->size(), d.size());
+    SIMD::vec_minus(this->data(), d.data(), this->data(), d.size());
+    return *this;
+}
+
+template<>
+template<>
+inline distribution<double> &
+distribution<double, std::vector<double> >::
+operator -= (const distribution<double, std::vector<double> > & d)
+{
+    if (this->size() != d.size())
+        wrong_sizes_exception("-= simd", this->size(), d.size());
+    SIMD::vec_minus(this->data(), d.data(), this->data(), d.size());
+    return *this;
+}
+
+template<>
+template<>
+inline distribution<float> &
+distribution<float, std::vector<float> >::
+operator *= (const distribution<float, std::vector<float> > & d)
+{
+    if (this->size() != d.size())
+        wrong_sizes_exception("*= simd", this->size(), d.size());
+    SIMD::vec_prod(this->data(), d.data(), this->data(), d.size());
+    return *this;
+}
+
+template<>
+template<>
+inline distribution<double> &
+distribution<double, std::vector<double> >::
+operator *= (const distribution<double, std::vector<double> > & d)
+{
+    if (this->size() != d.size())
+        wrong_sizes_exception("*= simd", this->size(), d.size());
+    SIMD::vec_prod(this->data(), d.data(), this->data(), d.size());
+    return *this;
+}
+
 template<>
 template<>
 inline void
@@ -202,4 +294,93 @@ exp(const distribution<double, Underlying> & dist)
     return result;
 }
 
+
+/* Fused versions of the chained expressions the classifiers and the
+   probabilizer evaluate per score.  Writing x * y + z with the
+   operators above allocates a distribution for x * y and another for
+   the sum; these run the whole expression through one kernel pass.
+*/
+
+inline distribution<float>
+multiply_add(const distribution<float> & x,
+             const distribution<float> & y,
+             const distribution<float> & z)
+{
+    if (x.size() != y.size())
+        wrong_sizes_exception("multiply_add", x.size(), y.size());
+    if (x.size() != z.size())
+        wrong_sizes_exception("multiply_add", x.size(), z.size());
+    distribution<float> result(x.size());
+    SIMD::vec_k1_x_plus_k2_y_z(1.0f, z.data(), 1.0f, x.data(), y.data(),
+                               result.data(), x.size());
+    return result;
+}
+
+inline distribution<double>
+multiply_add(const distribution<double> & x,
+             const distribution<double> & y,
+             const distribution<double> & z)
+{
+    if (x.size() != y.size())
+        wrong_sizes_exception("multiply_add", x.size(), y.size());
+    if (x.size() != z.size())
+        wrong_sizes_exception("multiply_add", x.size(), z.size());
+    distribution<double> result(x.size());
+    SIMD::vec_k1_x_plus_k2_y_z(1.0, z.data(), 1.0, x.data(), y.data(),
+                               result.data(), x.size());
+    return result;
+}
+
+/** (x * y + z).total() with no temporaries at all. */
+inline double
+multiply_add_total(const distribution<float> & x,
+                   const distribution<float> & y,
+                   const distribution<float> & z)
+{
+    if (x.size() != y.size())
+        wrong_sizes_exception("multiply_add_total", x.size(), y.size());
+    if (x.size() != z.size())
+        wrong_sizes_exception("multiply_add_total", x.size(), z.size());
+    return SIMD::vec_dotprod_dp(x.data(), y.data(), x.size())
+         + SIMD::vec_sum_dp(z.data(), z.size());
+}
+
+inline double
+multiply_add_total(const distribution<double> & x,
+                   const distribution<double> & y,
+                   const distribution<double> & z)
+{
+    if (x.size() != y.size())
+        wrong_sizes_exception("multiply_add_total", x.size(), y.size());
+    if (x.size() != z.size())
+        wrong_sizes_exception("multiply_add_total", x.size(), z.size());
+    return SIMD::vec_dotprod_dp(x.data(), y.data(), x.size())
+         + SIMD::vec_sum_dp(z.data(), z.size());
+}
+
+/** (x * y * z).total() accumulated in one pass. */
+inline double
+accum_prod3(const distribution<float> & x,
+            const distribution<float> & y,
+            const distribution<float> & z)
+{
+    if (x.size() != y.size())
+        wrong_sizes_exception("accum_prod3", x.size(), y.size());
+    if (x.size() != z.size())
+        wrong_sizes_exception("accum_prod3", x.size(), z.size());
+    return SIMD::vec_accum_prod3(x.data(), y.data(), z.data(), x.size());
+}
+
+inline double
+accum_prod3(const distribution<double> & x,
+            const distribution<double> & y,
+            const distribution<double> & z)
+{
+    if (x.size() != y.size())
+        wrong_sizes_exception("accum_prod3", x.size(), y.size());
+    if (x.size() != z.size())
+        wrong_sizes_exception("accum_prod3", x.size(), z.size());
+    return SIMD::vec_accum_prod3(x.data(), y.data(), z.data(), x.size());
+}
+
 } // namespace MLDB
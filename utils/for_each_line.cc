@@ -82,6 +82,12 @@ readStream(std::istream & stream,
 
     int64_t done = current.first = 0;  // 32 bit not enough
 
+    // Backpressure: don't let the reader run unboundedly ahead of the
+    // parsing threads.  Each queue entry holds up to 1000 lines, so this
+    // caps the readahead at a bounded number of batches rather than
+    // letting a slow consumer balloon the queue to the size of the file.
+    static constexpr size_t MAX_READAHEAD_BATCHES = 128;
+
     try {
         while (stream && !stream.eof() && (maxLines == -1 || done < maxLines)) {
 
@@ -95,6 +101,12 @@ readStream(std::istream & stream,
             ++done;
 
             if (current.second.size() == 1000) {
+                while (processing.decompressedLines.size_approx()
+                           > MAX_READAHEAD_BATCHES
+                       && !processing.hasException()
+                       && !processing.shutdown) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
                 processing.decompressedLines.enqueue(std::move(current));
                 current.first = done;
                 current.second.clear();
@@ -257,14 +269,37 @@ void forEachLineBlock(std::istream & stream,
                       std::function<bool (int64_t blockNumber, int64_t lineNumber)> startBlock,
                       std::function<bool (int64_t blockNumber, int64_t lineNumber)> endBlock)
 {
-    //static constexpr int64_t BLOCK_SIZE = 100000000;  // 100MB blocks
-    static constexpr int64_t BLOCK_SIZE = 20000000;  // 20MB blocks
+    // Block sizes adapt to the line length distribution: each block
+    // measures the mean line length of what it scanned and sizes the
+    // next block to hold around TARGET_BLOCK_LINES lines.  Short-line
+    // files therefore don't pay for oversized blocks and long-line
+    // files don't degenerate into blocks of a handful of lines, while
+    // the clamp keeps blocks big enough that the serial read/scan
+    // stage keeps up with fast storage and small enough that medium
+    // files still parallelize.
+    static constexpr int64_t TARGET_BLOCK_LINES = 500000;
+    static constexpr int64_t INITIAL_BLOCK_SIZE = 8000000;
+    static constexpr int64_t MIN_BLOCK_SIZE = 2000000;
+    static constexpr int64_t MAX_BLOCK_SIZE = 64000000;
     static constexpr int64_t READ_SIZE = 200000;  // read&scan 200kb to fit in cache
 
     std::atomic<int64_t> doneLines(0); //number of lines processed but not yet returned
     std::atomic<int64_t> returnedLines(0); //number of lines returned
     std::atomic<int64_t> byteOffset(0);
     std::atomic<int> chunkNumber(0);
+    std::atomic<int64_t> adaptiveBlockSize(INITIAL_BLOCK_SIZE);
+
+    auto updateBlockSize = [&] (int64_t bytesScanned, int64_t linesScanned)
+        {
+            if (bytesScanned <= 0 || linesScanned <= 0)
+                return;
+            int64_t meanLineLength
+                = std::max<int64_t>(1, bytesScanned / linesScanned);
+            int64_t target = meanLineLength * TARGET_BLOCK_LINES;
+            target = std::min(MAX_BLOCK_SIZE,
+                              std::max(MIN_BLOCK_SIZE, target));
+            adaptiveBlockSize.store(target, std::memory_order_relaxed);
+        };
 
     ThreadPool tp(ThreadPool::instance(), maxParallelism);
 
@@ -297,6 +332,8 @@ void forEachLineBlock(std::istream & stream,
             vector<size_t> lineOffsets = {0};
             bool lastBlock = false;
             size_t myChunkNumber = 0;
+            int64_t myBlockSize
+                = adaptiveBlockSize.load(std::memory_order_relaxed);
 
             
             try {
@@ -309,7 +346,7 @@ void forEachLineBlock(std::istream & stream,
                     const char * current = start;
                     const char * end = mapped + mappedSize;
 
-                    while (current && current < end && (current - start) < BLOCK_SIZE
+                    while (current && current < end && (current - start) < myBlockSize
                            && (maxLines == -1 || doneLines < maxLines)) { //stop processing new line when we have enough)
                         current = (const char *)memchr(current, '\n', end - current);
                         if (current && current < end) {
@@ -330,6 +367,9 @@ void forEachLineBlock(std::istream & stream,
                     
                     myChunkNumber = chunkNumber++;
 
+                    updateBlockSize(current ? current - start : end - start,
+                                    lineOffsets.size() - 1);
+
                     if (current && current < end &&
                         (maxLines == -1 || doneLines < maxLines)) // don't schedule a new block if we have enough lines
                         {
@@ -349,7 +389,7 @@ void forEachLineBlock(std::istream & stream,
                     // How much extra space to allocate for the last line?
                     static constexpr size_t EXTRA_SIZE = 10000;
 
-                    std::shared_ptr<char> block(new char[BLOCK_SIZE + EXTRA_SIZE],
+                    std::shared_ptr<char> block(new char[myBlockSize + EXTRA_SIZE],
                                                 [] (char * c) { delete[] c; });
                     blockOut = block;
 
@@ -357,10 +397,10 @@ void forEachLineBlock(std::istream & stream,
 
                     while (stream && !stream.eof()
                            && (maxLines == -1 || doneLines < maxLines)  //stop processing new line when we have enough
-                           && (byteOffset - startOffset < BLOCK_SIZE)) {
-                        
+                           && (byteOffset - startOffset < myBlockSize)) {
+
                         stream.read((char *)block.get() + offset,
-                                    std::min<size_t>(READ_SIZE, BLOCK_SIZE - offset));
+                                    std::min<size_t>(READ_SIZE, myBlockSize - offset));
 
                         // Check how many bytes we actually read
                         size_t bytesRead = stream.gcount();
@@ -405,7 +445,7 @@ void forEachLineBlock(std::istream & stream,
                 
                         if (!lastLine.empty()) {
                             // Check for overflow on the buffer size
-                            if (offset + lastLine.size() + 1 > BLOCK_SIZE + EXTRA_SIZE) {
+                            if (offset + lastLine.size() + 1 > myBlockSize + EXTRA_SIZE) {
                                 // reallocate and copy
                                 std::shared_ptr<char> newBlock(new char[offset + lastLine.size() + 1],
                                                                [] (char * c) { delete[] c; });
@@ -426,6 +466,8 @@ void forEachLineBlock(std::istream & stream,
 
                     myChunkNumber = chunkNumber++;
 
+                    updateBlockSize(offset, lineOffsets.size() - 1);
+
                     if (stream && !stream.eof() &&
                         (maxLines == -1 || doneLines < maxLines)) // don't schedule a new block if we have enough lines
                         {
@@ -109,6 +109,9 @@ forEachLineStr(const std::string & filename,
     the processing thread, at the beginning and end of the block
     respectively.
 
+    Block sizes adapt to the measured line length of the file, aiming
+    for a roughly constant number of lines per block.
+
     This is the second fastest way to parse a text file.
 */
 
@@ -0,0 +1,307 @@
+/** hnsw_index.h                                                   -*- C++ -*-
+    This file is part of MLDB. Copyright 2016 mldb.ai inc. All rights reserved.
+
+    Hierarchical Navigable Small World graph index for approximate
+    nearest neighbour search (Malkov & Yashunin).  Alternative to the
+    VantagePointTreeT for high dimensional metric spaces, where VP trees
+    degrade to near-linear scans: search cost grows roughly
+    logarithmically with the number of items, at the price of approximate
+    (not exact) results.
+*/
+
+#pragma once
+
+#include "mldb/base/exc_assert.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_set>
+#include <vector>
+
+namespace MLDB {
+
+template<typename Item>
+struct HnswIndexT {
+
+    /// Distance between two indexed items, used while building the graph
+    typedef std::function<float (const Item &, const Item &)> PairDistance;
+
+    /// Distance from the query to an indexed item, used while searching
+    typedef std::function<float (const Item &)> QueryDistance;
+
+    /** numNeighbors is the M parameter of the paper: the number of
+        graph neighbours kept per node and per level (twice that on the
+        ground level).  efConstruction is the size of the candidate list
+        used while inserting; higher values give a better graph at a
+        higher build cost.
+    */
+    HnswIndexT(int numNeighbors = 16, int efConstruction = 200)
+        : numNeighbors(numNeighbors),
+          maxNeighbors0(numNeighbors * 2),
+          efConstruction(efConstruction),
+          levelMultiplier(1.0 / std::log((double)numNeighbors))
+    {
+    }
+
+    struct Node {
+        Item item;
+        /// One adjacency list per level the node appears on
+        std::vector<std::vector<int32_t> > neighbors;
+    };
+
+    std::vector<Node> nodes;
+    int32_t entryPoint = -1;
+    int maxLevel = -1;
+
+    int numNeighbors;
+    int maxNeighbors0;
+    int efConstruction;
+    double levelMultiplier;
+
+    bool empty() const
+    {
+        return nodes.empty();
+    }
+
+    size_t memusage() const
+    {
+        size_t result = sizeof(*this) + nodes.capacity() * sizeof(Node);
+        for (const Node & node: nodes)
+            for (const auto & nb: node.neighbors)
+                result += nb.capacity() * sizeof(int32_t);
+        return result;
+    }
+
+    /** Build an index over the given items.  Items are inserted one at a
+        time; the graph structure is deterministic for a given item order.
+    */
+    static HnswIndexT *
+    create(const std::vector<Item> & items,
+           const PairDistance & distance,
+           int numNeighbors = 16,
+           int efConstruction = 200)
+    {
+        std::unique_ptr<HnswIndexT> result
+            (new HnswIndexT(numNeighbors, efConstruction));
+        result->nodes.reserve(items.size());
+        for (const Item & item: items)
+            result->insert(item, distance);
+        return result.release();
+    }
+
+    static HnswIndexT * deepCopy(const HnswIndexT * other)
+    {
+        return other ? new HnswIndexT(*other) : new HnswIndexT();
+    }
+
+    void insert(const Item & item, const PairDistance & distance)
+    {
+        int32_t id = nodes.size();
+        int level = randomLevel(id);
+
+        nodes.emplace_back
+            (Node{item, std::vector<std::vector<int32_t> >(level + 1)});
+
+        if (entryPoint == -1) {
+            entryPoint = id;
+            maxLevel = level;
+            return;
+        }
+
+        auto distTo = [&] (int32_t n)
+            {
+                return distance(item, nodes[n].item);
+            };
+
+        int32_t curr = entryPoint;
+        float currDist = distTo(curr);
+
+        // Greedily descend the levels above the new node's level
+        for (int l = maxLevel;  l > level;  --l)
+            greedyDescend(curr, currDist, l, distTo);
+
+        // On each level the node lives on, find candidates and connect
+        for (int l = std::min(level, maxLevel);  l >= 0;  --l) {
+            auto candidates
+                = searchLayer(distTo, curr, currDist, efConstruction, l);
+
+            int maxHere = (l == 0 ? maxNeighbors0 : numNeighbors);
+
+            std::vector<int32_t> & mine = nodes[id].neighbors[l];
+            for (size_t i = 0;
+                 i < candidates.size() && (int)i < numNeighbors;  ++i)
+                mine.push_back(candidates[i].second);
+
+            for (int32_t other: mine) {
+                std::vector<int32_t> & theirs = nodes[other].neighbors[l];
+                theirs.push_back(id);
+                if ((int)theirs.size() > maxHere)
+                    shrinkNeighbors(other, theirs, maxHere, distance);
+            }
+
+            if (!candidates.empty()) {
+                curr = candidates[0].second;
+                currDist = candidates[0].first;
+            }
+        }
+
+        if (level > maxLevel) {
+            maxLevel = level;
+            entryPoint = id;
+        }
+    }
+
+    /** Return up to n (distance, item) pairs for the approximate nearest
+        neighbours of the query, closest first, excluding anything past
+        maxDistance.  ef controls the breadth of the ground level search;
+        -1 uses max(2 n, 64).
+    */
+    std::vector<std::pair<float, Item> >
+    search(const QueryDistance & distance,
+           int n,
+           double maxDistance = INFINITY,
+           int ef = -1) const
+    {
+        std::vector<std::pair<float, Item> > result;
+
+        if (entryPoint == -1)
+            return result;
+
+        if (ef < 0)
+            ef = std::max(2 * n, 64);
+        ef = std::max(ef, n);
+
+        auto distTo = [&] (int32_t id)
+            {
+                return distance(nodes[id].item);
+            };
+
+        int32_t curr = entryPoint;
+        float currDist = distTo(curr);
+
+        for (int l = maxLevel;  l > 0;  --l)
+            greedyDescend(curr, currDist, l, distTo);
+
+        auto found = searchLayer(distTo, curr, currDist, ef, 0);
+
+        for (size_t i = 0;  i < found.size() && (int)result.size() < n;  ++i) {
+            if (found[i].first > maxDistance)
+                break;  // ascending order: nothing closer follows
+            result.emplace_back(found[i].first, nodes[found[i].second].item);
+        }
+
+        return result;
+    }
+
+private:
+    /** Level drawn from an exponential distribution, derived
+        deterministically from the node number so that rebuilding over the
+        same items gives the same graph.
+    */
+    int randomLevel(uint32_t id) const
+    {
+        // splitmix64-style mixing of the node number
+        uint64_t h = id + 0x9e3779b97f4a7c15ULL;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        h = h ^ (h >> 31);
+
+        double u = ((h >> 11) + 1) * (1.0 / 9007199254740993.0 /* 2^53+1 */);
+        int level = (int)(-std::log(u) * levelMultiplier);
+        return std::min(level, 31);
+    }
+
+    /** Move curr to the neighbour closest to the query on the given
+        level, repeating until no neighbour improves on it.
+    */
+    template<typename DistTo>
+    void greedyDescend(int32_t & curr, float & currDist, int level,
+                       const DistTo & distTo) const
+    {
+        bool improved = true;
+        while (improved) {
+            improved = false;
+            for (int32_t nb: nodes[curr].neighbors[level]) {
+                float d = distTo(nb);
+                if (d < currDist) {
+                    curr = nb;
+                    currDist = d;
+                    improved = true;
+                }
+            }
+        }
+    }
+
+    /** Beam search of one level, returning up to ef (distance, node)
+        pairs in ascending distance order.
+    */
+    template<typename DistTo>
+    std::vector<std::pair<float, int32_t> >
+    searchLayer(const DistTo & distTo, int32_t entry, float entryDist,
+                int ef, int level) const
+    {
+        typedef std::pair<float, int32_t> Entry;
+
+        // Closest unexpanded candidates first
+        std::priority_queue<Entry, std::vector<Entry>,
+                            std::greater<Entry> > candidates;
+        // Furthest kept result first, so the worst is cheap to evict
+        std::priority_queue<Entry> results;
+        std::unordered_set<int32_t> visited;
+
+        visited.insert(entry);
+        candidates.emplace(entryDist, entry);
+        results.emplace(entryDist, entry);
+
+        while (!candidates.empty()) {
+            Entry curr = candidates.top();
+
+            if ((int)results.size() >= ef && curr.first > results.top().first)
+                break;
+
+            candidates.pop();
+
+            for (int32_t nb: nodes[curr.second].neighbors[level]) {
+                if (!visited.insert(nb).second)
+                    continue;
+
+                float d = distTo(nb);
+                if ((int)results.size() < ef || d < results.top().first) {
+                    candidates.emplace(d, nb);
+                    results.emplace(d, nb);
+                    if ((int)results.size() > ef)
+                        results.pop();
+                }
+            }
+        }
+
+        std::vector<Entry> out(results.size());
+        for (int i = (int)out.size() - 1;  i >= 0;  --i) {
+            out[i] = results.top();
+            results.pop();
+        }
+
+        return out;
+    }
+
+    /** Keep only the maxHere neighbours of owner that are closest to it. */
+    void shrinkNeighbors(int32_t owner, std::vector<int32_t> & neighbors,
+                         int maxHere, const PairDistance & distance)
+    {
+        std::vector<std::pair<float, int32_t> > byDist;
+        byDist.reserve(neighbors.size());
+        for (int32_t nb: neighbors)
+            byDist.emplace_back(distance(nodes[owner].item, nodes[nb].item),
+                                nb);
+        std::sort(byDist.begin(), byDist.end());
+
+        neighbors.clear();
+        for (int i = 0;  i < maxHere;  ++i)
+            neighbors.push_back(byDist[i].second);
+    }
+};
+
+} // namespace MLDB
@@ -517,12 +517,31 @@ struct LightweightHashBase {
         size_ = 0;
     }
 
-    bool count(const Key & key) const
+    /** Templated on the probe key so that lookups with a type the Ops
+        can hash and compare directly (heterogeneous lookup) don't need
+        to construct a Key first. */
+    template<typename K>
+    bool count(const K & key) const
     {
         ssize_t bucket = this->find_full_bucket(key);
         return bucket != NO_BUCKET;
     }
 
+    /** Prefetch the home bucket for the given key.  Batch probe loops
+        (joins, group bys, id resolution) can issue prefetches a few
+        keys ahead of the matching lookups so that the dependent cache
+        misses overlap instead of serializing.
+    */
+    template<typename K>
+    void prefetch(const K & key) const
+    {
+        ssize_t cap = capacity();
+        if (cap == 0 || Ops::isGuardValue(key))
+            return;
+        __builtin_prefetch(&storage_[Ops::hashKey(key, cap, storage_)],
+                           0 /* read */, 3 /* locality */);
+    }
+
     static void destroyBucketFromDestructor(Bucket * bucket)
     {
         try {
@@ -637,7 +656,8 @@ public:
 
 protected:
     //__attribute__((__noinline__))
-    ssize_t find_bucket(const Key & key) const
+    template<typename K>
+    ssize_t find_bucket(const K & key) const
     {
         using namespace std;
 
@@ -688,7 +708,8 @@ protected:
         return NO_BUCKET;
     }
 
-    ssize_t find_full_bucket(const Key & key) const
+    template<typename K>
+    ssize_t find_full_bucket(const K & key) const
     {
         ssize_t bucket = find_bucket(key);
         if (bucket == NO_BUCKET || !Ops::bucketIsFull(storage_, bucket)) return NO_BUCKET;
@@ -764,7 +785,7 @@ protected:
             ExcAssert(!Ops::isGuardValue(key));
         }
         
-        if (needs_expansion()) {
+        if (needs_expansion() || displacement_exceeded(bucket, key)) {
             // expand
             reserve(std::max<size_t>(4, capacity() * 2));
             bucket = find_bucket(key);
@@ -780,6 +801,30 @@ protected:
         return bucket;
     }
 
+    /** Bound on how far linear probing may push a new entry past its
+        home bucket.  Clustering makes probe runs grow superlinearly as
+        the load factor rises; once an insertion lands this far from
+        home, a rehash is cheaper than the probes every later lookup of
+        the cluster would pay.
+    */
+    static constexpr ssize_t MAX_DISPLACEMENT = 32;
+
+    bool displacement_exceeded(ssize_t bucket, const Key & key) const
+    {
+        ssize_t cap = capacity();
+        if (bucket < 0 || cap < 2 * MAX_DISPLACEMENT)
+            return false;
+        // Only arms above 50% load: long runs at low load come from a
+        // stride-y hash, which doubling can't fix, not from clustering
+        if (2 * size_ < cap)
+            return false;
+        ssize_t home = Ops::hashKey(key, cap, storage_);
+        ssize_t displacement = bucket - home;
+        if (displacement < 0)
+            displacement += cap;
+        return displacement > MAX_DISPLACEMENT;
+    }
+
     ssize_t advance_to_valid(ssize_t index) const
     {
         using namespace std;
@@ -1018,14 +1063,19 @@ struct LightweightHash
         return const_iterator(this, this->capacity());
     }
 
-    iterator find(const Key & key)
+    /** Templated on the probe key for heterogeneous lookup; anything
+        the Ops can hash and compare against a bucket works without
+        constructing a Key. */
+    template<typename K>
+    iterator find(const K & key)
     {
         ssize_t bucket = this->find_full_bucket(key);
         if (bucket == NO_BUCKET) return end();
         return iterator(this, bucket);
     }
 
-    const_iterator find(const Key & key) const
+    template<typename K>
+    const_iterator find(const K & key) const
     {
         ssize_t bucket = this->find_full_bucket(key);
         if (bucket == NO_BUCKET) return end();
@@ -1271,7 +1321,8 @@ struct LightweightHashSet
         return const_iterator(this, this->capacity());
     }
 
-    const_iterator find(const Key & key) const
+    template<typename K>
+    const_iterator find(const K & key) const
     {
         ssize_t bucket = this->find_full_bucket(key);
         if (bucket == NO_BUCKET) return end();
@@ -7,7 +7,9 @@
 */
 
 #include "log.h"
+#include "mldb/utils/async_log_sink.h"
 #include "mldb/utils/config.h"
+#include "mldb/utils/environment.h"
 #include "mldb/arch/exception.h"
 
 namespace {
@@ -32,11 +34,25 @@ namespace MLDB {
 
 static constexpr char const * timestampFormat = "%Y-%m-%dT%T.%e%z";
 
+/* Route all loggers through the shared non-blocking sink.  Messages are
+   queued and written by a dedicated thread, and are dropped (with
+   accounting) rather than ever blocking a worker thread behind a slow
+   write.
+*/
+static EnvOption<bool> ASYNC_LOGGING("MLDB_ASYNC_LOGGING", false);
+
 std::shared_ptr<spdlog::logger> getConfiguredLogger(const std::string & name, const std::string & format) {
     /* If this is replaced with another logger (e.g. a file logger) make sure to pick one that
        is thread-safe (i.e. with suffix _mt) for many loggers are used on multiple threads by MLDB.
     */
-    std::shared_ptr<spdlog::logger> logger = spdlog::stdout_logger_mt(name);
+    std::shared_ptr<spdlog::logger> logger;
+    if (ASYNC_LOGGING) {
+        logger = std::make_shared<spdlog::logger>(name, asyncStdoutSink());
+        spdlog::register_logger(logger);
+    }
+    else {
+        logger = spdlog::stdout_logger_mt(name);
+    }
     logger->set_pattern(format);
     return logger;
 }
@@ -0,0 +1,171 @@
+/** memory_arena.h                                                 -*- C++ -*-
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Bump-pointer memory arena for transient, bounded-lifetime allocations.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "mldb/arch/exception.h"
+#include "mldb/base/exc_assert.h"
+
+namespace MLDB {
+
+/*****************************************************************************/
+/* MEMORY ARENA                                                              */
+/*****************************************************************************/
+
+/** A simple bump-pointer arena.  Allocation is a pointer increment within
+    the current block, with a new (doubled) block chained on when the
+    current one is exhausted.  Individual allocations are never freed;
+    instead the whole arena is reset at a known point, at which all
+    memory handed out becomes invalid but the largest block is kept for
+    reuse so a steady-state workload stops touching the heap entirely.
+
+    Typical use is per-query or per-row scratch space: anything that must
+    outlive the reset point must be copied out (or allocated normally)
+    before the arena is reset.  The arena is not thread safe; use one per
+    thread.
+*/
+
+struct MemoryArena {
+    MemoryArena(size_t initialBlockSize = 4096)
+        : initialBlockSize(initialBlockSize)
+    {
+    }
+
+    MemoryArena(const MemoryArena &) = delete;
+    MemoryArena & operator = (const MemoryArena &) = delete;
+
+    /** Allocate bytes with the given alignment (which must be a power of
+        two).  The memory is uninitialized and remains valid until the
+        next reset().
+    */
+    void * allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+    {
+        ExcAssert((alignment & (alignment - 1)) == 0);
+
+        uintptr_t aligned = (current + alignment - 1) & ~(alignment - 1);
+        if (aligned + bytes > currentEnd) {
+            addBlock(bytes + alignment);
+            aligned = (current + alignment - 1) & ~(alignment - 1);
+        }
+        current = aligned + bytes;
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    /** Allocate space for n objects of type T.  Construction is up to the
+        caller; destructors are never run by the arena.
+    */
+    template<typename T>
+    T * allocate(size_t n)
+    {
+        return static_cast<T *>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    /** Invalidate everything allocated so far, keeping the largest block
+        for reuse.
+    */
+    void reset()
+    {
+        if (blocks.empty()) {
+            return;
+        }
+        if (blocks.size() > 1) {
+            // Keep only the last (largest) block
+            blocks.front() = std::move(blocks.back());
+            blocks.resize(1);
+        }
+        current = reinterpret_cast<uintptr_t>(blocks.front().data.get());
+        currentEnd = current + blocks.front().size;
+    }
+
+    /** Total bytes of capacity currently held. */
+    size_t capacity() const
+    {
+        size_t result = 0;
+        for (auto & b: blocks)
+            result += b.size;
+        return result;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+
+    void addBlock(size_t atLeast)
+    {
+        size_t size = blocks.empty()
+            ? initialBlockSize : blocks.back().size * 2;
+        if (size < atLeast)
+            size = atLeast;
+        Block block;
+        block.data.reset(new char[size]);
+        block.size = size;
+        current = reinterpret_cast<uintptr_t>(block.data.get());
+        currentEnd = current + size;
+        blocks.emplace_back(std::move(block));
+    }
+
+    size_t initialBlockSize;
+    uintptr_t current = 0;
+    uintptr_t currentEnd = 0;
+    std::vector<Block> blocks;
+};
+
+
+/*****************************************************************************/
+/* ARENA ALLOCATOR                                                           */
+/*****************************************************************************/
+
+/** Standard-library allocator adaptor over a MemoryArena, so containers
+    holding transient data can draw their buffers from the arena.
+    Deallocation is a no-op; the memory is reclaimed when the arena is
+    reset, so containers using it must not outlive that point.
+*/
+
+template<typename T>
+struct ArenaAllocatorT {
+    typedef T value_type;
+
+    ArenaAllocatorT(MemoryArena * arena)
+        : arena(arena)
+    {
+    }
+
+    template<typename U>
+    ArenaAllocatorT(const ArenaAllocatorT<U> & other)
+        : arena(other.arena)
+    {
+    }
+
+    T * allocate(size_t n)
+    {
+        return arena->template allocate<T>(n);
+    }
+
+    void deallocate(T *, size_t)
+    {
+        // Reclaimed wholesale on arena reset
+    }
+
+    bool operator == (const ArenaAllocatorT & other) const
+    {
+        return arena == other.arena;
+    }
+
+    bool operator != (const ArenaAllocatorT & other) const
+    {
+        return arena != other.arena;
+    }
+
+    MemoryArena * arena;
+};
+
+} // namespace MLDB
@@ -0,0 +1,243 @@
+/** product_quantizer.h                                            -*- C++ -*-
+    This file is part of MLDB. Copyright 2016 mldb.ai inc. All rights reserved.
+
+    Product quantizer (Jegou et al) for compressed storage of dense float
+    vectors.  The dimensions are split into contiguous subspaces; each
+    subspace gets a codebook of up to 256 centroids trained with k-means,
+    and a vector is stored as one 8 bit centroid code per subspace.  A
+    256 dimensional float32 vector compressed with 32 subspaces goes from
+    1024 bytes to 32 bytes at the price of approximate reconstruction.
+
+    Squared euclidean distances against a query can be answered straight
+    from the codes with an ADC (asymmetric distance computation) table:
+    the query's partial squared distance to every centroid of every
+    subspace is precomputed once, after which each stored vector costs
+    one table lookup and one add per subspace.
+*/
+
+#pragma once
+
+#include "mldb/base/exc_assert.h"
+#include "mldb/base/parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace MLDB {
+
+struct ProductQuantizer {
+
+    /// Accessor for the training / encoding data: returns a pointer to
+    /// the dims coordinates of the given vector.
+    typedef std::function<const float * (size_t)> GetVector;
+
+    int dims = 0;               ///< Dimensions of the vectors quantized
+    int numSubspaces = 0;       ///< Number of 8 bit codes per vector
+    int numCentroids = 0;       ///< Centroids per codebook; at most 256
+
+    /// Start dimension of each subspace; numSubspaces + 1 entries
+    std::vector<int> subOffsets;
+
+    /// Subspace that each dimension belongs to
+    std::vector<uint16_t> dimToSubspace;
+
+    /// Per subspace, numCentroids * subspace width floats, centroid major
+    std::vector<std::vector<float> > codebooks;
+
+    /// At most this many vectors are used to train the codebooks; the
+    /// rest are sampled over with a constant stride.
+    static constexpr size_t MAX_TRAINING_VECTORS = 65536;
+
+    int subspaceWidth(int subspace) const
+    {
+        return subOffsets[subspace + 1] - subOffsets[subspace];
+    }
+
+    size_t memusage() const
+    {
+        size_t result = sizeof(*this)
+            + subOffsets.capacity() * sizeof(int)
+            + dimToSubspace.capacity() * sizeof(uint16_t);
+        for (const auto & cb: codebooks)
+            result += cb.capacity() * sizeof(float);
+        return result;
+    }
+
+    /** Train codebooks over the given vectors using k-means in each
+        subspace.  numSubspaces is clamped to dims; dimensions are dealt
+        out as evenly as possible.  Training is deterministic for a given
+        input: centroids are seeded from evenly spaced vectors.
+    */
+    static ProductQuantizer *
+    train(const GetVector & getVector,
+          size_t numVectors,
+          int dims,
+          int numSubspaces,
+          int numIterations = 10)
+    {
+        ExcAssertGreater(dims, 0);
+        ExcAssertGreater(numSubspaces, 0);
+        ExcAssertGreater(numVectors, 0);
+
+        std::unique_ptr<ProductQuantizer> result(new ProductQuantizer());
+        result->dims = dims;
+        result->numSubspaces = std::min<int>(numSubspaces, dims);
+        result->numCentroids = (int)std::min<size_t>(256, numVectors);
+
+        int m = result->numSubspaces;
+        result->subOffsets.resize(m + 1);
+        for (int s = 0;  s <= m;  ++s)
+            result->subOffsets[s] = (int)((int64_t)dims * s / m);
+
+        result->dimToSubspace.resize(dims);
+        for (int s = 0;  s < m;  ++s)
+            for (int d = result->subOffsets[s];
+                 d < result->subOffsets[s + 1];  ++d)
+                result->dimToSubspace[d] = s;
+
+        size_t stride = std::max<size_t>(1, numVectors / MAX_TRAINING_VECTORS);
+        size_t numTraining = (numVectors + stride - 1) / stride;
+
+        result->codebooks.resize(m);
+
+        auto trainSubspace = [&] (size_t s)
+            {
+                int off = result->subOffsets[s];
+                int w = result->subspaceWidth(s);
+                int k = result->numCentroids;
+
+                std::vector<float> & centroids = result->codebooks[s];
+                centroids.resize((size_t)k * w);
+
+                // Seed from evenly spaced training vectors
+                for (int c = 0;  c < k;  ++c) {
+                    const float * vec
+                        = getVector((size_t)c * numTraining / k * stride);
+                    std::copy(vec + off, vec + off + w,
+                              centroids.begin() + (size_t)c * w);
+                }
+
+                std::vector<double> sums((size_t)k * w);
+                std::vector<size_t> counts(k);
+
+                for (int iter = 0;  iter < numIterations;  ++iter) {
+                    std::fill(sums.begin(), sums.end(), 0.0);
+                    std::fill(counts.begin(), counts.end(), 0);
+
+                    for (size_t n = 0;  n < numTraining;  ++n) {
+                        const float * vec = getVector(n * stride) + off;
+                        int best = nearestCentroid(vec, centroids, k, w);
+                        double * sum = &sums[(size_t)best * w];
+                        for (int d = 0;  d < w;  ++d)
+                            sum[d] += vec[d];
+                        counts[best] += 1;
+                    }
+
+                    for (int c = 0;  c < k;  ++c) {
+                        if (counts[c] == 0)
+                            continue;  // keep the previous centroid
+                        float * centroid = &centroids[(size_t)c * w];
+                        const double * sum = &sums[(size_t)c * w];
+                        for (int d = 0;  d < w;  ++d)
+                            centroid[d] = sum[d] / counts[c];
+                    }
+                }
+            };
+
+        parallelMap(0, m, trainSubspace);
+
+        return result.release();
+    }
+
+    /** Quantize a vector of dims coordinates into numSubspaces codes. */
+    void encode(const float * vec, uint8_t * codes) const
+    {
+        for (int s = 0;  s < numSubspaces;  ++s) {
+            codes[s] = nearestCentroid(vec + subOffsets[s], codebooks[s],
+                                       numCentroids, subspaceWidth(s));
+        }
+    }
+
+    /** Reconstruct the (approximate) vector for the given codes. */
+    void decode(const uint8_t * codes, float * vec) const
+    {
+        for (int s = 0;  s < numSubspaces;  ++s) {
+            int w = subspaceWidth(s);
+            const float * centroid = &codebooks[s][(size_t)codes[s] * w];
+            std::copy(centroid, centroid + w, vec + subOffsets[s]);
+        }
+    }
+
+    /** Reconstruct a single coordinate; one codebook lookup, no full
+        decode needed.
+    */
+    float decodeOne(const uint8_t * codes, int dim) const
+    {
+        int s = dimToSubspace.at(dim);
+        return codebooks[s][(size_t)codes[s] * subspaceWidth(s)
+                            + dim - subOffsets[s]];
+    }
+
+    /** Build the ADC table for a query of dims coordinates: the squared
+        euclidean distance from the query to every centroid of every
+        subspace, numCentroids entries per subspace.
+    */
+    std::vector<float> buildQueryTable(const float * query) const
+    {
+        std::vector<float> table((size_t)numSubspaces * numCentroids);
+
+        for (int s = 0;  s < numSubspaces;  ++s) {
+            int w = subspaceWidth(s);
+            const float * q = query + subOffsets[s];
+            for (int c = 0;  c < numCentroids;  ++c) {
+                const float * centroid = &codebooks[s][(size_t)c * w];
+                float total = 0.0f;
+                for (int d = 0;  d < w;  ++d) {
+                    float diff = q[d] - centroid[d];
+                    total += diff * diff;
+                }
+                table[(size_t)s * numCentroids + c] = total;
+            }
+        }
+
+        return table;
+    }
+
+    /** Squared euclidean distance between the query the table was built
+        for and the vector with the given codes.
+    */
+    float adcSquaredDist(const uint8_t * codes, const float * table) const
+    {
+        float total = 0.0f;
+        for (int s = 0;  s < numSubspaces;  ++s)
+            total += table[(size_t)s * numCentroids + codes[s]];
+        return total;
+    }
+
+private:
+    static int nearestCentroid(const float * vec,
+                               const std::vector<float> & centroids,
+                               int numCentroids, int width)
+    {
+        int best = 0;
+        float bestDist = INFINITY;
+        for (int c = 0;  c < numCentroids;  ++c) {
+            const float * centroid = &centroids[(size_t)c * width];
+            float total = 0.0f;
+            for (int d = 0;  d < width;  ++d) {
+                float diff = vec[d] - centroid[d];
+                total += diff * diff;
+            }
+            if (total < bestDist) {
+                bestDist = total;
+                best = c;
+            }
+        }
+        return best;
+    }
+};
+
+} // namespace MLDB
@@ -0,0 +1,180 @@
+/** quantile_sketch.h                                              -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Mergeable t-digest sketch for estimating quantiles of a stream of
+    numeric values in constant memory.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+namespace MLDB {
+
+/*****************************************************************************/
+/* QUANTILE SKETCH                                                           */
+/*****************************************************************************/
+
+/** Approximate quantile sketch (a t-digest).  Values are accumulated
+    into at most a few hundred weighted centroids whose sizes shrink
+    towards the tails, so the relative rank error is proportional to
+    q(1-q): a fraction of a percentile at the median and tighter at the
+    extremes.  Sketches built over different parts of a stream can be
+    merged, which makes them suitable for per-chunk statistics combined
+    on demand.
+*/
+
+struct QuantileSketch {
+
+    /// Bounds the number of centroids kept; higher is more accurate
+    /// and bigger.  100 keeps at most ~200 centroids (about 3KB).
+    static constexpr double COMPRESSION = 100.0;
+
+    /// Additions are buffered and folded in batches; the buffer also
+    /// bounds the transient memory of the sketch.
+    static constexpr size_t BUFFER_SIZE = 512;
+
+    struct Centroid {
+        double mean;
+        double weight;
+
+        bool operator < (const Centroid & other) const
+        {
+            return mean < other.mean;
+        }
+    };
+
+    std::vector<Centroid> centroids;  ///< Sorted by mean once compressed
+    std::vector<Centroid> buffer;     ///< Additions not yet folded in
+    double total = 0;
+    double minValue = INFINITY;
+    double maxValue = -INFINITY;
+
+    /** Record one value with the given weight (eg, the number of rows
+        that hold it).  Non-finite values are ignored.
+    */
+    void add(double value, double weight = 1.0)
+    {
+        if (!std::isfinite(value) || weight <= 0)
+            return;
+        buffer.push_back({value, weight});
+        total += weight;
+        minValue = std::min(minValue, value);
+        maxValue = std::max(maxValue, value);
+        if (buffer.size() >= BUFFER_SIZE)
+            compress();
+    }
+
+    /** Fold the other sketch into this one, as if its values had been
+        added here.
+    */
+    void merge(const QuantileSketch & other)
+    {
+        buffer.insert(buffer.end(),
+                      other.centroids.begin(), other.centroids.end());
+        buffer.insert(buffer.end(),
+                      other.buffer.begin(), other.buffer.end());
+        total += other.total;
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+        compress();
+    }
+
+    bool empty() const
+    {
+        return total == 0;
+    }
+
+    double totalWeight() const
+    {
+        return total;
+    }
+
+    /** Fold the buffered additions into the centroid list.  Called
+        automatically; exposed so a finished sketch can be compacted
+        before it is cached or shared.
+    */
+    void compress()
+    {
+        if (buffer.empty())
+            return;
+
+        centroids.insert(centroids.end(), buffer.begin(), buffer.end());
+        buffer.clear();
+        std::sort(centroids.begin(), centroids.end());
+
+        std::vector<Centroid> merged;
+        merged.reserve(2 * (size_t)COMPRESSION);
+
+        double wSoFar = 0;
+        for (const Centroid & c: centroids) {
+            if (merged.empty()) {
+                merged.push_back(c);
+                continue;
+            }
+
+            Centroid & back = merged.back();
+
+            // A centroid may cover q(1-q)-proportional mass, which is
+            // what concentrates resolution in the tails.
+            double q = (wSoFar + (back.weight + c.weight) * 0.5) / total;
+            double limit = 4.0 * total * q * (1.0 - q) / COMPRESSION;
+
+            if (back.weight + c.weight <= limit) {
+                back.mean += (c.mean - back.mean)
+                    * (c.weight / (back.weight + c.weight));
+                back.weight += c.weight;
+            }
+            else {
+                wSoFar += back.weight;
+                merged.push_back(c);
+            }
+        }
+
+        centroids = std::move(merged);
+    }
+
+    /** Return the approximate value at quantile q in [0,1].  Returns
+        NaN for an empty sketch.
+
+        Uses nearest-rank semantics over the centroids: the answer is
+        the mean of the centroid that holds the target rank, so when no
+        merging has happened (small inputs) the result is exactly the
+        nearest-rank quantile of the values that were added.
+    */
+    double quantile(double q) const
+    {
+        if (total == 0)
+            return NAN;
+        if (!buffer.empty()) {
+            // Rare path: answer through a compacted copy so that the
+            // sketch itself can be shared read-only.
+            QuantileSketch compacted(*this);
+            compacted.compress();
+            return compacted.quantile(q);
+        }
+        if (q <= 0)
+            return minValue;
+        if (q >= 1)
+            return maxValue;
+
+        double target = q * total;
+        double cum = 0;
+
+        for (const Centroid & c: centroids) {
+            cum += c.weight;
+            if (target <= cum)
+                return c.mean;
+        }
+
+        return maxValue;
+    }
+};
+
+} // namespace MLDB
@@ -0,0 +1,248 @@
+/** row_bitmap.h                                                   -*- C++ -*-
+    Jeremy Barnes, 30 August 2026
+    Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+    This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+    Compressed bitmap over row numbers, used to pass filter results
+    between the frozen column kernels and the scan machinery, and as
+    a compact row membership set for sampling and tranche handling.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <vector>
+
+namespace MLDB {
+
+/** Compressed bitmap over row numbers, in the style of a Roaring bitmap:
+    rows are grouped in blocks of 65536, with each block stored either as
+    a sorted array of 16 bit offsets (sparse) or as a packed bitmap
+    (dense), whichever is smaller.
+*/
+struct RowBitmap {
+    static constexpr size_t BLOCK_SIZE = 65536;
+    static constexpr size_t ARRAY_MAX = 4096;  ///< past this, bits are smaller
+
+    struct Block {
+        bool dense = false;
+        std::vector<uint16_t> array;   ///< sorted row offsets, sparse blocks
+        std::vector<uint64_t> bits;    ///< packed bits, dense blocks
+
+        size_t count() const
+        {
+            if (!dense)
+                return array.size();
+            size_t result = 0;
+            for (uint64_t w: bits)
+                result += __builtin_popcountll(w);
+            return result;
+        }
+
+        /// Offsets must be added in increasing order
+        void set(uint16_t offset)
+        {
+            if (dense) {
+                bits[offset / 64] |= 1ULL << (offset % 64);
+                return;
+            }
+            array.push_back(offset);
+            if (array.size() > ARRAY_MAX)
+                makeDense();
+        }
+
+        void makeDense()
+        {
+            bits.assign(BLOCK_SIZE / 64, 0);
+            for (uint16_t o: array)
+                bits[o / 64] |= 1ULL << (o % 64);
+            array.clear();
+            array.shrink_to_fit();
+            dense = true;
+        }
+
+        bool test(uint16_t offset) const
+        {
+            if (dense)
+                return bits[offset / 64] & (1ULL << (offset % 64));
+            return std::binary_search(array.begin(), array.end(), offset);
+        }
+
+        /// Insert in any order; returns true if the offset was newly set
+        bool insert(uint16_t offset)
+        {
+            if (dense) {
+                uint64_t & word = bits[offset / 64];
+                uint64_t bit = 1ULL << (offset % 64);
+                if (word & bit)
+                    return false;
+                word |= bit;
+                return true;
+            }
+            auto it = std::lower_bound(array.begin(), array.end(), offset);
+            if (it != array.end() && *it == offset)
+                return false;
+            array.insert(it, offset);
+            if (array.size() > ARRAY_MAX)
+                makeDense();
+            return true;
+        }
+
+        template<typename Fn>
+        bool forEach(Fn && fn) const
+        {
+            if (!dense) {
+                for (uint16_t o: array) {
+                    if (!fn(o))
+                        return false;
+                }
+                return true;
+            }
+            for (size_t w = 0;  w < bits.size();  ++w) {
+                uint64_t word = bits[w];
+                while (word) {
+                    int b = __builtin_ctzll(word);
+                    word &= word - 1;
+                    if (!fn((uint16_t)(w * 64 + b)))
+                        return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    std::map<uint32_t, Block> blocks;
+
+    /// Rows must be added in increasing order
+    void set(uint64_t row)
+    {
+        blocks[row / BLOCK_SIZE].set(row % BLOCK_SIZE);
+    }
+
+    /// Insert rows in any order; returns true if the row was newly set
+    bool insert(uint64_t row)
+    {
+        return blocks[row / BLOCK_SIZE].insert(row % BLOCK_SIZE);
+    }
+
+    bool test(uint64_t row) const
+    {
+        auto it = blocks.find(row / BLOCK_SIZE);
+        if (it == blocks.end())
+            return false;
+        return it->second.test(row % BLOCK_SIZE);
+    }
+
+    size_t count() const
+    {
+        size_t result = 0;
+        for (auto & b: blocks)
+            result += b.second.count();
+        return result;
+    }
+
+    /// Call fn(rowNumber) for each set row, in increasing order
+    template<typename Fn>
+    bool forEach(Fn && fn) const
+    {
+        for (auto & b: blocks) {
+            uint64_t base = (uint64_t)b.first * BLOCK_SIZE;
+            auto onOffset = [&] (uint16_t o)
+                {
+                    return fn(base + o);
+                };
+            if (!b.second.forEach(onOffset))
+                return false;
+        }
+        return true;
+    }
+
+    void orWith(const RowBitmap & other)
+    {
+        for (auto & ob: other.blocks) {
+            auto it = blocks.find(ob.first);
+            if (it == blocks.end()) {
+                blocks[ob.first] = ob.second;
+                continue;
+            }
+            Block & b = it->second;
+            const Block & o = ob.second;
+            if (!b.dense && !o.dense) {
+                std::vector<uint16_t> merged;
+                merged.reserve(b.array.size() + o.array.size());
+                std::set_union(b.array.begin(), b.array.end(),
+                               o.array.begin(), o.array.end(),
+                               std::back_inserter(merged));
+                b.array = std::move(merged);
+                if (b.array.size() > ARRAY_MAX)
+                    b.makeDense();
+                continue;
+            }
+            if (!b.dense)
+                b.makeDense();
+            if (o.dense) {
+                for (size_t i = 0;  i < b.bits.size();  ++i)
+                    b.bits[i] |= o.bits[i];
+            }
+            else {
+                for (uint16_t off: o.array)
+                    b.bits[off / 64] |= 1ULL << (off % 64);
+            }
+        }
+    }
+
+    void andWith(const RowBitmap & other)
+    {
+        for (auto it = blocks.begin();  it != blocks.end();  /* no inc */) {
+            auto oit = other.blocks.find(it->first);
+            if (oit == other.blocks.end()) {
+                it = blocks.erase(it);
+                continue;
+            }
+            Block & b = it->second;
+            const Block & o = oit->second;
+            if (!b.dense && !o.dense) {
+                std::vector<uint16_t> merged;
+                std::set_intersection(b.array.begin(), b.array.end(),
+                                      o.array.begin(), o.array.end(),
+                                      std::back_inserter(merged));
+                b.array = std::move(merged);
+            }
+            else if (b.dense && o.dense) {
+                for (size_t i = 0;  i < b.bits.size();  ++i)
+                    b.bits[i] &= o.bits[i];
+            }
+            else if (!b.dense) {
+                // sparse & dense: filter our array through their bits
+                b.array.erase(std::remove_if(b.array.begin(), b.array.end(),
+                                             [&] (uint16_t off)
+                                             {
+                                                 return !o.test(off);
+                                             }),
+                              b.array.end());
+            }
+            else {
+                // dense & sparse: the result is at most their array
+                std::vector<uint16_t> merged;
+                for (uint16_t off: o.array) {
+                    if (b.test(off))
+                        merged.push_back(off);
+                }
+                b.dense = false;
+                b.bits.clear();
+                b.bits.shrink_to_fit();
+                b.array = std::move(merged);
+            }
+
+            if (b.count() == 0)
+                it = blocks.erase(it);
+            else ++it;
+        }
+    }
+};
+
+} // namespace MLDB
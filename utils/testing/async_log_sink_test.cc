@@ -0,0 +1,111 @@
+// This file is part of MLDB. Copyright 2026 mldb.ai inc. All rights reserved.
+
+/* async_log_sink_test.cc
+   Jeremy Barnes, 30 August 2026
+   Copyright (c) 2026 mldb.ai inc.  All rights reserved.
+
+   Test of the asynchronous log sink.
+*/
+
+#include "mldb/utils/async_log_sink.h"
+#include "mldb/ext/spdlog/include/spdlog/sinks/ostream_sink.h"
+#include "mldb/ext/spdlog/include/spdlog/spdlog.h"
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace MLDB;
+
+BOOST_AUTO_TEST_CASE( test_messages_arrive_in_order )
+{
+    ostringstream stream;
+    auto target = make_shared<spdlog::sinks::ostream_sink_mt>(stream);
+    auto sink = make_shared<AsyncLogSink>(target);
+
+    auto logger = make_shared<spdlog::logger>("async-test", sink);
+    logger->set_pattern("%v");
+
+    for (int i = 0;  i < 100;  ++i)
+        logger->info("message {}", i);
+
+    sink->flush();
+
+    istringstream lines(stream.str());
+    string line;
+    int n = 0;
+    while (getline(lines, line)) {
+        BOOST_CHECK_EQUAL(line, "message " + to_string(n));
+        ++n;
+    }
+    BOOST_CHECK_EQUAL(n, 100);
+    BOOST_CHECK_EQUAL(sink->droppedMessages(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( test_multithreaded_never_loses_or_blocks )
+{
+    ostringstream stream;
+    auto target = make_shared<spdlog::sinks::ostream_sink_mt>(stream);
+    auto sink = make_shared<AsyncLogSink>(target);
+
+    auto logger = make_shared<spdlog::logger>("async-test-mt", sink);
+    logger->set_pattern("%v");
+
+    constexpr int numThreads = 4;
+    constexpr int perThread = 1000;
+
+    vector<thread> threads;
+    for (int t = 0;  t < numThreads;  ++t) {
+        threads.emplace_back([&, t] ()
+                             {
+                                 for (int i = 0;  i < perThread;  ++i)
+                                     logger->info("thread {} message {}", t, i);
+                             });
+    }
+    for (auto & t: threads)
+        t.join();
+
+    sink->flush();
+
+    istringstream lines(stream.str());
+    string line;
+    size_t numLines = 0;
+    while (getline(lines, line))
+        ++numLines;
+
+    // Every message either arrived or was counted as dropped
+    BOOST_CHECK_EQUAL(numLines + sink->droppedMessages(),
+                      numThreads * perThread);
+}
+
+BOOST_AUTO_TEST_CASE( test_full_ring_drops_and_counts )
+{
+    // A tiny ring and a sink that's slow to construct messages for:
+    // overflow must drop, not block
+    ostringstream stream;
+    auto target = make_shared<spdlog::sinks::ostream_sink_mt>(stream);
+    auto sink = make_shared<AsyncLogSink>(target, 4 /* queueSize */);
+
+    auto logger = make_shared<spdlog::logger>("async-test-full", sink);
+    logger->set_pattern("%v");
+
+    for (int i = 0;  i < 10000;  ++i)
+        logger->info("message {}", i);
+
+    sink->flush();
+
+    istringstream lines(stream.str());
+    string line;
+    size_t numLines = 0;
+    while (getline(lines, line)) {
+        if (line.find("dropped") == string::npos)
+            ++numLines;
+    }
+
+    BOOST_CHECK_EQUAL(numLines + sink->droppedMessages(), 10000);
+}
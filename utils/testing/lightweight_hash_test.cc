@@ -239,3 +239,34 @@ BOOST_AUTO_TEST_CASE(test_insert_guard_object)
     }
 }
 
+
+BOOST_AUTO_TEST_CASE(test_prefetch_and_heterogeneous_find)
+{
+    int nobj = 10000;
+
+    LightweightHash<uint64_t, int> h;
+    for (int j = 1;  j <= nobj;  ++j)
+        h.insert({(uint64_t)j * 7919, j});
+
+    // Software-pipelined probe loop: prefetch a few keys ahead of the
+    // lookups, as batch join/group-by probes do
+    constexpr int PIPELINE = 8;
+    for (int j = 1;  j <= nobj;  ++j) {
+        if (j + PIPELINE <= nobj)
+            h.prefetch((uint64_t)(j + PIPELINE) * 7919);
+        auto it = h.find((uint64_t)j * 7919);
+        BOOST_REQUIRE(it != h.end());
+        BOOST_CHECK_EQUAL(it->second, j);
+    }
+
+    // Heterogeneous probes: no uint64_t key needs to be constructed by
+    // the caller for these to compile and hit
+    BOOST_CHECK_EQUAL(h.count(7919u), 1);
+    BOOST_CHECK_EQUAL(h.count((int16_t)7919), 1);
+    BOOST_CHECK(h.find(7919u) != h.end());
+
+    // Prefetching something absent (or the guard value) is harmless
+    h.prefetch((uint64_t)0);
+    h.prefetch((uint64_t)123456789);
+    BOOST_CHECK_EQUAL(h.count((uint64_t)123456789), 0);
+}
@@ -16,6 +16,7 @@ $(eval $(call test,json_hash_test,json_diff value_description arch,boost))
 $(eval $(call test,command_expression_test,command_expression value_description arch types test_utils,boost))
 $(eval $(call test,config_test,config boost_program_options,boost))
 $(eval $(call test,logger_test,log,boost))
+$(eval $(call test,async_log_sink_test,log,boost))
 $(eval $(call test,compact_vector_test,arch,boost))
 $(eval $(call test,fixture_test,test_utils,boost))
 $(eval $(call test,print_utils_test,,boost))
@@ -1,7 +1,7 @@
 # This file is part of MLDB. Copyright 2015 mldb.ai inc. All rights reserved.
 
 $(eval $(call library,config,config.cc,boost_program_options))
-$(eval $(call library,log,log.cc, arch config))
+$(eval $(call library,log,log.cc async_log_sink.cc, arch config))
 
 
 LIBUTILS_SOURCES := \
@@ -12,6 +12,7 @@ LIBUTILS_SOURCES := \
 	buckets.cc \
 	confidence_intervals.cc \
 	quadtree.cc \
+	compute_provider.cc \
 	for_each_line.cc \
 	tmpdir.cc \
 
@@ -11,12 +11,12 @@
 
 #include "mldb/utils/distribution.h"
 #include "mldb/base/exc_assert.h"
+#include "mldb/base/thread_pool.h"
 #include "mldb/types/db/persistent.h"
 #include "mldb/utils/compact_vector.h"
 #include "mldb/types/db/compact_vector_persistence.h"
 #include <iostream>
-#include <thread>
-#include <future>
+#include <type_traits>
 
 namespace MLDB {
 
@@ -114,10 +114,29 @@ struct VantagePointTreeT {
         return createParallel(objectsToInsert, distances, 0);
     }
 
+    /** Bulk load the tree, parallelizing the construction of large
+        subtrees over the thread pool.  Each median split that leaves a
+        subtree over a size limit schedules its build as a pool job; the
+        tree is complete once the work group is drained.  The structure
+        produced is identical to a serial build.
+    */
     static VantagePointTreeT *
-    createParallel(const std::vector<Item> & objectsToInsert_,
+    createParallel(const std::vector<Item> & objectsToInsert,
                    const std::function<distribution<float> (Item, const std::vector<Item> &, int)> & distance,
                    int depth = 0)
+    {
+        ThreadWorkGroup tp;
+        std::unique_ptr<VantagePointTreeT> result
+            (createNode(objectsToInsert, distance, depth, tp));
+        tp.waitForAll();
+        return result.release();
+    }
+
+    static VantagePointTreeT *
+    createNode(const std::vector<Item> & objectsToInsert_,
+               const std::function<distribution<float> (Item, const std::vector<Item> &, int)> & distance,
+               int depth,
+               ThreadPool & tp)
     {
         using namespace std;
 
@@ -274,87 +293,50 @@ struct VantagePointTreeT {
             }
 #endif
 
-            std::unique_ptr<VantagePointTreeT> inside, outside;
-            std::thread insideThread, outsideThread;
-
-            auto doInside = [&] ()
-                {
-                    std::sort(insideObjects.begin(), insideObjects.end());
-                    if (!insideObjects.empty())
-                        inside.reset(createParallel(insideObjects, distance, depth + 1));
-                };
-
-            auto doOutside = [&] ()
+            // Construct the node up front with empty children; the jobs
+            // below fill the child pointers in place.  The node stays
+            // alive until the work group is drained, since it's owned by
+            // the chain of callers under createParallel, which doesn't
+            // return before waitForAll().
+            std::unique_ptr<VantagePointTreeT> node
+                (new VantagePointTreeT(std::move(items), radius,
+                                       nullptr, nullptr));
+
+            auto buildChild = [&tp, &distance]
+                (std::vector<Item> objects,
+                 std::unique_ptr<VantagePointTreeT> & child,
+                 int childDepth)
                 {
-                    std::sort(outsideObjects.begin(), outsideObjects.end());
-                    if (!outsideObjects.empty())
-                        outside.reset(createParallel(outsideObjects, distance, depth + 1));
+                    std::sort(objects.begin(), objects.end());
+                    child.reset(createNode(objects, distance, childDepth, tp));
                 };
 
-            std::packaged_task<void ()> insideTask(doInside), outsideTask(doOutside);
-            std::future<void> insideFuture, outsideFuture;
-
-            static constexpr int PARALLEL_MAX_DEPTH = 5;
+            // Subtrees over the limit are scheduled on the pool; smaller
+            // ones are built inline.  The pool queues jobs rather than
+            // spawning a thread each, so no depth or balance heuristic is
+            // needed to bound the parallelism.
             static constexpr size_t PARALLEL_LIMIT = 10000;
-            static constexpr float PARALLEL_MAX_RATIO=10;
-
-            float ratio =
-                1.0 * std::max(insideObjects.size(), outsideObjects.size())
-                / std::min(insideObjects.size(), outsideObjects.size());
-
-            bool parallelInside
-                = isfinite(ratio)
-                && ratio < PARALLEL_MAX_RATIO
-                && insideObjects.size() >= PARALLEL_LIMIT
-                && depth <= PARALLEL_MAX_DEPTH;
-
-            bool parallelOutside
-                = isfinite(ratio)
-                && ratio < PARALLEL_MAX_RATIO
-                && outsideObjects.size() >= PARALLEL_LIMIT
-                && depth <= PARALLEL_MAX_DEPTH;
-
-            if (parallelInside) {
-                insideFuture = insideTask.get_future();
-                insideThread = std::thread(std::move(insideTask));
-            }
-
-            if (parallelOutside) {
-                outsideFuture = outsideTask.get_future();
-                outsideThread = std::thread(std::move(outsideTask));
-            }
-
-            if (!parallelInside) {
-                doInside();
-            }
-            if (!parallelOutside) {
-                doOutside();
-            }
 
-            if (parallelInside) {
-                insideThread.join();
-                insideFuture.wait();
-            }
-            if (parallelOutside) {
-                outsideThread.join();
-                outsideFuture.wait();
-            }
-#if 0
-            cerr << "depth = " << depth << " to insert " << objectsToInsert.size()
-                 << " pivot items " << items.size()
-                 << " inside " << insideObjects.size() << " outside "
-                 << outsideObjects.size() << " firstNonZero " << firstNonZero
-                 << " sp " << splitPoint << " radius " << radius << " first "
-                 << sorted[firstNonZero].first << " last " << sorted.back().first
-                 << endl;
-            if (outsideObjects.empty() && sorted.size() < 200) {
-                cerr << distances << endl;
-            }
-#endif
+            auto doChild = [&] (std::vector<Item> & objects,
+                                std::unique_ptr<VantagePointTreeT> & child)
+                {
+                    if (objects.empty())
+                        return;
+                    if (objects.size() >= PARALLEL_LIMIT) {
+                        tp.add([buildChild, objects = std::move(objects),
+                                &child, depth] () mutable
+                               {
+                                   buildChild(std::move(objects), child,
+                                              depth + 1);
+                               });
+                    }
+                    else buildChild(std::move(objects), child, depth + 1);
+                };
 
+            doChild(insideObjects, node->inside);
+            doChild(outsideObjects, node->outside);
 
-            return new VantagePointTreeT(items, radius,
-                                         std::move(inside), std::move(outside));
+            return node.release();
         }
     }
 
@@ -538,4 +520,224 @@ struct VantagePointTreeT {
 
 typedef VantagePointTreeT<int> VantagePointTree;
 
+
+/** Flattened, read-only form of the vantage point tree.  All nodes live
+    in one contiguous array in breadth-first order with the root at index
+    zero, and all per-node items in a second one, so a search touches a
+    couple of dense arrays instead of chasing heap pointers, and the whole
+    structure serializes and reconstitutes as two bulk copies with no
+    rebuild.
+*/
+template<typename Item>
+struct VantagePointTreeFlatT {
+
+    struct Node {
+        double radius;      ///< Radius of the inside versus outside ball
+        uint32_t itemBase;  ///< First entry in items for this node
+        uint32_t numItems;  ///< Pivot items, all at distance zero
+        uint32_t numClump;  ///< Clump items, following the pivot items
+        int32_t inside;     ///< Index of the inside child, or -1
+        int32_t outside;    ///< Index of the outside child, or -1
+    };
+
+    /// Nodes in breadth-first order; the root is nodes[0]
+    std::vector<Node> nodes;
+
+    /// Pivot then clump items of each node, contiguous
+    std::vector<Item> items;
+
+    bool empty() const
+    {
+        return nodes.empty();
+    }
+
+    /** Flatten the given tree.  A null tree gives an empty result. */
+    static VantagePointTreeFlatT
+    freeze(const VantagePointTreeT<Item> * root)
+    {
+        VantagePointTreeFlatT result;
+        if (!root)
+            return result;
+
+        // Scanning the order vector front to back while appending the
+        // children of each node visited yields breadth-first order
+        std::vector<const VantagePointTreeT<Item> *> order;
+        order.push_back(root);
+
+        for (size_t i = 0;  i < order.size();  ++i) {
+            const VantagePointTreeT<Item> * n = order[i];
+
+            Node node;
+            node.radius = n->radius;
+            node.itemBase = result.items.size();
+            node.numItems = n->items.size();
+            node.numClump = n->clump.size();
+            node.inside = -1;
+            node.outside = -1;
+
+            result.items.insert(result.items.end(),
+                                n->items.begin(), n->items.end());
+            result.items.insert(result.items.end(),
+                                n->clump.begin(), n->clump.end());
+
+            if (n->inside) {
+                node.inside = order.size();
+                order.push_back(n->inside.get());
+            }
+            if (n->outside) {
+                node.outside = order.size();
+                order.push_back(n->outside.get());
+            }
+
+            result.nodes.push_back(node);
+        }
+
+        return result;
+    }
+
+    /** Return the at most n closest neighbours, which must all have a
+        distance of less than maximumDist.  Same algorithm and results as
+        VantagePointTreeT::search.
+    */
+    std::vector<std::pair<float, Item> >
+    search(const std::function<float (Item)> & distance,
+           int n,
+           float maximumDist) const
+    {
+        if (nodes.empty() || nodes[0].numItems == 0)
+            return {};
+        return searchNode(0, distance, n, maximumDist);
+    }
+
+    size_t memusage() const
+    {
+        return sizeof(*this)
+            + sizeof(Node) * nodes.capacity()
+            + sizeof(Item) * items.capacity();
+    }
+
+    void serialize(DB::Store_Writer & store) const
+    {
+        static_assert(std::is_trivially_copyable<Item>::value,
+                      "flat tree serialization needs a trivially copyable "
+                      "item type");
+        using namespace MLDB::DB;
+        store << compact_size_t(nodes.size())
+              << compact_size_t(items.size());
+        store.save_binary(nodes.data(), nodes.size() * sizeof(Node));
+        store.save_binary(items.data(), items.size() * sizeof(Item));
+    }
+
+    void reconstitute(DB::Store_Reader & store)
+    {
+        static_assert(std::is_trivially_copyable<Item>::value,
+                      "flat tree serialization needs a trivially copyable "
+                      "item type");
+        using namespace MLDB::DB;
+        compact_size_t numNodes(store), numItems(store);
+        nodes.resize(numNodes);
+        items.resize(numItems);
+        store.load_binary(nodes.data(), nodes.size() * sizeof(Node));
+        store.load_binary(items.data(), items.size() * sizeof(Item));
+    }
+
+private:
+    std::vector<std::pair<float, Item> >
+    searchNode(int32_t nodeIndex,
+               const std::function<float (Item)> & distance,
+               int n,
+               float maximumDist) const
+    {
+        const Node & node = nodes[nodeIndex];
+        const Item * nodeItems = items.data() + node.itemBase;
+
+        std::vector<std::pair<float, Item> > result;
+
+        // Add the results to the current set of nearest neighbours
+        auto addResults = [&] (const std::vector<std::pair<float, Item> > & found)
+            {
+                result.insert(result.end(), found.begin(), found.end());
+
+                // Prune out solutions not viable
+                std::sort(result.begin(), result.end());
+                if (result.size() > n) {
+                    result.resize(n);
+                    maximumDist = result.back().first;
+                }
+            };
+
+        // First, find the distance to the object at this node
+        float pivotDistance = distance(nodeItems[0]);
+
+        if (pivotDistance <= maximumDist) {
+            // As for the pointer tree, we call distance() for every item
+            // rather than assuming they are all at the pivot distance, to
+            // tolerate distance functions where dist(x,x) != dist(x,y)
+            // for equal coordinates (MLDB-1044)
+            result.emplace_back(pivotDistance, nodeItems[0]);
+            for (unsigned i = 1;  i < node.numItems;  ++i)
+                result.emplace_back(distance(nodeItems[i]), nodeItems[i]);
+        }
+
+        if (result.size() > n)
+            result.resize(n);
+
+        if (node.numClump > 0) {
+            // Get the distance to each item in the clump
+            std::vector<std::pair<float, Item> > clumpResult;
+
+            for (unsigned i = 0;  i < node.numClump;  ++i) {
+                Item item = nodeItems[node.numItems + i];
+                float dist = distance(item);
+                if (dist <= maximumDist) {
+                    clumpResult.emplace_back(dist, item);
+                }
+            }
+
+            addResults(clumpResult);
+
+            return result;
+        }
+
+        if (node.inside == -1 && node.outside == -1)
+            return result;
+
+        int32_t toSearchFirst;
+        int32_t toSearchSecond = -1;
+        float closestPossibleSecond = INFINITY;
+
+        // Choose which subtree to search first, and the condition for
+        // searching the second one
+        if (node.inside == -1)
+            toSearchFirst = node.outside;
+        else if (node.outside == -1)
+            toSearchFirst = node.inside;
+        else if (pivotDistance < node.radius) {
+            toSearchFirst = node.inside;
+            toSearchSecond = node.outside;
+            closestPossibleSecond = node.radius - pivotDistance;
+        }
+        else {
+            toSearchFirst = node.outside;
+            toSearchSecond = node.inside;
+            closestPossibleSecond = pivotDistance - node.radius;
+        }
+
+        addResults(searchNode(toSearchFirst, distance, n, maximumDist));
+
+        // We are conservative by this factor with distance comparisons, to
+        // make the algorithm somewhat robust to slight numerical differences.
+        float fudgeFactor = 1.00001f;
+
+        if (toSearchSecond != -1 &&
+            (result.size() < n || maximumDist * fudgeFactor >= closestPossibleSecond)) {
+            addResults(searchNode(toSearchSecond, distance, n, maximumDist));
+        }
+
+        return result;
+    }
+};
+
+typedef VantagePointTreeFlatT<int> VantagePointTreeFlat;
+
 } // namespace MLDB
@@ -80,6 +80,23 @@ struct Compressor {
     static Compressor * create(const std::string & compression,
                                int level);
 
+    /** Create a compressor producing the format of the given scheme, but
+        chopping the input into independent blocks that are compressed in
+        parallel on up to numThreads worker threads and written out in
+        order.  The output is a concatenation of independent frames,
+        which decoders of the supported formats (zstd, gzip, lz4) accept
+        as a single stream, at a small cost in compression ratio since no
+        references cross block boundaries.
+
+        A blockSize of zero selects the default of 8MB.  With numThreads
+        of one or less the plain compressor for the scheme is returned.
+        Returns nullptr if the compression scheme isn't found.
+    */
+    static Compressor * createParallel(const std::string & compression,
+                                       int level,
+                                       int numThreads,
+                                       size_t blockSize = 0);
+
     /** Describes a compressor. */
     struct Info {
         std::string name;
@@ -31,6 +31,7 @@
 #include <unordered_map>
 #include "fs_utils.h"
 #include "mldb/base/exc_assert.h"
+#include "mldb/io/ring_buffer.h"
 
 
 using namespace std;
@@ -243,6 +244,141 @@ struct BoostDecompressor {
 };
 
 
+/*****************************************************************************/
+/* READAHEAD SOURCE                                                          */
+/*****************************************************************************/
+
+/** Source device that pulls an inner stream (typically a decompression
+    chain) from its own thread into a bounded ring of blocks, so that the
+    consumer and the decompressor run in parallel rather than
+    serializing.
+*/
+
+struct ReadaheadSource {
+    typedef char char_type;
+
+    struct category
+        : public boost::iostreams::input,
+          public boost::iostreams::device_tag,
+          public boost::iostreams::closable_tag {
+    };
+
+    static constexpr size_t BLOCK_SIZE = 256 * 1024;
+    static constexpr size_t NUM_BLOCKS = 16;
+
+    ReadaheadSource(std::shared_ptr<std::istream> inner)
+        : itl(new Itl(std::move(inner)))
+    {
+    }
+
+    std::streamsize read(char * s, std::streamsize n)
+    {
+        if (n == 0)
+            return 0;
+
+        while (itl->currentPos == itl->current.size()) {
+            if (itl->eofSeen)
+                return -1;
+            itl->current = itl->ring.pop();
+            itl->currentPos = 0;
+            if (itl->current.empty()) {
+                /* empty block marks the end of the inner stream */
+                itl->eofSeen = true;
+                if (itl->exc)
+                    std::rethrow_exception(itl->exc);
+                return -1;
+            }
+        }
+
+        size_t toDo = std::min<size_t>(n, itl->current.size()
+                                       - itl->currentPos);
+        std::copy(itl->current.data() + itl->currentPos,
+                  itl->current.data() + itl->currentPos + toDo,
+                  s);
+        itl->currentPos += toDo;
+        return toDo;
+    }
+
+    void close()
+    {
+        itl->shutdown();
+    }
+
+private:
+    /* Boost copies devices around, so all state is shared. */
+    struct Itl {
+        Itl(std::shared_ptr<std::istream> inner)
+            : inner(std::move(inner)),
+              ring(NUM_BLOCKS)
+        {
+            thread = std::thread([this] () { this->run(); });
+        }
+
+        ~Itl()
+        {
+            shutdown();
+        }
+
+        /* Runs on the readahead thread. */
+        void run()
+        {
+            try {
+                while (!stop) {
+                    std::string block(BLOCK_SIZE, '\0');
+                    inner->read(&block[0], block.size());
+                    block.resize(inner->gcount());
+                    if (block.empty())
+                        break;
+                    if (!pushBlock(std::move(block)))
+                        return;  // stopped; no need for an end marker
+                }
+            }
+            catch (...) {
+                /* Stashed before the end marker is pushed, so that the
+                   consumer sees it once it has drained the ring. */
+                exc = std::current_exception();
+            }
+            pushBlock(std::string());
+        }
+
+        bool pushBlock(std::string && block)
+        {
+            while (!stop) {
+                if (ring.tryPush(std::move(block)))
+                    return true;
+                /* The window is full; the consumer is the bottleneck, so
+                   a short sleep costs nothing. */
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return false;
+        }
+
+        void shutdown()
+        {
+            stop = true;
+            if (thread.joinable())
+                thread.join();
+        }
+
+        std::shared_ptr<std::istream> inner;
+
+        /* readahead thread */
+        std::exception_ptr exc;
+
+        /* consumer thread */
+        std::string current;      /* block being consumed */
+        size_t currentPos = 0;    /* position within current */
+        bool eofSeen = false;
+
+        /* shared */
+        RingBufferSWMR<std::string> ring;
+        std::atomic<bool> stop{false};
+        std::thread thread;
+    };
+
+    std::shared_ptr<Itl> itl;
+};
+
 
 /*****************************************************************************/
 /* FILTER_OSTREAM                                                            */
@@ -349,31 +485,30 @@ void addCompression(streambuf & buf,
                     boost::iostreams::filtering_ostream & stream,
                     const std::string & resource,
                     const std::string & compression,
-                    int compressionLevel)
+                    int compressionLevel,
+                    int compressionThreads = 1)
 {
     using namespace boost::iostreams;
 
     if (compression == "none") {
         // nothing to do
+        return;
     }
-    else if (compression != "") {
-        Compressor * compressor
-            = Compressor::create(compression, compressionLevel);
-        if (!compressor)
-            throw MLDB::Exception("unknown filter compression " + compression);
-        stream.push(BoostCompressor(compressor));
-    }
-    else {
-        std::string compressionFromFilename
-            = Compressor::filenameToCompression(resource);
-        if (compressionFromFilename != "") {
-            Compressor * compressor
-                = Compressor::create(compressionFromFilename, compressionLevel);
-            if (!compressor)
-                throw MLDB::Exception("unknown filter compression " + compression);
-            stream.push(BoostCompressor(compressor));
-        }
-    }
+
+    std::string scheme = compression;
+    if (scheme == "")
+        scheme = Compressor::filenameToCompression(resource);
+    if (scheme == "")
+        return;
+
+    Compressor * compressor
+        = (compressionThreads > 1
+           ? Compressor::createParallel(scheme, compressionLevel,
+                                        compressionThreads)
+           : Compressor::create(scheme, compressionLevel));
+    if (!compressor)
+        throw MLDB::Exception("unknown filter compression " + compression);
+    stream.push(BoostCompressor(compressor));
 }
 
 void addCompression(streambuf & buf,
@@ -390,8 +525,14 @@ void addCompression(streambuf & buf,
     it = options.find("compressionLevel");
     if (it != options.end())
         compressionLevel = boost::lexical_cast<int>(it->second);
-    
-    addCompression(buf, stream, resource, compression, compressionLevel);
+
+    int compressionThreads = 1;
+    it = options.find("compressionThreads");
+    if (it != options.end())
+        compressionThreads = boost::lexical_cast<int>(it->second);
+
+    addCompression(buf, stream, resource, compression, compressionLevel,
+                   compressionThreads);
 }
 
 
@@ -834,14 +975,20 @@ openFromHandler(const UriHandler & handler,
     auto cmpIt = options.find("compression");
     if (cmpIt != options.end())
         compression = cmpIt->second;
-    
+
+    bool readahead = false;
+    auto raIt = options.find("readahead");
+    if (raIt != options.end())
+        readahead = (raIt->second == "1" || raIt->second == "true");
+
     this->handlerOptions = handler.options;
     this->info_ = handler.info;
     if (!this->info_)
         throw MLDB::Exception("Handler for resource '" + resource
                             + "' didn't set info");
     ExcAssert(this->info_);
-    openFromStreambuf(handler.buf, handler.bufOwnership, resource, compression);
+    openFromStreambuf(handler.buf, handler.bufOwnership, resource, compression,
+                      readahead);
 }
 
 void
@@ -849,7 +996,8 @@ filter_istream::
 openFromStreambuf(std::streambuf * buf,
                   std::shared_ptr<void> bufOwnership,
                   const std::string & resource,
-                  const std::string & compression)
+                  const std::string & compression,
+                  bool readahead)
 {
     // TODO: exception safety for buf
 
@@ -871,6 +1019,20 @@ openFromStreambuf(std::streambuf * buf,
 
     if (!new_stream->empty()) {
         new_stream->push(*buf);
+
+        if (readahead) {
+            /* Move the decompression chain onto its own thread: the
+               inner stream is pulled by a ReadaheadSource into a bounded
+               ring of decompressed blocks that the consumer drains.  The
+               inner stream is kept alive by the source; the underlying
+               buffer stays owned by our sink member, which outlives the
+               stream. */
+            std::shared_ptr<std::istream> inner(new_stream.release());
+            unique_ptr<filtering_istream> outer(new filtering_istream());
+            outer->push(ReadaheadSource(std::move(inner)));
+            new_stream = std::move(outer);
+        }
+
         this->stream = std::move(new_stream);
 
         // MLDB-1140: if we add compression, we are no longer mappable, seekable,
@@ -251,7 +251,8 @@ public:
     void openFromStreambuf(std::streambuf * buf,
                            std::shared_ptr<void> bufOwnership,
                            const std::string & resource = "",
-                           const std::string & compression = "");
+                           const std::string & compression = "",
+                           bool readahead = false);
 
     void openFromHandler(const UriHandler & handler,
                          const std::string & resource,
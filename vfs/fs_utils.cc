@@ -10,6 +10,7 @@
 
 #include <libgen.h>
 
+#include <atomic>
 #include <memory>
 #include <map>
 #include <mutex>
@@ -22,6 +23,7 @@
 
 #include "mldb/vfs/fs_utils.h"
 #include "mldb/base/scope.h"
+#include "mldb/base/thread_pool.h"
 #include "mldb/vfs/filter_streams_registry.h"
 
 #include <sys/types.h>
@@ -339,6 +341,89 @@ getEtag(const Url & url) const
     return getInfo(url).etag;
 }
 
+bool
+UrlFsHandler::
+forEachParallel(const Url & prefix,
+                const OnUriObject & onObject,
+                const OnUriSubdir & onSubdir,
+                const std::string & delimiter,
+                const std::string & startAt,
+                int maxParallelism) const
+{
+    // Without a subdirectory callback there is nothing to partition on,
+    // and resuming from a marker doesn't compose with partitioning
+    if (!onSubdir || delimiter.empty() || maxParallelism <= 1
+        || startAt != "")
+        return forEach(prefix, onObject, onSubdir, delimiter, startAt);
+
+    std::mutex callbackMutex;     // serializes calls to the callbacks
+    std::atomic<bool> stopped(false);
+
+    auto onObjectSync = [&] (const std::string & uri,
+                             const FsObjectInfo & info,
+                             const OpenUriObject & open,
+                             int depth) -> bool
+        {
+            if (stopped)
+                return false;
+            std::unique_lock<std::mutex> guard(callbackMutex);
+            if (stopped)
+                return false;
+            if (!onObject(uri, info, open, depth)) {
+                stopped = true;
+                return false;
+            }
+            return true;
+        };
+
+    auto onSubdirSync = [&] (const std::string & dirName, int depth) -> bool
+        {
+            if (stopped)
+                return false;
+            std::unique_lock<std::mutex> guard(callbackMutex);
+            return onSubdir(dirName, depth);
+        };
+
+    // Phase 1: list the top level only, streaming its objects straight to
+    // the callback and collecting the partitions to list in parallel
+    std::vector<std::string> partitions;
+
+    auto onTopSubdir = [&] (const std::string & dirName, int depth) -> bool
+        {
+            if (onSubdirSync(dirName, depth))
+                partitions.push_back(dirName);
+            return false;   // we do the recursion ourselves, in parallel
+        };
+
+    forEach(prefix, onObjectSync, onTopSubdir, delimiter, "");
+
+    if (stopped)
+        return false;
+
+    // Phase 2: list each partition concurrently.  Within a partition the
+    // listing is serial and streams pages as they arrive; deeper
+    // subdirectories are recursed into on the same thread.
+    if (!partitions.empty()) {
+        ThreadPool tp(std::min<int>(maxParallelism, partitions.size()));
+
+        for (auto & p: partitions) {
+            auto listPartition = [&, p] ()
+                {
+                    if (stopped)
+                        return;
+                    this->forEach(Url(p + delimiter), onObjectSync,
+                                  onSubdirSync, delimiter, "");
+                };
+            tp.add(listPartition);
+        }
+
+        // Rethrows the first exception thrown by a partition listing
+        tp.waitForAll();
+    }
+
+    return !stopped;
+}
+
 
 /* registry */
 
@@ -425,6 +510,18 @@ bool forEachUriObject(const std::string & urlPrefix,
         ->forEach(realUrl, onObject, onSubdir, delimiter, startAt);
 }
 
+bool forEachUriObjectParallel(const std::string & urlPrefix,
+                              const OnUriObject & onObject,
+                              const OnUriSubdir & onSubdir,
+                              const std::string & delimiter,
+                              int maxParallelism)
+{
+    Url realUrl = makeUrl(urlPrefix);
+    return findFsHandler(realUrl.scheme())
+        ->forEachParallel(realUrl, onObject, onSubdir, delimiter, "",
+                          maxParallelism);
+}
+
 string
 baseName(const std::string & filename)
 {
@@ -109,6 +109,25 @@ struct UrlFsHandler {
                          const OnUriSubdir & onSubdir,
                          const std::string & delimiter,
                          const std::string & startAt) const = 0;
+
+    /** Like forEach, but lists disjoint key ranges concurrently when the
+        backend supports delimiter-based partitioning.  The top level is
+        listed first, streaming its objects to the callback while the
+        partitions (subdirectories) are discovered; each partition is then
+        listed on its own thread.
+
+        Callback invocations are serialized, but may come from different
+        threads, and objects from different partitions arrive interleaved.
+        Recursion depth is relative to each partition.  Falls back to the
+        serial forEach when there is no subdirectory callback, no
+        delimiter, or a startAt marker.
+    */
+    virtual bool forEachParallel(const Url & prefix,
+                                 const OnUriObject & onObject,
+                                 const OnUriSubdir & onSubdir,
+                                 const std::string & delimiter,
+                                 const std::string & startAt,
+                                 int maxParallelism) const;
 };
 
 /** Register a new handler for handling URIs of the given scheme. */
@@ -184,6 +203,21 @@ bool forEachUriObject(const std::string & uriPrefix,
                       const std::string & delimiter = "/",
                       const std::string & startAt = "");
 
+/** Like forEachUriObject, but lists subdirectories of the prefix in
+    parallel where the backend supports it, streaming objects to the
+    callback as listing pages arrive so that processing can start before
+    the full listing has finished.
+
+    Callback invocations are serialized, but may come from different
+    threads, and the ordering of objects across subdirectories is not
+    preserved.
+*/
+bool forEachUriObjectParallel(const std::string & uriPrefix,
+                              const OnUriObject & onObject,
+                              const OnUriSubdir & onSubdir = nullptr,
+                              const std::string & delimiter = "/",
+                              int maxParallelism = 16);
+
 
 // wrappers around "basename" and "dirname" from the libc
 std::string baseName(const std::string & filename);
@@ -108,13 +108,26 @@ struct HttpStreamingDownloadSource {
     struct Impl {
         Impl(const std::string & urlStr,
              const std::map<std::string, std::string> & options)
-            : proxy(urlStr), urlStr(urlStr), shutdown(false), dataQueue(100),
+            : urlStr(urlStr), shutdown(false), dataQueue(100),
               eof(false), currentDone(0), headerSet(false),
               httpAbortOnSlowConnection(false)
         {
+            // Cookies are per-proxy state, so requests that set them get a
+            // private proxy.  Everything else goes through the shared,
+            // host-keyed pool so that keep-alive connections are reused
+            // across streams to the same host.
+            if (options.count("http-set-cookie")) {
+                proxy = std::make_shared<HttpRestProxy>(urlStr);
+            }
+            else {
+                auto proxyAndResource = HttpRestProxy::sharedProxyForUri(urlStr);
+                proxy = std::move(proxyAndResource.first);
+                resource = std::move(proxyAndResource.second);
+            }
+
             for (auto & o: options) {
                 if (o.first == "http-set-cookie")
-                    proxy.setCookie(o.second);
+                    proxy->setCookie(o.second);
                 else if (o.first.find("http-") == 0)
                     throw AnnotatedException
                         (500,
@@ -124,7 +137,7 @@ struct HttpStreamingDownloadSource {
                     httpAbortOnSlowConnection = true;
                 }
             }
-            
+
             reset();
         }
 
@@ -133,7 +146,8 @@ struct HttpStreamingDownloadSource {
             stop();
         }
 
-        HttpRestProxy proxy;
+        std::shared_ptr<HttpRestProxy> proxy;
+        std::string resource;
         std::string urlStr;
 
         atomic<bool> shutdown;
@@ -293,11 +307,11 @@ struct HttpStreamingDownloadSource {
                         return !shutdown;
                     };
 
-                auto resp = proxy.get("", {}, {}, -1 /* timeout */,
-                                      false /* exceptions */,
-                                      onData, onHeader,
-                                      true /* follow redirect */,
-                                      httpAbortOnSlowConnection);
+                auto resp = proxy->get(resource, {}, {}, -1 /* timeout */,
+                                       false /* exceptions */,
+                                       onData, onHeader,
+                                       true /* follow redirect */,
+                                       httpAbortOnSlowConnection);
                 
                 if (shutdown)
                     return;
@@ -373,7 +387,6 @@ makeHttpStreamingDownload(const std::string & uri,
 }
 
 struct HttpUrlFsHandler: UrlFsHandler {
-    HttpRestProxy proxy;
 
     virtual FsObjectInfo getInfo(const Url & url) const
     {
@@ -390,6 +403,11 @@ struct HttpUrlFsHandler: UrlFsHandler {
         HttpRestProxy::Response resp;
         bool didGetHeader = false;
 
+        // Use the shared pool so that the HEAD and any subsequent GET of
+        // the same URL can reuse a single keep-alive connection
+        auto proxyAndResource
+            = HttpRestProxy::sharedProxyForUri(url.toDecodedString());
+
         for (unsigned attempt = 0;  attempt < 5;  ++attempt) {
 
             if (attempt != 0)
@@ -406,10 +424,11 @@ struct HttpUrlFsHandler: UrlFsHandler {
                     return true;
                 };
         
-            resp = proxy.perform("HEAD", url.toDecodedString(),
-                                 HttpRestProxy::Content(),
-                                 {}, {}, 1.0, false, nullptr, onHeader,
-                                 true /* follow redirects */);
+            resp = proxyAndResource.first
+                ->perform("HEAD", proxyAndResource.second,
+                          HttpRestProxy::Content(),
+                          {}, {}, 1.0, false, nullptr, onHeader,
+                          true /* follow redirects */);
             
             if (!didGetHeader && resp.errorCode() != 0) {
                 cerr << "error retrieving HEAD (retry) " << url.toString() << ": "
@@ -0,0 +1,212 @@
+/* parallel_compressor.cc
+   This file is part of MLDB. Copyright 2016 mldb.ai Inc. All rights reserved.
+
+   Compressor adaptor that farms independent blocks out to a thread pool
+   and commits the compressed frames in order.
+*/
+
+#include "compressor.h"
+#include "mldb/arch/exception.h"
+#include "mldb/base/exc_assert.h"
+#include "mldb/base/thread_pool.h"
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
+using namespace std;
+
+namespace MLDB {
+
+namespace {
+
+/*****************************************************************************/
+/* PARALLEL BLOCK COMPRESSOR                                                 */
+/*****************************************************************************/
+
+/** Wraps an underlying compression scheme, chopping the input into
+    fixed-size blocks that are each compressed into an independent frame
+    on a worker thread.  Finished frames are written downstream in input
+    order, so the output is a plain concatenation of frames: a valid
+    stream for formats whose decoders accept concatenated frames (zstd,
+    gzip, lz4).  Block boundaries cost a little compression ratio since
+    no references cross them.
+*/
+struct ParallelBlockCompressor : public Compressor {
+
+    ParallelBlockCompressor(std::string compression, int level,
+                            int numThreads, size_t blockSize)
+        : compression(std::move(compression)),
+          level(level),
+          blockSize(blockSize == 0 ? 8 * 1024 * 1024 : blockSize),
+          maxInFlight(numThreads + 2),
+          pool(ThreadPool::instance(), numThreads)
+    {
+    }
+
+    ~ParallelBlockCompressor()
+    {
+        /* In-flight jobs reference this object; make sure none are left
+           running, even when finish() was never reached. */
+        try {
+            pool.waitForAll();
+        }
+        catch (...) {
+        }
+    }
+
+    virtual void compress(const char * data, size_t len,
+                          const OnData & onData) override
+    {
+        while (len > 0) {
+            size_t toDo = std::min(blockSize - current.size(), len);
+            current.append(data, toDo);
+            data += toDo;
+            len -= toDo;
+            if (current.size() == blockSize) {
+                submitCurrent();
+            }
+        }
+        drain(onData, false);
+    }
+
+    virtual void flush(FlushLevel flushLevel, const OnData & onData) override
+    {
+        if (!current.empty()) {
+            submitCurrent();
+        }
+        drain(onData, true);
+    }
+
+    virtual void finish(const OnData & onData) override
+    {
+        /* For empty streams, force a single empty frame so that the
+           output is valid for the underlying format. */
+        if (!current.empty() || nextBlock == 0) {
+            submitCurrent();
+        }
+        drain(onData, true);
+    }
+
+private:
+    void submitCurrent()
+    {
+        auto data = std::make_shared<std::string>(std::move(current));
+        current.clear();
+        size_t seq = nextBlock++;
+        pool.add([this, seq, data] () { this->compressBlock(seq, *data); });
+    }
+
+    /* Runs on a worker thread.  ThreadPool jobs must not throw, so any
+       exception is stashed here and rethrown from drain() on the stream's
+       thread. */
+    void compressBlock(size_t seq, const std::string & data)
+    {
+        std::string out;
+        try {
+            std::unique_ptr<Compressor> blockCompressor
+                (Compressor::create(compression, level));
+            ExcAssert(blockCompressor);
+            auto onBlockData = [&] (const char * d, size_t n) -> size_t
+                {
+                    out.append(d, n);
+                    return n;
+                };
+            blockCompressor->notifyInputSize(data.size());
+            blockCompressor->compress(data.data(), data.size(), onBlockData);
+            blockCompressor->finish(onBlockData);
+        }
+        catch (...) {
+            std::unique_lock<std::mutex> guard(mutex);
+            if (!exc) {
+                exc = std::current_exception();
+            }
+            wakeup.notify_all();
+            return;
+        }
+
+        std::unique_lock<std::mutex> guard(mutex);
+        done.emplace(seq, std::move(out));
+        wakeup.notify_all();
+    }
+
+    /* Write out finished blocks in order.  When everything is true, wait
+       until all submitted blocks have been written; otherwise wait only
+       as needed to keep the number of in-flight blocks below
+       maxInFlight. */
+    void drain(const OnData & onData, bool everything)
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        for (;;) {
+            if (exc) {
+                std::rethrow_exception(exc);
+            }
+            while (!done.empty() && done.begin()->first == nextToWrite) {
+                std::string block = std::move(done.begin()->second);
+                done.erase(done.begin());
+                ++nextToWrite;
+                guard.unlock();
+                size_t written = 0;
+                while (written < block.size()) {
+                    written += onData(block.data() + written,
+                                      block.size() - written);
+                }
+                guard.lock();
+            }
+            bool mustWait = everything
+                ? nextToWrite < nextBlock
+                : nextBlock - nextToWrite >= maxInFlight;
+            if (!mustWait) {
+                return;
+            }
+
+            /* Lend this thread to the pool rather than blocking it, so
+               that we make progress even when all pool threads are busy
+               with jobs that are themselves waiting on this stream. */
+            guard.unlock();
+            pool.work();
+            guard.lock();
+            if (done.empty() && !exc) {
+                wakeup.wait_for(guard, std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    /* configuration, fixed at construction */
+    const std::string compression;
+    const int level;
+    const size_t blockSize;
+    const size_t maxInFlight;
+    ThreadPool pool;
+
+    /* stream thread only */
+    std::string current;      /* block being accumulated */
+    size_t nextBlock = 0;     /* sequence number of the next block submitted */
+    size_t nextToWrite = 0;   /* sequence number of the next block to write */
+
+    /* shared with worker threads */
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::map<size_t, std::string> done; /* finished, awaiting ordered write */
+    std::exception_ptr exc;
+};
+
+} // file scope
+
+Compressor *
+Compressor::
+createParallel(const std::string & compression, int level,
+               int numThreads, size_t blockSize)
+{
+    std::unique_ptr<Compressor> probe(create(compression, level));
+    if (!probe) {
+        return nullptr;
+    }
+    if (numThreads <= 1) {
+        return probe.release();
+    }
+    return new ParallelBlockCompressor(compression, level,
+                                       numThreads, blockSize);
+}
+
+} // namespace MLDB
@@ -200,6 +200,71 @@ BOOST_AUTO_TEST_CASE( test_compress_decompress_zstandard )
     test_compress_decompress(input_file, "zst", zstd_cmd, zstd_cmd + " -d");
 }
 
+/* Round-trip of the parallel block compression mode; enough data is
+   written to span several 8MB blocks, so the output contains multiple
+   concatenated zstd frames. */
+BOOST_AUTO_TEST_CASE( test_compress_decompress_zstandard_parallel )
+{
+    size_t dataSize = 20 * 1024 * 1024;
+    string data;
+    data.reserve(dataSize);
+    while (data.size() < dataSize) {
+        data += "All work and no play makes Jack a dull boy "
+            + to_string(data.size()) + "\n";
+    }
+
+    string filename = tmpDir / "parallel.zst";
+    FileCleanup cleanup(filename);
+
+    {
+        map<string, string> options = {
+            { "compressionThreads", "4" }
+        };
+        filter_ostream stream(filename, options);
+        stream.write(data.c_str(), data.size());
+    }
+
+    {
+        filter_istream stream(filename);
+        string data2(data.size(), '\0');
+        stream.read(&data2[0], data2.size());
+        BOOST_CHECK_EQUAL(stream.gcount(), data2.size());
+        BOOST_CHECK(data == data2);
+    }
+}
+
+/* Round-trip with the decompression readahead thread enabled on the
+   reading side. */
+BOOST_AUTO_TEST_CASE( test_decompress_readahead )
+{
+    size_t dataSize = 4 * 1024 * 1024;
+    string data;
+    data.reserve(dataSize);
+    while (data.size() < dataSize) {
+        data += "line number " + to_string(data.size()) + "\n";
+    }
+
+    string filename = tmpDir / "readahead.gz";
+    FileCleanup cleanup(filename);
+
+    {
+        filter_ostream stream(filename);
+        stream.write(data.c_str(), data.size());
+    }
+
+    {
+        map<string, string> options = {
+            { "readahead", "1" }
+        };
+        filter_istream stream(filename, options);
+        string data2(data.size(), '\0');
+        stream.read(&data2[0], data2.size());
+        BOOST_CHECK_EQUAL(stream.gcount(), data2.size());
+        BOOST_CHECK(data == data2);
+        BOOST_CHECK_EQUAL(stream.get(), -1);
+    }
+}
+
 BOOST_AUTO_TEST_CASE( test_open_failure )
 {
     filter_ostream stream;
@@ -5,6 +5,7 @@ LIBVFS_SOURCES := \
         filter_streams.cc \
 	http_streambuf.cc \
 	compressor.cc \
+	parallel_compressor.cc \
 	exception_ptr.cc \
 	libdb_initialization.cc \
 	\
@@ -154,9 +154,10 @@ struct ZStandardDecompressor: public Decompressor {
                                 ZSTD_getErrorName(res));
             }
             writeAll(onData);
-            if (res == 0 && inBuf.pos < inBuf.size) {
-                throw Exception("Extra bytes at end of decompressed zstandard stream");
-            }
+            /* res == 0 marks the end of a frame; any remaining input
+               belongs to the next frame of a concatenated stream (as
+               produced by parallel block compression), which the next
+               call to ZSTD_decompressStream picks up. */
         }
     }
     
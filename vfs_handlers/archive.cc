@@ -12,6 +12,9 @@
 #include "mldb/base/scope.h"
 #include "mldb/vfs/filter_streams_registry.h"
 #include "mldb/arch/exception.h"
+#include <future>
+#include <map>
+#include <mutex>
 #include <sstream>
 
 // libarchive support
@@ -146,6 +149,247 @@ bool iterateArchive(std::streambuf * archive,
 }
 
 
+/*****************************************************************************/
+/* ARCHIVE MEMBER CACHE                                                      */
+/*****************************************************************************/
+
+/* Archives only support sequential access, so opening one member means
+   decompressing everything before it, once per member opened.  The first
+   time any member of an archive is opened, we instead extract every
+   member in a single sequential pass (the lower bound for a compressed
+   stream) into shared immutable buffers, indexed by path.  Subsequent
+   member opens, including concurrent ones, are then served straight from
+   the index without touching the archive again.
+
+   The cache is keyed on the archive URI plus its etag, modification time
+   and size, so that a changed archive is re-extracted. */
+
+/** One extracted archive member. */
+struct CachedArchiveMember {
+    std::shared_ptr<FsObjectInfo> info;
+    std::shared_ptr<const std::string> data;
+};
+
+/** A fully-extracted archive, with its members indexed by path. */
+struct CachedArchive {
+    std::map<std::string, CachedArchiveMember> members;
+};
+
+namespace {
+
+std::mutex archiveCacheLock;
+
+/// Cache of extracted archives in insertion order, oldest first.  The
+/// future lets concurrent cold opens of the same archive share a single
+/// extraction pass.
+std::vector<std::pair<std::string,
+                      std::shared_future<std::shared_ptr<CachedArchive> > > >
+archiveCache;
+
+constexpr size_t maxCachedArchives = 4;
+
+} // file scope
+
+/** Cache key for the given archive; includes enough of the object info
+    that a modified archive gets a different key.
+*/
+static std::string archiveCacheKey(const Utf8String & archiveUri)
+{
+    std::string key = archiveUri.rawString();
+    auto info = tryGetUriObjectInfo(archiveUri.rawString());
+    if (info) {
+        key += "|" + info.etag
+            + "|" + info.lastModified.printIso8601()
+            + "|" + std::to_string(info.size);
+    }
+    return key;
+}
+
+/** Extract every regular member of the archive in one sequential pass. */
+static std::shared_ptr<CachedArchive>
+extractWholeArchive(const Utf8String & archiveUri)
+{
+    auto result = std::make_shared<CachedArchive>();
+
+    filter_istream archiveStream(archiveUri.rawString());
+
+    auto onEntry = [&] (const std::string & filename,
+                        struct archive * a,
+                        struct archive_entry * entry)
+        {
+            if (archive_entry_filetype(entry) != AE_IFREG)
+                return true;
+
+            CachedArchiveMember member;
+            member.info = std::make_shared<FsObjectInfo>();
+            member.info->exists = true;
+            if (archive_entry_mtime_is_set(entry)) {
+                member.info->lastModified
+                    = Date::fromSecondsSinceEpoch
+                    (archive_entry_mtime(entry)
+                     + 0.000000001 * archive_entry_mtime_nsec(entry));
+            }
+            else member.info->lastModified = Date::notADate();
+
+            member.info->ownerId = std::to_string(archive_entry_uid(entry));
+            const char * gname = archive_entry_gname(entry);
+            if (gname)
+                member.info->ownerName = gname;
+
+            auto data = std::make_shared<std::string>();
+            if (archive_entry_size_is_set(entry))
+                data->reserve(archive_entry_size(entry));
+
+            size_t size = 0;
+            // This is a type exported by libarchive
+            __LA_INT64_T offset = 0;
+            const char * buff;
+            int r = archive_read_data_block(a, (const void **)&buff,
+                                            &size, &offset);
+
+            while (r != ARCHIVE_EOF) {
+                if (r < ARCHIVE_OK)
+                    throw MLDB::Exception("Error extracting file");
+                data->append(buff, size);
+                r = archive_read_data_block(a, (const void **)&buff,
+                                            &size, &offset);
+            }
+
+            member.info->size = data->size();
+            member.data = std::move(data);
+            result->members.emplace(filename, std::move(member));
+
+            return true;
+        };
+
+    list_archive(archiveStream.rdbuf(), onEntry);
+
+    return result;
+}
+
+/** Return the extracted archive if it's already in the cache and ready,
+    nullptr otherwise.  Never triggers an extraction.
+*/
+static std::shared_ptr<CachedArchive>
+tryGetCachedArchive(const std::string & key)
+{
+    std::shared_future<std::shared_ptr<CachedArchive> > future;
+    {
+        std::unique_lock<std::mutex> guard(archiveCacheLock);
+        for (auto & e: archiveCache) {
+            if (e.first == key) {
+                future = e.second;
+                break;
+            }
+        }
+    }
+
+    if (!future.valid()
+        || future.wait_for(std::chrono::seconds(0))
+           != std::future_status::ready)
+        return nullptr;
+
+    try {
+        return future.get();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+/** Return the extracted archive, extracting it if necessary.  Concurrent
+    callers for the same archive share one extraction pass.
+*/
+static std::shared_ptr<CachedArchive>
+getCachedArchive(const Utf8String & archiveUri)
+{
+    std::string key = archiveCacheKey(archiveUri);
+
+    std::promise<std::shared_ptr<CachedArchive> > promise;
+    std::shared_future<std::shared_ptr<CachedArchive> > future;
+    bool extracting = false;
+
+    {
+        std::unique_lock<std::mutex> guard(archiveCacheLock);
+        for (auto & e: archiveCache) {
+            if (e.first == key) {
+                future = e.second;
+                break;
+            }
+        }
+        if (!future.valid()) {
+            future = promise.get_future().share();
+            archiveCache.emplace_back(key, future);
+            if (archiveCache.size() > maxCachedArchives)
+                archiveCache.erase(archiveCache.begin());
+            extracting = true;
+        }
+    }
+
+    if (!extracting)
+        return future.get();
+
+    try {
+        auto result = extractWholeArchive(archiveUri);
+        promise.set_value(result);
+        return result;
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+
+        // Remove the failed entry so a later open retries the extraction
+        std::unique_lock<std::mutex> guard(archiveCacheLock);
+        for (auto it = archiveCache.begin();  it != archiveCache.end();
+             ++it) {
+            if (it->first == key) {
+                archiveCache.erase(it);
+                break;
+            }
+        }
+        throw;
+    }
+}
+
+/** Read-only streambuf over a shared immutable buffer.  Keeps the buffer
+    alive and supports seeking, so archive members behave like regular
+    files.
+*/
+struct ArchiveMemberBuf: public std::streambuf {
+    ArchiveMemberBuf(std::shared_ptr<const std::string> data)
+        : data(std::move(data))
+    {
+        char * p = const_cast<char *>(this->data->data());
+        setg(p, p, p + this->data->size());
+    }
+
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                             std::ios_base::openmode which)
+    {
+        char * begin = const_cast<char *>(data->data());
+        char * end = begin + data->size();
+        char * target;
+
+        switch (dir) {
+        case std::ios_base::beg:  target = begin + off;   break;
+        case std::ios_base::cur:  target = gptr() + off;  break;
+        case std::ios_base::end:  target = end + off;     break;
+        default:                  return pos_type(off_type(-1));
+        }
+
+        if (target < begin || target > end)
+            return pos_type(off_type(-1));
+
+        setg(begin, target, end);
+        return pos_type(target - begin);
+    }
+
+    virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which)
+    {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+
+    std::shared_ptr<const std::string> data;
+};
+
+
 struct ArchiveUrlFsHandler: UrlFsHandler {
 
     ArchiveUrlFsHandler()
@@ -173,9 +417,18 @@ struct ArchiveUrlFsHandler: UrlFsHandler {
 
         Utf8String archiveUri(archiveSource.begin(), it);
 
-        // unused...
         Utf8String toExtractPath(std::next(it), archiveSource.end());
 
+        // If the archive has already been extracted, answer from the
+        // index without re-reading it
+        auto cached = tryGetCachedArchive(archiveCacheKey(archiveUri));
+        if (cached) {
+            auto it = cached->members.find(toExtractPath.rawString());
+            if (it == cached->members.end())
+                return FsObjectInfo();
+            return *it->second.info;
+        }
+
         FsObjectInfo result;
 
         OnUriObject onObject = [&] (const std::string & archiveMemberUri,
@@ -262,8 +515,6 @@ struct RegisterArchiveHandler {
 
         Utf8String uri = scheme + "://" + resource;
 
-        cerr << "uri = " << uri << endl;
-
         Utf8String archiveSource = uri;
         if (!archiveSource.removePrefix("archive+"))
             throw MLDB::Exception("archive URI '" + uri.rawString() + "' doesn't start with 'archive+' when opening archive member");
@@ -284,36 +535,32 @@ struct RegisterArchiveHandler {
 
         //cerr << "archiveUri = " << archiveUri << endl;
 
-        // unused...
         Utf8String toExtractPath(std::next(foundIt), archiveSource.end());
 
         //cerr << "uri = " << uri << " archiveSource = " << archiveSource
         //     << " archiveUri = " << archiveUri << " toExtractPath = "
         //     << toExtractPath << endl;
 
-        UriHandler result;
+        // Extract the whole archive in one pass (the first time only)
+        // and serve the member from the index
+        auto cached = getCachedArchive(archiveUri);
 
-        OnUriObject onObject = [&] (const std::string & archiveMemberUri,
-                                    const FsObjectInfo & info,
-                                    const OpenUriObject & open,
-                                    int depth)
-            {
-                //cerr << "matching " << archiveMemberUri
-                //<< " against " << uri << endl;
-                if (uri.rawString() == archiveMemberUri) {
-                    result = open(options);
-                    return false;
-                }
-                return true;
-            };
-
-        forEachUriObject("archive+" + archiveUri.rawString(), onObject, {},
-                         "/" /* delimiter */, "" /* startAt */);
-        if (!result.buf)
+        auto it = cached->members.find(toExtractPath.rawString());
+        if (it == cached->members.end())
             throw MLDB::Exception("Couldn't find resource " + toExtractPath.rawString()
                                 + " in archive " + archiveUri.rawString());
-        
-        return result;
+
+        const CachedArchiveMember & member = it->second;
+
+        auto buf = std::make_shared<ArchiveMemberBuf>(member.data);
+
+        UriHandlerOptions handlerOptions;
+        handlerOptions.isForwardSeekable = true;
+        handlerOptions.isRandomSeekable = true;
+        handlerOptions.mapped = member.data->data();
+        handlerOptions.mappedSize = member.data->size();
+
+        return UriHandler(buf.get(), buf, member.info, handlerOptions);
     }
 
     RegisterArchiveHandler()
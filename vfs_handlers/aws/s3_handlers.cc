@@ -133,11 +133,26 @@ size_t getTotalSystemMemory()
     return pages * page_size;
 }
 
+/* Read a positive integer tuning knob from the environment, returning
+   defaultValue when the variable is absent or unparseable. */
+int getEnvOverride(const char * varName, int defaultValue)
+{
+    char * value = getenv(varName);
+    if (value) {
+        int parsed = atoi(value);
+        if (parsed > 0) {
+            return parsed;
+        }
+    }
+    return defaultValue;
+}
+
 struct S3Downloader {
     S3Downloader(const S3Api * api,
                  const string & bucket,
                  const string & resource, // starts with "/", unescaped (buggy)
-                 ssize_t startOffset = 0, ssize_t endOffset = -1)
+                 ssize_t startOffset = 0, ssize_t endOffset = -1,
+                 int numRequests = -1, ssize_t partSize = -1)
         : api(api),
           bucket(bucket), resource(resource),
           offset(startOffset),
@@ -166,15 +181,38 @@ struct S3Downloader {
         size_t sysMemory = getTotalSystemMemory();
         maxChunkSize = std::min(maxChunkSize, sysMemory / 100);
 
+        /* A fixed part size, from the "part-size-mb" option or the
+           S3_DOWNLOAD_PART_SIZE_MB environment variable, disables the
+           ramp-up. */
+        if (partSize <= 0) {
+            partSize = ((ssize_t)
+                        getEnvOverride("S3_DOWNLOAD_PART_SIZE_MB", 0)
+                        * 1024 * 1024);
+        }
+        if (partSize > 0) {
+            baseChunkSize = partSize;
+            maxChunkSize = partSize;
+        }
+
         /* The maximum number of concurrent requests is set depending on
-           the total size of the stream. */
-        maxRqs = 1;
-        if (fileInfo.size > 1024 * 1024)
-            maxRqs = 5;
-        if (fileInfo.size > 16 * 1024 * 1024)
-            maxRqs = 15;
-        if (fileInfo.size > 256 * 1024 * 1024)
-            maxRqs = 30;
+           the total size of the stream, unless overridden by the
+           "num-requests" option or the S3_DOWNLOAD_CONCURRENCY
+           environment variable. */
+        if (numRequests <= 0) {
+            numRequests = getEnvOverride("S3_DOWNLOAD_CONCURRENCY", 0);
+        }
+        if (numRequests > 0) {
+            maxRqs = numRequests;
+        }
+        else {
+            maxRqs = 1;
+            if (fileInfo.size > 1024 * 1024)
+                maxRqs = 5;
+            if (fileInfo.size > 16 * 1024 * 1024)
+                maxRqs = 15;
+            if (fileInfo.size > 256 * 1024 * 1024)
+                maxRqs = 30;
+        }
         chunks.resize(maxRqs);
 
         /* Kick start the requests */
@@ -466,14 +504,16 @@ private:
 /****************************************************************************/
 
 struct StreamingDownloadSource {
-    StreamingDownloadSource(const std::string & urlStr)
+    StreamingDownloadSource(const std::string & urlStr,
+                            int numRequests = -1, ssize_t partSize = -1)
     {
         owner = getS3ApiForUri(urlStr);
 
         string bucket, resource;
         std::tie(bucket, resource) = S3Api::parseUri(urlStr);
         downloader.reset(new S3Downloader(owner.get(),
-                                          bucket, "/" + resource));
+                                          bucket, "/" + resource,
+                                          0, -1, numRequests, partSize));
     }
 
     const FsObjectInfo & info()
@@ -513,10 +553,11 @@ private:
 
 
 std::pair<std::unique_ptr<std::streambuf>, FsObjectInfo>
-makeStreamingDownload(const std::string & uri)
+makeStreamingDownload(const std::string & uri,
+                      int numRequests = -1, ssize_t partSize = -1)
 {
     std::unique_ptr<std::streambuf> result;
-    StreamingDownloadSource source(uri);
+    StreamingDownloadSource source(uri, numRequests, partSize);
     result.reset(new boost::iostreams::stream_buffer<StreamingDownloadSource>
                  (source,131072));
     return make_pair(std::move(result), source.info());
@@ -552,7 +593,8 @@ struct S3Uploader {
                const string & bucket,
                const string & resource, // starts with "/", unescaped (buggy)
                const OnUriHandlerException & excCallback,
-               const S3Api::ObjectMetadata & objectMetadata)
+               const S3Api::ObjectMetadata & objectMetadata,
+               ssize_t partSize = -1)
         : api(api),
           bucket(bucket), resource(resource),
           metadata(objectMetadata),
@@ -568,6 +610,19 @@ struct S3Uploader {
         size_t sysMemory = getTotalSystemMemory();
         maxChunkSize = std::min(maxChunkSize, sysMemory / 100);
 
+        /* A fixed part size, from the "part-size-mb" option or the
+           S3_UPLOAD_PART_SIZE_MB environment variable, disables the
+           ramp-up. */
+        if (partSize <= 0) {
+            partSize = ((ssize_t)
+                        getEnvOverride("S3_UPLOAD_PART_SIZE_MB", 0)
+                        * 1024 * 1024);
+        }
+        if (partSize > 0) {
+            chunkSize = partSize;
+            maxChunkSize = partSize;
+        }
+
         try {
             S3Api::MultiPartUpload upload
               = api->obtainMultiPartUpload(bucket, resource, metadata,
@@ -744,13 +799,14 @@ private:
 struct StreamingUploadSource {
     StreamingUploadSource(const std::string & urlStr,
                           const OnUriHandlerException & excCallback,
-                          const S3Api::ObjectMetadata & metadata)
+                          const S3Api::ObjectMetadata & metadata,
+                          ssize_t partSize = -1)
         : owner(getS3ApiForUri(urlStr))
     {
         string bucket, resource;
         std::tie(bucket, resource) = S3Api::parseUri(urlStr);
         uploader.reset(new S3Uploader(owner.get(), bucket, "/" + resource,
-                                      excCallback, metadata));
+                                      excCallback, metadata, partSize));
     }
 
     typedef char char_type;
@@ -785,11 +841,12 @@ private:
 std::unique_ptr<std::streambuf>
 makeStreamingUpload(const std::string & uri,
                     const OnUriHandlerException & onException,
-                    const S3Api::ObjectMetadata & metadata)
+                    const S3Api::ObjectMetadata & metadata,
+                    ssize_t partSize = -1)
 {
     std::unique_ptr<std::streambuf> result;
     result.reset(new boost::iostreams::stream_buffer<StreamingUploadSource>
-                 (StreamingUploadSource(uri, onException, metadata),
+                 (StreamingUploadSource(uri, onException, metadata, partSize),
                   131072));
     return result;
 }
@@ -812,9 +869,32 @@ struct RegisterS3Handler {
         string bucket(resource, 0, pos);
 
         if (mode == ios::in) {
+            int numRequests = -1;
+            ssize_t partSize = -1;
+            for (auto & opt: options) {
+                const string & name = opt.first;
+                const string & value = opt.second;
+                if (name == "num-requests" || name == "aws-num-requests") {
+                    numRequests = std::stoi(value);
+                }
+                else if (name == "part-size-mb"
+                         || name == "aws-part-size-mb") {
+                    partSize = (ssize_t) std::stoll(value) * 1024 * 1024;
+                }
+                else if (name == "mode" || name == "compression"
+                         || name == "compressionLevel") {
+                    // do nothing
+                }
+                else {
+                    cerr << "warning: skipping unknown S3 option "
+                         << name << "=" << value << endl;
+                }
+            }
+
             std::unique_ptr<std::streambuf> source;
             FsObjectInfo info;
-            auto dl = makeStreamingDownload("s3://" + resource);
+            auto dl = makeStreamingDownload("s3://" + resource,
+                                            numRequests, partSize);
             source = std::move(dl.first);
             info = std::move(dl.second);
             std::shared_ptr<std::streambuf> buf(source.release());
@@ -823,6 +903,7 @@ struct RegisterS3Handler {
         else if (mode == ios::out) {
 
             S3Api::ObjectMetadata md;
+            ssize_t partSize = -1;
             for (auto & opt: options) {
                 string name = opt.first;
                 string value = opt.second;
@@ -861,6 +942,10 @@ struct RegisterS3Handler {
                 {
                     md.numRequests = std::stoi(value);
                 }
+                else if (name == "part-size-mb"
+                         || name == "aws-part-size-mb") {
+                    partSize = (ssize_t) std::stoll(value) * 1024 * 1024;
+                }
                 else {
                     cerr << "warning: skipping unknown S3 option "
                          << name << "=" << value << endl;
@@ -868,7 +953,8 @@ struct RegisterS3Handler {
             }
 
             std::shared_ptr<std::streambuf> buf
-                (makeStreamingUpload("s3://" + resource, onException, md).release());
+                (makeStreamingUpload("s3://" + resource, onException, md,
+                                     partSize).release());
             return UriHandler(buf.get(), buf);
         }
         else throw MLDB::Exception("no way to create s3 handler for non in/out");
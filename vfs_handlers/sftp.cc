@@ -28,6 +28,8 @@
 #include "mldb/credentials/credential_provider.h"
 #include <thread>
 #include <unordered_map>
+#include <condition_variable>
+#include <deque>
 #include <errno.h>
 
 
@@ -613,13 +615,42 @@ struct SftpStreamingDownloadSource {
         impl->start();
     }
 
+    /** Download over a connection checked out of the pool; the lease is
+        held until the stream is closed.
+    */
+    SftpStreamingDownloadSource(std::shared_ptr<const SftpConnection> lease,
+                                std::string path)
+    {
+        impl.reset(new Impl());
+        impl->lease = std::move(lease);
+        impl->owner = impl->lease.get();
+        impl->path = path;
+        impl->start();
+    }
+
     typedef char char_type;
     struct category
         : public boost::iostreams::input /*_seekable*/,
           public boost::iostreams::device_tag,
           public boost::iostreams::closable_tag
     { };
-    
+
+    /// Number of read-ahead blocks kept in flight by the reader thread;
+    /// together with the block size this is the read window
+    static size_t readAheadBlocks()
+    {
+        static size_t result = [] () -> size_t
+            {
+                char * env = getenv("SFTP_READAHEAD_BLOCKS");
+                if (env)
+                    return std::max(1, atoi(env));
+                return 4;
+            } ();
+        return result;
+    }
+
+    static constexpr size_t blockSize = 1024 * 1024;
+
     struct Impl {
         Impl()
             : owner(0), offset(0), handle(0)
@@ -632,40 +663,124 @@ struct SftpStreamingDownloadSource {
         }
 
         const SftpConnection * owner;
+        std::shared_ptr<const SftpConnection> lease;
         std::string path;
         size_t offset;
         LIBSSH2_SFTP_HANDLE * handle;
 
         Date startDate;
 
+        /* Read-ahead: a reader thread keeps up to readAheadBlocks()
+           blocks queued so that the network stays busy while the
+           consumer is processing.  Large blocks also let libssh2 keep
+           multiple SFTP READ requests outstanding within each call. */
+        std::thread reader;
+        std::mutex blocksLock;
+        std::condition_variable blockReady;
+        std::condition_variable blockConsumed;
+        std::deque<std::string> blocks;
+        bool eof = false;
+        bool stopping = false;
+        std::exception_ptr readError;
+
+        std::string current;
+        size_t currentPos = 0;
+
         void start()
         {
             handle
                 = libssh2_sftp_open_ex(owner->sftp_session, path.c_str(),
                                        path.length(), LIBSSH2_FXF_READ, 0,
                                        LIBSSH2_SFTP_OPENFILE);
-            
+
             if (!handle) {
                 throw MLDB::Exception("couldn't open path: "
                                     + owner->lastError());
             }
+
+            reader = std::thread([this] () { this->runReader(); });
         }
 
         void stop()
         {
+            if (reader.joinable()) {
+                {
+                    std::unique_lock<std::mutex> guard(blocksLock);
+                    stopping = true;
+                    blockConsumed.notify_one();
+                }
+                reader.join();
+            }
             if (handle) libssh2_sftp_close(handle);
         }
 
+        void runReader()
+        {
+            try {
+                for (;;) {
+                    std::string block(blockSize, '\0');
+                    size_t done = 0;
+
+                    while (done < block.size()) {
+                        ssize_t numRead
+                            = libssh2_sftp_read(handle, &block[done],
+                                                block.size() - done);
+                        if (numRead < 0)
+                            throw MLDB::Exception("read(): "
+                                                  + owner->lastError());
+                        if (numRead == 0)
+                            break;
+                        done += numRead;
+                    }
+
+                    bool atEof = done < block.size();
+                    block.resize(done);
+
+                    std::unique_lock<std::mutex> guard(blocksLock);
+                    while (!stopping && blocks.size() >= readAheadBlocks())
+                        blockConsumed.wait(guard);
+                    if (stopping)
+                        return;
+                    if (!block.empty())
+                        blocks.emplace_back(std::move(block));
+                    if (atEof)
+                        eof = true;
+                    blockReady.notify_one();
+                    if (atEof)
+                        return;
+                }
+            } catch (...) {
+                std::unique_lock<std::mutex> guard(blocksLock);
+                readError = std::current_exception();
+                eof = true;
+                blockReady.notify_one();
+            }
+        }
+
         std::streamsize read(char_type* s, std::streamsize n)
         {
             BOOST_STATIC_ASSERT(sizeof(char_type) == 1);
 
-            ssize_t numRead = libssh2_sftp_read(handle, s, n);
-            if (numRead < 0) {
-                throw MLDB::Exception("read(): " + owner->lastError());
+            if (currentPos == current.size()) {
+                std::unique_lock<std::mutex> guard(blocksLock);
+                while (blocks.empty() && !eof)
+                    blockReady.wait(guard);
+                if (readError)
+                    std::rethrow_exception(readError);
+                if (blocks.empty())
+                    return -1;  // end of file
+                current = std::move(blocks.front());
+                blocks.pop_front();
+                currentPos = 0;
+                blockConsumed.notify_one();
             }
-            
-            return numRead;
+
+            size_t toCopy = std::min<size_t>(n, current.size() - currentPos);
+            memcpy(s, current.data() + currentPos, toCopy);
+            currentPos += toCopy;
+            offset += toCopy;
+
+            return toCopy;
         }
     };
 
@@ -906,12 +1021,82 @@ namespace {
 
 struct SftpHostInfo {
     std::string sftpHost;
-    std::shared_ptr<SftpConnection> connection;  //< Used to access this uri
+    std::string port = "ssh";
+    std::string username;
+    std::string password;
+    std::string publicKeyFile;
+    std::string privateKeyFile;
+    bool usePublicKey = false;
+
+    std::shared_ptr<SftpConnection> connection;  //< Shared metadata connection
+    std::vector<std::shared_ptr<SftpConnection> > idle;  //< Pooled connections
 };
 
 std::mutex sftpHostsLock;
 std::unordered_map<std::string, SftpHostInfo> sftpHosts;
 
+/// Idle connections kept per host once returned to the pool
+constexpr size_t maxIdleSftpConnections = 8;
+
+/* Return the entry for the given host, creating it from the registered
+   credentials if it's not yet known.  Must be called with sftpHostsLock
+   held. */
+SftpHostInfo & ensureSftpHost(const std::string & connStr)
+{
+    auto it = sftpHosts.find(connStr);
+    if (it != sftpHosts.end())
+        return it->second;
+
+    auto creds = getCredential("sftp", "sftp://" + connStr);
+
+    SftpHostInfo info;
+    const auto pos = connStr.find(":");
+    if (pos == string::npos) {
+        info.sftpHost = connStr;
+    }
+    else {
+        info.sftpHost = connStr.substr(0, pos);
+        info.port = connStr.substr(pos + 1);
+    }
+    info.username = creds.id;
+    info.password = creds.secret;
+
+    return sftpHosts[connStr] = info;
+}
+
+/* Open a new connection to the given host. */
+std::shared_ptr<SftpConnection> connectSftp(const SftpHostInfo & info)
+{
+    auto connection = std::make_shared<SftpConnection>();
+    if (info.usePublicKey)
+        connection->connectPublicKeyAuth(info.sftpHost, info.username,
+                                         info.publicKeyFile,
+                                         info.privateKeyFile,
+                                         info.port);
+    else
+        connection->connectPasswordAuth(info.sftpHost, info.username,
+                                        info.password, info.port);
+    return connection;
+}
+
+/* Wrap a connection so that dropping the last reference returns it to
+   the host's idle pool instead of closing it. */
+std::shared_ptr<SftpConnection>
+leaseSftpConnection(const std::string & connStr,
+                    std::shared_ptr<SftpConnection> connection)
+{
+    SftpConnection * ptr = connection.get();
+    auto returnToPool = [connStr, connection] (SftpConnection *) mutable
+        {
+            std::unique_lock<std::mutex> guard(sftpHostsLock);
+            auto it = sftpHosts.find(connStr);
+            if (it != sftpHosts.end()
+                && it->second.idle.size() < maxIdleSftpConnections)
+                it->second.idle.emplace_back(std::move(connection));
+        };
+    return std::shared_ptr<SftpConnection>(ptr, std::move(returnToPool));
+}
+
 } // file scope
 
 /** Sftp support for filter_ostream opens.  Register the host name here, and
@@ -930,9 +1115,12 @@ void registerSftpHostPassword(const std::string & hostname,
 
     SftpHostInfo info;
     info.sftpHost = hostname;
+    info.port = port;
+    info.username = username;
+    info.password = password;
     info.connection = std::make_shared<SftpConnection>();
     info.connection->connectPasswordAuth(hostname, username, password, port);
-    
+
     sftpHosts[hostname] = info;
 }
 
@@ -949,6 +1137,11 @@ void registerSftpHostPublicKey(const std::string & hostname,
 
     SftpHostInfo info;
     info.sftpHost = hostname;
+    info.port = port;
+    info.username = username;
+    info.publicKeyFile = publicKeyFile;
+    info.privateKeyFile = privateKeyFile;
+    info.usePublicKey = true;
     info.connection = std::make_shared<SftpConnection>();
     info.connection->connectPublicKeyAuth(hostname, username,
                                           publicKeyFile,
@@ -972,18 +1165,23 @@ struct RegisterSftpHandler {
                                 + resource);
         string connStr(resource, 0, pos);
 
-        const auto & connection = getSftpConnectionFromConnStr(connStr);
         string path = resource.substr(connStr.size());
         if (mode == ios::in) {
-            std::shared_ptr<std::streambuf> buf
-                (connection.streamingDownloadStreambuf(path).release());
+            // Each download gets its own pooled connection, so several
+            // files can be fetched from the same host in parallel
+            auto connection = getPooledSftpConnection(connStr);
 
             SftpConnection::Attributes attr;
-            if (!connection.getAttributes(path, attr)) {
+            if (!connection->getAttributes(path, attr)) {
                 throw MLDB::Exception("Couldn't read attributes for sftp "
                                     "resource");
             }
 
+            std::shared_ptr<std::streambuf> buf
+                (new boost::iostreams::stream_buffer<SftpStreamingDownloadSource>
+                 (SftpStreamingDownloadSource(connection, path),
+                  131072));
+
             auto info = std::make_shared<FsObjectInfo>();
             info->exists = true;
             info->size = attr.filesize;
@@ -993,6 +1191,7 @@ struct RegisterSftpHandler {
             return UriHandler(buf.get(), buf, info);
         }
         if (mode == ios::out) {
+            const auto & connection = getSftpConnectionFromConnStr(connStr);
             std::shared_ptr<std::streambuf> buf
                 (connection.streamingUploadStreambuf(path, onException)
                  .release());
@@ -1011,31 +1210,40 @@ struct RegisterSftpHandler {
 const SftpConnection & getSftpConnectionFromConnStr(const std::string & connStr)
 {
     std::unique_lock<std::mutex> guard(sftpHostsLock);
-    auto it = sftpHosts.find(connStr);
-    if (it != sftpHosts.end() && it->second.connection.get()->isAlive()) {
-        return *it->second.connection.get();
-    }
-    auto creds = getCredential("sftp", "sftp://" + connStr);
+    auto & info = ensureSftpHost(connStr);
+    if (info.connection && info.connection->isAlive())
+        return *info.connection;
+    info.connection = connectSftp(info);
+    return *info.connection;
+}
 
-    const auto pos = connStr.find(":");
-    string host;
-    string port;
-    if (pos == string::npos) {
-        host = connStr;
-        port = "ssh";
-    }
-    else {
-        host = connStr.substr(0, pos);
-        port = connStr.substr(pos + 1);
+std::shared_ptr<SftpConnection>
+getPooledSftpConnection(const std::string & connStr)
+{
+    // Prefer an idle pooled connection, skipping any that have died
+    for (;;) {
+        std::shared_ptr<SftpConnection> connection;
+        {
+            std::unique_lock<std::mutex> guard(sftpHostsLock);
+            auto & info = ensureSftpHost(connStr);
+            if (info.idle.empty())
+                break;
+            connection = std::move(info.idle.back());
+            info.idle.pop_back();
+        }
+        if (connection->isAlive())
+            return leaseSftpConnection(connStr, std::move(connection));
     }
 
-
+    // Nothing idle; open a new connection outside the lock
     SftpHostInfo info;
-    info.sftpHost = host;
-    info.connection = std::make_shared<SftpConnection>();
-    info.connection->connectPasswordAuth(host, creds.id, creds.secret, port);
-    sftpHosts[connStr] = info;
-    return *info.connection.get();
+    {
+        std::unique_lock<std::mutex> guard(sftpHostsLock);
+        info = ensureSftpHost(connStr);
+        info.idle.clear();
+    }
+
+    return leaseSftpConnection(connStr, connectSftp(info));
 }
 
 namespace {
@@ -1112,7 +1320,11 @@ struct SftpUrlFsHandler : public UrlFsHandler {
         ExcAssert(delimiter == "/");
         string url = prefix.toString();
         const string connStr = connStrFromUri(url);
-        const auto & conn = getSftpConnectionFromConnStr(connStr);
+
+        // Traverse over a pooled connection, so that concurrent listings
+        // (eg the partitions of forEachParallel) don't share a session
+        auto lease = getPooledSftpConnection(connStr);
+        const auto & conn = *lease;
 
         function<void(string, int)> processPath = [&] (string path, int depth) {
             auto dir = conn.getDirectory(path);
@@ -197,4 +197,16 @@ void registerSftpHostPublicKey(const std::string & hostname,
 
 const SftpConnection & getSftpConnectionFromConnStr(const std::string & connStr);
 
+/** Check a connection to the given host out of the per-host connection
+    pool, opening a new one if none is idle.  The connection is returned
+    to the pool when the last reference is dropped.
+
+    Unlike getSftpConnectionFromConnStr, which hands out one shared
+    connection per host, each caller gets exclusive use of its
+    connection, so transfers of different files from the same host can
+    proceed in parallel.
+*/
+std::shared_ptr<SftpConnection>
+getPooledSftpConnection(const std::string & connStr);
+
 } // namespace MLDB
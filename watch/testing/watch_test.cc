@@ -638,6 +638,127 @@ BOOST_AUTO_TEST_CASE(test_bind_non_recursive)
     BOOST_CHECK_EQUAL(firedNonRecursive.size(), 1);
 }
 
+BOOST_AUTO_TEST_CASE(test_trigger_batch)
+{
+    WatchesT<int> watches;
+
+    // Unbound watch: batched events accumulate and can be waited on
+    auto w1 = watches.add();
+
+    watches.triggerBatch({ std::make_tuple(1),
+                           std::make_tuple(2),
+                           std::make_tuple(3) });
+
+    BOOST_CHECK_EQUAL(w1.count(), 3);
+    BOOST_CHECK_EQUAL(w1.pop(), 1);
+    BOOST_CHECK_EQUAL(w1.pop(), 2);
+    BOOST_CHECK_EQUAL(w1.pop(), 3);
+
+    // Per-element bound watch: each batched event fires the callback
+    vector<int> fired;
+    w1.bind([&] (int i) { fired.push_back(i); });
+
+    watches.triggerBatch({ std::make_tuple(4), std::make_tuple(5) });
+
+    BOOST_CHECK_EQUAL(fired.size(), 2);
+    BOOST_CHECK_EQUAL(fired[0], 4);
+    BOOST_CHECK_EQUAL(fired[1], 5);
+
+    // Filters are applied per element within the batch
+    vector<int> firedFiltered;
+    auto w2 = watches.add(nullptr, [] (int i) { return i % 2 == 0; });
+    w2.bind([&] (int i) { firedFiltered.push_back(i); });
+
+    watches.triggerBatch({ std::make_tuple(6),
+                           std::make_tuple(7),
+                           std::make_tuple(8) });
+
+    BOOST_CHECK_EQUAL(firedFiltered.size(), 2);
+    BOOST_CHECK_EQUAL(firedFiltered[0], 6);
+    BOOST_CHECK_EQUAL(firedFiltered[1], 8);
+}
+
+BOOST_AUTO_TEST_CASE(test_bind_batch)
+{
+    WatchesT<int> watches;
+
+    auto w = watches.add();
+
+    // Events triggered before binding arrive as one batch
+    watches.trigger(1);
+    watches.trigger(2);
+
+    vector<vector<int> > batches;
+    auto onBatch = [&] (vector<tuple<int> > && batch)
+        {
+            vector<int> vals;
+            for (auto & el: batch)
+                vals.push_back(std::get<0>(el));
+            batches.push_back(std::move(vals));
+        };
+
+    w.bindBatch(onBatch);
+
+    BOOST_REQUIRE_EQUAL(batches.size(), 1);
+    BOOST_CHECK_EQUAL(batches[0].size(), 2);
+
+    // With no delay configured, each trigger is its own batch
+    watches.trigger(3);
+    watches.triggerBatch({ std::make_tuple(4), std::make_tuple(5) });
+
+    BOOST_REQUIRE_EQUAL(batches.size(), 3);
+    BOOST_CHECK_EQUAL(batches[1].size(), 1);
+    BOOST_CHECK_EQUAL(batches[2].size(), 2);
+
+    // Unbinding sends coalesced events back to the saved queue
+    w.unbind();
+    watches.trigger(6);
+    BOOST_CHECK_EQUAL(w.pop(), 6);
+}
+
+BOOST_AUTO_TEST_CASE(test_bind_batch_coalescing)
+{
+    // Make sure the test bombs if delivery never happens
+    MLDB::Watchdog watchdog(10 /* seconds */);
+
+    WatchesT<int> watches;
+
+    auto w = watches.add();
+
+    std::mutex batchMutex;
+    std::vector<size_t> batchSizes;
+    size_t numDelivered = 0;
+
+    auto onBatch = [&] (vector<tuple<int> > && batch)
+        {
+            std::unique_lock<std::mutex> guard(batchMutex);
+            batchSizes.push_back(batch.size());
+            numDelivered += batch.size();
+        };
+
+    // Coalesce with a 50ms bounded delay
+    w.bindBatch(onBatch, 0.05);
+
+    constexpr size_t numEvents = 1000;
+    for (size_t i = 0;  i < numEvents;  ++i)
+        watches.trigger(i);
+
+    // Everything must be delivered within the delay bound (plus slack),
+    // and in far fewer callbacks than events
+    for (int i = 0;  i < 100;  ++i) {
+        {
+            std::unique_lock<std::mutex> guard(batchMutex);
+            if (numDelivered == numEvents)
+                break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    std::unique_lock<std::mutex> guard(batchMutex);
+    BOOST_CHECK_EQUAL(numDelivered, numEvents);
+    BOOST_CHECK_LT(batchSizes.size(), numEvents / 2);
+}
+
 BOOST_AUTO_TEST_CASE(test_disable_from_fire)
 {
     // Make sure the test bombs if there is a deadlock rather than hanging
@@ -534,6 +534,20 @@ struct WatchT: public Watch {
                           WatchErrorHandler errorFnToBind = CRASH_IF_NOT_DISCONNECTED,
                           const WatchErrorHandler & errorFnRecursive = CRASH_IF_NOT_DISCONNECTED);
 
+    /** Bind a callback that receives whole batches of events.  Events
+        that are triggered individually or via triggerBatch() are
+        coalesced per watch, and each one is delivered at most
+        maxDelaySeconds after it was triggered.  With a delay of zero,
+        every trigger or batch trigger is delivered immediately as its
+        own batch.
+
+        The batch vector is moved into the callback, so its elements can
+        be consumed without copying.  Mutually exclusive with bind().
+    */
+    void bindBatch(const std::function<void (std::vector<std::tuple<T...> > &&)> & fn,
+                   double maxDelaySeconds = 0.0,
+                   WatchErrorHandler errorFn = CRASH_IF_NOT_DISCONNECTED);
+
     /** Unbind an asynchronous callback function from the watch. */
     void unbind();
 
@@ -613,6 +627,13 @@ struct WatchesT : public Watches {
 
     /** Trigger the watches, causing all bound handlers to trigger. */
     void trigger(const T &... args);
+
+    /** Trigger the watches with a whole span of events at once.  Each
+        watch sees the events in order, but locking and wakeups are
+        amortized over the span instead of paid per element, and the
+        last watch receives the span by move rather than by copy.
+    */
+    void triggerBatch(std::vector<std::tuple<T...> > vals);
 };
 
 
@@ -15,6 +15,8 @@
 #include <thread>
 #include <atomic>
 #include <list>
+#include <algorithm>
+#include <chrono>
 #include "mldb/types/value_description.h"
 #include "mldb/types/any_impl.h"
 #include "mldb/types/date.h" // TODO: shouldn't need this
@@ -272,10 +274,19 @@ struct WatchDataT: public WatchData {
                std::function<bool (const T &...)> filterFn,
                Any info);
 
+    virtual ~WatchDataT();
+
     /** Bind an asynchronous callback. */
     void bind(const std::function<void (const T &...)> & boundFn,
               WatchErrorHandler errorFn);
 
+    /** Bind a callback taking whole batches of events; see
+        WatchT::bindBatch for the semantics.
+    */
+    void bindBatch(const std::function<void (std::vector<std::tuple<T...> > &&)> & fn,
+                   double maxDelaySeconds,
+                   WatchErrorHandler errorFn);
+
     bool tryBindNonRecursive(const std::function<void (const T &...)> & fn,
                              WatchErrorHandler errorFn);
 
@@ -344,6 +355,14 @@ struct WatchDataT: public WatchData {
     /** Trigger the watch. */
     void triggerLocked(const T &... args);
 
+    /** Trigger the watch with a span of events at once. */
+    void triggerBatch(std::vector<std::tuple<T...> > && vals);
+
+    /** Trigger the watch with a span of events, with the lock already
+        taken.
+    */
+    void triggerBatchLocked(std::vector<std::tuple<T...> > && vals);
+
     /** Trigger the watch from a generic value */
     virtual void triggerGeneric(const Any & vals);
 
@@ -377,6 +396,9 @@ struct WatchDataT: public WatchData {
     /// Function that does the watching
     std::function<void (const T &...)> boundFn;
 
+    /// Function bound to receive whole batches; exclusive with boundFn
+    std::function<void (std::vector<std::tuple<T...> > &&)> boundBatchFn;
+
     /// Function that gets the errors
     WatchErrorHandler errorFn;
 
@@ -385,6 +407,31 @@ struct WatchDataT: public WatchData {
 
     /// Set of multiplexed watches
     std::vector<WatchT<T...> > multiplexed;
+
+private:
+    /// Events coalesced for delivery to boundBatchFn
+    std::vector<std::tuple<T...> > pendingBatch;
+
+    /// Number of coalesced events.  Used as a futex for the flusher.
+    std::atomic<int> numPending;
+
+    /// Maximum time an event may be coalesced before delivery
+    double batchMaxDelay;
+
+    /// Set to ask the flusher thread to exit
+    std::atomic<bool> flusherStopping;
+
+    /// Thread that delivers coalesced batches when a delay is configured
+    std::thread flusherThread;
+
+    /// Deliver anything in pendingBatch to boundBatchFn.  Lock must be held.
+    void flushPendingLocked();
+
+    /// Body of the flusher thread
+    void runFlusher();
+
+    /// Stop the flusher thread, if it's running
+    void stopFlusher();
 };
 
 
@@ -494,6 +541,21 @@ bindNonRecursive(const std::function<void (const T &...)> & fnToBind,
     }
 }
 
+template<typename... T>
+void
+WatchT<T...>::
+bindBatch(const std::function<void (std::vector<std::tuple<T...> > &&)> & fn,
+          double maxDelaySeconds,
+          WatchErrorHandler errorFn)
+{
+    ExcAssert(data);
+    auto d = dataT();
+    if (!d)
+        throwException(WATCH_ERR_TYPE,
+                       "batch binding requires a watch of a known type");
+    d->bindBatch(fn, maxDelaySeconds, std::move(errorFn));
+}
+
 /** Unbind an asynchronous callback function from the watch. */
 template<typename... T>
 void
@@ -675,6 +737,29 @@ trigger(const T &... args)
     triggerThread = std::thread::id();
 }
 
+template<typename... T>
+void
+WatchesT<T...>::
+triggerBatch(std::vector<std::tuple<T...> > vals)
+{
+    std::unique_lock<std::mutex> guard(mutex);
+    triggerThread = std::this_thread::get_id();
+
+    ++triggers;
+    for (size_t i = 0;  i < watches.size();  ++i) {
+        auto kept = watches[i];  // keep a copy of the shared_ptr
+        auto * data = static_cast<WatchDataT<T...> *>(kept.get());
+        if (i == watches.size() - 1)
+            data->triggerBatch(std::move(vals));
+        else {
+            auto copy = vals;
+            data->triggerBatch(std::move(copy));
+        }
+    }
+
+    triggerThread = std::thread::id();
+}
+
 
 /*****************************************************************************/
 /* WATCH DATA T                                                              */
@@ -687,10 +772,20 @@ WatchDataT(Watches * owner,
            Any info)
     : WatchData(owner, &typeid(std::tuple<T...>), std::move(info)),
       numSaved(0),
-      filterFn(std::move(filterFn))
+      filterFn(std::move(filterFn)),
+      numPending(0),
+      batchMaxDelay(0.0),
+      flusherStopping(false)
 {
 }
 
+template<typename... T>
+WatchDataT<T...>::
+~WatchDataT()
+{
+    stopFlusher();
+}
+
 template<typename... T>
 void
 WatchDataT<T...>::
@@ -702,6 +797,7 @@ bind(const std::function<void (const T &...)> & boundFn,
     auto guard(this->lock());
 
     ExcAssert(!this->boundFn);
+    ExcAssert(!this->boundBatchFn);
 
     this->boundFn = boundFn;
     this->errorFn = errorFn;
@@ -718,6 +814,92 @@ bind(const std::function<void (const T &...)> & boundFn,
     numSaved = 0;
 }
 
+template<typename... T>
+void
+WatchDataT<T...>::
+bindBatch(const std::function<void (std::vector<std::tuple<T...> > &&)> & fn,
+          double maxDelaySeconds,
+          WatchErrorHandler errorFn)
+{
+    auto guard(this->lock());
+
+    ExcAssert(!this->boundFn);
+    ExcAssert(!this->boundBatchFn);
+
+    this->boundBatchFn = fn;
+    this->errorFn = errorFn;
+    this->batchMaxDelay = maxDelaySeconds;
+
+    // Deliver anything that accumulated before binding as a single batch
+    std::vector<std::tuple<T...> > batch;
+    batch.reserve(saved.size());
+    for (auto & s: saved) {
+        if (s)
+            batch.emplace_back(std::move(s.val()));
+        else {
+            errorFn(s.err());
+        }
+    }
+
+    saved.clear();
+    numSaved = 0;
+
+    if (!batch.empty())
+        boundBatchFn(std::move(batch));
+
+    if (batchMaxDelay > 0.0 && !flusherThread.joinable())
+        flusherThread = std::thread(&WatchDataT::runFlusher, this);
+}
+
+template<typename... T>
+void
+WatchDataT<T...>::
+flushPendingLocked()
+{
+    if (pendingBatch.empty() || !boundBatchFn)
+        return;
+
+    std::vector<std::tuple<T...> > batch;
+    batch.swap(pendingBatch);
+    numPending = 0;
+
+    boundBatchFn(std::move(batch));
+}
+
+template<typename... T>
+void
+WatchDataT<T...>::
+runFlusher()
+{
+    while (!flusherStopping) {
+        if (numPending == 0) {
+            MLDB::wait_on_address(numPending, 0, batchMaxDelay);
+            continue;  // re-check the stop flag and pending count
+        }
+
+        // Let further events accumulate until the delay bound for the
+        // first one expires, then deliver everything in one batch.
+        std::this_thread::sleep_for
+            (std::chrono::duration<double>(batchMaxDelay));
+
+        auto guard(this->lock());
+        flushPendingLocked();
+    }
+}
+
+template<typename... T>
+void
+WatchDataT<T...>::
+stopFlusher()
+{
+    if (!flusherThread.joinable())
+        return;
+    flusherStopping = true;
+    MLDB::wake_by_address(numPending);
+    flusherThread.join();
+    flusherStopping = false;
+}
+
 template<typename... T>
 bool
 WatchDataT<T...>::
@@ -725,8 +907,9 @@ tryBindNonRecursive(const std::function<void (const T &...)> & boundFn,
                     WatchErrorHandler errorFn)
 {
     auto guard(this->lock());
-    
+
     ExcAssert(!this->boundFn);
+    ExcAssert(!this->boundBatchFn);
     if (!saved.empty())
         return false;
     
@@ -781,7 +964,8 @@ WatchDataT<T...>::
 bound() const
 {
     auto guard(this->lock());
-    return this->boundFn.operator bool();
+    return this->boundFn.operator bool()
+        || this->boundBatchFn.operator bool();
 }
 
 /** Unbind an asynchronous callback. */
@@ -790,8 +974,20 @@ void
 WatchDataT<T...>::
 unbind()
 {
+    stopFlusher();
+
     auto guard(this->lock());
     this->boundFn = nullptr;
+    if (this->boundBatchFn) {
+        this->boundBatchFn = nullptr;
+
+        // Anything still coalesced goes back to accumulating in saved
+        for (auto & el: pendingBatch)
+            saved.emplace_back(std::move(el));
+        pendingBatch.clear();
+        numSaved += numPending.exchange(0);
+        MLDB::wake_by_address(numSaved);
+    }
     this->errorFn = nullptr;
 }
 
@@ -877,8 +1073,8 @@ MaybeT<std::tuple<T...>, WatchError>
 WatchDataT<T...>::
 tryWaitMaybe(double timeToWait)
 {
-    if (boundFn)
-        owner->throwException(WATCH_ERR_WAIT_BOUND, 
+    if (boundFn || boundBatchFn)
+        owner->throwException(WATCH_ERR_WAIT_BOUND,
                               "cannot wait on a bound watch");
     
     Date limit = Date::now().plusSeconds(timeToWait);
@@ -936,7 +1132,14 @@ triggerLocked(const T &... args)
         return;
 
     // No lock, assume it's already taken
-    if (boundFn && saved.empty())
+    if (boundBatchFn) {
+        pendingBatch.emplace_back(args...);
+        ++numPending;
+        if (batchMaxDelay <= 0.0)
+            flushPendingLocked();
+        else MLDB::wake_by_address(numPending);
+    }
+    else if (boundFn && saved.empty())
         boundFn(args...);
     else {
         saved.emplace_back(std::tuple<T...>(args...));
@@ -945,6 +1148,68 @@ triggerLocked(const T &... args)
     }
 }
 
+template<typename... T>
+void
+WatchDataT<T...>::
+triggerBatch(std::vector<std::tuple<T...> > && vals)
+{
+    auto guard = this->lock();
+    triggerBatchLocked(std::move(vals));
+}
+
+template<typename... T>
+void
+WatchDataT<T...>::
+triggerBatchLocked(std::vector<std::tuple<T...> > && vals)
+{
+    this->triggers += vals.size();
+
+    if (filterFn) {
+        auto matches = [&] (std::tuple<T...> & el)
+            {
+                bool keep = true;
+                auto checkFn = [&] (const T &... args)
+                    {
+                        keep = filterFn(args...);
+                    };
+                callFromTuple(checkFn, el);
+                return keep;
+            };
+
+        vals.erase(std::remove_if(vals.begin(), vals.end(),
+                                  [&] (std::tuple<T...> & el)
+                                  {
+                                      return !matches(el);
+                                  }),
+                   vals.end());
+    }
+
+    if (vals.empty())
+        return;
+
+    if (boundBatchFn) {
+        if (pendingBatch.empty())
+            pendingBatch = std::move(vals);
+        else pendingBatch.insert(pendingBatch.end(),
+                                 std::make_move_iterator(vals.begin()),
+                                 std::make_move_iterator(vals.end()));
+        numPending = pendingBatch.size();
+        if (batchMaxDelay <= 0.0)
+            flushPendingLocked();
+        else MLDB::wake_by_address(numPending);
+    }
+    else if (boundFn && saved.empty()) {
+        for (auto & el: vals)
+            callFromTuple(boundFn, std::move(el));
+    }
+    else {
+        for (auto & el: vals)
+            saved.emplace_back(std::move(el));
+        numSaved += vals.size();
+        MLDB::wake_by_address(numSaved);
+    }
+}
+
 template<typename... T>
 void
 WatchDataT<T...>::
@@ -979,6 +1244,10 @@ errorLocked(const WatchError & error)
 {
     ++this->errors;
 
+    // Make sure any coalesced events are seen before the error
+    if (boundBatchFn)
+        flushPendingLocked();
+
     if (errorFn) {
         ExcAssert(saved.empty());
         errorFn(error);